@@ -61,6 +61,7 @@ struct Configuration {
 
     std::string versionCheckUrl;
     bool useMultithreadedInitialization = false;
+    bool useMultithreadedSceneUpdate = false;
 
     struct LoadingScreen {
         bool isShowingMessages = true;
@@ -28,6 +28,7 @@
 #include <openspace/util/syncbuffer.h>
 
 #include <ghoul/misc/boolean.h>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -38,19 +39,29 @@ class Syncable;
 /**
  * Manages a collection of <code>Syncable</code>s and ensures they are synchronized
  * over SGCT nodes. Encoding/Decoding order is handles internally.
+ *
+ * Most frames are delta frames that only contain the Syncables that report a change
+ * through Syncable::hasChanged, prefixed by their index. Every
+ * <code>keyframeInterval</code> frames, and whenever the set of Syncables changes, a
+ * keyframe containing all Syncables is sent instead so that the slaves can never drift
+ * away from the master for long.
  */
 class SyncEngine {
 public:
     BooleanType(IsMaster);
 
     /**
-     * Creates a new SyncEngine which a buffer size of \p syncBufferSize
+     * Creates a new SyncEngine which a buffer size of \p syncBufferSize that sends a
+     * keyframe every \p keyframeInterval frames. A \p keyframeInterval of 1 disables
+     * the delta frames
      * \pre syncBufferSize must be bigger than 0
+     * \pre keyframeInterval must be bigger than 0
      */
-    SyncEngine(unsigned int syncBufferSize);
+    SyncEngine(unsigned int syncBufferSize, unsigned int keyframeInterval = 60);
 
     /**
-     * Encodes all added Syncables in the injected <code>SyncBuffer</code>.
+     * Encodes the added Syncables in the injected <code>SyncBuffer</code>, either all of
+     * them or only the changed ones, depending on whether this frame is a keyframe.
      * This method is only called on the SGCT master node
      */
     std::vector<char> encodeSyncables();
@@ -93,7 +104,17 @@ public:
     */
     void removeSyncables(const std::vector<Syncable*>& syncables);
 
+    /**
+     * Makes the next call to encodeSyncables produce a keyframe
+     */
+    void requestKeyframe();
+
 private:
+    enum class FrameType : uint8_t {
+        Keyframe = 0,
+        Delta
+    };
+
     /**
      * Vector of Syncables. The vectors ensures consistent encode/decode order
      */
@@ -103,6 +124,13 @@ private:
      * Databuffer used in encoding/decoding
      */
     SyncBuffer _syncBuffer;
+
+    /// Indices of the Syncables that are part of the delta frame that is being encoded
+    std::vector<uint32_t> _changedSyncables;
+
+    unsigned int _keyframeInterval;
+    unsigned int _framesSinceKeyframe = 0;
+    bool _keyframeRequested = true;
 };
 
 } // namespace openspace
@@ -0,0 +1,202 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___INDEXEDRECORDING___H__
+#define __OPENSPACE_CORE___INDEXEDRECORDING___H__
+
+#include <openspace/interaction/keyframenavigator.h>
+#include <openspace/network/messagestructures.h>
+#include <openspace/util/memorymappedfile.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::interaction {
+
+/**
+ * A random-access, read-only view of a session recording. Indexed recordings (version
+ * 02.00 of the session recording format) are memory-mapped, so opening them only
+ * requires validating the trailer and the time index, and keyframes are read from the
+ * mapping as they are needed. Recordings in the older ASCII and binary formats are
+ * parsed into the same layout in memory when they are opened.
+ *
+ * An indexed file starts with the same text header as the older formats, followed by the
+ * fixed-size camera, time, and script records, a string table containing the focus node
+ * names and scripts, and the time index. The file ends with a fixed-size trailer that
+ * stores the offsets and sizes of these sections. The time index has one Entry per
+ * keyframe in the order in which they were recorded, so as long as the timestamps in a
+ * time base are increasing, any timestamp can be found with a binary search.
+ */
+class IndexedRecording {
+public:
+    enum class EntryType : uint32_t {
+        Camera = 0,
+        Time,
+        Script
+    };
+
+    /// One entry of the time index, which is stored as-is in the file
+    struct Entry {
+        /// The application time at which the keyframe was recorded
+        double timeOs;
+        /// The time since the recording was started
+        double timeRec;
+        /// The simulation time in J2000 seconds at which the keyframe was recorded
+        double timeSim;
+        EntryType type;
+        /// The index into the camera keyframes, time keyframes, or scripts
+        uint32_t index;
+    };
+
+    /**
+     * Collects keyframes in the order in which they are recorded and creates the
+     * contents of an indexed recording file from them. Identical focus node names are
+     * only stored once in the string table.
+     */
+    class Builder {
+    public:
+        void addCamera(double timeOs, double timeRec, double timeSim,
+            const KeyframeNavigator::CameraPose& pose);
+        void addTime(double timeOs, double timeRec, double timeSim,
+            const datamessagestructures::TimeKeyframe& keyframe);
+        void addScript(double timeOs, double timeRec, double timeSim,
+            std::string_view script);
+
+        /// Returns the number of keyframes that have been added
+        size_t nEntries() const;
+
+        /// Returns the contents of the indexed recording file
+        std::vector<std::byte> build() const;
+
+        /**
+         * Writes the indexed recording to \p path. The file is first written under a
+         * temporary name and then moved into place.
+         *
+         * \throw ghoul::RuntimeError If the file could not be written
+         */
+        void save(const std::string& path) const;
+
+    private:
+        friend class IndexedRecording;
+
+        size_t fileSize() const;
+        void write(std::byte* destination) const;
+        uint64_t addString(std::string_view s);
+
+        std::vector<Entry> _entries;
+        std::vector<std::byte> _cameras;
+        std::vector<std::byte> _times;
+        std::vector<std::byte> _scripts;
+        std::string _strings;
+        std::unordered_map<std::string, uint64_t> _nodeNameOffsets;
+    };
+
+    /**
+     * Opens the recording at \p path. Indexed recordings are memory-mapped, recordings
+     * in the ASCII or binary formats are parsed completely. Keyframes in those files
+     * that cannot be parsed are logged and skipped.
+     *
+     * \throw ghoul::RuntimeError If the file could not be opened, does not have a valid
+     *        header, contains an unknown type of keyframe, or is an invalid indexed file
+     */
+    explicit IndexedRecording(const std::string& path);
+
+    /// Creates a view of the keyframes collected in the \p builder
+    explicit IndexedRecording(const Builder& builder);
+
+    IndexedRecording(const IndexedRecording&) = delete;
+    IndexedRecording& operator=(const IndexedRecording&) = delete;
+
+    /// Returns \c true if the recording is backed by a memory-mapped indexed file
+    bool isMapped() const;
+
+    size_t nEntries() const;
+    size_t nCameraKeyframes() const;
+    size_t nTimeKeyframes() const;
+    size_t nScripts() const;
+
+    /// Returns the entry with the provided \p index, which has to be smaller than
+    /// nEntries
+    const Entry& entry(size_t index) const;
+
+    /// Returns the camera pose with the provided \p index, which has to be smaller than
+    /// nCameraKeyframes
+    KeyframeNavigator::CameraPose cameraPose(uint32_t index) const;
+
+    /**
+     * Returns the time keyframe with the provided \p index, which has to be smaller than
+     * nTimeKeyframes. Only the delta time, the paused state, and whether a time jump is
+     * required are stored in the recording.
+     */
+    datamessagestructures::TimeKeyframe timeKeyframe(uint32_t index) const;
+
+    /// Returns the script with the provided \p index, which has to be smaller than
+    /// nScripts
+    std::string_view script(uint32_t index) const;
+
+    /**
+     * Returns the index of the first entry whose timestamp in the time base selected by
+     * \p timeRef is not smaller than \p timestamp, or nEntries if there is no such
+     * entry. This requires the timestamps in that time base to be increasing.
+     */
+    size_t seek(double timestamp, KeyframeTimeRef timeRef) const;
+
+    /// Returns the timestamp of the \p entry in the time base selected by \p timeRef
+    static double timestamp(const Entry& entry, KeyframeTimeRef timeRef);
+
+private:
+    void initialize(const std::byte* data, size_t size, const std::string& path);
+    std::string_view string(uint64_t offset, uint64_t length) const;
+
+    std::optional<MemoryMappedFile> _file;
+    std::vector<std::byte> _buffer;
+
+    const Entry* _entries = nullptr;
+    size_t _nEntries = 0;
+    const std::byte* _cameras = nullptr;
+    size_t _nCameras = 0;
+    const std::byte* _times = nullptr;
+    size_t _nTimes = 0;
+    const std::byte* _scripts = nullptr;
+    size_t _nScripts = 0;
+    const char* _strings = nullptr;
+    size_t _stringsSize = 0;
+};
+
+/**
+ * Converts the recording in the ASCII or binary format at \p source into an indexed
+ * recording at \p destination.
+ *
+ * \throw ghoul::RuntimeError If the \p source could not be read or the \p destination
+ *        could not be written
+ */
+void convertToIndexedRecording(const std::string& source, const std::string& destination);
+
+} // namespace openspace::interaction
+
+#endif // __OPENSPACE_CORE___INDEXEDRECORDING___H__
@@ -0,0 +1,147 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_CORE___RECORDINGWRITER___H__
+#define __OPENSPACE_CORE___RECORDINGWRITER___H__
+
+#include <openspace/network/messagestructures.h>
+#include <openspace/util/boundedconcurrentqueue.h>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace openspace::interaction {
+
+/**
+ * Writes the keyframes of a session recording to the recording file on a separate
+ * thread, so that slow storage does not affect the frame time. The keyframes are passed
+ * to the writer thread through a bounded queue. If the queue is full, camera and time
+ * keyframes are dropped and counted, while scripts wait for free space, as a missing
+ * script would change the outcome of the playback. The writer thread formats the
+ * keyframes in batches and writes each batch with a single call to the file.
+ */
+class RecordingWriter {
+public:
+    enum class DataMode {
+        Ascii = 0,
+        Binary
+    };
+
+    /// A keyframe that was recorded on the main thread and is waiting to be written
+    struct Keyframe {
+        enum class Type {
+            Camera = 0,
+            Time,
+            Script
+        };
+
+        Type type = Type::Camera;
+        double timestamp = 0.0;
+        double timestampRelative = 0.0;
+        double simulationTime = 0.0;
+        datamessagestructures::CameraKeyframe camera;
+        datamessagestructures::TimeKeyframe time;
+        std::string script;
+    };
+
+    /// About one minute of camera keyframes at 60 frames per second
+    static constexpr const size_t DefaultQueueCapacity = 4096;
+
+    explicit RecordingWriter(size_t queueCapacity = DefaultQueueCapacity);
+    ~RecordingWriter();
+
+    /**
+     * Creates the recording file \p filename for keyframes in the format \p dataMode.
+     * Keyframes can be queued as soon as the file is open, but they are only written
+     * after #start has been called. Returns <code>false</code> if the file could not be
+     * created.
+     */
+    bool open(const std::string& filename, DataMode dataMode);
+
+    /**
+     * Starts the thread that writes the queued keyframes to the recording file
+     */
+    void start();
+
+    /**
+     * Writes all keyframes that are still queued, flushes the recording file to the
+     * disk, and closes it. Does nothing if no recording file is open.
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * Queues the \p keyframe for writing. If the queue is full, a camera or time keyframe
+     * is dropped, while this function waits for the writer thread to make space for a
+     * script.
+     */
+    void queueKeyframe(Keyframe keyframe);
+
+    /**
+     * Returns the number of camera and time keyframes that were dropped since the
+     * recording file was opened
+     */
+    size_t nDroppedKeyframes() const;
+
+    /**
+     * Returns the number of keyframes that have been queued but not written yet
+     */
+    size_t backlog() const;
+
+    /**
+     * Returns the largest backlog since the recording file was opened
+     */
+    size_t maxBacklog() const;
+
+private:
+    void run();
+    bool writeQueuedKeyframes();
+
+    const size_t _queueCapacity;
+    std::FILE* _file = nullptr;
+    DataMode _dataMode = DataMode::Binary;
+
+    // The queue is only allocated while a recording file is open
+    std::unique_ptr<BoundedConcurrentQueue<Keyframe>> _queue;
+    std::thread _thread;
+    std::atomic_bool _isRunning = false;
+
+    // Only accessed by the writer thread while it is running
+    std::vector<Keyframe> _batch;
+    std::vector<char> _buffer;
+    bool _hasWriteFailed = false;
+
+    // Only accessed by the thread that queues the keyframes
+    size_t _nDroppedKeyframes = 0;
+    size_t _maxBacklog = 0;
+};
+
+} // namespace openspace::interaction
+
+#endif // __OPENSPACE_CORE___RECORDINGWRITER___H__
@@ -26,18 +26,18 @@
 #define __OPENSPACE_CORE___SESSIONRECORDING___H__
 
 #include <openspace/interaction/externinteraction.h>
+#include <openspace/interaction/indexedrecording.h>
 #include <openspace/interaction/keyframenavigator.h>
+#include <openspace/interaction/recordingwriter.h>
 #include <openspace/scripting/lualibrary.h>
+#include <memory>
 #include <vector>
 
 namespace openspace::interaction {
 
 class SessionRecording : public properties::PropertyOwner {
 public:
-    enum class RecordedDataMode {
-        Ascii = 0,
-        Binary
-    };
+    using RecordedDataMode = RecordingWriter::DataMode;
 
     enum class SessionState {
         Idle = 0,
@@ -97,8 +97,9 @@ public:
     void setRecordDataFormat(RecordedDataMode dataMode);
 
     /**
-     * Used to stop a recording in progress. If open, the recording file will be closed,
-     * and all keyframes deleted from memory.
+     * Used to stop a recording in progress. All keyframes that have not been written
+     * yet are written to the recording file before it is flushed to the disk and
+     * closed.
      */
     void stopRecording();
 
@@ -109,8 +110,23 @@ public:
      */
     bool isRecording() const;
 
+    /**
+     * Returns the number of camera and time keyframes that were dropped during the
+     * current or last recording, because the writer thread could not keep up with the
+     * rendering. Scripts are never dropped.
+     */
+    size_t nDroppedKeyframes() const;
+
+    /**
+     * Returns the number of keyframes that have been recorded but not written to the
+     * recording file yet.
+     */
+    size_t recordingBacklog() const;
+
     /**
      * Starts a playback session, which can run in one of three different time modes.
+     * Indexed recordings are memory-mapped and start immediately, recordings in the
+     * ASCII or binary formats are parsed completely before the playback starts.
      *
      * \param filename file containing recorded keyframes to play back
      * \param timeMode which of the 3 time modes to use for time reference during
@@ -129,6 +145,30 @@ public:
      */
     void stopPlayback();
 
+    /**
+     * Moves the playback in progress to the provided \p timestamp, which is interpreted
+     * in the time mode of the playback. The keyframes are found with a binary search
+     * and scripts between the current position and the \p timestamp are not executed.
+     * Playbacks that are relative to the application time cannot be moved.
+     *
+     * \param timestamp The time to which the playback is moved
+     *
+     * \return \c true if the playback was moved
+     */
+    bool seekPlayback(double timestamp);
+
+    /**
+     * Converts a recording in the ASCII or binary format into an indexed recording,
+     * which can be played back without parsing it first. Both files are located in the
+     * recordings directory.
+     *
+     * \param source The name of the recording that is converted
+     * \param destination The name of the indexed recording that is created
+     *
+     * \return \c true if the recording was converted without errors
+     */
+    bool convertRecording(const std::string& source, const std::string& destination);
+
     /**
      * Enables that rendered frames should be saved during playback
      * \param fps Number of frames per second.
@@ -215,11 +255,6 @@ private:
         Script,
         Invalid
     };
-    struct timelineEntry {
-        RecordedType keyframeType;
-        unsigned int idxIntoKeyframeTypeArray;
-        double timestamp;
-    };
     ExternInteraction _externInteract;
     bool _isRecording = false;
     double _timestampRecordStarted = 0.0;
@@ -227,28 +262,12 @@ private:
     double _timestampPlaybackStarted_simulation = 0.0;
     double _timestampApplicationStarted_simulation = 0.0;
     bool hasCameraChangedFromPrev(datamessagestructures::CameraKeyframe kfNew);
-    double appropriateTimestamp(double timeOs, double timeRec, double timeSim);
     double equivalentSimulationTime(double timeOs, double timeRec, double timeSim);
     double equivalentApplicationTime(double timeOs, double timeRec, double timeSim);
 
-    void playbackCamera();
-    void playbackTimeChange();
-    void playbackScript();
-    bool playbackAddEntriesToTimeline();
     void signalPlaybackFinishedForComponent(RecordedType type);
-    void writeToFileBuffer(double src);
-    void writeToFileBuffer(std::vector<char>& cvec);
-    void writeToFileBuffer(unsigned char c);
-    void writeToFileBuffer(bool b);
-    void saveStringToFile(const std::string& s);
-    void saveKeyframeToFileBinary(unsigned char* bufferSource, size_t size);
     void findFirstCameraKeyframeInTimeline();
-    void saveKeyframeToFile(std::string entry);
 
-    void addKeyframe(double timestamp,
-        interaction::KeyframeNavigator::CameraPose keyframe);
-    void addKeyframe(double timestamp, datamessagestructures::TimeKeyframe keyframe);
-    void addKeyframe(double timestamp, std::string scriptToQueue);
     void moveAheadInTime();
     void lookForNonCameraKeyframesThatHaveComeDue(double currTime);
     void updateCameraWithOrWithoutNewKeyframes(double currTime);
@@ -260,6 +279,9 @@ private:
     //bool isDataModeBinary();
     unsigned int findIndexOfLastCameraKeyframeInTimeline();
     bool doesTimelineEntryContainCamera(unsigned int index) const;
+    unsigned int timelineSize() const;
+    RecordedType timelineEntryType(unsigned int index) const;
+    double timelineTimestamp(unsigned int index) const;
     std::vector<std::pair<CallbackHandle, StateChangeCallback>> _stateChangeCallbacks;
 
     RecordedType getNextKeyframeType();
@@ -272,38 +294,24 @@ private:
     SessionState _state = SessionState::Idle;
     SessionState _lastState = SessionState::Idle;
     std::string _playbackFilename;
-    std::ifstream _playbackFile;
-    std::string _playbackLineParsing;
-    std::ofstream _recordFile;
-    int _playbackLineNum = 1;
+    std::unique_ptr<IndexedRecording> _playback;
     KeyframeTimeRef _playbackTimeReferenceMode;
     datamessagestructures::CameraKeyframe _prevRecordedCameraKeyframe;
     bool _playbackActive_camera = false;
     bool _playbackActive_time = false;
     bool _playbackActive_script = false;
     bool _hasHitEndOfCameraKeyframes = false;
-    bool _setSimulationTimeWithNextCameraKeyframe = false;
 
     bool _saveRenderingDuringPlayback = false;
     double _saveRenderingDeltaTime = 1.0 / 30.0;
     double _saveRenderingCurrentRecordedTime;
 
-    static const size_t keyframeHeaderSize_bytes = 33;
-    static const size_t saveBufferCameraSize_min = 82;
-    static const size_t saveBufferStringSize_max = 500;
-    static const size_t _saveBufferMaxSize_bytes = keyframeHeaderSize_bytes +
-        + saveBufferCameraSize_min
-        + saveBufferStringSize_max;
-    unsigned char _keyframeBuffer[_saveBufferMaxSize_bytes];
-    size_t _bufferIndex = 0;
+    // Keyframes are written to the recording file on a separate thread, so slow storage
+    // does not affect the frame time
+    RecordingWriter _recordingWriter;
 
     bool _cleanupNeeded = false;
 
-    std::vector<interaction::KeyframeNavigator::CameraPose> _keyframesCamera;
-    std::vector<datamessagestructures::TimeKeyframe> _keyframesTime;
-    std::vector<std::string> _keyframesScript;
-    std::vector<timelineEntry> _timeline;
-
     unsigned int _idxTimeline_nonCamera = 0;
     unsigned int _idxTime = 0;
     unsigned int _idxScript = 0;
@@ -0,0 +1,122 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___KEYFRAMECODEC___H__
+#define __OPENSPACE_CORE___KEYFRAMECODEC___H__
+
+#include <openspace/network/messagestructures.h>
+
+#include <ghoul/glm.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::datamessagestructures {
+
+/**
+ * The version of the compact keyframe codec that is implemented by KeyframeEncoder and
+ * KeyframeDecoder. Peers announce the version they support during authentication and
+ * the server tells everyone the highest version that all peers support. Version 0 is the
+ * field-by-field encoding of CameraKeyframe and TimeTimeline.
+ */
+constexpr const uint32_t KeyframeCodecVersion = 1;
+
+/**
+ * All keyframes that a host sends in a single message of type Type::KeyframeBatch
+ */
+struct KeyframeBatch {
+    std::vector<CameraKeyframe> cameraKeyframes;
+    bool hasTimeline = false;
+    TimeTimeline timeline;
+};
+
+/**
+ * Encodes KeyframeBatch%es compactly. Rotations are quantized with the smallest-three
+ * method, positions are sent as single precision deltas to the previous position
+ * relative to the same focus node whenever that is precise enough, focus node names are
+ * only sent the first time they are used, and timestamps are sent as offsets to a
+ * single timestamp per batch.
+ *
+ * As the encoding of a batch depends on the previous batches, every
+ * <code>ResetInterval</code> batches, and after #requestReset, a batch is encoded that
+ * does not depend on any previous state. A KeyframeDecoder that joins a stream can only
+ * start decoding with such a batch.
+ */
+class KeyframeEncoder {
+public:
+    static constexpr const int ResetInterval = 100;
+
+    /**
+     * Appends the encoded \p batch to the \p buffer
+     */
+    void encode(const KeyframeBatch& batch, std::vector<char>& buffer);
+
+    /**
+     * Makes the next batch independent of all previous ones, for example because a new
+     * peer has joined the session
+     */
+    void requestReset();
+
+private:
+    std::unordered_map<std::string, uint16_t> _nodeIds;
+    std::vector<glm::dvec3> _lastPositions;
+    std::vector<bool> _hasLastPosition;
+    uint16_t _sequenceNumber = 0;
+    int _batchesSinceReset = 0;
+    bool _resetRequested = true;
+};
+
+/**
+ * Decodes the batches that are produced by a KeyframeEncoder. The batches have to be
+ * passed to the decoder in the order in which they were encoded.
+ */
+class KeyframeDecoder {
+public:
+    /**
+     * Decodes the batch in \p buffer starting at \p offset into \p batch. Returns
+     * <code>false</code> if the \p buffer is malformed or depends on previous batches
+     * that this decoder has not seen, in which case the decoder waits for the next batch
+     * that does not depend on any previous state.
+     */
+    bool decode(const std::vector<char>& buffer, KeyframeBatch& batch,
+        size_t offset = 0);
+
+    /**
+     * Discards all state so that the next batch that can be decoded is one that does
+     * not depend on previous batches
+     */
+    void reset();
+
+private:
+    std::vector<std::string> _nodeNames;
+    std::vector<glm::dvec3> _lastPositions;
+    std::vector<bool> _hasLastPosition;
+    uint16_t _expectedSequenceNumber = 0;
+    bool _isValid = false;
+};
+
+} // namespace openspace::datamessagestructures
+
+#endif // __OPENSPACE_CORE___KEYFRAMECODEC___H__
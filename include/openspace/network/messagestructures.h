@@ -36,7 +36,8 @@ namespace openspace::datamessagestructures {
 enum class Type : uint32_t {
     CameraData = 0,
     TimelineData,
-    ScriptData
+    ScriptData,
+    KeyframeBatch
 };
 
 struct CameraKeyframe {
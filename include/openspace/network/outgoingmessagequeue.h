@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_CORE___OUTGOINGMESSAGEQUEUE___H__
+#define __OPENSPACE_CORE___OUTGOINGMESSAGEQUEUE___H__
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The bounded queue of encoded messages that the ParallelServer has not yet written to
+ * the socket of a single peer. At most one sender drains the queue at any time; #push
+ * tells the caller when a sender has to be started. A camera keyframe that is still
+ * queued is replaced by a newer one, so a lagging peer only ever receives the latest
+ * camera position. If the queue overflows nevertheless, all queued messages are
+ * discarded and the queue rejects every further message, as the peer has to be
+ * disconnected.
+ */
+class OutgoingMessageQueue {
+public:
+    /**
+     * A message that is queued for sending. The encoded bytes are shared between all
+     * peers that the message is sent to.
+     */
+    struct Message {
+        std::shared_ptr<const std::vector<char>> encoded;
+        bool isCameraKeyframe = false;
+    };
+
+    enum class PushResult {
+        Queued = 0,    ///< The message was queued and a sender is already running
+        StartSending,  ///< The message was queued and the caller has to start a sender
+        Overflow,      ///< The queue overflowed with this message, the peer is lagging
+        Rejected       ///< The queue has overflowed before, the message was discarded
+    };
+
+    /**
+     * Creates a queue that overflows when a message is pushed while \p maxMessages
+     * messages are queued already
+     */
+    explicit OutgoingMessageQueue(size_t maxMessages);
+
+    /**
+     * Queues the \p message, replacing a queued camera keyframe if \p message is a
+     * camera keyframe itself
+     */
+    PushResult push(Message message);
+
+    /**
+     * Returns the next message that the sender should write to the socket, or
+     * <code>nullptr</code> if the queue is empty. In the latter case the sender has to
+     * stop and the next call to #push will request a new one.
+     */
+    std::shared_ptr<const std::vector<char>> pop();
+
+    /**
+     * Discards all queued messages and stops the sender, for example because the socket
+     * could not be written to
+     */
+    void clear();
+
+    size_t size() const;
+
+    bool hasOverflowed() const;
+
+private:
+    mutable std::mutex _mutex;
+    std::deque<Message> _messages;
+    const size_t _maxMessages;
+    bool _isSending = false;
+    bool _hasOverflowed = false;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___OUTGOINGMESSAGEQUEUE___H__
@@ -79,6 +79,20 @@ public:
     bool isConnectedOrConnecting() const;
     void sendDataMessage(const ParallelConnection::DataMessage& dataMessage);
     bool sendMessage(const ParallelConnection::Message& message);
+
+    /**
+     * Sends a message that has already been encoded with #encodeMessage. This allows a
+     * message that goes to several connections to be encoded only once.
+     */
+    bool sendEncodedMessage(const std::vector<char>& encodedMessage);
+
+    /**
+     * Returns the bytes that are sent over the socket for a message of type \p type with
+     * the provided \p content, that is the message header followed by the content.
+     */
+    static std::vector<char> encodeMessage(MessageType type,
+        const std::vector<char>& content);
+
     void disconnect();
     ghoul::io::TcpSocket* socket();
 
@@ -27,6 +27,7 @@
 
 #include <openspace/network/parallelconnection.h>
 #include <openspace/interaction/externinteraction.h>
+#include <openspace/network/keyframecodec.h>
 #include <openspace/network/messagestructures.h>
 #include <openspace/util/timemanager.h>
 
@@ -88,8 +89,15 @@ private:
     void connectionStatusMessageReceived(const std::vector<char>& message);
     void nConnectionsMessageReceived(const std::vector<char>& message);
 
+    void applyCameraKeyframe(const datamessagestructures::CameraKeyframe& kf);
+    void applyTimeTimeline(const datamessagestructures::TimeTimeline& timeline,
+        double timestamp);
+
+    bool createCameraKeyframe(datamessagestructures::CameraKeyframe& kf);
+    datamessagestructures::TimeTimeline createTimeTimeline();
     void sendCameraKeyframe();
     void sendTimeTimeline();
+    void sendKeyframeBatch(bool includeCamera, bool includeTimeline);
 
     void setStatus(ParallelConnection::Status status);
     void setHostName(const std::string& hostName);
@@ -137,6 +145,11 @@ private:
 
     ParallelConnection _connection;
 
+    // The keyframe codec that all peers in the session support, 0 is the legacy encoding
+    uint32_t _keyframeCodecVersion = 0;
+    datamessagestructures::KeyframeEncoder _keyframeEncoder;
+    datamessagestructures::KeyframeDecoder _keyframeDecoder;
+
     TimeManager::CallbackHandle _timeJumpCallback = -1;
     TimeManager::CallbackHandle _timeTimelineChangeCallback = -1;
 };
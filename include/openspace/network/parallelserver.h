@@ -25,18 +25,31 @@
 #ifndef __OPENSPACE_CORE___PARALLELSERVER___H__
 #define __OPENSPACE_CORE___PARALLELSERVER___H__
 
+#include <openspace/network/outgoingmessagequeue.h>
 #include <openspace/network/parallelconnection.h>
 
 #include <openspace/util/concurrentqueue.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/io/socket/tcpsocketserver.h>
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 namespace openspace {
 
+/**
+ * The server that relays messages between the peers of a parallel session. Messages to
+ * the peers are encoded once and put into bounded per-peer queues that are written to
+ * the sockets by a fixed pool of send threads, so that a slow peer does not hold up the
+ * others. Camera keyframes that are still queued for a lagging peer are replaced by
+ * newer ones, and a peer whose queue overflows nevertheless is disconnected.
+ */
 class ParallelServer {
 public:
+    ParallelServer();
+
     void start(int port, const std::string& password,
         const std::string& changeHostPassword);
 
@@ -49,15 +62,21 @@ public:
     size_t nConnections() const;
 
 private:
-    struct Peer {
-        //Peer(size_t id_, std::string name_, ParallelConnection parallelConnection_,
-            //ParallelConnection::Status status_, std::thread )
+    struct Peer : public std::enable_shared_from_this<Peer> {
+        Peer(size_t id_, ParallelConnection parallelConnection_);
 
         size_t id;
         std::string name;
         ParallelConnection parallelConnection;
-        ParallelConnection::Status status;
+        ParallelConnection::Status status = ParallelConnection::Status::Connecting;
         std::thread thread;
+        // The newest keyframe codec that the peer supports, 0 for peers that only know
+        // the legacy encoding
+        uint32_t keyframeCodecVersion = 0;
+
+        // Messages that have not been written to the socket yet. The queue is drained
+        // by the send pool, at most one task is sending to a peer at any time
+        OutgoingMessageQueue outgoing;
     };
 
     struct PeerMessage {
@@ -76,12 +95,16 @@ private:
     void sendMessageToClients(ParallelConnection::MessageType messageType,
         const std::vector<char>& message);
 
+    void queueMessage(Peer& peer, OutgoingMessageQueue::Message message);
+    void sendQueuedMessages(std::shared_ptr<Peer> peer);
+
     void disconnect(Peer& peer);
     void setName(Peer& peer, std::string name);
     void assignHost(std::shared_ptr<Peer> newHost);
     void setToClient(Peer& peer);
     void setNConnections(size_t nConnections);
     void sendConnectionStatus(Peer& peer);
+    void updateKeyframeCodecVersion();
 
     void handleAuthentication(std::shared_ptr<Peer> peer, std::vector<char> message);
     void handleData(const Peer& peer, std::vector<char> data);
@@ -109,11 +132,17 @@ private:
     std::atomic_size_t _nConnections = 0;
     std::atomic_size_t _hostPeerId = 0;
 
+    // The newest keyframe codec version that all connected peers support
+    uint32_t _keyframeCodecVersion = 0;
+
     mutable std::mutex _hostInfoMutex;
     std::string _hostName;
     std::string _defaultHostAddress;
 
     ConcurrentQueue<PeerMessage> _incomingMessages;
+
+    /// Writes the peers' outgoing queues to their sockets
+    ThreadPool _sendPool;
 };
 
 } // namespace openspace
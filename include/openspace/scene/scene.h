@@ -45,6 +45,7 @@ namespace documentation { struct Documentation; }
 namespace scripting { struct LuaLibrary; }
 
 class SceneInitializer;
+class ThreadPool;
 
 // Notifications:
 // SceneGraphFinishedLoading
@@ -103,6 +104,19 @@ public:
      */
     void update(const UpdateData& data);
 
+    /**
+     * Sets the number of worker threads that are used to update the scene graph. If
+     * \p nThreads is 0, all nodes are updated serially on the calling thread. Otherwise,
+     * the nodes are grouped into levels such that each node is placed after its parent
+     * and all of its dependencies. The transformations of all nodes within a level are
+     * then updated in parallel, after which the renderables are updated on the calling
+     * thread in topological order. The resulting state is identical to a serial update.
+     *
+     * \param nThreads The number of worker threads used in addition to the calling
+     *        thread, or 0 to disable the parallel update
+     */
+    void setNumberOfUpdateThreads(unsigned int nThreads);
+
     /**
      * Render visible SceneGraphNodes using the provided camera.
      */
@@ -251,9 +265,26 @@ private:
 
     void sortTopologically();
 
+    /**
+     * Groups the topologically sorted nodes into levels that can be updated in parallel.
+     * The level of a node is one larger than the largest level of its parent and its
+     * dependencies, with the root node on level 0.
+     */
+    void computeUpdateLevels();
+
+    void updateSerially(const UpdateData& data);
+    void updateInParallel(const UpdateData& data);
+
     std::unique_ptr<Camera> _camera;
     std::vector<SceneGraphNode*> _topologicallySortedNodes;
     std::vector<SceneGraphNode*> _circularNodes;
+
+    // All nodes sorted by their update level. Level i consists of the nodes in the range
+    // [_levelOffsets[i], _levelOffsets[i + 1])
+    std::vector<SceneGraphNode*> _levelSortedNodes;
+    std::vector<size_t> _levelOffsets;
+    std::unique_ptr<ThreadPool> _updateThreadPool;
+
     std::unordered_map<std::string, SceneGraphNode*> _nodesByIdentifier;
     bool _dirtyNodeRegistry = false;
     SceneGraphNode _rootDummy;
@@ -95,6 +95,23 @@ public:
     void traversePreOrder(const std::function<void(SceneGraphNode*)>& fn);
     void traversePostOrder(const std::function<void(SceneGraphNode*)>& fn);
     void update(const UpdateData& data);
+
+    /**
+     * Updates the translation, rotation, and scale of this node and recomputes the
+     * cached world transformation. This function only reads the cached transformations
+     * of the parent and can thus be called concurrently for nodes that do not depend on
+     * each other. Calling #updateTransform followed by #updateRenderable is equivalent
+     * to calling #update.
+     */
+    void updateTransform(const UpdateData& data);
+
+    /**
+     * Updates the Renderable attached to this node, if one exists, using the world
+     * transformation that was computed in the last call to #updateTransform. As
+     * Renderable%s might interact with the OpenGL context, this function must only be
+     * called from the main thread.
+     */
+    void updateRenderable(const UpdateData& data);
     void render(const RenderData& data, RendererTasks& tasks);
 
     void attachChild(std::unique_ptr<SceneGraphNode> child);
@@ -136,6 +153,14 @@ public:
 
     const PerformanceRecord& performanceRecord() const;
 
+    /**
+     * Replaces the Translation, Rotation, or Scale of this node, which otherwise are
+     * only created from the dictionary passed to #createFromDictionary.
+     */
+    void setTranslation(std::unique_ptr<Translation> translation);
+    void setRotation(std::unique_ptr<Rotation> rotation);
+    void setScale(std::unique_ptr<Scale> scale);
+
     void setRenderable(std::unique_ptr<Renderable> renderable);
     const Renderable* renderable() const;
     Renderable* renderable();
@@ -0,0 +1,135 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___BOUNDED_CONCURRENT_QUEUE___H__
+#define __OPENSPACE_CORE___BOUNDED_CONCURRENT_QUEUE___H__
+
+#include <atomic>
+#include <memory>
+
+namespace openspace {
+
+/**
+ * Templated lock-free queue with a fixed capacity that supports multiple producers and
+ * multiple consumers. The queue is implemented as a ring buffer in which each cell
+ * carries a sequence number that tells producers and consumers whether the cell is ready
+ * to be written or read (see http://www.1024cores.net for the original description). In
+ * addition to single elements, a contiguous range of cells can be claimed at once with
+ * #pushBulk and #tryPopBulk, which requires only a single atomic operation per batch.
+ *
+ * The capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class BoundedConcurrentQueue {
+public:
+    explicit BoundedConcurrentQueue(size_t capacity = 1024);
+
+    BoundedConcurrentQueue(const BoundedConcurrentQueue&) = delete;
+    BoundedConcurrentQueue& operator=(const BoundedConcurrentQueue&) = delete;
+
+    /**
+     * Tries to add the \p item to the end of the queue. Returns \c false if the queue is
+     * full, in which case \p item is not modified.
+     */
+    bool tryPush(T&& item);
+    bool tryPush(const T& item);
+
+    /**
+     * Adds the \p item to the end of the queue, yielding the thread while the queue is
+     * full.
+     */
+    void push(T item);
+
+    /**
+     * Adds up to \p count items starting at \p first to the end of the queue. The items
+     * are moved out of the range. Returns the number of items that were added, which is
+     * smaller than \p count if the queue does not have enough free space.
+     */
+    template <typename Iterator>
+    size_t tryPushBulk(Iterator first, size_t count);
+
+    /**
+     * Adds all \p count items starting at \p first to the end of the queue, yielding the
+     * thread while the queue is full.
+     */
+    template <typename Iterator>
+    void pushBulk(Iterator first, size_t count);
+
+    /**
+     * Tries to remove the first element of the queue. Returns \c false if the queue is
+     * empty.
+     */
+    bool tryPop(T& item);
+
+    /**
+     * Removes up to \p maxItems elements from the front of the queue and writes them to
+     * \p out. Returns the number of elements that were removed.
+     */
+    template <typename OutputIterator>
+    size_t tryPopBulk(OutputIterator out, size_t maxItems);
+
+    /**
+     * Returns the number of elements that can be removed from the front of the queue.
+     * Elements that a producer is still writing, and all elements behind them, are not
+     * counted, so with a single consumer, a #tryPop following a non-zero result always
+     * succeeds. As other threads might modify the queue concurrently, the result is only
+     * a snapshot. The cost of this function is linear in the number of elements.
+     */
+    size_t size() const;
+
+    /**
+     * Returns \c true if the first element of the queue can not be removed, either
+     * because the queue is empty or because the element is still being written.
+     */
+    bool empty() const;
+
+    size_t capacity() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // Claims up to maxCount consecutive cells for writing and returns the first position
+    // and the number of cells that were claimed
+    size_t claimForPush(size_t maxCount, size_t& position);
+    size_t claimForPop(size_t maxCount, size_t& position);
+
+    static constexpr const size_t CacheLineSize = 64;
+
+    std::unique_ptr<Cell[]> _buffer;
+    const size_t _mask;
+
+    // The producer and consumer positions are placed on separate cache lines to avoid
+    // false sharing between them
+    alignas(CacheLineSize) std::atomic<size_t> _pushPosition = 0;
+    alignas(CacheLineSize) std::atomic<size_t> _popPosition = 0;
+};
+
+} // namespace openspace
+
+#include "boundedconcurrentqueue.inl"
+
+#endif // __OPENSPACE_CORE___BOUNDED_CONCURRENT_QUEUE___H__
@@ -0,0 +1,250 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+
+namespace openspace {
+
+namespace boundedconcurrentqueue::detail {
+
+inline size_t nextPowerOfTwo(size_t v) {
+    size_t result = 1;
+    while (result < v) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace boundedconcurrentqueue::detail
+
+template <typename T>
+BoundedConcurrentQueue<T>::BoundedConcurrentQueue(size_t capacity)
+    : _buffer(
+        std::make_unique<Cell[]>(boundedconcurrentqueue::detail::nextPowerOfTwo(
+            std::max<size_t>(capacity, 2)
+        ))
+    )
+    , _mask(boundedconcurrentqueue::detail::nextPowerOfTwo(
+        std::max<size_t>(capacity, 2)
+    ) - 1)
+{
+    for (size_t i = 0; i <= _mask; ++i) {
+        _buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::claimForPush(size_t maxCount, size_t& position) {
+    position = _pushPosition.load(std::memory_order_relaxed);
+    while (true) {
+        // Count how many consecutive cells starting at position are free. A cell is free
+        // if its sequence number is equal to the position that wants to write it
+        size_t count = 0;
+        while (count < maxCount) {
+            const Cell& cell = _buffer[(position + count) & _mask];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq != position + count) {
+                break;
+            }
+            ++count;
+        }
+
+        if (count == 0) {
+            const Cell& cell = _buffer[position & _mask];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(seq - position) < 0) {
+                // The cell still contains an element from the previous lap, so the queue
+                // is full
+                return 0;
+            }
+            // Another producer has claimed this position in the meantime
+            position = _pushPosition.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (_pushPosition.compare_exchange_weak(
+                position,
+                position + count,
+                std::memory_order_relaxed
+            ))
+        {
+            return count;
+        }
+        // On failure, position has been updated to the current value
+    }
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::claimForPop(size_t maxCount, size_t& position) {
+    position = _popPosition.load(std::memory_order_relaxed);
+    while (true) {
+        // A cell can be read if a producer has finished writing to it, in which case its
+        // sequence number is one larger than the position
+        size_t count = 0;
+        while (count < maxCount) {
+            const Cell& cell = _buffer[(position + count) & _mask];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq != position + count + 1) {
+                break;
+            }
+            ++count;
+        }
+
+        if (count == 0) {
+            const Cell& cell = _buffer[position & _mask];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(seq - (position + 1)) < 0) {
+                // The queue is empty, or the producer has not finished writing yet
+                return 0;
+            }
+            // Another consumer has claimed this position in the meantime
+            position = _popPosition.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (_popPosition.compare_exchange_weak(
+                position,
+                position + count,
+                std::memory_order_relaxed
+            ))
+        {
+            return count;
+        }
+    }
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(T&& item) {
+    size_t position;
+    if (claimForPush(1, position) == 0) {
+        return false;
+    }
+    Cell& cell = _buffer[position & _mask];
+    cell.data = std::move(item);
+    cell.sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(const T& item) {
+    T copy = item;
+    return tryPush(std::move(copy));
+}
+
+template <typename T>
+void BoundedConcurrentQueue<T>::push(T item) {
+    while (!tryPush(std::move(item))) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T>
+template <typename Iterator>
+size_t BoundedConcurrentQueue<T>::tryPushBulk(Iterator first, size_t count) {
+    size_t position;
+    const size_t claimed = claimForPush(count, position);
+    for (size_t i = 0; i < claimed; ++i) {
+        Cell& cell = _buffer[(position + i) & _mask];
+        cell.data = std::move(*first);
+        ++first;
+        cell.sequence.store(position + i + 1, std::memory_order_release);
+    }
+    return claimed;
+}
+
+template <typename T>
+template <typename Iterator>
+void BoundedConcurrentQueue<T>::pushBulk(Iterator first, size_t count) {
+    while (count > 0) {
+        const size_t pushed = tryPushBulk(first, count);
+        std::advance(first, pushed);
+        count -= pushed;
+        if (count > 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPop(T& item) {
+    size_t position;
+    if (claimForPop(1, position) == 0) {
+        return false;
+    }
+    Cell& cell = _buffer[position & _mask];
+    item = std::move(cell.data);
+    cell.data = T();
+    // Release the cell for the producer that will write it in the next lap
+    cell.sequence.store(position + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+template <typename OutputIterator>
+size_t BoundedConcurrentQueue<T>::tryPopBulk(OutputIterator out, size_t maxItems) {
+    size_t position;
+    const size_t claimed = claimForPop(maxItems, position);
+    for (size_t i = 0; i < claimed; ++i) {
+        Cell& cell = _buffer[(position + i) & _mask];
+        *out = std::move(cell.data);
+        ++out;
+        cell.data = T();
+        cell.sequence.store(position + i + _mask + 1, std::memory_order_release);
+    }
+    return claimed;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::size() const {
+    // The push position is advanced when a producer claims a cell, which happens before
+    // the element is written, so only the cells that have been published are counted
+    const size_t pop = _popPosition.load(std::memory_order_relaxed);
+    const size_t push = _pushPosition.load(std::memory_order_relaxed);
+    size_t count = 0;
+    while (static_cast<std::ptrdiff_t>(push - (pop + count)) > 0) {
+        const Cell& cell = _buffer[(pop + count) & _mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pop + count + 1) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::empty() const {
+    const size_t pop = _popPosition.load(std::memory_order_relaxed);
+    const Cell& cell = _buffer[pop & _mask];
+    return cell.sequence.load(std::memory_order_acquire) != pop + 1;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::capacity() const {
+    return _mask + 1;
+}
+
+} // namespace openspace
@@ -25,10 +25,14 @@
 #ifndef __OPENSPACE_CORE___CONCURRENT_JOB_MANAGER___H__
 #define __OPENSPACE_CORE___CONCURRENT_JOB_MANAGER___H__
 
-#include <openspace/util/concurrentqueue.h>
+#include <openspace/util/boundedconcurrentqueue.h>
 #include <openspace/util/threadpool.h>
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace openspace {
 
@@ -49,11 +53,25 @@ public:
 
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /**
+     * Removes all jobs that have finished at the time of the call and returns them in
+     * the order in which they finished.
+     */
+    std::vector<std::shared_ptr<Job<P>>> popFinishedJobs();
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
+    void pushFinishedJob(std::shared_ptr<Job<P>> job);
+
+    BoundedConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
+
+    // Finished jobs that did not fit into _finishedJobs. The number of finished jobs is
+    // not limited, so the workers never have to wait for the owner to pop them
+    std::deque<std::shared_ptr<Job<P>>> _overflowJobs;
+    std::mutex _overflowMutex;
+    std::atomic<size_t> _nOverflowJobs = 0;
+
     ThreadPool threadPool;
 };
 
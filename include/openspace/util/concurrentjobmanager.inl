@@ -24,6 +24,8 @@
 
 #include <openspace/util/job.h>
 #include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <iterator>
 
 namespace openspace {
 
@@ -36,11 +38,22 @@ template<typename P>
 void ConcurrentJobManager<P>::enqueueJob(std::shared_ptr<Job<P>> job) {
     threadPool.enqueue([this, job]() {
         job->execute();
-        std::lock_guard<std::mutex> lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
+        pushFinishedJob(job);
     });
 }
 
+template<typename P>
+void ConcurrentJobManager<P>::pushFinishedJob(std::shared_ptr<Job<P>> job) {
+    // Once jobs have overflowed, the following ones have to be added behind them to keep
+    // the order in which the jobs finished
+    if (_nOverflowJobs == 0 && _finishedJobs.tryPush(job)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflowJobs.push_back(std::move(job));
+    _nOverflowJobs = _overflowJobs.size();
+}
+
 template<typename P>
 void ConcurrentJobManager<P>::clearEnqueuedJobs() {
     threadPool.clearTasks();
@@ -48,15 +61,37 @@ void ConcurrentJobManager<P>::clearEnqueuedJobs() {
 
 template<typename P>
 std::shared_ptr<Job<P>> ConcurrentJobManager<P>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
+    ghoul_assert(numFinishedJobs() > 0, "There is no finished job to pop!");
+
+    std::shared_ptr<Job<P>> result;
+    if (_finishedJobs.tryPop(result)) {
+        return result;
+    }
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    if (!_overflowJobs.empty()) {
+        result = std::move(_overflowJobs.front());
+        _overflowJobs.pop_front();
+        _nOverflowJobs = _overflowJobs.size();
+    }
+    return result;
+}
+
+template<typename P>
+std::vector<std::shared_ptr<Job<P>>> ConcurrentJobManager<P>::popFinishedJobs() {
+    std::vector<std::shared_ptr<Job<P>>> result;
+    result.reserve(numFinishedJobs());
+    _finishedJobs.tryPopBulk(std::back_inserter(result), _finishedJobs.capacity());
 
-    std::lock_guard<std::mutex> lock(_finishedJobsMutex);
-    return _finishedJobs.pop();
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    std::move(_overflowJobs.begin(), _overflowJobs.end(), std::back_inserter(result));
+    _overflowJobs.clear();
+    _nOverflowJobs = 0;
+    return result;
 }
 
 template<typename P>
 size_t ConcurrentJobManager<P>::numFinishedJobs() const {
-    return _finishedJobs.size();
+    return _finishedJobs.size() + _nOverflowJobs;
 }
 
 } // namespace openspace
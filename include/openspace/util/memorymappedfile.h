@@ -0,0 +1,107 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
+#define __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
+
+#include <ghoul/misc/boolean.h>
+#include <cstddef>
+#include <string>
+
+namespace openspace {
+
+/**
+ * This class maps the contents of a file into the address space of the process. The
+ * mapping is established in the constructor and released in the destructor. If the file
+ * is opened as writable, it is created if it does not exist and its size is set to the
+ * requested size before it is mapped, which makes it possible to use the mapping as
+ * persistent storage that can be written to directly.
+ */
+class MemoryMappedFile {
+public:
+    BooleanType(Writable);
+
+    /**
+     * Maps the file at \p path into memory.
+     *
+     * \param path The path to the file that should be mapped
+     * \param writable If this is \c Writable::Yes, the mapping is writable and changes
+     *        are written back to the file. The file is created if it does not exist
+     * \param size If the mapping is writable and this value is bigger than 0, the file
+     *        is resized to this many bytes and the disk space for them is reserved
+     *        before it is mapped. For read-only mappings this value is ignored and the
+     *        entire file is mapped
+     *
+     * \throw ghoul::RuntimeError If the file could not be opened, resized, or mapped or
+     *        if there is not enough disk space for \p size bytes
+     */
+    explicit MemoryMappedFile(std::string path, Writable writable = Writable::No,
+        size_t size = 0);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    /// Returns a pointer to the first byte of the mapping or \c nullptr for empty files
+    std::byte* data();
+
+    /// Returns a pointer to the first byte of the mapping or \c nullptr for empty files
+    const std::byte* data() const;
+
+    /// Returns the number of bytes that are mapped
+    size_t size() const;
+
+    /// Returns the path of the file that is mapped
+    const std::string& path() const;
+
+    /// Returns \c true if the mapping was created as writable
+    bool isWritable() const;
+
+    /**
+     * Schedules all modified pages of a writable mapping to be written back to the file.
+     * Calling this function on a read-only mapping has no effect.
+     */
+    void flush();
+
+private:
+    void unmap();
+
+    std::string _path;
+    std::byte* _data = nullptr;
+    size_t _size = 0;
+    bool _isWritable = false;
+
+#ifdef WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#else
+    int _fileDescriptor = -1;
+#endif // WIN32
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
@@ -0,0 +1,190 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___SPECKCACHE___H__
+#define __OPENSPACE_CORE___SPECKCACHE___H__
+
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/speckloader.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openspace::speck {
+
+/**
+ * A columnar, read-only view of a point-cloud dataset. The dataset is either backed by a
+ * memory-mapped cache file, in which case opening it only requires validating the header
+ * and pointing the columns into the mapping, or by a Dataset that was loaded into memory
+ * directly. In both cases, each column is a contiguous array of values, so any single
+ * column can be accessed or uploaded without touching the others.
+ *
+ * The cache file consists of a fixed-size header, a table describing each column (name,
+ * type, minimum, maximum, and offset of the values), the list of textures, a string
+ * table, and finally the values of each column aligned to 64 bytes. The header also
+ * stores the size, modification time, and a checksum of the source file and a version
+ * number provided by the owner of the dataset, which are used to detect stale cache
+ * files.
+ *
+ * The columns point into the memory mapping or the owned Dataset, so a CachedDataset can
+ * be moved, but not copied.
+ */
+class CachedDataset {
+public:
+    /// The type of the values stored in a column
+    enum class ColumnType : uint32_t {
+        Float32 = 0
+    };
+
+    struct Column {
+        /// The name of the variable or an empty string for unnamed columns
+        std::string name;
+        ColumnType type = ColumnType::Float32;
+        float minimum = 0.f;
+        float maximum = 0.f;
+        /// Points to <code>nRows()</code> consecutive values
+        const float* values = nullptr;
+    };
+
+    /**
+     * Opens the cache file at the provided \p path.
+     *
+     * \throw ghoul::RuntimeError If the file could not be opened or is not a valid cache
+     *        file
+     */
+    explicit CachedDataset(const std::string& path);
+
+    /**
+     * Creates a view of the provided \p dataset, which is used if no cache file could be
+     * written.
+     */
+    explicit CachedDataset(Dataset dataset);
+
+    CachedDataset(const CachedDataset&) = delete;
+    CachedDataset& operator=(const CachedDataset&) = delete;
+    CachedDataset(CachedDataset&&) = default;
+    CachedDataset& operator=(CachedDataset&&) = default;
+
+    size_t nRows() const;
+    size_t nColumns() const;
+
+    /// Returns the column with the provided \p index, which has to be smaller than
+    /// nColumns
+    const Column& column(size_t index) const;
+
+    /// Returns the index of the column with the provided \p name or -1 if it does not
+    /// exist
+    int index(std::string_view name) const;
+
+    const std::vector<Dataset::Variable>& variables() const;
+    const std::vector<Dataset::Texture>& textures() const;
+    int textureDataIndex() const;
+    int orientationDataIndex() const;
+
+    /// The checksum of the source file, or 0 if the dataset is not backed by a file
+    uint64_t sourceChecksum() const;
+
+    /// The size of the source file, or 0 if it is unknown
+    uint64_t sourceSize() const;
+
+    /// The modification time of the source file, or 0 if it is unknown
+    int64_t sourceModificationTime() const;
+
+    /// The version number that was passed to saveCache
+    uint32_t datasetVersion() const;
+
+private:
+    void initializeFromFile();
+
+    std::optional<MemoryMappedFile> _file;
+    std::optional<Dataset> _dataset;
+
+    size_t _nRows = 0;
+    std::vector<Column> _columns;
+    std::vector<Dataset::Variable> _variables;
+    std::vector<Dataset::Texture> _textures;
+    int _textureDataIndex = -1;
+    int _orientationDataIndex = -1;
+    uint64_t _sourceChecksum = 0;
+    uint64_t _sourceSize = 0;
+    int64_t _sourceModificationTime = 0;
+    uint32_t _datasetVersion = 0;
+};
+
+/**
+ * Writes the \p dataset as a cache file to \p path. The file is first written under a
+ * temporary name and then moved into place, so a partially written file is never
+ * mistaken for a valid cache.
+ *
+ * \param dataset The dataset that is written
+ * \param path The path of the cache file
+ * \param sourceChecksum The checksum of the file the dataset was loaded from
+ * \param datasetVersion A version number that the owner of the dataset can use to
+ *        invalidate caches if the way the dataset is processed changes
+ * \param sourceSize The size of the file the dataset was loaded from
+ * \param sourceModificationTime The modification time of the file the dataset was
+ *        loaded from
+ *
+ * \throw ghoul::RuntimeError If the file could not be written
+ */
+void saveCache(const Dataset& dataset, const std::string& path, uint64_t sourceChecksum,
+    uint32_t datasetVersion, uint64_t sourceSize = 0, int64_t sourceModificationTime = 0);
+
+/**
+ * Computes the checksum of the file at \p path that is stored in the cache files.
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened
+ */
+uint64_t fileChecksum(const std::string& path);
+
+/**
+ * Loads the Speck file at \p path through the persistent cache of the CacheManager. If
+ * a cache file exists that was created from the same source file and with the same
+ * \p datasetVersion, it is opened directly. Otherwise the Speck file is loaded, the
+ * optional \p preprocess function is applied to the dataset, and the result is written
+ * to the cache. The source file is only hashed if its size or modification time differ
+ * from the ones stored in the cache file.
+ *
+ * \param path The path to the Speck file
+ * \param cacheInformation Distinguishes the cache files of different users of the same
+ *        Speck file that process the dataset differently
+ * \param datasetVersion The version number of the processing done by the caller
+ * \param skipAllZeroRows Whether rows containing only zeros are removed
+ * \param preprocess A function that is applied to the dataset before it is cached
+ * \return The cached dataset
+ *
+ * \throw ghoul::RuntimeError If the Speck file could not be loaded
+ */
+std::unique_ptr<CachedDataset> loadCachedFile(const std::string& path,
+    const std::string& cacheInformation, uint32_t datasetVersion,
+    SkipAllZeroRows skipAllZeroRows = SkipAllZeroRows::No,
+    const std::function<void(Dataset&)>& preprocess = {});
+
+} // namespace openspace::speck
+
+#endif // __OPENSPACE_CORE___SPECKCACHE___H__
@@ -0,0 +1,128 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___SPECKLOADER___H__
+#define __OPENSPACE_CORE___SPECKLOADER___H__
+
+#include <ghoul/misc/boolean.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openspace::speck {
+
+/**
+ * The contents of a Speck file. The header information is stored as it was read from the
+ * file, with the exception that all indices are converted into columns of the data
+ * table, which means that they include the three position values at the beginning of
+ * each row. The values themselves are stored column by column.
+ */
+struct Dataset {
+    struct Variable {
+        /// The column in which the (first) value of this variable is stored
+        int index;
+        std::string name;
+    };
+
+    struct Texture {
+        int index;
+        std::string file;
+    };
+
+    /// All 'datavar' entries in the order in which they appear in the file
+    std::vector<Variable> variables;
+
+    /// All 'texture' entries in the order in which they appear in the file
+    std::vector<Texture> textures;
+
+    /// The column referenced by the 'texturevar' entry or -1 if there is none
+    int textureDataIndex = -1;
+
+    /// The column referenced by the 'polyorivar' entry or -1 if there is none
+    int orientationDataIndex = -1;
+
+    /// The number of values in each row, including the x, y, z position
+    int nValuesPerRow = 3;
+
+    /// The data values, <code>columns[i][j]</code> is the i-th value of row j
+    std::vector<std::vector<float>> columns;
+
+    /// Returns the number of rows in the data table
+    size_t nRows() const;
+
+    /**
+     * Returns the column of the variable with the provided \p name, or -1 if no variable
+     * with that name exists.
+     */
+    int index(std::string_view name) const;
+
+    /**
+     * Returns all values in row-major order, which is the layout that is used by the
+     * point-cloud renderables to create their vertex buffers.
+     */
+    std::vector<float> interleaved() const;
+};
+
+BooleanType(SkipAllZeroRows);
+
+/**
+ * Loads the Speck file at the provided \p path. The file is memory mapped and the data
+ * section is split into chunks that are parsed in parallel. Empty lines and comment
+ * lines in the data section are skipped, values that are missing at the end of a row are
+ * set to 0.
+ *
+ * \param path The path to the Speck file
+ * \param skipAllZeroRows If this is \c Yes, rows in which all values are 0 are removed
+ * \return The contents of the Speck file
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened
+ */
+Dataset loadFile(const std::string& path,
+    SkipAllZeroRows skipAllZeroRows = SkipAllZeroRows::No);
+
+/**
+ * Parses the contents of a Speck file that is already available in memory. See
+ * loadFile for details.
+ */
+Dataset parse(std::string_view contents,
+    SkipAllZeroRows skipAllZeroRows = SkipAllZeroRows::No);
+
+/**
+ * Returns the next line of \p buffer without the line ending and advances \p buffer to
+ * the beginning of the following line. Both \\n and \\r\\n line endings are supported.
+ */
+std::string_view nextLine(std::string_view& buffer);
+
+/**
+ * Parses up to \p nValues whitespace-separated floating point values from the
+ * \p line into \p values. Parsing stops at the end of the line, at the first comment
+ * character, or at the first token that is not a number.
+ *
+ * \return The number of values that were parsed
+ */
+int parseValues(std::string_view line, float* values, int nValues);
+
+} // namespace openspace::speck
+
+#endif // __OPENSPACE_CORE___SPECKLOADER___H__
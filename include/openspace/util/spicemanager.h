@@ -30,6 +30,7 @@
 #include <ghoul/misc/exception.h>
 #include <array>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <set>
@@ -1057,6 +1058,11 @@ private:
     /// The last assigned kernel-id, used to determine the next free kernel id
     KernelHandle _lastAssignedKernel = KernelHandle(0);
 
+    /// The CSPICE library is not thread-safe and SPICE-backed nodes are updated from
+    /// worker threads during a parallel scene update, so every member function that calls
+    /// into CSPICE or reads the loaded kernels and coverage intervals holds this mutex
+    mutable std::recursive_mutex _spiceMutex;
+
     static SpiceManager* _instance;
 };
 
@@ -44,6 +44,14 @@ protected:
     friend class SyncEngine;
 
     virtual void preSync(bool /*isMaster*/) {};
+
+    /**
+     * Returns whether this Syncable has changed since it was last encoded. Syncables that
+     * have not changed are left out of the SyncEngine's delta frames. The default
+     * implementation conservatively reports a change every frame.
+     */
+    virtual bool hasChanged() { return true; };
+
     virtual void encode(SyncBuffer* /*syncBuffer*/) = 0;
     virtual void decode(SyncBuffer* /*syncBuffer*/) = 0;
     virtual void postSync(bool /*isMaster*/) {};
@@ -31,6 +31,10 @@
 
 namespace openspace {
 
+/**
+ * Binary buffer that Syncables are encoded into and decoded from. The buffer starts out
+ * with a capacity of <code>n</code> bytes and grows as needed while encoding.
+ */
 class SyncBuffer {
 public:
     SyncBuffer(size_t n);
@@ -58,9 +62,17 @@ public:
     //void read();
 
     void setData(std::vector<char> data);
+
+    /**
+     * Moves the encoded bytes out of the buffer. The buffer has to be #reset before it
+     * is used again.
+     */
     std::vector<char> data();
 
 private:
+    /// Grows the data stream so that \p size more bytes can be encoded
+    void reserveForEncode(size_t size);
+
     size_t _n;
     size_t _encodeOffset = 0;
     size_t _decodeOffset = 0;
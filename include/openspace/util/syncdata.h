@@ -76,12 +76,15 @@ public:
     const T& data() const;
 
 protected:
+    virtual bool hasChanged() override;
     virtual void encode(SyncBuffer* syncBuffer) override;
     virtual void decode(SyncBuffer* syncBuffer) override;
     virtual void postSync(bool isMaster) override;
 
     T _data;
     T _doubleBufferedData;
+    T _lastEncodedData;
+    bool _hasEncoded = false;
     std::mutex _mutex;
 };
 
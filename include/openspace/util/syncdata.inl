@@ -23,6 +23,7 @@
  ****************************************************************************************/
 
 #include <openspace/util/syncbuffer.h>
+#include <cstring>
 
 namespace openspace {
 
@@ -58,10 +59,23 @@ const T& SyncData<T>::data() const {
     return _data;
 }
 
+template<class T>
+bool SyncData<T>::hasChanged() {
+    // The SyncBuffer transfers the raw bytes of T, so comparing those bytes is exactly
+    // the question of whether the slaves would receive something different
+    _mutex.lock();
+    const bool changed = !_hasEncoded ||
+                         std::memcmp(&_data, &_lastEncodedData, sizeof(T)) != 0;
+    _mutex.unlock();
+    return changed;
+}
+
 template<class T>
 void SyncData<T>::encode(SyncBuffer* syncBuffer) {
     _mutex.lock();
     syncBuffer->encode(_data);
+    _lastEncodedData = _data;
+    _hasEncoded = true;
     _mutex.unlock();
 }
 
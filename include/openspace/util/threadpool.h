@@ -25,50 +25,122 @@
 #ifndef __OPENSPACE_CORE___THREAD_POOL___H__
 #define __OPENSPACE_CORE___THREAD_POOL___H__
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
-// Implementation based on http://progsch.net/wordpress/?p=81
-
 namespace openspace {
 
-class ThreadPool;
-
-class Worker {
-public:
-    Worker(ThreadPool& p);
-    void operator()();
-
-private:
-    ThreadPool& pool;
-};
-
+/**
+ * A thread pool in which each worker thread owns a separate task queue. Tasks that are
+ * enqueued from outside the pool are distributed round-robin over the workers' queues,
+ * tasks that are enqueued from within a worker thread are placed in that worker's own
+ * queue. A worker whose queue is empty steals tasks from the other workers' queues, so
+ * that the workers only contend for a lock when they run out of work.
+ *
+ * Each queue is split by Priority; higher priority tasks are always executed before
+ * lower priority tasks, regardless of which worker's queue they were placed in. Within
+ * a priority, a worker executes its own tasks in the order they were enqueued, while
+ * stealing happens from the back of other queues.
+ */
 class ThreadPool {
 public:
+    enum class Priority : int {
+        Low = 0,
+        Normal,
+        High
+    };
+
     ThreadPool(size_t numThreads);
     ThreadPool(const ThreadPool& toCopy);
     ~ThreadPool();
 
+    /**
+     * Adds the task \p f with Priority::Normal to the pool.
+     */
     void enqueue(std::function<void()> f);
-    void clearTasks();
-
-private:
-    friend class Worker;
-
-    std::vector<std::thread> workers;
 
-    std::deque<std::function<void()>> tasks;
+    /**
+     * Adds the task \p f with the provided \p priority to the pool.
+     */
+    void enqueue(std::function<void()> f, Priority priority);
+
+    /**
+     * Adds the task \p f to the pool and returns a future that will contain the result of
+     * \p f, or the exception that was thrown by it.
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F f,
+        Priority priority = Priority::Normal);
+
+    /**
+     * Adds the task \p f to the pool. After \p f has finished, the \p continuation is
+     * called with the result of \p f (or without arguments if \p f returns
+     * <code>void</code>). The continuation is executed next on the same worker thread to
+     * benefit from the data \p f has just touched. The returned future contains the
+     * result of the \p continuation, or the exception that was thrown by either function.
+     */
+    template <typename F, typename C>
+    auto submitWithContinuation(F f, C continuation,
+        Priority priority = Priority::Normal);
+
+    /**
+     * Calls \p f for each index in the range [\p begin, \p end) and returns after all
+     * calls have finished. The range is split into chunks of \p grainSize indices that
+     * are executed by the worker threads and the calling thread. As the calling thread
+     * participates, this function can also be called from within one of the worker
+     * threads. \p f must not throw an exception.
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F f, size_t grainSize = 1);
+
+    /**
+     * Removes all tasks that have not yet been started from the pool.
+     */
+    void clearTasks();
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
+    /**
+     * Returns the number of worker threads of this pool.
+     */
+    size_t numThreads() const;
 
-    bool stop;
+private:
+    static constexpr const int NumPriorities = 3;
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::array<std::deque<std::function<void()>>, NumPriorities> tasks;
+        // The number of tasks per priority, which can be read without acquiring the
+        // mutex to skip empty queues while looking for work
+        std::array<std::atomic<size_t>, NumPriorities> sizes = {};
+    };
+
+    void workerLoop(size_t index);
+    void push(std::function<void()> task, Priority priority, bool runNext);
+    bool pop(size_t index, std::function<void()>& task);
+
+    std::vector<std::thread> _workers;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+
+    std::atomic<size_t> _nextQueue = 0;
+    std::atomic<size_t> _nPendingTasks = 0;
+    std::atomic<size_t> _nSleepingWorkers = 0;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+
+    std::atomic_bool _stop = false;
 };
 
 } // namespace openspace
 
+#include "threadpool.inl"
+
 #endif // __OPENSPACE_CORE___THREAD_POOL___H__
@@ -0,0 +1,158 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <algorithm>
+
+namespace openspace {
+
+namespace threadpool::detail {
+
+template <typename C, typename R>
+struct ContinuationResult {
+    using type = std::invoke_result_t<C, R>;
+};
+
+template <typename C>
+struct ContinuationResult<C, void> {
+    using type = std::invoke_result_t<C>;
+};
+
+template <typename T, typename F, typename... Args>
+void fulfill(std::promise<T>& promise, F& f, Args&&... args) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            f(std::forward<Args>(args)...);
+            promise.set_value();
+        }
+        else {
+            promise.set_value(f(std::forward<Args>(args)...));
+        }
+    }
+    catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+} // namespace threadpool::detail
+
+template <typename F>
+std::future<std::invoke_result_t<F>> ThreadPool::submit(F f, Priority priority) {
+    using R = std::invoke_result_t<F>;
+
+    // std::function requires a copyable callable, so the task has to be shared
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+    std::future<R> result = task->get_future();
+    push([task]() { (*task)(); }, priority, false);
+    return result;
+}
+
+template <typename F, typename C>
+auto ThreadPool::submitWithContinuation(F f, C continuation, Priority priority) {
+    using R = std::invoke_result_t<F>;
+    using CR = typename threadpool::detail::ContinuationResult<C, R>::type;
+
+    auto promise = std::make_shared<std::promise<CR>>();
+    std::future<CR> result = promise->get_future();
+
+    push(
+        [this, f = std::move(f), c = std::move(continuation), promise, priority]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    f();
+                    push(
+                        [c, promise]() mutable {
+                            threadpool::detail::fulfill(*promise, c);
+                        },
+                        priority,
+                        true
+                    );
+                }
+                else {
+                    auto value = std::make_shared<R>(f());
+                    push(
+                        [c, promise, value]() mutable {
+                            using namespace threadpool::detail;
+                            fulfill(*promise, c, std::move(*value));
+                        },
+                        priority,
+                        true
+                    );
+                }
+            }
+            catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        },
+        priority,
+        false
+    );
+    return result;
+}
+
+template <typename F>
+void ThreadPool::parallelFor(size_t begin, size_t end, F f, size_t grainSize) {
+    if (begin >= end) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t nChunks = (end - begin + grainSize - 1) / grainSize;
+
+    struct State {
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic<size_t> nFinishedChunks = 0;
+    };
+    // The helper tasks might only be started after this function has returned, so the
+    // shared state has to outlive this stack frame. Such a late helper will not be able
+    // to claim a chunk and thus never touches the function
+    auto state = std::make_shared<State>();
+
+    auto runChunks = [state, begin, end, grainSize, nChunks, &f]() {
+        while (true) {
+            const size_t chunk = state->nextChunk.fetch_add(1);
+            if (chunk >= nChunks) {
+                return;
+            }
+            const size_t first = begin + chunk * grainSize;
+            const size_t last = std::min(first + grainSize, end);
+            for (size_t i = first; i < last; ++i) {
+                f(i);
+            }
+            state->nFinishedChunks.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    const size_t nHelpers = std::min(_workers.size(), nChunks - 1);
+    for (size_t i = 0; i < nHelpers; ++i) {
+        push(runChunks, Priority::High, false);
+    }
+    runChunks();
+
+    // All chunks have been claimed at this point, the remaining ones are being executed
+    // by threads that are actively running, so we only have to wait for them
+    while (state->nFinishedChunks.load(std::memory_order_acquire) < nChunks) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace openspace
@@ -31,7 +31,6 @@
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/util/updatestructures.h>
 #include <openspace/rendering/renderengine.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/misc/crc32.h>
 #include <ghoul/misc/templatefactory.h>
@@ -627,7 +626,8 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 }
 
 bool RenderableBillboardsCloud::isReady() const {
-    return ((_program != nullptr) && (!_fullData.empty())) || (!_labelData.empty());
+    return ((_program != nullptr) && _dataset && (_dataset->nRows() > 0)) ||
+           (!_labelData.empty());
 }
 
 void RenderableBillboardsCloud::initialize() {
@@ -800,9 +800,7 @@ void RenderableBillboardsCloud::renderBillboards(const RenderData& data,
     _program->setUniform(_uniformCache.hasColormap, _hasColorMapFile);
 
     glBindVertexArray(_vao);
-    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(
-        _fullData.size() / _nValuesPerAstronomicalObject
-    );
+    const GLsizei nAstronomicalObjects = static_cast<GLsizei>(_dataset->nRows());
     glDrawArrays(GL_POINTS, 0, nAstronomicalObjects);
 
     glBindVertexArray(0);
@@ -947,7 +945,7 @@ void RenderableBillboardsCloud::render(const RenderData& data, RendererTasks&) {
     }
     glm::dvec3 orthoUp = glm::normalize(glm::cross(cameraViewDirectionWorld, orthoRight));
 
-    if (_hasSpeckFile) {
+    if (_hasSpeckFile && _dataset) {
         renderBillboards(
             data,
             modelMatrix,
@@ -996,8 +994,7 @@ void RenderableBillboardsCloud::update(const UpdateData&) {
         GLint positionAttrib = _program->attributeLocation("in_position");
 
         if (_hasColorMapFile) {
-            /*const size_t nAstronomicalObjects = _fullData.size() /
-            _nValuesPerAstronomicalObject;
+            /*const size_t nAstronomicalObjects = _dataset->nRows();
             const size_t nValues = _slicedData.size() / nAstronomicalObjects;
             GLsizei stride = static_cast<GLsizei>(sizeof(float) * nValues);*/
 
@@ -1083,171 +1080,35 @@ bool RenderableBillboardsCloud::loadSpeckData() {
     if (!_hasSpeckFile) {
         return true;
     }
-    bool success = true;
-    const std::string& cachedFile = FileSys.cacheManager()->cachedFilename(
-        ghoul::filesystem::File(_speckFile),
-        "RenderableDUMeshes|" + identifier(),
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-
-    const bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format(
-            "Cached file '{}' used for Speck file '{}'",
-            cachedFile, _speckFile
-        ));
 
-        success = loadCachedFile(cachedFile);
-        if (success) {
-            return true;
-        }
-        else {
-            FileSys.cacheManager()->removeCacheFile(_speckFile);
-            // Intentional fall-through to the 'else' to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Speck file '{}' not found", _speckFile));
+    try {
+        _dataset = speck::loadCachedFile(
+            _speckFile,
+            "RenderableDUMeshes|" + identifier(),
+            CurrentCacheVersion
+        );
     }
-    LINFO(fmt::format("Loading Speck file '{}'", _speckFile));
-
-    success = readSpeckFile();
-    if (!success) {
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
         return false;
     }
 
-    success &= saveCachedFile(cachedFile);
-    return success;
+    for (const speck::Dataset::Variable& variable : _dataset->variables()) {
+        // The position map stores the index into the Speck file's variables, which does
+        // not include the X Y Z position
+        _variableDataPositionMap.insert({ variable.name, variable.index - 3 });
+    }
+    return true;
 }
 
 bool RenderableBillboardsCloud::loadLabelData() {
     if (_labelFile.empty()) {
         return true;
     }
-    bool success = true;
-    // I disabled the cache as it didn't work on Mac --- abock
-    const std::string& cachedFile = FileSys.cacheManager()->cachedFilename(
-        ghoul::filesystem::File(_labelFile),
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-    if (!_hasSpeckFile && !_hasColorMapFile) {
-        success = true;
-    }
-    const bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format(
-            "Cached file '{}' used for Label file '{}'",
-            cachedFile, _labelFile
-        ));
-
-        success &= loadCachedFile(cachedFile);
-        if (!success) {
-            FileSys.cacheManager()->removeCacheFile(_labelFile);
-            // Intentional fall-through to the 'else' to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Label file '{}' not found", _labelFile));
-        LINFO(fmt::format("Loading Label file '{}'", _labelFile));
-
-        success &= readLabelFile();
-        if (!success) {
-            return false;
-        }
-    }
-
-    return success;
-}
-
-bool RenderableBillboardsCloud::readSpeckFile() {
-    std::ifstream file(_speckFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _speckFile));
-        return false;
-    }
-
-    _nValuesPerAstronomicalObject = 0;
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture" &&
-            line.substr(0, 10) != "polyorivar" &&
-            line.substr(0, 10) != "maxcomment")
-        {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            file.seekg(position);
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy; // command
-            str >> _nValuesPerAstronomicalObject; // variable index
-            dummy.clear();
-            str >> dummy; // variable name
-
-            _variableDataPositionMap.insert({ dummy, _nValuesPerAstronomicalObject });
-
-            // We want the number, but the index is 0 based
-            _nValuesPerAstronomicalObject += 1;
-        }
-    }
-
-    _nValuesPerAstronomicalObject += 3; // X Y Z are not counted in the Speck file indices
-
-    do {
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
-        std::getline(file, line);
 
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        if (line.empty()) {
-            continue;
-        }
-
-        std::stringstream str(line);
-
-        for (int i = 0; i < _nValuesPerAstronomicalObject; ++i) {
-            str >> values[i];
-        }
-
-        _fullData.insert(_fullData.end(), values.begin(), values.end());
-    } while (!file.eof());
-
-    return true;
+    // The label data is not cached as the cache didn't work on Mac --- abock
+    LINFO(fmt::format("Loading Label file '{}'", _labelFile));
+    return readLabelFile();
 }
 
 bool RenderableBillboardsCloud::readColorMapFile() {
@@ -1345,8 +1206,6 @@ bool RenderableBillboardsCloud::readLabelFile() {
 
 
     do {
-        std::vector<float> values(_nValuesPerAstronomicalObject);
-
         std::getline(file, line);
 
         // Guard against wrong line endings (copying files from Windows to Mac) causes
@@ -1391,105 +1250,17 @@ bool RenderableBillboardsCloud::readLabelFile() {
     return true;
 }
 
-bool RenderableBillboardsCloud::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
-        return false;
-    }
-    int8_t version = 0;
-    fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-    if (version != CurrentCacheVersion) {
-        LINFO("The format of the cached file has changed: deleting old cache");
-        fileStream.close();
-        FileSys.deleteFile(file);
-        return false;
-    }
-
-    int32_t nValues = 0;
-    fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-    fileStream.read(
-        reinterpret_cast<char*>(&_nValuesPerAstronomicalObject),
-        sizeof(int32_t)
-    );
-
-    _fullData.resize(nValues);
-    fileStream.read(
-        reinterpret_cast<char*>(&_fullData[0]),
-        nValues * sizeof(_fullData[0])
-    );
-
-    if (_hasColorMapFile) {
-        int32_t nItems = 0;
-        fileStream.read(reinterpret_cast<char*>(&nItems), sizeof(int32_t));
-
-        for (int i = 0; i < nItems; ++i) {
-            int32_t keySize = 0;
-            fileStream.read(reinterpret_cast<char*>(&keySize), sizeof(int32_t));
-            std::vector<char> buffer(keySize);
-            fileStream.read(buffer.data(), keySize);
-
-            std::string key(buffer.begin(), buffer.end());
-            int32_t value = 0;
-            fileStream.read(reinterpret_cast<char*>(&value), sizeof(int32_t));
-
-            _variableDataPositionMap.insert({ key, value });
-        }
-    }
-
-    bool success = fileStream.good();
-    return success;
-}
-
-bool RenderableBillboardsCloud::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
-        return false;
-    }
-    fileStream.write(reinterpret_cast<const char*>(&CurrentCacheVersion), sizeof(int8_t));
-
-    int32_t nValues = static_cast<int32_t>(_fullData.size());
-    if (nValues == 0) {
-        LERROR("Error writing cache: No values were loaded");
-        return false;
-    }
-    fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-    int32_t nValuesPerAstronomicalObject = static_cast<int32_t>(
-        _nValuesPerAstronomicalObject
-    );
-    fileStream.write(
-        reinterpret_cast<const char*>(&nValuesPerAstronomicalObject),
-        sizeof(int32_t)
-    );
-
-    size_t nBytes = nValues * sizeof(_fullData[0]);
-    fileStream.write(reinterpret_cast<const char*>(&_fullData[0]), nBytes);
-
-    if (_hasColorMapFile) {
-        int32_t nItems = static_cast<int32_t>(_variableDataPositionMap.size());
-        fileStream.write(reinterpret_cast<const char*>(&nItems), sizeof(int32_t));
-
-        for (const std::pair<const std::string, int>& pair : _variableDataPositionMap) {
-            int32_t keySize = static_cast<int32_t>(pair.first.size());
-            fileStream.write(reinterpret_cast<const char*>(&keySize), sizeof(int32_t));
-            fileStream.write(pair.first.data(), keySize);
-            int32_t value = static_cast<int32_t>(pair.second);
-            fileStream.write(reinterpret_cast<const char*>(&value), sizeof(int32_t));
-        }
-    }
-
-    return fileStream.good();
-}
-
 void RenderableBillboardsCloud::createDataSlice() {
     _slicedData.clear();
+    if (!_dataset) {
+        return;
+    }
+
     if (_hasColorMapFile) {
-        _slicedData.reserve(8 * (_fullData.size() / _nValuesPerAstronomicalObject));
+        _slicedData.reserve(8 * _dataset->nRows());
     }
     else {
-        _slicedData.reserve(4 * (_fullData.size() / _nValuesPerAstronomicalObject));
+        _slicedData.reserve(4 * _dataset->nRows());
     }
 
     // Generate the color bins for the colomap
@@ -1507,12 +1278,20 @@ void RenderableBillboardsCloud::createDataSlice() {
         }
     }
 
+    // Only the position and the color variable columns are accessed
+    const float* x = _dataset->column(0).values;
+    const float* y = _dataset->column(1).values;
+    const float* z = _dataset->column(2).values;
+    const float* colorVariable = _hasColorMapFile ?
+        _dataset->column(3 + colorMapInUse).values :
+        nullptr;
+
     float biggestCoord = -1.0f;
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerAstronomicalObject) {
+    for (size_t i = 0; i < _dataset->nRows(); ++i) {
         glm::dvec4 transformedPos = _transformationMatrix * glm::dvec4(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2],
+            x[i],
+            y[i],
+            z[i],
             1.0
         );
         glm::vec4 position(glm::vec3(transformedPos), static_cast<float>(_unit));
@@ -1526,7 +1305,7 @@ void RenderableBillboardsCloud::createDataSlice() {
             // Note: the first color in the colormap file
             // is the outliers color.
             glm::vec4 itemColor;
-            float variableColor = _fullData[i + 3 + colorMapInUse];
+            float variableColor = colorVariable[i];
             int c = static_cast<int>(colorBins.size() - 1);
             while (variableColor < colorBins[c]) {
                 --c;
@@ -27,6 +27,8 @@
 #include <modules/digitaluniverse/digitaluniversemodule.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/speckloader.h>
 #include <openspace/util/updatestructures.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
@@ -44,6 +46,7 @@
 #include <array>
 #include <fstream>
 #include <cstdint>
+#include <memory>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableDUMeshes";
@@ -693,40 +696,31 @@ bool RenderableDUMeshes::loadData() {
 }
 
 bool RenderableDUMeshes::readSpeckFile() {
-    std::ifstream file(_speckFile);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _speckFile));
+    std::unique_ptr<MemoryMappedFile> file;
+    try {
+        file = std::make_unique<MemoryMappedFile>(_speckFile);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
         return false;
     }
+    std::string_view buffer(reinterpret_cast<const char*>(file->data()), file->size());
 
     int meshIndex = 0;
 
     // The beginning of the speck file has a header that either contains comments
     // (signaled by a preceding '#') or information about the structure of the file
     // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        if (file.eof()) {
-            break;
-        }
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
+    while (!buffer.empty()) {
+        // Wrong line endings (copying files from Windows to Mac) are handled by nextLine
+        std::string_view line = speck::nextLine(buffer);
 
         if (line.empty() || line[0] == '#') {
             continue;
         }
 
         if (line.substr(0, 4) != "mesh") {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            file.seekg(position);
+            // we read a line that doesn't belong to the header
             break;
         }
 
@@ -736,7 +730,7 @@ bool RenderableDUMeshes::readSpeckFile() {
             // where textnum is the index of the texture;
             // colorindex is the index of the color for the mesh
             // and style is solid, wire or point (for now we support only wire)
-            std::stringstream str(line);
+            std::stringstream str{ std::string(line) };
 
             RenderingMesh mesh;
             mesh.meshIndex = meshIndex;
@@ -775,34 +769,29 @@ bool RenderableDUMeshes::readSpeckFile() {
                 str >> dummy;
             } while (dummy != "{");
 
-            std::getline(file, line);
-            std::stringstream dim(line);
+            std::stringstream dim{ std::string(speck::nextLine(buffer)) };
             dim >> mesh.numU; // numU
             dim >> mesh.numV; // numV
 
             // We can now read the vertices data:
+            mesh.vertices.reserve(static_cast<size_t>(mesh.numU * mesh.numV) * 7);
             for (int l = 0; l < mesh.numU * mesh.numV; ++l) {
-                std::getline(file, line);
+                line = speck::nextLine(buffer);
                 if (line.substr(0, 1) != "}") {
-                    std::stringstream lineData(line);
-                    for (int i = 0; i < 7; ++i) {
-                        GLfloat value;
-                        lineData >> value;
-                        bool errorReading = lineData.rdstate() & std::ifstream::failbit;
-                        if (!errorReading) {
-                            mesh.vertices.push_back(value);
-                        }
-                        else {
-                            break;
-                        }
-                    }
+                    std::array<GLfloat, 7> values;
+                    const int n = speck::parseValues(line, values.data(), 7);
+                    mesh.vertices.insert(
+                        mesh.vertices.end(),
+                        values.begin(),
+                        values.begin() + n
+                    );
                 }
                 else {
                     break;
                 }
             }
 
-            std::getline(file, line);
+            line = speck::nextLine(buffer);
             if (line.substr(0, 1) == "}") {
                 _renderingMeshesMap.insert({ meshIndex++, mesh });
             }
@@ -32,6 +32,7 @@
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/vector/vec3property.h>
+#include <openspace/util/speckcache.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
 
@@ -77,10 +78,7 @@ private:
     void createDataSlice();
 
     bool loadData();
-    bool readSpeckFile();
     bool readColorMapFile();
-    bool loadCachedFile(const std::string& file);
-    bool saveCachedFile(const std::string& file) const;
 
     bool _dataIsDirty = true;
     bool _hasSpriteTexture = false;
@@ -104,11 +102,9 @@ private:
     Unit _unit = Parsec;
 
     std::vector<double> _slicedData;
-    std::vector<float> _fullData;
+    std::unique_ptr<speck::CachedDataset> _dataset;
     std::vector<glm::vec4> _colorMapData;
 
-    int _nValuesPerAstronomicalObject = 0;
-
     GLuint _vao = 0;
     GLuint _vbo = 0;
 };
@@ -25,6 +25,7 @@
 #include <modules/fieldlinessequence/rendering/renderablefieldlinessequence.h>
 
 #include <modules/fieldlinessequence/fieldlinessequencemodule.h>
+#include <modules/fieldlinessequence/util/commons.h>
 #include <modules/fieldlinessequence/util/kameleonfieldlinehelper.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
@@ -32,14 +33,18 @@
 #include <openspace/interaction/orbitalnavigator.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scene.h>
+#include <openspace/util/job.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
-#include <thread>
+#include <limits>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableFieldlinesSequence";
@@ -70,6 +75,9 @@ namespace {
     constexpr const char* KeyJsonScalingFactor = "ScaleToMeters";
     // [BOOLEAN] If value False => Load in initializing step and store in RAM
     constexpr const char* KeyOslfsLoadAtRuntime = "LoadAtRuntime";
+    // [INT] Number of decoded states that are kept around the active one when loading
+    // states at runtime
+    constexpr const char* KeyOslfsPrefetchDepth = "PrefetchDepth";
 
     // ---------------------------- OPTIONAL MODFILE KEYS  ---------------------------- //
     // [STRING ARRAY] Values should be paths to .txt files
@@ -87,6 +95,13 @@ namespace {
     constexpr const char* ValueInputFileTypeJson = "json";
     constexpr const char* ValueInputFileTypeOsfls = "osfls";
 
+    // ------------------------------ STREAMING CONSTANTS ----------------------------- //
+    constexpr const int DefaultPrefetchDepth = 4;
+    constexpr const size_t NumStateLoaderThreads = 2;
+    // States that become active within this many seconds of wall-clock time, at the
+    // current delta time, are prefetched
+    constexpr const double PrefetchHorizon = 2.0;
+
     // --------------------------------- Property Info -------------------------------- //
     constexpr openspace::properties::Property::PropertyInfo ColorMethodInfo = {
         "colorMethod",
@@ -213,6 +228,27 @@ namespace {
         "Jump to Start Of Sequence",
         "Performs a time jump to the start of the sequence."
     };
+    constexpr openspace::properties::Property::PropertyInfo StreamingMemoryCapInfo = {
+        "streamingMemoryCap",
+        "Memory Cap (MB)",
+        "Maximum amount of memory, in megabytes, used by the states that are prefetched "
+        "when loading states at runtime. At least the active state is always loaded."
+    };
+    constexpr openspace::properties::Property::PropertyInfo StreamingMemoryUsageInfo = {
+        "streamingMemoryUsage",
+        "Memory Usage (MB)",
+        "Amount of memory, in megabytes, currently used by the prefetched states."
+    };
+    constexpr openspace::properties::Property::PropertyInfo StreamingHitsInfo = {
+        "streamingHits",
+        "Prefetch Hits",
+        "Number of times the state for a new trigger time had already been loaded."
+    };
+    constexpr openspace::properties::Property::PropertyInfo StreamingMissesInfo = {
+        "streamingMisses",
+        "Prefetch Misses",
+        "Number of times the state for a new trigger time had to be waited for."
+    };
 
     enum class SourceFileType : int {
         Cdf = 0,
@@ -234,11 +270,57 @@ namespace {
         }
         return tmp;
     }
+
+    size_t stateMemoryUsage(const openspace::FieldlinesState& state) {
+        size_t nBytes = state.vertexPositions().size() * sizeof(glm::vec3) +
+                        state.lineStart().size() * sizeof(GLint) +
+                        state.lineCount().size() * sizeof(GLsizei);
+        // Memory mapped states only occupy this much once all pages have been touched
+        nBytes += state.nExtraQuantities() * state.vertexPositions().size() *
+                  sizeof(float);
+        return nBytes;
+    }
 } // namespace
 
 namespace openspace {
 using namespace properties;
 
+// Decodes a single .osfls state on one of the loader threads. A job that is cancelled
+// before it has started does not touch the disk and produces no state
+struct RenderableFieldlinesSequence::StateLoadJob
+    : public Job<RenderableFieldlinesSequence::LoadedState>
+{
+    StateLoadJob(int index, std::string path) : _path(std::move(path)) {
+        _loaded.index = index;
+    }
+
+    void execute() override {
+        if (cancelled) {
+            wasSkipped = true;
+            return;
+        }
+        auto state = std::make_shared<FieldlinesState>();
+        if (state->loadStateFromOsfls(_path)) {
+            _loaded.nBytes = stateMemoryUsage(*state);
+            _loaded.state = std::move(state);
+        }
+        else {
+            LWARNING(fmt::format("Failed to load state from: {}", _path));
+        }
+    }
+
+    LoadedState product() override {
+        return _loaded;
+    }
+
+    std::atomic_bool cancelled = false;
+    bool wasSkipped = false;
+
+private:
+    std::string _path;
+    LoadedState _loaded;
+};
+
 RenderableFieldlinesSequence::RenderableFieldlinesSequence(
                                                       const ghoul::Dictionary& dictionary)
     : Renderable(dictionary)
@@ -280,6 +362,16 @@ RenderableFieldlinesSequence::RenderableFieldlinesSequence(
     , _pMaskingQuantity(MaskingQuantityInfo, OptionProperty::DisplayType::Dropdown)
     , _pFocusOnOriginBtn(OriginButtonInfo)
     , _pJumpToStartBtn(TimeJumpButtonInfo)
+    , _pStreamingGroup({ "Streaming" })
+    , _pStreamingMemoryCap(StreamingMemoryCapInfo, 1024, 16, 65536)
+    , _pStreamingMemoryUsage(
+        StreamingMemoryUsageInfo,
+        0.f,
+        0.f,
+        std::numeric_limits<float>::max()
+    )
+    , _pStreamingHits(StreamingHitsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _pStreamingMisses(StreamingMissesInfo, 0, 0, std::numeric_limits<int>::max())
 {
     _dictionary = std::make_unique<ghoul::Dictionary>(dictionary);
 }
@@ -584,9 +676,20 @@ bool RenderableFieldlinesSequence::prepareForOsflsStreaming() {
         LERROR("The provided .osfls files seem to be corrupt!");
         return false;
     }
+    _estimatedStateBytes = stateMemoryUsage(newState);
     _states.push_back(newState);
     _nStates = _startTimes.size();
     _activeStateIndex = 0;
+
+    int prefetchDepth = DefaultPrefetchDepth;
+    double depth;
+    if (_dictionary->getValue(KeyOslfsPrefetchDepth, depth)) {
+        prefetchDepth = std::max(static_cast<int>(depth), 1);
+    }
+    _stateRing.resize(std::min(static_cast<size_t>(prefetchDepth), _nStates));
+    _stateLoadJobManager = std::make_unique<ConcurrentJobManager<LoadedState>>(
+        ThreadPool(NumStateLoaderThreads)
+    );
     return true;
 }
 
@@ -641,6 +744,9 @@ void RenderableFieldlinesSequence::setupProperties() {
     if (hasExtras) {
         addPropertySubOwner(_pMaskingGroup);
     }
+    if (_loadingStatesDynamically) {
+        addPropertySubOwner(_pStreamingGroup);
+    }
 
     // ------------------------- Add Properties to the groups ------------------------- //
     _pColorGroup.addProperty(_pColorUniform);
@@ -653,6 +759,15 @@ void RenderableFieldlinesSequence::setupProperties() {
     _pFlowGroup.addProperty(_pFlowParticleSize);
     _pFlowGroup.addProperty(_pFlowParticleSpacing);
     _pFlowGroup.addProperty(_pFlowSpeed);
+    if (_loadingStatesDynamically) {
+        _pStreamingMemoryUsage.setReadOnly(true);
+        _pStreamingHits.setReadOnly(true);
+        _pStreamingMisses.setReadOnly(true);
+        _pStreamingGroup.addProperty(_pStreamingMemoryCap);
+        _pStreamingGroup.addProperty(_pStreamingMemoryUsage);
+        _pStreamingGroup.addProperty(_pStreamingHits);
+        _pStreamingGroup.addProperty(_pStreamingMisses);
+    }
     if (hasExtras) {
         _pColorGroup.addProperty(_pColorMethod);
         _pColorGroup.addProperty(_pColorQuantity);
@@ -1031,15 +1146,19 @@ void RenderableFieldlinesSequence::deinitializeGL() {
         _shaderProgram = nullptr;
     }
 
-    // Stall main thread until thread that's loading states is done!
-    bool printedWarning = false;
-    while (_isLoadingStateFromDisk) {
-        if (!printedWarning) {
-            LWARNING("Trying to destroy class when an active thread is still using it");
-            printedWarning = true;
+    if (_stateLoadJobManager) {
+        for (std::pair<const int, std::shared_ptr<StateLoadJob>>& p : _pendingStateLoads)
+        {
+            p.second->cancelled = true;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        _stateLoadJobManager->clearEnqueuedJobs();
+        // Destroying the job manager waits for the jobs that are already running
+        _stateLoadJobManager = nullptr;
+        _pendingStateLoads.clear();
     }
+    _stateRing.clear();
+    _streamedState = nullptr;
+    _streamedStateIndex = -1;
 }
 
 bool RenderableFieldlinesSequence::isReady() const {
@@ -1047,7 +1166,7 @@ bool RenderableFieldlinesSequence::isReady() const {
 }
 
 void RenderableFieldlinesSequence::render(const RenderData& data, RendererTasks&) {
-    if (_activeTriggerTimeIndex != -1) {
+    if (_activeTriggerTimeIndex != -1 && hasActiveState()) {
         _shaderProgram->activate();
 
         // Calculate Model View MatrixProjection
@@ -1115,12 +1234,13 @@ void RenderableFieldlinesSequence::render(const RenderData& data, RendererTasks&
             }
         }
 
+        const FieldlinesState& state = activeState();
         glBindVertexArray(_vertexArrayObject);
         glMultiDrawArrays(
             GL_LINE_STRIP, //_drawingOutputType,
-            _states[_activeStateIndex].lineStart().data(),
-            _states[_activeStateIndex].lineCount().data(),
-            static_cast<GLsizei>(_states[_activeStateIndex].lineStart().size())
+            state.lineStart().data(),
+            state.lineCount().data(),
+            static_cast<GLsizei>(state.lineStart().size())
         );
 
         glBindVertexArray(0);
@@ -1138,6 +1258,10 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
         _shaderProgram->rebuildFromFile();
     }
 
+    if (_loadingStatesDynamically) {
+        collectLoadedStates();
+    }
+
     const double currentTime = data.time.j2000Seconds();
     const bool isInInterval = (currentTime >= _startTimes[0]) &&
                               (currentTime < _sequenceEndTime);
@@ -1157,6 +1281,14 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
 
             if (_loadingStatesDynamically) {
                 _mustLoadNewStateFromDisk = true;
+                if (_streamedStateIndex == _activeTriggerTimeIndex ||
+                    isStateInRing(_activeTriggerTimeIndex))
+                {
+                    _pStreamingHits = _pStreamingHits + 1;
+                }
+                else {
+                    _pStreamingMisses = _pStreamingMisses + 1;
+                }
             } else {
                 _needsUpdate = true;
                 _activeStateIndex = _activeTriggerTimeIndex;
@@ -1169,26 +1301,26 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
         _needsUpdate              = false;
     }
 
-    if (_mustLoadNewStateFromDisk) {
-        if (!_isLoadingStateFromDisk && !_newStateIsReady) {
-            _isLoadingStateFromDisk    = true;
-            _mustLoadNewStateFromDisk  = false;
-            std::string filePath = _sourceFiles[_activeTriggerTimeIndex];
-            std::thread readBinaryThread([this, f = std::move(filePath)] {
-                readNewState(f);
-            });
-            readBinaryThread.detach();
+    if (_loadingStatesDynamically) {
+        prefetchStates(currentTime);
+
+        const int index = _activeTriggerTimeIndex;
+        if (_mustLoadNewStateFromDisk && _streamedStateIndex == index) {
+            // The buffers still contain the right state
+            _mustLoadNewStateFromDisk = false;
+        }
+        else if (_mustLoadNewStateFromDisk && isStateInRing(index)) {
+            _streamedState = _stateRing[index % _stateRing.size()].state;
+            _streamedStateIndex = _activeTriggerTimeIndex;
+            _mustLoadNewStateFromDisk = false;
+            _newStateIsReady = true;
         }
     }
 
     if (_needsUpdate || _newStateIsReady) {
-        if (_loadingStatesDynamically) {
-            _states[0] = std::move(*_newState);
-        }
-
         updateVertexPositionBuffer();
 
-        if (_states[_activeStateIndex].nExtraQuantities() > 0) {
+        if (activeState().nExtraQuantities() > 0) {
             _shouldUpdateColorBuffer = true;
             _shouldUpdateMaskingBuffer = true;
         }
@@ -1198,12 +1330,14 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
         _newStateIsReady = false;
     }
 
-    if (_shouldUpdateColorBuffer) {
+    // The property callbacks request buffer updates even before the first state is
+    // available; those requests are kept until there is a state to take the data from
+    if (_shouldUpdateColorBuffer && hasActiveState()) {
         updateVertexColorBuffer();
         _shouldUpdateColorBuffer = false;
     }
 
-    if (_shouldUpdateMaskingBuffer) {
+    if (_shouldUpdateMaskingBuffer && hasActiveState()) {
         updateVertexMaskingBuffer();
         _shouldUpdateMaskingBuffer = false;
     }
@@ -1226,13 +1360,101 @@ void RenderableFieldlinesSequence::updateActiveTriggerTimeIndex(double currentTi
     }
 }
 
-// Reading state from disk. Must be thread safe!
-void RenderableFieldlinesSequence::readNewState(const std::string& filePath) {
-    _newState = std::make_unique<FieldlinesState>();
-    if (_newState->loadStateFromOsfls(filePath)) {
-        _newStateIsReady = true;
+bool RenderableFieldlinesSequence::hasActiveState() const {
+    return _loadingStatesDynamically ? _streamedState != nullptr : _activeStateIndex >= 0;
+}
+
+const FieldlinesState& RenderableFieldlinesSequence::activeState() const {
+    ghoul_assert(hasActiveState(), "There is no active state");
+    return _loadingStatesDynamically ? *_streamedState : _states[_activeStateIndex];
+}
+
+// Moves the states that the loader threads have finished into the prefetch ring
+void RenderableFieldlinesSequence::collectLoadedStates() {
+    std::vector<std::shared_ptr<Job<LoadedState>>> jobs =
+        _stateLoadJobManager->popFinishedJobs();
+
+    for (const std::shared_ptr<Job<LoadedState>>& job : jobs) {
+        LoadedState loaded = job->product();
+        auto it = _pendingStateLoads.find(loaded.index);
+        ghoul_assert(it != _pendingStateLoads.end(), "Finished job was not pending");
+        const bool isDiscarded = it->second->wasSkipped || it->second->cancelled;
+        _pendingStateLoads.erase(it);
+
+        if (isDiscarded) {
+            // The state has left the prefetch window while it was waiting or loading,
+            // so storing it would evict a state that is still needed. If it has come
+            // back into the window, it is scheduled again by prefetchStates
+            continue;
+        }
+        if (loaded.state) {
+            _estimatedStateBytes = loaded.nBytes;
+        }
+        // A failed load is stored as well so that it is not retried every frame
+        _stateRing[loaded.index % _stateRing.size()] = std::move(loaded);
+    }
+}
+
+bool RenderableFieldlinesSequence::isStateInRing(int index) const {
+    if (index < 0) {
+        return false;
+    }
+    const LoadedState& slot = _stateRing[index % _stateRing.size()];
+    return slot.index == index && slot.state;
+}
+
+// Schedules the active state and the states that will follow it with the current delta
+// time, as far as the prefetch depth and the memory cap allow
+void RenderableFieldlinesSequence::prefetchStates(double currentTime) {
+    const int nStates = static_cast<int>(_nStates);
+    const double deltaTime = global::timeManager.deltaTime();
+
+    int first = _activeTriggerTimeIndex;
+    if (first < 0) {
+        // Outside of the sequence; prepare the state at the closest end of it
+        first = currentTime < _startTimes[0] ? 0 : nStates - 1;
+    }
+
+    const size_t memoryCap = static_cast<size_t>(_pStreamingMemoryCap) * 1024 * 1024;
+    const size_t maxStatesInMemory = std::max<size_t>(
+        memoryCap / std::max<size_t>(_estimatedStateBytes, 1),
+        1
+    );
+    const int maxStates = static_cast<int>(
+        std::min(_stateRing.size(), maxStatesInMemory)
+    );
+
+    const std::vector<int> window = fls::prefetchWindow(
+        _startTimes,
+        first,
+        currentTime,
+        deltaTime * PrefetchHorizon,
+        maxStates
+    );
+    auto isInWindow = [&window](int index) {
+        return std::find(window.begin(), window.end(), index) != window.end();
+    };
+
+    for (std::pair<const int, std::shared_ptr<StateLoadJob>>& p : _pendingStateLoads) {
+        p.second->cancelled = !isInWindow(p.first);
+    }
+
+    for (int index : window) {
+        if (_stateRing[index % _stateRing.size()].index == index ||
+            _pendingStateLoads.find(index) != _pendingStateLoads.end())
+        {
+            continue;
+        }
+        auto job = std::make_shared<StateLoadJob>(index, _sourceFiles[index]);
+        _pendingStateLoads[index] = job;
+        _stateLoadJobManager->enqueueJob(job);
+    }
+
+    size_t nBytes = 0;
+    for (const LoadedState& slot : _stateRing) {
+        nBytes += slot.nBytes;
     }
-    _isLoadingStateFromDisk = false;
+    _pStreamingMemoryUsage = static_cast<float>(nBytes) / (1024.f * 1024.f);
 }
 
 // Unbind buffers and arrays
@@ -1245,7 +1467,7 @@ void RenderableFieldlinesSequence::updateVertexPositionBuffer() {
     glBindVertexArray(_vertexArrayObject);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexPositionBuffer);
 
-    const std::vector<glm::vec3>& vertPos = _states[_activeStateIndex].vertexPositions();
+    const fls::ArrayView<glm::vec3> vertPos = activeState().vertexPositions();
 
     glBufferData(
         GL_ARRAY_BUFFER,
@@ -1265,7 +1487,7 @@ void RenderableFieldlinesSequence::updateVertexColorBuffer() {
     glBindBuffer(GL_ARRAY_BUFFER, _vertexColorBuffer);
 
     bool isSuccessful;
-    const std::vector<float>& quantities = _states[_activeStateIndex].extraQuantity(
+    const fls::ArrayView<float> quantities = activeState().extraQuantity(
         _pColorQuantity,
         isSuccessful
     );
@@ -1290,7 +1512,7 @@ void RenderableFieldlinesSequence::updateVertexMaskingBuffer() {
     glBindBuffer(GL_ARRAY_BUFFER, _vertexMaskingBuffer);
 
     bool isSuccessful;
-    const std::vector<float>& maskings = _states[_activeStateIndex].extraQuantity(
+    const fls::ArrayView<float> maskings = activeState().extraQuantity(
         _pMaskingQuantity,
         isSuccessful
     );
@@ -31,11 +31,13 @@
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/triggerproperty.h>
+#include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/vector/vec2property.h>
 #include <openspace/properties/vector/vec4property.h>
 #include <openspace/rendering/transferfunction.h>
-#include <atomic>
+#include <openspace/util/concurrentjobmanager.h>
+#include <map>
 
 namespace { enum class SourceFileType; }
 
@@ -64,10 +66,16 @@ private:
     // ------------------------------------ STRINGS ------------------------------------//
     std::string _identifier;                               // Name of the Node!
 
+    // ------------------------------------ STRUCTS ------------------------------------//
+    // Used for 'runtime-states'. A state that was decoded on one of the loader threads
+    struct LoadedState {
+        int index = -1;
+        std::shared_ptr<const FieldlinesState> state;
+        size_t nBytes = 0;
+    };
+    struct StateLoadJob;
+
     // ------------------------------------- FLAGS -------------------------------------//
-    // Used for 'runtime-states'. True when loading a new state from disk on another
-    // thread.
-    std::atomic_bool _isLoadingStateFromDisk = false;
     // False => states are stored in RAM (using 'in-RAM-states'), True => states are
     // loaded from disk during runtime (using 'runtime-states')
     bool _loadingStatesDynamically  = false;
@@ -77,9 +85,9 @@ private:
     // Used for 'in-RAM-states' : True if new 'in-RAM-state'  must be loaded.
     // False => the previous frame's state should still be shown
     bool _needsUpdate = false;
-    // Used for 'runtime-states'. True when finished loading a new state from disk on
-    // another thread.
-    std::atomic_bool _newStateIsReady = false;
+    // Used for 'runtime-states'. True when the state for the active trigger time has
+    // been taken from the prefetch ring and its buffers need to be updated
+    bool _newStateIsReady = false;
     // True when new state is loaded or user change which quantity to color the lines by
     bool _shouldUpdateColorBuffer   = false;
     // True when new state is loaded or user change which quantity used for masking out
@@ -95,6 +103,11 @@ private:
     int _activeTriggerTimeIndex = -1;
     // Number of states in the sequence
     size_t _nStates = 0;
+    // Used for 'runtime-states'. Index of the state in _streamedState, -1 if none
+    int _streamedStateIndex = -1;
+    // Used for 'runtime-states'. Estimated memory usage of a single decoded state, used
+    // to determine how many states fit into the streaming memory cap
+    size_t _estimatedStateBytes = 0;
     // In setup it is used to scale JSON coordinates. During runtime it is used to scale
     // domain limits.
     float _scalingFactor = 1.f;
@@ -114,8 +127,10 @@ private:
     // ----------------------------------- POINTERS ------------------------------------//
     // The Lua-Modfile-Dictionary used during initialization
     std::unique_ptr<ghoul::Dictionary> _dictionary;
-    // Used for 'runtime-states' when switching out current state to a new state
-    std::unique_ptr<FieldlinesState> _newState;
+    // Used for 'runtime-states'. The state whose data is currently in the buffers
+    std::shared_ptr<const FieldlinesState> _streamedState;
+    // Used for 'runtime-states'. Runs the StateLoadJobs on a fixed pool of threads
+    std::unique_ptr<ConcurrentJobManager<LoadedState>> _stateLoadJobManager;
     std::unique_ptr<ghoul::opengl::ProgramObject> _shaderProgram;
     // Transfer function used to color lines when _pColorMethod is set to BY_QUANTITY
     std::unique_ptr<TransferFunction> _transferFunction;
@@ -134,6 +149,12 @@ private:
     std::vector<double> _startTimes;
     // Stores the FieldlineStates
     std::vector<FieldlinesState> _states;
+    // Used for 'runtime-states'. Ring of decoded states around the active one. The state
+    // with index i is stored in slot i % _stateRing.size()
+    std::vector<LoadedState> _stateRing;
+    // Used for 'runtime-states'. Jobs that have been enqueued but not yet collected,
+    // keyed by the index of the state they load
+    std::map<int, std::shared_ptr<StateLoadJob>> _pendingStateLoads;
 
     // ---------------------------------- Properties ---------------------------------- //
     // Group to hold the color properties
@@ -197,6 +218,17 @@ private:
     // Button which executes a time jump to start of sequence
     properties::TriggerProperty _pJumpToStartBtn;
 
+    // Group to hold the streaming properties
+    properties::PropertyOwner _pStreamingGroup;
+    // Maximum memory that the prefetched states are allowed to use
+    properties::IntProperty _pStreamingMemoryCap;
+    // Memory currently used by the prefetched states
+    properties::FloatProperty _pStreamingMemoryUsage;
+    // Number of state changes for which the new state was already prefetched
+    properties::IntProperty _pStreamingHits;
+    // Number of state changes that had to wait for the new state to be loaded
+    properties::IntProperty _pStreamingMisses;
+
     // --------------------- FUNCTIONS USED DURING INITIALIZATION --------------------- //
     void addStateToSequence(FieldlinesState& STATE);
     void computeSequenceEndTime();
@@ -220,7 +252,11 @@ private:
     bool prepareForOsflsStreaming();
 
     // ------------------------- FUNCTIONS USED DURING RUNTIME ------------------------ //
-    void readNewState(const std::string& filePath);
+    bool hasActiveState() const;
+    const FieldlinesState& activeState() const;
+    void collectLoadedStates();
+    bool isStateInRing(int index) const;
+    void prefetchStates(double currentTime);
     void updateActiveTriggerTimeIndex(double currentTime);
     void updateVertexPositionBuffer();
     void updateVertexColorBuffer();
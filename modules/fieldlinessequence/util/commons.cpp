@@ -37,4 +37,30 @@ Model stringToModel(const std::string& s) {
     return Model::Invalid;
 }
 
+std::vector<int> prefetchWindow(const std::vector<double>& startTimes, int first,
+                                double currentTime, double lookAhead, int maxStates)
+{
+    const int nStates = static_cast<int>(startTimes.size());
+    const int direction = lookAhead < 0.0 ? -1 : 1;
+    const double horizon = currentTime + lookAhead;
+
+    std::vector<int> window = { first };
+    while (static_cast<int>(window.size()) < maxStates) {
+        const int index = first + direction * static_cast<int>(window.size());
+        if (index < 0 || index >= nStates) {
+            break;
+        }
+        // A state becomes active when the time crosses its own start time going
+        // forward, or the start time of the state after it going backward
+        const bool isWithinHorizon = direction > 0 ?
+            startTimes[index] <= horizon :
+            startTimes[index + 1] >= horizon;
+        if (window.size() > 1 && !isWithinHorizon) {
+            break;
+        }
+        window.push_back(index);
+    }
+    return window;
+}
+
 } // namespace openspace::fls
@@ -26,6 +26,7 @@
 #define __OPENSPACE_MODULE_FIELDLINESSEQUENCE___COMMONS___H__
 
 #include <string>
+#include <vector>
 
 namespace openspace::fls { // (F)ield(L)ines(S)equence
 
@@ -38,6 +39,17 @@ enum class Model : int {
 
 Model stringToModel(const std::string& s);
 
+/**
+ * Returns the indices of the states that should be prefetched for a sequence whose
+ * states start at the sorted \p startTimes, in the order in which they become active.
+ * The window starts at the state \p first and follows the direction of \p lookAhead,
+ * which is the distance in time from \p currentTime that is looked into. The state
+ * after \p first is always included, the ones after it only if they become active
+ * within the look ahead. At most \p maxStates indices are returned.
+ */
+std::vector<int> prefetchWindow(const std::vector<double>& startTimes, int first,
+    double currentTime, double lookAhead, int maxStates);
+
 constexpr const float AuToMeter = 149597870700.f;  // Astronomical Units
 constexpr const float ReToMeter = 6371000.f;       // Earth radius
 constexpr const float RsToMeter = 695700000.f;     // Sun radius
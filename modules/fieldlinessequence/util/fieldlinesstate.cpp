@@ -25,15 +25,52 @@
 #include <modules/fieldlinessequence/util/fieldlinesstate.h>
 
 #include <openspace/json.h>
+#include <openspace/util/memorymappedfile.h>
 #include <openspace/util/time.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <cstring>
 #include <fstream>
 
 namespace {
     constexpr const char* _loggerCat = "FieldlinesState";
-    constexpr const int CurrentVersion = 0;
+    constexpr const int32_t CurrentVersion = 1;
     using json = nlohmann::json;
+
+    // All arrays in a version 1 file start at a multiple of this many bytes, so that
+    // they can be used directly from the memory mapping
+    constexpr const size_t ArrayAlignment = 64;
+
+    // The version number is the first value in every version of the file
+    struct OsflsHeader {
+        int32_t version;
+        int32_t model;
+        double triggerTime;
+        uint64_t nLines;
+        uint64_t nPoints;
+        uint32_t nExtras;
+        uint32_t isMorphable;
+        uint64_t lineStartOffset;
+        uint64_t lineCountOffset;
+        uint64_t vertexPositionsOffset;
+    };
+    static_assert(sizeof(OsflsHeader) == 64, "Unexpected padding in OsflsHeader");
+
+    // One entry per extra quantity follows the header, then the table of names
+    struct OsflsExtraQuantity {
+        uint64_t dataOffset;
+        // Relative to the beginning of the name table
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+    static_assert(sizeof(OsflsExtraQuantity) == 16, "Unexpected padding");
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 is not packed");
+
+    size_t alignOffset(size_t offset) {
+        return (offset + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+    }
 } // namespace
 
 namespace openspace {
@@ -44,6 +81,7 @@ namespace openspace {
  * expected to be in degrees. scale is an optional scaling factor.
  */
 void FieldlinesState::convertLatLonToCartesian(float scale) {
+    detachFromMapping();
     for (glm::vec3& p : _vertexPositions) {
         const float r = p.x * scale;
         const float lat = glm::radians(p.y);
@@ -55,45 +93,102 @@ void FieldlinesState::convertLatLonToCartesian(float scale) {
 }
 
 void FieldlinesState::scalePositions(float scale) {
+    detachFromMapping();
     for (glm::vec3& p : _vertexPositions) {
         p *= scale;
     }
 }
 
 bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
-    std::ifstream ifs(pathToOsflsFile, std::ifstream::binary);
-    if (!ifs.is_open()) {
+    std::shared_ptr<const MemoryMappedFile> file;
+    try {
+        file = std::make_shared<const MemoryMappedFile>(pathToOsflsFile);
+    }
+    catch (const ghoul::RuntimeError&) {
         LERROR("Couldn't open file: " + pathToOsflsFile);
         return false;
     }
 
-    int binFileVersion;
-    ifs.read(reinterpret_cast<char*>(&binFileVersion), sizeof(int));
+    int32_t binFileVersion = -1;
+    if (file->size() >= sizeof(int32_t)) {
+        std::memcpy(&binFileVersion, file->data(), sizeof(int32_t));
+    }
 
+    bool success = false;
     switch (binFileVersion) {
         case 0:
-            // No need to put everything in this scope now, as only version 0 exists!
+            // The data of version 0 files is unaligned, so it is copied out of the file
+            // and the mapping is released when we return
+            success = loadVersion0(file->data(), file->size());
+            break;
+        case 1:
+            success = loadVersion1(std::move(file));
             break;
         default:
             LERROR("VERSION OF BINARY FILE WAS NOT RECOGNIZED!");
             return false;
     }
 
+    if (!success) {
+        LERROR(fmt::format("The file '{}' is truncated or corrupt", pathToOsflsFile));
+    }
+    return success;
+}
+
+bool FieldlinesState::loadVersion0(const std::byte* data, size_t size) {
+    size_t offset = sizeof(int32_t);
+    auto read = [data, size, &offset](void* destination, size_t nBytes) {
+        if (offset + nBytes > size) {
+            return false;
+        }
+        std::memcpy(destination, data + offset, nBytes);
+        offset += nBytes;
+        return true;
+    };
+
     // Define tmp variables to store meta data in
-    size_t nLines;
-    size_t nPoints;
-    size_t nExtras;
-    size_t byteSizeAllNames;
+    int32_t model;
+    uint64_t nLines;
+    uint64_t nPoints;
+    uint64_t nExtras;
+    uint64_t byteSizeAllNames;
 
     // Read single value variables
-    ifs.read(reinterpret_cast<char*>(&_triggerTime), sizeof(double));
-    ifs.read(reinterpret_cast<char*>(&_model), sizeof(int32_t));
-    ifs.read(reinterpret_cast<char*>(&_isMorphable), sizeof(bool));
-    ifs.read(reinterpret_cast<char*>(&nLines), sizeof(uint64_t));
-    ifs.read(reinterpret_cast<char*>(&nPoints), sizeof(uint64_t));
-    ifs.read(reinterpret_cast<char*>(&nExtras), sizeof(uint64_t));
-    ifs.read(reinterpret_cast<char*>(&byteSizeAllNames), sizeof(uint64_t));
+    const bool hasMetaData = read(&_triggerTime, sizeof(double)) &&
+                             read(&model, sizeof(int32_t)) &&
+                             read(&_isMorphable, sizeof(bool)) &&
+                             read(&nLines, sizeof(uint64_t)) &&
+                             read(&nPoints, sizeof(uint64_t)) &&
+                             read(&nExtras, sizeof(uint64_t)) &&
+                             read(&byteSizeAllNames, sizeof(uint64_t));
+    if (!hasMetaData) {
+        return false;
+    }
+    _model = static_cast<fls::Model>(model);
+
+    // Check the size before allocating so that a corrupt file can't request huge arrays.
+    // The counts come straight from the file, so every product is checked by dividing
+    // the remaining bytes instead of multiplying the counts
+    size_t remaining = size - offset;
+    auto consume = [&remaining](uint64_t n, size_t elementSize) {
+        if (n > remaining / elementSize) {
+            return false;
+        }
+        remaining -= n * elementSize;
+        return true;
+    };
+    const bool hasArrays = consume(nLines, sizeof(int32_t) + sizeof(uint32_t)) &&
+                           consume(nPoints, 3 * sizeof(float)) &&
+                           consume(byteSizeAllNames, 1) &&
+                           // Every name is terminated by a null character
+                           nExtras <= byteSizeAllNames &&
+                           (nPoints == 0 ||
+                            nExtras <= remaining / (sizeof(float) * nPoints));
+    if (!hasArrays) {
+        return false;
+    }
 
+    _mappedFile = nullptr;
     _lineStart.resize(nLines);
     _lineCount.resize(nLines);
     _vertexPositions.resize(nPoints);
@@ -101,37 +196,137 @@ bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
     _extraQuantityNames.resize(nExtras);
 
     // Read vertex position data
-    ifs.read(reinterpret_cast<char*>(_lineStart.data()), sizeof(int32_t) * nLines);
-    ifs.read(reinterpret_cast<char*>(_lineCount.data()), sizeof(uint32_t) * nLines);
-    ifs.read(
-        reinterpret_cast<char*>(_vertexPositions.data()),
-        3 * sizeof(float) * nPoints
-    );
+    read(_lineStart.data(), sizeof(int32_t) * nLines);
+    read(_lineCount.data(), sizeof(uint32_t) * nLines);
+    read(_vertexPositions.data(), 3 * sizeof(float) * nPoints);
 
     // Read all extra quantities
     for (std::vector<float>& vec : _extraQuantities) {
         vec.resize(nPoints);
-        ifs.read(reinterpret_cast<char*>(vec.data()), sizeof(float) * nPoints);
+        read(vec.data(), sizeof(float) * nPoints);
     }
 
     // Read all extra quantities' names. Stored as multiple c-strings
-    std::string allNamesInOne;
-    std::vector<char> buffer(byteSizeAllNames);
-    ifs.read(buffer.data(), byteSizeAllNames);
-    allNamesInOne.assign(buffer.data(), byteSizeAllNames);
+    const std::string allNamesInOne(
+        reinterpret_cast<const char*>(data + offset),
+        byteSizeAllNames
+    );
 
-    size_t offset = 0;
+    size_t nameOffset = 0;
     for (size_t i = 0; i < nExtras; ++i) {
-        auto endOfVarName = allNamesInOne.find('\0', offset);
-        endOfVarName -= offset;
-        const std::string varName = allNamesInOne.substr(offset, endOfVarName);
-        offset += varName.size() + 1;
+        auto endOfVarName = allNamesInOne.find('\0', nameOffset);
+        endOfVarName -= nameOffset;
+        const std::string varName = allNamesInOne.substr(nameOffset, endOfVarName);
+        nameOffset += varName.size() + 1;
         _extraQuantityNames[i] = varName;
     }
 
     return true;
 }
 
+bool FieldlinesState::loadVersion1(std::shared_ptr<const MemoryMappedFile> file) {
+    const std::byte* data = file->data();
+    const size_t size = file->size();
+
+    OsflsHeader header;
+    if (size < sizeof(OsflsHeader)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(OsflsHeader));
+
+    // Returns whether an array of n elements at the offset is within the file and
+    // correctly aligned for direct access
+    auto isValidArray = [size](uint64_t offset, uint64_t n, size_t elementSize) {
+        return offset % ArrayAlignment == 0 && offset <= size &&
+               n <= (size - offset) / elementSize;
+    };
+
+    const size_t entriesOffset = sizeof(OsflsHeader);
+    const size_t namesOffset =
+        entriesOffset + header.nExtras * sizeof(OsflsExtraQuantity);
+    const bool isValid = namesOffset <= size &&
+        isValidArray(header.lineStartOffset, header.nLines, sizeof(GLint)) &&
+        isValidArray(header.lineCountOffset, header.nLines, sizeof(GLsizei)) &&
+        isValidArray(header.vertexPositionsOffset, header.nPoints, sizeof(glm::vec3));
+    if (!isValid) {
+        return false;
+    }
+
+    std::vector<std::string> names(header.nExtras);
+    std::vector<fls::ArrayView<float>> extras(header.nExtras);
+    for (uint32_t i = 0; i < header.nExtras; ++i) {
+        OsflsExtraQuantity entry;
+        std::memcpy(
+            &entry,
+            data + entriesOffset + i * sizeof(OsflsExtraQuantity),
+            sizeof(OsflsExtraQuantity)
+        );
+
+        const size_t nameEnd = namesOffset + entry.nameOffset + entry.nameLength;
+        if (!isValidArray(entry.dataOffset, header.nPoints, sizeof(float)) ||
+            nameEnd > size)
+        {
+            return false;
+        }
+
+        names[i] = std::string(
+            reinterpret_cast<const char*>(data + namesOffset + entry.nameOffset),
+            entry.nameLength
+        );
+        // The pages of the quantity are only read when the quantity is accessed
+        extras[i] = fls::ArrayView<float>(
+            reinterpret_cast<const float*>(data + entry.dataOffset),
+            header.nPoints
+        );
+    }
+
+    _triggerTime = header.triggerTime;
+    _model = static_cast<fls::Model>(header.model);
+    _isMorphable = header.isMorphable != 0;
+
+    _lineStart.clear();
+    _lineCount.clear();
+    _vertexPositions.clear();
+    _extraQuantities.clear();
+    _extraQuantityNames = std::move(names);
+
+    _mappedLineStart = fls::ArrayView<GLint>(
+        reinterpret_cast<const GLint*>(data + header.lineStartOffset),
+        header.nLines
+    );
+    _mappedLineCount = fls::ArrayView<GLsizei>(
+        reinterpret_cast<const GLsizei*>(data + header.lineCountOffset),
+        header.nLines
+    );
+    _mappedVertexPositions = fls::ArrayView<glm::vec3>(
+        reinterpret_cast<const glm::vec3*>(data + header.vertexPositionsOffset),
+        header.nPoints
+    );
+    _mappedExtraQuantities = std::move(extras);
+    _mappedFile = std::move(file);
+    return true;
+}
+
+void FieldlinesState::detachFromMapping() {
+    if (!_mappedFile) {
+        return;
+    }
+
+    _lineStart.assign(_mappedLineStart.begin(), _mappedLineStart.end());
+    _lineCount.assign(_mappedLineCount.begin(), _mappedLineCount.end());
+    _vertexPositions.assign(_mappedVertexPositions.begin(), _mappedVertexPositions.end());
+    _extraQuantities.clear();
+    for (const fls::ArrayView<float>& quantity : _mappedExtraQuantities) {
+        _extraQuantities.emplace_back(quantity.begin(), quantity.end());
+    }
+
+    _mappedLineStart = {};
+    _mappedLineCount = {};
+    _mappedVertexPositions = {};
+    _mappedExtraQuantities.clear();
+    _mappedFile = nullptr;
+}
+
 bool FieldlinesState::loadStateFromJson(const std::string& pathToJsonFile,
                                         fls::Model Model, float coordToMeters)
 {
@@ -219,28 +414,6 @@ bool FieldlinesState::loadStateFromJson(const std::string& pathToJsonFile,
 /**
  * \param absPath must be the path to the file (incl. filename but excl. extension!)
  * Directory must exist! File is created (or overwritten if already existing).
- * File is structured like this: (for version 0)
- *  0. int                    - version number of binary state file! (in case something
- *                              needs to be altered in the future, then increase
- *                              CurrentVersion)
- *  1. double                 - _triggerTime
- *  2. int                    - _model
- *  3. bool                   - _isMorphable
- *  4. size_t                 - Number of lines in the state  == _lineStart.size()
- *                                                            == _lineCount.size()
- *  5. size_t                 - Total number of vertex points == _vertexPositions.size()
- *                                                           == _extraQuantities[i].size()
- *  6. size_t                 - Number of extra quantites     == _extraQuantities.size()
- *                                                           == _extraQuantityNames.size()
- *  7. site_t                 - Number of total bytes that ALL _extraQuantityNames
- *                              consists of (Each such name is stored as a c_str which
- *                              means it ends with the null char '\0' )
- *  7. std::vector<GLint>     - _lineStart
- *  8. std::vector<GLsizei>   - _lineCount
- *  9. std::vector<glm::vec3> - _vertexPositions
- * 10. std::vector<float>     - _extraQuantities
- * 11. array of c_str         - Strings naming the extra quantities (elements of
- *                              _extraQuantityNames). Each string ends with null char '\0'
  */
 void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
     // ------------------------------- Create the file ------------------------------- //
@@ -250,51 +423,112 @@ void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
     pathSafeTimeString.replace(19, 1, "-");
     const std::string& fileName = pathSafeTimeString + ".osfls";
 
-    std::ofstream ofs(absPath + fileName, std::ofstream::binary | std::ofstream::trunc);
-    if (!ofs.is_open()) {
+    if (!writeOsfls(absPath + fileName)) {
         LERROR(fmt::format(
             "Failed to save state to binary file: {}{}", absPath, fileName
         ));
-        return;
     }
+}
+
+bool FieldlinesState::convertOsflsFile(const std::string& source,
+                                       const std::string& destination)
+{
+    FieldlinesState state;
+    if (!state.loadStateFromOsfls(source)) {
+        return false;
+    }
+    return state.writeOsfls(destination);
+}
+
+/**
+ * File is structured like this: (for version 1, version 0 files can still be loaded)
+ *  0. OsflsHeader             - 64 bytes, starting with the version number of binary
+ *                               state file! (in case something needs to be altered in
+ *                               the future, then increase CurrentVersion), followed by
+ *                               _model, _triggerTime, number of lines, number of
+ *                               vertex points, number of extra quantities,
+ *                               _isMorphable and the offsets of the three arrays below
+ *  1. OsflsExtraQuantity[]    - One entry per extra quantity with the offset of its
+ *                               data and the location of its name in the name table
+ *  2. char[]                  - The names of the extra quantities, not null terminated
+ *  3. std::vector<GLint>      - _lineStart
+ *  4. std::vector<GLsizei>    - _lineCount
+ *  5. std::vector<glm::vec3>  - _vertexPositions
+ *  6. std::vector<float>      - _extraQuantities, one array per quantity
+ * All offsets are in bytes from the beginning of the file and every array starts at a
+ * multiple of ArrayAlignment bytes, so the file can be memory mapped and used in place.
+ */
+bool FieldlinesState::writeOsfls(const std::string& path) const {
+    std::ofstream ofs(path, std::ofstream::binary | std::ofstream::trunc);
+    if (!ofs.is_open()) {
+        return false;
+    }
+
+    const fls::ArrayView<GLint> lineStarts = lineStart();
+    const fls::ArrayView<GLsizei> lineCounts = lineCount();
+    const fls::ArrayView<glm::vec3> positions = vertexPositions();
+    const size_t nLines = lineStarts.size();
+    const size_t nPoints = positions.size();
+    const size_t nExtras = nExtraQuantities();
 
-    // --------- Add each string of _extraQuantityNames into one long string --------- //
-    std::string allExtraQuantityNamesInOne = "";
-    for (const std::string& str : _extraQuantityNames) {
-        allExtraQuantityNamesInOne += str + '\0'; // Add null char '\0' for easier reading
+    // ------------------------------ Compute the layout ------------------------------ //
+    std::vector<OsflsExtraQuantity> entries(nExtras);
+    std::string names;
+    for (size_t i = 0; i < nExtras; ++i) {
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameLength = static_cast<uint32_t>(_extraQuantityNames[i].size());
+        names += _extraQuantityNames[i];
     }
 
-    const size_t nLines = _lineStart.size();
-    const size_t nPoints = _vertexPositions.size();
-    const size_t nExtras = _extraQuantities.size();
-    const size_t nStringBytes = allExtraQuantityNamesInOne.size();
+    OsflsHeader header;
+    header.version = CurrentVersion;
+    header.model = static_cast<int32_t>(_model);
+    header.triggerTime = _triggerTime;
+    header.nLines = nLines;
+    header.nPoints = nPoints;
+    header.nExtras = static_cast<uint32_t>(nExtras);
+    header.isMorphable = _isMorphable ? 1 : 0;
+
+    size_t offset = sizeof(OsflsHeader) + nExtras * sizeof(OsflsExtraQuantity) +
+                    names.size();
+    offset = alignOffset(offset);
+    header.lineStartOffset = offset;
+    offset = alignOffset(offset + nLines * sizeof(GLint));
+    header.lineCountOffset = offset;
+    offset = alignOffset(offset + nLines * sizeof(GLsizei));
+    header.vertexPositionsOffset = offset;
+    offset = alignOffset(offset + nPoints * sizeof(glm::vec3));
+    for (OsflsExtraQuantity& entry : entries) {
+        entry.dataOffset = offset;
+        offset = alignOffset(offset + nPoints * sizeof(float));
+    }
 
-    //----------------------------- WRITE EVERYTHING TO FILE -----------------------------
-    // VERSION OF BINARY FIELDLINES STATE FILE - IN CASE STRUCTURE CHANGES IN THE FUTURE
-    ofs.write(reinterpret_cast<const char*>(&CurrentVersion), sizeof(int));
-
-    //-------------------- WRITE META DATA FOR STATE --------------------------------
-    ofs.write(reinterpret_cast<const char*>(&_triggerTime), sizeof(_triggerTime));
-    ofs.write(reinterpret_cast<const char*>(&_model), sizeof(int32_t));
-    ofs.write(reinterpret_cast<const char*>(&_isMorphable), sizeof(bool));
-
-    ofs.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nStringBytes), sizeof(uint64_t));
-
-    //---------------------- WRITE ALL ARRAYS OF DATA --------------------------------
-    ofs.write(reinterpret_cast<char*>(_lineStart.data()), sizeof(int32_t) * nLines);
-    ofs.write(reinterpret_cast<char*>(_lineCount.data()), sizeof(uint32_t) * nLines);
-    ofs.write(
-        reinterpret_cast<char*>(_vertexPositions.data()),
-        3 * sizeof(float) * nPoints
-    );
-    // Write the data for each vector in _extraQuantities
-    for (std::vector<float>& vec : _extraQuantities) {
-        ofs.write(reinterpret_cast<char*>(vec.data()), sizeof(float) * nPoints);
+    // ----------------------------- Write everything to file ---------------------------
+    auto write = [&ofs](const void* data, size_t nBytes) {
+        ofs.write(reinterpret_cast<const char*>(data), nBytes);
+    };
+    auto pad = [&ofs]() {
+        const size_t position = static_cast<size_t>(ofs.tellp());
+        const std::vector<char> zeros(alignOffset(position) - position, 0);
+        ofs.write(zeros.data(), zeros.size());
+    };
+
+    write(&header, sizeof(OsflsHeader));
+    write(entries.data(), nExtras * sizeof(OsflsExtraQuantity));
+    write(names.data(), names.size());
+    pad();
+    write(lineStarts.data(), nLines * sizeof(GLint));
+    pad();
+    write(lineCounts.data(), nLines * sizeof(GLsizei));
+    pad();
+    write(positions.data(), nPoints * sizeof(glm::vec3));
+    for (size_t i = 0; i < nExtras; ++i) {
+        pad();
+        bool isSuccessful;
+        write(extraQuantity(i, isSuccessful).data(), nPoints * sizeof(float));
     }
-    ofs.write(allExtraQuantityNamesInOne.c_str(), nStringBytes);
+
+    return ofs.good();
 }
 
 // TODO: This should probably be rewritten, but this is the way the files were structured
@@ -341,19 +575,26 @@ void FieldlinesState::saveStateToJson(const std::string& absPath) {
     json jFile;
 
     const std::string timeStr = Time(_triggerTime).ISO8601();
-    const size_t nLines = _lineStart.size();
-    // const size_t nPoints      = _vertexPositions.size();
-    const size_t nExtras = _extraQuantities.size();
+    const fls::ArrayView<GLsizei> lineCounts = lineCount();
+    const fls::ArrayView<glm::vec3> positions = vertexPositions();
+    const size_t nLines = lineCounts.size();
+    const size_t nExtras = nExtraQuantities();
+
+    std::vector<fls::ArrayView<float>> extras(nExtras);
+    for (size_t extraIndex = 0; extraIndex < nExtras; ++extraIndex) {
+        bool isSuccessful;
+        extras[extraIndex] = extraQuantity(extraIndex, isSuccessful);
+    }
 
     size_t pointIndex = 0;
     for (size_t lineIndex = 0; lineIndex < nLines; ++lineIndex) {
         json jData = json::array();
-        for (GLsizei i = 0; i < _lineCount[lineIndex]; i++, ++pointIndex) {
-            const glm::vec3 pos = _vertexPositions[pointIndex];
+        for (GLsizei i = 0; i < lineCounts[lineIndex]; i++, ++pointIndex) {
+            const glm::vec3 pos = positions[pointIndex];
             json jDataElement = { pos.x, pos.y, pos.z };
 
             for (size_t extraIndex = 0; extraIndex < nExtras; ++extraIndex) {
-                jDataElement.push_back(_extraQuantities[extraIndex][pointIndex]);
+                jDataElement.push_back(extras[extraIndex][pointIndex]);
             }
             jData.push_back(jDataElement);
         }
@@ -384,10 +625,14 @@ void FieldlinesState::setTriggerTime(double t) {
 
 // Returns one of the extra quantity vectors, _extraQuantities[index].
 // If index is out of scope an empty vector is returned and the referenced bool is false.
-std::vector<float> FieldlinesState::extraQuantity(size_t index, bool& isSuccessful) const
+fls::ArrayView<float> FieldlinesState::extraQuantity(size_t index,
+                                                     bool& isSuccessful) const
 {
-    if (index < _extraQuantities.size()) {
+    if (index < nExtraQuantities()) {
         isSuccessful = true;
+        if (_mappedFile) {
+            return _mappedExtraQuantities[index];
+        }
         return _extraQuantities[index];
     }
     else {
@@ -401,6 +646,7 @@ std::vector<float> FieldlinesState::extraQuantity(size_t index, bool& isSuccessf
 // _lineStart & _lineCount accordingly.
 
 void FieldlinesState::addLine(std::vector<glm::vec3>& line) {
+    detachFromMapping();
     const size_t nNewPoints = line.size();
     const size_t nOldPoints = _vertexPositions.size();
     _lineStart.push_back(static_cast<GLint>(nOldPoints));
@@ -415,28 +661,26 @@ void FieldlinesState::addLine(std::vector<glm::vec3>& line) {
 }
 
 void FieldlinesState::appendToExtra(size_t idx, float val) {
+    detachFromMapping();
     _extraQuantities[idx].push_back(val);
 }
 
 void FieldlinesState::setExtraQuantityNames(std::vector<std::string> names) {
+    detachFromMapping();
     _extraQuantityNames = std::move(names);
     _extraQuantities.resize(_extraQuantityNames.size());
 }
 
-const std::vector<std::vector<float>>& FieldlinesState::extraQuantities() const {
-    return _extraQuantities;
-}
-
 const std::vector<std::string>& FieldlinesState::extraQuantityNames() const {
     return _extraQuantityNames;
 }
 
-const std::vector<GLsizei>& FieldlinesState::lineCount() const {
-    return _lineCount;
+fls::ArrayView<GLsizei> FieldlinesState::lineCount() const {
+    return _mappedFile ? _mappedLineCount : fls::ArrayView<GLsizei>(_lineCount);
 }
 
-const std::vector<GLint>& FieldlinesState::lineStart() const {
-    return _lineStart;
+fls::ArrayView<GLint> FieldlinesState::lineStart() const {
+    return _mappedFile ? _mappedLineStart : fls::ArrayView<GLint>(_lineStart);
 }
 
 fls::Model FieldlinesState::FieldlinesState::model() const {
@@ -444,15 +688,17 @@ fls::Model FieldlinesState::FieldlinesState::model() const {
 }
 
 size_t FieldlinesState::nExtraQuantities() const {
-    return _extraQuantities.size();
+    return _mappedFile ? _mappedExtraQuantities.size() : _extraQuantities.size();
 }
 
 double FieldlinesState::triggerTime() const {
     return _triggerTime;
 }
 
-const std::vector<glm::vec3>& FieldlinesState::vertexPositions() const {
-    return _vertexPositions;
+fls::ArrayView<glm::vec3> FieldlinesState::vertexPositions() const {
+    return _mappedFile ?
+        _mappedVertexPositions :
+        fls::ArrayView<glm::vec3>(_vertexPositions);
 }
 
 } // namespace openspace
@@ -28,35 +28,80 @@
 #include <modules/fieldlinessequence/util/commons.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace openspace {
 
+class MemoryMappedFile;
+
+namespace fls {
+
+/**
+ * A non-owning, read-only view of a contiguous array. The data is either owned by a
+ * FieldlinesState or by the memory mapping of the .osfls file it was loaded from.
+ */
+template <typename T>
+class ArrayView {
+public:
+    ArrayView() = default;
+    ArrayView(const T* data, size_t size) : _data(data), _size(size) {}
+    ArrayView(const std::vector<T>& v) : _data(v.data()), _size(v.size()) {}
+
+    const T* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+    const T& operator[](size_t i) const { return _data[i]; }
+
+private:
+    const T* _data = nullptr;
+    size_t _size = 0;
+};
+
+} // namespace fls
+
 class FieldlinesState {
 public:
     void convertLatLonToCartesian(float scale = 1.f);
     void scalePositions(float scale);
 
+    /**
+     * Loads the state from an .osfls file of any version. Files of version 1 are mapped
+     * into memory instead of being read, and all arrays of the state refer directly to
+     * the mapping; the pages of an extra quantity are only read from disk when it is
+     * first accessed.
+     */
     bool loadStateFromOsfls(const std::string& pathToOsflsFile);
     void saveStateToOsfls(const std::string& pathToOsflsFile);
 
+    /**
+     * Converts the .osfls file at \p source, which can be of any version, into the
+     * current, memory-mappable version and writes it to \p destination.
+     *
+     * \return \c true if the conversion was successful
+     */
+    static bool convertOsflsFile(const std::string& source,
+        const std::string& destination);
+
     bool loadStateFromJson(const std::string& pathToJsonFile, fls::Model model,
         float coordToMeters);
     void saveStateToJson(const std::string& pathToJsonFile);
 
-    const std::vector<std::vector<float>>& extraQuantities() const;
     const std::vector<std::string>& extraQuantityNames() const;
-    const std::vector<GLsizei>& lineCount() const;
-    const std::vector<GLint>& lineStart() const;
+    fls::ArrayView<GLsizei> lineCount() const;
+    fls::ArrayView<GLint> lineStart() const;
 
     fls::Model model() const;
     size_t nExtraQuantities() const;
     double triggerTime() const;
-    const std::vector<glm::vec3>& vertexPositions() const;
+    fls::ArrayView<glm::vec3> vertexPositions() const;
 
     // Special getter. Returns extraQuantities[index].
-    std::vector<float> extraQuantity(size_t index, bool& isSuccesful) const;
+    fls::ArrayView<float> extraQuantity(size_t index, bool& isSuccesful) const;
 
     void setModel(fls::Model m);
     void setTriggerTime(double t);
@@ -66,6 +111,12 @@ public:
     void appendToExtra(size_t idx, float val);
 
 private:
+    bool loadVersion0(const std::byte* data, size_t size);
+    bool loadVersion1(std::shared_ptr<const MemoryMappedFile> file);
+    bool writeOsfls(const std::string& path) const;
+    // Copies the arrays out of the memory mapping so that they can be modified
+    void detachFromMapping();
+
     bool _isMorphable = false;
     double _triggerTime = -1.0;
     fls::Model _model;
@@ -75,6 +126,14 @@ private:
     std::vector<GLsizei> _lineCount;
     std::vector<GLint> _lineStart;
     std::vector<glm::vec3> _vertexPositions;
+
+    // Only set for states that were loaded from a version 1 file. In that case, the
+    // views below refer to the mapping and the vectors above are empty
+    std::shared_ptr<const MemoryMappedFile> _mappedFile;
+    std::vector<fls::ArrayView<float>> _mappedExtraQuantities;
+    fls::ArrayView<GLsizei> _mappedLineCount;
+    fls::ArrayView<GLint> _mappedLineStart;
+    fls::ArrayView<glm::vec3> _mappedVertexPositions;
 };
 
 } // namespace openspace
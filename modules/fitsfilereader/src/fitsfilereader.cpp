@@ -25,11 +25,12 @@
 #include <modules/fitsfilereader/include/fitsfilereader.h>
 
 #include <openspace/util/distanceconversion.h>
+#include <openspace/util/speckloader.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
 #include <CCfits>
-#include <fstream>
+#include <algorithm>
 
 using namespace CCfits;
 
@@ -512,55 +513,24 @@ std::vector<float> FitsFileReader::readSpeckFile(const std::string& filePath,
 {
     std::vector<float> fullData;
 
-    std::ifstream fileStream(filePath);
-
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", filePath));
+    speck::Dataset dataset;
+    try {
+        dataset = speck::loadFile(filePath);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
         return fullData;
     }
 
-    int nValuesPerStar = 0;
-    int nNullArr = 0;
-    size_t nStars = 0;
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', 'texture' and 'maxcomment')
-    std::string line;
-    while (true) {
-        std::streampos position = fileStream.tellg();
-        std::getline(fileStream, line);
-
-        if (line[0] == '#' || line.empty()) {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" && line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture" && line.substr(0, 10) != "maxcomment")
-        {
-            // We read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line.
-            fileStream.seekg(position);
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy;
-            str >> nValuesPerStar;
-            nValuesPerStar += 1; // We want the number, but the index is 0 based
-        }
+    constexpr const int VelocityScaleColumn = 16;
+    if (dataset.nValuesPerRow <= VelocityScaleColumn) {
+        LERROR(fmt::format(
+            "Speck file '{}' has {} values per star, expected at least {}",
+            filePath, dataset.nValuesPerRow, VelocityScaleColumn + 1
+        ));
+        return fullData;
     }
 
-    nValuesPerStar += 3; // X Y Z are not counted in the Speck file indices
-
     // Order in DR1 file:       DR2 - GaiaGroupMembers:
     // 0 BVcolor                0 color
     // 1 lum                    1 lum
@@ -578,26 +548,19 @@ std::vector<float> FitsFileReader::readSpeckFile(const std::string& filePath,
     // 13 texture               13 speed
     //                          14 texture
 
-    do {
-        std::vector<float> readValues(nValuesPerStar);
-        nStars++;
-
-        std::getline(fileStream, line);
-        std::stringstream str(line);
-
-        // Read values.
-        for (int i = 0; i < nValuesPerStar; ++i) {
-            str >> readValues[i];
-        }
+    const std::vector<std::vector<float>>& c = dataset.columns;
+    const size_t nStars = dataset.nRows();
+    int nNullArr = 0;
 
+    nRenderValues = 8;
+    fullData.reserve(nStars * nRenderValues);
+    for (size_t i = 0; i < nStars; ++i) {
         // Check if star is a nullArray.
-        bool nullArray = true;
-        for (float f : readValues) {
-            if (f != 0.0) {
-                nullArray = false;
-                break;
-            }
-        }
+        const bool nullArray = std::all_of(
+            c.begin(),
+            c.end(),
+            [i](const std::vector<float>& column) { return column[i] == 0.f; }
+        );
 
         // Insert to data if we found some values.
         if (!nullArray) {
@@ -609,29 +572,23 @@ std::vector<float> FitsFileReader::readSpeckFile(const std::string& filePath,
             // B-V Color
             // Velocity [X, Y, Z]
 
-            nRenderValues = 8;
-            std::vector<float> renderValues(nRenderValues);
-
             // Gaia DR1 data from AMNH measures positions in Parsec, but
             // RenderableGaiaStars expects kiloParsec (because fits file from Vienna had
             // in kPc).
             // Thus we need to convert positions twice atm.
-            renderValues[0] = readValues[0] / 1000.0; // PosX
-            renderValues[1] = readValues[1] / 1000.0; // PosY
-            renderValues[2] = readValues[2] / 1000.0; // PosZ
-            renderValues[3] = readValues[6]; // AbsMag
-            renderValues[4] = readValues[3]; // color
-            renderValues[5] = readValues[13] * readValues[16]; // Vel X
-            renderValues[6] = readValues[14] * readValues[16]; // Vel Y
-            renderValues[7] = readValues[15] * readValues[16]; // Vel Z
-
-            fullData.insert(fullData.end(), renderValues.begin(), renderValues.end());
+            fullData.push_back(c[0][i] / 1000.f); // PosX
+            fullData.push_back(c[1][i] / 1000.f); // PosY
+            fullData.push_back(c[2][i] / 1000.f); // PosZ
+            fullData.push_back(c[6][i]); // AbsMag
+            fullData.push_back(c[3][i]); // color
+            fullData.push_back(c[13][i] * c[16][i]); // Vel X
+            fullData.push_back(c[14][i] * c[16][i]); // Vel Y
+            fullData.push_back(c[15][i] * c[16][i]); // Vel Z
         }
         else {
             nNullArr++;
         }
-
-    } while (!fileStream.eof());
+    }
 
     LINFO(fmt::format("{} out of {} read stars were null arrays", nNullArr, nStars));
 
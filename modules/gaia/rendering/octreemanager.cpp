@@ -25,20 +25,38 @@
 #include <modules/gaia/rendering/octreemanager.h>
 
 #include <modules/gaia/rendering/octreeculler.h>
+#include <modules/gaia/rendering/octreenodeloader.h>
 #include <openspace/util/distanceconstants.h>
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <thread>
 
 namespace {
     constexpr const char* _loggerCat = "OctreeManager";
+
+    // Loading nodes is bound by the disk, so more threads only add seeking
+    constexpr const unsigned int MaxNodeLoaderThreads = 4;
+
+    // The number of render calls that the camera is extrapolated along its velocity to
+    // prefetch the nodes it is moving towards
+    constexpr const double PrefetchRenderCalls = 60.0;
 } // namespace
 
 namespace openspace {
 
+OctreeManager::~OctreeManager() {
+    // The loader threads reference the nodes, so they have to be stopped first.
+    _nodeLoader = nullptr;
+}
+
 void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStarsPerNode) {
+    // Stop loading nodes of the previous Octree.
+    _nodeLoader = nullptr;
+
     if (_root) {
         LDEBUG("Clear existing Octree");
         clearAllData();
@@ -53,8 +71,9 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
     box.min = glm::vec3(-1.f, -1.f, 0.f);
     box.max = glm::vec3(1.f, 1.f, 1e2);
     _culler = std::make_unique<OctreeCuller>(box);
-    _removedKeysInPrevCall = std::set<int>();
-    _leastRecentlyFetchedNodes = std::queue<unsigned long long>();
+    _removedKeysInPrevCall.clear();
+    _leastRecentlyRequestedNodes.clear();
+    _requestedNodePositions.clear();
 
     // Reset default values when rebuilding the Octree during runtime.
     _numInnerNodes = 0;
@@ -64,6 +83,7 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
     _maxCpuRamBudget = cpuRamBudget;
     _cpuRamBudget = cpuRamBudget;
     _parentNodeOfCamera = 8;
+    _parentNodeOfPrediction = 8;
 
     if (maxDist > 0) {
         MAX_DIST = static_cast<size_t>(maxDist);
@@ -113,6 +133,7 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
         _freeSpotsInBuffer.push(static_cast<int>(idx));
     }
     _maxStackSize = _freeSpotsInBuffer.size();
+    _stagedChunks.assign(_maxStackSize, -1);
     LINFO("StackSize: " + std::to_string(maxNodes));
 }
 
@@ -122,12 +143,16 @@ void OctreeManager::insert(const std::vector<float>& starValues) {
     insertInNode(*_root->Children[index], starValues);
 }
 
+size_t OctreeManager::branchIndex(float posX, float posY, float posZ) const {
+    return getChildIndex(posX, posY, posZ);
+}
+
 void OctreeManager::sliceLodData(size_t branchIndex) {
     if (branchIndex != 8) {
         sliceNodeLodCache(*_root->Children[branchIndex]);
     }
     else {
-        for (int i = 0; i < 7; ++i) {
+        for (int i = 0; i < 8; ++i) {
             sliceNodeLodCache(*_root->Children[i]);
         }
     }
@@ -141,69 +166,132 @@ void OctreeManager::printStarsPerNode() const {
         accumulatedString += printStarsPerNode(*_root->Children[i], prefix);
     }
     LINFO(fmt::format("Number of stars per node: \n{}", accumulatedString));
-    LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes)));
-    LINFO(fmt::format("Number of inner nodes: {}", std::to_string(_numInnerNodes)));
-    LINFO(fmt::format("Depth of tree: {}", std::to_string(_totalDepth)));
+    LINFO(fmt::format("Number of leaf nodes: {}", _numLeafNodes.load()));
+    LINFO(fmt::format("Number of inner nodes: {}", _numInnerNodes.load()));
+    LINFO(fmt::format("Depth of tree: {}", _totalDepth.load()));
 }
 
 void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                                           size_t chunkSizeInBytes,
                                           const glm::ivec2& additionalNodes)
 {
+    // Nodes are loaded in the order of their distance to the camera.
+    _cameraPosInKpc = static_cast<glm::vec3>(
+        cameraPos / (1000.0 * distanceconstants::Parsec)
+    );
 
     // If entire dataset fits in RAM then load the entire dataset asynchronously now.
     // Nodes will be rendered when they've been made available.
     if (_datasetFitInMemory) {
         // Only traverse Octree once!
         if (_parentNodeOfCamera == 8) {
-            // Fetch first layer of children
-            fetchChildrenNodes(*_root, 0);
-
-            for (int i = 0; i < 8; ++i) {
-                // Check so branch doesn't have a single layer.
-                if (_root->Children[i]->isLeaf) {
-                    continue;
-                }
-
-                // Use multithreading to load files and detach thread from main execution
-                // so it can execute independently. Thread will be destroyed when
-                // finished!
-                std::thread([this, n = _root->Children[i]]() {
-                    fetchChildrenNodes(*n, -1);
-                }).detach();
-            }
+            _nodeLoader->beginRequests();
+            fetchChildrenNodes(*_root, -1);
             _parentNodeOfCamera = 0;
         }
         return;
     }
 
+    // Extrapolate the camera along its velocity to prefetch the nodes in front of it.
+    const glm::dvec3 velocity = cameraPos - _previousCameraPos;
+    _previousCameraPos = cameraPos;
+    const glm::dvec3 predictedPos = cameraPos + velocity * PrefetchRenderCalls;
+
     // Get leaf node in which the camera resides.
-    glm::vec3 fCameraPos = static_cast<glm::vec3>(
-        cameraPos / (1000.0 * distanceconstants::Parsec)
+    unsigned long long leafId = findLeafNodeId(cameraPos);
+    unsigned long long firstParentId = leafId / 10;
+    unsigned long long predictedLeafId = findLeafNodeId(predictedPos);
+    unsigned long long predictedParentId = predictedLeafId / 10;
+
+    // Return early if camera resides in the same first parent as before and is moving
+    // towards the same one! Otherwise camera has moved and may need to load more nodes!
+    if (_parentNodeOfCamera == firstParentId &&
+        _parentNodeOfPrediction == predictedParentId)
+    {
+        return;
+    }
+    _parentNodeOfCamera = firstParentId;
+    _parentNodeOfPrediction = predictedParentId;
+
+    // Request all nodes that are needed now. Queued requests for nodes that are not
+    // needed anymore are cancelled afterwards.
+    _nodeLoader->beginRequests();
+    fetchNeighborhood(leafId, additionalNodes);
+    if (predictedParentId != firstParentId) {
+        // Only prefetch the closest neighbors, they are loaded after the nodes around
+        // the camera as they are further away.
+        fetchNeighborhood(predictedLeafId, glm::ivec2(0, additionalNodes.y));
+    }
+    const size_t nCancelled = _nodeLoader->cancelStaleRequests();
+    if (nCancelled > 0) {
+        LDEBUG(fmt::format("Cancelled {} stale node requests", nCancelled));
+    }
+
+    // Check if we should remove any nodes from RAM.
+    long long tenthOfRamBudget = _maxCpuRamBudget / 10;
+    if (_cpuRamBudget < tenthOfRamBudget) {
+        long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
+        size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
+        std::vector<unsigned long long> nodesToRemove;
+
+        // Remove the nodes that were least recently requested. This only depends on the
+        // path of the camera and not on the order in which the loads finished.
+        auto it = _leastRecentlyRequestedNodes.begin();
+        while (nNodesToRemove > 0 && it != _leastRecentlyRequestedNodes.end()) {
+            const unsigned long long id = *it;
+            const bool isPending = _nodeLoader->isPending(id);
+            if (isPending) {
+                // Still loading, it can be removed when it has been loaded.
+                ++it;
+                continue;
+            }
+
+            // Check if the node is loaded after making sure that it is not loading.
+            std::shared_ptr<OctreeNode> node = _root;
+            for (char digit : std::to_string(id).substr(1)) {
+                node = node->Children[digit - '0'];
+            }
+            if (node->isLoaded) {
+                nodesToRemove.push_back(id);
+                nNodesToRemove--;
+            }
+            _requestedNodePositions.erase(id);
+            it = _leastRecentlyRequestedNodes.erase(it);
+        }
+
+        // Removing is cheap compared to loading, and doing it on the main thread means
+        // that no node is removed while the Octree is traversed.
+        if (!nodesToRemove.empty()) {
+            removeNodesFromRam(nodesToRemove);
+        }
+    }
+}
+
+unsigned long long OctreeManager::findLeafNodeId(const glm::dvec3& position) const {
+    glm::vec3 fPos = static_cast<glm::vec3>(
+        position / (1000.0 * distanceconstants::Parsec)
     );
-    size_t idx = getChildIndex(fCameraPos.x, fCameraPos.y, fCameraPos.z);
+    size_t idx = getChildIndex(fPos.x, fPos.y, fPos.z);
     std::shared_ptr<OctreeNode> node = _root->Children[idx];
 
     while (!node->isLeaf) {
         idx = getChildIndex(
-            fCameraPos.x,
-            fCameraPos.y,
-            fCameraPos.z,
+            fPos.x,
+            fPos.y,
+            fPos.z,
             node->originX,
             node->originY,
             node->originZ
         );
         node = node->Children[idx];
     }
-    unsigned long long leafId = node->octreePositionIndex;
-    unsigned long long firstParentId = leafId / 10;
+    return node->octreePositionIndex;
+}
 
-    // Return early if camera resides in the same first parent as before!
-    // Otherwise camera has moved and may need to load more nodes!
-    if (_parentNodeOfCamera == firstParentId) {
-        return;
-    }
-    _parentNodeOfCamera = firstParentId;
+void OctreeManager::fetchNeighborhood(unsigned long long leafId,
+                                      const glm::ivec2& additionalNodes)
+{
+    unsigned long long firstParentId = leafId / 10;
 
     // Each parent level may be root, make sure to propagate it in that case!
     unsigned long long secondParentId = (firstParentId == 8) ? 8 : leafId / 100;
@@ -215,7 +303,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
     int additionalLevelsToFetch = additionalNodes.y;
 
     // Get more descendants when closer to root.
-    if (_parentNodeOfCamera < 80000) {
+    if (firstParentId < 80000) {
         additionalLevelsToFetch++;
     }
 
@@ -273,24 +361,6 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
             }
         }
     }
-
-    // Check if we should remove any nodes from RAM.
-    long long tenthOfRamBudget = _maxCpuRamBudget / 10;
-    if (_cpuRamBudget < tenthOfRamBudget) {
-        long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
-        size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
-        std::vector<unsigned long long> nodesToRemove;
-        while (nNodesToRemove > 0) {
-            // Dequeue nodes that were least recently fetched by findAndFetchNeighborNode.
-            nodesToRemove.push_back(_leastRecentlyFetchedNodes.front());
-            _leastRecentlyFetchedNodes.pop();
-            nNodesToRemove--;
-        }
-        // Use asynchronous removal.
-        if (!nodesToRemove.empty()) {
-            std::thread(&OctreeManager::removeNodesFromRam, this, nodesToRemove).detach();
-        }
-    }
 }
 
 void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, int x,
@@ -384,24 +454,30 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
         indexStack.pop();
     }
 
-    // Fetch all children nodes from found parent. Use multithreading to load files
-    // asynchronously! Detach thread from main execution so it can execute independently.
-    // Thread will then be destroyed when it has finished!
-    std::thread([this, node, additionalLevelsToFetch]() {
-        fetchChildrenNodes(*node, additionalLevelsToFetch);
-    }).detach();
+    // Fetch all children nodes from found parent. The files are loaded asynchronously
+    // by the node loader.
+    fetchChildrenNodes(*node, additionalLevelsToFetch);
 }
 
-std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                              int& deltaStars,
-                                                              gaia::RenderOption option,
-                                                              float lodPixelThreshold)
+const OctreeManager::BufferUpdates& OctreeManager::traverseData(const glm::dmat4& mvp,
+                                                             const glm::vec2& screenSize,
+                                                                       int& deltaStars,
+                                                             gaia::RenderOption option,
+                                                               float lodPixelThreshold)
 {
-    auto renderData = std::map<int, std::vector<float>>();
+    // Reuse the memory of the previous render call.
+    _bufferUpdates.chunks.clear();
+    _bufferUpdates.values.clear();
     bool innerRebuild = false;
     _minTotalPixelsLod = lodPixelThreshold;
 
+    // The same index might have been removed more than once while rebuilding.
+    std::sort(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end());
+    _removedKeysInPrevCall.erase(
+        std::unique(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end()),
+        _removedKeysInPrevCall.end()
+    );
+
     // Reclaim indices from previous render call.
     for (auto removedKey = _removedKeysInPrevCall.rbegin();
          removedKey != _removedKeysInPrevCall.rend(); ++removedKey) {
@@ -417,9 +493,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         _freeSpotsInBuffer.push(*removedKey);
     }
     // Clear cache of removed keys before next render call.
-    if (!_removedKeysInPrevCall.empty()) {
-        _removedKeysInPrevCall.clear();
-    }
+    _removedKeysInPrevCall.clear();
 
     // Rebuild VBO from scratch if we're not using most of it but have a high max index.
     if ((_biggestChunkIndexInUse > _maxStackSize * 4 / 5) &&
@@ -434,8 +508,23 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         innerRebuild = true;
     }
 
+    // Sorts the updated chunks and resets the lookup of staged chunks for the next call.
+    auto finishUpdates = [this]() -> const BufferUpdates& {
+        for (const BufferUpdates::Chunk& chunk : _bufferUpdates.chunks) {
+            _stagedChunks[chunk.bufferIndex] = -1;
+        }
+        std::sort(
+            _bufferUpdates.chunks.begin(),
+            _bufferUpdates.chunks.end(),
+            [](const BufferUpdates::Chunk& lhs, const BufferUpdates::Chunk& rhs) {
+                return lhs.bufferIndex < rhs.bufferIndex;
+            }
+        );
+        return _bufferUpdates;
+    };
+
     // Check if entire tree is too small to see, and if so remove it.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     float fMaxDist = static_cast<float>(MAX_DIST);
     for (int i = 0; i < 8; ++i) {
         float x = (i % 2 == 0) ? fMaxDist : -fMaxDist;
@@ -445,20 +534,16 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         corners[i] = glm::dvec4(pos, 1.0);
     }
     if (!_culler->isVisible(corners, mvp)) {
-        return renderData;
+        return finishUpdates();
     }
     glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
     float totalPixels = nodeSize.x * nodeSize.y;
     if (totalPixels < _minTotalPixelsLod * 2) {
         // Remove LOD from first layer of children.
         for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *_root->Children[i],
-                deltaStars
-            );
-            renderData.insert(tmpData.begin(), tmpData.end());
+            removeNodeFromCache(*_root->Children[i], deltaStars);
         }
-        return renderData;
+        return finishUpdates();
     }
 
     for (size_t i = 0; i < 8; ++i) {
@@ -466,38 +551,23 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             continue;
         }
 
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *_root->Children[i],
-            mvp,
-            screenSize,
-            deltaStars,
-            option
-        );
+        checkNodeIntersection(*_root->Children[i], mvp, screenSize, deltaStars, option);
 
         // Avoid freezing when switching render mode for large datasets by only fetching
         // one branch at a time when rebuilding buffer.
         if (_rebuildBuffer) {
-            //renderData = std::move(tmpData);
             _traversedBranchesInRenderCall++;
-            //break;
         }
-
-        // Observe that if there exists identical keys in renderData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        renderData.insert(tmpData.begin(), tmpData.end());
     }
 
     if (_rebuildBuffer) {
         if (_useVBO) {
             // We need to overwrite bigger indices that had data before! No need for SSBO.
-            std::map<int, std::vector<float>> idxToRemove;
+            // This will only stage indices that weren't updated already
+            // (i.e. > biggestIdx).
             for (int idx : _removedKeysInPrevCall) {
-                idxToRemove[idx] = std::vector<float>();
+                stageRemovedChunk(idx);
             }
-
-            // This will only insert indices that doesn't already exist in map
-            // (i.e. > biggestIdx).
-            renderData.insert(idxToRemove.begin(), idxToRemove.end());
         }
         if (innerRebuild) {
             deltaStars = 0;
@@ -518,15 +588,14 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             _traversedBranchesInRenderCall = 0;
         }
     }
-    return renderData;
+    return finishUpdates();
 }
 
 std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
     std::vector<float> fullData;
 
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*_root->Children[i], option);
-        fullData.insert(fullData.end(), tmpData.begin(), tmpData.end());
+        getNodeData(*_root->Children[i], option, fullData);
     }
     return fullData;
 }
@@ -598,6 +667,12 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
     _streamOctree = !readData;
     if (_streamOctree) {
         _streamFolderPath = folderPath;
+        const unsigned int nThreads = std::clamp(
+            std::thread::hardware_concurrency() / 2,
+            1u,
+            MaxNodeLoaderThreads
+        );
+        _nodeLoader = std::make_unique<OctreeNodeLoader>(nThreads);
     }
 
     _valuesPerStar = 0;
@@ -757,28 +832,73 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
 void OctreeManager::fetchChildrenNodes(OctreeNode& parentNode,
                                        int additionalLevelsToFetch)
 {
-    // Lock node to make sure nobody else are trying to load the same children.
-    std::lock_guard lock(parentNode.loadingLock);
-
     for (int i = 0; i < 8; ++i) {
         // Fetch node data if we're streaming and it doesn't exist in RAM yet.
-        // (As long as there is any RAM budget left and node actually has any data!)
-        if (!parentNode.Children[i]->isLoaded &&
-            (parentNode.Children[i]->numStars > 0) &&
-            _cpuRamBudget > static_cast<long long>(parentNode.Children[i]->numStars
-            * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
-        {
-            fetchNodeDataFromFile(*parentNode.Children[i]);
+        // (As long as node actually has any data!)
+        if (parentNode.Children[i]->numStars > 0) {
+            requestNodeData(parentNode.Children[i]);
         }
 
         // Fetch all Children's Children if recursive is set to true!
         if (additionalLevelsToFetch != 0 && !parentNode.Children[i]->isLeaf) {
-            fetchChildrenNodes(*parentNode.Children[i], --additionalLevelsToFetch);
+            fetchChildrenNodes(*parentNode.Children[i], additionalLevelsToFetch - 1);
         }
     }
 }
 
-void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
+void OctreeManager::requestNodeData(const std::shared_ptr<OctreeNode>& node) {
+    const unsigned long long id = node->octreePositionIndex;
+
+    // Mark node as most recently requested.
+    if (!_datasetFitInMemory) {
+        auto it = _requestedNodePositions.find(id);
+        if (it != _requestedNodePositions.end()) {
+            _leastRecentlyRequestedNodes.splice(
+                _leastRecentlyRequestedNodes.end(),
+                _leastRecentlyRequestedNodes,
+                it->second
+            );
+        }
+        else {
+            _requestedNodePositions[id] = _leastRecentlyRequestedNodes.insert(
+                _leastRecentlyRequestedNodes.end(),
+                id
+            );
+        }
+    }
+
+    if (node->isLoaded) {
+        return;
+    }
+
+    const glm::vec3 origin = glm::vec3(node->originX, node->originY, node->originZ);
+    const float distance = glm::length(origin - _cameraPosInKpc);
+    _nodeLoader->request(id, distance, [this, node]() { loadNodeData(*node); });
+}
+
+void OctreeManager::loadNodeData(OctreeNode& node) {
+    // Make sure nobody else is accessing the node while it is loading.
+    std::lock_guard lock(node.loadingLock);
+    if (node.isLoaded) {
+        return;
+    }
+
+    // Reserve the memory in the RAM budget before reading. If there is no room left the
+    // node will be requested again after other nodes have been removed.
+    const long long nBytes = static_cast<long long>(
+        node.numStars * _valuesPerStar * sizeof(float)
+    );
+    if (_cpuRamBudget.fetch_sub(nBytes) < nBytes) {
+        _cpuRamBudget += nBytes;
+        return;
+    }
+
+    if (!fetchNodeDataFromFile(node)) {
+        _cpuRamBudget += nBytes;
+    }
+}
+
+bool OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
     // Remove root ID ("8") from index before loading file.
     std::string posId = std::to_string(node.octreePositionIndex);
     posId.erase(posId.begin());
@@ -787,39 +907,47 @@ void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
     std::ifstream inFileStream(inFilePath, std::ifstream::binary);
     // LINFO("Fetch node data file: " + inFilePath);
 
-    if (inFileStream.good()) {
-        // Read node data.
-        int32_t nDataSize = 0;
+    if (!inFileStream.good()) {
+        LERROR("Error opening node data file: " + inFilePath);
+        return false;
+    }
 
-        // Octree knows if we have any data in this node = it exists.
-        // Otherwise don't call this function!
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+    // Read node data.
+    int32_t nDataSize = 0;
 
-        std::vector<float> readData(nDataSize, 0.f);
-        int nBytes = nDataSize * sizeof(readData[0]);
-        if (nDataSize > 0) {
-            inFileStream.read(reinterpret_cast<char*>(&readData[0]), nBytes);
-        }
+    // Octree knows if we have any data in this node = it exists.
+    // Otherwise don't call this function!
+    inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
 
-        int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-        auto posEnd = readData.begin() + (starsInNode * POS_SIZE);
-        auto colEnd = posEnd + (starsInNode * COL_SIZE);
-        auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-        node.posData = std::vector<float>(readData.begin(), posEnd);
-        node.colData = std::vector<float>(posEnd, colEnd);
-        node.velData = std::vector<float>(colEnd, velEnd);
-
-        // Keep track of nodes that are loaded and update CPU RAM budget.
-        node.isLoaded = true;
-        if (!_datasetFitInMemory) {
-            std::lock_guard g(_leastRecentlyFetchedNodesMutex);
-            _leastRecentlyFetchedNodes.push(node.octreePositionIndex);
-        }
-        _cpuRamBudget -= nBytes;
-    }
-    else {
-        LERROR("Error opening node data file: " + inFilePath);
+    // Read the data straight into the node without an intermediate copy.
+    const size_t starsInNode = nDataSize / _valuesPerStar;
+    node.posData.resize(starsInNode * POS_SIZE);
+    node.colData.resize(starsInNode * COL_SIZE);
+    node.velData.resize(starsInNode * VEL_SIZE);
+    inFileStream.read(
+        reinterpret_cast<char*>(node.posData.data()),
+        node.posData.size() * sizeof(float)
+    );
+    inFileStream.read(
+        reinterpret_cast<char*>(node.colData.data()),
+        node.colData.size() * sizeof(float)
+    );
+    inFileStream.read(
+        reinterpret_cast<char*>(node.velData.data()),
+        node.velData.size() * sizeof(float)
+    );
+
+    if (!inFileStream.good()) {
+        LERROR("Error reading node data file: " + inFilePath);
+        node.posData.clear();
+        node.colData.clear();
+        node.velData.clear();
+        return false;
     }
+
+    // Keep track of nodes that are loaded.
+    node.isLoaded = true;
+    return true;
 }
 
 void OctreeManager::removeNodesFromRam(
@@ -941,7 +1069,7 @@ bool OctreeManager::isRebuildOngoing() const {
 }
 
 size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float origX,
-                                    float origY, float origZ)
+                                    float origY, float origZ) const
 {
     size_t index = 0;
     if (posX < origX) {
@@ -963,9 +1091,12 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
         // Node is a leaf and it's not yet full -> insert star.
         storeStarData(node, starValues);
 
-        if (depth > _totalDepth) {
-            _totalDepth = depth;
-        }
+        // Other branches might be updating the depth at the same time.
+        const size_t nodeDepth = static_cast<size_t>(depth);
+        size_t totalDepth = _totalDepth;
+        while (nodeDepth > totalDepth &&
+               !_totalDepth.compare_exchange_weak(totalDepth, nodeDepth))
+        {}
         return true;
     }
     else if (node.isLeaf) {
@@ -1098,17 +1229,14 @@ std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
     }
 }
 
-std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNode& node,
-                                                                    const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                                          int& deltaStars,
-                                                                gaia::RenderOption option)
+void OctreeManager::checkNodeIntersection(OctreeNode& node, const glm::dmat4& mvp,
+                                          const glm::vec2& screenSize, int& deltaStars,
+                                          gaia::RenderOption option)
 {
-    std::map<int, std::vector<float>> fetchedData;
     //int depth  = static_cast<int>(log2( MAX_DIST / node->halfDimension ));
 
     // Calculate the corners of the node.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     for (int i = 0; i < 8; ++i) {
         const float x = (i % 2 == 0) ?
             node.originX + node.halfDimension :
@@ -1127,8 +1255,8 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (!(_culler->isVisible(corners, mvp))) {
         // Check if this node or any of its children existed in cache previously.
         // If so, then remove them from cache and add those indices to stack.
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(node, deltaStars);
+        return;
     }
 
     // Remove node if it has been unloaded while still in view.
@@ -1136,8 +1264,8 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (node.bufferIndex != DEFAULT_INDEX && !node.isLoaded && _streamOctree &&
         !_datasetFitInMemory)
     {
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(node, deltaStars);
+        return;
     }
 
     // Take care of inner nodes.
@@ -1155,86 +1283,61 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
             // Get correct insert index from stack if node didn't exist already. Otherwise
             // we will overwrite the old data. Key merging is not a problem here.
             if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
-                // Return empty if we couldn't claim a buffer stream index.
+                // Return early if we couldn't claim a buffer stream index.
                 if (!updateBufferIndex(node)) {
-                    return fetchedData;
+                    return;
                 }
 
                 // We're in an inner node, remove indices from potential children in cache
                 for (int i = 0; i < 8; ++i) {
-                    std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                        *node.Children[i],
-                        deltaStars
-                    );
-                    fetchedData.insert(tmpData.begin(), tmpData.end());
+                    removeNodeFromCache(*node.Children[i], deltaStars);
                 }
 
                 // Insert data and adjust stars added in this frame.
-                fetchedData[node.bufferIndex] = constructInsertData(
-                    node,
-                    option,
-                    deltaStars
-                );
+                stageNodeData(node, option, deltaStars);
             }
-            return fetchedData;
+            return;
         }
     }
     // Return node data if node is a leaf.
     else {
         // If node already is in cache then skip it, otherwise store it.
         if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
-            // Return empty if we couldn't claim a buffer stream index.
+            // Return early if we couldn't claim a buffer stream index.
             if (!updateBufferIndex(node)) {
-                return fetchedData;
+                return;
             }
 
             // Insert data and adjust stars added in this frame.
-            fetchedData[node.bufferIndex] = constructInsertData(
-                node,
-                option,
-                deltaStars
-            );
+            stageNodeData(node, option, deltaStars);
         }
-        return fetchedData;
+        return;
     }
 
     // We're in a big, visible inner node -> remove it from cache if it existed.
     // But not its children -> set recursive check to false.
-    fetchedData = removeNodeFromCache(node, deltaStars, false);
+    removeNodeFromCache(node, deltaStars, false);
 
     // Recursively check if children should be rendered.
     for (size_t i = 0; i < 8; ++i) {
-        // Observe that if there exists identical keys in fetchedData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *node.Children[i],
-            mvp,
-            screenSize,
-            deltaStars,
-            option
-        );
-        fetchedData.insert(tmpData.begin(), tmpData.end());
+        checkNodeIntersection(*node.Children[i], mvp, screenSize, deltaStars, option);
     }
-    return fetchedData;
 }
 
-std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode& node,
-                                                                     int& deltaStars,
-                                                                     bool recursive)
+void OctreeManager::removeNodeFromCache(OctreeNode& node, int& deltaStars,
+                                        bool recursive)
 {
-    std::map<int, std::vector<float>> keysToRemove;
-
     // If we're in rebuilding mode then there is no need to remove any nodes.
-    //if (_rebuildBuffer) return keysToRemove;
+    //if (_rebuildBuffer) return;
 
     // Check if this node was rendered == had a specified index.
     if (node.bufferIndex != DEFAULT_INDEX) {
 
         // Reclaim that index. We need to wait until next render call to use it again!
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        _removedKeysInPrevCall.push_back(node.bufferIndex);
 
         // Insert dummy node at offset index that should be removed from render.
-        keysToRemove[node.bufferIndex] = std::vector<float>();
+        stageRemovedChunk(node.bufferIndex);
 
         // Reset index and adjust stars removed this frame.
         node.bufferIndex = DEFAULT_INDEX;
@@ -1244,32 +1347,63 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
     // Check children recursively if we're in an inner node.
     if (!(node.isLeaf) && recursive) {
         for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *node.Children[i],
-                deltaStars
-            );
-            keysToRemove.insert(tmpData.begin(), tmpData.end());
+            removeNodeFromCache(*node.Children[i], deltaStars);
         }
     }
-    return keysToRemove;
 }
 
-std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
-                                              gaia::RenderOption option)
+void OctreeManager::stageRemovedChunk(int bufferIndex) {
+    if (bufferIndex >= static_cast<int>(_stagedChunks.size())) {
+        // Only happens for indices of a buffer that was larger before a rebuild.
+        _stagedChunks.resize(bufferIndex + 1, -1);
+    }
+
+    // A chunk that already received new data this render call should keep it.
+    if (_stagedChunks[bufferIndex] != -1) {
+        return;
+    }
+
+    _stagedChunks[bufferIndex] = static_cast<int>(_bufferUpdates.chunks.size());
+    _bufferUpdates.chunks.push_back({ bufferIndex, _bufferUpdates.values.size(), 0 });
+}
+
+void OctreeManager::stageNodeData(const OctreeNode& node, gaia::RenderOption option,
+                                  int& deltaStars)
+{
+    if (node.bufferIndex >= static_cast<int>(_stagedChunks.size())) {
+        _stagedChunks.resize(node.bufferIndex + 1, -1);
+    }
+
+    const size_t offset = _bufferUpdates.values.size();
+    constructInsertData(node, option, deltaStars, _bufferUpdates.values);
+    const size_t size = _bufferUpdates.values.size() - offset;
+
+    // Overwrite a chunk that was cleared earlier in this render call.
+    const int staged = _stagedChunks[node.bufferIndex];
+    if (staged != -1) {
+        _bufferUpdates.chunks[staged].offset = offset;
+        _bufferUpdates.chunks[staged].size = size;
+    }
+    else {
+        _stagedChunks[node.bufferIndex] = static_cast<int>(_bufferUpdates.chunks.size());
+        _bufferUpdates.chunks.push_back({ node.bufferIndex, offset, size });
+    }
+}
+
+void OctreeManager::getNodeData(const OctreeNode& node, gaia::RenderOption option,
+                                std::vector<float>& data)
 {
     // Return node data if node is a leaf.
     if (node.isLeaf) {
         int dStars = 0;
-        return constructInsertData(node, option, dStars);
+        constructInsertData(node, option, dStars, data);
+        return;
     }
 
     // If we're not in a leaf, get data from all children recursively.
-    auto nodeData = std::vector<float>();
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*node.Children[i], option);
-        nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
+        getNodeData(*node.Children[i], option, data);
     }
-    return nodeData;
 }
 
 void OctreeManager::clearNodeData(OctreeNode& node) {
@@ -1333,7 +1467,7 @@ void OctreeManager::createNodeChildren(OctreeNode& node) {
 bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     if (node.bufferIndex != DEFAULT_INDEX) {
         // If we're rebuilding Buffer Index Cache then store indices to overwrite later.
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        _removedKeysInPrevCall.push_back(node.bufferIndex);
     }
 
     // Make sure node isn't loading/unloading as we're checking isLoaded flag.
@@ -1361,31 +1495,32 @@ bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     return true;
 }
 
-std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
-                                                      gaia::RenderOption option,
-                                                      int& deltaStars)
+void OctreeManager::constructInsertData(const OctreeNode& node,
+                                        gaia::RenderOption option, int& deltaStars,
+                                        std::vector<float>& data)
 {
     // Return early if node doesn't contain any stars!
     if (node.numStars == 0) {
-        return std::vector<float>();
+        return;
     }
 
     // Fill chunk by appending zeroes to data so we overwrite possible earlier values.
     // And more importantly so our attribute pointers knows where to read!
-    auto insertData = std::vector<float>(node.posData.begin(), node.posData.end());
+    const size_t offset = data.size();
+    data.insert(data.end(), node.posData.begin(), node.posData.end());
     if (_useVBO) {
-        insertData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
+        data.resize(offset + POS_SIZE * MAX_STARS_PER_NODE, 0.f);
     }
     if (option != gaia::RenderOption::Static) {
-        insertData.insert(insertData.end(), node.colData.begin(), node.colData.end());
+        data.insert(data.end(), node.colData.begin(), node.colData.end());
         if (_useVBO) {
-            insertData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
+            data.resize(offset + (POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
         }
         if (option == gaia::RenderOption::Motion) {
-            insertData.insert(insertData.end(), node.velData.begin(), node.velData.end());
+            data.insert(data.end(), node.velData.begin(), node.velData.end());
             if (_useVBO) {
-                insertData.resize(
-                    (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
+                data.resize(
+                    offset + (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
                 );
             }
         }
@@ -1393,7 +1528,6 @@ std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
 
     // Update deltaStars.
     deltaStars += static_cast<int>(node.numStars);
-    return insertData;
 }
 
 }  // namespace openspace
@@ -28,15 +28,18 @@
 #include <modules/gaia/rendering/gaiaoptions.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
-#include <map>
+#include <atomic>
+#include <list>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 namespace openspace {
 
 class OctreeCuller;
+class OctreeNodeLoader;
 
 class OctreeManager {
 public:
@@ -59,8 +62,29 @@ public:
         unsigned long long octreePositionIndex;
     };
 
+    /**
+     * The changes to the streaming buffer that were found in one call to
+     * <code>traverseData()</code>. The values of all updated chunks are stored back to
+     * back in one staging arena that is reused between render calls, so that no memory
+     * is allocated once the arena has grown to the size of the largest update.
+     */
+    struct BufferUpdates {
+        struct Chunk {
+            /// The index of the chunk in the streaming buffer
+            int bufferIndex;
+            /// The offset of the first value of the chunk in <code>values</code>
+            size_t offset;
+            /// The number of values of the chunk. Chunks without values are cleared
+            size_t size;
+        };
+
+        /// One entry per updated chunk, sorted by buffer index
+        std::vector<Chunk> chunks;
+        std::vector<float> values;
+    };
+
     OctreeManager() = default;
-    ~OctreeManager() = default;
+    ~OctreeManager();
 
     /**
      * Initializes a one layer Octree with root and 8 children that covers all stars.
@@ -82,9 +106,17 @@ public:
     /**
      * Inserts star values in correct position in Octree. Makes use of a recursive
      * traversal strategy. Internally calls <code>insertInNode()</code>
+     * Stars that belong to different branches can be inserted from different threads at
+     * the same time, as long as each branch is only modified by one thread.
      */
     void insert(const std::vector<float>& starValues);
 
+    /**
+     * \returns the index of the branch, i.e. the child of the root, that a star at
+     * position (\p posX, \p posY, \p posZ) would be inserted into.
+     */
+    size_t branchIndex(float posX, float posY, float posZ) const;
+
     /**
      * Slices LOD data so only the MAX_STARS_PER_NODE brightest stars are stored in inner
      * nodes. If \p branchIndex is defined then only that branch will be sliced.
@@ -102,25 +134,27 @@ public:
     /**
      * Used while streaming nodes from files. Checks if any nodes need to be loaded or
      * unloaded. If entire dataset fits in RAM then the whole dataset will be loaded
-     * asynchronously. Otherwise only nodes close to the camera will be fetched.
-     * When RAM stars to fill up least-recently used nodes will start to unload.
-     * Calls <code>findAndFetchNeighborNode()</code> and
-     * <code>removeNodesFromRam()</code> internally.
+     * asynchronously, closest nodes first. Otherwise only nodes close to the camera, and
+     * close to where the camera will be if it keeps its current velocity, will be
+     * fetched. Requests for nodes that are no longer close are cancelled.
+     * When RAM stars to fill up least-recently requested nodes will start to unload.
+     * Calls <code>fetchNeighborhood()</code> and <code>removeNodesFromRam()</code>
+     * internally.
      */
     void fetchSurroundingNodes(const glm::dvec3& cameraPos, size_t chunkSizeInBytes,
         const glm::ivec2& additionalNodes);
 
     /**
      * Builds render data structure by traversing the Octree and checking for intersection
-     * with view frustum. Every vector in map contains data for one node.
-     * The corresponding integer key is the index where chunk should be inserted into
-     * streaming buffer. Calls <code>checkNodeIntersection()</code> for every branch.
+     * with view frustum. Every chunk in the returned updates contains the data for one
+     * node and the index where it should be inserted into the streaming buffer. The
+     * returned reference is valid until the next call. Calls
+     * <code>checkNodeIntersection()</code> for every branch.
      * \pdeltaStars keeps track of how many stars that were added/removed this render
      * call.
      */
-    std::map<int, std::vector<float>> traverseData(const glm::dmat4& mvp,
-        const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option,
-        float lodPixelThreshold);
+    const BufferUpdates& traverseData(const glm::dmat4& mvp, const glm::vec2& screenSize,
+        int& deltaStars, gaia::RenderOption option, float lodPixelThreshold);
 
     /**
      * Builds full render data structure by traversing all leaves in the Octree.
@@ -203,7 +237,7 @@ private:
      * \returns the correct index of child node. Maps [1,1,1] to 0 and [-1,-1,-1] to 7.
      */
     size_t getChildIndex(float posX, float posY, float posZ, float origX = 0.f,
-        float origY = 0.f, float origZ = 0.f);
+        float origY = 0.f, float origZ = 0.f) const;
 
     /**
      * Private help function for <code>insert()</code>. Inserts star into node if leaf and
@@ -242,9 +276,8 @@ private:
      * loaded (if streaming). \param deltaStars keeps track of how many stars that were
      * added/removed this render call.
      */
-    std::map<int, std::vector<float>> checkNodeIntersection(OctreeNode& node,
-        const glm::dmat4& mvp, const glm::vec2& screenSize, int& deltaStars,
-        gaia::RenderOption option);
+    void checkNodeIntersection(OctreeNode& node, const glm::dmat4& mvp,
+        const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option);
 
     /**
      * Checks if specified node existed in cache, and removes it if that's the case.
@@ -252,13 +285,28 @@ private:
      * long as \param recursive is not set to false. \param deltaStars keeps track of how
      * many stars that were removed.
      */
-    std::map<int, std::vector<float>> removeNodeFromCache(OctreeNode& node,
-        int& deltaStars, bool recursive = true);
+    void removeNodeFromCache(OctreeNode& node, int& deltaStars, bool recursive = true);
 
     /**
-     * Get data in node and its descendants regardless if they are visible or not.
+     * Stages a chunk without values for \param bufferIndex, which clears that chunk in
+     * the streaming buffer, unless the chunk already was updated in this render call.
      */
-    std::vector<float> getNodeData(const OctreeNode& node, gaia::RenderOption option);
+    void stageRemovedChunk(int bufferIndex);
+
+    /**
+     * Stages the data of \param node for its buffer index. This replaces any earlier
+     * update of that chunk in this render call. \param deltaStars keeps track of how
+     * many stars that were added.
+     */
+    void stageNodeData(const OctreeNode& node, gaia::RenderOption option,
+        int& deltaStars);
+
+    /**
+     * Appends the data in node and its descendants to \param data regardless if they
+     * are visible or not.
+     */
+    void getNodeData(const OctreeNode& node, gaia::RenderOption option,
+        std::vector<float>& data);
 
     /**
      * Clear data from node and its descendants and shrink vectors to deallocate memory.
@@ -278,14 +326,15 @@ private:
     bool updateBufferIndex(OctreeNode& node);
 
     /**
-     * Node should be inserted into stream. This function \returns the data to be
-     * inserted. If VBOs are used then the chunks will be appended by zeros, otherwise
-     * only the star data corresponding to RenderOption \param option will be inserted.
+     * Node should be inserted into stream. This function appends the data to be inserted
+     * to \param data. If VBOs are used then the chunks will be appended by zeros,
+     * otherwise only the star data corresponding to RenderOption \param option will be
+     * inserted.
      *
      * \param deltaStars keeps track of how many stars that were added.
      */
-    std::vector<float> constructInsertData(const OctreeNode& node,
-        gaia::RenderOption option, int& deltaStars);
+    void constructInsertData(const OctreeNode& node, gaia::RenderOption option,
+        int& deltaStars, std::vector<float>& data);
 
     /**
      * Write a node to outFileStream. \param writeData defines if data should be included
@@ -309,6 +358,19 @@ private:
     void writeNodeToMultipleFiles(const std::string& outFilePrefix, OctreeNode& node,
         bool threadWrites);
 
+    /**
+     * \returns the octree position index of the leaf node that contains \param position,
+     * which is specified in meters.
+     */
+    unsigned long long findLeafNodeId(const glm::dvec3& position) const;
+
+    /**
+     * Fetches the nodes surrounding the leaf \param leafId. \param additionalNodes
+     * determines how many parent levels (x) and how many levels of descendants (y) of
+     * the neighbors are fetched as well.
+     */
+    void fetchNeighborhood(unsigned long long leafId, const glm::ivec2& additionalNodes);
+
     /**
      * Finds the neighboring node on the same level (or a higher level if there is no
      * corresponding level) in the specified direction. Also fetches data from found node
@@ -319,21 +381,35 @@ private:
         int additionalLevelsToFetch);
 
     /**
-     * Fetches data from all children of \param parentNode, as long as it's not already
-     * fetched, it exists and it can fit in RAM.
+     * Requests data for all children of \param parentNode, as long as it's not already
+     * fetched and it exists.
      * \param additionalLevelsToFetch determines how many levels of descendants to fetch.
      * If it is set to 0 no additional level will be fetched.
      * If it is set to a negative value then all descendants will be fetched recursively.
-     * Calls <code>fetchNodeDataFromFile()</code> for every child that passes the tests.
+     * Calls <code>requestNodeData()</code> for every child.
      */
     void fetchChildrenNodes(OctreeNode& parentNode, int additionalLevelsToFetch);
 
     /**
-     * Fetches data for specified node from file.
+     * Requests data for the specified node from the node loader, prioritized by its
+     * distance to the camera, unless it is already loaded. Also marks the node as the
+     * most recently requested node, which protects it from being removed from RAM.
+     */
+    void requestNodeData(const std::shared_ptr<OctreeNode>& node);
+
+    /**
+     * Loads data for specified node on a loader thread if there is still room for it in
+     * the CPU RAM budget.
+     */
+    void loadNodeData(OctreeNode& node);
+
+    /**
+     * Fetches data for specified node from file. \returns false if the file couldn't be
+     * read.
      * OBS! Only call if node file exists (i.e. node has any data, node->numStars > 0)
      * and is not already loaded.
      */
-    void fetchNodeDataFromFile(OctreeNode& node);
+    bool fetchNodeDataFromFile(OctreeNode& node);
 
     /**
     * Loops though all nodes in \param nodesToRemove and clears them from RAM.
@@ -358,13 +434,23 @@ private:
     std::shared_ptr<OctreeNode> _root;
     std::unique_ptr<OctreeCuller> _culler;
     std::stack<int> _freeSpotsInBuffer;
-    std::set<int> _removedKeysInPrevCall;
-    std::queue<unsigned long long> _leastRecentlyFetchedNodes;
-    std::mutex _leastRecentlyFetchedNodesMutex;
-
-    size_t _totalDepth = 0;
-    size_t _numLeafNodes = 0;
-    size_t _numInnerNodes = 0;
+    std::vector<int> _removedKeysInPrevCall;
+
+    // The updates of the current render call and, for every buffer index, the position
+    // of its chunk in the updates or -1 if the chunk hasn't been updated
+    BufferUpdates _bufferUpdates;
+    std::vector<int> _stagedChunks;
+
+    // The streamed nodes in the order in which they were requested, most recent last,
+    // and the position of every node in that list. Only used on the main thread
+    std::list<unsigned long long> _leastRecentlyRequestedNodes;
+    std::unordered_map<unsigned long long, std::list<unsigned long long>::iterator>
+        _requestedNodePositions;
+
+    // Atomic as the branches of the Octree can be constructed concurrently
+    std::atomic<size_t> _totalDepth = 0;
+    std::atomic<size_t> _numLeafNodes = 0;
+    std::atomic<size_t> _numInnerNodes = 0;
     size_t _biggestChunkIndexInUse = 0;
     size_t _valuesPerStar = 0;
     float _minTotalPixelsLod = 0.f;
@@ -374,12 +460,18 @@ private:
     bool _useVBO = false;
     bool _streamOctree = false;
     bool _datasetFitInMemory = false;
-    long long _cpuRamBudget = 0;
+    std::atomic<long long> _cpuRamBudget = 0;
     long long _maxCpuRamBudget = 0;
     unsigned long long _parentNodeOfCamera = 8;
+    unsigned long long _parentNodeOfPrediction = 8;
+    glm::dvec3 _previousCameraPos = glm::dvec3(0.0);
+    glm::vec3 _cameraPosInKpc = glm::vec3(0.f);
     std::string _streamFolderPath;
     size_t _traversedBranchesInRenderCall = 0;
 
+    // Destroyed first so that no loads are running while the nodes are destroyed
+    std::unique_ptr<OctreeNodeLoader> _nodeLoader;
+
 }; // class OctreeManager
 
 }  // namespace openspace
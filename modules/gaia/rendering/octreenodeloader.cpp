@@ -0,0 +1,159 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/octreenodeloader.h>
+
+#include <ghoul/misc/assert.h>
+
+namespace openspace {
+
+OctreeNodeLoader::OctreeNodeLoader(size_t nThreads) {
+    ghoul_assert(nThreads > 0, "Need at least one worker thread");
+
+    _workers.reserve(nThreads);
+    for (size_t i = 0; i < nThreads; ++i) {
+        _workers.emplace_back([this]() { worker(); });
+    }
+}
+
+OctreeNodeLoader::~OctreeNodeLoader() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+        _requests.clear();
+        _order.clear();
+    }
+    _workAvailable.notify_all();
+    for (std::thread& t : _workers) {
+        t.join();
+    }
+}
+
+void OctreeNodeLoader::beginRequests() {
+    std::lock_guard lock(_mutex);
+    _round++;
+}
+
+void OctreeNodeLoader::request(NodeId id, float priority, std::function<void()> load) {
+    {
+        std::lock_guard lock(_mutex);
+        if (_running.find(id) != _running.end()) {
+            return;
+        }
+
+        auto it = _requests.find(id);
+        if (it != _requests.end()) {
+            // Already queued, move it to its new place in the order
+            _order.erase({ it->second.priority, id });
+            it->second.priority = priority;
+            it->second.round = _round;
+            _order.insert({ priority, id });
+            return;
+        }
+
+        _requests[id] = { priority, _round, std::move(load) };
+        _order.insert({ priority, id });
+    }
+    _workAvailable.notify_one();
+}
+
+size_t OctreeNodeLoader::cancelStaleRequests() {
+    std::lock_guard lock(_mutex);
+    size_t nCancelled = 0;
+    for (auto it = _requests.begin(); it != _requests.end();) {
+        if (it->second.round != _round) {
+            _order.erase({ it->second.priority, it->first });
+            it = _requests.erase(it);
+            nCancelled++;
+        }
+        else {
+            ++it;
+        }
+    }
+    if (_running.empty() && _requests.empty()) {
+        _idle.notify_all();
+    }
+    return nCancelled;
+}
+
+void OctreeNodeLoader::cancelAllRequests() {
+    std::lock_guard lock(_mutex);
+    _requests.clear();
+    _order.clear();
+    if (_running.empty()) {
+        _idle.notify_all();
+    }
+}
+
+void OctreeNodeLoader::waitUntilIdle() {
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [this]() { return _requests.empty() && _running.empty(); });
+}
+
+bool OctreeNodeLoader::isPending(NodeId id) const {
+    std::lock_guard lock(_mutex);
+    return _requests.find(id) != _requests.end() || _running.find(id) != _running.end();
+}
+
+size_t OctreeNodeLoader::numQueuedRequests() const {
+    std::lock_guard lock(_mutex);
+    return _requests.size();
+}
+
+size_t OctreeNodeLoader::numThreads() const {
+    return _workers.size();
+}
+
+void OctreeNodeLoader::worker() {
+    while (true) {
+        NodeId id;
+        std::function<void()> load;
+        {
+            std::unique_lock lock(_mutex);
+            _workAvailable.wait(lock, [this]() { return _stop || !_order.empty(); });
+            if (_stop) {
+                return;
+            }
+
+            id = _order.begin()->second;
+            _order.erase(_order.begin());
+            auto it = _requests.find(id);
+            load = std::move(it->second.load);
+            _requests.erase(it);
+            _running.insert(id);
+        }
+
+        load();
+
+        {
+            std::lock_guard lock(_mutex);
+            _running.erase(id);
+            if (_running.empty() && _requests.empty()) {
+                _idle.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace openspace
@@ -0,0 +1,131 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
+#define __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Loads the data of streamed Octree nodes from disk on a fixed number of worker threads.
+ *
+ * Requests are identified by the octree position index of their node and are executed
+ * in the order of their priority, where a lower value is loaded first. The OctreeManager
+ * uses the distance between the node and the camera as the priority. Requests are
+ * grouped into rounds: every time the camera moves into a new node, a new round is
+ * started with #beginRequests, all nodes that are needed are requested again, and all
+ * requests that were queued in an earlier round but not requested again are cancelled
+ * by #cancelStaleRequests.
+ *
+ * The functions of this class, apart from the worker threads, are only called from the
+ * main thread. Loads that are already running can not be cancelled; the destructor
+ * discards all queued requests and waits for the running ones.
+ */
+class OctreeNodeLoader {
+public:
+    using NodeId = unsigned long long;
+
+    /**
+     * \param nThreads The number of worker threads that load node data
+     */
+    explicit OctreeNodeLoader(size_t nThreads);
+    ~OctreeNodeLoader();
+
+    /**
+     * Starts a new round of requests. All requests that are queued at this point are
+     * stale until they are requested again.
+     */
+    void beginRequests();
+
+    /**
+     * Requests that \p load is executed for the node \p id with the provided
+     * \p priority. If the node is already queued, its priority is updated and it is no
+     * longer stale, but \p load is not replaced. Requests for nodes that are currently
+     * loaded are ignored.
+     */
+    void request(NodeId id, float priority, std::function<void()> load);
+
+    /**
+     * Removes all queued requests that have not been requested since the last call to
+     * #beginRequests.
+     *
+     * \return The number of requests that were cancelled
+     */
+    size_t cancelStaleRequests();
+
+    /**
+     * Removes all queued requests. Loads that are currently running are not affected.
+     */
+    void cancelAllRequests();
+
+    /**
+     * Blocks until no requests are queued or running anymore.
+     */
+    void waitUntilIdle();
+
+    /// Returns \c true if the node \p id is queued or currently loaded
+    bool isPending(NodeId id) const;
+
+    /// The number of requests that are waiting to be loaded
+    size_t numQueuedRequests() const;
+
+    /// The number of worker threads of this loader
+    size_t numThreads() const;
+
+private:
+    struct Request {
+        float priority;
+        uint64_t round;
+        std::function<void()> load;
+    };
+
+    void worker();
+
+    // The queued requests and their order of execution
+    std::unordered_map<NodeId, Request> _requests;
+    std::set<std::pair<float, NodeId>> _order;
+    std::unordered_set<NodeId> _running;
+    uint64_t _round = 0;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _idle;
+    bool _stop = false;
+    std::vector<std::thread> _workers;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
@@ -46,6 +46,7 @@
 #include <array>
 #include <fstream>
 #include <cstdint>
+#include <set>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableGaiaStars";
@@ -1173,10 +1174,10 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         _cpuRamBudgetProperty = static_cast<float>(_octreeManager.cpuRamBudget());
     }
 
-    // Traverse Octree and build a map with new nodes to render, uses mvp matrix to decide
+    // Traverse Octree and stage the nodes to render, uses mvp matrix to decide
     const int renderOption = _renderOption;
     int deltaStars = 0;
-    std::map<int, std::vector<float>> updateData = _octreeManager.traverseData(
+    const OctreeManager::BufferUpdates& updates = _octreeManager.traverseData(
         modelViewProjMat,
         screenSize,
         deltaStars,
@@ -1208,16 +1209,28 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         int lastValue = _accumulatedIndices.back();
         _accumulatedIndices.resize(nChunksToRender + 1, lastValue);
 
-        // Update vector with accumulated indices.
-        for (const auto& [offset, subData] : updateData) {
-            int newValue = static_cast<int>(subData.size() / _nRenderValuesPerStar) +
-                           _accumulatedIndices[offset];
-            int changeInValue = newValue - _accumulatedIndices[offset + 1];
-            _accumulatedIndices[offset + 1] = newValue;
-            // Propagate change.
-            for (int i = offset + 1; i < nChunksToRender; ++i) {
-                _accumulatedIndices[i + 1] += changeInValue;
+        // Update vector with accumulated indices. The updated chunks are sorted by their
+        // index, so the changes can be propagated in a single pass.
+        int changeInValue = 0;
+        size_t nextIndex = 0;
+        for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
+            const size_t offset = static_cast<size_t>(chunk.bufferIndex);
+            if (offset + 1 >= _accumulatedIndices.size()) {
+                break;
+            }
+            // Propagate change up to this chunk.
+            for (; nextIndex <= offset; ++nextIndex) {
+                _accumulatedIndices[nextIndex] += changeInValue;
             }
+            const int oldStars = _accumulatedIndices[offset + 1] -
+                                 (_accumulatedIndices[offset] - changeInValue);
+            const int newStars = static_cast<int>(chunk.size / _nRenderValuesPerStar);
+            _accumulatedIndices[offset + 1] = _accumulatedIndices[offset] + newStars;
+            changeInValue += newStars - oldStars;
+            nextIndex = offset + 2;
+        }
+        for (; nextIndex < _accumulatedIndices.size(); ++nextIndex) {
+            _accumulatedIndices[nextIndex] += changeInValue;
         }
 
         // Fix number of stars rendered if it doesn't correspond to our buffers.
@@ -1247,16 +1260,15 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         );
 
         // Update SSBO with one insert per chunk/node.
-        // The key in map holds the offset index.
-        for (const auto &[offset, subData] : updateData) {
+        for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
             // We don't need to fill chunk with zeros for SSBOs!
             // Just check if we have any values to update.
-            if (!subData.empty()) {
+            if (chunk.size > 0) {
                 glBufferSubData(
                     GL_SHADER_STORAGE_BUFFER,
-                    offset * _chunkSize * sizeof(GLfloat),
-                    subData.size() * sizeof(GLfloat),
-                    subData.data()
+                    chunk.bufferIndex * _chunkSize * sizeof(GLfloat),
+                    chunk.size * sizeof(GLfloat),
+                    updates.values.data() + chunk.offset
                 );
             }
         }
@@ -1270,6 +1282,17 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         // This will overwrite old data that's not visible anymore as well.
         glBindVertexArray(_vao);
 
+        // Chunks with data are already filled up with zeroes by the octree. Removed
+        // chunks are overwritten with zeroes so that no earlier values remain.
+        if (_zeroChunk.size() < _chunkSize) {
+            _zeroChunk.resize(_chunkSize, 0.f);
+        }
+        auto chunkData = [&](const OctreeManager::BufferUpdates::Chunk& chunk) {
+            return chunk.size > 0 ?
+                updates.values.data() + chunk.offset :
+                _zeroChunk.data();
+        };
+
         // Always update Position VBO.
         glBindBuffer(GL_ARRAY_BUFFER, _vboPos);
         float posMemoryShare = static_cast<float>(PositionSize) / _nRenderValuesPerStar;
@@ -1287,18 +1310,12 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         );
 
         // Update buffer with one insert per chunk/node.
-        //The key in map holds the offset index.
-        for (const auto& [offset, subData] : updateData) {
-            // Fill chunk by appending zeroes so we overwrite possible earlier values.
-            // Only required when removing nodes because chunks are filled up in octree
-            // fetch on add.
-            std::vector<float> vectorData(subData.begin(), subData.end());
-            vectorData.resize(posChunkSize, 0.f);
+        for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
             glBufferSubData(
                 GL_ARRAY_BUFFER,
-                offset * posChunkSize * sizeof(GLfloat),
+                chunk.bufferIndex * posChunkSize * sizeof(GLfloat),
                 posChunkSize * sizeof(GLfloat),
-                vectorData.data()
+                chunkData(chunk)
             );
         }
 
@@ -1320,16 +1337,12 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             );
 
             // Update buffer with one insert per chunk/node.
-            //The key in map holds the offset index.
-            for (const auto& [offset, subData] : updateData) {
-                // Fill chunk by appending zeroes so we overwrite possible earlier values.
-                std::vector<float> vectorData(subData.begin(), subData.end());
-                vectorData.resize(posChunkSize + colChunkSize, 0.f);
+            for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
                 glBufferSubData(
                     GL_ARRAY_BUFFER,
-                    offset * colChunkSize * sizeof(GLfloat),
+                    chunk.bufferIndex * colChunkSize * sizeof(GLfloat),
                     colChunkSize * sizeof(GLfloat),
-                    vectorData.data() + posChunkSize
+                    chunkData(chunk) + posChunkSize
                 );
             }
 
@@ -1352,16 +1365,12 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                 );
 
                 // Update buffer with one insert per chunk/node.
-                //The key in map holds the offset index.
-                for (const auto& [offset, subData] : updateData) {
-                    // Fill chunk by appending zeroes.
-                    std::vector<float> vectorData(subData.begin(), subData.end());
-                    vectorData.resize(_chunkSize, 0.f);
+                for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
                     glBufferSubData(
                         GL_ARRAY_BUFFER,
-                        offset * velChunkSize * sizeof(GLfloat),
+                        chunk.bufferIndex * velChunkSize * sizeof(GLfloat),
                         velChunkSize * sizeof(GLfloat),
-                        vectorData.data() + posChunkSize + colChunkSize
+                        chunkData(chunk) + posChunkSize + colChunkSize
                     );
                 }
             }
@@ -188,6 +188,7 @@ private:
         ghoul::opengl::bufferbinding::Buffer::ShaderStorage>> _ssboDataBinding;
 
     std::vector<int> _accumulatedIndices;
+    std::vector<float> _zeroChunk;
     size_t _nRenderValuesPerStar = 0;
     int _nStarsToRender = 0;
     bool _firstDrawCalls = true;
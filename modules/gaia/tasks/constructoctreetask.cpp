@@ -26,12 +26,18 @@
 
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/directory.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <fstream>
+#include <future>
 #include <thread>
 
 namespace {
@@ -40,6 +46,7 @@ namespace {
     constexpr const char* KeyMaxDist = "MaxDist";
     constexpr const char* KeyMaxStarsPerNode = "MaxStarsPerNode";
     constexpr const char* KeySingleFileInput = "SingleFileInput";
+    constexpr const char* KeyThreadsToUse = "ThreadsToUse";
 
     constexpr const char* KeyFilterPosX = "FilterPosX";
     constexpr const char* KeyFilterPosY = "FilterPosY";
@@ -67,6 +74,65 @@ namespace {
     constexpr const char* KeyFilterRvError = "FilterRvError";
 
     constexpr const char* _loggerCat = "ConstructOctreeTask";
+
+    struct FilterColumn {
+        const char* key;
+        size_t column;
+        float normValue;
+    };
+
+    // The column in the preprocessed star data that every filter applies to. Magnitudes
+    // use 20 as the value for an open range as that is the default for missing values
+    constexpr const FilterColumn FilterColumns[] = {
+        { KeyFilterPosX, 0, 0.f },
+        { KeyFilterPosY, 1, 0.f },
+        { KeyFilterPosZ, 2, 0.f },
+        { KeyFilterGMag, 3, 20.f },
+        { KeyFilterBpRp, 4, 0.f },
+        { KeyFilterVelX, 5, 0.f },
+        { KeyFilterVelY, 6, 0.f },
+        { KeyFilterVelZ, 7, 0.f },
+        { KeyFilterBpMag, 8, 20.f },
+        { KeyFilterRpMag, 9, 20.f },
+        { KeyFilterBpG, 10, 0.f },
+        { KeyFilterGRp, 11, 0.f },
+        { KeyFilterRa, 12, 0.f },
+        { KeyFilterRaError, 13, 0.f },
+        { KeyFilterDec, 14, 0.f },
+        { KeyFilterDecError, 15, 0.f },
+        { KeyFilterParallax, 16, 0.f },
+        { KeyFilterParallaxError, 17, 0.f },
+        { KeyFilterPmra, 18, 0.f },
+        { KeyFilterPmraError, 19, 0.f },
+        { KeyFilterPmdec, 20, 0.f },
+        { KeyFilterPmdecError, 21, 0.f },
+        { KeyFilterRv, 22, 0.f },
+        { KeyFilterRvError, 23, 0.f }
+    };
+
+    // The number of stars that are read from a file and filtered at a time
+    constexpr const size_t StarsPerBlock = 1 << 16;
+
+    // There is no use for more threads than there are branches in the Octree
+    constexpr const size_t MaxThreads = 8;
+
+    // Waits for all branch \p futures to finish while reporting the \p progress
+    template <typename T>
+    std::vector<T> waitForBranches(std::vector<std::future<T>>& futures,
+                                   const std::function<float()>& progress,
+                                   const openspace::Task::ProgressCallback& onProgress)
+    {
+        std::vector<T> results;
+        for (std::future<T>& future : futures) {
+            while (future.wait_for(std::chrono::milliseconds(100)) !=
+                   std::future_status::ready)
+            {
+                onProgress(progress());
+            }
+            results.push_back(future.get());
+        }
+        return results;
+    }
 } // namespace
 
 namespace openspace {
@@ -93,105 +159,31 @@ ConstructOctreeTask::ConstructOctreeTask(const ghoul::Dictionary& dictionary) {
         _singleFileInput = dictionary.value<bool>(KeySingleFileInput);
     }
 
+    // Every thread constructs one branch at a time, so it is a trade-off against RAM.
+    _threadsToUse = std::thread::hardware_concurrency();
+    if (dictionary.hasKey(KeyThreadsToUse)) {
+        const double threadsToUse = dictionary.value<double>(KeyThreadsToUse);
+        if (threadsToUse < 1.0) {
+            LINFO(fmt::format(
+                "User defined ThreadsToUse was: {}. Will be set to 1", threadsToUse
+            ));
+        }
+        _threadsToUse = static_cast<size_t>(std::max(threadsToUse, 1.0));
+    }
+    _threadsToUse = std::clamp(_threadsToUse, size_t(1), MaxThreads);
+
     _octreeManager = std::make_shared<OctreeManager>();
     _indexOctreeManager = std::make_shared<OctreeManager>();
 
     // Check for filter params.
-    if (dictionary.hasKey(KeyFilterPosX)) {
-        _posX = dictionary.value<glm::vec2>(KeyFilterPosX);
-        _filterPosX = true;
-    }
-    if (dictionary.hasKey(KeyFilterPosY)) {
-        _posY = dictionary.value<glm::vec2>(KeyFilterPosY);
-        _filterPosY = true;
-    }
-    if (dictionary.hasKey(KeyFilterPosZ)) {
-        _posZ = dictionary.value<glm::vec2>(KeyFilterPosZ);
-        _filterPosZ = true;
-    }
-    if (dictionary.hasKey(KeyFilterGMag)) {
-        _gMag = dictionary.value<glm::vec2>(KeyFilterGMag);
-        _filterGMag = true;
-    }
-    if (dictionary.hasKey(KeyFilterBpRp)) {
-        _bpRp = dictionary.value<glm::vec2>(KeyFilterBpRp);
-        _filterBpRp = true;
-    }
-    if (dictionary.hasKey(KeyFilterVelX)) {
-        _velX = dictionary.value<glm::vec2>(KeyFilterVelX);
-        _filterVelX = true;
-    }
-    if (dictionary.hasKey(KeyFilterVelY)) {
-        _velY = dictionary.value<glm::vec2>(KeyFilterVelY);
-        _filterVelY = true;
-    }
-    if (dictionary.hasKey(KeyFilterVelZ)) {
-        _velZ = dictionary.value<glm::vec2>(KeyFilterVelZ);
-        _filterVelZ = true;
-    }
-    if (dictionary.hasKey(KeyFilterBpMag)) {
-        _bpMag = dictionary.value<glm::vec2>(KeyFilterBpMag);
-        _filterBpMag = true;
-    }
-    if (dictionary.hasKey(KeyFilterRpMag)) {
-        _rpMag = dictionary.value<glm::vec2>(KeyFilterRpMag);
-        _filterRpMag = true;
-    }
-    if (dictionary.hasKey(KeyFilterBpG)) {
-        _bpG = dictionary.value<glm::vec2>(KeyFilterBpG);
-        _filterBpG = true;
-    }
-    if (dictionary.hasKey(KeyFilterGRp)) {
-        _gRp = dictionary.value<glm::vec2>(KeyFilterGRp);
-        _filterGRp = true;
-    }
-    if (dictionary.hasKey(KeyFilterRa)) {
-        _ra = dictionary.value<glm::vec2>(KeyFilterRa);
-        _filterRa = true;
-    }
-    if (dictionary.hasKey(KeyFilterRaError)) {
-        _raError = dictionary.value<glm::vec2>(KeyFilterRaError);
-        _filterRaError = true;
-    }
-    if (dictionary.hasKey(KeyFilterDec)) {
-        _dec = dictionary.value<glm::vec2>(KeyFilterDec);
-        _filterDec = true;
-    }
-    if (dictionary.hasKey(KeyFilterDecError)) {
-        _decError = dictionary.value<glm::vec2>(KeyFilterDecError);
-        _filterDecError = true;
-    }
-    if (dictionary.hasKey(KeyFilterParallax)) {
-        _parallax = dictionary.value<glm::vec2>(KeyFilterParallax);
-        _filterParallax = true;
-    }
-    if (dictionary.hasKey(KeyFilterParallaxError)) {
-        _parallaxError = dictionary.value<glm::vec2>(KeyFilterParallaxError);
-        _filterParallaxError = true;
-    }
-    if (dictionary.hasKey(KeyFilterPmra)) {
-        _pmra = dictionary.value<glm::vec2>(KeyFilterPmra);
-        _filterPmra = true;
-    }
-    if (dictionary.hasKey(KeyFilterPmraError)) {
-        _pmraError = dictionary.value<glm::vec2>(KeyFilterPmraError);
-        _filterPmraError = true;
-    }
-    if (dictionary.hasKey(KeyFilterPmdec)) {
-        _pmdec = dictionary.value<glm::vec2>(KeyFilterPmdec);
-        _filterPmdec = true;
-    }
-    if (dictionary.hasKey(KeyFilterPmdecError)) {
-        _pmdecError = dictionary.value<glm::vec2>(KeyFilterPmdecError);
-        _filterPmdecError = true;
-    }
-    if (dictionary.hasKey(KeyFilterRv)) {
-        _rv = dictionary.value<glm::vec2>(KeyFilterRv);
-        _filterRv = true;
-    }
-    if (dictionary.hasKey(KeyFilterRvError)) {
-        _rvError = dictionary.value<glm::vec2>(KeyFilterRvError);
-        _filterRvError = true;
+    for (const FilterColumn& filter : FilterColumns) {
+        if (dictionary.hasKey(filter.key)) {
+            _filters.push_back({
+                filter.column,
+                dictionary.value<glm::vec2>(filter.key),
+                filter.normValue
+            });
+        }
     }
 }
 
@@ -220,7 +212,7 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
     int32_t nValues = 0;
     int32_t nValuesPerStar = 0;
     size_t nFilteredStars = 0;
-    int nTotalStars = 0;
+    size_t nTotalStars = 0;
 
     _octreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
 
@@ -280,28 +272,70 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
             reinterpret_cast<char*>(fullData.data()),
             nValues * sizeof(fullData[0])
         );
+        inFileStream.close();
+
+        if (nValuesPerStar < RENDER_VALUES) {
+            LERROR(fmt::format(
+                "Error reading file '{}' - Expected at least {} values per star, got {}",
+                _inFileOrFolderPath, RENDER_VALUES, nValuesPerStar
+            ));
+            return;
+        }
         nTotalStars = nValues / nValuesPerStar;
 
         progressCallback(0.3f);
         LINFO("Constructing Octree.");
 
-        // Insert star into octree. We assume the data already is in correct order.
-        for (size_t i = 0; i < fullData.size(); i += nValuesPerStar) {
-            auto first = fullData.begin() + i;
-            auto last = fullData.begin() + i + nValuesPerStar;
-            std::vector<float> filterValues(first, last);
-            std::vector<float> renderValues(first, first + RENDER_VALUES);
-
-            // Filter data by parameters.
-            if (checkAllFilters(filterValues)) {
+        // Filter data by parameters and partition the stars by branch.
+        std::vector<uint8_t> passed;
+        filterStars(fullData.data(), nTotalStars, nValuesPerStar, passed);
+        std::vector<uint8_t> branches(nTotalStars, 8);
+        for (size_t i = 0; i < nTotalStars; ++i) {
+            if (!passed[i]) {
                 nFilteredStars++;
                 continue;
             }
+            const float* star = fullData.data() + i * nValuesPerStar;
+            branches[i] = static_cast<uint8_t>(
+                _octreeManager->branchIndex(star[0], star[1], star[2])
+            );
+        }
 
-            // If all filters passed then insert render values into Octree.
-            _octreeManager->insert(renderValues);
+        // Insert stars into octree, one thread per branch. We assume the data already is
+        // in correct order, which is kept within every branch.
+        std::atomic<size_t> nInsertedStars = 0;
+        ThreadPool threadPool(_threadsToUse);
+        std::vector<std::future<size_t>> futures;
+        for (size_t branch = 0; branch < 8; ++branch) {
+            futures.push_back(threadPool.submit([&, branch]() {
+                std::vector<float> renderValues(RENDER_VALUES);
+                size_t nInserted = 0;
+                for (size_t i = 0; i < nTotalStars; ++i) {
+                    if (branches[i] != branch) {
+                        continue;
+                    }
+                    const float* star = fullData.data() + i * nValuesPerStar;
+                    renderValues.assign(star, star + RENDER_VALUES);
+                    _octreeManager->insert(renderValues);
+
+                    if (++nInserted % StarsPerBlock == 0) {
+                        nInsertedStars += StarsPerBlock;
+                    }
+                }
+                nInsertedStars += nInserted % StarsPerBlock;
+
+                // Slice LOD data before writing to file.
+                _octreeManager->sliceLodData(branch);
+                return nInserted;
+            }));
         }
-        inFileStream.close();
+
+        const float nPassedStars = static_cast<float>(nTotalStars - nFilteredStars);
+        waitForBranches(
+            futures,
+            [&]() { return 0.3f + 0.6f * nInsertedStars / std::max(nPassedStars, 1.f); },
+            progressCallback
+        );
     }
     else {
         LERROR(fmt::format(
@@ -311,9 +345,6 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
     }
     LINFO(fmt::format("{} of {} read stars were filtered", nFilteredStars, nTotalStars));
 
-    // Slice LOD data before writing to files.
-    _octreeManager->sliceLodData();
-
     LINFO("Writing octree to: " + _outFileOrFolderPath);
     std::ofstream outFileStream(_outFileOrFolderPath, std::ofstream::binary);
     if (outFileStream.good()) {
@@ -334,153 +365,80 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
 void ConstructOctreeTask::constructOctreeFromFolder(
                                            const Task::ProgressCallback& progressCallback)
 {
-    int32_t nStars = 0;
-    int32_t nValuesPerStar = 0;
-    size_t nFilteredStars = 0;
-    //float maxRadius = 0.0;
-    //int starsOutside10 = 0;
-    //int starsOutside25 = 0;
-    //int starsOutside50 = 0;
-    //int starsOutside75 = 0;
-    //int starsOutside100 = 0;
-    //int starsOutside200 = 0;
-    //int starsOutside300 = 0;
-    //int starsOutside400 = 0;
-    //int starsOutside500 = 0;
-    //int starsOutside750 = 0;
-    //int starsOutside1000 = 0;
-    //int starsOutside1500 = 0;
-    //int starsOutside2000 = 0;
-    //int starsOutside5000 = 0;
-
     ghoul::filesystem::Directory currentDir(_inFileOrFolderPath);
     std::vector<std::string> allInputFiles = currentDir.readFiles();
-    std::vector<float> filterValues;
-    auto writeThreads = std::vector<std::thread>(8);
 
-    _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
+    // The files are named after the branch they contain (octant_0.bin - octant_7.bin).
+    std::sort(allInputFiles.begin(), allInputFiles.end());
+    if (allInputFiles.size() != 8) {
+        LERROR(fmt::format(
+            "Expected one file per branch in '{}' but found {} files",
+            _inFileOrFolderPath, allInputFiles.size()
+        ));
+        return;
+    }
 
-    float processOneFile = 1.f / allInputFiles.size();
+    _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
 
     LINFO(fmt::format(
         "MAX DIST: {} - MAX STARS PER NODE: {}",
         _indexOctreeManager->maxDist(), _indexOctreeManager->maxStarsPerNode()
     ));
 
-    for (size_t idx = 0; idx < allInputFiles.size(); ++idx) {
-        std::string inFilePath = allInputFiles[idx];
-        int nStarsInfile = 0;
-
-        LINFO("Reading data file: " + inFilePath);
-
-        std::ifstream inFileStream(inFilePath, std::ifstream::binary);
+    size_t nTotalBytes = 0;
+    for (const std::string& inFilePath : allInputFiles) {
+        std::ifstream inFileStream(
+            inFilePath,
+            std::ifstream::binary | std::ifstream::ate
+        );
         if (inFileStream.good()) {
-            inFileStream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
-            filterValues.resize(nValuesPerStar, 0.f);
-
-            while (inFileStream.read(
-                reinterpret_cast<char*>(filterValues.data()),
-                nValuesPerStar * sizeof(filterValues[0])
-            ))
-            {
-                // Filter data by parameters.
-                if (checkAllFilters(filterValues)) {
-                    nFilteredStars++;
-                    continue;
-                }
-                // Generate a 50/12,5 dataset (gMag <=13/>13).
-                //if ((filterStar(glm::vec2(20.0), filterValues[3], 20.f)) ||
-                //    (filterStar(glm::vec2(0.0), filterValues[16])) ||
-                //    (filterValues[3] > 13.0 && filterValues[17] > 0.125) ||
-                //    (filterValues[3] <= 13.0 && filterValues[17] > 0.5)) {
-                //    nFilteredStars++;
-                //    continue;
-                //}
-
-                // If all filters passed then insert render values into Octree.
-                std::vector<float> renderValues(
-                    filterValues.begin(),
-                    filterValues.begin() + RENDER_VALUES
-                );
-
-                _indexOctreeManager->insert(renderValues);
-                nStarsInfile++;
-
-                //float maxVal = fmax(fmax(fabs(renderValues[0]), fabs(renderValues[1])),
-                //    fabs(renderValues[2]));
-                //if (maxVal > maxRadius) maxRadius = maxVal;
-                //// Calculate how many stars are outside of different thresholds.
-                //if (maxVal > 10) starsOutside10++;
-                //if (maxVal > 25) starsOutside25++;
-                //if (maxVal > 50) starsOutside50++;
-                //if (maxVal > 75) starsOutside75++;
-                //if (maxVal > 100) starsOutside100++;
-                //if (maxVal > 200) starsOutside200++;
-                //if (maxVal > 300) starsOutside300++;
-                //if (maxVal > 400) starsOutside400++;
-                //if (maxVal > 500) starsOutside500++;
-                //if (maxVal > 750) starsOutside750++;
-                //if (maxVal > 1000) starsOutside1000++;
-                //if (maxVal > 1500) starsOutside1500++;
-                //if (maxVal > 2000) starsOutside2000++;
-                //if (maxVal > 5000) starsOutside5000++;
-            }
-            inFileStream.close();
+            nTotalBytes += static_cast<size_t>(inFileStream.tellg());
         }
-        else {
-            LERROR(fmt::format(
-                "Error opening file '{}' for loading preprocessed file!", inFilePath
-            ));
-        }
-
-        // Slice LOD data.
-        LINFO("Slicing LOD data!");
-        _indexOctreeManager->sliceLodData(idx);
-
-        progressCallback((idx + 1) * processOneFile);
-        nStars += nStarsInfile;
+    }
 
-        LINFO(fmt::format("Writing {} stars to octree files!", nStarsInfile));
-        LINFO(fmt::format(
-            "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
-            _indexOctreeManager->numLeafNodes(),
-            _indexOctreeManager->numInnerNodes(),
-            _indexOctreeManager->totalDepth()
-        ));
+    // Construct the branches in parallel. A branch is written to files and cleared from
+    // RAM as soon as it's done, so only the branches that are being constructed are
+    // kept in RAM.
+    LINFO(fmt::format("Constructing {} branches at a time", _threadsToUse));
+    std::atomic<size_t> processedBytes = 0;
+    ThreadPool threadPool(_threadsToUse);
+    std::vector<std::future<BranchStatistics>> futures;
+    for (size_t idx = 0; idx < allInputFiles.size(); ++idx) {
+        const std::string& inFilePath = allInputFiles[idx];
+        futures.push_back(threadPool.submit([this, &inFilePath, &processedBytes, idx]() {
+            return constructBranchFromFile(inFilePath, idx, processedBytes);
+        }));
+    }
+    const std::vector<BranchStatistics> allStatistics = waitForBranches(
+        futures,
+        [&]() { return processedBytes / (2.f * std::max(nTotalBytes, size_t(1))); },
+        progressCallback
+    );
 
-        // Write to 8 separate files in a separate thread. Data will be cleared after it
-        // has been written. Store joinable thread for later sync.
-        std::thread t(
-            &OctreeManager::writeToMultipleFiles,
-            _indexOctreeManager,
-            _outFileOrFolderPath,
-            idx
-        );
-        writeThreads[idx] = std::move(t);
+    BranchStatistics total;
+    for (const BranchStatistics& statistics : allStatistics) {
+        total.nInsertedStars += statistics.nInsertedStars;
+        total.nFilteredStars += statistics.nFilteredStars;
+        total.nMisplacedStars += statistics.nMisplacedStars;
     }
 
     LINFO(fmt::format(
         "A total of {} stars were read from files and distributed into {} total nodes",
-        nStars, _indexOctreeManager->totalNodes()
+        total.nInsertedStars, _indexOctreeManager->totalNodes()
+    ));
+    LINFO(fmt::format(
+        "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
+        _indexOctreeManager->numLeafNodes(),
+        _indexOctreeManager->numInnerNodes(),
+        _indexOctreeManager->totalDepth()
     ));
-    LINFO(std::to_string(nFilteredStars) + " stars were filtered");
-
-    //LINFO("Max radius of dataset is: " + std::to_string(maxRadius) +
-    //    "\n Number of stars outside of:" +
-    //    " - 10kPc is " + std::to_string(starsOutside10) + "\n" +
-    //    " - 25kPc is " + std::to_string(starsOutside25) + "\n" +
-    //    " - 50kPc is " + std::to_string(starsOutside50) + "\n" +
-    //    " - 75kPc is " + std::to_string(starsOutside75) + "\n" +
-    //    " - 100kPc is " + std::to_string(starsOutside100) + "\n" +
-    //    " - 200kPc is " + std::to_string(starsOutside200) + "\n" +
-    //    " - 300kPc is " + std::to_string(starsOutside300) + "\n" +
-    //    " - 400kPc is " + std::to_string(starsOutside400) + "\n" +
-    //    " - 500kPc is " + std::to_string(starsOutside500) + "\n" +
-    //    " - 750kPc is " + std::to_string(starsOutside750) + "\n" +
-    //    " - 1000kPc is " + std::to_string(starsOutside1000) + "\n" +
-    //    " - 1500kPc is " + std::to_string(starsOutside1500) + "\n" +
-    //    " - 2000kPc is " + std::to_string(starsOutside2000) + "\n" +
-    //    " - 5000kPc is " + std::to_string(starsOutside5000));
+    LINFO(std::to_string(total.nFilteredStars) + " stars were filtered");
+    if (total.nMisplacedStars > 0) {
+        LWARNING(fmt::format(
+            "{} stars were skipped as they were stored in the file of another branch",
+            total.nMisplacedStars
+        ));
+    }
 
     // Write index file of Octree structure.
     std::string indexFileOutPath = _outFileOrFolderPath + "index.bin";
@@ -496,50 +454,122 @@ void ConstructOctreeTask::constructOctreeFromFolder(
             "Error opening file: {} as index output file.", indexFileOutPath
         ));
     }
+}
+
+ConstructOctreeTask::BranchStatistics ConstructOctreeTask::constructBranchFromFile(
+                                                           const std::string& inFilePath,
+                                                                       size_t branchIndex,
+                                                      std::atomic<size_t>& processedBytes)
+{
+    BranchStatistics statistics;
 
-    // Make sure all threads are done.
-    for (int i = 0; i < 8; ++i) {
-        writeThreads[i].join();
+    LINFO("Reading data file: " + inFilePath);
+
+    std::ifstream inFileStream(inFilePath, std::ifstream::binary);
+    if (!inFileStream.good()) {
+        LERROR(fmt::format(
+            "Error opening file '{}' for loading preprocessed file!", inFilePath
+        ));
+        return statistics;
     }
-}
 
-bool ConstructOctreeTask::checkAllFilters(const std::vector<float>& filterValues) {
-    // Return true if star is caught in any filter.
-    return (_filterPosX && filterStar(_posX, filterValues[0])) ||
-        (_filterPosY && filterStar(_posY, filterValues[1])) ||
-        (_filterPosZ && filterStar(_posZ, filterValues[2])) ||
-        (_filterGMag && filterStar(_gMag, filterValues[3], 20.f)) ||
-        (_filterBpRp && filterStar(_bpRp, filterValues[4])) ||
-        (_filterVelX && filterStar(_velX, filterValues[5])) ||
-        (_filterVelY && filterStar(_velY, filterValues[6])) ||
-        (_filterVelZ && filterStar(_velZ, filterValues[7])) ||
-        (_filterBpMag && filterStar(_bpMag, filterValues[8], 20.f)) ||
-        (_filterRpMag && filterStar(_rpMag, filterValues[9], 20.f)) ||
-        (_filterBpG && filterStar(_bpG, filterValues[10])) ||
-        (_filterGRp && filterStar(_gRp, filterValues[11])) ||
-        (_filterRa && filterStar(_ra, filterValues[12])) ||
-        (_filterRaError && filterStar(_raError, filterValues[13])) ||
-        (_filterDec && filterStar(_dec, filterValues[14])) ||
-        (_filterDecError && filterStar(_decError, filterValues[15])) ||
-        (_filterParallax && filterStar(_parallax, filterValues[16])) ||
-        (_filterParallaxError && filterStar(_parallaxError, filterValues[17])) ||
-        (_filterPmra && filterStar(_pmra, filterValues[18])) ||
-        (_filterPmraError && filterStar(_pmraError, filterValues[19])) ||
-        (_filterPmdec && filterStar(_pmdec, filterValues[20])) ||
-        (_filterPmdecError && filterStar(_pmdecError, filterValues[21])) ||
-        (_filterRv && filterStar(_rv, filterValues[22])) ||
-        (_filterRvError && filterStar(_rvError, filterValues[23]));
+    int32_t nValuesPerStar = 0;
+    inFileStream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
+    if (nValuesPerStar < RENDER_VALUES) {
+        LERROR(fmt::format(
+            "Error reading file '{}' - Expected at least {} values per star, got {}",
+            inFilePath, RENDER_VALUES, nValuesPerStar
+        ));
+        return statistics;
+    }
+    size_t nBytesRead = sizeof(int32_t);
+    processedBytes += sizeof(int32_t);
+
+    // Read the file in blocks so that only the branch itself has to fit in RAM.
+    const size_t starSize = nValuesPerStar * sizeof(float);
+    std::vector<float> block(StarsPerBlock * nValuesPerStar);
+    std::vector<uint8_t> passed;
+    std::vector<float> renderValues(RENDER_VALUES);
+
+    while (inFileStream.read(reinterpret_cast<char*>(block.data()), block.size() *
+           sizeof(float)) || inFileStream.gcount() > 0)
+    {
+        const size_t nBytes = static_cast<size_t>(inFileStream.gcount());
+        const size_t nStars = nBytes / starSize;
+
+        // Filter data by parameters.
+        filterStars(block.data(), nStars, nValuesPerStar, passed);
+
+        for (size_t i = 0; i < nStars; ++i) {
+            if (!passed[i]) {
+                statistics.nFilteredStars++;
+                continue;
+            }
+
+            // The other branches are constructed by other threads.
+            const float* star = block.data() + i * nValuesPerStar;
+            if (_indexOctreeManager->branchIndex(star[0], star[1], star[2]) !=
+                branchIndex)
+            {
+                statistics.nMisplacedStars++;
+                continue;
+            }
+
+            // If all filters passed then insert render values into Octree.
+            renderValues.assign(star, star + RENDER_VALUES);
+            _indexOctreeManager->insert(renderValues);
+            statistics.nInsertedStars++;
+        }
+
+        nBytesRead += nBytes;
+        processedBytes += nBytes;
+    }
+    inFileStream.close();
+
+    // Slice LOD data.
+    LINFO(fmt::format("Slicing LOD data of branch {}!", branchIndex));
+    _indexOctreeManager->sliceLodData(branchIndex);
+
+    // Write to 8 separate files. Data will be cleared after it has been written.
+    LINFO(fmt::format(
+        "Writing {} stars of branch {} to octree files!",
+        statistics.nInsertedStars, branchIndex
+    ));
+    _indexOctreeManager->writeToMultipleFiles(_outFileOrFolderPath, branchIndex);
+    processedBytes += nBytesRead;
+
+    return statistics;
 }
 
-bool ConstructOctreeTask::filterStar(const glm::vec2& range, float filterValue,
-                                     float normValue)
+void ConstructOctreeTask::filterStars(const float* values, size_t nStars,
+                                      size_t nValuesPerStar,
+                                      std::vector<uint8_t>& passed) const
 {
-    // Return true if star should be filtered away, i.e. if min = max = filterValue or
-    // if filterValue < min (when min != 0.0) or filterValue > max (when max != 0.0).
-    return (fabs(range.x - range.y) < FLT_EPSILON &&
-        fabs(range.x - filterValue) < FLT_EPSILON) ||
-        (fabs(range.x - normValue) > FLT_EPSILON && filterValue < range.x) ||
-        (fabs(range.y - normValue) > FLT_EPSILON && filterValue > range.y);
+    passed.assign(nStars, 1);
+
+    for (const StarFilter& filter : _filters) {
+        if (filter.column >= nValuesPerStar) {
+            continue;
+        }
+
+        // Resolve which parts of the range that are defined once for all stars.
+        const float min = filter.range.x;
+        const float max = filter.range.y;
+        const bool isEqualFilter = std::fabs(min - max) < FLT_EPSILON;
+        const bool hasMin = std::fabs(min - filter.normValue) > FLT_EPSILON;
+        const bool hasMax = std::fabs(max - filter.normValue) > FLT_EPSILON;
+
+        // Star is filtered either if min = max = value or if value < min (when min is
+        // defined) or value > max (when max is defined).
+        const float* value = values + filter.column;
+        for (size_t i = 0; i < nStars; ++i, value += nValuesPerStar) {
+            const bool isFiltered =
+                (isEqualFilter & (std::fabs(min - *value) < FLT_EPSILON)) |
+                (hasMin & (*value < min)) |
+                (hasMax & (*value > max));
+            passed[i] &= static_cast<uint8_t>(!isFiltered);
+        }
+    }
 }
 
 documentation::Documentation ConstructOctreeTask::Documentation() {
@@ -590,6 +620,15 @@ documentation::Documentation ConstructOctreeTask::Documentation() {
                 "binary file with the full Octree. If false then task will read all "
                 "files in specified folder and output multiple files for the Octree."
             },
+            {
+                KeyThreadsToUse,
+                new IntVerifier,
+                Optional::Yes,
+                "Defines how many branches of the Octree that are constructed in "
+                "parallel, at most 8. Every branch that is being constructed is kept in "
+                "RAM until it has been written. Defaults to the number of hardware "
+                "threads."
+            },
             {
                 KeyFilterPosX,
                 new Vector2Verifier<double>,
@@ -29,6 +29,7 @@
 
 #include <modules/gaia/rendering/octreeculler.h>
 #include <modules/gaia/rendering/octreemanager.h>
+#include <atomic>
 
 namespace openspace {
 
@@ -46,9 +47,30 @@ public:
 private:
     const int RENDER_VALUES = 8;
 
+    /**
+     * A filter range for one column of the preprocessed star data. A star is filtered
+     * away either if min = max = value, or if value < min (when min != normValue) or if
+     * value > max (when max != normValue).
+     */
+    struct StarFilter {
+        size_t column;
+        glm::vec2 range;
+        float normValue;
+    };
+
+    /**
+     * The number of stars that were read for one branch of the Octree.
+     */
+    struct BranchStatistics {
+        size_t nInsertedStars = 0;
+        size_t nFilteredStars = 0;
+        size_t nMisplacedStars = 0;
+    };
+
     /**
      * Reads a single binary file with preprocessed star data and insert the render values
      * into an octree structure (if star data passed all defined filters).
+     * The stars are partitioned by branch and the branches are constructed in parallel.
      * Stores the entire octree in one binary file.
      */
     void constructOctreeFromSingleFile(const Task::ProgressCallback& progressCallback);
@@ -57,85 +79,43 @@ private:
      *  Reads binary star data from 8 preprocessed files (one per branch) in specified
      * folder, prepared by ReadFitsTask, and inserts star render data into an octree
      * (if star data passed all defined filters).
+     * Up to <code>_threadsToUse</code> branches are constructed in parallel.
      * Stores octree structure in a binary index file and stores all render data
      * separate files, one file per node in the octree.
      */
     void constructOctreeFromFolder(const Task::ProgressCallback& progressCallback);
 
     /**
-     * Checks all defined filter ranges and \returns true if any of the corresponding
-     * <code>filterValues</code> are outside of the defined range.
-     * \returns false if value should be inserted into Octree.
-     * \param filterValues are all read filter values in binary file.
+     * Streams the stars in \p inFilePath through the filters in blocks, inserts them
+     * into branch \p branchIndex of the index octree and writes the finished branch to
+     * its node files, after which its data is cleared from RAM. \p processedBytes is
+     * increased by the number of bytes read and, once the branch is written, by the
+     * same number again.
      */
-    bool checkAllFilters(const std::vector<float>& filterValues);
+    BranchStatistics constructBranchFromFile(const std::string& inFilePath,
+        size_t branchIndex, std::atomic<size_t>& processedBytes);
 
     /**
-     * \returns true if star should be filtered away and false if all filters passed.
-     * \param range contains ]min, max[ and \param filterValue corresponding value in
-     * star. Star is filtered either if min = max = filterValue or if filterValue < min
-     * (when min != 0.0) or filterValue > max (when max != 0.0).
+     * Applies all defined filters to the \p nStars stars in \p values, that are stored
+     * with \p nValuesPerStar values per star. Sets \p passed to 1 for every star that
+     * passed all filters and to 0 for every star that should be filtered away. The
+     * filters are applied one column at a time for all stars.
      */
-    bool filterStar(const glm::vec2& range, float filterValue, float normValue = 0.f);
+    void filterStars(const float* values, size_t nStars, size_t nValuesPerStar,
+        std::vector<uint8_t>& passed) const;
 
     std::string _inFileOrFolderPath;
     std::string _outFileOrFolderPath;
     int _maxDist = 0;
     int _maxStarsPerNode = 0;
     bool _singleFileInput = false;
+    size_t _threadsToUse = 1;
 
     std::shared_ptr<OctreeManager> _octreeManager;
     std::shared_ptr<OctreeManager> _indexOctreeManager;
 
     // Filter params
-    glm::vec2 _posX = glm::vec2(0.f);
-    bool _filterPosX = false;
-    glm::vec2 _posY = glm::vec2(0.f);
-    bool _filterPosY = false;
-    glm::vec2 _posZ = glm::vec2(0.f);
-    bool _filterPosZ = false;
-    glm::vec2 _gMag = glm::vec2(0.f);
-    bool _filterGMag = false;
-    glm::vec2 _bpRp = glm::vec2(0.f);
-    bool _filterBpRp = false;
-    glm::vec2 _velX = glm::vec2(0.f);
-    bool _filterVelX = false;
-    glm::vec2 _velY = glm::vec2(0.f);
-    bool _filterVelY = false;
-    glm::vec2 _velZ = glm::vec2(0.f);
-    bool _filterVelZ = false;
-    glm::vec2 _bpMag = glm::vec2(0.f);
-    bool _filterBpMag = false;
-    glm::vec2 _rpMag = glm::vec2(0.f);
-    bool _filterRpMag = false;
-    glm::vec2 _bpG = glm::vec2(0.f);
-    bool _filterBpG = false;
-    glm::vec2 _gRp = glm::vec2(0.f);
-    bool _filterGRp = false;
-    glm::vec2 _ra = glm::vec2(0.f);
-    bool _filterRa = false;
-    glm::vec2 _raError = glm::vec2(0.f);
-    bool _filterRaError = false;
-    glm::vec2 _dec = glm::vec2(0.f);
-    bool _filterDec = false;
-    glm::vec2 _decError = glm::vec2(0.f);
-    bool _filterDecError = false;
-    glm::vec2 _parallax = glm::vec2(0.f);
-    bool _filterParallax = false;
-    glm::vec2 _parallaxError = glm::vec2(0.f);
-    bool _filterParallaxError = false;
-    glm::vec2 _pmra = glm::vec2(0.f);
-    bool _filterPmra = false;
-    glm::vec2 _pmraError = glm::vec2(0.f);
-    bool _filterPmraError = false;
-    glm::vec2 _pmdec = glm::vec2(0.f);
-    bool _filterPmdec = false;
-    glm::vec2 _pmdecError = glm::vec2(0.f);
-    bool _filterPmdecError = false;
-    glm::vec2 _rv = glm::vec2(0.f);
-    bool _filterRv = false;
-    glm::vec2 _rvError = glm::vec2(0.f);
-    bool _filterRvError = false;
+    std::vector<StarFilter> _filters;
 };
 
 } // namespace openspace
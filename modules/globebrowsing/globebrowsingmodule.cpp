@@ -26,20 +26,25 @@
 
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/dashboarditemglobelocation.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/gdalwrapper.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globetranslation.h>
+#include <modules/globebrowsing/src/heighttilecache.h>
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
+#include <modules/globebrowsing/src/tileioscheduler.h>
 #include <modules/globebrowsing/src/tileprovider.h>
 #include <openspace/interaction/navigationhandler.h>
 #include <openspace/interaction/orbitalnavigator.h>
 #include <openspace/engine/globalscallbacks.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/factorymanager.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/templatefactory.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
 #include <vector>
 
@@ -100,6 +105,65 @@ namespace {
         "The maximum size of the MemoryAwareTileCache, on the CPU and GPU."
     };
 
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheEnabledInfo = {
+        "DiskTileCacheEnabled",
+        "Disk Tile Cache Enabled",
+        "Determines whether tiles that are read from any dataset are stored in a "
+        "persistent cache on disk, from which they are loaded instead of reading them "
+        "from the dataset again. Changing the value of this property will not have an "
+        "effect until the application is restarted."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheLocationInfo = {
+        "DiskTileCacheLocation",
+        "Disk Tile Cache Location",
+        "The location of the folder in which the disk tile cache is stored. Changing the "
+        "value of this property will not have an effect until the application is "
+        "restarted."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheSizeInfo = {
+        "DiskTileCacheSize",
+        "Disk Tile Cache Size",
+        "The maximum size of the disk tile cache for all globes, in MB. Changing the "
+        "value of this property will not have an effect until the application is "
+        "restarted."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo TileIOThreadsInfo = {
+        "TileIOThreads",
+        "Tile IO Threads",
+        "The number of threads that are used to read the tiles of all globes. Changing "
+        "the value of this property will not have an effect until the application is "
+        "restarted."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo ChunkUpdateThreadsInfo =
+    {
+        "ChunkUpdateThreads",
+        "Chunk Update Threads",
+        "The number of threads that help with the culling and level of detail selection "
+        "of the chunks of all globes. If this value is 0, the chunks are evaluated on "
+        "the main thread only. Changing the value of this property will not have an "
+        "effect until the application is restarted."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo HeightTileCacheSizeInfo =
+    {
+        "HeightTileCacheSize",
+        "Height Tile Cache Size",
+        "The maximum number of height tiles that are kept on the CPU to sample the "
+        "height of all globes, for example to keep the camera above the surface. "
+        "Changing the value of this property will not have an effect until the "
+        "application is restarted."
+    };
+
+    // The maximum number of tile requests of all layers that are queued at once
+    constexpr const size_t TileIOQueueSize = 512;
+
 
     openspace::GlobeBrowsingModule::Capabilities
     parseSubDatasets(char** subDatasets, int nSubdatasets)
@@ -162,12 +226,24 @@ GlobeBrowsingModule::GlobeBrowsingModule()
     , _wmsCacheLocation(WMSCacheLocationInfo, "${BASE}/cache_gdal")
     , _wmsCacheSizeMB(WMSCacheSizeInfo, 1024)
     , _tileCacheSizeMB(TileCacheSizeInfo, 1024)
+    , _diskTileCacheEnabled(DiskTileCacheEnabledInfo, false)
+    , _diskTileCacheLocation(DiskTileCacheLocationInfo, "${BASE}/cache_tiles")
+    , _diskTileCacheSizeMB(DiskTileCacheSizeInfo, 4096)
+    , _tileIOThreads(TileIOThreadsInfo, 4, 1, 32)
+    , _chunkUpdateThreads(ChunkUpdateThreadsInfo, 2, 0, 32)
+    , _heightTileCacheSize(HeightTileCacheSizeInfo, 256, 16, 8192)
 {
     addProperty(_wmsCacheEnabled);
     addProperty(_offlineMode);
     addProperty(_wmsCacheLocation);
     addProperty(_wmsCacheSizeMB);
     addProperty(_tileCacheSizeMB);
+    addProperty(_diskTileCacheEnabled);
+    addProperty(_diskTileCacheLocation);
+    addProperty(_diskTileCacheSizeMB);
+    addProperty(_tileIOThreads);
+    addProperty(_chunkUpdateThreads);
+    addProperty(_heightTileCacheSize);
 }
 
 void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
@@ -192,6 +268,34 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
             dict.value<double>(TileCacheSizeInfo.identifier)
         );
     }
+    if (dict.hasKeyAndValue<bool>(DiskTileCacheEnabledInfo.identifier)) {
+        _diskTileCacheEnabled = dict.value<bool>(DiskTileCacheEnabledInfo.identifier);
+    }
+    if (dict.hasKeyAndValue<std::string>(DiskTileCacheLocationInfo.identifier)) {
+        _diskTileCacheLocation = dict.value<std::string>(
+            DiskTileCacheLocationInfo.identifier
+        );
+    }
+    if (dict.hasKeyAndValue<double>(DiskTileCacheSizeInfo.identifier)) {
+        _diskTileCacheSizeMB = static_cast<int>(
+            dict.value<double>(DiskTileCacheSizeInfo.identifier)
+        );
+    }
+    if (dict.hasKeyAndValue<double>(TileIOThreadsInfo.identifier)) {
+        _tileIOThreads = static_cast<int>(
+            dict.value<double>(TileIOThreadsInfo.identifier)
+        );
+    }
+    if (dict.hasKeyAndValue<double>(ChunkUpdateThreadsInfo.identifier)) {
+        _chunkUpdateThreads = static_cast<int>(
+            dict.value<double>(ChunkUpdateThreadsInfo.identifier)
+        );
+    }
+    if (dict.hasKeyAndValue<double>(HeightTileCacheSizeInfo.identifier)) {
+        _heightTileCacheSize = static_cast<int>(
+            dict.value<double>(HeightTileCacheSizeInfo.identifier)
+        );
+    }
 
     // Sanity check
     const bool noWarning = dict.hasKeyAndValue<bool>("NoWarning") ?
@@ -209,6 +313,40 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
     }
 
 
+    // The disk tile cache has to exist before the first tile provider is created
+    if (_diskTileCacheEnabled) {
+        try {
+            _diskTileCache = std::make_unique<cache::DiskTileCache>(
+                absPath(_diskTileCacheLocation),
+                static_cast<uint64_t>(_diskTileCacheSizeMB) * 1024ULL * 1024ULL
+            );
+            addPropertySubOwner(*_diskTileCache);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            // Most likely another instance is using the same cache directory
+            LERRORC(e.component, e.message);
+            LWARNING("Continuing without the disk tile cache");
+        }
+    }
+
+    // The tile IO scheduler is shared by all tile providers and has to exist before the
+    // first of them is created
+    _tileIOScheduler = std::make_unique<globebrowsing::TileIOScheduler>(
+        _tileIOThreads.value(),
+        TileIOQueueSize
+    );
+    addPropertySubOwner(*_tileIOScheduler);
+
+    // The thread pool has to exist before the first globe is created
+    if (_chunkUpdateThreads > 0) {
+        _chunkUpdateThreadPool = std::make_unique<ThreadPool>(
+            _chunkUpdateThreads.value()
+        );
+    }
+    _heightTileCache = std::make_unique<cache::HeightTileCache>(
+        _heightTileCacheSize.value()
+    );
+
     // Initialize
     global::callback::initializeGL.emplace_back([&]() {
         _tileCache = std::make_unique<globebrowsing::cache::MemoryAwareTileCache>(
@@ -232,10 +370,26 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
 
 
     // Render
-    global::callback::render.emplace_back([&]() { _tileCache->update(); });
+    global::callback::render.emplace_back([&]() {
+        _tileCache->update();
+        if (_diskTileCache) {
+            _diskTileCache->update();
+        }
+        _tileIOScheduler->update();
+    });
 
     // Deinitialize
-    global::callback::deinitialize.emplace_back([&]() { GdalWrapper::destroy(); });
+    global::callback::deinitialize.emplace_back([&]() {
+        removePropertySubOwner(*_tileIOScheduler);
+        _tileIOScheduler = nullptr;
+        _chunkUpdateThreadPool = nullptr;
+        _heightTileCache = nullptr;
+        if (_diskTileCache) {
+            removePropertySubOwner(*_diskTileCache);
+            _diskTileCache = nullptr;
+        }
+        GdalWrapper::destroy();
+    });
 
     auto fRenderable = FactoryManager::ref().factory<Renderable>();
     ghoul_assert(fRenderable, "Renderable factory was not created");
@@ -297,6 +451,22 @@ globebrowsing::cache::MemoryAwareTileCache* GlobeBrowsingModule::tileCache() {
     return _tileCache.get();
 }
 
+globebrowsing::cache::DiskTileCache* GlobeBrowsingModule::diskTileCache() {
+    return _diskTileCache.get();
+}
+
+globebrowsing::TileIOScheduler* GlobeBrowsingModule::tileIOScheduler() {
+    return _tileIOScheduler.get();
+}
+
+ThreadPool* GlobeBrowsingModule::chunkUpdateThreadPool() {
+    return _chunkUpdateThreadPool.get();
+}
+
+globebrowsing::cache::HeightTileCache* GlobeBrowsingModule::heightTileCache() {
+    return _heightTileCache.get();
+}
+
 scripting::LuaLibrary GlobeBrowsingModule::luaLibrary() const {
     std::string listLayerGroups = layerGroupNamesList();
 
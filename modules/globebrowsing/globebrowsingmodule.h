@@ -36,16 +36,22 @@
 
 namespace openspace::globebrowsing {
     class RenderableGlobe;
+    class TileIOScheduler;
     struct TileIndex;
     struct Geodetic2;
     struct Geodetic3;
 
-    namespace cache { class MemoryAwareTileCache; }
+    namespace cache {
+        class DiskTileCache;
+        class HeightTileCache;
+        class MemoryAwareTileCache;
+    } // namespace cache
 } // namespace openspace::globebrowsing
 
 namespace openspace {
 
 class Camera;
+class ThreadPool;
 
 class GlobeBrowsingModule : public OpenSpaceModule {
 public:
@@ -61,6 +67,30 @@ public:
         double latitude, double longitude, double altitude);
 
     globebrowsing::cache::MemoryAwareTileCache* tileCache();
+
+    /**
+     * \return the persistent tile cache that is shared between all tile providers, or
+     *         \c nullptr if the disk tile cache is disabled
+     */
+    globebrowsing::cache::DiskTileCache* diskTileCache();
+
+    /**
+     * \return the scheduler that reads the tiles for all tile providers of all globes
+     */
+    globebrowsing::TileIOScheduler* tileIOScheduler();
+
+    /**
+     * \return the CPU-side cache of height tiles that is used by all globes to sample
+     *         their height
+     */
+    globebrowsing::cache::HeightTileCache* heightTileCache();
+
+    /**
+     * \return the thread pool on which the globes evaluate their chunks, or
+     *         \c nullptr if the chunks are evaluated on the calling thread
+     */
+    ThreadPool* chunkUpdateThreadPool();
+
     scripting::LuaLibrary luaLibrary() const override;
     const globebrowsing::RenderableGlobe* castFocusNodeRenderableToGlobe();
 
@@ -118,8 +148,18 @@ private:
     properties::StringProperty _wmsCacheLocation;
     properties::UIntProperty _wmsCacheSizeMB;
     properties::UIntProperty _tileCacheSizeMB;
+    properties::BoolProperty _diskTileCacheEnabled;
+    properties::StringProperty _diskTileCacheLocation;
+    properties::UIntProperty _diskTileCacheSizeMB;
+    properties::UIntProperty _tileIOThreads;
+    properties::UIntProperty _chunkUpdateThreads;
+    properties::UIntProperty _heightTileCacheSize;
 
     std::unique_ptr<globebrowsing::cache::MemoryAwareTileCache> _tileCache;
+    std::unique_ptr<globebrowsing::cache::DiskTileCache> _diskTileCache;
+    std::unique_ptr<globebrowsing::TileIOScheduler> _tileIOScheduler;
+    std::unique_ptr<ThreadPool> _chunkUpdateThreadPool;
+    std::unique_ptr<globebrowsing::cache::HeightTileCache> _heightTileCache;
 
     // name -> capabilities
     std::map<std::string, std::future<Capabilities>> _inFlightCapabilitiesMap;
@@ -30,6 +30,7 @@
 #include <modules/globebrowsing/src/tileloadjob.h>
 #include <openspace/engine/moduleengine.h>
 #include <openspace/engine/globals.h>
+#include <openspace/util/job.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/ghoul_gl.h>
 
@@ -42,67 +43,88 @@ namespace {
 AsyncTileDataProvider::AsyncTileDataProvider(std::string name,
                                     std::unique_ptr<RawTileDataReader> rawTileDataReader)
     : _name(std::move(name))
+    , _globeBrowsingModule(global::moduleEngine.module<GlobeBrowsingModule>())
     , _rawTileDataReader(std::move(rawTileDataReader))
-    , _concurrentJobManager(LRUThreadPool<TileIndex::TileHashKey>(1, 10))
+    , _scheduler(*_globeBrowsingModule->tileIOScheduler())
+    , _schedulerClient(_scheduler.registerClient())
 {
-    _globeBrowsingModule = global::moduleEngine.module<GlobeBrowsingModule>();
     performReset(ResetRawTileDataReader::No);
 }
 
-AsyncTileDataProvider::~AsyncTileDataProvider() {} // NOLINT
+AsyncTileDataProvider::~AsyncTileDataProvider() {
+    // Blocks until the jobs that are reading from our RawTileDataReader have finished
+    _scheduler.unregisterClient(_schedulerClient);
+}
 
 const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
     return *_rawTileDataReader;
 }
 
+std::shared_ptr<const RawTileDataReader>
+AsyncTileDataProvider::sharedRawTileDataReader() const
+{
+    return _rawTileDataReader;
+}
+
 bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
     if (_resetMode == ResetMode::ShouldNotReset && satisfiesEnqueueCriteria(tileIndex)) {
-        auto job = std::make_unique<TileLoadJob>(*_rawTileDataReader, tileIndex);
-        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey());
-        _enqueuedTileRequests.insert(tileIndex.hashKey());
-        return true;
+        auto job = std::make_shared<TileLoadJob>(*_rawTileDataReader, tileIndex);
+        if (_scheduler.enqueue(_schedulerClient, tileIndex, std::move(job))) {
+            _enqueuedTileRequests.insert(tileIndex.hashKey());
+            return true;
+        }
     }
     return false;
 }
 
+void AsyncTileDataProvider::cancelTileIO(const TileIndex& tileIndex) {
+    _scheduler.cancel(_schedulerClient, tileIndex);
+}
+
 void AsyncTileDataProvider::clearTiles() {
-    std::optional<RawTile> finishedJob = popFinishedRawTile();
-    while (finishedJob) {
-        finishedJob = popFinishedRawTile();
+    while (_scheduler.numFinishedJobs(_schedulerClient) > 0) {
+        popFinishedRawTiles();
     }
 }
 
-std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
-    if (_concurrentJobManager.numFinishedJobs() > 0) {
-        // Now the tile load job looses ownerwhip of the data pointer
-        RawTile product = _concurrentJobManager.popFinishedJob()->product();
+std::vector<RawTile> AsyncTileDataProvider::popFinishedRawTiles() {
+    std::vector<std::shared_ptr<Job<RawTile>>> jobs =
+        _scheduler.popFinishedJobs(_schedulerClient);
 
-        const TileIndex::TileHashKey key = product.tileIndex.hashKey();
-        // No longer enqueued. Remove from set of enqueued tiles
-        _enqueuedTileRequests.erase(key);
-        // Pbo is still mapped. Set the id for the raw tile
-        if (product.error != RawTile::ReadError::None) {
-            product.imageData = nullptr;
-            return std::nullopt;
+    std::vector<RawTile> tiles;
+    tiles.reserve(jobs.size());
+    for (const std::shared_ptr<Job<RawTile>>& job : jobs) {
+        std::optional<RawTile> tile = finishRawTile(job->product());
+        if (tile) {
+            tiles.push_back(std::move(*tile));
         }
-
-        return product;
     }
-    else {
+    return tiles;
+}
+
+std::optional<RawTile> AsyncTileDataProvider::finishRawTile(RawTile product) {
+    const TileIndex::TileHashKey key = product.tileIndex.hashKey();
+    // No longer enqueued. Remove from set of enqueued tiles
+    _enqueuedTileRequests.erase(key);
+    // Pbo is still mapped. Set the id for the raw tile
+    if (product.error != RawTile::ReadError::None) {
+        product.imageData = nullptr;
         return std::nullopt;
     }
+
+    return product;
 }
 
 bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex) {
     // Only satisfies if it is not already enqueued. Also bumps the request to the top.
-    const bool alreadyEnqueued = _concurrentJobManager.touch(tileIndex.hashKey());
+    const bool alreadyEnqueued = _scheduler.touch(_schedulerClient, tileIndex);
     // Early out so we don't need to check the already enqueued requests
     if (alreadyEnqueued) {
         return false;
     }
 
-    // Concurrent job manager can start jobs which will pop them from enqueued, however
-    // they are still in _enqueuedTileRequests until finished
+    // The scheduler can start jobs which will pop them from its queue, however they are
+    // still in _enqueuedTileRequests until finished
     const auto it = _enqueuedTileRequests.find(tileIndex.hashKey());
     const bool notFoundAmongEnqueued = it == _enqueuedTileRequests.end();
 
@@ -111,7 +133,7 @@ bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex)
 
 void AsyncTileDataProvider::endUnfinishedJobs() {
     std::vector<TileIndex::TileHashKey> unfinishedJobs =
-        _concurrentJobManager.keysToUnfinishedJobs();
+        _scheduler.popDroppedRequests(_schedulerClient);
     for (const TileIndex::TileHashKey& unfinishedJob : unfinishedJobs) {
         // When erasing the job before
         _enqueuedTileRequests.erase(unfinishedJob);
@@ -120,7 +142,7 @@ void AsyncTileDataProvider::endUnfinishedJobs() {
 
 void AsyncTileDataProvider::endEnqueuedJobs() {
     std::vector<TileIndex::TileHashKey> enqueuedJobs =
-        _concurrentJobManager.keysToEnqueuedJobs();
+        _scheduler.cancelEnqueuedRequests(_schedulerClient);
     for (const TileIndex::TileHashKey& enqueuedJob : enqueuedJobs) {
         // When erasing the job before
         _enqueuedTileRequests.erase(enqueuedJob);
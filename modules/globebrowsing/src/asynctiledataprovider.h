@@ -25,13 +25,15 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___ASYNC_TILE_DATAPROVIDER___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___ASYNC_TILE_DATAPROVIDER___H__
 
-#include <modules/globebrowsing/src/prioritizingconcurrentjobmanager.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tileioscheduler.h>
 #include <ghoul/misc/boolean.h>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
+#include <vector>
 
 namespace openspace { class GlobeBrowsingModule; }
 
@@ -41,7 +43,8 @@ struct RawTile;
 
 /**
  * The responsibility of this class is to enqueue tile requests and fetching finished
- * <code>RawTile</code>s that has been asynchronously loaded.
+ * <code>RawTile</code>s that has been asynchronously loaded. The tiles are read by the
+ * TileIOScheduler of the GlobeBrowsingModule that is shared between all providers.
  */
 class AsyncTileDataProvider {
 public:
@@ -60,9 +63,16 @@ public:
     bool enqueueTileIO(const TileIndex& tileIndex);
 
     /**
-     * Get one finished job.
+     * Removes the request for \p tileIndex if it is still waiting to be read. The
+     * request is ended in the next #update like any other dropped request.
      */
-    std::optional<RawTile> popFinishedRawTile();
+    void cancelTileIO(const TileIndex& tileIndex);
+
+    /**
+     * Get all jobs that have finished since the last call. Tiles whose loading failed
+     * are not included.
+     */
+    std::vector<RawTile> popFinishedRawTiles();
 
     void update();
     void reset();
@@ -71,6 +81,12 @@ public:
     bool shouldBeDeleted();
 
     const RawTileDataReader& rawTileDataReader() const;
+
+    /**
+     * Returns the reader with shared ownership, so that it stays alive while it is used
+     * by other threads, even if this provider is destroyed in the meantime.
+     */
+    std::shared_ptr<const RawTileDataReader> sharedRawTileDataReader() const;
     float noDataValueAsFloat() const;
 
 protected:
@@ -89,9 +105,9 @@ protected:
     bool satisfiesEnqueueCriteria(const TileIndex& tileIndex);
 
     /**
-     * An unfinished job is a load tile job that has been popped from the thread pool due
-     * to its low priority. Once it has been popped, it is marked as unfinished and needs
-     * to be explicitly ended.
+     * An unfinished job is a load tile job that has been dropped by the scheduler, either
+     * due to its low priority or because it was cancelled. Once it has been dropped, it
+     * needs to be explicitly ended.
      */
     void endUnfinishedJobs();
 
@@ -101,14 +117,20 @@ protected:
 
     void performReset(ResetRawTileDataReader resetRawTileDataReader);
 
+    /**
+     * Marks the tile in \p product as no longer enqueued and returns it, or returns an
+     * empty optional if the tile could not be loaded.
+     */
+    std::optional<RawTile> finishRawTile(RawTile product);
+
 private:
     const std::string _name;
     GlobeBrowsingModule* _globeBrowsingModule;
     /// The reader used for asynchronous reading
-    std::unique_ptr<RawTileDataReader> _rawTileDataReader;
+    std::shared_ptr<RawTileDataReader> _rawTileDataReader;
 
-    PrioritizingConcurrentJobManager<RawTile, TileIndex::TileHashKey>
-        _concurrentJobManager;
+    TileIOScheduler& _scheduler;
+    TileIOScheduler::ClientId _schedulerClient;
 
     std::set<TileIndex::TileHashKey> _enqueuedTileRequests;
 
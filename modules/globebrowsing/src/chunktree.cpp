@@ -0,0 +1,237 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/chunktree.h>
+
+#include <openspace/util/threadpool.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+
+namespace {
+    // Levels with fewer chunks than this to evaluate are processed on the calling thread
+    // as the cost of distributing the work would outweigh the gain
+    constexpr const size_t MinChunksForParallelLevel = 64;
+
+    // The number of chunks that a thread claims at a time during a parallel evaluation
+    constexpr const size_t ChunksPerBatch = 16;
+} // namespace
+
+namespace openspace::globebrowsing {
+
+Chunk::Chunk(const TileIndex& ti)
+    : tileIndex(ti)
+    , surfacePatch(ti)
+    , status(Status::DoNothing)
+{}
+
+bool Chunk::isLeaf() const {
+    return children == NoChunk;
+}
+
+ChunkTree::ChunkTree(const std::vector<TileIndex>& roots, ThreadPool* threadPool)
+    : _threadPool(threadPool)
+{
+    ghoul_assert(!roots.empty(), "There must be at least one root");
+
+    _levels.emplace_back();
+    for (const TileIndex& index : roots) {
+        ghoul_assert(index.level == roots.front().level, "Roots must be on one level");
+        _levels.front().emplace_back(index);
+    }
+}
+
+void ChunkTree::update(Evaluator& evaluator, SkipSettled skipSettled) {
+    _nEvaluatedChunks = 0;
+
+    for (size_t depth = _levels.size(); depth > 0; --depth) {
+        const size_t d = depth - 1;
+
+        _evaluationList.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(_levels[d].size()); ++i) {
+            if (!skipSettled || !_levels[d][i].isSettled) {
+                _evaluationList.push_back(i);
+            }
+        }
+        _nEvaluatedChunks += _evaluationList.size();
+
+        // Querying the tile data is not thread-safe
+        for (uint32_t i : _evaluationList) {
+            evaluator.prepareChunk(_levels[d][i]);
+        }
+
+        std::vector<Chunk>& level = _levels[d];
+        if (_threadPool && _evaluationList.size() >= MinChunksForParallelLevel) {
+            _threadPool->parallelFor(
+                0,
+                _evaluationList.size(),
+                [this, &evaluator, &level](size_t i) {
+                    evaluator.evaluateChunk(level[_evaluationList[i]]);
+                },
+                ChunksPerBatch
+            );
+        }
+        else {
+            for (uint32_t i : _evaluationList) {
+                evaluator.evaluateChunk(level[i]);
+            }
+        }
+
+        // Splits and merges only add and remove chunks in the finer levels, so the
+        // indices of this level stay valid. A split might add a new level, which
+        // invalidates references to the levels, so the chunks are looked up every time
+        for (uint32_t i : _evaluationList) {
+            const bool hasAllData = evaluator.commitChunk(_levels[d][i]);
+
+            const Chunk& chunk = _levels[d][i];
+            if (chunk.isLeaf()) {
+                if (chunk.status == Chunk::Status::WantSplit) {
+                    split(evaluator, d, i);
+                    _levels[d][i].isSettled = false;
+                }
+                else {
+                    _levels[d][i].isSettled = hasAllData;
+                }
+                continue;
+            }
+
+            const Chunk* children = &_levels[d + 1][chunk.children];
+            bool allChildrenWantMerge = true;
+            bool allChildrenSettled = true;
+            for (int c = 0; c < 4; ++c) {
+                allChildrenWantMerge &= children[c].isLeaf() &&
+                    children[c].status == Chunk::Status::WantMerge;
+                allChildrenSettled &= children[c].isSettled;
+            }
+
+            if (allChildrenWantMerge && chunk.status != Chunk::Status::WantSplit) {
+                merge(evaluator, d, i);
+                _levels[d][i].isSettled = false;
+            }
+            else {
+                _levels[d][i].isSettled = hasAllData && allChildrenSettled;
+            }
+        }
+    }
+
+    // Remove the levels that have become empty by merges to keep the next update short
+    while (_levels.size() > 1 && _levels.back().empty()) {
+        _levels.pop_back();
+    }
+}
+
+void ChunkTree::collectVisibleLeaves(int cutoffLevel, std::vector<const Chunk*>& global,
+                                     std::vector<const Chunk*>& local) const
+{
+    global.clear();
+    local.clear();
+
+    for (const std::vector<Chunk>& level : _levels) {
+        for (const Chunk& chunk : level) {
+            if (chunk.isLeaf() && chunk.isVisible) {
+                if (chunk.tileIndex.level < cutoffLevel) {
+                    global.push_back(&chunk);
+                }
+                else {
+                    local.push_back(&chunk);
+                }
+            }
+        }
+    }
+}
+
+const Chunk& ChunkTree::root(size_t i) const {
+    ghoul_assert(i < _levels.front().size(), "Index out of bounds");
+    return _levels.front()[i];
+}
+
+const Chunk& ChunkTree::child(const Chunk& chunk, Quad q) const {
+    ghoul_assert(!chunk.isLeaf(), "Chunk must not be a leaf");
+
+    const size_t depth = chunk.tileIndex.level - root(0).tileIndex.level;
+    return _levels[depth + 1][chunk.children + static_cast<uint32_t>(q)];
+}
+
+size_t ChunkTree::numChunks() const {
+    size_t n = 0;
+    for (const std::vector<Chunk>& level : _levels) {
+        n += level.size();
+    }
+    return n;
+}
+
+size_t ChunkTree::numEvaluatedChunks() const {
+    return _nEvaluatedChunks;
+}
+
+void ChunkTree::split(Evaluator& evaluator, size_t depth, uint32_t index) {
+    if (_levels.size() == depth + 1) {
+        _levels.emplace_back();
+    }
+
+    const TileIndex tileIndex = _levels[depth][index].tileIndex;
+    std::vector<Chunk>& children = _levels[depth + 1];
+    const uint32_t first = static_cast<uint32_t>(children.size());
+    for (int q = 0; q < 4; ++q) {
+        Chunk& child = children.emplace_back(tileIndex.child(static_cast<Quad>(q)));
+        child.parent = index;
+        evaluator.initializeChunk(child);
+    }
+    _levels[depth][index].children = first;
+}
+
+void ChunkTree::merge(Evaluator& evaluator, size_t depth, uint32_t index) {
+    const uint32_t first = _levels[depth][index].children;
+    if (first == Chunk::NoChunk) {
+        return;
+    }
+
+    // Removing the grandchildren only reorders the level after the children, so the
+    // children stay where they are
+    for (uint32_t i = first; i < first + 4; ++i) {
+        merge(evaluator, depth + 1, i);
+        evaluator.removeChunk(_levels[depth + 1][i]);
+    }
+    _levels[depth][index].children = Chunk::NoChunk;
+
+    // Fill the gap with the last four siblings of the level and update the links of
+    // their parent and children to their new location
+    std::vector<Chunk>& level = _levels[depth + 1];
+    const uint32_t last = static_cast<uint32_t>(level.size()) - 4;
+    if (first != last) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            level[first + i] = std::move(level[last + i]);
+
+            const uint32_t grandchildren = level[first + i].children;
+            if (grandchildren != Chunk::NoChunk) {
+                for (uint32_t j = grandchildren; j < grandchildren + 4; ++j) {
+                    _levels[depth + 2][j].parent = first + i;
+                }
+            }
+        }
+        _levels[depth][level[first].parent].children = first;
+    }
+    level.erase(level.begin() + last, level.end());
+}
+
+} // namespace openspace::globebrowsing
@@ -0,0 +1,211 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___CHUNKTREE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___CHUNKTREE___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <ghoul/glm.h>
+#include <ghoul/misc/boolean.h>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace openspace { class ThreadPool; }
+
+namespace openspace::globebrowsing {
+
+struct BoundingHeights {
+    float min;
+    float max;
+    bool available;
+    bool tileOK;
+};
+
+struct Chunk {
+    /// The index that is used for a parent or child that does not exist
+    static constexpr const uint32_t NoChunk = std::numeric_limits<uint32_t>::max();
+
+    enum class Status : uint8_t {
+        DoNothing,
+        WantMerge,
+        WantSplit
+    };
+
+    Chunk(const TileIndex& tileIndex);
+
+    bool isLeaf() const;
+
+    TileIndex tileIndex;
+    GeodeticPatch surfacePatch;
+
+    Status status;
+
+    bool isVisible = true;
+    bool colorTileOK = false;
+    bool heightTileOK = false;
+
+    /// Whether neither this chunk nor any chunk of its subtree changed during the last
+    /// update of the ChunkTree, while none of them were waiting for tile data
+    bool isSettled = false;
+
+    BoundingHeights heights = { 0.f, 0.f, false, true };
+    int desiredLevel = 0;
+    int levelByAvailableData = 0;
+
+    std::array<glm::dvec4, 8> corners;
+
+    /// The index of the parent in the previous level of the ChunkTree
+    uint32_t parent = NoChunk;
+
+    /// The index of the first of the four children in the next level of the ChunkTree.
+    /// The children are stored next to each other in the order of the Quad enum
+    uint32_t children = NoChunk;
+};
+
+/**
+ * The quadtree of Chunks of a globe. The chunks are stored in a flat array per level in
+ * which the four children of a chunk are stored next to each other, so that each update
+ * of the tree and the collection of the chunks to render are linear passes over
+ * contiguous memory without any allocations. A split appends the four children to the
+ * next level, a merge fills the gap with the last four chunks of the level.
+ *
+ * The tree is updated level by level, starting at the finest level, so that the
+ * children of a chunk have been evaluated when the chunk decides whether to merge them.
+ * The culling and level of detail selection of the chunks of one level are independent
+ * of each other and are run on a ThreadPool if one is provided. If the view has not
+ * changed since the last update, only the subtrees that have changed or that are still
+ * waiting for tile data are evaluated again.
+ */
+class ChunkTree {
+public:
+    BooleanType(SkipSettled);
+
+    /**
+     * The interface through which the ChunkTree evaluates its chunks. For each chunk
+     * that is updated, first #prepareChunk, then #evaluateChunk, and then #commitChunk
+     * are called.
+     */
+    class Evaluator {
+    public:
+        virtual ~Evaluator() = default;
+
+        /**
+         * Computes the bounding data of a \p chunk that was just created by a split.
+         */
+        virtual void initializeChunk(Chunk& chunk) = 0;
+
+        /**
+         * Gathers everything that the evaluation of the \p chunk needs to know about
+         * its tile data.
+         */
+        virtual void prepareChunk(Chunk& chunk) = 0;
+
+        /**
+         * Sets the visibility, desired level and status of the \p chunk. This function
+         * is called concurrently for different chunks of the same level and must not
+         * access anything but the \p chunk and state that is constant during the update.
+         */
+        virtual void evaluateChunk(Chunk& chunk) const = 0;
+
+        /**
+         * Called on the updating thread after the \p chunk has been evaluated.
+         *
+         * \return <code>true</code> if the chunk is not waiting for any tile data and
+         *         will thus be in the same state as long as the view does not change
+         */
+        virtual bool commitChunk(const Chunk& chunk) = 0;
+
+        /**
+         * Called before the \p chunk is removed from the tree by a merge.
+         */
+        virtual void removeChunk(const Chunk& chunk) = 0;
+    };
+
+    /**
+     * Creates a tree with one leaf chunk for each of the \p roots, which all have to be
+     * on the same level. If a \p threadPool is provided, it is used to evaluate the
+     * chunks of large levels in parallel. The corners of the roots are computed by their
+     * first evaluation.
+     */
+    ChunkTree(const std::vector<TileIndex>& roots, ThreadPool* threadPool = nullptr);
+
+    /**
+     * Evaluates the chunks and splits or merges them according to their status. If
+     * \p skipSettled is <code>Yes</code>, the subtrees that were settled after the last
+     * update are not evaluated again, which is only valid if nothing that the
+     * \p evaluator depends on has changed since then.
+     */
+    void update(Evaluator& evaluator, SkipSettled skipSettled = SkipSettled::No);
+
+    /**
+     * Replaces the contents of \p global and \p local with the visible leaf chunks of
+     * the tree. Chunks with a level lower than \p cutoffLevel are placed into \p global,
+     * all other into \p local. The chunks are ordered by their level.
+     */
+    void collectVisibleLeaves(int cutoffLevel, std::vector<const Chunk*>& global,
+        std::vector<const Chunk*>& local) const;
+
+    /**
+     * Returns the \p i-th root of the tree.
+     */
+    const Chunk& root(size_t i) const;
+
+    /**
+     * Returns the child of the \p chunk in the quadrant \p q. The \p chunk must not be a
+     * leaf.
+     */
+    const Chunk& child(const Chunk& chunk, Quad q) const;
+
+    /**
+     * Returns the number of chunks in the tree.
+     */
+    size_t numChunks() const;
+
+    /**
+     * Returns the number of chunks that have been evaluated during the last update.
+     */
+    size_t numEvaluatedChunks() const;
+
+private:
+    void split(Evaluator& evaluator, size_t depth, uint32_t index);
+    void merge(Evaluator& evaluator, size_t depth, uint32_t index);
+
+    /// The chunks of each level, with the roots at depth 0
+    std::vector<std::vector<Chunk>> _levels;
+
+    /// The indices of the chunks of the current level that have to be evaluated. This is
+    /// a member to reuse its memory between updates
+    std::vector<uint32_t> _evaluationList;
+    size_t _nEvaluatedChunks = 0;
+
+    ThreadPool* _threadPool;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___CHUNKTREE___H__
@@ -0,0 +1,654 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/disktilecache.h>
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <openspace/util/memorymappedfile.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    constexpr const char* _loggerCat = "DiskTileCache";
+
+    constexpr const char* SegmentExtension = "tilesegment";
+    constexpr const char* LockFileName = "lock";
+
+    constexpr const uint32_t SegmentMagic = 0x4354534F; // 'OSTC'
+    constexpr const uint32_t SegmentVersion = 1;
+    constexpr const uint32_t RecordMagic = 0x454C4954; // 'TILE'
+
+    // All records are aligned to this many bytes in the segment files
+    constexpr const uint64_t Alignment = 16;
+
+    // The segment size is chosen such that the maximum cache size is split into roughly
+    // this many segments, which determines the granularity of the eviction
+    constexpr const uint64_t NumberOfSegments = 8;
+    constexpr const uint64_t MinimumSegmentSize = 16ULL * 1024ULL * 1024ULL;
+    constexpr const uint64_t MaximumSegmentSize = 256ULL * 1024ULL * 1024ULL;
+
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sequenceNumber;
+        // Offset behind the last completely written record
+        uint64_t writeOffset;
+    };
+    constexpr const uint64_t SegmentHeaderSize = 64;
+    static_assert(sizeof(SegmentHeader) <= SegmentHeaderSize);
+
+    // Each record consists of this header followed by the maximum values, the minimum
+    // values, and the missing data flags of all rasters and then by the image data
+    struct RecordHeader {
+        uint32_t magic;
+        int32_t level;
+        int32_t x;
+        int32_t y;
+        uint64_t datasetIdentifier;
+        uint64_t recordSize;
+        uint64_t imageSize;
+        uint16_t nRasters;
+        uint8_t error;
+        uint8_t hasMetaData;
+        uint32_t padding;
+    };
+    static_assert(sizeof(RecordHeader) == 48);
+    static_assert(sizeof(RecordHeader) % Alignment == 0);
+
+    constexpr uint64_t aligned(uint64_t v) {
+        return (v + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    uint64_t metaDataSize(uint64_t nRasters) {
+        return aligned(nRasters * (2 * sizeof(float) + sizeof(uint8_t)));
+    }
+
+    // Checks that a record read from a segment file is consistent with what writeRecord
+    // produces and that it fits into the remaining bytes of the segment, so that a
+    // damaged file never causes reads outside of the mapping
+    bool isValidRecord(const RecordHeader& header, uint64_t remainingBytes) {
+        if (header.magic != RecordMagic || header.hasMetaData > 1 ||
+            (!header.hasMetaData && header.nRasters != 0))
+        {
+            return false;
+        }
+        // The image size is checked on its own first as the sum below could overflow
+        if (header.imageSize == 0 || header.imageSize > remainingBytes) {
+            return false;
+        }
+        const uint64_t expectedSize = sizeof(RecordHeader) +
+            metaDataSize(header.nRasters) + aligned(header.imageSize);
+        return header.recordSize == expectedSize && expectedSize <= remainingBytes;
+    }
+
+    // 64-bit FNV-1a, which is used as the hash has to be stable between different runs
+    // and platforms
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* d = reinterpret_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= d[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Returns the size and the modification time of the file at the provided path, or
+    // zeros if the path does not point to a local file, which is the case for datasets
+    // that are described by a GDAL XML string or a URL
+    std::pair<uint64_t, int64_t> fileStatus(const std::string& path) {
+#ifdef WIN32
+        struct _stat64 s;
+        if (_stat64(path.c_str(), &s) != 0) {
+            return { 0, 0 };
+        }
+#else
+        struct stat s;
+        if (stat(path.c_str(), &s) != 0) {
+            return { 0, 0 };
+        }
+#endif // WIN32
+        return { static_cast<uint64_t>(s.st_size), static_cast<int64_t>(s.st_mtime) };
+    }
+
+    constexpr openspace::properties::Property::PropertyInfo UsedSizeInfo = {
+        "UsedSize",
+        "Used size (MB)",
+        "This value denotes the amount of disk space (in MB) that is currently used by "
+        "the disk tile cache."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NumberOfTilesInfo = {
+        "NumberOfTiles",
+        "Number of tiles",
+        "This value denotes the number of tiles that are stored in the disk tile cache."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo HitRateInfo = {
+        "HitRate",
+        "Hit rate (%)",
+        "This value denotes the percentage of tile requests that could be served from "
+        "the disk tile cache instead of reading the tile from its dataset."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ClearDiskTileCacheInfo = {
+        "ClearDiskTileCache",
+        "Clear disk tile cache",
+        "Removes all tiles from the disk tile cache and deletes the cache files."
+    };
+} // namespace
+
+namespace openspace::globebrowsing::cache {
+
+DiskTileCache::DiskTileCache(std::string directory, uint64_t maximumSize)
+    : PropertyOwner({ "DiskTileCache" })
+    , _directory(std::move(directory))
+    , _maximumSize(maximumSize)
+    , _segmentSize(
+        std::clamp(maximumSize / NumberOfSegments, MinimumSegmentSize, MaximumSegmentSize)
+    )
+    , _usedSize(UsedSizeInfo, 0, 0, std::numeric_limits<int>::max())
+    , _nTiles(NumberOfTilesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _hitRate(HitRateInfo, 0, 0, 100)
+    , _clearDiskTileCache(ClearDiskTileCacheInfo)
+{
+    _usedSize.setReadOnly(true);
+    addProperty(_usedSize);
+
+    _nTiles.setReadOnly(true);
+    addProperty(_nTiles);
+
+    _hitRate.setReadOnly(true);
+    addProperty(_hitRate);
+
+    _clearDiskTileCache.onChange([&]() { clear(); });
+    addProperty(_clearDiskTileCache);
+
+    if (!FileSys.directoryExists(_directory)) {
+        FileSys.createDirectory(
+            _directory,
+            ghoul::filesystem::FileSystem::Recursive::Yes
+        );
+    }
+
+    lockDirectory();
+    loadSegments();
+    update();
+}
+
+DiskTileCache::~DiskTileCache() {
+    for (Segment& s : _segments) {
+        s.file->flush();
+    }
+    unlockDirectory();
+}
+
+uint64_t DiskTileCache::datasetIdentifier(const std::string& filePath,
+                                          const TileTextureInitData& initData,
+                                          bool performPreprocessing)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hashBytes(hash, filePath.data(), filePath.size());
+    const TileTextureInitData::HashKey initKey = initData.hashKey;
+    hash = hashBytes(hash, &initKey, sizeof(initKey));
+    const uint8_t flags = (initData.padTiles ? 1 : 0) | (performPreprocessing ? 2 : 0);
+    hash = hashBytes(hash, &flags, sizeof(flags));
+
+    // A dataset that is replaced in place has to invalidate the tiles of the old version
+    const std::pair<uint64_t, int64_t> status = fileStatus(filePath);
+    hash = hashBytes(hash, &status.first, sizeof(status.first));
+    hash = hashBytes(hash, &status.second, sizeof(status.second));
+    return hash;
+}
+
+std::optional<RawTile> DiskTileCache::get(const DiskTileKey& key,
+                                          const TileTextureInitData& initData)
+{
+    std::optional<RawTile> result;
+    bool isInOldestSegment = false;
+    {
+        std::shared_lock lock(_mutex);
+
+        const auto it = _index.find(key);
+        if (it == _index.end()) {
+            ++_nMisses;
+            return std::nullopt;
+        }
+
+        const Segment* s = segment(it->second.sequenceNumber);
+        ghoul_assert(s, "Index must only point to existing segments");
+        const std::byte* record = s->file->data() + it->second.offset;
+
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(RecordHeader));
+        if (header.imageSize != initData.totalNumBytes) {
+            ++_nMisses;
+            return std::nullopt;
+        }
+
+        RawTile rawTile;
+        const std::byte* metaData = record + sizeof(RecordHeader);
+        if (header.hasMetaData) {
+            TileMetaData& md = rawTile.tileMetaData;
+            md.maxValues.resize(header.nRasters);
+            md.minValues.resize(header.nRasters);
+            md.hasMissingData.resize(header.nRasters);
+
+            const size_t floatBytes = header.nRasters * sizeof(float);
+            std::memcpy(md.maxValues.data(), metaData, floatBytes);
+            std::memcpy(md.minValues.data(), metaData + floatBytes, floatBytes);
+            const std::byte* missing = metaData + 2 * floatBytes;
+            for (uint16_t i = 0; i < header.nRasters; ++i) {
+                md.hasMissingData[i] = (missing[i] != std::byte(0));
+            }
+        }
+
+        const std::byte* image = metaData + metaDataSize(header.nRasters);
+        rawTile.imageData = std::unique_ptr<std::byte[]>(new std::byte[header.imageSize]);
+        std::memcpy(rawTile.imageData.get(), image, header.imageSize);
+
+        rawTile.error = static_cast<RawTile::ReadError>(header.error);
+        rawTile.tileIndex = key.tileIndex;
+        rawTile.textureInitData = initData;
+        result = std::move(rawTile);
+
+        isInOldestSegment = (_segments.size() > 1) &&
+                            (s->sequenceNumber == _segments.front().sequenceNumber);
+    }
+    ++_nHits;
+
+    if (isInOldestSegment) {
+        // The tile is still in use, so we move it to the newest segment before the
+        // oldest segment gets evicted
+        std::unique_lock lock(_mutex);
+        const auto it = _index.find(key);
+        if (it != _index.end() &&
+            it->second.sequenceNumber == _segments.front().sequenceNumber)
+        {
+            writeRecord(key, *result);
+        }
+    }
+
+    return result;
+}
+
+void DiskTileCache::put(const DiskTileKey& key, const RawTile& rawTile) {
+    if (!rawTile.imageData || !rawTile.textureInitData.has_value()) {
+        return;
+    }
+
+    std::unique_lock lock(_mutex);
+    writeRecord(key, rawTile);
+}
+
+bool DiskTileCache::exist(const DiskTileKey& key) const {
+    std::shared_lock lock(_mutex);
+    return _index.find(key) != _index.end();
+}
+
+void DiskTileCache::clear() {
+    LINFO("Clearing disk tile cache");
+
+    std::unique_lock lock(_mutex);
+    while (!_segments.empty()) {
+        evictOldestSegment();
+    }
+    _index.clear();
+}
+
+void DiskTileCache::update() {
+    constexpr const uint64_t MB = 1024 * 1024;
+    _usedSize = static_cast<int>(size() / MB);
+    {
+        std::shared_lock lock(_mutex);
+        _nTiles = static_cast<int>(_index.size());
+    }
+
+    const uint64_t hits = _nHits;
+    const uint64_t total = hits + _nMisses;
+    _hitRate = total > 0 ? static_cast<int>(hits * 100 / total) : 0;
+}
+
+uint64_t DiskTileCache::size() const {
+    std::shared_lock lock(_mutex);
+    uint64_t res = 0;
+    for (const Segment& s : _segments) {
+        res += s.file->size();
+    }
+    return res;
+}
+
+#ifdef WIN32
+
+void DiskTileCache::lockDirectory() {
+    // Opening the file without sharing prevents any other process from opening it until
+    // the handle is closed, which also happens if the process terminates unexpectedly
+    const std::string path = _directory + "/" + LockFileName;
+    HANDLE file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        0,
+        nullptr,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw ghoul::RuntimeError(
+            fmt::format("Tile cache directory '{}' is already in use", _directory),
+            _loggerCat
+        );
+    }
+    _lockFileHandle = file;
+}
+
+void DiskTileCache::unlockDirectory() {
+    if (_lockFileHandle) {
+        CloseHandle(_lockFileHandle);
+        _lockFileHandle = nullptr;
+    }
+}
+
+#else
+
+void DiskTileCache::lockDirectory() {
+    // The lock is released by the operating system if the process terminates
+    // unexpectedly, so a stale lock file never blocks the cache
+    const std::string path = _directory + "/" + LockFileName;
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        throw ghoul::RuntimeError(
+            fmt::format("Error opening lock file '{}'", path),
+            _loggerCat
+        );
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        throw ghoul::RuntimeError(
+            fmt::format("Tile cache directory '{}' is already in use", _directory),
+            _loggerCat
+        );
+    }
+    _lockFileDescriptor = fd;
+}
+
+void DiskTileCache::unlockDirectory() {
+    if (_lockFileDescriptor != -1) {
+        flock(_lockFileDescriptor, LOCK_UN);
+        close(_lockFileDescriptor);
+        _lockFileDescriptor = -1;
+    }
+}
+
+#endif // WIN32
+
+void DiskTileCache::loadSegments() {
+    ghoul::filesystem::Directory dir(_directory);
+    std::vector<std::string> files = dir.readFiles();
+
+    for (const std::string& f : files) {
+        const std::string extension = ghoul::filesystem::File(f).fileExtension();
+        if (extension != SegmentExtension) {
+            continue;
+        }
+
+        std::unique_ptr<MemoryMappedFile> file;
+        try {
+            file = std::make_unique<MemoryMappedFile>(
+                f,
+                MemoryMappedFile::Writable::Yes
+            );
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+            continue;
+        }
+
+        SegmentHeader header = { 0, 0, 0, 0 };
+        if (file->size() >= SegmentHeaderSize) {
+            std::memcpy(&header, file->data(), sizeof(SegmentHeader));
+        }
+        const bool isValid = header.magic == SegmentMagic &&
+            header.version == SegmentVersion &&
+            header.writeOffset >= SegmentHeaderSize &&
+            header.writeOffset <= file->size();
+        if (!isValid) {
+            LWARNING(fmt::format("Removing invalid tile cache segment '{}'", f));
+            file = nullptr;
+            std::remove(f.c_str());
+            continue;
+        }
+
+        _segments.push_back({
+            header.sequenceNumber,
+            std::move(file),
+            header.writeOffset,
+            {}
+        });
+    }
+
+    std::sort(
+        _segments.begin(),
+        _segments.end(),
+        [](const Segment& lhs, const Segment& rhs) {
+            return lhs.sequenceNumber < rhs.sequenceNumber;
+        }
+    );
+
+    // Rebuild the index. As the segments are sorted, a tile that is stored multiple
+    // times will end up pointing at its newest copy
+    for (Segment& s : _segments) {
+        uint64_t offset = SegmentHeaderSize;
+        while (offset + sizeof(RecordHeader) <= s.writeOffset) {
+            RecordHeader header;
+            std::memcpy(&header, s.file->data() + offset, sizeof(RecordHeader));
+            if (!isValidRecord(header, s.writeOffset - offset)) {
+                LWARNING(fmt::format(
+                    "Discarding corrupt tail of tile cache segment '{}'",
+                    s.file->path()
+                ));
+                s.writeOffset = offset;
+                break;
+            }
+
+            DiskTileKey key = {
+                header.datasetIdentifier,
+                TileIndex(header.x, header.y, header.level)
+            };
+            _index[key] = { s.sequenceNumber, offset };
+            s.keys.push_back(std::move(key));
+            offset += header.recordSize;
+        }
+    }
+
+    // The maximum cache size might have been decreased since the last run
+    uint64_t totalSize = 0;
+    for (const Segment& s : _segments) {
+        totalSize += s.file->size();
+    }
+    while (totalSize > _maximumSize && !_segments.empty()) {
+        totalSize -= _segments.front().file->size();
+        evictOldestSegment();
+    }
+
+    LINFO(fmt::format(
+        "Loaded {} tiles from {} segments in '{}'",
+        _index.size(), _segments.size(), _directory
+    ));
+}
+
+void DiskTileCache::createSegment() {
+    const uint64_t sequenceNumber =
+        _segments.empty() ? 0 : _segments.back().sequenceNumber + 1;
+
+    // Make room for the new segment first so that we never exceed the maximum size
+    uint64_t totalSize = _segmentSize;
+    for (const Segment& s : _segments) {
+        totalSize += s.file->size();
+    }
+    while (totalSize > _maximumSize && !_segments.empty()) {
+        totalSize -= _segments.front().file->size();
+        evictOldestSegment();
+    }
+
+    auto file = std::make_unique<MemoryMappedFile>(
+        segmentPath(sequenceNumber),
+        MemoryMappedFile::Writable::Yes,
+        _segmentSize
+    );
+
+    SegmentHeader header = {
+        SegmentMagic,
+        SegmentVersion,
+        sequenceNumber,
+        SegmentHeaderSize
+    };
+    std::memcpy(file->data(), &header, sizeof(SegmentHeader));
+
+    _segments.push_back({ sequenceNumber, std::move(file), SegmentHeaderSize, {} });
+}
+
+void DiskTileCache::evictOldestSegment() {
+    ghoul_assert(!_segments.empty(), "No segment to evict");
+
+    Segment& s = _segments.front();
+    for (const DiskTileKey& key : s.keys) {
+        const auto it = _index.find(key);
+        if (it != _index.end() && it->second.sequenceNumber == s.sequenceNumber) {
+            _index.erase(it);
+        }
+    }
+
+    const std::string path = s.file->path();
+    s.file = nullptr;
+    std::remove(path.c_str());
+    _segments.pop_front();
+}
+
+void DiskTileCache::writeRecord(const DiskTileKey& key, const RawTile& rawTile) {
+    const TileMetaData& md = rawTile.tileMetaData;
+    const bool hasMetaData = !md.maxValues.empty();
+    const uint64_t nRasters = hasMetaData ? md.maxValues.size() : 0;
+    const uint64_t imageSize = rawTile.textureInitData->totalNumBytes;
+    const uint64_t recordSize =
+        sizeof(RecordHeader) + metaDataSize(nRasters) + aligned(imageSize);
+
+    if (recordSize > _segmentSize - SegmentHeaderSize) {
+        // The tile is too large to be stored in any segment
+        return;
+    }
+
+    if (_segments.empty() ||
+        _segments.back().writeOffset + recordSize > _segments.back().file->size())
+    {
+        try {
+            createSegment();
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+            return;
+        }
+    }
+
+    Segment& s = _segments.back();
+    std::byte* record = s.file->data() + s.writeOffset;
+
+    RecordHeader header = {
+        RecordMagic,
+        key.tileIndex.level,
+        key.tileIndex.x,
+        key.tileIndex.y,
+        key.datasetIdentifier,
+        recordSize,
+        imageSize,
+        static_cast<uint16_t>(nRasters),
+        static_cast<uint8_t>(rawTile.error),
+        static_cast<uint8_t>(hasMetaData ? 1 : 0),
+        0
+    };
+    std::memcpy(record, &header, sizeof(RecordHeader));
+
+    std::byte* metaData = record + sizeof(RecordHeader);
+    if (hasMetaData) {
+        const size_t floatBytes = nRasters * sizeof(float);
+        std::memcpy(metaData, md.maxValues.data(), floatBytes);
+        std::memcpy(metaData + floatBytes, md.minValues.data(), floatBytes);
+        std::byte* missing = metaData + 2 * floatBytes;
+        for (uint64_t i = 0; i < nRasters; ++i) {
+            missing[i] = std::byte(md.hasMissingData[i] ? 1 : 0);
+        }
+    }
+    std::byte* image = metaData + metaDataSize(nRasters);
+    std::memcpy(image, rawTile.imageData.get(), imageSize);
+
+    // Only advance the committed write offset after the record is complete so that a
+    // partially written record is never picked up when the index is rebuilt
+    _index[key] = { s.sequenceNumber, s.writeOffset };
+    s.keys.push_back(key);
+    s.writeOffset += recordSize;
+    std::memcpy(
+        s.file->data() + offsetof(SegmentHeader, writeOffset),
+        &s.writeOffset,
+        sizeof(uint64_t)
+    );
+}
+
+DiskTileCache::Segment* DiskTileCache::segment(uint64_t sequenceNumber) {
+    const auto it = std::lower_bound(
+        _segments.begin(),
+        _segments.end(),
+        sequenceNumber,
+        [](const Segment& s, uint64_t n) { return s.sequenceNumber < n; }
+    );
+    if (it == _segments.end() || it->sequenceNumber != sequenceNumber) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+std::string DiskTileCache::segmentPath(uint64_t sequenceNumber) const {
+    return fmt::format("{}/{:010}.{}", _directory, sequenceNumber, SegmentExtension);
+}
+
+} // namespace openspace::globebrowsing::cache
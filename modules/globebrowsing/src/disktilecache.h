@@ -0,0 +1,205 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+
+#include <modules/globebrowsing/src/tileindex.h>
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <openspace/properties/triggerproperty.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace { class MemoryMappedFile; }
+
+namespace openspace::globebrowsing {
+    struct RawTile;
+    class TileTextureInitData;
+} // namespace openspace::globebrowsing
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * The key that is used to identify a tile in the DiskTileCache. Contrary to the
+ * ProviderTileKey, which uses an identifier that is only valid during a single run, the
+ * dataset identifier is stable between runs as it is derived from the dataset and the
+ * layer settings that influence the contents of the tile. See
+ * DiskTileCache::datasetIdentifier for details.
+ */
+struct DiskTileKey {
+    uint64_t datasetIdentifier;
+    TileIndex tileIndex;
+
+    bool operator==(const DiskTileKey& r) const {
+        return (datasetIdentifier == r.datasetIdentifier) && (tileIndex == r.tileIndex);
+    }
+};
+
+struct DiskTileKeyHasher {
+    size_t operator()(const DiskTileKey& t) const {
+        // Same layout as TileIndex::hashKey, with the dataset mixed in to separate the
+        // same tile index between different layers
+        uint64_t key = t.tileIndex.hashKey();
+        key ^= t.datasetIdentifier + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+        return static_cast<size_t>(key);
+    }
+};
+
+/**
+ * A persistent, second-level cache for RawTile%s that sits between the
+ * MemoryAwareTileCache and the GDAL reads in the RawTileDataReader. Tiles are stored
+ * together with their TileMetaData in a number of fixed-size segment files in the cache
+ * directory that are memory mapped, so reading a tile from the cache amounts to a single
+ * copy out of the mapping.
+ *
+ * New tiles are always appended to the newest segment. Once the total size of all
+ * segments exceeds the maximum cache size, the oldest segment is deleted as a whole.
+ * Tiles that are requested while they are stored in the oldest segment are copied into
+ * the newest segment, which means that the tiles that are used frequently survive the
+ * eviction and the cache approximates a least-recently-used policy without having to
+ * rewrite any files.
+ *
+ * The index of all tiles is rebuilt from the segment files when the cache is created,
+ * so the contents survive a restart of the application. All public functions are
+ * thread-safe and can be called from the tile loading threads. The index is not shared
+ * between processes, so the cache holds a lock file in its directory for as long as it
+ * exists and a second cache for the same directory cannot be created.
+ */
+class DiskTileCache : public properties::PropertyOwner {
+public:
+    /**
+     * Creates a cache that stores its segment files in \p directory, which is created if
+     * it does not exist, and loads the index of all tiles that are already stored in
+     * there.
+     *
+     * \param directory The directory in which the segment files are stored
+     * \param maximumSize The maximum number of bytes that all segments files combined
+     *        are allowed to use
+     *
+     * \throw ghoul::RuntimeError If the \p directory is already used by another cache,
+     *        either in this or in another process
+     */
+    DiskTileCache(std::string directory, uint64_t maximumSize);
+    ~DiskTileCache();
+
+    /**
+     * Returns a stable identifier for the combination of dataset and layer settings that
+     * result in the tiles stored in the cache. Tiles for layers that use the same dataset
+     * but a different tile size, texture format, or preprocessing are stored separately.
+     * If \p filePath refers to a local file, its size and modification time are part of
+     * the identifier, so the tiles of a dataset that is replaced are not used anymore.
+     *
+     * \param filePath The path or description of the GDAL dataset
+     * \param initData The settings of the textures that are created from the tiles
+     * \param performPreprocessing Whether the tile metadata is computed for the tiles
+     * \return A value that identifies the dataset across multiple runs
+     */
+    static uint64_t datasetIdentifier(const std::string& filePath,
+        const TileTextureInitData& initData, bool performPreprocessing);
+
+    /**
+     * Returns the tile for the provided \p key if it is stored in the cache. The tile's
+     * image data has to have the same size as the provided \p initData, otherwise the
+     * stored tile is ignored.
+     */
+    std::optional<RawTile> get(const DiskTileKey& key,
+        const TileTextureInitData& initData);
+
+    /**
+     * Stores the \p rawTile in the cache, potentially evicting the oldest segment if the
+     * maximum size of the cache would be exceeded. Tiles without image data or tiles
+     * that are larger than a single segment are ignored.
+     */
+    void put(const DiskTileKey& key, const RawTile& rawTile);
+
+    /// Returns \c true if a tile for the provided \p key is stored in the cache
+    bool exist(const DiskTileKey& key) const;
+
+    /// Removes all tiles from the cache and deletes all segment files
+    void clear();
+
+    /// Updates the properties with the current state of the cache
+    void update();
+
+    /// Returns the number of bytes that are currently used by the segment files
+    uint64_t size() const;
+
+private:
+    struct Segment {
+        uint64_t sequenceNumber;
+        std::unique_ptr<MemoryMappedFile> file;
+        /// The offset at which the next record is written
+        uint64_t writeOffset;
+        /// All keys that have been written into this segment
+        std::vector<DiskTileKey> keys;
+    };
+
+    struct Location {
+        uint64_t sequenceNumber;
+        uint64_t offset;
+    };
+
+    void lockDirectory();
+    void unlockDirectory();
+    void loadSegments();
+    void createSegment();
+    void evictOldestSegment();
+    void writeRecord(const DiskTileKey& key, const RawTile& rawTile);
+    Segment* segment(uint64_t sequenceNumber);
+    std::string segmentPath(uint64_t sequenceNumber) const;
+
+    const std::string _directory;
+    const uint64_t _maximumSize;
+    const uint64_t _segmentSize;
+
+    /// All segments sorted by their sequence number, the newest segment is in the back
+    std::deque<Segment> _segments;
+    std::unordered_map<DiskTileKey, Location, DiskTileKeyHasher> _index;
+    mutable std::shared_mutex _mutex;
+
+    std::atomic<uint64_t> _nHits = 0;
+    std::atomic<uint64_t> _nMisses = 0;
+
+#ifdef WIN32
+    void* _lockFileHandle = nullptr;
+#else
+    int _lockFileDescriptor = -1;
+#endif // WIN32
+
+    properties::IntProperty _usedSize;
+    properties::IntProperty _nTiles;
+    properties::IntProperty _hitRate;
+    properties::TriggerProperty _clearDiskTileCache;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
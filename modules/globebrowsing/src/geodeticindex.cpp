@@ -0,0 +1,181 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/geodeticindex.h>
+
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <numeric>
+
+namespace openspace::globebrowsing {
+
+GeodeticIndex::GeodeticIndex(const std::vector<Geodetic2>& locations,
+                             const std::vector<glm::vec3>& positions,
+                             std::vector<uint32_t>& order, size_t maxPointsPerCell,
+                             int maxLevel)
+{
+    ghoul_assert(locations.size() == positions.size(), "Sizes must match");
+    ghoul_assert(maxLevel >= 1 && maxLevel <= MaxLevel, "Invalid maximum level");
+
+    order.resize(locations.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    auto makeCell = [&](const TileIndex& index, uint32_t begin, uint32_t end) {
+        Cell cell;
+        cell.x = index.x;
+        cell.y = index.y;
+        cell.level = index.level;
+        cell.firstChild = NoChild;
+        cell.begin = begin;
+        cell.end = end;
+        cell.center = glm::vec3(0.f);
+        cell.radius = 0.f;
+
+        if (begin != end) {
+            glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+            glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+            for (uint32_t i = begin; i < end; ++i) {
+                min = glm::min(min, positions[order[i]]);
+                max = glm::max(max, positions[order[i]]);
+            }
+            cell.center = (min + max) / 2.f;
+            cell.radius = glm::length(max - min) / 2.f;
+        }
+        return cell;
+    };
+
+    // The roots cover all negative and all positive longitudes, respectively
+    const uint32_t nPoints = static_cast<uint32_t>(order.size());
+    const uint32_t split = static_cast<uint32_t>(std::distance(
+        order.begin(),
+        std::partition(
+            order.begin(),
+            order.end(),
+            [&locations](uint32_t i) { return locations[i].lon < 0.0; }
+        )
+    ));
+    _cells.push_back(makeCell(TileIndex(0, 0, 1), 0, split));
+    _cells.push_back(makeCell(TileIndex(1, 0, 1), split, nPoints));
+
+    // The cells vector doubles as the queue of a breadth-first subdivision, so the
+    // cells end up sorted by their level
+    for (size_t c = 0; c < _cells.size(); ++c) {
+        const Cell cell = _cells[c];
+        if (cell.end - cell.begin <= maxPointsPerCell || cell.level >= maxLevel) {
+            continue;
+        }
+
+        const TileIndex index = TileIndex(cell.x, cell.y, cell.level);
+        const Geodetic2 center = GeodeticPatch(index).center();
+        const auto first = order.begin() + cell.begin;
+        const auto last = order.begin() + cell.end;
+
+        // Sort the points into the quadrants in the order of the Quad enum
+        const auto south = std::partition(
+            first,
+            last,
+            [&](uint32_t i) { return locations[i].lat >= center.lat; }
+        );
+        const auto northEast = std::partition(
+            first,
+            south,
+            [&](uint32_t i) { return locations[i].lon < center.lon; }
+        );
+        const auto southEast = std::partition(
+            south,
+            last,
+            [&](uint32_t i) { return locations[i].lon < center.lon; }
+        );
+
+        const std::array<uint32_t, 5> bounds = {
+            cell.begin,
+            static_cast<uint32_t>(std::distance(order.begin(), northEast)),
+            static_cast<uint32_t>(std::distance(order.begin(), south)),
+            static_cast<uint32_t>(std::distance(order.begin(), southEast)),
+            cell.end
+        };
+
+        _cells[c].firstChild = static_cast<uint32_t>(_cells.size());
+        for (int q = 0; q < 4; ++q) {
+            _cells.push_back(
+                makeCell(index.child(static_cast<Quad>(q)), bounds[q], bounds[q + 1])
+            );
+        }
+    }
+}
+
+GeodeticIndex::GeodeticIndex(std::vector<Cell> cells) : _cells(std::move(cells)) {
+    ghoul_assert(_cells.empty() || _cells.size() >= 2, "Roots are missing");
+}
+
+const std::vector<GeodeticIndex::Cell>& GeodeticIndex::cells() const {
+    return _cells;
+}
+
+uint32_t GeodeticIndex::numPoints() const {
+    return _cells.empty() ? 0 : _cells[1].end;
+}
+
+bool GeodeticIndex::isValid() const {
+    if (_cells.empty()) {
+        return true;
+    }
+    if (_cells.size() < 2 || _cells[0].level != 1 || _cells[1].level != 1 ||
+        _cells[0].begin != 0 || _cells[0].end != _cells[1].begin)
+    {
+        return false;
+    }
+
+    for (size_t c = 0; c < _cells.size(); ++c) {
+        const Cell& cell = _cells[c];
+        if (cell.begin > cell.end || cell.level < 1 || cell.level > MaxLevel) {
+            return false;
+        }
+        if (cell.firstChild == NoChild) {
+            continue;
+        }
+
+        // Children that come after their parent can't form a cycle, and as every child
+        // is one level finer, the depth of the tree is bounded by MaxLevel
+        if (cell.firstChild <= c || cell.firstChild > _cells.size() - 4) {
+            return false;
+        }
+        uint32_t begin = cell.begin;
+        for (uint32_t i = cell.firstChild; i < cell.firstChild + 4; ++i) {
+            const Cell& child = _cells[i];
+            if (child.level != cell.level + 1 || child.begin != begin) {
+                return false;
+            }
+            begin = child.end;
+        }
+        if (begin != cell.end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace openspace::globebrowsing
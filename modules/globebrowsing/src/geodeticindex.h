@@ -0,0 +1,149 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___GEODETICINDEX___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___GEODETICINDEX___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/glm.h>
+#include <ghoul/misc/assert.h>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * A quadtree over a fixed set of points on the surface of a globe. The cells of the tree
+ * are the GeodeticPatch%es of the TileIndex%es that are used for the chunks of the globe,
+ * starting with the two hemispheres on level 1. Cells are subdivided until they contain
+ * at most a fixed number of points or until the maximum level is reached.
+ *
+ * All cells are stored in a single array in which the four children of a cell are next
+ * to each other. The points are not stored in the index; instead, the points of every
+ * cell are a contiguous range in the order that is computed when the index is created,
+ * so the owner of the points has to store them in that order. Every cell contains a
+ * bounding sphere of the model space positions of its points, which is used to cull
+ * whole cells at once.
+ */
+class GeodeticIndex {
+public:
+    static constexpr const uint32_t NoChild = std::numeric_limits<uint32_t>::max();
+
+    /// The finest level on which cells can exist
+    static constexpr const int MaxLevel = 30;
+
+    /// The cells have a fixed layout so that they can be written into cache files
+    struct Cell {
+        int32_t x;
+        int32_t y;
+        int32_t level;
+
+        /// The index of the first of the four children, or NoChild if this is a leaf
+        uint32_t firstChild;
+
+        /// The range of points [begin, end) in this cell
+        uint32_t begin;
+        uint32_t end;
+
+        glm::vec3 center;
+        float radius;
+    };
+
+    /// The result of testing a cell against the view
+    enum class Visibility {
+        /// None of the points in the cell are visible
+        Hidden,
+        /// Some of the points in the cell might be visible and have to be tested
+        Partial,
+        /// All of the points in the cell are visible
+        Visible
+    };
+
+    /// A range of points [begin, end) that was found by #query
+    struct Range {
+        uint32_t begin;
+        uint32_t end;
+        /// Whether the points are known to be visible or have to be tested individually
+        bool isVisible;
+    };
+
+    GeodeticIndex() = default;
+
+    /**
+     * Creates the index for the points at the geodetic \p locations with the model space
+     * \p positions. The order in which the points have to be stored to match the ranges
+     * of the cells is returned in \p order, such that the i-th point in the new order is
+     * the point <code>order[i]</code> of the provided points.
+     *
+     * \param maxPointsPerCell Cells with more points than this are subdivided
+     * \param maxLevel Cells on this level are not subdivided any further
+     */
+    GeodeticIndex(const std::vector<Geodetic2>& locations,
+        const std::vector<glm::vec3>& positions, std::vector<uint32_t>& order,
+        size_t maxPointsPerCell = 32, int maxLevel = 16);
+
+    /**
+     * Creates the index from cells that were created before, for example when they are
+     * loaded from a cache file. Cells that are read from a file have to be checked with
+     * #isValid before the index is queried.
+     */
+    explicit GeodeticIndex(std::vector<Cell> cells);
+
+    /**
+     * Returns the ranges of points that are in cells that are not hidden according to
+     * \p classify, which is called with each Cell that is reached from the roots and
+     * returns its Visibility. Children of cells that are Visible or Hidden are not
+     * tested. The ranges are appended to \p ranges.
+     */
+    template <typename Func>
+    void query(Func classify, std::vector<Range>& ranges) const;
+
+    /// Returns all cells of the index, the first two cells are the roots
+    const std::vector<Cell>& cells() const;
+
+    /// The number of points in the index
+    uint32_t numPoints() const;
+
+    /**
+     * Returns whether the cells form a tree that could have been created by this class.
+     * The roots have to be on level 1 and cover consecutive ranges of points starting at
+     * 0, every child has to come after its parent and be one level finer, no cell can be
+     * finer than MaxLevel, and the four children of a cell have to split its range of
+     * points into consecutive ranges. If the index is valid, all ranges returned by
+     * #query are within [0, #numPoints).
+     */
+    bool isValid() const;
+
+private:
+    std::vector<Cell> _cells;
+};
+
+} // namespace openspace::globebrowsing
+
+#include <modules/globebrowsing/src/geodeticindex.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___GEODETICINDEX___H__
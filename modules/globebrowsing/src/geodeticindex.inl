@@ -0,0 +1,71 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+namespace openspace::globebrowsing {
+
+template <typename Func>
+void GeodeticIndex::query(Func classify, std::vector<Range>& ranges) const {
+    if (_cells.empty()) {
+        return;
+    }
+
+    // A depth-first traversal holds at most three waiting siblings per level below the
+    // roots plus the cell that is visited next. The cells of a valid index are at most
+    // on MaxLevel, which bounds the size of the stack
+    constexpr const size_t StackSize = 2 + 3 * MaxLevel;
+    std::array<uint32_t, StackSize> stack;
+    size_t stackSize = 0;
+    stack[stackSize++] = 1;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Cell& cell = _cells[stack[--stackSize]];
+        if (cell.begin == cell.end) {
+            continue;
+        }
+
+        const Visibility visibility = classify(cell);
+        if (visibility == Visibility::Hidden) {
+            continue;
+        }
+
+        if (visibility == Visibility::Visible || cell.firstChild == NoChild) {
+            ranges.push_back({
+                cell.begin,
+                cell.end,
+                visibility == Visibility::Visible
+            });
+        }
+        else {
+            // Push in reverse so that the children are visited in the order of the points
+            ghoul_assert(stackSize + 4 <= StackSize, "Index is not valid");
+            for (uint32_t c = 4; c > 0; --c) {
+                stack[stackSize++] = cell.firstChild + c - 1;
+            }
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing
@@ -39,6 +39,7 @@ public:
     GeodeticPatch(const Geodetic2& center, const Geodetic2& halfSize);
 
     GeodeticPatch(const GeodeticPatch& patch) = default;
+    GeodeticPatch& operator=(const GeodeticPatch& patch) = default;
 
     GeodeticPatch(const TileIndex& tileIndex);
 
@@ -40,9 +40,12 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/opengl/programobject.h>
+#include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <fstream>
 #include <locale>
+#include <numeric>
 
 namespace {
     constexpr const char* KeyLabels = "Labels";
@@ -59,7 +62,7 @@ namespace {
         Circularly
     };
 
-    constexpr int8_t CurrentCacheVersion = 1;
+    constexpr int8_t CurrentCacheVersion = 2;
 
     constexpr openspace::properties::Property::PropertyInfo LabelsInfo = {
         "Labels",
@@ -157,6 +160,35 @@ namespace {
         "Label Alignment Option",
         "Labels are aligned horizontally or circularly related to the planet."
     };
+
+    // A label has to be at least this far inside all frustum planes to be drawn
+    constexpr const double FrustumRadius = 1.0;
+
+    // Returns the normalized left, right, bottom, top, and near planes of the frustum
+    // of the matrix \p m. The far plane is not included because the atmosphere has no
+    // depth
+    std::array<glm::dvec4, 5> frustumPlanes(const glm::dmat4& m) {
+        const glm::dvec4 row1 = glm::dvec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+        const glm::dvec4 row2 = glm::dvec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+        const glm::dvec4 row3 = glm::dvec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+        const glm::dvec4 row4 = glm::dvec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        std::array<glm::dvec4, 5> planes = {
+            row4 + row1,
+            row4 - row1,
+            row4 + row2,
+            row4 - row2,
+            row4 + row3
+        };
+        for (glm::dvec4& p : planes) {
+            p /= glm::length(glm::dvec3(p));
+        }
+        return planes;
+    }
+
+    double signedDistance(const glm::dvec4& plane, const glm::dvec3& position) {
+        return glm::dot(glm::dvec3(plane), position) + plane.w;
+    }
 } // namespace
 
 namespace openspace {
@@ -553,6 +585,7 @@ bool GlobeLabelsComponent::readLabelsFile(const std::string& file) {
             _labels.labelsArray.push_back(lEntry);
         }
 
+        buildLabelIndex();
         return true;
     }
     catch (const std::fstream::failure& e) {
@@ -562,6 +595,39 @@ bool GlobeLabelsComponent::readLabelsFile(const std::string& file) {
     }
 }
 
+void GlobeLabelsComponent::buildLabelIndex() {
+    std::vector<globebrowsing::Geodetic2> locations;
+    std::vector<glm::vec3> positions;
+    locations.reserve(_labels.labelsArray.size());
+    positions.reserve(_labels.labelsArray.size());
+    for (const LabelEntry& lEntry : _labels.labelsArray) {
+        // The longitudes of the labels are in [0, 360), but the cells of the index use
+        // the same [-180, 180) range as the chunks of the globe
+        double lon = std::fmod(static_cast<double>(lEntry.longitude), 360.0);
+        if (lon >= 180.0) {
+            lon -= 360.0;
+        }
+        else if (lon < -180.0) {
+            lon += 360.0;
+        }
+        locations.push_back({
+            glm::radians(static_cast<double>(lEntry.latitude)),
+            glm::radians(lon)
+        });
+        positions.push_back(lEntry.geoPosition);
+    }
+
+    std::vector<uint32_t> order;
+    _labelIndex = globebrowsing::GeodeticIndex(locations, positions, order);
+
+    std::vector<LabelEntry> sorted;
+    sorted.reserve(order.size());
+    for (uint32_t i : order) {
+        sorted.push_back(_labels.labelsArray[i]);
+    }
+    _labels.labelsArray = std::move(sorted);
+}
+
 bool GlobeLabelsComponent::loadCachedFile(const std::string& file) {
     std::ifstream fileStream(file, std::ifstream::binary);
     if (!fileStream.good()) {
@@ -580,6 +646,10 @@ bool GlobeLabelsComponent::loadCachedFile(const std::string& file) {
 
     int32_t nValues = 0;
     fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
+    if (!fileStream.good() || nValues < 0) {
+        LERROR(fmt::format("Cache file '{}' is corrupt", file));
+        return false;
+    }
     _labels.labelsArray.resize(nValues);
 
     fileStream.read(
@@ -587,7 +657,27 @@ bool GlobeLabelsComponent::loadCachedFile(const std::string& file) {
         nValues * sizeof(LabelEntry)
     );
 
-    return fileStream.good();
+    using Cell = globebrowsing::GeodeticIndex::Cell;
+    int32_t nCells = 0;
+    fileStream.read(reinterpret_cast<char*>(&nCells), sizeof(int32_t));
+    if (!fileStream.good() || nCells < 2) {
+        LERROR(fmt::format("Cache file '{}' does not contain a label index", file));
+        return false;
+    }
+    std::vector<Cell> cells(nCells);
+    fileStream.read(reinterpret_cast<char*>(cells.data()), nCells * sizeof(Cell));
+    _labelIndex = globebrowsing::GeodeticIndex(std::move(cells));
+
+    // The index is queried without bounds checks, so a corrupt index has to be rejected
+    // here, which causes the labels file to be read and the index to be rebuilt
+    const bool isValid = fileStream.good() && _labelIndex.isValid() &&
+                         _labelIndex.numPoints() == static_cast<uint32_t>(nValues);
+    if (!isValid) {
+        LERROR(fmt::format("Cache file '{}' contains an invalid label index", file));
+        _labelIndex = globebrowsing::GeodeticIndex();
+        return false;
+    }
+    return true;
 }
 
 bool GlobeLabelsComponent::saveCachedFile(const std::string& file) const {
@@ -609,6 +699,16 @@ bool GlobeLabelsComponent::saveCachedFile(const std::string& file) const {
     size_t nBytes = nValues * sizeof(LabelEntry);
     fileStream.write(reinterpret_cast<const char*>(_labels.labelsArray.data()), nBytes);
 
+    // The labels are stored in the order of the index, so the index is stored with them
+    using Cell = globebrowsing::GeodeticIndex::Cell;
+    const std::vector<Cell>& cells = _labelIndex.cells();
+    int32_t nCells = static_cast<int32_t>(cells.size());
+    fileStream.write(reinterpret_cast<const char*>(&nCells), sizeof(int32_t));
+    fileStream.write(
+        reinterpret_cast<const char*>(cells.data()),
+        nCells * sizeof(Cell)
+    );
+
     return fileStream.good();
 }
 
@@ -671,20 +771,9 @@ void GlobeLabelsComponent::renderLabels(const RenderData& data,
                                         float distToCamera,
                                         float fadeInVariable
 ) {
-    constexpr double DIST_EPS = 6000.0;
-    constexpr double SIN_EPS = 0.001;
-
     glm::vec4 textColor = _labelsColor;
     textColor.a *= fadeInVariable;
 
-    glm::dmat4 invMP = glm::inverse(_globe->modelTransform());
-    glm::dmat4 invCombinedView = glm::inverse(data.camera.combinedViewMatrix());
-
-    glm::dvec4 cameraPosWorld = invCombinedView * glm::dvec4(0.0, 0.0, 0.0, 1.0);
-    glm::dvec3 cameraPosObj = glm::dvec3(invMP * cameraPosWorld);
-    glm::dvec4 cameraUpVecWorld = glm::dvec4(data.camera.lookUpVectorWorldSpace(), 0.0);
-    glm::dvec3 cameraLookUpObj = glm::dvec3(invMP * cameraUpVecWorld);
-
     glm::dmat4 VP = glm::dmat4(data.camera.sgctInternal.projectionMatrix()) *
                     data.camera.combinedViewMatrix();
 
@@ -709,146 +798,137 @@ void GlobeLabelsComponent::renderLabels(const RenderData& data,
     }
     glm::dvec3 orthoUp = glm::normalize(glm::cross(orthoRight, cameraViewDirectionObj));
 
-    for (const LabelEntry& lEntry : _labels.labelsArray) {
-        glm::vec3 position = lEntry.geoPosition;
-        glm::dvec3 locationPositionWorld =
-            glm::dvec3(_globe->modelTransform() * glm::dvec4(position, 1.0));
-        double distanceCameraToLabelWorld =
-            glm::length(locationPositionWorld - data.camera.positionVec3());
-
-        if (_labelsDisableCullingEnabled ||
-            ((distToCamera > (distanceCameraToLabelWorld + _labelsDistaneEPS)) &&
-            isLabelInFrustum(VP, locationPositionWorld)))
-        {
-            if (_labelAlignmentOption == Circularly) {
-                glm::dvec3 labelNormalObj = glm::dvec3(
-                    invModelMatrix * glm::dvec4(data.camera.positionVec3(), 1.0)
-                ) - glm::dvec3(position);
+    const glm::dmat4 modelTransform = _globe->modelTransform();
+    const glm::dvec3 cameraPosWorldSpace = data.camera.positionVec3();
 
-                glm::dvec3 labelUpDirectionObj = glm::dvec3(position);
+    // Collect all labels that are in front of the globe and inside the frustum first.
+    // The index is used to accept or reject whole cells of labels at once and only the
+    // labels in cells that straddle one of the boundaries are tested individually
+    _visibleLabels.clear();
+    if (_labelsDisableCullingEnabled) {
+        _visibleLabels.resize(_labels.labelsArray.size());
+        std::iota(_visibleLabels.begin(), _visibleLabels.end(), 0);
+    }
+    else {
+        using GeodeticIndex = globebrowsing::GeodeticIndex;
+
+        const std::array<glm::dvec4, 5> planes = frustumPlanes(VP);
+        const double threshold = static_cast<double>(distToCamera) - _labelsDistaneEPS;
+        const double radiusScale = std::max({
+            glm::length(glm::dvec3(modelTransform[0])),
+            glm::length(glm::dvec3(modelTransform[1])),
+            glm::length(glm::dvec3(modelTransform[2]))
+        });
+
+        auto classify = [&](const GeodeticIndex::Cell& cell) {
+            const glm::dvec3 center = glm::dvec3(
+                modelTransform * glm::dvec4(glm::dvec3(cell.center), 1.0)
+            );
+            const double radius = cell.radius * radiusScale;
 
-                orthoRight = glm::normalize(
-                    glm::cross(labelUpDirectionObj, labelNormalObj)
-                );
-                if (orthoRight == glm::dvec3(0.0)) {
-                    glm::dvec3 otherVector(
-                        labelUpDirectionObj.y,
-                        labelUpDirectionObj.x,
-                        labelUpDirectionObj.z
-                    );
-                    orthoRight = glm::normalize(glm::cross(otherVector, labelNormalObj));
+            const double distance = glm::length(center - cameraPosWorldSpace);
+            if (distance - radius >= threshold) {
+                return GeodeticIndex::Visibility::Hidden;
+            }
+            bool isInside = distance + radius < threshold;
+            for (const glm::dvec4& plane : planes) {
+                const double s = signedDistance(plane, center);
+                if (s + radius < -FrustumRadius) {
+                    return GeodeticIndex::Visibility::Hidden;
                 }
-                orthoUp = glm::normalize(glm::cross(labelNormalObj, orthoRight));
+                isInside &= (s - radius >= -FrustumRadius);
             }
+            return isInside ?
+                GeodeticIndex::Visibility::Visible :
+                GeodeticIndex::Visibility::Partial;
+        };
+
+        _labelRanges.clear();
+        _labelIndex.query(classify, _labelRanges);
+
+        for (const GeodeticIndex::Range& range : _labelRanges) {
+            for (uint32_t i = range.begin; i < range.end; ++i) {
+                if (range.isVisible) {
+                    _visibleLabels.push_back(i);
+                    continue;
+                }
 
-            position += _labelsMinHeight;
-
-            ghoul::fontrendering::FontRenderer::ProjectedLabelsInformation labelInfo;
-            labelInfo.orthoRight = orthoRight;
-            labelInfo.orthoUp = orthoUp;
-            labelInfo.minSize = _labelsMinSize;
-            labelInfo.maxSize = _labelsMaxSize;
-            labelInfo.cameraPos = data.camera.positionVec3();
-            labelInfo.cameraLookUp = data.camera.lookUpVectorWorldSpace();
-            labelInfo.renderType = 0;
-            labelInfo.mvpMatrix = modelViewProjectionMatrix;
-            labelInfo.scale = powf(2.f, _labelsSize);
-            labelInfo.enableDepth = true;
-            labelInfo.enableFalseDepth = true;
-            labelInfo.disableTransmittance = true;
-
-            // Testing
-            glm::dmat4 modelviewTransform = glm::dmat4(data.camera.combinedViewMatrix()) *
-                                            _globe->modelTransform();
-            labelInfo.modelViewMatrix = modelviewTransform;
-            labelInfo.projectionMatrix = glm::dmat4(
-                data.camera.sgctInternal.projectionMatrix()
-            );
+                const glm::dvec3 locationPositionWorld = glm::dvec3(
+                    modelTransform * glm::dvec4(_labels.labelsArray[i].geoPosition, 1.0)
+                );
+                const double distanceCameraToLabelWorld =
+                    glm::length(locationPositionWorld - cameraPosWorldSpace);
+                if (distanceCameraToLabelWorld >= threshold) {
+                    continue;
+                }
 
-            ghoul::fontrendering::FontRenderer::defaultProjectionRenderer().render(
-                *_font,
-                position,
-                lEntry.feature,
-                textColor,
-                labelInfo
-            );
+                const bool isInFrustum = std::all_of(
+                    planes.begin(),
+                    planes.end(),
+                    [&](const glm::dvec4& plane) {
+                        return signedDistance(plane, locationPositionWorld) >=
+                               -FrustumRadius;
+                    }
+                );
+                if (isInFrustum) {
+                    _visibleLabels.push_back(i);
+                }
+            }
         }
     }
-}
 
-bool GlobeLabelsComponent::isLabelInFrustum(const glm::dmat4& MVMatrix,
-                                            const glm::dvec3& position) const
-{
+    ghoul::fontrendering::FontRenderer::ProjectedLabelsInformation labelInfo;
+    labelInfo.minSize = _labelsMinSize;
+    labelInfo.maxSize = _labelsMaxSize;
+    labelInfo.cameraPos = cameraPosWorldSpace;
+    labelInfo.cameraLookUp = data.camera.lookUpVectorWorldSpace();
+    labelInfo.renderType = 0;
+    labelInfo.mvpMatrix = modelViewProjectionMatrix;
+    labelInfo.scale = powf(2.f, _labelsSize);
+    labelInfo.enableDepth = true;
+    labelInfo.enableFalseDepth = true;
+    labelInfo.disableTransmittance = true;
+    labelInfo.modelViewMatrix = glm::dmat4(data.camera.combinedViewMatrix()) *
+                                modelTransform;
+    labelInfo.projectionMatrix = glm::dmat4(data.camera.sgctInternal.projectionMatrix());
+
+    const glm::dvec3 cameraPosObj = glm::dvec3(
+        invModelMatrix * glm::dvec4(cameraPosWorldSpace, 1.0)
+    );
 
-    // Frustum Planes
-    glm::dvec3 col1(MVMatrix[0][0], MVMatrix[1][0], MVMatrix[2][0]);
-    glm::dvec3 col2(MVMatrix[0][1], MVMatrix[1][1], MVMatrix[2][1]);
-    glm::dvec3 col3(MVMatrix[0][2], MVMatrix[1][2], MVMatrix[2][2]);
-    glm::dvec3 col4(MVMatrix[0][3], MVMatrix[1][3], MVMatrix[2][3]);
-
-    glm::dvec3 leftNormal = col4 + col1;
-    glm::dvec3 rightNormal = col4 - col1;
-    glm::dvec3 bottomNormal = col4 + col2;
-    glm::dvec3 topNormal = col4 - col2;
-    glm::dvec3 nearNormal = col3 + col4;
-    glm::dvec3 farNormal = col4 - col3;
-
-    // Plane Distances
-    double leftDistance = MVMatrix[3][3] + MVMatrix[3][0];
-    double rightDistance = MVMatrix[3][3] - MVMatrix[3][0];
-    double bottomDistance = MVMatrix[3][3] + MVMatrix[3][1];
-    double topDistance = MVMatrix[3][3] - MVMatrix[3][1];
-    double nearDistance = MVMatrix[3][3] + MVMatrix[3][2];
-    double farDistance = MVMatrix[3][3] - MVMatrix[3][2];
-
-    // Normalize Planes
-    const double invMagLeft = 1.0 / glm::length(leftNormal);
-    leftNormal *= invMagLeft;
-    leftDistance *= invMagLeft;
-
-    const double invMagRight = 1.0 / glm::length(rightNormal);
-    rightNormal *= invMagRight;
-    rightDistance *= invMagRight;
-
-    const double invMagBottom = 1.0 / glm::length(bottomNormal);
-    bottomNormal *= invMagBottom;
-    bottomDistance *= invMagBottom;
-
-    const double invMagTop = 1.0 / glm::length(topNormal);
-    topNormal *= invMagTop;
-    topDistance *= invMagTop;
-
-    const double invMagNear = 1.0 / glm::length(nearNormal);
-    nearNormal *= invMagNear;
-    nearDistance *= invMagNear;
-
-    const double invMagFar = 1.0 / glm::length(farNormal);
-    farNormal *= invMagFar;
-    farDistance *= invMagFar;
-
-    constexpr const float Radius = 1.0;
-
-    if ((glm::dot(leftNormal, position) + leftDistance) < -Radius) {
-        return false;
-    }
-    else if ((glm::dot(rightNormal, position) + rightDistance) < -Radius) {
-        return false;
-    }
-    else if ((glm::dot(bottomNormal, position) + bottomDistance) < -Radius) {
-        return false;
-    }
-    else if ((glm::dot(topNormal, position) + topDistance) < -Radius) {
-        return false;
-    }
-    else if ((glm::dot(nearNormal, position) + nearDistance) < -Radius) {
-        return false;
-    }
-    // The far plane testing is disabled because the atm has no depth.
-    /*else if ((glm::dot(farNormal, position) + farDistance) < -Radius) {
-    return false;
-    }*/
+    for (uint32_t i : _visibleLabels) {
+        const LabelEntry& lEntry = _labels.labelsArray[i];
+        glm::vec3 position = lEntry.geoPosition;
 
-    return true;
+        if (_labelAlignmentOption == Circularly) {
+            glm::dvec3 labelNormalObj = cameraPosObj - glm::dvec3(position);
+            glm::dvec3 labelUpDirectionObj = glm::dvec3(position);
+
+            orthoRight = glm::normalize(glm::cross(labelUpDirectionObj, labelNormalObj));
+            if (orthoRight == glm::dvec3(0.0)) {
+                glm::dvec3 otherVector(
+                    labelUpDirectionObj.y,
+                    labelUpDirectionObj.x,
+                    labelUpDirectionObj.z
+                );
+                orthoRight = glm::normalize(glm::cross(otherVector, labelNormalObj));
+            }
+            orthoUp = glm::normalize(glm::cross(labelNormalObj, orthoRight));
+        }
+
+        position += _labelsMinHeight;
+
+        labelInfo.orthoRight = orthoRight;
+        labelInfo.orthoUp = orthoUp;
+
+        ghoul::fontrendering::FontRenderer::defaultProjectionRenderer().render(
+            *_font,
+            position,
+            lEntry.feature,
+            textColor,
+            labelInfo
+        );
+    }
 }
 
 } // namespace openspace
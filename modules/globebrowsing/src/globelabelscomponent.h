@@ -27,6 +27,7 @@
 
 #include <openspace/properties/propertyowner.h>
 
+#include <modules/globebrowsing/src/geodeticindex.h>
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/floatproperty.h>
@@ -62,11 +63,11 @@ public:
 private:
     bool loadLabelsData(const std::string& file);
     bool readLabelsFile(const std::string& file);
+    void buildLabelIndex();
     bool loadCachedFile(const std::string& file);
     bool saveCachedFile(const std::string& file) const;
     void renderLabels(const RenderData& data, const glm::dmat4& modelViewProjectionMatrix,
         float distToCamera, float fadeInVariable);
-    bool isLabelInFrustum(const glm::dmat4& MVMatrix, const glm::dvec3& position) const;
 
 private:
     // Labels Structures
@@ -101,6 +102,13 @@ private:
 private:
     Labels _labels;
 
+    // Spatial index over the labels, which are stored in the order of its cells
+    globebrowsing::GeodeticIndex _labelIndex;
+
+    // Reused every frame to avoid reallocating them
+    std::vector<globebrowsing::GeodeticIndex::Range> _labelRanges;
+    std::vector<uint32_t> _visibleLabels;
+
     // Font
     std::shared_ptr<ghoul::fontrendering::Font> _font;
 
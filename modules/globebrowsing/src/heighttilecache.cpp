@@ -0,0 +1,302 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <modules/globebrowsing/src/heighttilecache.h>
+
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr const char* _loggerCat = "HeightTileCache";
+
+    // The same cut-off that is used in the shader. If the sample is actually a no-data
+    // value (min_float), the interpolated value might not be, so all values below this
+    // are considered to be missing
+    constexpr const float MinimumValidHeight = -100000.f;
+} // namespace
+
+namespace openspace::globebrowsing::cache {
+
+namespace {
+
+TileIndex tileIndexForPosition(const Geodetic2& position, int level) {
+    const int numIndicesAtLevel = 1 << level;
+    const double u = 0.5 + position.lon / glm::two_pi<double>();
+    const double v = 0.25 - position.lat / glm::two_pi<double>();
+    const int x = static_cast<int>(floor(u * numIndicesAtLevel));
+    const int y = static_cast<int>(floor(v * numIndicesAtLevel));
+
+    // Positions on the eastern or southern border belong to the last tile
+    return TileIndex(
+        glm::clamp(x, 0, numIndicesAtLevel - 1),
+        glm::clamp(y, 0, numIndicesAtLevel / 2 - 1),
+        level
+    );
+}
+
+glm::vec2 positionInTile(const Geodetic2& position, const TileIndex& tileIndex) {
+    const GeodeticPatch patch = GeodeticPatch(tileIndex);
+    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
+    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+
+    return glm::vec2(
+        (position.lon - southWest.lon) / (northEast.lon - southWest.lon),
+        (position.lat - southWest.lat) / (northEast.lat - southWest.lat)
+    );
+}
+
+} // namespace
+
+std::optional<float> HeightTile::sample(const glm::vec2& uv) const {
+    // Transform the uv coordinates of the tile into the padded texture, in the same way
+    // as Layer::tileUvToTextureSamplePosition
+    const glm::vec2 sourceSize = glm::vec2(dimensions + pixelSizeDifference);
+    const glm::vec2 textureUv = glm::vec2(dimensions) / sourceSize *
+        (uv - glm::vec2(pixelStartOffset) / sourceSize);
+
+    const glm::vec2 samplePos = textureUv * glm::vec2(dimensions);
+    const glm::ivec2 maxPos = dimensions - glm::ivec2(1);
+    const glm::ivec2 samplePos00 = glm::clamp(
+        glm::ivec2(glm::floor(samplePos)),
+        glm::ivec2(0),
+        maxPos
+    );
+    const glm::vec2 samplePosFract = glm::clamp(
+        samplePos - glm::vec2(samplePos00),
+        glm::vec2(0.f),
+        glm::vec2(1.f)
+    );
+    const glm::ivec2 samplePos11 = glm::min(samplePos00 + glm::ivec2(1), maxPos);
+
+    auto texel = [this](int x, int y) {
+        return samples[static_cast<size_t>(y) * dimensions.x + x];
+    };
+    const float sample00 = texel(samplePos00.x, samplePos00.y);
+    const float sample10 = texel(samplePos11.x, samplePos00.y);
+    const float sample01 = texel(samplePos00.x, samplePos11.y);
+    const float sample11 = texel(samplePos11.x, samplePos11.y);
+
+    // In case the texture has NaN or no data values don't use this height map
+    const bool anySampleIsNaN = std::isnan(sample00) || std::isnan(sample01) ||
+        std::isnan(sample10) || std::isnan(sample11);
+    const bool anySampleIsNoData = sample00 == noDataValue || sample01 == noDataValue ||
+        sample10 == noDataValue || sample11 == noDataValue;
+    if (anySampleIsNaN || anySampleIsNoData) {
+        return std::nullopt;
+    }
+
+    const float sample0 = sample00 * (1.f - samplePosFract.x) +
+        sample10 * samplePosFract.x;
+    const float sample1 = sample01 * (1.f - samplePosFract.x) +
+        sample11 * samplePosFract.x;
+    const float sample = sample0 * (1.f - samplePosFract.y) + sample1 * samplePosFract.y;
+    if (sample <= MinimumValidHeight) {
+        return std::nullopt;
+    }
+
+    // Perform depth transform to get the value in meters
+    return depthTransform.offset + depthTransform.scale * sample;
+}
+
+HeightTileCache::HeightTileCache(size_t maximumSize)
+    : _tiles(maximumSize)
+    , _readThread(std::make_unique<ThreadPool>(1))
+{}
+
+HeightTileCache::~HeightTileCache() {
+    // Requests that have not been started would only fill a cache that no longer exists
+    _readThread->clearTasks();
+    _readThread = nullptr;
+}
+
+std::shared_ptr<const HeightTile> HeightTileCache::get(const HeightTileSource& source,
+                                                       const TileIndex& tileIndex)
+{
+    const DiskTileKey key = { source.datasetIdentifier(), tileIndex };
+
+    std::lock_guard lock(_mutex);
+    return _tiles.exist(key) ? _tiles.get(key) : nullptr;
+}
+
+std::shared_ptr<const HeightTile> HeightTileCache::read(const HeightTileSource& source,
+                                                        const TileIndex& tileIndex)
+{
+    std::shared_ptr<const HeightTile> tile = get(source, tileIndex);
+    return tile ? tile : load(source, tileIndex);
+}
+
+void HeightTileCache::request(std::shared_ptr<const HeightTileSource> source,
+                              const TileIndex& tileIndex)
+{
+    const DiskTileKey key = { source->datasetIdentifier(), tileIndex };
+    {
+        std::lock_guard lock(_mutex);
+        if (_tiles.exist(key) || !_requestedTiles.insert(key).second) {
+            return;
+        }
+    }
+
+    _readThread->enqueue([this, source = std::move(source), tileIndex, key]() {
+        load(*source, tileIndex);
+
+        std::lock_guard lock(_mutex);
+        _requestedTiles.erase(key);
+    });
+}
+
+float HeightTileCache::sampleHeight(const std::vector<HeightSamplingLayer>& layers,
+                                    const Geodetic2& position, int level,
+                                    ReadMissingTiles readMissing)
+{
+    float height = 0.f;
+    for (const HeightSamplingLayer& layer : layers) {
+        if (level < 0 || level >= static_cast<int>(layer.sources.size())) {
+            continue;
+        }
+        const std::shared_ptr<const HeightTileSource>& source = layer.sources[level];
+        if (!source) {
+            continue;
+        }
+
+        // Levels beyond the resolution of the dataset are sampled from its finest level
+        const int tileLevel = std::min(level, source->maxChunkLevel());
+        if (tileLevel < 1) {
+            // The dataset is currently being reset
+            return 0.f;
+        }
+
+        TileIndex tileIndex = tileIndexForPosition(position, tileLevel);
+        std::shared_ptr<const HeightTile> tile;
+        if (readMissing) {
+            tile = read(*source, tileIndex);
+        }
+        else {
+            tile = get(*source, tileIndex);
+            if (!tile) {
+                // Use the finest coarser tile that is cached until the requested tile
+                // has been read in the background
+                request(source, tileIndex);
+                while (!tile && tileIndex.level > 1) {
+                    tileIndex = tileIndexForPosition(position, tileIndex.level - 1);
+                    tile = get(*source, tileIndex);
+                }
+            }
+        }
+        if (!tile) {
+            return 0.f;
+        }
+
+        const std::optional<float> sample = tile->sample(
+            positionInTile(position, tileIndex)
+        );
+        if (sample.has_value()) {
+            // Make sure that the height value follows the layer settings, in the same
+            // way as LayerRenderSettings::performLayerSettings. For example if the
+            // multiplier is set to a value bigger than one, the sampled height should be
+            // modified as well
+            const float v = *sample;
+            height = ((glm::sign(v) * glm::pow(glm::abs(v), layer.gamma) *
+                layer.multiplier) + layer.offset) * layer.opacity;
+        }
+    }
+    return height;
+}
+
+void HeightTileCache::clear() {
+    std::lock_guard lock(_mutex);
+    _tiles.clear();
+}
+
+std::shared_ptr<const HeightTile> HeightTileCache::load(const HeightTileSource& source,
+                                                        const TileIndex& tileIndex)
+{
+    // The tile is read without holding the lock, as reading it might involve a request
+    // to a remote server. If two threads read the same tile, the second result wins
+    std::shared_ptr<const HeightTile> tile = source.readTile(tileIndex);
+    if (!tile) {
+        return nullptr;
+    }
+
+    const DiskTileKey key = { source.datasetIdentifier(), tileIndex };
+    std::lock_guard lock(_mutex);
+    _tiles.put(key, tile);
+    return tile;
+}
+
+RawTileHeightSource::RawTileHeightSource(std::shared_ptr<const RawTileDataReader> reader)
+    : _reader(std::move(reader))
+{}
+
+uint64_t RawTileHeightSource::datasetIdentifier() const {
+    return _reader->datasetIdentifier();
+}
+
+int RawTileHeightSource::maxChunkLevel() const {
+    return _reader->maxChunkLevel();
+}
+
+std::shared_ptr<const HeightTile> RawTileHeightSource::readTile(
+                                                        const TileIndex& tileIndex) const
+{
+    RawTile rawTile = _reader->readTileData(tileIndex);
+    if (rawTile.error >= RawTile::ReadError::Failure || !rawTile.imageData ||
+        !rawTile.textureInitData.has_value())
+    {
+        return nullptr;
+    }
+
+    const TileTextureInitData& initData = *rawTile.textureInitData;
+    if (initData.glType != GL_FLOAT || initData.nRasters != 1) {
+        LWARNING(fmt::format(
+            "Tile {},{} at level {} can not be used for height sampling as it does not "
+            "consist of a single float raster",
+            tileIndex.x, tileIndex.y, tileIndex.level
+        ));
+        return nullptr;
+    }
+
+    auto tile = std::make_shared<HeightTile>();
+    tile->dimensions = glm::ivec2(initData.dimensions);
+    tile->pixelStartOffset = initData.tilePixelStartOffset;
+    tile->pixelSizeDifference = initData.tilePixelSizeDifference;
+    tile->depthTransform = _reader->depthTransform();
+    tile->noDataValue = _reader->noDataValueAsFloat();
+    tile->samples.resize(static_cast<size_t>(tile->dimensions.x) * tile->dimensions.y);
+    std::memcpy(
+        tile->samples.data(),
+        rawTile.imageData.get(),
+        tile->samples.size() * sizeof(float)
+    );
+    return tile;
+}
+
+} // namespace openspace::globebrowsing::cache
@@ -0,0 +1,197 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHT_TILE_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHT_TILE_CACHE___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/disktilecache.h>
+#include <modules/globebrowsing/src/lrucache.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <ghoul/glm.h>
+#include <ghoul/misc/boolean.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace openspace { class ThreadPool; }
+
+namespace openspace::globebrowsing {
+    class RawTileDataReader;
+} // namespace openspace::globebrowsing
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * The height values of a single tile of a height layer, stored on the CPU and
+ * independent of any GPU texture. The samples are stored row by row, starting with the
+ * southernmost row, and include the padding of the tile.
+ */
+struct HeightTile {
+    /**
+     * Returns the height in meters at the \p uv coordinates of the tile, where (0, 0) is
+     * the south-west corner and (1, 1) the north-east corner of the tile. The samples
+     * are interpolated bilinearly and the depth transform of the dataset is applied. If
+     * any of the interpolated samples is missing, an empty optional is returned.
+     */
+    std::optional<float> sample(const glm::vec2& uv) const;
+
+    std::vector<float> samples;
+    glm::ivec2 dimensions;
+    glm::ivec2 pixelStartOffset;
+    glm::ivec2 pixelSizeDifference;
+    TileDepthTransform depthTransform;
+    float noDataValue;
+};
+
+/**
+ * A dataset from which HeightTile%s can be read on any thread.
+ */
+class HeightTileSource {
+public:
+    virtual ~HeightTileSource() = default;
+
+    /// Identifies the tiles of this source in the HeightTileCache
+    virtual uint64_t datasetIdentifier() const = 0;
+
+    /// The finest level for which the source provides tiles, or less than 1 if the
+    /// source is currently not available
+    virtual int maxChunkLevel() const = 0;
+
+    /**
+     * Reads the tile \p tileIndex on the calling thread. If the tile can not be read or
+     * can not be used for height sampling, \c nullptr is returned.
+     */
+    virtual std::shared_ptr<const HeightTile> readTile(
+        const TileIndex& tileIndex) const = 0;
+};
+
+/**
+ * Reads the height tiles of a height layer from its RawTileDataReader. The reader
+ * serializes the access to its dataset, so it can be shared with the TileIOScheduler.
+ */
+class RawTileHeightSource : public HeightTileSource {
+public:
+    explicit RawTileHeightSource(std::shared_ptr<const RawTileDataReader> reader);
+
+    uint64_t datasetIdentifier() const override;
+    int maxChunkLevel() const override;
+    std::shared_ptr<const HeightTile> readTile(const TileIndex& tileIndex) const override;
+
+private:
+    std::shared_ptr<const RawTileDataReader> _reader;
+};
+
+/**
+ * Everything that is needed to sample a height layer without accessing its
+ * TileProvider, which may only be used on the main thread.
+ */
+struct HeightSamplingLayer {
+    /// The source of the tiles of the layer for every chunk level, starting at level 0
+    std::vector<std::shared_ptr<const HeightTileSource>> sources;
+    float gamma = 1.f;
+    float multiplier = 1.f;
+    float offset = 0.f;
+    float opacity = 1.f;
+};
+
+/**
+ * A small least-recently-used cache of HeightTile%s that is used to sample the height of
+ * globes on the CPU. The tiles are read directly from the HeightTileSource of a height
+ * layer, which means that heights can be sampled for any location, regardless of
+ * whether the tiles of that location are currently loaded for rendering. The tiles are
+ * identified by the stable dataset identifier of their source, so the tiles of a
+ * dataset are shared between all layers and globes that use it.
+ *
+ * All public functions are thread-safe. The tiles are returned as shared pointers so
+ * that they stay valid while they are sampled, even if they are evicted concurrently.
+ */
+class HeightTileCache {
+public:
+    BooleanType(ReadMissingTiles);
+
+    /**
+     * \param maximumSize The maximum number of tiles that are kept in the cache
+     */
+    HeightTileCache(size_t maximumSize);
+    ~HeightTileCache();
+
+    /**
+     * Returns the tile \p tileIndex of the \p source if it is in the cache, or
+     * \c nullptr otherwise.
+     */
+    std::shared_ptr<const HeightTile> get(const HeightTileSource& source,
+        const TileIndex& tileIndex);
+
+    /**
+     * Returns the tile \p tileIndex of the \p source, reading it on the calling thread if
+     * it is not in the cache. If the tile can not be read, \c nullptr is returned.
+     */
+    std::shared_ptr<const HeightTile> read(const HeightTileSource& source,
+        const TileIndex& tileIndex);
+
+    /**
+     * Reads the tile \p tileIndex of the \p source on a background thread and places it
+     * in the cache, unless it is already cached or being read. The \p source is kept
+     * alive until the read has finished.
+     */
+    void request(std::shared_ptr<const HeightTileSource> source,
+        const TileIndex& tileIndex);
+
+    /**
+     * Samples the height of all \p layers at the \p position from the tiles of the
+     * chunk \p level, or of the finest level of a layer if that is coarser. The layer
+     * settings are applied in the same way as in LayerRenderSettings and the last layer
+     * with a valid sample determines the height. If \p readMissing is \c No, missing
+     * tiles are requested in the background and the finest coarser tile that is cached
+     * is sampled instead. If no tile is available, 0 is returned. If \p readMissing is
+     * \c Yes, missing tiles are read from their dataset on the calling thread, which can
+     * take as long as a request to a remote server, so it must not be used on the
+     * render thread.
+     */
+    float sampleHeight(const std::vector<HeightSamplingLayer>& layers,
+        const Geodetic2& position, int level, ReadMissingTiles readMissing);
+
+    /// Removes all tiles from the cache
+    void clear();
+
+private:
+    std::shared_ptr<const HeightTile> load(const HeightTileSource& source,
+        const TileIndex& tileIndex);
+
+    std::mutex _mutex;
+    LRUCache<DiskTileKey, std::shared_ptr<const HeightTile>, DiskTileKeyHasher> _tiles;
+
+    /// The keys of the tiles that are currently read by the background thread
+    std::unordered_set<DiskTileKey, DiskTileKeyHasher> _requestedTiles;
+    std::unique_ptr<ThreadPool> _readThread;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHT_TILE_CACHE___H__
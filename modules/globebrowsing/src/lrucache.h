@@ -25,8 +25,11 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___LRU_CACHE___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___LRU_CACHE___H__
 
-#include <list>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
 #include <vector>
 
 namespace openspace::globebrowsing::cache {
@@ -34,20 +37,28 @@ namespace openspace::globebrowsing::cache {
 /**
  * Templated class implementing a Least-Recently-Used Cache.
  * <code>KeyType</code> needs to be an enumerable type.
+ *
+ * The items are stored in a slab of nodes that are linked into an intrusive, doubly
+ * linked list ordered by recency, and they are found through an open-addressing hash
+ * table that stores node indices. Nodes of removed items are reused for new items, so
+ * the cache does not allocate memory for <code>put</code>, <code>touch</code>, or
+ * <code>get</code> once it has grown to its working size. Instead of returning the items
+ * that were evicted, an optional eviction callback is called for each of them.
  */
 template <typename KeyType, typename ValueType, typename HasherType>
 class LRUCache {
 public:
     using Item = std::pair<KeyType, ValueType>;
-    using Items = std::list<Item>;
+    using EvictionCallback = std::function<void(KeyType, ValueType)>;
 
     /**
      * \param size is the maximum size of the cache given in number of cached items.
+     * \param onEviction is called for every item that is removed from the cache because
+     *        the maximum size of the cache was exceeded
      */
-    LRUCache(size_t size);
+    LRUCache(size_t size, EvictionCallback onEviction = EvictionCallback());
 
     void put(KeyType key, ValueType value);
-    std::vector<Item> putAndFetchPopped(KeyType key, ValueType value);
     void clear();
     bool exist(const KeyType& key) const;
 
@@ -71,16 +82,49 @@ public:
     size_t size() const;
     size_t maximumCacheSize() const;
 
+    /**
+     * Preallocates the storage for \p nItems items, so that no allocations are
+     * necessary until the cache contains more items than that.
+     */
+    void reserve(size_t nItems);
+
 private:
-    void putWithoutCleaning(KeyType key, ValueType value);
-    void clean();
+    using NodeIndex = uint32_t;
+    static constexpr const NodeIndex InvalidNode = ~NodeIndex(0);
+    static constexpr const size_t NotFound = ~size_t(0);
+
+    struct Node {
+        std::optional<Item> item;
+        uint64_t hash = 0;
+        NodeIndex previous = InvalidNode;
+        NodeIndex next = InvalidNode;
+    };
 
-    std::vector<Item> cleanAndFetchPopped();
+    uint64_t hash(const KeyType& key) const;
+
+    /// Returns the bucket that contains \p key or NotFound
+    size_t findBucket(const KeyType& key, uint64_t hash) const;
+    void insertIntoIndex(NodeIndex node);
+    void eraseFromIndex(NodeIndex node);
+    void rehash(size_t nBuckets);
+
+    NodeIndex allocateNode();
+    Item releaseNode(NodeIndex node);
+
+    void unlink(NodeIndex node);
+    void pushFront(NodeIndex node);
+
+    void clean();
 
-    Items _itemList;
-    std::unordered_map<KeyType, typename Items::const_iterator, HasherType> _itemMap;
+    std::vector<Node> _nodes;
+    std::vector<NodeIndex> _buckets;
+    NodeIndex _head = InvalidNode;
+    NodeIndex _tail = InvalidNode;
+    NodeIndex _freeList = InvalidNode;
+    size_t _size = 0;
 
     size_t _maximumCacheSize;
+    EvictionCallback _onEviction;
 };
 
 } // namespace openspace::globebrowsing::cache
@@ -27,93 +27,96 @@
 namespace openspace::globebrowsing::cache {
 
 template<typename KeyType, typename ValueType, typename HasherType>
-LRUCache<KeyType, ValueType, HasherType>::LRUCache(size_t size)
+LRUCache<KeyType, ValueType, HasherType>::LRUCache(size_t size,
+                                                   EvictionCallback onEviction)
     : _maximumCacheSize(size)
+    , _onEviction(std::move(onEviction))
 {}
 
 template<typename KeyType, typename ValueType, typename HasherType>
 void LRUCache<KeyType, ValueType, HasherType>::clear() {
-    _itemList.clear();
-    _itemMap.clear();
+    // Keep the allocated storage around for the next items
+    _nodes.clear();
+    std::fill(_buckets.begin(), _buckets.end(), InvalidNode);
+    _head = InvalidNode;
+    _tail = InvalidNode;
+    _freeList = InvalidNode;
+    _size = 0;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 void LRUCache<KeyType, ValueType, HasherType>::put(KeyType key, ValueType value) {
-    putWithoutCleaning(std::move(key), std::move(value));
+    const uint64_t h = hash(key);
+    const size_t bucket = findBucket(key, h);
+    if (bucket != NotFound) {
+        const NodeIndex node = _buckets[bucket];
+        _nodes[node].item->second = std::move(value);
+        unlink(node);
+        pushFront(node);
+    }
+    else {
+        const NodeIndex node = allocateNode();
+        _nodes[node].item.emplace(std::move(key), std::move(value));
+        _nodes[node].hash = h;
+        // The node has to be added to the index before it is linked into the list, as
+        // a rehash reinserts all nodes that are reachable through the list
+        insertIntoIndex(node);
+        pushFront(node);
+        ++_size;
+    }
     clean();
 }
 
-template<typename KeyType, typename ValueType, typename HasherType>
-std::vector<std::pair<KeyType, ValueType>>
-LRUCache<KeyType, ValueType, HasherType>::putAndFetchPopped(KeyType key, ValueType value)
-{
-    putWithoutCleaning(std::move(key), std::move(value));
-    return cleanAndFetchPopped();
-}
-
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::exist(const KeyType& key) const {
-    return (_itemMap.count(key) > 0);
+    return findBucket(key, hash(key)) != NotFound;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::touch(const KeyType& key) {
-    const auto it = _itemMap.find(key);
-    if (it != _itemMap.end()) { // Found in cache
-        ValueType value = it->second->second;
-        // Remove from current position
-        _itemList.erase(it->second);
-        _itemMap.erase(it);
+    const size_t bucket = findBucket(key, hash(key));
+    if (bucket != NotFound) { // Found in cache
         // Bump to front
-        _itemList.emplace_front(key, value);
-        _itemMap.emplace(key, _itemList.begin());
-
+        const NodeIndex node = _buckets[bucket];
+        unlink(node);
+        pushFront(node);
         return true;
-    } else {
+    }
+    else {
         return false;
     }
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::isEmpty() const {
-    return (_itemMap.size() == 0);
+    return (_size == 0);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 ValueType LRUCache<KeyType, ValueType, HasherType>::get(const KeyType& key) {
-    //ghoul_assert(exist(key), "Key " << key << " must exist");
-    const auto it = _itemMap.find(key);
-    // Move list iterator pointing to value
-    _itemList.splice(_itemList.begin(), _itemList, it->second);
-    return it->second->second;
+    const size_t bucket = findBucket(key, hash(key));
+    ghoul_assert(bucket != NotFound, "Key must exist");
+    const NodeIndex node = _buckets[bucket];
+    unlink(node);
+    pushFront(node);
+    return _nodes[node].item->second;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 std::pair<KeyType, ValueType> LRUCache<KeyType, ValueType, HasherType>::popMRU() {
-    ghoul_assert(!_itemList.empty(), "Cannot pop LRU cache. Ensure cache is not empty.");
-
-    auto first_it = _itemList.begin();
-    _itemMap.erase(first_it->first);
-    std::pair<KeyType, ValueType> toReturn = _itemList.front();
-    _itemList.pop_front();
-    return toReturn;
+    ghoul_assert(_size > 0, "Cannot pop LRU cache. Ensure cache is not empty.");
+    return releaseNode(_head);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 std::pair<KeyType, ValueType> LRUCache<KeyType, ValueType, HasherType>::popLRU() {
-    ghoul_assert(!_itemList.empty(), "Cannot pop LRU cache. Ensure cache is not empty.");
-
-    auto lastIt = _itemList.end();
-    lastIt--;
-    _itemMap.erase(lastIt->first);
-    std::pair<KeyType, ValueType> toReturn = _itemList.back();
-    _itemList.pop_back();
-    return toReturn;
+    ghoul_assert(_size > 0, "Cannot pop LRU cache. Ensure cache is not empty.");
+    return releaseNode(_tail);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 size_t LRUCache<KeyType, ValueType, HasherType>::size() const {
-    return _itemMap.size();
+    return _size;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
@@ -122,41 +125,172 @@ size_t LRUCache<KeyType, ValueType, HasherType>::maximumCacheSize() const {
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
-void LRUCache<KeyType, ValueType, HasherType>::putWithoutCleaning(KeyType key,
-                                                                  ValueType value)
+void LRUCache<KeyType, ValueType, HasherType>::reserve(size_t nItems) {
+    _nodes.reserve(nItems);
+    size_t nBuckets = _buckets.empty() ? 16 : _buckets.size();
+    while (nBuckets < 2 * nItems) {
+        nBuckets *= 2;
+    }
+    if (nBuckets != _buckets.size()) {
+        rehash(nBuckets);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+uint64_t LRUCache<KeyType, ValueType, HasherType>::hash(const KeyType& key) const {
+    // The hashers that are used with this cache are often only packing the key into an
+    // integer, so we mix the bits to spread consecutive keys over the buckets
+    uint64_t h = static_cast<uint64_t>(HasherType()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+size_t LRUCache<KeyType, ValueType, HasherType>::findBucket(const KeyType& key,
+                                                            uint64_t hash) const
 {
-    const auto it = _itemMap.find(key);
-    if (it != _itemMap.end()) {
-        _itemList.erase(it->second);
-        _itemMap.erase(it);
+    if (_buckets.empty()) {
+        return NotFound;
     }
-    _itemList.emplace_front(key, std::move(value));
-    _itemMap.emplace(std::move(key), _itemList.begin());
+
+    const size_t mask = _buckets.size() - 1;
+    size_t bucket = static_cast<size_t>(hash) & mask;
+    while (_buckets[bucket] != InvalidNode) {
+        const Node& n = _nodes[_buckets[bucket]];
+        if (n.hash == hash && n.item->first == key) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    return NotFound;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
-void LRUCache<KeyType, ValueType, HasherType>::clean() {
-    while (_itemMap.size() > _maximumCacheSize) {
-        auto lastIt = _itemList.end();
-        lastIt--;
-        _itemMap.erase(lastIt->first);
-        _itemList.pop_back();
+void LRUCache<KeyType, ValueType, HasherType>::insertIntoIndex(NodeIndex node) {
+    // Keep the load factor at or below 0.5 to keep the probe sequences short
+    if (2 * (_size + 1) > _buckets.size()) {
+        rehash(_buckets.empty() ? 16 : 2 * _buckets.size());
+    }
+
+    const size_t mask = _buckets.size() - 1;
+    size_t bucket = static_cast<size_t>(_nodes[node].hash) & mask;
+    while (_buckets[bucket] != InvalidNode) {
+        bucket = (bucket + 1) & mask;
+    }
+    _buckets[bucket] = node;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::eraseFromIndex(NodeIndex node) {
+    const size_t mask = _buckets.size() - 1;
+    size_t bucket = static_cast<size_t>(_nodes[node].hash) & mask;
+    while (_buckets[bucket] != node) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    // Backward-shift deletion: move all following entries of the probe sequence that
+    // would no longer be reachable into the hole, which avoids the need for tombstones
+    size_t hole = bucket;
+    size_t next = (hole + 1) & mask;
+    while (_buckets[next] != InvalidNode) {
+        const size_t home = static_cast<size_t>(_nodes[_buckets[next]].hash) & mask;
+        // Distance from the home bucket to the current and to the hole position
+        const size_t distanceNext = (next - home) & mask;
+        const size_t distanceHole = (hole - home) & mask;
+        if (distanceHole < distanceNext) {
+            _buckets[hole] = _buckets[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    _buckets[hole] = InvalidNode;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::rehash(size_t nBuckets) {
+    _buckets.assign(nBuckets, InvalidNode);
+    const size_t mask = nBuckets - 1;
+    for (NodeIndex n = _head; n != InvalidNode; n = _nodes[n].next) {
+        size_t bucket = static_cast<size_t>(_nodes[n].hash) & mask;
+        while (_buckets[bucket] != InvalidNode) {
+            bucket = (bucket + 1) & mask;
+        }
+        _buckets[bucket] = n;
+    }
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+typename LRUCache<KeyType, ValueType, HasherType>::NodeIndex
+LRUCache<KeyType, ValueType, HasherType>::allocateNode()
+{
+    if (_freeList != InvalidNode) {
+        const NodeIndex node = _freeList;
+        _freeList = _nodes[node].next;
+        return node;
     }
+    _nodes.emplace_back();
+    return static_cast<NodeIndex>(_nodes.size() - 1);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
-std::vector<std::pair<KeyType, ValueType>>
-LRUCache<KeyType, ValueType, HasherType>::cleanAndFetchPopped()
+std::pair<KeyType, ValueType> LRUCache<KeyType, ValueType, HasherType>::releaseNode(
+                                                                          NodeIndex node)
 {
-    std::vector<std::pair<KeyType, ValueType>> toReturn;
-    while (_itemMap.size() > _maximumCacheSize) {
-        auto lastIt = _itemList.end();
-        lastIt--;
-        _itemMap.erase(lastIt->first);
-        toReturn.push_back(_itemList.back());
-        _itemList.pop_back();
-    }
-    return toReturn;
+    eraseFromIndex(node);
+    unlink(node);
+
+    Node& n = _nodes[node];
+    Item item = std::move(*n.item);
+    n.item.reset();
+    n.next = _freeList;
+    _freeList = node;
+    --_size;
+    return item;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::unlink(NodeIndex node) {
+    Node& n = _nodes[node];
+    if (n.previous != InvalidNode) {
+        _nodes[n.previous].next = n.next;
+    }
+    else {
+        _head = n.next;
+    }
+    if (n.next != InvalidNode) {
+        _nodes[n.next].previous = n.previous;
+    }
+    else {
+        _tail = n.previous;
+    }
+    n.previous = InvalidNode;
+    n.next = InvalidNode;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::pushFront(NodeIndex node) {
+    Node& n = _nodes[node];
+    n.previous = InvalidNode;
+    n.next = _head;
+    if (_head != InvalidNode) {
+        _nodes[_head].previous = node;
+    }
+    _head = node;
+    if (_tail == InvalidNode) {
+        _tail = node;
+    }
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::clean() {
+    while (_size > _maximumCacheSize) {
+        Item item = releaseNode(_tail);
+        if (_onEviction) {
+            _onEviction(std::move(item.first), std::move(item.second));
+        }
+    }
 }
 
 } // namespace openspace::globebrowsing::cache
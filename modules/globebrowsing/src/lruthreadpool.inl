@@ -59,8 +59,13 @@ void LRUThreadPoolWorker<KeyType>::operator()() {
 
 template<typename KeyType>
 LRUThreadPool<KeyType>::LRUThreadPool(size_t numThreads, size_t queueSize)
-    : _queuedTasks(queueSize)
+    : _queuedTasks(
+        queueSize,
+        [this](KeyType key, std::function<void()>) { _unqueuedTasks.push_back(key); }
+    )
 {
+    _queuedTasks.reserve(queueSize + 1);
+
     for (size_t i = 0; i < numThreads; ++i) {
         _workers.push_back(std::thread(LRUThreadPoolWorker<KeyType>(*this)));
     }
@@ -92,15 +97,9 @@ void LRUThreadPool<KeyType>::enqueue(std::function<void()> f, KeyType key) {
     {
         std::unique_lock<std::mutex> lock(_queueMutex);
 
-        // add the task
-        //_queuedTasks.put(key, f);
-        const std::vector<std::pair<KeyType, std::function<void()>>>& unfinishedTasks =
-            _queuedTasks.putAndFetchPopped(key, f);
-        for (const std::pair<KeyType, std::function<void()>>& unfinishedTask :
-             unfinishedTasks)
-        {
-            _unqueuedTasks.push_back(unfinishedTask.first);
-        }
+        // add the task, tasks that are pushed out of the queue are recorded in the
+        // eviction callback
+        _queuedTasks.put(std::move(key), std::move(f));
     }
 
     // wake up one thread
@@ -115,9 +114,10 @@ bool LRUThreadPool<KeyType>::touch(KeyType key) {
 
 template<typename KeyType>
 std::vector<KeyType> LRUThreadPool<KeyType>::getUnqueuedTasksKeys() {
-    std::vector<KeyType> toReturn = _unqueuedTasks;
+    std::vector<KeyType> toReturn;
     {
         std::unique_lock<std::mutex> lock(_queueMutex);
+        toReturn = _unqueuedTasks;
         _unqueuedTasks.clear();
     }
     return toReturn;
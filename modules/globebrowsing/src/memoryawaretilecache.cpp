@@ -359,6 +359,8 @@ void MemoryAwareTileCache::resetTextureContainerSize(size_t numTexturesPerTextur
     {
         p.second.first->reset(numTexturesPerTextureType);
         p.second.second->clear();
+        // There can never be more tiles than textures in each cache
+        p.second.second->reserve(numTexturesPerTextureType);
     }
 }
 
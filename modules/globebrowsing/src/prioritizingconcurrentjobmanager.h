@@ -26,8 +26,12 @@
 #define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 
 #include <modules/globebrowsing/src/lruthreadpool.h>
-#include <openspace/util/concurrentqueue.h>
+#include <openspace/util/boundedconcurrentqueue.h>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace openspace { template <typename T> struct Job; }
 
@@ -80,11 +84,25 @@ public:
      */
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /**
+     * \returns all jobs that have finished at the time of the call, in the order in
+     * which they finished.
+     */
+    std::vector<std::shared_ptr<Job<P>>> popFinishedJobs();
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
+    void pushFinishedJob(std::shared_ptr<Job<P>> job);
+
+    BoundedConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
+
+    // Finished jobs that did not fit into _finishedJobs. The number of finished jobs is
+    // not limited, so the workers never have to wait for the owner to pop them
+    std::deque<std::shared_ptr<Job<P>>> _overflowJobs;
+    std::mutex _overflowMutex;
+    std::atomic<size_t> _nOverflowJobs = 0;
+
     /// An LRU thread pool is used since the jobs can be bumped and hence prioritized.
     LRUThreadPool<KeyType> _threadPool;
 };
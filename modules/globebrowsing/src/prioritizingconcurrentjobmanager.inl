@@ -23,6 +23,8 @@
  ****************************************************************************************/
 
 #include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <iterator>
 
 namespace openspace::globebrowsing {
 
@@ -38,11 +40,24 @@ void PrioritizingConcurrentJobManager<P, KeyType>::enqueueJob(std::shared_ptr<Jo
 {
     _threadPool.enqueue([this, job]() {
         job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
+        pushFinishedJob(job);
     }, key);
 }
 
+template <typename P, typename KeyType>
+void PrioritizingConcurrentJobManager<P, KeyType>::pushFinishedJob(
+                                                             std::shared_ptr<Job<P>> job)
+{
+    // Once jobs have overflowed, the following ones have to be added behind them to keep
+    // the order in which the jobs finished
+    if (_nOverflowJobs == 0 && _finishedJobs.tryPush(job)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflowJobs.push_back(std::move(job));
+    _nOverflowJobs = _overflowJobs.size();
+}
+
 template <typename P, typename KeyType>
 std::vector<KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::keysToUnfinishedJobs() {
@@ -67,16 +82,39 @@ void PrioritizingConcurrentJobManager<P, KeyType>::clearEnqueuedJobs() {
 
 template <typename P, typename KeyType>
 std::shared_ptr<Job<P>> PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
+    ghoul_assert(numFinishedJobs() > 0, "There is no finished job to pop!");
+
+    std::shared_ptr<Job<P>> result;
+    if (_finishedJobs.tryPop(result)) {
+        return result;
+    }
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    if (!_overflowJobs.empty()) {
+        result = std::move(_overflowJobs.front());
+        _overflowJobs.pop_front();
+        _nOverflowJobs = _overflowJobs.size();
+    }
+    return result;
+}
+
+template <typename P, typename KeyType>
+std::vector<std::shared_ptr<Job<P>>>
+PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJobs()
+{
+    std::vector<std::shared_ptr<Job<P>>> result;
+    result.reserve(numFinishedJobs());
+    _finishedJobs.tryPopBulk(std::back_inserter(result), _finishedJobs.capacity());
 
-    std::lock_guard lock(_finishedJobsMutex);
-    std::shared_ptr<Job<P>> result = _finishedJobs.pop();
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    std::move(_overflowJobs.begin(), _overflowJobs.end(), std::back_inserter(result));
+    _overflowJobs.clear();
+    _nOverflowJobs = 0;
     return result;
 }
 
 template <typename P, typename KeyType>
 size_t PrioritizingConcurrentJobManager<P, KeyType>::numFinishedJobs() const {
-    return _finishedJobs.size();
+    return _finishedJobs.size() + _nOverflowJobs;
 }
 
 } // namespace openspace::globebrowsing
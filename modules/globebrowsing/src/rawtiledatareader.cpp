@@ -25,7 +25,9 @@
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 
 #include <modules/globebrowsing/globebrowsingmodule.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tilemetadatakernel.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <ghoul/fmt.h>
@@ -121,30 +123,6 @@ enum class Side {
     Bottom
 };
 
-float interpretFloat(GLenum glType, const std::byte* src) {
-    switch (glType) {
-        case GL_UNSIGNED_BYTE:
-            return static_cast<float>(*reinterpret_cast<const GLubyte*>(src));
-        case GL_UNSIGNED_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLushort*>(src));
-        case GL_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLshort*>(src));
-        case GL_UNSIGNED_INT:
-            return static_cast<float>(*reinterpret_cast<const GLuint*>(src));
-        case GL_INT:
-            return static_cast<float>(*reinterpret_cast<const GLint*>(src));
-        case GL_HALF_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLhalf*>(src));
-        case GL_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLfloat*>(src));
-        case GL_DOUBLE:
-            return static_cast<float>(*reinterpret_cast<const GLdouble*>(src));
-        default:
-            ghoul_assert(false, "Unknown data type");
-            throw ghoul::MissingCaseException();
-    }
-}
-
 GDALDataType toGDALDataType(GLenum glType) {
     switch (glType) {
         case GL_UNSIGNED_BYTE:
@@ -425,6 +403,10 @@ RawTileDataReader::RawTileDataReader(std::string filePath,
     : _datasetFilePath(std::move(filePath))
     , _initData(std::move(initData))
     , _preprocess(preprocess)
+    , _diskTileCacheIdentifier(
+        cache::DiskTileCache::datasetIdentifier(_datasetFilePath, _initData, _preprocess)
+    )
+    , _tileMetaDataKernel(tileMetaDataKernel(_initData.glType, _initData.nRasters))
 {
     initialize();
 }
@@ -633,15 +615,36 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
 }
 
 RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
+    // The cache is owned by the module and destroyed when the module is deinitialized,
+    // so it is looked up for every read instead of keeping a pointer to it
+    cache::DiskTileCache* diskTileCache =
+        global::moduleEngine.module<GlobeBrowsingModule>()->diskTileCache();
+
+    const cache::DiskTileKey diskKey = { _diskTileCacheIdentifier, tileIndex };
+    if (diskTileCache) {
+        std::optional<RawTile> cachedTile = diskTileCache->get(diskKey, _initData);
+        if (cachedTile.has_value()) {
+            return std::move(*cachedTile);
+        }
+    }
+
     size_t numBytes = _initData.totalNumBytes;
 
     RawTile rawTile;
     rawTile.imageData = std::unique_ptr<std::byte[]>(new std::byte[numBytes]);
     memset(rawTile.imageData.get(), 0xFF, numBytes);
 
-    IODescription io = ioDescription(tileIndex);
+    IODescription io;
     RawTile::ReadError worstError = RawTile::ReadError::None;
-    readImageData(io, worstError, reinterpret_cast<char*>(rawTile.imageData.get()));
+    {
+        // GDAL datasets must not be used by multiple threads at the same time. Besides
+        // the TileIOScheduler, the height sampling of the globes reads from this reader.
+        // The regions are computed under the same lock, as reset() reinitializes the
+        // raster sizes and geo transform that they are based on
+        std::lock_guard lockGuard(_datasetLock);
+        io = ioDescription(tileIndex);
+        readImageData(io, worstError, reinterpret_cast<char*>(rawTile.imageData.get()));
+    }
 
     for (const MemoryLocation& ml : NoDataAvailableData) {
         std::byte* ptr = rawTile.imageData.get();
@@ -666,6 +669,12 @@ RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
         );
     }
 
+    // Failed reads are not persisted as they might succeed the next time, for example
+    // if a server was temporarily unavailable
+    if (diskTileCache && rawTile.error < RawTile::ReadError::Failure) {
+        diskTileCache->put(diskKey, rawTile);
+    }
+
     return rawTile;
 }
 
@@ -814,6 +823,10 @@ glm::ivec2 RawTileDataReader::fullPixelSize() const {
     return geodeticToPixel(Geodetic2{ 90.0, 180.0 }, _padfTransform);
 }
 
+uint64_t RawTileDataReader::datasetIdentifier() const {
+    return _diskTileCacheIdentifier;
+}
+
 RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
                                                          const IODescription& fullIO,
                                                          char* dataDestination,
@@ -932,56 +945,27 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
 TileMetaData RawTileDataReader::tileMetaData(RawTile& rawTile,
                                              const PixelRegion& region) const
 {
-    const size_t bytesPerLine = _initData.bytesPerPixel * region.numPixels.x;
+    const size_t nPixels = static_cast<size_t>(region.numPixels.x) *
+                           static_cast<size_t>(region.numPixels.y);
 
     TileMetaData preprocessData;
-    preprocessData.maxValues.resize(_initData.nRasters);
-    preprocessData.minValues.resize(_initData.nRasters);
-    preprocessData.hasMissingData.resize(_initData.nRasters);
-
-    std::vector<float> noDataValues(_initData.nRasters);
-    for (size_t raster = 0; raster < _initData.nRasters; ++raster) {
-        preprocessData.maxValues[raster] = -FLT_MAX;
-        preprocessData.minValues[raster] = FLT_MAX;
-        preprocessData.hasMissingData[raster] = false;
-        noDataValues[raster] = noDataValueAsFloat();
-    }
-
-    bool allIsMissing = true;
-    for (int y = 0; y < region.numPixels.y; ++y) {
-        const size_t yi = (region.numPixels.y - 1 - y) * bytesPerLine;
-        size_t i = 0;
-        for (int x = 0; x < region.numPixels.x; ++x) {
-            for (size_t raster = 0; raster < _initData.nRasters; ++raster) {
-                const float noDataValue = noDataValueAsFloat();
-                const float val = interpretFloat(
-                    _initData.glType,
-                    &(rawTile.imageData.get()[yi + i])
-                );
-                if (val != noDataValue && val == val) {
-                    preprocessData.maxValues[raster] = std::max(
-                        val,
-                        preprocessData.maxValues[raster]
-                    );
-                    preprocessData.minValues[raster] = std::min(
-                        val,
-                        preprocessData.minValues[raster]
-                    );
-                    allIsMissing = false;
-                }
-                else {
-                    preprocessData.hasMissingData[raster] = true;
-                    float& floatToRewrite = reinterpret_cast<float&>(
-                        rawTile.imageData[yi + i]
-                    );
-                    floatToRewrite = -std::numeric_limits<float>::max();
-                }
-                i += _initData.bytesPerDatum;
-            }
-        }
-    }
+    const bool anyValid = _tileMetaDataKernel ?
+        _tileMetaDataKernel(
+            rawTile.imageData.get(),
+            nPixels,
+            noDataValueAsFloat(),
+            preprocessData
+        ) :
+        tileMetaDataScalar(
+            _initData.glType,
+            _initData.nRasters,
+            rawTile.imageData.get(),
+            nPixels,
+            noDataValueAsFloat(),
+            preprocessData
+        );
 
-    if (allIsMissing) {
+    if (!anyValid) {
         rawTile.error = RawTile::ReadError::Failure;
     }
 
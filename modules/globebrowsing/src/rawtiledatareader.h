@@ -27,6 +27,7 @@
 
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tilemetadatakernel.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <ghoul/misc/boolean.h>
 #include <string>
@@ -39,6 +40,7 @@ class GDALRasterBand;
 namespace openspace::globebrowsing {
 
 class GeodeticPatch;
+namespace cache { class DiskTileCache; }
 
 class RawTileDataReader {
 public:
@@ -60,10 +62,21 @@ public:
     int maxChunkLevel() const;
     float noDataValueAsFloat() const;
 
+    /**
+     * Reads the tile \p tileIndex from the persistent tile cache or from the dataset.
+     * This function can be called from multiple threads at once, the reads from the
+     * dataset are serialized.
+     */
     RawTile readTileData(TileIndex tileIndex) const;
     const TileDepthTransform& depthTransform() const;
     glm::ivec2 fullPixelSize() const;
 
+    /**
+     * Returns the identifier of the dataset and settings of this reader, which is stable
+     * between runs. See cache::DiskTileCache::datasetIdentifier for details.
+     */
+    uint64_t datasetIdentifier() const;
+
 private:
     void initialize();
 
@@ -100,6 +113,14 @@ private:
     const PerformPreprocessing _preprocess;
     TileDepthTransform _depthTransform = { 0.f, 0.f };
 
+    /// Identifies the tiles of this reader in the persistent cache that is owned by the
+    /// GlobeBrowsingModule and consulted before reading from the dataset
+    const uint64_t _diskTileCacheIdentifier;
+
+    /// The kernel that computes the TileMetaData for the data type of this reader, or
+    /// \c nullptr if the data type requires the scalar implementation
+    const TileMetaDataKernel _tileMetaDataKernel;
+
     mutable std::mutex _datasetLock;
 };
 
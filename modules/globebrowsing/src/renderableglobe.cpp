@@ -24,14 +24,19 @@
 
 #include <modules/globebrowsing/src/renderableglobe.h>
 
+#include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/gpulayergroup.h>
+#include <modules/globebrowsing/src/heighttilecache.h>
 #include <modules/globebrowsing/src/layer.h>
 #include <modules/globebrowsing/src/layergroup.h>
+#include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <modules/globebrowsing/src/renderableglobe.h>
+#include <modules/globebrowsing/src/tileioscheduler.h>
 #include <modules/globebrowsing/src/tileprovider.h>
 #include <modules/debugging/rendering/debugrenderer.h>
 #include <openspace/engine/globals.h>
+#include <openspace/engine/moduleengine.h>
 #include <openspace/performance/performancemanager.h>
 #include <openspace/performance/performancemeasurement.h>
 #include <openspace/rendering/renderengine.h>
@@ -213,14 +218,12 @@ namespace openspace::globebrowsing {
 
 namespace {
 
-bool isLeaf(const Chunk& cn) {
-    return cn.children[0] == nullptr;
-}
-
-const Chunk& findChunkNode(const Chunk& node, const Geodetic2& location) {
+const Chunk& findChunkNode(const ChunkTree& tree, const Chunk& node,
+                           const Geodetic2& location)
+{
     const Chunk* n = &node;
 
-    while (!isLeaf(*n)) {
+    while (!n->isLeaf()) {
         const Geodetic2 center = n->surfacePatch.center();
         int index = 0;
         if (center.lon < location.lon) {
@@ -230,7 +233,7 @@ const Chunk& findChunkNode(const Chunk& node, const Geodetic2& location) {
             ++index;
             ++index;
         }
-        n = n->children[static_cast<Quad>(index)];
+        n = &tree.child(*n, static_cast<Quad>(index));
     }
     return *n;
 }
@@ -411,12 +414,6 @@ bool intersects(const AABB3& bb, const AABB3& o) {
 
 } // namespace
 
-Chunk::Chunk(const TileIndex& ti)
-    : tileIndex(ti)
-    , surfacePatch(ti)
-    , status(Status::DoNothing)
-{}
-
 RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     : Renderable(dictionary)
     , _debugProperties({
@@ -443,11 +440,17 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     })
     , _debugPropertyOwner({ "Debug" })
     , _grid(DefaultSkirtedGridSegments, DefaultSkirtedGridSegments)
-    , _leftRoot(Chunk(LeftHemisphereIndex))
-    , _rightRoot(Chunk(RightHemisphereIndex))
+    , _chunkTree(
+        { LeftHemisphereIndex, RightHemisphereIndex },
+        global::moduleEngine.module<GlobeBrowsingModule>()->chunkUpdateThreadPool()
+    )
 {
     _generalProperties.currentLodScaleFactor.setReadOnly(true);
 
+    GlobeBrowsingModule* module = global::moduleEngine.module<GlobeBrowsingModule>();
+    _tileIOScheduler = module->tileIOScheduler();
+    _heightTileCache = module->heightTileCache();
+
     // Read the radii in to its own dictionary
     if (dictionary.hasKeyAndValue<glm::dvec3>(KeyRadii)) {
         _ellipsoid = Ellipsoid(dictionary.value<glm::vec3>(KeyRadii));
@@ -746,6 +749,7 @@ void RenderableGlobe::update(const UpdateData& data) {
         _debugProperties.resetTileProviders = false;
     }
     _layerManager.update();
+    updateHeightSamplingLayers();
 
     if (_nLayersIsDirty) {
         std::array<LayerGroup*, LayerManager::NumLayerGroups> lgs =
@@ -856,8 +860,7 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&) {
     }
 
     _allChunksAvailable = true;
-    updateChunkTree(_leftRoot, data);
-    updateChunkTree(_rightRoot, data);
+    updateChunkTree(data);
     _chunkCornersDirty = false;
     _iterationsOfAvailableData =
         (_allChunksAvailable ? _iterationsOfAvailableData + 1 : 0);
@@ -978,76 +981,41 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&) {
         );
     }
 
-    constexpr const int ChunkBufferSize = 2048;
-    std::array<const Chunk*, ChunkBufferSize> global;
-    int globalCount = 0;
-    std::array<const Chunk*, ChunkBufferSize> local;
-    int localCount = 0;
-
-    auto traversal = [&global, &globalCount, &local, &localCount,
-          cutoff = _debugProperties.modelSpaceRenderingCutoffLevel](const Chunk& node)
-    {
-        std::vector<const Chunk*> Q;
-        Q.reserve(256);
-
-        // Loop through nodes in breadths first order
-        Q.push_back(&node);
-        while (!Q.empty()) {
-            const Chunk* n = Q.front();
-            Q.erase(Q.begin());
-
-            if (isLeaf(*n) && n->isVisible) {
-                if (n->tileIndex.level < cutoff) {
-                    global[globalCount] = n;
-                    ++globalCount;
-                }
-                else {
-                    local[localCount] = n;
-                    ++localCount;
-                }
-            }
-
-            // Add children to queue, if any
-            if (!isLeaf(*n)) {
-                for (int i = 0; i < 4; ++i) {
-                    Q.push_back(n->children[i]);
-                }
-            }
-        }
-    };
-
-    traversal(_leftRoot);
-    traversal(_rightRoot);
+    _chunkTree.collectVisibleLeaves(
+        _debugProperties.modelSpaceRenderingCutoffLevel,
+        _globalChunks,
+        _localChunks
+    );
 
     // Render all chunks that want to be rendered globally
     _globalRenderer.program->activate();
-    for (int i = 0; i < std::min(globalCount, ChunkBufferSize); ++i) {
-        renderChunkGlobally(*global[i], data);
+    for (const Chunk* chunk : _globalChunks) {
+        renderChunkGlobally(*chunk, data);
     }
     _globalRenderer.program->deactivate();
 
 
     // Render all chunks that need to be rendered locally
     _localRenderer.program->activate();
-    for (int i = 0; i < std::min(localCount, ChunkBufferSize); ++i) {
-        renderChunkLocally(*local[i], data);
+    for (const Chunk* chunk : _localChunks) {
+        renderChunkLocally(*chunk, data);
     }
     _localRenderer.program->deactivate();
 
 
     if (_debugProperties.showChunkBounds || _debugProperties.showChunkAABB) {
-        for (int i = 0; i < std::min(globalCount, ChunkBufferSize); ++i) {
+        for (const Chunk* chunk : _globalChunks) {
             debugRenderChunk(
-                *global[i],
+                *chunk,
                 mvp,
                 _debugProperties.showChunkBounds,
                 _debugProperties.showChunkAABB
             );
         }
 
-        for (int i = 0; i < std::min(localCount, ChunkBufferSize); ++i) {
+        for (const Chunk* chunk : _localChunks) {
             debugRenderChunk(
-                *local[i],
+                *chunk,
                 mvp,
                 _debugProperties.showChunkBounds,
                 _debugProperties.showChunkAABB
@@ -1594,20 +1562,20 @@ SurfacePositionHandle RenderableGlobe::calculateSurfacePositionHandle(
 }
 
 bool RenderableGlobe::testIfCullable(const Chunk& chunk,
-                                     const RenderData& renderData,
                                      const BoundingHeights& heights) const
 {
-    return (PreformHorizonCulling && isCullableByHorizon(chunk, renderData, heights)) ||
-           (PerformFrustumCulling && isCullableByFrustum(chunk, renderData));
+    return (PreformHorizonCulling && isCullableByHorizon(chunk, heights)) ||
+           (PerformFrustumCulling && isCullableByFrustum(chunk));
 }
 
-int RenderableGlobe::desiredLevel(const Chunk& chunk, const RenderData& renderData,
+int RenderableGlobe::desiredLevel(const Chunk& chunk,
                                   const BoundingHeights& heights) const
 {
-    const int desiredLevel = _debugProperties.levelByProjectedAreaElseDistance ?
-        desiredLevelByProjectedArea(chunk, renderData, heights) :
-        desiredLevelByDistance(chunk, renderData, heights);
-    const int levelByAvailableData = desiredLevelByAvailableTileData(chunk);
+    const int desiredLevel = _chunkUpdateState.levelByProjectedArea ?
+        desiredLevelByProjectedArea(chunk, heights) :
+        desiredLevelByDistance(chunk, heights);
+    // Querying the tile status is not thread-safe, so it is done in prepareChunk
+    const int levelByAvailableData = chunk.levelByAvailableData;
 
     if (LimitLevelByAvailableData && (levelByAvailableData != UnknownDesiredLevel)) {
         const int l = glm::min(desiredLevel, levelByAvailableData);
@@ -1619,152 +1587,118 @@ int RenderableGlobe::desiredLevel(const Chunk& chunk, const RenderData& renderDa
 }
 
 float RenderableGlobe::getHeight(const glm::dvec3& position) const {
-    float height = 0;
-
-    // Get the uv coordinates to sample from
+    // Sample at the level of the chunk that is rendered at the position
     const Geodetic2 geodeticPosition = _ellipsoid.cartesianToGeodetic2(position);
     const Chunk& node = geodeticPosition.lon < Coverage.center().lon ?
-        findChunkNode(_leftRoot, geodeticPosition) :
-        findChunkNode(_rightRoot, geodeticPosition);
-    const int chunkLevel = node.tileIndex.level;
-
-
-    //TileIndex::TileIndex(const Geodetic2& point, int level_)
-    //    : level(level_)
-    //{
-    const int numIndicesAtLevel = 1 << chunkLevel;
-    const double u = 0.5 + geodeticPosition.lon / glm::two_pi<double>();
-    const double v = 0.25 - geodeticPosition.lat / glm::two_pi<double>();
-    const double xIndexSpace = u * numIndicesAtLevel;
-    const double yIndexSpace = v * numIndicesAtLevel;
+        findChunkNode(_chunkTree, _chunkTree.root(0), geodeticPosition) :
+        findChunkNode(_chunkTree, _chunkTree.root(1), geodeticPosition);
 
-    const int x = static_cast<int>(floor(xIndexSpace));
-    const int y = static_cast<int>(floor(yIndexSpace));
-
-    const TileIndex tileIndex(x, y, chunkLevel);
-    const GeodeticPatch patch = GeodeticPatch(tileIndex);
-
-    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
-    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
-
-    const Geodetic2 geoDiffPatch = {
-        northEast.lat - southWest.lat,
-        northEast.lon - southWest.lon
-    };
+    std::shared_ptr<const HeightSamplingLayers> layers;
+    {
+        std::lock_guard lock(_heightSamplingLayersMutex);
+        layers = _heightSamplingLayers;
+    }
+    if (!layers) {
+        return 0.f;
+    }
 
-    const Geodetic2 geoDiffPoint = {
-        geodeticPosition.lat - southWest.lat,
-        geodeticPosition.lon - southWest.lon
-    };
-    const glm::vec2 patchUV = glm::vec2(
-        geoDiffPoint.lon / geoDiffPatch.lon,
-        geoDiffPoint.lat / geoDiffPatch.lat
+    return _heightTileCache->sampleHeight(
+        *layers,
+        geodeticPosition,
+        node.tileIndex.level,
+        cache::HeightTileCache::ReadMissingTiles::No
     );
+}
 
-    // Get the tile providers for the height maps
-    const std::vector<Layer*>& heightMapLayers =
-        _layerManager.layerGroup(layergroupid::GroupID::HeightLayers).activeLayers();
-
-    for (Layer* layer : heightMapLayers) {
+void RenderableGlobe::updateHeightSamplingLayers() {
+    // The readers of temporal and per-level tile providers change without a notification
+    // by the layer manager, so the readers and settings of the active height layers are
+    // compared with the ones that the current snapshot was built from. The snapshot keeps
+    // its readers alive, so a new reader can't reuse the address of a captured one
+    const LayerGroup& heightLayers = _layerManager.layerGroup(layergroupid::HeightLayers);
+    bool isUnchanged = true;
+    size_t iReader = 0;
+    size_t iLayer = 0;
+    for (Layer* layer : heightLayers.activeLayers()) {
         tileprovider::TileProvider* tileProvider = layer->tileProvider();
         if (!tileProvider) {
             continue;
         }
-        // Transform the uv coordinates to the current tile texture
-        const ChunkTile chunkTile = tileprovider::chunkTile(*tileProvider, tileIndex);
-        const Tile& tile = chunkTile.tile;
-        const TileUvTransform& uvTransform = chunkTile.uvTransform;
-        const TileDepthTransform& depthTransform =
-            tileprovider::depthTransform(*tileProvider);
-        if (tile.status != Tile::Status::OK) {
-            return 0;
-        }
-
-        ghoul::opengl::Texture* tileTexture = tile.texture;
-        if (!tileTexture) {
-            return 0;
-        }
-
-        glm::vec2 transformedUv = layer->tileUvToTextureSamplePosition(
-            uvTransform,
-            patchUV,
-            glm::uvec2(tileTexture->dimensions())
-        );
-
-        // Sample and do linear interpolation
-        // (could possibly be moved as a function in ghoul texture)
-        // Suggestion: a function in ghoul::opengl::Texture that takes uv coordinates
-        // in range [0,1] and uses the set interpolation method and clamping.
 
-        const glm::uvec3 dimensions = tileTexture->dimensions();
-
-        const glm::vec2 samplePos = transformedUv * glm::vec2(dimensions);
-        glm::uvec2 samplePos00 = samplePos;
-        samplePos00 = glm::clamp(
-            samplePos00,
-            glm::uvec2(0, 0),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::vec2 samplePosFract = samplePos - glm::vec2(samplePos00);
-
-        const glm::uvec2 samplePos10 = glm::min(
-            samplePos00 + glm::uvec2(1, 0),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::uvec2 samplePos01 = glm::min(
-            samplePos00 + glm::uvec2(0, 1),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::uvec2 samplePos11 = glm::min(
-            samplePos00 + glm::uvec2(1, 1),
-            glm::uvec2(dimensions) - glm::uvec2(1)
+        const LayerRenderSettings& settings = layer->renderSettings();
+        const glm::vec4 s = glm::vec4(
+            settings.gamma.value(),
+            settings.multiplier.value(),
+            settings.offset.value(),
+            settings.opacity.value()
         );
+        isUnchanged = iLayer < _heightSamplingState.settings.size() &&
+                      s == _heightSamplingState.settings[iLayer];
+        ++iLayer;
+
+        for (int level = 0; isUnchanged && level <= MaxSplitDepth; ++level) {
+            const RawTileDataReader* reader =
+                tileprovider::rawTileDataReader(*tileProvider, level).get();
+            isUnchanged = iReader < _heightSamplingState.readers.size() &&
+                          reader == _heightSamplingState.readers[iReader];
+            ++iReader;
+        }
+        if (!isUnchanged) {
+            break;
+        }
+    }
+    if (isUnchanged && iLayer == _heightSamplingState.settings.size()) {
+        return;
+    }
 
-        const float sample00 = tileTexture->texelAsFloat(samplePos00).x;
-        const float sample10 = tileTexture->texelAsFloat(samplePos10).x;
-        const float sample01 = tileTexture->texelAsFloat(samplePos01).x;
-        const float sample11 = tileTexture->texelAsFloat(samplePos11).x;
-
-        // In case the texture has NaN or no data values don't use this height map.
-        const bool anySampleIsNaN =
-            std::isnan(sample00) ||
-            std::isnan(sample01) ||
-            std::isnan(sample10) ||
-            std::isnan(sample11);
-
-        const bool anySampleIsNoData =
-            sample00 == tileprovider::noDataValueAsFloat(*tileProvider) ||
-            sample01 == tileprovider::noDataValueAsFloat(*tileProvider) ||
-            sample10 == tileprovider::noDataValueAsFloat(*tileProvider) ||
-            sample11 == tileprovider::noDataValueAsFloat(*tileProvider);
-
-        if (anySampleIsNaN || anySampleIsNoData) {
+    auto layers = std::make_shared<HeightSamplingLayers>();
+    _heightSamplingState.readers.clear();
+    _heightSamplingState.settings.clear();
+    for (Layer* layer : heightLayers.activeLayers()) {
+        tileprovider::TileProvider* tileProvider = layer->tileProvider();
+        if (!tileProvider) {
             continue;
         }
 
-        const float sample0 = sample00 * (1.f - samplePosFract.x) +
-            sample10 * samplePosFract.x;
-        const float sample1 = sample01 * (1.f - samplePosFract.x) +
-            sample11 * samplePosFract.x;
-
-        const float sample = sample0 * (1.f - samplePosFract.y) +
-            sample1 * samplePosFract.y;
-
-        // Same as is used in the shader. This is not a perfect solution but
-        // if the sample is actually a no-data-value (min_float) the interpolated
-        // value might not be. Therefore we have a cut-off. Assuming no data value
-        // is smaller than -100000
-        if (sample > -100000) {
-            // Perform depth transform to get the value in meters
-            height = depthTransform.offset + depthTransform.scale * sample;
-            // Make sure that the height value follows the layer settings.
-            // For example if the multiplier is set to a value bigger than one,
-            // the sampled height should be modified as well.
-            height = layer->renderSettings().performLayerSettings(height);
+        // Tile providers that don't read from a dataset, such as SingleImage,
+        // SizeReference, and TileIndex providers, have no reader on any level, so their
+        // layers don't contribute to the sampled heights
+        cache::HeightSamplingLayer l;
+        std::shared_ptr<const RawTileDataReader> previousReader;
+        for (int level = 0; level <= MaxSplitDepth; ++level) {
+            std::shared_ptr<const RawTileDataReader> reader =
+                tileprovider::rawTileDataReader(*tileProvider, level);
+            _heightSamplingState.readers.push_back(reader.get());
+            if (!reader) {
+                l.sources.push_back(nullptr);
+            }
+            else if (reader == previousReader) {
+                // Most layers read all levels from the same dataset
+                l.sources.push_back(l.sources.back());
+            }
+            else {
+                l.sources.push_back(
+                    std::make_shared<cache::RawTileHeightSource>(reader)
+                );
+            }
+            previousReader = std::move(reader);
         }
+        const LayerRenderSettings& settings = layer->renderSettings();
+        l.gamma = settings.gamma.value();
+        l.multiplier = settings.multiplier.value();
+        l.offset = settings.offset.value();
+        l.opacity = settings.opacity.value();
+        _heightSamplingState.settings.emplace_back(
+            l.gamma,
+            l.multiplier,
+            l.offset,
+            l.opacity
+        );
+        layers->push_back(std::move(l));
     }
-    // Return the result
-    return height;
+
+    std::lock_guard lock(_heightSamplingLayersMutex);
+    _heightSamplingLayers = std::move(layers);
 }
 
 void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& programObject,
@@ -1907,14 +1841,10 @@ void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& prog
 //////////////////////////////////////////////////////////////////////////////////////////
 
 int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
-                                            const RenderData& data,
                                             const BoundingHeights& heights) const
 {
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(_cachedInverseModelTransform *
-        glm::dvec4(data.camera.positionVec3(), 1.0));
+    // Calculations are done in the reference frame of the globe (model space)
+    const glm::dvec3& cameraPosition = _chunkUpdateState.cameraPosition;
 
     const Geodetic2 pointOnPatch = chunk.surfacePatch.closestPoint(
         _ellipsoid.cartesianToGeodetic2(cameraPosition)
@@ -1933,7 +1863,7 @@ int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
     const double distanceToPatch = glm::length(cameraToChunk);
     const double distance = distanceToPatch;
 
-    const double scaleFactor = _generalProperties.currentLodScaleFactor *
+    const double scaleFactor = _chunkUpdateState.lodScaleFactor *
         _ellipsoid.minimumRadius();
     const double projectedScaleFactor = scaleFactor / distance;
     const int desiredLevel = static_cast<int>(ceil(log2(projectedScaleFactor)));
@@ -1941,15 +1871,10 @@ int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
 }
 
 int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
-                                                 const RenderData& data,
                                                  const BoundingHeights& heights) const
 {
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
-    );
+    // Calculations are done in the reference frame of the globe (model space)
+    const glm::dvec3& cameraPosition = _chunkUpdateState.cameraPosition;
 
     // Approach:
     // The projected area of the chunk will be calculated based on a small area that
@@ -2018,7 +1943,7 @@ int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
     const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
     const double projectedChunkAreaApprox = 8 * areaABC;
 
-    const double scaledArea = _generalProperties.currentLodScaleFactor *
+    const double scaledArea = _chunkUpdateState.lodScaleFactor *
                               projectedChunkAreaApprox;
     return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
 }
@@ -2044,14 +1969,9 @@ int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
 //  Culling
 //////////////////////////////////////////////////////////////////////////////////////////
 
-bool RenderableGlobe::isCullableByFrustum(const Chunk& chunk,
-                                          const RenderData& renderData) const
-{
-    // Calculate the MVP matrix
-    const glm::dmat4 viewTransform = glm::dmat4(renderData.camera.combinedViewMatrix());
-    const glm::dmat4 modelViewProjectionTransform = glm::dmat4(
-        renderData.camera.sgctInternal.projectionMatrix()
-    ) * viewTransform * _cachedModelTransform;
+bool RenderableGlobe::isCullableByFrustum(const Chunk& chunk) const {
+    const glm::dmat4& modelViewProjectionTransform =
+        _chunkUpdateState.modelViewProjection;
 
     const std::array<glm::dvec4, 8>& corners = chunk.corners;
 
@@ -2069,19 +1989,15 @@ bool RenderableGlobe::isCullableByFrustum(const Chunk& chunk,
 }
 
 bool RenderableGlobe::isCullableByHorizon(const Chunk& chunk,
-                                          const RenderData& renderData,
                                           const BoundingHeights& heights) const
 {
-    // Calculations are done in the reference frame of the globe. Hence, the camera
-    // position needs to be transformed with the inverse model matrix
+    // Calculations are done in the reference frame of the globe (model space)
     const GeodeticPatch& patch = chunk.surfacePatch;
     const float maxHeight = heights.max;
     const glm::dvec3 globePos = glm::dvec3(0, 0, 0); // In model space it is 0
     const double minimumGlobeRadius = _ellipsoid.minimumRadius();
 
-    const glm::dvec3 cameraPos = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(renderData.camera.positionVec3(), 1)
-    );
+    const glm::dvec3& cameraPos = _chunkUpdateState.cameraPosition;
 
     const glm::dvec3 globeToCamera = cameraPos;
 
@@ -2140,123 +2056,73 @@ bool RenderableGlobe::isCullableByHorizon(const Chunk& chunk,
 //  Chunk node handling
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void RenderableGlobe::splitChunkNode(Chunk& cn, int depth) {
-    if (depth > 0 && isLeaf(cn)) {
-        std::vector<void*> memory = _chunkPool.allocate(
-            static_cast<int>(cn.children.size())
+void RenderableGlobe::updateChunkTree(const RenderData& data) {
+    const glm::dmat4 modelViewProjection =
+        glm::dmat4(data.camera.sgctInternal.projectionMatrix()) *
+        data.camera.combinedViewMatrix() * _cachedModelTransform;
+    const glm::dvec3 cameraPosition = glm::dvec3(
+        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
+    );
+    const double time = data.time.j2000Seconds();
+    const float lodScaleFactor = _generalProperties.currentLodScaleFactor;
+    const bool levelByProjectedArea = _debugProperties.levelByProjectedAreaElseDistance;
+
+    // The height layer settings change the bounding heights of the chunks without
+    // causing a notification by the layer manager
+    std::vector<glm::vec2> heightLayerSettings;
+    const LayerGroup& heightLayers = _layerManager.layerGroup(layergroupid::HeightLayers);
+    for (Layer* layer : heightLayers.activeLayers()) {
+        const LayerRenderSettings& settings = layer->renderSettings();
+        heightLayerSettings.emplace_back(
+            settings.multiplier.value(),
+            settings.offset.value()
         );
-        for (size_t i = 0; i < cn.children.size(); ++i) {
-            cn.children[i] = new (memory[i]) Chunk(
-                cn.tileIndex.child(static_cast<Quad>(i))
-            );
-            const BoundingHeights& heights = boundingHeightsForChunk(
-                *(cn.children[i]),
-                _layerManager
-            );
-            cn.children[i]->corners = boundingCornersForChunk(
-                *cn.children[i],
-                _ellipsoid,
-                heights
-            );
-        }
     }
 
-    if (depth > 1) {
-        for (Chunk* child : cn.children) {
-            splitChunkNode(*child, depth - 1);
-        }
-    }
-}
+    const bool isUnchanged = !_chunkCornersDirty &&
+        modelViewProjection == _chunkUpdateState.modelViewProjection &&
+        cameraPosition == _chunkUpdateState.cameraPosition &&
+        time == _chunkUpdateState.time &&
+        lodScaleFactor == _chunkUpdateState.lodScaleFactor &&
+        levelByProjectedArea == _chunkUpdateState.levelByProjectedArea &&
+        heightLayerSettings == _chunkUpdateState.heightLayerSettings;
 
-void RenderableGlobe::freeChunkNode(Chunk* n) {
-    _chunkPool.free(n);
-    for (Chunk* c : n->children) {
-        if (c) {
-            freeChunkNode(c);
-        }
-    }
-    n->children.fill(nullptr);
-}
+    _chunkUpdateState.modelViewProjection = modelViewProjection;
+    _chunkUpdateState.cameraPosition = cameraPosition;
+    _chunkUpdateState.time = time;
+    _chunkUpdateState.lodScaleFactor = lodScaleFactor;
+    _chunkUpdateState.levelByProjectedArea = levelByProjectedArea;
+    _chunkUpdateState.heightLayerSettings = std::move(heightLayerSettings);
 
-void RenderableGlobe::mergeChunkNode(Chunk& cn) {
-    for (Chunk* child : cn.children) {
-        if (child) {
-            mergeChunkNode(*child);
-            freeChunkNode(child);
-        }
-    }
-    cn.children.fill(nullptr);
+    _chunkTree.update(*this, ChunkTree::SkipSettled(isUnchanged));
 }
 
-bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data) {
-    // abock:  I tried turning this into a queue and use iteration, rather than recursion
-    //         but that made the code harder to understand as the breadth-first traversal
-    //         requires parents to be passed through the pipe twice (first to add the
-    //         children and then again it self to be processed after the children finish).
-    //         In addition, this didn't even improve performance ---  2018-10-04
-    if (isLeaf(cn)) {
-        updateChunk(cn, data);
-
-        if (cn.status == Chunk::Status::WantSplit) {
-            splitChunkNode(cn, 1);
-        }
-        else if (cn.status == Chunk::Status::DoNothing && (!cn.colorTileOK)) {
-            // Checking cn.heightTileOK caused always not avaiable for certain HiRISE data
-            _allChunksAvailable = false;
-        }
-
-        return cn.status == Chunk::Status::WantMerge;
-    }
-    else {
-        char requestedMergeMask = 0;
-        for (int i = 0; i < 4; ++i) {
-            if (updateChunkTree(*cn.children[i], data)) {
-                requestedMergeMask |= (1 << i);
-            }
-        }
-
-        const bool allChildrenWantsMerge = requestedMergeMask == 0xf;
-        updateChunk(cn, data);
-
-        if (allChildrenWantsMerge && (cn.status != Chunk::Status::WantSplit)) {
-            mergeChunkNode(cn);
-        }
-        else if (cn.status == Chunk::Status::WantSplit) {
-            splitChunkNode(cn, 1);
-        }
-        else if (cn.status == Chunk::Status::DoNothing && (!cn.colorTileOK)) {
-            _allChunksAvailable = false;
-        }
-
-        return false;
-    }
+void RenderableGlobe::initializeChunk(Chunk& chunk) {
+    const BoundingHeights& heights = boundingHeightsForChunk(chunk, _layerManager);
+    chunk.corners = boundingCornersForChunk(chunk, _ellipsoid, heights);
 }
 
-void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data) const {
-    const BoundingHeights& heights = boundingHeightsForChunk(chunk, _layerManager);
-    chunk.heightTileOK = heights.tileOK;
+void RenderableGlobe::prepareChunk(Chunk& chunk) {
+    chunk.heights = boundingHeightsForChunk(chunk, _layerManager);
+    chunk.heightTileOK = chunk.heights.tileOK;
     chunk.colorTileOK = colorAvailableForChunk(chunk, _layerManager);
+    chunk.levelByAvailableData = desiredLevelByAvailableTileData(chunk);
 
     if (_chunkCornersDirty) {
-        chunk.corners = boundingCornersForChunk(chunk, _ellipsoid, heights);
+        chunk.corners = boundingCornersForChunk(chunk, _ellipsoid, chunk.heights);
 
         // The flag gets set to false globally after the updateChunkTree calls
     }
+}
 
-    if (testIfCullable(chunk, data, heights)) {
-        chunk.isVisible = false;
-        chunk.status = Chunk::Status::WantMerge;
-    }
-    else {
-        chunk.isVisible = true;
-    }
-
-    const int dl = desiredLevel(chunk, data, heights);
+void RenderableGlobe::evaluateChunk(Chunk& chunk) const {
+    chunk.isVisible = !testIfCullable(chunk, chunk.heights);
+    chunk.desiredLevel = desiredLevel(chunk, chunk.heights);
 
-    if (dl < chunk.tileIndex.level) {
+    if (chunk.desiredLevel < chunk.tileIndex.level) {
         chunk.status = Chunk::Status::WantMerge;
     }
-    else if (chunk.tileIndex.level < dl) {
+    else if (chunk.tileIndex.level < chunk.desiredLevel) {
         chunk.status = Chunk::Status::WantSplit;
     }
     else {
@@ -2264,4 +2130,34 @@ void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data) const {
     }
 }
 
+bool RenderableGlobe::commitChunk(const Chunk& chunk) {
+    if (chunk.isVisible) {
+        // The further a chunk is from its desired level, the larger its screen-space
+        // error and the more important it is to load its tiles first
+        const int error = std::max(chunk.desiredLevel - chunk.tileIndex.level, 0);
+        _tileIOScheduler->setPriority(chunk.tileIndex, 1.f + static_cast<float>(error));
+    }
+
+    if (chunk.status == Chunk::Status::DoNothing && !chunk.colorTileOK) {
+        // Checking chunk.heightTileOK caused always not avaiable for certain HiRISE data
+        _allChunksAvailable = false;
+    }
+
+    return chunk.colorTileOK && chunk.heightTileOK &&
+        chunk.levelByAvailableData == UnknownDesiredLevel;
+}
+
+void RenderableGlobe::removeChunk(const Chunk& chunk) {
+    // The tiles of the merged chunks are no longer needed, so there is no point in
+    // reading them if they are still waiting in the queue. Only the layers of this
+    // globe are cancelled, as other globes might still need the same tile index
+    for (LayerGroup* layerGroup : _layerManager.layerGroups()) {
+        for (Layer* layer : layerGroup->activeLayers()) {
+            if (layer->tileProvider()) {
+                tileprovider::cancel(*layer->tileProvider(), chunk.tileIndex);
+            }
+        }
+    }
+}
+
 } // namespace openspace::globebrowsing
@@ -27,6 +27,7 @@
 
 #include <openspace/rendering/renderable.h>
 
+#include <modules/globebrowsing/src/chunktree.h>
 #include <modules/globebrowsing/src/ellipsoid.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
@@ -37,48 +38,27 @@
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
-#include <ghoul/misc/memorypool.h>
+#include <ghoul/misc/boolean.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <cstddef>
+#include <memory>
+#include <mutex>
 
 namespace openspace::globebrowsing {
 
 class GPULayerGroup;
+class RawTileDataReader;
 class RenderableGlobe;
+class TileIOScheduler;
 struct TileIndex;
 
-struct BoundingHeights {
-    float min;
-    float max;
-    bool available;
-    bool tileOK;
-};
-
+namespace cache {
+    class HeightTileCache;
+    struct HeightSamplingLayer;
+} // namespace cache
 namespace chunklevelevaluator { class Evaluator; }
 namespace culling { class ChunkCuller; }
 
-struct Chunk {
-    enum class Status : uint8_t {
-        DoNothing,
-        WantMerge,
-        WantSplit
-    };
-
-    Chunk(const TileIndex& tileIndex);
-
-    const TileIndex tileIndex;
-    const GeodeticPatch surfacePatch;
-
-    Status status;
-
-    bool isVisible = true;
-    bool colorTileOK = false;
-    bool heightTileOK = false;
-
-    std::array<glm::dvec4, 8> corners;
-    std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
-};
-
 enum class ShadowCompType {
     GLOBAL_SHADOW,
     LOCAL_SHADOW
@@ -88,7 +68,7 @@ enum class ShadowCompType {
  * A RenderableGlobe is a globe modeled as an ellipsoid using a chunked LOD algorithm for
  * rendering.
  */
-class RenderableGlobe : public Renderable {
+class RenderableGlobe : public Renderable, private ChunkTree::Evaluator {
 public:
     RenderableGlobe(const ghoul::Dictionary& dictionary);
     ~RenderableGlobe() = default;
@@ -148,8 +128,7 @@ private:
      * Goes through all available <code>ChunkCuller</code>s and check if any of them
      * allows culling of the <code>Chunk</code>s in question.
      */
-    bool testIfCullable(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
+    bool testIfCullable(const Chunk& chunk, const BoundingHeights& heights) const;
 
     /**
      * Gets the desired level which can be used to determine if a chunk should split
@@ -161,12 +140,15 @@ private:
      * <code>Chunk</code>, it wants to split. If it is lower, it wants to merge with
      * its siblings.
      */
-    int desiredLevel(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
+    int desiredLevel(const Chunk& chunk, const BoundingHeights& heights) const;
 
     /**
      * Calculates the height from the surface of the reference ellipsoid to the
-     * height mapped surface.
+     * height mapped surface at the level of the chunk that is rendered at the position.
+     * Tiles that are not in the height tile cache are requested in the background and
+     * the height is sampled from the next coarser cached tile in the meantime. Only height
+     * layers that read their tiles from a dataset contribute to the height; layers with a
+     * SingleImage, SizeReference, or TileIndex tile provider are ignored.
      *
      * The height can be negative if the height map contains negative values.
      *
@@ -205,13 +187,11 @@ private:
     void debugRenderChunk(const Chunk& chunk, const glm::dmat4& mvp,
         bool renderBounds, bool renderAABB) const;
 
-    bool isCullableByFrustum(const Chunk& chunk, const RenderData& renderData) const;
-    bool isCullableByHorizon(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
+    bool isCullableByFrustum(const Chunk& chunk) const;
+    bool isCullableByHorizon(const Chunk& chunk, const BoundingHeights& heights) const;
 
-    int desiredLevelByDistance(const Chunk& chunk, const RenderData& data,
-        const BoundingHeights& heights) const;
-    int desiredLevelByProjectedArea(const Chunk& chunk, const RenderData& data,
+    int desiredLevelByDistance(const Chunk& chunk, const BoundingHeights& heights) const;
+    int desiredLevelByProjectedArea(const Chunk& chunk,
         const BoundingHeights& heights) const;
     int desiredLevelByAvailableTileData(const Chunk& chunk) const;
 
@@ -226,11 +206,25 @@ private:
     void recompileShaders();
 
 
-    void splitChunkNode(Chunk& cn, int depth);
-    void mergeChunkNode(Chunk& cn);
-    bool updateChunkTree(Chunk& cn, const RenderData& data);
-    void updateChunk(Chunk& chunk, const RenderData& data) const;
-    void freeChunkNode(Chunk* n);
+    /**
+     * Updates the chunk tree for the view of \p data. If nothing that the chunks depend
+     * on has changed since the last frame, only the chunks that are still waiting for
+     * tile data are evaluated again.
+     */
+    void updateChunkTree(const RenderData& data);
+
+    using HeightSamplingLayers = std::vector<cache::HeightSamplingLayer>;
+
+    /// Captures the currently active height layers for the height sampling if they, their
+    /// readers, or their settings have changed since the last capture
+    void updateHeightSamplingLayers();
+
+    // ChunkTree::Evaluator
+    void initializeChunk(Chunk& chunk) override;
+    void prepareChunk(Chunk& chunk) override;
+    void evaluateChunk(Chunk& chunk) const override;
+    bool commitChunk(const Chunk& chunk) override;
+    void removeChunk(const Chunk& chunk) override;
 
     Ellipsoid _ellipsoid;
     SkirtedGrid _grid;
@@ -239,10 +233,43 @@ private:
     glm::dmat4 _cachedModelTransform;
     glm::dmat4 _cachedInverseModelTransform;
 
-    ghoul::ReusableTypedMemoryPool<Chunk, 256> _chunkPool;
+    // The roots cover all negative and all positive longitudes, respectively
+    ChunkTree _chunkTree;
+
+    // The visible leaf chunks, which are kept as members to reuse their memory
+    std::vector<const Chunk*> _globalChunks;
+    std::vector<const Chunk*> _localChunks;
 
-    Chunk _leftRoot;  // Covers all negative longitudes
-    Chunk _rightRoot; // Covers all positive longitudes
+    // Everything the evaluation of the chunks depends on besides their tiles. The camera
+    // dependent values are computed once per frame, so that the chunks can be evaluated
+    // concurrently without touching the camera
+    struct {
+        glm::dmat4 modelViewProjection = glm::dmat4(0.0);
+        glm::dvec3 cameraPosition = glm::dvec3(0.0); // In model space
+        double time = 0.0;
+        float lodScaleFactor = 0.f;
+        bool levelByProjectedArea = false;
+        std::vector<glm::vec2> heightLayerSettings;
+    } _chunkUpdateState;
+
+    /// Receives the priorities of the tiles of all chunks and the cancellations of the
+    /// tile requests of merged chunks
+    TileIOScheduler* _tileIOScheduler = nullptr;
+
+    /// The CPU-side height tiles from which getHeight samples
+    cache::HeightTileCache* _heightTileCache = nullptr;
+
+    /// The height layers as of the last update. The snapshot is replaced as a whole, so
+    /// that other threads can keep using the previous one while they are sampling
+    std::shared_ptr<const HeightSamplingLayers> _heightSamplingLayers;
+    mutable std::mutex _heightSamplingLayersMutex;
+
+    // What the height sampling layers were captured from: the reader of every level and
+    // the gamma, multiplier, offset, and opacity of each layer
+    struct {
+        std::vector<const RawTileDataReader*> readers;
+        std::vector<glm::vec4> settings;
+    } _heightSamplingState;
 
     // Two different shader programs. One for global and one for local rendering.
     struct {
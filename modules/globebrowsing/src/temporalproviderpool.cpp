@@ -0,0 +1,81 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/temporalproviderpool.h>
+
+#include <algorithm>
+
+namespace openspace::globebrowsing::providerpool {
+
+std::vector<int> prefetchSteps(int prefetchCount, double deltaTime) {
+    std::vector<int> steps;
+    for (int i = 1; i <= prefetchCount; ++i) {
+        if (deltaTime >= 0.0) {
+            steps.push_back(i);
+        }
+        if (deltaTime <= 0.0) {
+            steps.push_back(-i);
+        }
+    }
+    return steps;
+}
+
+size_t numberOfTiles(int maxLevel) {
+    size_t nTiles = 0;
+    for (int level = 1; level <= maxLevel; ++level) {
+        nTiles += size_t(1) << (2 * level - 1);
+    }
+    return nTiles;
+}
+
+size_t capacity(size_t bytesPerProvider, size_t budget, size_t fallback) {
+    if (bytesPerProvider == 0) {
+        return std::max<size_t>(fallback, 1);
+    }
+    return std::max<size_t>(budget / bytesPerProvider, 1);
+}
+
+std::vector<size_t> evictions(const std::vector<PoolEntry>& entries, uint64_t frame,
+                              size_t capacity)
+{
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].lastUsedFrame != frame && !entries[i].isCurrent) {
+            candidates.push_back(i);
+        }
+    }
+    std::stable_sort(
+        candidates.begin(),
+        candidates.end(),
+        [&entries](size_t a, size_t b) {
+            return entries[a].lastUsedFrame < entries[b].lastUsedFrame;
+        }
+    );
+
+    const size_t nExcess = entries.size() > capacity ? entries.size() - capacity : 0;
+    candidates.resize(std::min(nExcess, candidates.size()));
+    return candidates;
+}
+
+} // namespace openspace::globebrowsing::providerpool
@@ -0,0 +1,76 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TEMPORALPROVIDERPOOL___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TEMPORALPROVIDERPOOL___H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The policy of the pool of per-time providers of a TemporalTileProvider, which only
+// depends on the sizes and the usage of the pooled providers
+namespace openspace::globebrowsing::providerpool {
+
+struct PoolEntry {
+    /// The last frame in which the provider was used or prefetched
+    uint64_t lastUsedFrame = 0;
+    /// Whether the provider is the one for the current time
+    bool isCurrent = false;
+};
+
+/**
+ * Returns the steps, in multiples of the time resolution, from the current quantized
+ * time to the \p prefetchCount quantized times that should be prefetched, the closest
+ * first. Only the direction in which time is moving, given by the sign of
+ * \p deltaTime, is prefetched. If time is paused, the steps alternate between both
+ * directions.
+ */
+std::vector<int> prefetchSteps(int prefetchCount, double deltaTime);
+
+/**
+ * Returns the number of tiles on the levels 1 up to and including \p maxLevel, where
+ * level n consists of 2^n x 2^(n-1) tiles.
+ */
+size_t numberOfTiles(int maxLevel);
+
+/**
+ * Returns the number of providers of \p bytesPerProvider each that fit into the
+ * \p budget, but always at least one. If the size of a provider is unknown, that is
+ * \p bytesPerProvider is 0, \p fallback providers are allowed.
+ */
+size_t capacity(size_t bytesPerProvider, size_t budget, size_t fallback);
+
+/**
+ * Returns the indices into \p entries of the providers that have to be removed so that
+ * at most \p capacity providers remain, the least recently used first. Providers that
+ * were used in the \p frame and the current provider are never removed, so more than
+ * \p capacity providers might remain.
+ */
+std::vector<size_t> evictions(const std::vector<PoolEntry>& entries, uint64_t frame,
+    size_t capacity);
+
+} // namespace openspace::globebrowsing::providerpool
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TEMPORALPROVIDERPOOL___H__
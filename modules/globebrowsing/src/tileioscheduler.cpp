@@ -0,0 +1,402 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tileioscheduler.h>
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <openspace/util/job.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    constexpr const std::chrono::seconds StatisticsInterval = std::chrono::seconds(1);
+
+    constexpr openspace::properties::Property::PropertyInfo QueuedRequestsInfo = {
+        "QueuedRequests",
+        "Queued requests",
+        "The number of tile requests of all layers that are waiting to be read."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CompletedRequestsInfo = {
+        "CompletedRequests",
+        "Completed requests",
+        "The total number of tiles that have been read by the tile IO scheduler."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo DroppedRequestsInfo = {
+        "DroppedRequests",
+        "Dropped requests",
+        "The total number of tile requests that were dropped because the queue was "
+        "full of requests with a higher priority."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CancelledRequestsInfo = {
+        "CancelledRequests",
+        "Cancelled requests",
+        "The total number of tile requests that were cancelled before they were read, "
+        "for example because the chunk that requested them was merged."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ThroughputInfo = {
+        "Throughput",
+        "Throughput (tiles/s)",
+        "The number of tiles that were read per second during the last second."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo AverageLatencyInfo = {
+        "AverageLatency",
+        "Average latency (ms)",
+        "The average time between requesting a tile and the tile being read for all "
+        "tiles that were read during the last second."
+    };
+
+    int clampToInt(uint64_t value) {
+        return static_cast<int>(
+            std::min<uint64_t>(value, std::numeric_limits<int>::max())
+        );
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+TileIOScheduler::TileIOScheduler(size_t nThreads, size_t maximumQueueSize)
+    : PropertyOwner({ "TileIOScheduler" })
+    , _maximumQueueSize(maximumQueueSize)
+    , _lastStatisticsTime(Clock::now())
+    , _nQueuedRequests(QueuedRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _nCompletedRequests(CompletedRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _nDroppedRequests(DroppedRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _nCancelledRequests(CancelledRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _throughput(ThroughputInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _averageLatency(AverageLatencyInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+{
+    ghoul_assert(nThreads > 0, "There must be at least one worker thread");
+    ghoul_assert(maximumQueueSize > 0, "The queue must be able to hold requests");
+
+    _nQueuedRequests.setReadOnly(true);
+    addProperty(_nQueuedRequests);
+
+    _nCompletedRequests.setReadOnly(true);
+    addProperty(_nCompletedRequests);
+
+    _nDroppedRequests.setReadOnly(true);
+    addProperty(_nDroppedRequests);
+
+    _nCancelledRequests.setReadOnly(true);
+    addProperty(_nCancelledRequests);
+
+    _throughput.setReadOnly(true);
+    addProperty(_throughput);
+
+    _averageLatency.setReadOnly(true);
+    addProperty(_averageLatency);
+
+    _queue.reserve(_maximumQueueSize + 1);
+    _workers.reserve(nThreads);
+    for (size_t i = 0; i < nThreads; ++i) {
+        _workers.emplace_back([this]() { worker(); });
+    }
+}
+
+TileIOScheduler::~TileIOScheduler() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _workAvailable.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+TileIOScheduler::ClientId TileIOScheduler::registerClient() {
+    std::lock_guard lock(_mutex);
+    const ClientId id = _nextClientId++;
+    _clients[id] = Client();
+    return id;
+}
+
+void TileIOScheduler::unregisterClient(ClientId client) {
+    std::unique_lock lock(_mutex);
+    for (auto it = _queue.begin(); it != _queue.end();) {
+        if (it->first.client == client) {
+            it = _queue.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // The running jobs reference the tile reader of the client, so we can only return
+    // once they are all done
+    _jobFinished.wait(lock, [&]() { return _clients.at(client).nRunningJobs == 0; });
+    _clients.erase(client);
+}
+
+bool TileIOScheduler::enqueue(ClientId client, const TileIndex& tileIndex,
+                              std::shared_ptr<Job<RawTile>> job)
+{
+    const RequestKey key = { client, tileIndex.hashKey() };
+    Request request = {
+        std::move(job),
+        tileIndex.level,
+        priority(key.tile),
+        0,
+        Clock::now()
+    };
+
+    {
+        std::lock_guard lock(_mutex);
+        ghoul_assert(_clients.find(client) != _clients.end(), "Unknown client");
+
+        request.sequence = _nextSequence++;
+
+        if (_queue.size() >= _maximumQueueSize && _queue.find(key) == _queue.end()) {
+            auto worst = _queue.begin();
+            for (auto it = std::next(worst); it != _queue.end(); ++it) {
+                if (hasPrecedence(worst->second, it->second)) {
+                    worst = it;
+                }
+            }
+
+            _statistics.nDropped++;
+            if (!hasPrecedence(request, worst->second)) {
+                return false;
+            }
+
+            _clients[worst->first.client].droppedRequests.push_back(worst->first.tile);
+            _queue.erase(worst);
+        }
+
+        _queue[key] = std::move(request);
+        _statistics.nEnqueued++;
+    }
+
+    _workAvailable.notify_one();
+    return true;
+}
+
+bool TileIOScheduler::touch(ClientId client, const TileIndex& tileIndex) {
+    std::lock_guard lock(_mutex);
+    const auto it = _queue.find({ client, tileIndex.hashKey() });
+    if (it == _queue.end()) {
+        return false;
+    }
+
+    it->second.sequence = _nextSequence++;
+    return true;
+}
+
+std::vector<std::shared_ptr<Job<RawTile>>> TileIOScheduler::popFinishedJobs(
+                                                                        ClientId client)
+{
+    std::vector<std::shared_ptr<Job<RawTile>>> jobs;
+    std::lock_guard lock(_mutex);
+    std::swap(jobs, _clients.at(client).finishedJobs);
+    return jobs;
+}
+
+size_t TileIOScheduler::numFinishedJobs(ClientId client) const {
+    std::lock_guard lock(_mutex);
+    return _clients.at(client).finishedJobs.size();
+}
+
+std::vector<TileIndex::TileHashKey> TileIOScheduler::popDroppedRequests(
+                                                                        ClientId client)
+{
+    std::vector<TileIndex::TileHashKey> keys;
+    std::lock_guard lock(_mutex);
+    std::swap(keys, _clients.at(client).droppedRequests);
+    return keys;
+}
+
+std::vector<TileIndex::TileHashKey> TileIOScheduler::cancelEnqueuedRequests(
+                                                                        ClientId client)
+{
+    std::vector<TileIndex::TileHashKey> keys;
+    std::lock_guard lock(_mutex);
+    for (auto it = _queue.begin(); it != _queue.end();) {
+        if (it->first.client == client) {
+            keys.push_back(it->first.tile);
+            it = _queue.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    _statistics.nCancelled += keys.size();
+    return keys;
+}
+
+void TileIOScheduler::setPriority(const TileIndex& tileIndex, float priority) {
+    auto [it, inserted] = _priorityHints.try_emplace(tileIndex.hashKey(), priority);
+    if (!inserted) {
+        it->second = std::max(it->second, priority);
+    }
+}
+
+void TileIOScheduler::cancel(ClientId client, const TileIndex& tileIndex) {
+    const RequestKey key = { client, tileIndex.hashKey() };
+
+    std::lock_guard lock(_mutex);
+    const auto it = _queue.find(key);
+    if (it != _queue.end()) {
+        _clients.at(client).droppedRequests.push_back(key.tile);
+        _statistics.nCancelled++;
+        _queue.erase(it);
+    }
+}
+
+void TileIOScheduler::update() {
+    Statistics stats;
+    size_t nQueued = 0;
+    {
+        std::lock_guard lock(_mutex);
+        for (std::pair<const RequestKey, Request>& r : _queue) {
+            r.second.priority = priority(r.first.tile);
+        }
+        stats = _statistics;
+        nQueued = _queue.size();
+    }
+    _priorityHints.clear();
+
+    _nQueuedRequests = clampToInt(nQueued);
+    _nCompletedRequests = clampToInt(stats.nCompleted);
+    _nDroppedRequests = clampToInt(stats.nDropped);
+    _nCancelledRequests = clampToInt(stats.nCancelled);
+
+    const Clock::time_point now = Clock::now();
+    const Clock::duration dt = now - _lastStatisticsTime;
+    if (dt >= StatisticsInterval) {
+        const uint64_t nCompleted = stats.nCompleted - _lastStatistics.nCompleted;
+        const std::chrono::microseconds latency =
+            stats.totalLatency - _lastStatistics.totalLatency;
+
+        _throughput = static_cast<float>(
+            nCompleted / std::chrono::duration<double>(dt).count()
+        );
+        _averageLatency = nCompleted > 0 ?
+            static_cast<float>(latency.count() / 1000.0 / nCompleted) :
+            0.f;
+
+        _lastStatistics = stats;
+        _lastStatisticsTime = now;
+    }
+}
+
+size_t TileIOScheduler::numThreads() const {
+    return _workers.size();
+}
+
+size_t TileIOScheduler::numQueuedRequests() const {
+    std::lock_guard lock(_mutex);
+    return _queue.size();
+}
+
+TileIOScheduler::Statistics TileIOScheduler::statistics() const {
+    std::lock_guard lock(_mutex);
+    return _statistics;
+}
+
+bool TileIOScheduler::hasPrecedence(const Request& a, const Request& b) {
+    if (a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    if (a.level != b.level) {
+        return a.level < b.level;
+    }
+    return a.sequence > b.sequence;
+}
+
+TileIOScheduler::Queue::iterator TileIOScheduler::bestRunnableRequest() {
+    // The queue only holds a few hundred requests and the priorities change every
+    // frame, so searching for the best request is cheaper than keeping the queue sorted
+    Queue::iterator best = _queue.end();
+    for (auto it = _queue.begin(); it != _queue.end(); ++it) {
+        // GDAL datasets must not be used by multiple threads at the same time, so a
+        // client, which reads from a single dataset, only ever runs one job. Its next
+        // request is picked up by the worker that finishes the running job
+        if (_clients.at(it->first.client).nRunningJobs > 0) {
+            continue;
+        }
+        if (best == _queue.end() || hasPrecedence(it->second, best->second)) {
+            best = it;
+        }
+    }
+    return best;
+}
+
+float TileIOScheduler::priority(TileIndex::TileHashKey key) const {
+    const auto it = _priorityHints.find(key);
+    return it != _priorityHints.end() ? it->second : 0.f;
+}
+
+void TileIOScheduler::worker() {
+    while (true) {
+        ClientId client;
+        std::shared_ptr<Job<RawTile>> job;
+        Clock::time_point enqueueTime;
+        {
+            std::unique_lock lock(_mutex);
+            Queue::iterator best = _queue.end();
+            _workAvailable.wait(lock, [this, &best]() {
+                if (_stop) {
+                    return true;
+                }
+                best = bestRunnableRequest();
+                return best != _queue.end();
+            });
+            if (_stop) {
+                return;
+            }
+
+            client = best->first.client;
+            job = std::move(best->second.job);
+            enqueueTime = best->second.enqueueTime;
+            _queue.erase(best);
+            _clients.at(client).nRunningJobs++;
+        }
+
+        job->execute();
+
+        {
+            std::lock_guard lock(_mutex);
+            // The client is still registered as unregistering waits for running jobs
+            Client& c = _clients.at(client);
+            c.finishedJobs.push_back(std::move(job));
+            c.nRunningJobs--;
+
+            _statistics.nCompleted++;
+            _statistics.totalLatency +=
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - enqueueTime
+                );
+        }
+        _jobFinished.notify_all();
+    }
+}
+
+} // namespace openspace::globebrowsing
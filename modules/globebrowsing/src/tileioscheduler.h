@@ -0,0 +1,255 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_IO_SCHEDULER___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_IO_SCHEDULER___H__
+
+#include <openspace/properties/propertyowner.h>
+
+#include <modules/globebrowsing/src/tileindex.h>
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace { template <typename T> struct Job; }
+
+namespace openspace::globebrowsing {
+
+struct RawTile;
+
+/**
+ * A single scheduler for all tile reads of all AsyncTileDataProvider%s. Instead of every
+ * provider owning a thread and a queue of its own, the providers register themselves as
+ * clients of this scheduler and all of their requests are executed by a shared, fixed
+ * set of worker threads.
+ *
+ * Whenever a worker becomes idle, it picks the queued request with the highest priority.
+ * Priorities are published by the RenderableGlobe%s every frame through #setPriority;
+ * a chunk whose level is far below its desired level has a large screen-space error and
+ * its tiles are loaded first. Ties are broken by loading coarser tiles first and, within
+ * the same level, the most recently requested tile first. Requests that did not receive
+ * a priority in the last frame fall back to the lowest priority, which means that they
+ * are the first to be dropped when the queue is full.
+ *
+ * The jobs of a single client are executed one at a time, as every client reads from
+ * its own GDAL dataset and those must not be accessed from multiple threads at once.
+ * The workers therefore spread over the clients and pick the best request of a client
+ * that is not running a job already.
+ *
+ * The functions of this class, apart from the worker threads, are only called from the
+ * main thread. Jobs that are already running can not be cancelled; their results are
+ * returned to the client as usual.
+ */
+class TileIOScheduler : public properties::PropertyOwner {
+public:
+    using ClientId = uint32_t;
+
+    /**
+     * \param nThreads The number of worker threads that execute the tile reads
+     * \param maximumQueueSize The maximum number of requests of all clients that can be
+     *        queued at the same time. If more requests are enqueued, the request with
+     *        the lowest priority is dropped
+     */
+    TileIOScheduler(size_t nThreads, size_t maximumQueueSize);
+    ~TileIOScheduler();
+
+    /**
+     * Registers a new client of the scheduler and returns the identifier that has to be
+     * passed to all client-specific functions.
+     */
+    ClientId registerClient();
+
+    /**
+     * Removes the \p client from this scheduler. All queued requests of the client are
+     * discarded and this function blocks until all jobs of the client that are currently
+     * executed have finished, as those jobs might reference data owned by the client.
+     */
+    void unregisterClient(ClientId client);
+
+    /**
+     * Enqueues the \p job that loads the tile \p tileIndex for the \p client.
+     *
+     * \return \c true if the job was enqueued, \c false if the queue is full of requests
+     *         that have a higher priority than this request
+     */
+    bool enqueue(ClientId client, const TileIndex& tileIndex,
+        std::shared_ptr<Job<RawTile>> job);
+
+    /**
+     * Marks the request for \p tileIndex of the \p client as recently used.
+     *
+     * \return \c true if the request is still queued, \c false otherwise
+     */
+    bool touch(ClientId client, const TileIndex& tileIndex);
+
+    /**
+     * \return All jobs of the \p client that have finished since the last call, in the
+     *         order in which they finished
+     */
+    std::vector<std::shared_ptr<Job<RawTile>>> popFinishedJobs(ClientId client);
+
+    size_t numFinishedJobs(ClientId client) const;
+
+    /**
+     * \return The keys of all requests of the \p client that were removed from the
+     *         queue without being executed since the last call, either because the
+     *         queue was full or because they were cancelled
+     */
+    std::vector<TileIndex::TileHashKey> popDroppedRequests(ClientId client);
+
+    /**
+     * Removes all queued requests of the \p client and returns their keys. Jobs that
+     * are currently executed are not affected.
+     */
+    std::vector<TileIndex::TileHashKey> cancelEnqueuedRequests(ClientId client);
+
+    /**
+     * Publishes the priority with which the tile \p tileIndex is needed in the current
+     * frame. If multiple priorities are published for the same tile index, for example
+     * by different globes, the highest one is used. The priorities are applied to all
+     * queued requests in #update and are reset afterwards.
+     */
+    void setPriority(const TileIndex& tileIndex, float priority);
+
+    /**
+     * Removes the queued request of the \p client for the tile \p tileIndex. This is
+     * called when the chunk that requested the tile is merged into its parent. Other
+     * globes might still need the same tile index, so only the clients of the globe
+     * whose chunk was merged are cancelled. The request is reported to the client
+     * through #popDroppedRequests.
+     */
+    void cancel(ClientId client, const TileIndex& tileIndex);
+
+    /**
+     * Reranks all queued requests based on the priorities that were published in this
+     * frame and updates the statistics. This function has to be called once per frame.
+     */
+    void update();
+
+    /// The number of worker threads of this scheduler
+    size_t numThreads() const;
+
+    /// The number of requests that are currently queued for all clients
+    size_t numQueuedRequests() const;
+
+    struct Statistics {
+        uint64_t nEnqueued = 0;
+        uint64_t nCompleted = 0;
+        uint64_t nDropped = 0;
+        uint64_t nCancelled = 0;
+        /// The sum of the times between enqueueing and finishing all completed jobs
+        std::chrono::microseconds totalLatency = std::chrono::microseconds(0);
+    };
+
+    /// Returns the statistics since the creation of the scheduler
+    Statistics statistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct RequestKey {
+        ClientId client;
+        TileIndex::TileHashKey tile;
+
+        bool operator==(const RequestKey& r) const {
+            return (client == r.client) && (tile == r.tile);
+        }
+    };
+
+    struct RequestKeyHasher {
+        size_t operator()(const RequestKey& k) const {
+            uint64_t key = k.tile;
+            key ^= k.client + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+            return static_cast<size_t>(key);
+        }
+    };
+
+    struct Request {
+        std::shared_ptr<Job<RawTile>> job;
+        int level;
+        float priority;
+        /// Increases with every enqueue or touch, used to prefer recent requests
+        uint64_t sequence;
+        Clock::time_point enqueueTime;
+    };
+
+    struct Client {
+        std::vector<std::shared_ptr<Job<RawTile>>> finishedJobs;
+        std::vector<TileIndex::TileHashKey> droppedRequests;
+        /// The number of jobs of this client that are currently executed
+        int nRunningJobs = 0;
+    };
+
+    using Queue = std::unordered_map<RequestKey, Request, RequestKeyHasher>;
+
+    /// Returns \c true if request \p a should be executed before request \p b
+    static bool hasPrecedence(const Request& a, const Request& b);
+
+    /// Returns the request with the highest precedence of all clients that are not
+    /// running a job at the moment, or the end of the queue if there is none. Must be
+    /// called with the mutex locked
+    Queue::iterator bestRunnableRequest();
+
+    void worker();
+    float priority(TileIndex::TileHashKey key) const;
+
+    const size_t _maximumQueueSize;
+
+    Queue _queue;
+    std::unordered_map<ClientId, Client> _clients;
+    ClientId _nextClientId = 0;
+    uint64_t _nextSequence = 0;
+    Statistics _statistics;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _jobFinished;
+    bool _stop = false;
+    std::vector<std::thread> _workers;
+
+    /// The priorities that were published in the current frame, only used on the main
+    /// thread
+    std::unordered_map<TileIndex::TileHashKey, float> _priorityHints;
+
+    Statistics _lastStatistics;
+    Clock::time_point _lastStatisticsTime;
+
+    properties::IntProperty _nQueuedRequests;
+    properties::IntProperty _nCompletedRequests;
+    properties::IntProperty _nDroppedRequests;
+    properties::IntProperty _nCancelledRequests;
+    properties::FloatProperty _throughput;
+    properties::FloatProperty _averageLatency;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_IO_SCHEDULER___H__
@@ -0,0 +1,234 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilemetadatakernel.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    // The number of pixels that are processed in one iteration of the specialized kernels
+    constexpr const size_t BlockSize = 16;
+
+    template <typename T>
+    constexpr T missingValue() {
+        if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(-std::numeric_limits<float>::max());
+        }
+        else {
+            return std::numeric_limits<T>::lowest();
+        }
+    }
+
+    size_t numberOfBytes(GLenum glType) {
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:  return sizeof(GLubyte);
+            case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+            case GL_SHORT:          return sizeof(GLshort);
+            case GL_UNSIGNED_INT:   return sizeof(GLuint);
+            case GL_INT:            return sizeof(GLint);
+            case GL_HALF_FLOAT:     return sizeof(GLhalf);
+            case GL_FLOAT:          return sizeof(GLfloat);
+            case GL_DOUBLE:         return sizeof(GLdouble);
+            default:
+                ghoul_assert(false, "Unknown data type");
+                throw ghoul::MissingCaseException();
+        }
+    }
+
+    float interpretFloat(GLenum glType, const std::byte* src) {
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:
+                return static_cast<float>(*reinterpret_cast<const GLubyte*>(src));
+            case GL_UNSIGNED_SHORT:
+                return static_cast<float>(*reinterpret_cast<const GLushort*>(src));
+            case GL_SHORT:
+                return static_cast<float>(*reinterpret_cast<const GLshort*>(src));
+            case GL_UNSIGNED_INT:
+                return static_cast<float>(*reinterpret_cast<const GLuint*>(src));
+            case GL_INT:
+                return static_cast<float>(*reinterpret_cast<const GLint*>(src));
+            case GL_HALF_FLOAT:
+                return static_cast<float>(*reinterpret_cast<const GLhalf*>(src));
+            case GL_FLOAT:
+                return static_cast<float>(*reinterpret_cast<const GLfloat*>(src));
+            case GL_DOUBLE:
+                return static_cast<float>(*reinterpret_cast<const GLdouble*>(src));
+            default:
+                ghoul_assert(false, "Unknown data type");
+                throw ghoul::MissingCaseException();
+        }
+    }
+
+    template <typename T>
+    void writeMissingValue(std::byte* dst) {
+        *reinterpret_cast<T*>(dst) = missingValue<T>();
+    }
+
+    void writeMissingValue(GLenum glType, std::byte* dst) {
+        switch (glType) {
+            case GL_UNSIGNED_BYTE:  writeMissingValue<GLubyte>(dst);  break;
+            case GL_UNSIGNED_SHORT: writeMissingValue<GLushort>(dst); break;
+            case GL_SHORT:          writeMissingValue<GLshort>(dst);  break;
+            case GL_UNSIGNED_INT:   writeMissingValue<GLuint>(dst);   break;
+            case GL_INT:            writeMissingValue<GLint>(dst);    break;
+            case GL_HALF_FLOAT:     writeMissingValue<GLhalf>(dst);   break;
+            case GL_FLOAT:          writeMissingValue<GLfloat>(dst);  break;
+            case GL_DOUBLE:         writeMissingValue<GLdouble>(dst); break;
+            default:
+                ghoul_assert(false, "Unknown data type");
+                throw ghoul::MissingCaseException();
+        }
+    }
+
+    template <typename T, size_t NRasters>
+    bool tileMetaDataBlocked(std::byte* data, size_t nPixels, float noDataValue,
+                             TileMetaData& metaData)
+    {
+        // Every lane accumulates one raster of one pixel in a block. As the number of
+        // lanes is known at compile time and the loop body has no branches, the inner
+        // loop is compiled into vector instructions
+        constexpr size_t Lanes = BlockSize * NRasters;
+        constexpr T Missing = missingValue<T>();
+
+        std::array<float, Lanes> minValues;
+        minValues.fill(std::numeric_limits<float>::max());
+        std::array<float, Lanes> maxValues;
+        maxValues.fill(-std::numeric_limits<float>::max());
+        std::array<uint32_t, Lanes> nValid = {};
+
+        auto process = [&](T* values, size_t lane) {
+            const float v = static_cast<float>(*values);
+            // Invalid values are replaced by the neutral element of each operation
+            // instead of being skipped, which would introduce a branch
+            const bool valid = (v != noDataValue) & (v == v);
+            const float low = valid ? v : std::numeric_limits<float>::max();
+            const float high = valid ? v : -std::numeric_limits<float>::max();
+            minValues[lane] = std::min(minValues[lane], low);
+            maxValues[lane] = std::max(maxValues[lane], high);
+            nValid[lane] += static_cast<uint32_t>(valid);
+            *values = valid ? *values : Missing;
+        };
+
+        T* values = reinterpret_cast<T*>(data);
+        const size_t nValues = nPixels * NRasters;
+        const size_t nBlockValues = nValues - nValues % Lanes;
+        for (size_t i = 0; i < nBlockValues; i += Lanes) {
+            T* block = values + i;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                process(block + lane, lane);
+            }
+        }
+        // The remaining pixels that do not fill a whole block
+        for (size_t i = nBlockValues; i < nValues; ++i) {
+            process(values + i, i - nBlockValues);
+        }
+
+        metaData.maxValues.assign(NRasters, -std::numeric_limits<float>::max());
+        metaData.minValues.assign(NRasters, std::numeric_limits<float>::max());
+        metaData.hasMissingData.assign(NRasters, false);
+        bool anyValid = false;
+        for (size_t raster = 0; raster < NRasters; ++raster) {
+            uint64_t nValidRaster = 0;
+            for (size_t lane = raster; lane < Lanes; lane += NRasters) {
+                metaData.minValues[raster] = std::min(
+                    metaData.minValues[raster],
+                    minValues[lane]
+                );
+                metaData.maxValues[raster] = std::max(
+                    metaData.maxValues[raster],
+                    maxValues[lane]
+                );
+                nValidRaster += nValid[lane];
+            }
+            metaData.hasMissingData[raster] = nValidRaster < nPixels;
+            anyValid |= nValidRaster > 0;
+        }
+        return anyValid;
+    }
+
+    template <typename T>
+    TileMetaDataKernel blockedKernel(size_t nRasters) {
+        switch (nRasters) {
+            case 1: return &tileMetaDataBlocked<T, 1>;
+            case 2: return &tileMetaDataBlocked<T, 2>;
+            case 3: return &tileMetaDataBlocked<T, 3>;
+            case 4: return &tileMetaDataBlocked<T, 4>;
+            default: return nullptr;
+        }
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+TileMetaDataKernel tileMetaDataKernel(GLenum glType, size_t nRasters) {
+    switch (glType) {
+        case GL_UNSIGNED_BYTE:  return blockedKernel<GLubyte>(nRasters);
+        case GL_UNSIGNED_SHORT: return blockedKernel<GLushort>(nRasters);
+        case GL_SHORT:          return blockedKernel<GLshort>(nRasters);
+        case GL_UNSIGNED_INT:   return blockedKernel<GLuint>(nRasters);
+        case GL_INT:            return blockedKernel<GLint>(nRasters);
+        case GL_FLOAT:          return blockedKernel<GLfloat>(nRasters);
+        case GL_DOUBLE:         return blockedKernel<GLdouble>(nRasters);
+        // GLhalf has no arithmetic type, so it is handled by the scalar implementation
+        default:                return nullptr;
+    }
+}
+
+bool tileMetaDataScalar(GLenum glType, size_t nRasters, std::byte* data, size_t nPixels,
+                        float noDataValue, TileMetaData& metaData)
+{
+    metaData.maxValues.assign(nRasters, -std::numeric_limits<float>::max());
+    metaData.minValues.assign(nRasters, std::numeric_limits<float>::max());
+    metaData.hasMissingData.assign(nRasters, false);
+
+    const size_t bytesPerDatum = numberOfBytes(glType);
+
+    bool anyValid = false;
+    size_t i = 0;
+    for (size_t pixel = 0; pixel < nPixels; ++pixel) {
+        for (size_t raster = 0; raster < nRasters; ++raster) {
+            const float val = interpretFloat(glType, data + i);
+            if (val != noDataValue && val == val) {
+                metaData.maxValues[raster] = std::max(val, metaData.maxValues[raster]);
+                metaData.minValues[raster] = std::min(val, metaData.minValues[raster]);
+                anyValid = true;
+            }
+            else {
+                metaData.hasMissingData[raster] = true;
+                writeMissingValue(glType, data + i);
+            }
+            i += bytesPerDatum;
+        }
+    }
+    return anyValid;
+}
+
+} // namespace openspace::globebrowsing
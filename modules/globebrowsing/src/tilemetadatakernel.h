@@ -0,0 +1,64 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA_KERNEL___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA_KERNEL___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/opengl/ghoul_gl.h>
+#include <cstddef>
+
+namespace openspace::globebrowsing {
+
+/**
+ * A function that computes the minimum and maximum value of each raster of the
+ * \p nPixels interleaved pixels in \p data. NaNs and values that are equal to the
+ * \p noDataValue are excluded, are replaced in \p data by the lowest value of the data
+ * type (or <code>-FLT_MAX</code> for floating point data), and mark their raster as
+ * having missing data. The values are compared as <code>float</code>s.
+ *
+ * \return \c true if at least one value in \p data was valid, \c false otherwise
+ */
+using TileMetaDataKernel = bool(*)(std::byte* data, size_t nPixels, float noDataValue,
+    TileMetaData& metaData);
+
+/**
+ * Returns the kernel that is specialized for the data type \p glType and the number of
+ * rasters \p nRasters. The specialized kernels process the pixels in fixed-size blocks
+ * without branches so that the compiler can vectorize them. If there is no specialized
+ * kernel for the combination, \c nullptr is returned and #tileMetaDataScalar has to be
+ * used instead.
+ */
+TileMetaDataKernel tileMetaDataKernel(GLenum glType, size_t nRasters);
+
+/**
+ * The reference implementation of a TileMetaDataKernel that supports all data types and
+ * number of rasters by interpreting one value at a time.
+ */
+bool tileMetaDataScalar(GLenum glType, size_t nRasters, std::byte* data, size_t nPixels,
+    float noDataValue, TileMetaData& metaData);
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA_KERNEL___H__
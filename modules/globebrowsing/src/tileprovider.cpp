@@ -30,6 +30,7 @@
 #include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/temporalproviderpool.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <openspace/util/factorymanager.h>
@@ -40,7 +41,10 @@
 #include <ghoul/font/fontrenderer.h>
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
 #include <fstream>
+#include <limits>
+#include <optional>
 #include "cpl_minixml.h"
 
 namespace ghoul {
@@ -144,6 +148,34 @@ namespace temporal {
         "This is the path to the XML configuration file that describes the temporal tile "
         "information."
     };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchCountInfo = {
+        "PrefetchCount",
+        "Prefetch Count",
+        "The number of quantized times in the direction in which time is moving for "
+        "which the datasets are opened and the low-level tiles are loaded ahead of time. "
+        "If time is paused, the times in both directions are prefetched."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchLevelInfo = {
+        "PrefetchLevel",
+        "Prefetch Level",
+        "All tiles up to and including this level are loaded for the prefetched times."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo MemoryBudgetInfo = {
+        "MemoryBudget",
+        "Memory Budget (MB)",
+        "The amount of memory that the tile providers of the different times are "
+        "allowed to use, estimated from the size of their prefetched tiles. If more "
+        "providers would be needed, the least recently used ones are removed."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NumberOfProvidersInfo = {
+        "NumberOfProviders",
+        "Number of Providers",
+        "The number of tile providers for different times that are currently open."
+    };
 } // namespace temporal
 
 
@@ -164,11 +196,11 @@ void initAsyncTileDataReader(DefaultTileProvider& t, TileTextureInitData initDat
 
 void initTexturesFromLoadedData(DefaultTileProvider& t) {
     if (t.asyncTextureDataProvider) {
-        std::optional<RawTile> tile = t.asyncTextureDataProvider->popFinishedRawTile();
-        if (tile) {
-            const cache::ProviderTileKey key = { tile->tileIndex, t.uniqueIdentifier };
+        std::vector<RawTile> tiles = t.asyncTextureDataProvider->popFinishedRawTiles();
+        for (RawTile& tile : tiles) {
+            const cache::ProviderTileKey key = { tile.tileIndex, t.uniqueIdentifier };
             ghoul_assert(!t.tileCache->exist(key), "Tile must not be existing in cache");
-            t.tileCache->createTileAndPut(key, std::move(tile.value()));
+            t.tileCache->createTileAndPut(key, std::move(tile));
         }
     }
 }
@@ -324,24 +356,34 @@ TileProvider* getTileProvider(TemporalTileProvider& t,
 {
     const auto it = t.tileProviderMap.find(timekey);
     if (it != t.tileProviderMap.end()) {
-        return it->second.get();
+        it->second.lastUsedFrame = t.frame;
+        return it->second.provider.get();
     }
     else {
         std::unique_ptr<TileProvider> tileProvider = initTileProvider(t, timekey);
         initialize(*tileProvider);
 
         TileProvider* res = tileProvider.get();
-        t.tileProviderMap[timekey] = std::move(tileProvider);
+        t.tileProviderMap[timekey] = { std::move(tileProvider), t.frame };
         return res;
     }
 }
 
-TileProvider* getTileProvider(TemporalTileProvider& t, const Time& time) {
+std::optional<TemporalTileProvider::TimeKey> quantizedTimeKey(TemporalTileProvider& t,
+                                                              const Time& time)
+{
     Time tCopy(time);
     if (t.timeQuantizer.quantize(tCopy, true)) {
-        TemporalTileProvider::TimeKey timeKey = timeStringify(t.timeFormat, tCopy);
+        return timeStringify(t.timeFormat, tCopy);
+    }
+    return std::nullopt;
+}
+
+TileProvider* getTileProvider(TemporalTileProvider& t, const Time& time) {
+    std::optional<TemporalTileProvider::TimeKey> timeKey = quantizedTimeKey(t, time);
+    if (timeKey) {
         try {
-            return getTileProvider(t, timeKey);
+            return getTileProvider(t, *timeKey);
         }
         catch (const ghoul::RuntimeError& e) {
             LERRORC("TemporalTileProvider", e.message);
@@ -351,6 +393,148 @@ TileProvider* getTileProvider(TemporalTileProvider& t, const Time& time) {
     return nullptr;
 }
 
+/**
+ * Returns the estimated number of bytes that one provider of \p t uses for the tiles up
+ * to the prefetch level, or 0 if the provider type is unknown.
+ */
+size_t providerMemory(TemporalTileProvider& t) {
+    if (!t.currentTileProvider ||
+        t.currentTileProvider->type != Type::DefaultTileProvider)
+    {
+        return 0;
+    }
+
+    // All providers of a temporal layer are created from the same dictionary, so they
+    // share the same tile size
+    const DefaultTileProvider& p =
+        static_cast<const DefaultTileProvider&>(*t.currentTileProvider);
+    const TileTextureInitData initData = tileTextureInitData(
+        p.layerGroupID,
+        p.padTiles,
+        p.tilePixelSize
+    );
+
+    return providerpool::numberOfTiles(t.prefetchLevel) * initData.totalNumBytes;
+}
+
+/**
+ * Returns the number of providers that fit into the memory budget of \p t, including
+ * the provider for the current time.
+ */
+size_t providerCapacity(TemporalTileProvider& t) {
+    return providerpool::capacity(
+        providerMemory(t),
+        static_cast<size_t>(t.memoryBudget) * 1024 * 1024,
+        static_cast<size_t>(t.prefetchCount) + 1
+    );
+}
+
+/**
+ * Returns the keys of the quantized times that are next to \p time in the direction in
+ * which time is moving, or on both sides if time is paused. At most \p maxKeys keys are
+ * returned, the closest times first.
+ */
+std::vector<TemporalTileProvider::TimeKey> prefetchTimeKeys(TemporalTileProvider& t,
+                                                            const Time& time,
+                                                            size_t maxKeys)
+{
+    using TimeKey = TemporalTileProvider::TimeKey;
+
+    const double deltaTime = global::timeManager.deltaTime();
+    const double resolution = t.timeQuantizer.resolution();
+    const std::optional<TimeKey> current = quantizedTimeKey(t, time);
+
+    std::vector<TimeKey> keys;
+    auto addStep = [&](int step) {
+        if (keys.size() >= maxKeys) {
+            return;
+        }
+        const Time neighbor(time.j2000Seconds() + step * resolution);
+        // Times outside of the time range are clamped onto the first or last time, so
+        // there might be fewer distinct times than steps
+        std::optional<TimeKey> key = quantizedTimeKey(t, neighbor);
+        if (key && key != current &&
+            std::find(keys.begin(), keys.end(), *key) == keys.end())
+        {
+            keys.push_back(std::move(*key));
+        }
+    };
+
+    for (int step : providerpool::prefetchSteps(t.prefetchCount, deltaTime)) {
+        addStep(step);
+    }
+    return keys;
+}
+
+/**
+ * Opens the providers for the quantized times next to \p time and requests their tiles
+ * up to the prefetch level. As opening a dataset might take a while, at most one new
+ * provider is created per call.
+ */
+void prefetchProviders(TemporalTileProvider& t, const Time& time, size_t capacity) {
+    using TimeKey = TemporalTileProvider::TimeKey;
+
+    bool hasCreatedProvider = false;
+    for (const TimeKey& key : prefetchTimeKeys(t, time, capacity - 1)) {
+        auto it = t.tileProviderMap.find(key);
+        if (it == t.tileProviderMap.end()) {
+            if (hasCreatedProvider) {
+                continue;
+            }
+            hasCreatedProvider = true;
+
+            try {
+                getTileProvider(t, key);
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC("TemporalTileProvider", e.message);
+                continue;
+            }
+            it = t.tileProviderMap.find(key);
+        }
+
+        it->second.lastUsedFrame = t.frame;
+        TileProvider& provider = *it->second.provider;
+        update(provider);
+
+        // Requesting a tile enqueues its read unless it is already in the tile cache
+        for (int level = 1; level <= t.prefetchLevel; ++level) {
+            for (int x = 0; x < (1 << level); ++x) {
+                for (int y = 0; y < (1 << (level - 1)); ++y) {
+                    tile(provider, TileIndex(x, y, level));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Removes the least recently used providers until no more than \p capacity providers
+ * are left. Providers that were used in the current frame are never removed.
+ */
+void evictProviders(TemporalTileProvider& t, size_t capacity) {
+    using TimeKey = TemporalTileProvider::TimeKey;
+    using PooledProvider = TemporalTileProvider::PooledProvider;
+
+    std::vector<TimeKey> keys;
+    std::vector<providerpool::PoolEntry> entries;
+    for (const std::pair<const TimeKey, PooledProvider>& p : t.tileProviderMap) {
+        keys.push_back(p.first);
+        entries.push_back({
+            p.second.lastUsedFrame,
+            p.second.provider.get() == t.currentTileProvider
+        });
+    }
+
+    for (size_t i : providerpool::evictions(entries, t.frame, capacity)) {
+        auto it = t.tileProviderMap.find(keys[i]);
+        deinitialize(*it->second.provider);
+        t.tileProviderMap.erase(it);
+    }
+
+    t.nProviders = static_cast<int>(t.tileProviderMap.size());
+}
+
 void ensureUpdated(TemporalTileProvider& t) {
     if (!t.currentTileProvider) {
         update(t);
@@ -750,12 +934,40 @@ TileProviderByLevel::TileProviderByLevel(const ghoul::Dictionary& dictionary) {
 TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     : initDict(dictionary)
     , filePath(temporal::FilePathInfo)
+    , prefetchCount(temporal::PrefetchCountInfo, 2, 0, 16)
+    , prefetchLevel(temporal::PrefetchLevelInfo, 3, 1, 6)
+    , memoryBudget(temporal::MemoryBudgetInfo, 512, 16, 16384)
+    , nProviders(temporal::NumberOfProvidersInfo, 0, 0, std::numeric_limits<int>::max())
 {
     type = Type::TemporalTileProvider;
 
     filePath = dictionary.value<std::string>(KeyFilePath);
     addProperty(filePath);
 
+    if (dictionary.hasKeyAndValue<double>(temporal::PrefetchCountInfo.identifier)) {
+        prefetchCount = static_cast<int>(
+            dictionary.value<double>(temporal::PrefetchCountInfo.identifier)
+        );
+    }
+    addProperty(prefetchCount);
+
+    if (dictionary.hasKeyAndValue<double>(temporal::PrefetchLevelInfo.identifier)) {
+        prefetchLevel = static_cast<int>(
+            dictionary.value<double>(temporal::PrefetchLevelInfo.identifier)
+        );
+    }
+    addProperty(prefetchLevel);
+
+    if (dictionary.hasKeyAndValue<double>(temporal::MemoryBudgetInfo.identifier)) {
+        memoryBudget = static_cast<int>(
+            dictionary.value<double>(temporal::MemoryBudgetInfo.identifier)
+        );
+    }
+    addProperty(memoryBudget);
+
+    nProviders.setReadOnly(true);
+    addProperty(nProviders);
+
     successfulInitialization = readFilePath(*this);
 
     if (!successfulInitialization) {
@@ -1119,11 +1331,18 @@ void update(TileProvider& tp) {
         case Type::TemporalTileProvider: {
             TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
             if (t.successfulInitialization) {
-                TileProvider* newCurrent = getTileProvider(t, global::timeManager.time());
+                t.frame++;
+
+                const Time& time = global::timeManager.time();
+                TileProvider* newCurrent = getTileProvider(t, time);
                 if (newCurrent) {
                     t.currentTileProvider = newCurrent;
                 }
                 update(*t.currentTileProvider);
+
+                const size_t capacity = providerCapacity(t);
+                prefetchProviders(t, time, capacity);
+                evictProviders(t, capacity);
             }
             break;
         }
@@ -1206,9 +1425,9 @@ void reset(TileProvider& tp) {
             TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
             if (t.successfulInitialization) {
                 using K = TemporalTileProvider::TimeKey;
-                using V = std::unique_ptr<TileProvider>;
+                using V = TemporalTileProvider::PooledProvider;
                 for (std::pair<const K, V>& it : t.tileProviderMap) {
-                    reset(*it.second);
+                    reset(*it.second.provider);
                 }
             }
             break;
@@ -1223,6 +1442,56 @@ void reset(TileProvider& tp) {
 
 
 
+void cancel(TileProvider& tp, const TileIndex& tileIndex) {
+    switch (tp.type) {
+        case Type::DefaultTileProvider: {
+            DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
+            if (t.asyncTextureDataProvider) {
+                t.asyncTextureDataProvider->cancelTileIO(tileIndex);
+            }
+            break;
+        }
+        case Type::SingleImageTileProvider:
+            break;
+        case Type::SizeReferenceTileProvider:
+            break;
+        case Type::TileIndexTileProvider:
+            break;
+        case Type::ByIndexTileProvider: {
+            TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
+            const auto it = t.tileProviderMap.find(tileIndex.hashKey());
+            if (it != t.tileProviderMap.end()) {
+                cancel(*it->second, tileIndex);
+            }
+            break;
+        }
+        case Type::ByLevelTileProvider: {
+            TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
+            TileProvider* provider = levelProvider(t, tileIndex.level);
+            if (provider) {
+                cancel(*provider, tileIndex);
+            }
+            break;
+        }
+        case Type::TemporalTileProvider: {
+            // Only the current provider requests tiles for the chunks; the prefetched
+            // providers load their low-level tiles regardless of the chunks
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            if (t.successfulInitialization && t.currentTileProvider) {
+                cancel(*t.currentTileProvider, tileIndex);
+            }
+            break;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+
+
+
+
+
 int maxLevel(TileProvider& tp) {
     switch (tp.type) {
         case Type::DefaultTileProvider: {
@@ -1294,6 +1563,44 @@ float noDataValueAsFloat(TileProvider& tp) {
     }
 }
 
+std::shared_ptr<const RawTileDataReader> rawTileDataReader(TileProvider& tp, int level) {
+    switch (tp.type) {
+        case Type::DefaultTileProvider: {
+            DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
+            return t.asyncTextureDataProvider ?
+                t.asyncTextureDataProvider->sharedRawTileDataReader() :
+                nullptr;
+        }
+        case Type::SingleImageTileProvider:
+            return nullptr;
+        case Type::SizeReferenceTileProvider:
+            return nullptr;
+        case Type::TileIndexTileProvider:
+            return nullptr;
+        case Type::ByIndexTileProvider: {
+            TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
+            return rawTileDataReader(*t.defaultTileProvider, level);
+        }
+        case Type::ByLevelTileProvider: {
+            TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
+            TileProvider* provider = levelProvider(t, level);
+            return provider ? rawTileDataReader(*provider, level) : nullptr;
+        }
+        case Type::TemporalTileProvider: {
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            if (t.successfulInitialization) {
+                ensureUpdated(t);
+                return rawTileDataReader(*t.currentTileProvider, level);
+            }
+            else {
+                return nullptr;
+            }
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
 
 
 
@@ -35,6 +35,7 @@
 #include <modules/globebrowsing/src/timequantizer.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
+#include <memory>
 #include <unordered_map>
 
 struct CPLXMLNode;
@@ -49,6 +50,7 @@ namespace openspace { class PixelBuffer; }
 namespace openspace::globebrowsing {
     class AsyncTileDataProvider;
     struct RawTile;
+    class RawTileDataReader;
     struct TileIndex;
     namespace cache { class MemoryAwareTileCache; }
 } // namespace openspace::globebrowsing
@@ -158,6 +160,12 @@ struct TileProviderByLevel : public TileProvider {
  * extra tags describing the temporal properties of the dataset. See
  * <code>TemporalTileProvider::TemporalXMLTags</code>
  *
+ * One DefaultTileProvider is created per quantized time. These providers are kept in a
+ * pool that is bounded by the memory budget, which is estimated from the low-level tiles
+ * that every provider keeps loaded. The least recently used providers are removed when
+ * the budget is exceeded. Besides the provider for the current time, the providers and
+ * low-level tiles of the next quantized times in the direction in which time is moving
+ * are prepared ahead of time, so that changing to them does not stall.
  */
 struct TemporalTileProvider : public TileProvider {
     enum class TimeFormatType {
@@ -176,10 +184,21 @@ struct TemporalTileProvider : public TileProvider {
     properties::StringProperty filePath;
     std::string gdalXmlTemplate;
 
-    std::unordered_map<TimeKey, std::unique_ptr<TileProvider>> tileProviderMap;
+    struct PooledProvider {
+        std::unique_ptr<TileProvider> provider;
+        /// The last frame in which the provider was used or prefetched
+        uint64_t lastUsedFrame = 0;
+    };
+    std::unordered_map<TimeKey, PooledProvider> tileProviderMap;
+    uint64_t frame = 0;
 
     TileProvider* currentTileProvider = nullptr;
 
+    properties::IntProperty prefetchCount;
+    properties::IntProperty prefetchLevel;
+    properties::IntProperty memoryBudget;
+    properties::IntProperty nProviders;
+
     TimeFormatType timeFormat;
     TimeQuantizer timeQuantizer;
 
@@ -232,6 +251,13 @@ void update(TileProvider& tp);
  */
 void reset(TileProvider& tp);
 
+/**
+ * Cancels the reading of the tile \p tileIndex if it has been requested by this
+ * TileProvider and is still waiting to be read. This is called when the chunk that
+ * needed the tile is merged into its parent.
+ */
+void cancel(TileProvider& tp, const TileIndex& tileIndex);
+
 /**
  * \returns The maximum level as defined by <code>TileIndex</code>
  * that this TileProvider is able provide.
@@ -243,6 +269,14 @@ int maxLevel(TileProvider& tp);
  */
 float noDataValueAsFloat(TileProvider& tp);
 
+/**
+ * \returns the reader from which the tiles of the provided \p level are read, or
+ *          <code>nullptr</code> if this TileProvider does not read its tiles from a
+ *          dataset. The ownership of the reader is shared, so that it can be used on
+ *          other threads without having to synchronize with this TileProvider.
+ */
+std::shared_ptr<const RawTileDataReader> rawTileDataReader(TileProvider& tp, int level);
+
 } // namespace openspace::globebrowsing::tileprovider
 
 #endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_PROVIDER___H__
@@ -124,4 +124,8 @@ std::vector<Time> TimeQuantizer::quantized(const Time& start, const Time& end) c
     return result;
 }
 
+double TimeQuantizer::resolution() const {
+    return _resolution;
+}
+
 } // namespace openspace::globebrowsing
@@ -73,6 +73,9 @@ struct TimeQuantizer {
     */
     std::vector<Time> quantized(const Time& start, const Time& end) const;
 
+    /// Returns the distance between two quantized times in seconds
+    double resolution() const;
+
 private:
     TimeRange _timerange;
     double _resolution;
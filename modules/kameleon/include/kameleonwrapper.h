@@ -28,6 +28,7 @@
 #include <ghoul/glm.h>
 #include <glm/gtx/std_based_type.hpp>
 #include <array>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -46,6 +47,25 @@ struct LinePoint {
 
 std::array<std::string, 3> gridVariables(ccmc::Model* model);
 
+/**
+ * Returns the number of z-slabs that a volume with \p nSlices slices along the z axis
+ * should be split into for sampling. This is the number of hardware threads, but never
+ * more than the number of slices.
+ */
+size_t numSamplingSlabs(size_t nSlices);
+
+/**
+ * Splits the \p nSlices slices along the z axis into \p nSlabs contiguous slabs and
+ * calls \p sample once for each of them, concurrently on separate threads. Every call
+ * receives its own interpolator created from the \p model, the index of the slab, and
+ * the half-open range <code>[zBegin, zEnd)</code> of slices in the slab. All variables
+ * that are sampled have to be loaded into the \p model before this function is called.
+ * \p sample must not throw.
+ */
+void sampleSlabs(ccmc::Model* model, size_t nSlices, size_t nSlabs,
+    const std::function<void(ccmc::Interpolator& interpolator, size_t slab,
+        size_t zBegin, size_t zEnd)>& sample);
+
 class KameleonWrapper {
 public:
     enum class Model {
@@ -24,6 +24,7 @@
 
 #include <modules/kameleon/include/kameleonwrapper.h>
 
+#include <openspace/util/threadpool.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
@@ -31,6 +32,9 @@
 #include <ghoul/glm.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/misc.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
 
 #ifdef WIN32
 #pragma warning (push)
@@ -102,6 +106,40 @@ std::array<std::string, 3> gridVariables(ccmc::Model* model) {
     return { x, y, z };
 }
 
+size_t numSamplingSlabs(size_t nSlices) {
+    const size_t nThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::max<size_t>(std::min(nThreads, nSlices), 1);
+}
+
+void sampleSlabs(ccmc::Model* model, size_t nSlices, size_t nSlabs,
+                 const std::function<void(ccmc::Interpolator&, size_t, size_t,
+                                          size_t)>& sample)
+{
+    ghoul_assert(model, "Model must exist");
+    if (nSlices == 0) {
+        return;
+    }
+    nSlabs = std::max<size_t>(std::min(nSlabs, nSlices), 1);
+
+    // The interpolators cache the cell of the last lookup, so they can't be shared
+    // between threads
+    auto sampleSlab = [&](size_t slab) {
+        std::unique_ptr<ccmc::Interpolator> interpolator(model->createNewInterpolator());
+        const size_t zBegin = slab * nSlices / nSlabs;
+        const size_t zEnd = (slab + 1) * nSlices / nSlabs;
+        sample(*interpolator, slab, zBegin, zEnd);
+    };
+
+    if (nSlabs == 1) {
+        sampleSlab(0);
+        return;
+    }
+
+    // The calling thread works on slabs as well
+    ThreadPool pool(nSlabs - 1);
+    pool.parallelFor(0, nSlabs, sampleSlab, 1);
+}
+
 KameleonWrapper::KameleonWrapper(const std::string& filename) {
     open(filename);
 }
@@ -198,9 +236,11 @@ float* KameleonWrapper::uniformSampledValues(const std::string& var,
         _model->getVariableAttribute(var, "actual_max").getAttributeFloat();
     LDEBUG(fmt::format("{} Max: {}", var, varMax));
 
+    // The variable has to be in memory before it can be sampled from several threads.
+    _model->loadVariable(var);
+
     // HISTOGRAM
     constexpr const int NBins = 200;
-    std::vector<int> histogram(NBins, 0);
     // Explicitly mentioning the capture list provides either an error on MSVC (if NBins)
     // is not specified or a warning on Clang if it is specified. Sigh...
     auto mapToHistogram = [=](double val) {
@@ -211,90 +251,107 @@ float* KameleonWrapper::uniformSampledValues(const std::string& var,
         return glm::clamp(izerotoone, 0, NBins - 1);
     };
 
-    // ProgressBar pb(static_cast<int>(outDimensions.x));
-    for (size_t x = 0; x < outDimensions.x; ++x) {
-        for (size_t y = 0; y < outDimensions.y; ++y) {
-            for (size_t z = 0; z < outDimensions.z; ++z) {
-                const size_t index = x + y * outDimensions.x +
-                                     z * outDimensions.x * outDimensions.y;
-
-                if (_gridType == GridType::Spherical) {
-                    // Put r in the [0..sqrt(3)] range
-                    const double rNorm = glm::root_three<double>() * x /
-                                         outDimensions.x - 1;
-
-                    // Put theta in the [0..PI] range
-                    const double thetaNorm = glm::pi<double>() * y / outDimensions.y - 1;
-
-                    // Put phi in the [0..2PI] range
-                    const double phiNorm = glm::two_pi<double>() * z /
-                                           outDimensions.z - 1;
-
-                    // Go to physical coordinates before sampling
-                    const double rPh = _min.x + rNorm * (_max.x - _min.x);
-                    const double thetaPh = thetaNorm;
-                    // phi range needs to be mapped to the slightly different model
-                    // range to avoid gaps in the data Subtract a small term to
-                    // avoid rounding errors when comparing to phiMax.
-                    const double phiPh = _min.z + phiNorm /
-                                    glm::two_pi<double>() * (_max.z - _min.z - 0.000001);
-
-                    double value = 0.0;
-                    // See if sample point is inside domain
-                    if (rPh < _min.x || rPh > _max.x || thetaPh < _min.y ||
-                        thetaPh > _max.y || phiPh < _min.z || phiPh > _max.z)
-                    {
-                        if (phiPh > _max.z) {
-                            LWARNING("Warning: There might be a gap in the data");
-                        }
-                        // Leave values at zero if outside domain
-                    } else { // if inside
-                        // ENLIL CDF specific hacks!
-                        // Convert from meters to AU for interpolator
-                        const double localRPh = rPh / ccmc::constants::AU_in_meters;
-                        // Convert from colatitude [0, pi] rad to latitude [-90, 90] deg
-                        const double localThetaPh = -thetaPh * 180.f /
-                                                    glm::pi<double>() + 90.f;
-                        // Convert from [0, 2pi] rad to [0, 360] degrees
-                        const double localPhiPh = phiPh * 180.f / glm::pi<double>();
-                        // Sample
-                        value = _interpolator->interpolate(
-                            var,
-                            static_cast<float>(localRPh),
-                            static_cast<float>(localThetaPh),
-                            static_cast<float>(localPhiPh)
-                        );
-                    }
+    // Every slab is counted in its own histogram, they are merged after sampling.
+    const size_t nSlabs = numSamplingSlabs(outDimensions.z);
+    std::vector<std::vector<int>> slabHistograms(nSlabs, std::vector<int>(NBins, 0));
 
-                    doubleData[index] = value;
-                    histogram[mapToHistogram(value)]++;
+    auto sampleSlab = [&](ccmc::Interpolator& interpolator, size_t slab, size_t zBegin,
+                          size_t zEnd)
+    {
+        std::vector<int>& histogram = slabHistograms[slab];
+        for (size_t z = zBegin; z < zEnd; ++z) {
+            for (size_t y = 0; y < outDimensions.y; ++y) {
+                for (size_t x = 0; x < outDimensions.x; ++x) {
+                    const size_t index = x + y * outDimensions.x +
+                                         z * outDimensions.x * outDimensions.y;
+
+                    if (_gridType == GridType::Spherical) {
+                        // Put r in the [0..sqrt(3)] range
+                        const double rNorm = glm::root_three<double>() * x /
+                                             outDimensions.x - 1;
 
-                } else {
-                    // Assume cartesian for fallback purpose
-                    const double stepX = (_max.x - _min.x) /
-                                         (static_cast<double>(outDimensions.x));
-                    const double stepY = (_max.y - _min.y) /
-                                         (static_cast<double>(outDimensions.y));
-                    const double stepZ = (_max.z - _min.z) /
-                                         (static_cast<double>(outDimensions.z));
+                        // Put theta in the [0..PI] range
+                        const double thetaNorm = glm::pi<double>() * y /
+                                                 outDimensions.y - 1;
 
-                    const double xPos = _min.x + stepX * x;
-                    const double yPos = _min.y + stepY * y;
-                    const double zPos = _min.z + stepZ * z;
+                        // Put phi in the [0..2PI] range
+                        const double phiNorm = glm::two_pi<double>() * z /
+                                               outDimensions.z - 1;
 
-                    // get interpolated data value for (xPos, yPos, zPos)
-                    // swap yPos and zPos because model has Z as up
-                    double value = _interpolator->interpolate(
-                        var,
-                        static_cast<float>(xPos),
-                        static_cast<float>(zPos),
-                        static_cast<float>(yPos)
-                    );
-                    doubleData[index] = value;
-                    histogram[mapToHistogram(value)]++;
+                        // Go to physical coordinates before sampling
+                        const double rPh = _min.x + rNorm * (_max.x - _min.x);
+                        const double thetaPh = thetaNorm;
+                        // phi range needs to be mapped to the slightly different model
+                        // range to avoid gaps in the data Subtract a small term to
+                        // avoid rounding errors when comparing to phiMax.
+                        const double phiPh = _min.z + phiNorm / glm::two_pi<double>() *
+                                             (_max.z - _min.z - 0.000001);
+
+                        double value = 0.0;
+                        // See if sample point is inside domain
+                        if (rPh < _min.x || rPh > _max.x || thetaPh < _min.y ||
+                            thetaPh > _max.y || phiPh < _min.z || phiPh > _max.z)
+                        {
+                            if (phiPh > _max.z) {
+                                LWARNING("Warning: There might be a gap in the data");
+                            }
+                            // Leave values at zero if outside domain
+                        } else { // if inside
+                            // ENLIL CDF specific hacks!
+                            // Convert from meters to AU for interpolator
+                            const double localRPh = rPh / ccmc::constants::AU_in_meters;
+                            // Convert from colatitude [0, pi] rad to [-90, 90] deg
+                            const double localThetaPh = -thetaPh * 180.f /
+                                                        glm::pi<double>() + 90.f;
+                            // Convert from [0, 2pi] rad to [0, 360] degrees
+                            const double localPhiPh = phiPh * 180.f / glm::pi<double>();
+                            // Sample
+                            value = interpolator.interpolate(
+                                var,
+                                static_cast<float>(localRPh),
+                                static_cast<float>(localThetaPh),
+                                static_cast<float>(localPhiPh)
+                            );
+                        }
+
+                        doubleData[index] = value;
+                        histogram[mapToHistogram(value)]++;
+
+                    } else {
+                        // Assume cartesian for fallback purpose
+                        const double stepX = (_max.x - _min.x) /
+                                             (static_cast<double>(outDimensions.x));
+                        const double stepY = (_max.y - _min.y) /
+                                             (static_cast<double>(outDimensions.y));
+                        const double stepZ = (_max.z - _min.z) /
+                                             (static_cast<double>(outDimensions.z));
+
+                        const double xPos = _min.x + stepX * x;
+                        const double yPos = _min.y + stepY * y;
+                        const double zPos = _min.z + stepZ * z;
+
+                        // get interpolated data value for (xPos, yPos, zPos)
+                        // swap yPos and zPos because model has Z as up
+                        double value = interpolator.interpolate(
+                            var,
+                            static_cast<float>(xPos),
+                            static_cast<float>(zPos),
+                            static_cast<float>(yPos)
+                        );
+                        doubleData[index] = value;
+                        histogram[mapToHistogram(value)]++;
+                    }
                 }
             }
         }
+    };
+    sampleSlabs(_model, outDimensions.z, nSlabs, sampleSlab);
+
+    std::vector<int> histogram(NBins, 0);
+    for (const std::vector<int>& slabHistogram : slabHistograms) {
+        for (int i = 0; i < NBins; ++i) {
+            histogram[i] += slabHistogram[i];
+        }
     }
 
     int sum = 0;
@@ -340,7 +397,6 @@ float* KameleonWrapper::uniformSliceValues(const std::string& var,
 
     const size_t size = outDimensions.x * outDimensions.y * outDimensions.z;
     float* data = new float[size];
-    std::vector<double> doubleData(size);
 
     _model->loadVariable(var);
 
@@ -364,24 +420,22 @@ float* KameleonWrapper::uniformSliceValues(const std::string& var,
     LDEBUG(fmt::format("{} min: {}", var, varMin));
     LDEBUG(fmt::format("{} max: {}", var, varMax));
 
-    //double maxValue = 0.0;
-    //double minValue = std::numeric_limits<double>::max();
+    const float missingValue = _model->getMissingValue();
 
-    float missingValue = _model->getMissingValue();
-
-    for (size_t x = 0; x < outDimensions.x; ++x) {
-        for (size_t y = 0; y < outDimensions.y; ++y) {
-            for(size_t z = 0; z < outDimensions.z; ++z){
-
-                const float xi = (hasXSlice) ? slice : x;
-                const float yi = (hasYSlice) ? slice : y;
-                const float zi = (hasZSlice) ? slice : z;
-
-                double value = 0;
-                const size_t index = x + y * outDimensions.x +
-                                     z * outDimensions.x * outDimensions.y;
-                if (_gridType == GridType::Spherical) {
-                        // int z = zSlice;
+    auto sampleSlab = [&](ccmc::Interpolator& interpolator, size_t, size_t zBegin,
+                          size_t zEnd)
+    {
+        for (size_t z = zBegin; z < zEnd; ++z) {
+            for (size_t y = 0; y < outDimensions.y; ++y) {
+                for (size_t x = 0; x < outDimensions.x; ++x) {
+                    const float xi = (hasXSlice) ? slice : x;
+                    const float yi = (hasYSlice) ? slice : y;
+                    const float zi = (hasZSlice) ? slice : z;
+
+                    double value = 0;
+                    const size_t index = x + y * outDimensions.x +
+                                         z * outDimensions.x * outDimensions.y;
+                    if (_gridType == GridType::Spherical) {
                         // Put r in the [0..sqrt(3)] range
                         const double rNorm = glm::root_three<double>() * xi / xDim;
 
@@ -418,37 +472,35 @@ float* KameleonWrapper::uniformSliceValues(const std::string& var,
                             // Convert from [0, 2pi] rad to [0, 360] degrees
                             const double localPhiPh = phiPh * 180.f / glm::pi<double>();
                             // Sample
-                            value = _interpolator->interpolate(
+                            value = interpolator.interpolate(
                                 var,
                                 static_cast<float>(localRPh),
                                 static_cast<float>(localPhiPh),
                                 static_cast<float>(localThetaPh)
                             );
                         }
+                    } else {
+                        const double xPos = _min.x + stepX * xi;
+                        const double yPos = _min.y + stepY * yi;
+                        const double zPos = _min.z + stepZ * zi;
 
-                } else {
-                    const double xPos = _min.x + stepX * xi;
-                    const double yPos = _min.y + stepY * yi;
-                    const double zPos = _min.z + stepZ * zi;
-
-                    // std::cout << zPos << ", " << zpos << std::endl;
-                    // Should y and z be flipped?
-                    value = _interpolator->interpolate(
-                        var,
-                        static_cast<float>(xPos),
-                        static_cast<float>(zPos),
-                        static_cast<float>(yPos));
-                }
+                        // Should y and z be flipped?
+                        value = interpolator.interpolate(
+                            var,
+                            static_cast<float>(xPos),
+                            static_cast<float>(zPos),
+                            static_cast<float>(yPos)
+                        );
+                    }
 
-                if (value != missingValue) {
-                    doubleData[index] = value;
-                    data[index] = static_cast<float>(value);
-                } else {
-                    doubleData[index] = 0;
+                    data[index] = (value != missingValue) ?
+                                  static_cast<float>(value) :
+                                  0.f;
                 }
             }
         }
-    }
+    };
+    sampleSlabs(_model, outDimensions.z, numSamplingSlabs(outDimensions.z), sampleSlab);
 
     return data;
 }
@@ -471,6 +523,11 @@ float* KameleonWrapper::uniformSampledVectorValues(const std::string& xVar,
     const size_t size = NumChannels * outDimensions.x * outDimensions.y * outDimensions.z;
     float* data = new float[size];
 
+    if (_gridType != GridType::Cartesian) {
+        LERROR("Only cartesian grid supported for uniformSampledVectorValues (for now)");
+        return data;
+    }
+
     float varXMin = _model->getVariableAttribute(xVar, "actual_min").getAttributeFloat();
     float varXMax = _model->getVariableAttribute(xVar, "actual_max").getAttributeFloat();
     float varYMin = _model->getVariableAttribute(yVar, "actual_min").getAttributeFloat();
@@ -482,30 +539,27 @@ float* KameleonWrapper::uniformSampledVectorValues(const std::string& xVar,
     const float stepY = (_max.y - _min.y) / (static_cast<float>(outDimensions.y));
     const float stepZ = (_max.z - _min.z) / (static_cast<float>(outDimensions.z));
 
-    //LDEBUG(xVar << "Min: " << varXMin);
-    //LDEBUG(xVar << "Max: " << varXMax);
-    //LDEBUG(yVar << "Min: " << varYMin);
-    //LDEBUG(yVar << "Max: " << varYMax);
-    //LDEBUG(zVar << "Min: " << varZMin);
-    //LDEBUG(zVar << "Max: " << varZMax);
-
-    //ProgressBar pb(static_cast<int>(outDimensions.x));
-    for (size_t x = 0; x < outDimensions.x; ++x) {
-        //pb.print(x);
-        for (size_t y = 0; y < outDimensions.y; ++y) {
-            for (size_t z = 0; z < outDimensions.z; ++z) {
-                const size_t index = x * NumChannels + y * NumChannels * outDimensions.x +
-                                     z * NumChannels * outDimensions.x * outDimensions.y;
-
-                if (_gridType == GridType::Cartesian) {
+    _model->loadVariable(xVar);
+    _model->loadVariable(yVar);
+    _model->loadVariable(zVar);
+
+    auto sampleSlab = [&](ccmc::Interpolator& interpolator, size_t, size_t zBegin,
+                          size_t zEnd)
+    {
+        for (size_t z = zBegin; z < zEnd; ++z) {
+            for (size_t y = 0; y < outDimensions.y; ++y) {
+                for (size_t x = 0; x < outDimensions.x; ++x) {
+                    const size_t index = NumChannels * (x + y * outDimensions.x +
+                                         z * outDimensions.x * outDimensions.y);
+
                     const float xPos = _min.x + stepX * x;
                     const float yPos = _min.y + stepY * y;
                     const float zPos = _min.z + stepZ * z;
 
                     // get interpolated data value for (xPos, yPos, zPos)
-                    const float xVal = _interpolator->interpolate(xVar, xPos, yPos, zPos);
-                    const float yVal = _interpolator->interpolate(yVar, xPos, yPos, zPos);
-                    const float zVal = _interpolator->interpolate(zVar, xPos, yPos, zPos);
+                    const float xVal = interpolator.interpolate(xVar, xPos, yPos, zPos);
+                    const float yVal = interpolator.interpolate(yVar, xPos, yPos, zPos);
+                    const float zVal = interpolator.interpolate(zVar, xPos, yPos, zPos);
 
                     // scale to [0,1]
                     data[index]     = (xVal - varXMin) / (varXMax - varXMin); // R
@@ -513,16 +567,11 @@ float* KameleonWrapper::uniformSampledVectorValues(const std::string& xVar,
                     data[index + 2] = (zVal - varZMin) / (varZMax - varZMin); // B
                     // GL_RGB refuses to work. Workaround doing a GL_RGBA  hardcoded alpha
                     data[index + 3] = 1.f;
-                } else {
-                    LERROR(
-                        "Only cartesian grid supported for "
-                        "uniformSampledVectorValues (for now)"
-                    );
-                    return data;
                 }
             }
         }
-    }
+    };
+    sampleSlabs(_model, outDimensions.z, numSamplingSlabs(outDimensions.z), sampleSlab);
 
     return data;
 }
@@ -114,33 +114,81 @@ std::unique_ptr<volume::RawVolume<float>> KameleonVolumeReader::readFloatVolume(
                                                               const glm::vec3& upperBound,
                                                                           float& minValue,
                                                                     float& maxValue) const
+{
+    std::unique_ptr<volume::RawVolume<float>> volume =
+        std::make_unique<volume::RawVolume<float>>(dimensions);
+
+    readFloatSlices(
+        dimensions,
+        variable,
+        lowerBound,
+        upperBound,
+        0,
+        dimensions.z,
+        volume->data(),
+        minValue,
+        maxValue
+    );
+
+    return volume;
+}
+
+void KameleonVolumeReader::readFloatSlices(const glm::uvec3& dimensions,
+                                           const std::string& variable,
+                                           const glm::vec3& lowerBound,
+                                           const glm::vec3& upperBound,
+                                           unsigned int firstSlice, unsigned int nSlices,
+                                           float* data, float& minValue,
+                                           float& maxValue) const
 {
     minValue = std::numeric_limits<float>::max();
     maxValue = -std::numeric_limits<float>::max();
 
-    std::unique_ptr<volume::RawVolume<float>> volume =
-        std::make_unique<volume::RawVolume<float>>(dimensions);
+    // The variable has to be in memory before it can be sampled from several threads
+    _kameleon.model->loadVariable(variable);
 
-    const glm::vec3 dims = volume->dimensions();
+    const glm::vec3 dims = dimensions;
     const glm::vec3 diff = upperBound - lowerBound;
+    const size_t sliceSize = static_cast<size_t>(dimensions.x) * dimensions.y;
 
-    auto interpolate = [this](const std::string& var, const glm::vec3& coords) {
-        return _interpolator->interpolate(var, coords[0], coords[1], coords[2]);
-    };
-
-    float* data = volume->data();
-    for (size_t index = 0; index < volume->nCells(); ++index) {
-        const glm::vec3 coords = volume->indexToCoords(index);
-        const glm::vec3 coordsZeroToOne = coords / dims;
-        const glm::vec3 volumeCoords = lowerBound + diff * coordsZeroToOne;
+    const size_t nSlabs = numSamplingSlabs(nSlices);
+    std::vector<glm::vec2> slabExtremes(
+        nSlabs,
+        glm::vec2(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max())
+    );
 
-        data[index] = interpolate(variable, volumeCoords);
+    auto sampleSlab = [&](ccmc::Interpolator& interpolator, size_t slab, size_t zBegin,
+                          size_t zEnd)
+    {
+        glm::vec2& extremes = slabExtremes[slab];
+        for (size_t z = zBegin; z < zEnd; ++z) {
+            float* slice = data + z * sliceSize;
+            for (unsigned int y = 0; y < dimensions.y; ++y) {
+                for (unsigned int x = 0; x < dimensions.x; ++x) {
+                    const glm::vec3 coords(x, y, firstSlice + z);
+                    const glm::vec3 coordsZeroToOne = coords / dims;
+                    const glm::vec3 volumeCoords = lowerBound + diff * coordsZeroToOne;
+
+                    const float value = interpolator.interpolate(
+                        variable,
+                        volumeCoords[0],
+                        volumeCoords[1],
+                        volumeCoords[2]
+                    );
+                    slice[x + y * dimensions.x] = value;
+
+                    extremes.x = glm::min(extremes.x, value);
+                    extremes.y = glm::max(extremes.y, value);
+                }
+            }
+        }
+    };
+    sampleSlabs(_kameleon.model, nSlices, nSlabs, sampleSlab);
 
-        minValue = glm::min(minValue, data[index]);
-        maxValue = glm::max(maxValue, data[index]);
+    for (const glm::vec2& extremes : slabExtremes) {
+        minValue = glm::min(minValue, extremes.x);
+        maxValue = glm::max(maxValue, extremes.y);
     }
-
-    return volume;
 }
 
 std::vector<std::string> KameleonVolumeReader::variableNames() const {
@@ -62,6 +62,17 @@ public:
         const glm::vec3& lowerBound, const glm::vec3& upperBound, float& minValue,
         float& maxValue) const;
 
+    /**
+     * Samples the slices <code>[firstSlice, firstSlice + nSlices)</code> along the z axis
+     * of a volume with the provided \p dimensions into \p data, which has to hold
+     * <code>dimensions.x * dimensions.y * nSlices</code> values. The slices are sampled
+     * in parallel. \p minValue and \p maxValue are set to the extremes of the sampled
+     * values.
+     */
+    void readFloatSlices(const glm::uvec3& dimensions, const std::string& variable,
+        const glm::vec3& lowerBound, const glm::vec3& upperBound, unsigned int firstSlice,
+        unsigned int nSlices, float* data, float& minValue, float& maxValue) const;
+
     ghoul::Dictionary readMetaData() const;
 
     std::string time() const;
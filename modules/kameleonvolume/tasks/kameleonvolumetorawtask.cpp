@@ -24,6 +24,7 @@
 
 #include <modules/kameleonvolume/tasks/kameleonvolumetorawtask.h>
 
+#include <modules/kameleon/include/kameleonwrapper.h>
 #include <modules/kameleonvolume/kameleonvolumereader.h>
 #include <modules/volume/rawvolumewriter.h>
 #include <openspace/documentation/verifier.h>
@@ -164,19 +165,31 @@ void KameleonVolumeToRawTask::perform(const Task::ProgressCallback& progressCall
         );
     }
 
-    std::unique_ptr<volume::RawVolume<float>> rawVolume = reader.readFloatVolume(
-        _dimensions,
-        _variable,
-        _lowerDomainBound,
-        _upperDomainBound
-    );
-
-    progressCallback(0.5f);
+    // Sample and write a few slabs worth of slices at a time so that the whole volume
+    // never has to be kept in memory
+    const unsigned int slicesPerGroup =
+        static_cast<unsigned int>(numSamplingSlabs(_dimensions.z) * 4);
 
     volume::RawVolumeWriter<float> writer(_rawVolumeOutputPath);
-    writer.write(*rawVolume);
-
-    progressCallback(0.9f);
+    writer.setDimensions(_dimensions);
+    writer.writeSlices(
+        [&](unsigned int firstSlice, unsigned int nSlices, float* buffer) {
+            float minValue, maxValue;
+            reader.readFloatSlices(
+                _dimensions,
+                _variable,
+                _lowerDomainBound,
+                _upperDomainBound,
+                firstSlice,
+                nSlices,
+                buffer,
+                minValue,
+                maxValue
+            );
+        },
+        slicesPerGroup,
+        [&progressCallback](float t) { progressCallback(0.9f * t); }
+    );
 
     ghoul::Dictionary inputMetadata = reader.readMetaData();
     ghoul::Dictionary outputMetadata;
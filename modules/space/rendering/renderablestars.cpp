@@ -31,7 +31,6 @@
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/renderengine.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/templatefactory.h>
@@ -39,9 +38,9 @@
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
 #include <array>
 #include <cstdint>
-#include <fstream>
 #include <iostream>
 #include <limits>
 #include <type_traits>
@@ -61,7 +60,7 @@ namespace {
         "filterOutOfRange"
     };
 
-    constexpr int8_t CurrentCacheVersion = 3;
+    constexpr int8_t CurrentCacheVersion = 4;
 
     constexpr const int RenderOptionPointSpreadFunction = 0;
     constexpr const int RenderOptionTexture = 1;
@@ -276,6 +275,25 @@ namespace {
         "Beta",
         "Moffat's Beta Constant."
     };
+
+    // Normalizes the luminosity of all stars into the range [0, 1]
+    void normalizeLuminosity(openspace::speck::Dataset& dataset) {
+        const int lum = dataset.index("lum");
+        if (lum < 0 || dataset.nRows() == 0) {
+            return;
+        }
+
+        std::vector<float>& luminosity = dataset.columns[lum];
+        const auto [minLum, maxLum] = std::minmax_element(
+            luminosity.begin(),
+            luminosity.end()
+        );
+        const float minLumValue = *minLum;
+        const float maxLumValue = *maxLum;
+        for (float& l : luminosity) {
+            l = (l - minLumValue) / (maxLumValue - minLumValue);
+        }
+    }
 }  // namespace
 
 namespace openspace {
@@ -887,7 +905,7 @@ void RenderableStars::renderPSFToTexture() {
 }
 
 void RenderableStars::render(const RenderData& data, RendererTasks&) {
-    if (_fullData.empty()) {
+    if (!_dataset || _dataset->nRows() == 0) {
         return;
     }
 
@@ -986,7 +1004,7 @@ void RenderableStars::render(const RenderData& data, RendererTasks&) {
 
 
     glBindVertexArray(_vao);
-    const GLsizei nStars = static_cast<GLsizei>(_fullData.size() / _nValuesPerStar);
+    const GLsizei nStars = static_cast<GLsizei>(_dataset->nRows());
     glDrawArrays(GL_POINTS, 0, nStars);
 
     glBindVertexArray(0);
@@ -1008,7 +1026,7 @@ void RenderableStars::update(const UpdateData&) {
         _dataIsDirty = true;
     }
 
-    if (_fullData.empty()) {
+    if (!_dataset || _dataset->nRows() == 0) {
         return;
     }
 
@@ -1041,7 +1059,7 @@ void RenderableStars::update(const UpdateData&) {
             "in_bvLumAbsMagAppMag"
         );
 
-        const size_t nStars = _fullData.size() / _nValuesPerStar;
+        const size_t nStars = _dataset->nRows();
         const size_t nValues = _slicedData.size() / nStars;
 
         GLsizei stride = static_cast<GLsizei>(sizeof(GLfloat) * nValues);
@@ -1277,240 +1295,40 @@ void RenderableStars::loadData() {
         return;
     }
 
-    std::string cachedFile = FileSys.cacheManager()->cachedFilename(
-        _file,
-        ghoul::filesystem::CacheManager::Persistent::Yes
-    );
-
-    _nValuesPerStar = 0;
     _slicedData.clear();
-    _fullData.clear();
+    _dataset = nullptr;
     _dataNames.clear();
 
-    bool hasCachedFile = FileSys.fileExists(cachedFile);
-    if (hasCachedFile) {
-        LINFO(fmt::format("Cached file '{}' used for Speck file '{}'",
-            cachedFile, _file
-        ));
-
-        bool success = loadCachedFile(cachedFile);
-        if (success) {
-            return;
-        }
-        else {
-            FileSys.cacheManager()->removeCacheFile(_file);
-            // Intentional fall-through to the 'else' computation to generate the cache
-            // file for the next run
-        }
-    }
-    else {
-        LINFO(fmt::format("Cache for Speck file '{}' not found", _file));
-    }
-    LINFO(fmt::format("Loading Speck file '{}'", _file));
-
-    readSpeckFile();
-
-    LINFO("Saving cache");
-    saveCachedFile(cachedFile);
-}
-
-void RenderableStars::readSpeckFile() {
-    std::string _file = _speckFile;
-    std::ifstream file(_file);
-    if (!file.good()) {
-        LERROR(fmt::format("Failed to open Speck file '{}'", _file));
-        return;
-    }
-
-    // The beginning of the speck file has a header that either contains comments
-    // (signaled by a preceding '#') or information about the structure of the file
-    // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line);
-
-        if (line[0] == '#' || line.empty()) {
-            continue;
-        }
-
-        if (line.substr(0, 7) != "datavar" &&
-            line.substr(0, 10) != "texturevar" &&
-            line.substr(0, 7) != "texture")
-        {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
-            if (_enableTestGrid) {
-                file.seekg(position - std::streamoff(8));
-            }
-            else {
-                file.seekg(position);
-            }
-            break;
-        }
-
-        if (line.substr(0, 7) == "datavar") {
-            // datavar lines are structured as follows:
-            // datavar # description
-            // where # is the index of the data variable; so if we repeatedly overwrite
-            // the 'nValues' variable with the latest index, we will end up with the total
-            // number of values (+3 since X Y Z are not counted in the Speck file index)
-            std::stringstream str(line);
-
-            std::string dummy;
-            str >> dummy;
-            str >> _nValuesPerStar;
-
-            std::string name;
-            str >> name;
-            _dataNames.push_back(name);
-
-            // +3 because the position x, y, z
-            if (name == "lum") {
-                _lumArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "absmag") {
-                _absMagArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "appmag") {
-                _appMagArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "colorb_v") {
-                _bvColorArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "vx") {
-                _velocityArrayPos = _nValuesPerStar + 3;
-            }
-            else if (name == "speed") {
-                _speedArrayPos = _nValuesPerStar + 3;
-            }
-            _nValuesPerStar += 1; // We want the number, but the index is 0 based
-        }
-    }
-
-    _nValuesPerStar += 3; // X Y Z are not counted in the Speck file indices
-    _otherDataOption.addOptions(_dataNames);
-
-    float minLumValue = std::numeric_limits<float>::max();
-    float maxLumValue = std::numeric_limits<float>::min();
-
-    do {
-        std::vector<float> values(_nValuesPerStar);
-
-        std::getline(file, line);
-        std::stringstream str(line);
-
-        for (int i = 0; i < _nValuesPerStar; ++i) {
-            str >> values[i];
-        }
-        bool nullArray = true;
-        for (float v : values) {
-            if (v != 0.0) {
-                nullArray = false;
-                break;
-            }
-        }
-        minLumValue = values[_lumArrayPos] < minLumValue ?
-            values[_lumArrayPos] : minLumValue;
-        maxLumValue = values[_lumArrayPos] > maxLumValue ?
-            values[_lumArrayPos] : maxLumValue;
-        if (!nullArray) {
-            _fullData.insert(_fullData.end(), values.begin(), values.end());
-        }
-    } while (!file.eof());
-
-    // Normalize Luminosity:
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        _fullData[i + _lumArrayPos] =
-            (_fullData[i + _lumArrayPos] - minLumValue) / (maxLumValue - minLumValue);
-    }
-}
-
-bool RenderableStars::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed: deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(file);
-            return false;
-        }
-
-        int32_t nValues = 0;
-        fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_nValuesPerStar), sizeof(int32_t));
-
-        fileStream.read(reinterpret_cast<char*>(&_lumArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_absMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_appMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_bvColorArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_velocityArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_speedArrayPos), sizeof(int32_t));
-
-        for (int i = 0; i < _nValuesPerStar - 3; ++i) {
-            uint16_t len;
-            fileStream.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-            std::vector<char> buffer(len);
-            fileStream.read(buffer.data(), len);
-            std::string value(buffer.begin(), buffer.end());
-            _dataNames.push_back(value);
-        }
-        _otherDataOption.addOptions(_dataNames);
-
-        _fullData.resize(nValues);
-        fileStream.read(reinterpret_cast<char*>(
-            _fullData.data()),
-            nValues * sizeof(_fullData[0])
+    try {
+        _dataset = speck::loadCachedFile(
+            _file,
+            "RenderableStars",
+            CurrentCacheVersion,
+            speck::SkipAllZeroRows::Yes,
+            normalizeLuminosity
         );
-
-        bool success = fileStream.good();
-        return success;
-    }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
-        return false;
     }
-}
-
-void RenderableStars::saveCachedFile(const std::string& file) const {
-    std::ofstream fileStream(file, std::ofstream::binary);
-
-    if (!fileStream.good()) {
-        LERROR(fmt::format("Error opening file '{}' for save cache file", file));
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
         return;
     }
 
-    fileStream.write(
-        reinterpret_cast<const char*>(&CurrentCacheVersion),
-        sizeof(int8_t)
-    );
-
-    int32_t nValues = static_cast<int32_t>(_fullData.size());
-    if (nValues == 0) {
-        throw ghoul::RuntimeError("Error writing cache: No values were loaded");
-    }
-    fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
-
-    int32_t nValuesPerStar = static_cast<int32_t>(_nValuesPerStar);
-    fileStream.write(reinterpret_cast<const char*>(&nValuesPerStar), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_lumArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_absMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_appMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_bvColorArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_velocityArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_speedArrayPos), sizeof(int32_t));
-
-    // -3 as we don't want to save the xyz values that are in the beginning of the file
-    for (int i = 0; i < _nValuesPerStar - 3; ++i) {
-        uint16_t len = static_cast<uint16_t>(_dataNames[i].size());
-        fileStream.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        fileStream.write(_dataNames[i].c_str(), len);
+    for (const speck::Dataset::Variable& variable : _dataset->variables()) {
+        _dataNames.push_back(variable.name);
     }
+    _otherDataOption.addOptions(_dataNames);
 
-    size_t nBytes = nValues * sizeof(_fullData[0]);
-    fileStream.write(reinterpret_cast<const char*>(_fullData.data()), nBytes);
+    // The indices already include the x, y, z position. Variables that are missing from
+    // the file keep pointing at the first column, as they did before
+    auto arrayPosition = [this](std::string_view name) -> size_t {
+        return static_cast<size_t>(std::max(_dataset->index(name), 0));
+    };
+    _lumArrayPos = arrayPosition("lum");
+    _absMagArrayPos = arrayPosition("absmag");
+    _appMagArrayPos = arrayPosition("appmag");
+    _bvColorArrayPos = arrayPosition("colorb_v");
+    _velocityArrayPos = arrayPosition("vx");
+    _speedArrayPos = arrayPosition("speed");
 }
 
 void RenderableStars::createDataSlice(ColorOption option) {
@@ -1521,12 +1339,40 @@ void RenderableStars::createDataSlice(ColorOption option) {
         -std::numeric_limits<float>::max()
     );
 
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        glm::vec3 position = glm::vec3(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2]
-        );
+    // Only the columns that are needed for the selected option are accessed, the pages
+    // of all other columns of the memory-mapped dataset are never touched
+    const speck::CachedDataset& d = *_dataset;
+    auto column = [&d](size_t index) { return d.column(index).values; };
+    const float* x = column(0);
+    const float* y = column(1);
+    const float* z = column(2);
+    const float* bvColor = column(_bvColorArrayPos);
+    const float* lum = column(_lumArrayPos);
+    const float* absMag = column(_absMagArrayPos);
+    const float* appMag = column(_appMagArrayPos);
+    const float* vx = nullptr;
+    const float* vy = nullptr;
+    const float* vz = nullptr;
+    const float* speed = nullptr;
+    const float* otherData = nullptr;
+    switch (option) {
+        case ColorOption::Velocity:
+            vx = column(_velocityArrayPos);
+            vy = column(_velocityArrayPos + 1);
+            vz = column(_velocityArrayPos + 2);
+            break;
+        case ColorOption::Speed:
+            speed = column(_speedArrayPos);
+            break;
+        case ColorOption::OtherData:
+            otherData = column(d.variables()[_otherDataOption.value()].index);
+            break;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < d.nRows(); ++i) {
+        glm::vec3 position = glm::vec3(x[i], y[i], z[i]);
         position *= openspace::distanceconstants::Parsec;
 
         switch (option) {
@@ -1541,15 +1387,15 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 if (_enableTestGrid) {
                     float sunColor = 0.650f;
-                    layout.value.value = sunColor;// _fullData[i + 3];
+                    layout.value.value = sunColor;
                 }
                 else {
-                    layout.value.value = _fullData[i + _bvColorArrayPos];
+                    layout.value.value = bvColor[i];
                 }
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1567,14 +1413,14 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = bvColor[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
-                layout.value.vx = _fullData[i + _velocityArrayPos];
-                layout.value.vy = _fullData[i + _velocityArrayPos + 1];
-                layout.value.vz = _fullData[i + _velocityArrayPos + 2];
+                layout.value.vx = vx[i];
+                layout.value.vy = vy[i];
+                layout.value.vz = vz[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1592,12 +1438,12 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = bvColor[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
-                layout.value.speed = _fullData[i + _speedArrayPos];
+                layout.value.speed = speed[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1615,9 +1461,7 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                int index = _otherDataOption.value();
-                // plus 3 because of the position
-                layout.value.value = _fullData[i + index + 3];
+                layout.value.value = otherData[i];
 
                 if (_staticFilterValue.has_value() &&
                     layout.value.value == _staticFilterValue)
@@ -1632,9 +1476,9 @@ void RenderableStars::createDataSlice(ColorOption option) {
                 _otherDataRange.setMinValue(glm::vec2(range.x));
                 _otherDataRange.setMaxValue(glm::vec2(range.y));
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
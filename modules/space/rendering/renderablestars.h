@@ -33,6 +33,7 @@
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/propertyowner.h>
 #include <openspace/properties/vector/vec2property.h>
+#include <openspace/util/speckcache.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <optional>
@@ -80,9 +81,6 @@ private:
     void createDataSlice(ColorOption option);
 
     void loadData();
-    void readSpeckFile();
-    bool loadCachedFile(const std::string& file);
-    void saveCachedFile(const std::string& file) const;
 
     properties::StringProperty _speckFile;
 
@@ -144,9 +142,8 @@ private:
     bool _enableTestGrid = false;
 
     std::vector<float> _slicedData;
-    std::vector<float> _fullData;
+    std::unique_ptr<speck::CachedDataset> _dataset;
 
-    int _nValuesPerStar = 0;
     std::string _queuedOtherData;
     std::vector<std::string> _dataNames;
 
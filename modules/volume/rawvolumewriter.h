@@ -44,6 +44,18 @@ public:
                const std::function<void(float)>& onProgress = [](float) {});
     void write(const RawVolume<VoxelType>& volume);
 
+    /**
+     * Writes the volume in groups of at most \p slicesPerGroup slices along the z axis,
+     * so that only a single group has to be kept in memory. \p fn is called once per
+     * group, in order, with the first slice of the group, the number of slices in it, and
+     * a buffer of <code>dimensions().x * dimensions().y * nSlices</code> voxels that it
+     * has to fill.
+     */
+    void writeSlices(const std::function<void(unsigned int firstSlice,
+                         unsigned int nSlices, VoxelType* buffer)>& fn,
+                     unsigned int slicesPerGroup,
+                     const std::function<void(float)>& onProgress = [](float) {});
+
     size_t coordsToIndex(const glm::uvec3& coords) const;
     glm::ivec3 indexToCoords(size_t linear) const;
 
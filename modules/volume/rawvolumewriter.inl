@@ -25,6 +25,7 @@
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/volumeutils.h>
 #include <ghoul/misc/exception.h>
+#include <algorithm>
 #include <fstream>
 
 namespace openspace::volume {
@@ -106,4 +107,32 @@ void RawVolumeWriter<VoxelType>::write(const RawVolume<VoxelType>& volume) {
     file.close();
 }
 
+template <typename VoxelType>
+void RawVolumeWriter<VoxelType>::writeSlices(
+                   const std::function<void(unsigned int, unsigned int, VoxelType*)>& fn,
+                                                              unsigned int slicesPerGroup,
+                                           const std::function<void(float t)>& onProgress)
+{
+    const glm::uvec3 dims = dimensions();
+    const size_t sliceSize = static_cast<size_t>(dims.x) * static_cast<size_t>(dims.y);
+    slicesPerGroup = std::max(std::min(slicesPerGroup, dims.z), 1u);
+
+    std::ofstream file(_path, std::ios::binary);
+    if (!file.good()) {
+        throw ghoul::RuntimeError("Could not create file '" + _path + "'");
+    }
+
+    std::vector<VoxelType> buffer(sliceSize * slicesPerGroup);
+    for (unsigned int z = 0; z < dims.z; z += slicesPerGroup) {
+        const unsigned int nSlices = std::min(slicesPerGroup, dims.z - z);
+        fn(z, nSlices, buffer.data());
+        file.write(
+            reinterpret_cast<const char*>(buffer.data()),
+            sliceSize * nSlices * sizeof(VoxelType)
+        );
+        onProgress(static_cast<float>(z + nSlices) / dims.z);
+    }
+    file.close();
+}
+
 } // namespace openspace::volume
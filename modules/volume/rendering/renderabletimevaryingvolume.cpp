@@ -30,19 +30,27 @@
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/rawvolumereader.h>
 #include <modules/volume/volumegridtype.h>
+#include <modules/volume/volumeutils.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/raycastermanager.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/histogram.h>
+#include <openspace/util/job.h>
 #include <openspace/util/time.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
 #include <ghoul/opengl/texture.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableTimeVaryingVolume";
@@ -58,9 +66,15 @@ namespace {
     const char* KeyClipPlanes = "ClipPlanes";
     const char* KeySecondsBefore = "SecondsBefore";
     const char* KeySecondsAfter = "SecondsAfter";
+    const char* KeyStreaming = "Streaming";
+    const char* KeyMemoryBudget = "MemoryBudget";
 
     const float SecondsInOneDay = 60 * 60 * 24;
     constexpr const float VolumeMaxOpacity = 500;
+    constexpr const int DefaultMemoryBudget = 2048; // MB
+    // The number of timesteps behind the current one that are kept resident when
+    // streaming so that a small step backwards in time does not cause a reload
+    constexpr const int TimestepsBehind = 1;
 
     static const openspace::properties::Property::PropertyInfo StepSizeInfo = {
         "stepSize",
@@ -127,11 +141,102 @@ namespace {
         "Radius upper bound",
         "" // @TODO Missing documentation
     };
+
+    constexpr openspace::properties::Property::PropertyInfo MemoryBudgetInfo = {
+        "memoryBudget",
+        "Memory budget (MB)",
+        "The maximum amount of memory, in megabytes, that the timesteps which are "
+        "resident when streaming are allowed to use. Each resident timestep occupies "
+        "this amount in main memory and the same amount on the GPU. The current "
+        "timestep is always loaded, even if it alone exceeds the budget."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchTimeInfo = {
+        "prefetchTime",
+        "Prefetch time (s)",
+        "When streaming, all timesteps that will be reached within this many seconds "
+        "of wall-clock time with the current delta time are loaded ahead of time, as "
+        "far as the memory budget allows."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ResidentMemoryInfo = {
+        "residentMemory",
+        "Resident memory (MB)",
+        "The amount of main memory, in megabytes, that is currently used by the "
+        "resident timesteps."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NResidentTimestepsInfo = {
+        "nResidentTimesteps",
+        "Resident timesteps",
+        "The number of timesteps that are currently resident on the GPU."
+    };
+
+    size_t timestepBytes(const glm::uvec3& dimensions) {
+        return static_cast<size_t>(dimensions.x) * static_cast<size_t>(dimensions.y) *
+               static_cast<size_t>(dimensions.z) * sizeof(float);
+    }
 } // namespace
 
 namespace openspace::volume {
 
-    documentation::Documentation RenderableTimeVaryingVolume::Documentation() {
+/**
+ * Reads a single timestep from disk, normalizes its values into [0, 1] and builds its
+ * histogram. A job that was cancelled before it started does nothing and produces an
+ * empty volume.
+ */
+struct RenderableTimeVaryingVolume::TimestepLoadJob
+    : public Job<RenderableTimeVaryingVolume::LoadedTimestep>
+{
+    TimestepLoadJob(std::string path, RawVolumeMetadata metadata)
+        : _path(std::move(path))
+        , _metadata(std::move(metadata))
+    {
+        _loaded.time = _metadata.time;
+    }
+
+    void execute() override {
+        if (cancelled) {
+            return;
+        }
+
+        try {
+            RawVolumeReader<float> reader(_path, _metadata.dimensions);
+            std::shared_ptr<RawVolume<float>> volume = reader.read();
+
+            const float min = _metadata.minValue;
+            const float diff = _metadata.maxValue - _metadata.minValue;
+            float* data = volume->data();
+            for (size_t i = 0; i < volume->nCells(); ++i) {
+                data[i] = glm::clamp((data[i] - min) / diff, 0.f, 1.f);
+            }
+
+            // TODO: handle normalization properly for different timesteps + transfer
+            // function
+            _loaded.histogram = std::make_shared<Histogram>(0.f, 1.f, 100);
+            for (size_t i = 0; i < volume->nCells(); ++i) {
+                _loaded.histogram->add(data[i]);
+            }
+            _loaded.rawVolume = std::move(volume);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, fmt::format("{}: '{}'", e.message, _path));
+        }
+    }
+
+    LoadedTimestep product() override {
+        return _loaded;
+    }
+
+    std::atomic_bool cancelled = false;
+
+private:
+    std::string _path;
+    RawVolumeMetadata _metadata;
+    LoadedTimestep _loaded;
+};
+
+documentation::Documentation RenderableTimeVaryingVolume::Documentation() {
     using namespace documentation;
     return {
         "RenderableTimevaryingVolume",
@@ -162,6 +267,21 @@ namespace openspace::volume {
                 Optional::No,
                 "Specifies the number of seconds to show the the last timestep after its "
                 "actual time"
+            },
+            {
+                KeyStreaming,
+                new BoolVerifier,
+                Optional::Yes,
+                "If this value is 'true', the timesteps are loaded on background threads "
+                "while the simulation time advances and only the timesteps around the "
+                "current time are kept in memory. Otherwise, all timesteps are loaded "
+                "during initialization. The default value is 'false'."
+            },
+            {
+                KeyMemoryBudget,
+                new IntVerifier,
+                Optional::Yes,
+                MemoryBudgetInfo.description
             }
         }
     };
@@ -181,6 +301,10 @@ RenderableTimeVaryingVolume::RenderableTimeVaryingVolume(
     , _triggerTimeJump(TriggerTimeJumpInfo)
     , _jumpToTimestep(JumpToTimestepInfo, 0, 0, 256)
     , _currentTimestep(CurrentTimeStepInfo, 0, 0, 256)
+    , _memoryBudget(MemoryBudgetInfo, DefaultMemoryBudget, 64, 65536)
+    , _prefetchTime(PrefetchTimeInfo, 2.f, 0.f, 30.f)
+    , _residentMemory(ResidentMemoryInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _nResidentTimesteps(NResidentTimestepsInfo, 0, 0, 256)
 {
     documentation::testSpecificationAndThrow(
         Documentation(),
@@ -223,6 +347,14 @@ RenderableTimeVaryingVolume::RenderableTimeVaryingVolume(
         _gridType = static_cast<std::underlying_type_t<VolumeGridType>>(gridType);
     }
 
+    if (dictionary.hasKeyAndValue<bool>(KeyStreaming)) {
+        _isStreaming = dictionary.value<bool>(KeyStreaming);
+    }
+
+    if (dictionary.hasKeyAndValue<double>(KeyMemoryBudget)) {
+        _memoryBudget = static_cast<int>(dictionary.value<double>(KeyMemoryBudget));
+    }
+
     addProperty(_opacity);
 }
 
@@ -249,43 +381,26 @@ void RenderableTimeVaryingVolume::initializeGL() {
         }
     }
 
-    // TODO: defer loading of data to later (separate thread or at least not when loading)
+    _orderedTimesteps.clear();
+    _orderedTimesteps.reserve(_volumeTimesteps.size());
     for (std::pair<const double, Timestep>& p : _volumeTimesteps) {
-        Timestep& t = p.second;
-        std::string path = FileSys.pathByAppendingComponent(
-            _sourceDirectory, t.baseName
-        ) + ".rawvolume";
-        RawVolumeReader<float> reader(path, t.metadata.dimensions);
-        t.rawVolume = reader.read();
-
-        float min = t.metadata.minValue;
-        float diff = t.metadata.maxValue - t.metadata.minValue;
-        float* data = t.rawVolume->data();
-        for (size_t i = 0; i < t.rawVolume->nCells(); ++i) {
-            data[i] = glm::clamp((data[i] - min) / diff, 0.f, 1.f);
-        }
-
-        t.histogram = std::make_shared<Histogram>(0.f, 1.f, 100);
-        for (size_t i = 0; i < t.rawVolume->nCells(); ++i) {
-            t.histogram->add(data[i]);
-        }
-
-        // TODO: handle normalization properly for different timesteps + transfer function
+        _orderedTimesteps.push_back(&p.second);
+    }
 
-        t.texture = std::make_shared<ghoul::opengl::Texture>(
-            t.metadata.dimensions,
-            ghoul::opengl::Texture::Format::Red,
-            GL_RED,
-            GL_FLOAT,
-            ghoul::opengl::Texture::FilterMode::Linear,
-            ghoul::opengl::Texture::WrappingMode::Clamp
+    if (_isStreaming) {
+        // Reading is mostly I/O bound, so a few threads are enough to saturate the disk
+        // while leaving cores for the rest of the application
+        const unsigned int nThreads = std::clamp(
+            std::thread::hardware_concurrency() / 2,
+            1u,
+            4u
         );
-
-        t.texture->setPixelData(
-            reinterpret_cast<void*>(data),
-            ghoul::opengl::Texture::TakeOwnership::No
+        _loadJobManager = std::make_unique<ConcurrentJobManager<LoadedTimestep>>(
+            ThreadPool(nThreads)
         );
-        t.texture->uploadTexture();
+    }
+    else {
+        loadAllTimesteps();
     }
 
     _clipPlanes->initialize();
@@ -329,6 +444,16 @@ void RenderableTimeVaryingVolume::initializeGL() {
     addProperty(_rUpperBound);
     addProperty(_gridType);
 
+    if (_isStreaming) {
+        _residentMemory.setReadOnly(true);
+        _nResidentTimesteps.setReadOnly(true);
+        _nResidentTimesteps.setMaxValue(static_cast<int>(_volumeTimesteps.size()));
+        addProperty(_memoryBudget);
+        addProperty(_prefetchTime);
+        addProperty(_residentMemory);
+        addProperty(_nResidentTimesteps);
+    }
+
     _raycaster->setGridType(static_cast<VolumeGridType>(_gridType.value()));
     _gridType.onChange([this] {
         _raycaster->setGridType(static_cast<VolumeGridType>(_gridType.value()));
@@ -361,6 +486,153 @@ void RenderableTimeVaryingVolume::loadTimestepMetadata(const std::string& path)
     _volumeTimesteps[t.metadata.time] = std::move(t);
 }
 
+std::shared_ptr<RenderableTimeVaryingVolume::TimestepLoadJob>
+RenderableTimeVaryingVolume::createLoadJob(const Timestep& t) const
+{
+    std::string path = FileSys.pathByAppendingComponent(
+        _sourceDirectory, t.baseName
+    ) + ".rawvolume";
+    return std::make_shared<TimestepLoadJob>(std::move(path), t.metadata);
+}
+
+void RenderableTimeVaryingVolume::loadAllTimesteps() {
+    for (Timestep* t : _orderedTimesteps) {
+        std::shared_ptr<TimestepLoadJob> job = createLoadJob(*t);
+        job->execute();
+        uploadTimestep(*t, job->product());
+    }
+}
+
+void RenderableTimeVaryingVolume::uploadTimestep(Timestep& t, LoadedTimestep loaded) {
+    if (!loaded.rawVolume) {
+        return;
+    }
+
+    t.rawVolume = std::move(loaded.rawVolume);
+    t.histogram = std::move(loaded.histogram);
+    t.inRam = true;
+
+    t.texture = std::make_shared<ghoul::opengl::Texture>(
+        t.metadata.dimensions,
+        ghoul::opengl::Texture::Format::Red,
+        GL_RED,
+        GL_FLOAT,
+        ghoul::opengl::Texture::FilterMode::Linear,
+        ghoul::opengl::Texture::WrappingMode::Clamp
+    );
+
+    t.texture->setPixelData(
+        reinterpret_cast<void*>(t.rawVolume->data()),
+        ghoul::opengl::Texture::TakeOwnership::No
+    );
+    t.texture->uploadTexture();
+    t.onGpu = true;
+
+    _residentBytes += timestepBytes(t.metadata.dimensions);
+}
+
+void RenderableTimeVaryingVolume::unloadTimestep(Timestep& t) {
+    if (t.inRam) {
+        _residentBytes -= timestepBytes(t.metadata.dimensions);
+    }
+    t.texture = nullptr;
+    t.rawVolume = nullptr;
+    t.histogram = nullptr;
+    t.inRam = false;
+    t.onGpu = false;
+}
+
+std::vector<RenderableTimeVaryingVolume::Timestep*>
+RenderableTimeVaryingVolume::residentWindow()
+{
+    std::vector<double> startTimes;
+    std::vector<size_t> sizes;
+    startTimes.reserve(_orderedTimesteps.size());
+    sizes.reserve(_orderedTimesteps.size());
+    for (const Timestep* t : _orderedTimesteps) {
+        startTimes.push_back(t->metadata.time);
+        sizes.push_back(timestepBytes(t->metadata.dimensions));
+    }
+
+    const std::vector<size_t> indices = streamingWindow(
+        startTimes,
+        sizes,
+        global::timeManager.time().j2000Seconds(),
+        global::timeManager.deltaTime(),
+        _prefetchTime,
+        static_cast<size_t>(_memoryBudget) * 1024 * 1024,
+        TimestepsBehind
+    );
+
+    std::vector<Timestep*> result;
+    result.reserve(indices.size());
+    for (size_t index : indices) {
+        result.push_back(_orderedTimesteps[index]);
+    }
+    return result;
+}
+
+void RenderableTimeVaryingVolume::updateStreaming() {
+    const std::vector<Timestep*> window = residentWindow();
+    auto isInWindow = [&window](const Timestep* t) {
+        return std::find(window.begin(), window.end(), t) != window.end();
+    };
+
+    // Evict timesteps that have left the window before uploading new ones, so that the
+    // memory usage never exceeds the budget by more than the current timestep
+    for (Timestep* t : _orderedTimesteps) {
+        if (t->inRam && !isInWindow(t)) {
+            unloadTimestep(*t);
+        }
+    }
+
+    for (std::pair<const double, std::shared_ptr<TimestepLoadJob>>& p : _pendingLoads) {
+        if (!isInWindow(&_volumeTimesteps.at(p.first))) {
+            p.second->cancelled = true;
+        }
+    }
+
+    const std::vector<std::shared_ptr<Job<LoadedTimestep>>> finishedJobs =
+        _loadJobManager->popFinishedJobs();
+    for (const std::shared_ptr<Job<LoadedTimestep>>& job : finishedJobs) {
+        LoadedTimestep loaded = job->product();
+        _pendingLoads.erase(loaded.time);
+
+        Timestep& t = _volumeTimesteps.at(loaded.time);
+        if (!t.inRam && isInWindow(&t)) {
+            uploadTimestep(t, std::move(loaded));
+        }
+    }
+
+    // Schedule the missing timesteps in the order of priority; the workers pick up the
+    // jobs in the order in which they were enqueued
+    for (Timestep* t : window) {
+        if (t->inRam) {
+            continue;
+        }
+
+        auto pending = _pendingLoads.find(t->metadata.time);
+        if (pending != _pendingLoads.end()) {
+            // The timestep came back into the window before its job was started, or the
+            // job has skipped already and the timestep is scheduled again once the empty
+            // result has been popped
+            pending->second->cancelled = false;
+            continue;
+        }
+
+        std::shared_ptr<TimestepLoadJob> job = createLoadJob(*t);
+        _pendingLoads[t->metadata.time] = job;
+        _loadJobManager->enqueueJob(job);
+    }
+
+    _residentMemory = static_cast<float>(_residentBytes) / (1024.f * 1024.f);
+    _nResidentTimesteps = static_cast<int>(std::count_if(
+        _orderedTimesteps.begin(),
+        _orderedTimesteps.end(),
+        [](const Timestep* t) { return t->onGpu; }
+    ));
+}
+
 RenderableTimeVaryingVolume::Timestep* RenderableTimeVaryingVolume::currentTimestep() {
     if (_volumeTimesteps.empty()) {
         return nullptr;
@@ -433,6 +705,10 @@ void RenderableTimeVaryingVolume::jumpToTimestep(int target) {
 void RenderableTimeVaryingVolume::update(const UpdateData&) {
     _transferFunction->update();
 
+    if (_loadJobManager) {
+        updateStreaming();
+    }
+
     if (_raycaster) {
         Timestep* t = currentTimestep();
         _currentTimestep = timestepIndex(t);
@@ -483,6 +759,21 @@ bool RenderableTimeVaryingVolume::isReady() const {
 }
 
 void RenderableTimeVaryingVolume::deinitializeGL() {
+    if (_loadJobManager) {
+        for (std::pair<const double, std::shared_ptr<TimestepLoadJob>>& p :
+             _pendingLoads)
+        {
+            p.second->cancelled = true;
+        }
+        _loadJobManager->clearEnqueuedJobs();
+        // Destroying the job manager waits for the jobs that are currently executing
+        _loadJobManager = nullptr;
+        _pendingLoads.clear();
+    }
+    for (Timestep* t : _orderedTimesteps) {
+        unloadTimestep(*t);
+    }
+
     if (_raycaster) {
         global::raycasterManager.detachRaycaster(*_raycaster.get());
         _raycaster = nullptr;
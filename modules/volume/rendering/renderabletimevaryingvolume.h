@@ -30,6 +30,9 @@
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/triggerproperty.h>
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <openspace/util/concurrentjobmanager.h>
 // #include <modules/volume/rawvolume.h>
  #include <modules/volume/rawvolumemetadata.h>
 // #include <modules/volume/rendering/basicvolumeraycaster.h>
@@ -78,12 +81,40 @@ private:
         std::shared_ptr<Histogram> histogram;
     };
 
+    /// The result of reading and normalizing a single timestep on a worker thread
+    struct LoadedTimestep {
+        double time = 0.0;
+        std::shared_ptr<RawVolume<float>> rawVolume;
+        std::shared_ptr<Histogram> histogram;
+    };
+    struct TimestepLoadJob;
+
     Timestep* currentTimestep();
     int timestepIndex(const Timestep* t) const;
     Timestep* timestepFromIndex(int index);
     void jumpToTimestep(int i);
 
     void loadTimestepMetadata(const std::string& path);
+    std::shared_ptr<TimestepLoadJob> createLoadJob(const Timestep& t) const;
+    void loadAllTimesteps();
+
+    /**
+     * Moves the resident window of timesteps to follow the current simulation time.
+     * Timesteps that have finished loading on a worker thread are uploaded to the GPU,
+     * timesteps that have left the window are evicted, and loads are scheduled for the
+     * timesteps that have entered it.
+     */
+    void updateStreaming();
+
+    /**
+     * Returns the timesteps that should be resident, in the order in which they should
+     * be loaded. The current timestep comes first, followed by the timesteps that will be
+     * reached next with the current delta time and lastly the previous timestep. The
+     * list is cut off when the memory budget is exceeded.
+     */
+    std::vector<Timestep*> residentWindow();
+    void uploadTimestep(Timestep& t, LoadedTimestep loaded);
+    void unloadTimestep(Timestep& t);
 
     properties::OptionProperty _gridType;
     std::shared_ptr<VolumeClipPlanes> _clipPlanes;
@@ -100,7 +131,20 @@ private:
     properties::IntProperty _jumpToTimestep;
     properties::IntProperty _currentTimestep;
 
+    properties::IntProperty _memoryBudget;
+    properties::FloatProperty _prefetchTime;
+    properties::FloatProperty _residentMemory;
+    properties::IntProperty _nResidentTimesteps;
+
     std::map<double, Timestep> _volumeTimesteps;
+    // Pointers into _volumeTimesteps, sorted by time, for random access
+    std::vector<Timestep*> _orderedTimesteps;
+
+    bool _isStreaming = false;
+    size_t _residentBytes = 0;
+    std::unique_ptr<ConcurrentJobManager<LoadedTimestep>> _loadJobManager;
+    std::map<double, std::shared_ptr<TimestepLoadJob>> _pendingLoads;
+
     std::unique_ptr<BasicVolumeRaycaster> _raycaster;
 
     std::shared_ptr<openspace::TransferFunction> _transferFunction;
@@ -24,6 +24,10 @@
 
 #include <modules/volume/volumeutils.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 namespace openspace::volume {
 
 size_t coordsToIndex(const glm::uvec3& coords, const glm::uvec3& dims) {
@@ -43,4 +47,63 @@ glm::uvec3 indexToCoords(size_t index, const glm::uvec3& dims) {
     return glm::uvec3(x, y, z);
 }
 
+std::vector<size_t> streamingWindow(const std::vector<double>& startTimes,
+                                    const std::vector<size_t>& sizes, double now,
+                                    double deltaTime, double prefetchTime,
+                                    size_t memoryBudget, int nBehind)
+{
+    std::vector<size_t> result;
+    if (startTimes.empty()) {
+        return result;
+    }
+    const int nTimesteps = static_cast<int>(startTimes.size());
+
+    // The index of the last timestep that starts at or before the current time, which
+    // is clamped to the first timestep if we are before the sequence
+    const auto it = std::upper_bound(startTimes.begin(), startTimes.end(), now);
+    const int current = std::max(
+        static_cast<int>(std::distance(startTimes.begin(), it)) - 1,
+        0
+    );
+
+    // Estimate how many timesteps will be passed during the prefetch time based on the
+    // average spacing between the timesteps
+    int nAhead = 1;
+    if (nTimesteps > 1) {
+        const double span = startTimes.back() - startTimes.front();
+        const double spacing = span / static_cast<double>(nTimesteps - 1);
+        if (spacing > 0.0) {
+            const double passed = std::abs(deltaTime) * prefetchTime / spacing;
+            nAhead += static_cast<int>(std::min(
+                std::ceil(passed),
+                static_cast<double>(nTimesteps)
+            ));
+        }
+    }
+    const int direction = deltaTime < 0.0 ? -1 : 1;
+
+    std::vector<int> indices;
+    indices.reserve(nAhead + nBehind + 1);
+    indices.push_back(current);
+    for (int i = 1; i <= nAhead; ++i) {
+        indices.push_back(current + direction * i);
+    }
+    for (int i = 1; i <= nBehind; ++i) {
+        indices.push_back(current - direction * i);
+    }
+
+    size_t bytes = 0;
+    for (int index : indices) {
+        if (index < 0 || index >= nTimesteps) {
+            continue;
+        }
+        bytes += sizes[index];
+        if (bytes > memoryBudget && !result.empty()) {
+            break;
+        }
+        result.push_back(static_cast<size_t>(index));
+    }
+    return result;
+}
+
 } // namespace openspace::volume
@@ -26,12 +26,33 @@
 #define __OPENSPACE_MODULE_VOLUME___VOLUMEUTILS___H__
 
 #include <ghoul/glm.h>
+#include <vector>
 
 namespace openspace::volume {
 
 size_t coordsToIndex(const glm::uvec3& coords, const glm::uvec3& dimensions);
 glm::uvec3 indexToCoords(size_t index, const glm::uvec3& dimensions);
 
+/**
+ * Returns the indices of the timesteps of a streamed, time-varying volume that should be
+ * resident, in the order in which they should be loaded. The timestep that is active at
+ * \p now comes first, followed by the timesteps that will be reached within
+ * \p prefetchTime seconds at the provided \p deltaTime, and lastly \p nBehind timesteps
+ * in the opposite direction of time. The list is cut off once the summed sizes of the
+ * timesteps exceed \p memoryBudget, but always contains the current timestep.
+ *
+ * \param startTimes The start time of each timestep in ascending order
+ * \param sizes The number of bytes each timestep occupies when it is resident
+ * \param now The current simulation time
+ * \param deltaTime The current simulation time increment per second
+ * \param prefetchTime The number of seconds ahead for which timesteps are loaded
+ * \param memoryBudget The maximum number of bytes of all resident timesteps
+ * \param nBehind The number of timesteps behind the current one that stay resident
+ */
+std::vector<size_t> streamingWindow(const std::vector<double>& startTimes,
+    const std::vector<size_t>& sizes, double now, double deltaTime, double prefetchTime,
+    size_t memoryBudget, int nBehind);
+
 } // namespace openspace::volume
 
 #endif // __OPENSPACE_MODULE_VOLUME___VOLUMEUTILS___H__
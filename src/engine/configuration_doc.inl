@@ -393,6 +393,18 @@ documentation::Documentation Configuration::Documentation = {
             "initialize in parallel. The only use for this value is to disable it for "
             "debugging support."
         },
+        {
+            KeyUseMultithreadedSceneUpdate,
+            new BoolVerifier,
+            Optional::Yes,
+            "This value determines whether the per-frame update of the scene graph "
+            "should occur multithreaded. If enabled, the translations, rotations, and "
+            "scales of all scene graph nodes that do not depend on each other are "
+            "updated in parallel, while the renderables are still updated on the main "
+            "thread. The result is identical to the serial update as long as all "
+            "dependencies between scene graph nodes are specified. This defaults to "
+            "'false'."
+        },
         {
             KeyLoadingScreen,
             new TableVerifier({
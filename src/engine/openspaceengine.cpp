@@ -660,6 +660,11 @@ void OpenSpaceEngine::loadSingleAsset(const std::string& assetPath) {
     }
 
     _scene = std::make_unique<Scene>(std::move(sceneInitializer));
+    if (global::configuration.useMultithreadedSceneUpdate) {
+        unsigned int nAvailableThreads = std::thread::hardware_concurrency();
+        unsigned int nThreads = nAvailableThreads == 0 ? 2 : nAvailableThreads - 1;
+        _scene->setNumberOfUpdateThreads(nThreads);
+    }
     global::renderEngine.setScene(_scene.get());
 
     global::rootPropertyOwner.addPropertySubOwner(_scene.get());
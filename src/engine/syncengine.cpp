@@ -30,16 +30,42 @@
 
 namespace openspace {
 
-SyncEngine::SyncEngine(unsigned int syncBufferSize)
+SyncEngine::SyncEngine(unsigned int syncBufferSize, unsigned int keyframeInterval)
     : _syncBuffer(syncBufferSize)
+    , _keyframeInterval(keyframeInterval)
 {
     ghoul_assert(syncBufferSize > 0, "syncBufferSize must be bigger than 0");
+    ghoul_assert(keyframeInterval > 0, "keyframeInterval must be bigger than 0");
 }
 
 // Should be called on sgct master
 std::vector<char> SyncEngine::encodeSyncables() {
-    for (Syncable* syncable : _syncables) {
-        syncable->encode(&_syncBuffer);
+    const bool isKeyframe = _keyframeRequested ||
+                            _framesSinceKeyframe + 1 >= _keyframeInterval;
+
+    if (isKeyframe) {
+        _syncBuffer.encode(FrameType::Keyframe);
+        for (Syncable* syncable : _syncables) {
+            syncable->encode(&_syncBuffer);
+        }
+        _keyframeRequested = false;
+        _framesSinceKeyframe = 0;
+    }
+    else {
+        _changedSyncables.clear();
+        for (size_t i = 0; i < _syncables.size(); ++i) {
+            if (_syncables[i]->hasChanged()) {
+                _changedSyncables.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        _syncBuffer.encode(FrameType::Delta);
+        _syncBuffer.encode(static_cast<uint32_t>(_changedSyncables.size()));
+        for (uint32_t i : _changedSyncables) {
+            _syncBuffer.encode(i);
+            _syncables[i]->encode(&_syncBuffer);
+        }
+        ++_framesSinceKeyframe;
     }
 
     std::vector<char> data = _syncBuffer.data();
@@ -50,8 +76,20 @@ std::vector<char> SyncEngine::encodeSyncables() {
 // Should be called on sgct slaves
 void SyncEngine::decodeSyncables(std::vector<char> data) {
     _syncBuffer.setData(std::move(data));
-    for (Syncable* syncable : _syncables) {
-        syncable->decode(&_syncBuffer);
+
+    const FrameType type = _syncBuffer.decode<FrameType>();
+    if (type == FrameType::Keyframe) {
+        for (Syncable* syncable : _syncables) {
+            syncable->decode(&_syncBuffer);
+        }
+    }
+    else {
+        const uint32_t nChanged = _syncBuffer.decode<uint32_t>();
+        for (uint32_t i = 0; i < nChanged; ++i) {
+            const uint32_t index = _syncBuffer.decode<uint32_t>();
+            ghoul_assert(index < _syncables.size(), "Syncable index out of range");
+            _syncables[index]->decode(&_syncBuffer);
+        }
     }
 
     _syncBuffer.reset();
@@ -73,6 +111,7 @@ void SyncEngine::addSyncable(Syncable* syncable) {
     ghoul_assert(syncable, "Syncable must not be nullptr");
 
     _syncables.push_back(syncable);
+    requestKeyframe();
 }
 
 void SyncEngine::addSyncables(const std::vector<Syncable*>& syncables) {
@@ -87,6 +126,7 @@ void SyncEngine::removeSyncable(Syncable* syncable) {
         std::remove(_syncables.begin(), _syncables.end(), syncable),
         _syncables.end()
     );
+    requestKeyframe();
 }
 
 void SyncEngine::removeSyncables(const std::vector<Syncable*>& syncables) {
@@ -95,4 +135,8 @@ void SyncEngine::removeSyncables(const std::vector<Syncable*>& syncables) {
     }
 }
 
+void SyncEngine::requestKeyframe() {
+    _keyframeRequested = true;
+}
+
 } // namespace openspace
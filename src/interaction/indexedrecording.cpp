@@ -0,0 +1,726 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/interaction/indexedrecording.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    constexpr const char* _loggerCat = "IndexedRecording";
+
+    constexpr const char FileHeaderTitle[] = "OpenSpace_record/playback";
+    constexpr const size_t FileHeaderTitleLength = sizeof(FileHeaderTitle) - 1;
+    constexpr const size_t FileHeaderVersionLength = 5;
+    constexpr const char IndexedFileHeaderVersion[FileHeaderVersionLength] = {
+        '0', '2', '.', '0', '0'
+    };
+    constexpr const char DataFormatAsciiTag = 'A';
+    constexpr const char DataFormatBinaryTag = 'B';
+    constexpr const char DataFormatIndexedTag = 'I';
+    // Title, version, data format tag, and newline
+    constexpr const size_t FileHeaderSize =
+        FileHeaderTitleLength + FileHeaderVersionLength + 2;
+
+    constexpr const uint32_t Magic = 0x4952534F; // 'OSRI'
+    constexpr const uint32_t FormatVersion = 1;
+    constexpr const size_t SectionAlignment = 8;
+
+    struct CameraRecord {
+        double position[3];
+        // The rotation quaternion as x, y, z, w
+        float rotation[4];
+        uint64_t focusNodeOffset;
+        uint64_t focusNodeLength;
+        float scale;
+        uint8_t followFocusNodeRotation;
+        uint8_t padding[3];
+    };
+    static_assert(sizeof(CameraRecord) == 64);
+
+    struct TimeRecord {
+        double dt;
+        uint8_t paused;
+        uint8_t requiresTimeJump;
+        uint8_t padding[6];
+    };
+    static_assert(sizeof(TimeRecord) == 16);
+
+    struct ScriptRecord {
+        uint64_t offset;
+        uint64_t length;
+    };
+    static_assert(sizeof(ScriptRecord) == 16);
+
+    static_assert(sizeof(openspace::interaction::IndexedRecording::Entry) == 32);
+
+    // Stored at the very end of the file, so the sections can be written in the order in
+    // which the recording is read
+    struct Trailer {
+        uint64_t camerasOffset;
+        uint64_t nCameras;
+        uint64_t timesOffset;
+        uint64_t nTimes;
+        uint64_t scriptsOffset;
+        uint64_t nScripts;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t entriesOffset;
+        uint64_t nEntries;
+        uint32_t formatVersion;
+        uint32_t magic;
+    };
+    static_assert(sizeof(Trailer) == 88);
+
+    size_t align(size_t value) {
+        return (value + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+    }
+
+    template <typename T>
+    void append(std::vector<std::byte>& buffer, const T& value) {
+        const size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T readFromPlayback(std::istream& stream) {
+        T res;
+        stream.read(reinterpret_cast<char*>(&res), sizeof(T));
+        return res;
+    }
+
+    template <>
+    bool readFromPlayback(std::istream& stream) {
+        unsigned char b;
+        stream.read(reinterpret_cast<char*>(&b), sizeof(unsigned char));
+        return b != 0;
+    }
+
+    template <>
+    std::string readFromPlayback(std::istream& stream) {
+        size_t strLen;
+        // Read string length from file
+        stream.read(reinterpret_cast<char*>(&strLen), sizeof(strLen));
+        // Read back full string
+        std::vector<char> temp(strLen + 1);
+        stream.read(temp.data(), strLen);
+        temp[strLen] = '\0';
+        return temp.data();
+    }
+
+    std::string readHeaderElement(std::istream& stream, size_t readLen_chars) {
+        std::vector<char> readTemp(readLen_chars);
+        stream.read(readTemp.data(), readLen_chars);
+        return std::string(readTemp.begin(), readTemp.end());
+    }
+
+    char readFileHeader(std::istream& stream, const std::string& path) {
+        if (readHeaderElement(stream, FileHeaderTitleLength) != FileHeaderTitle) {
+            throw ghoul::RuntimeError(
+                fmt::format("Playback file '{}' does not contain expected header", path),
+                _loggerCat
+            );
+        }
+        readHeaderElement(stream, FileHeaderVersionLength);
+        const char dataMode = readHeaderElement(stream, 1)[0];
+        // Skip the newline character
+        readHeaderElement(stream, 1);
+        return dataMode;
+    }
+
+    bool readBinaryKeyframe(std::istream& file, unsigned char frameType,
+                            openspace::interaction::IndexedRecording::Builder& builder)
+    {
+        using namespace openspace;
+
+        const double timeOs = readFromPlayback<double>(file);
+        const double timeRec = readFromPlayback<double>(file);
+        const double timeSim = readFromPlayback<double>(file);
+
+        if (frameType == 'c') {
+            datamessagestructures::CameraKeyframe kf;
+            kf.read(&file);
+            if (!file) {
+                return false;
+            }
+
+            interaction::KeyframeNavigator::CameraPose pose;
+            pose.focusNode = kf._focusNode;
+            pose.position = kf._position;
+            pose.rotation = kf._rotation;
+            pose.scale = kf._scale;
+            pose.followFocusNodeRotation = kf._followNodeRotation;
+            builder.addCamera(kf._timestamp, timeRec, timeSim, pose);
+        }
+        else if (frameType == 't') {
+            datamessagestructures::TimeKeyframe kf;
+            kf._dt = readFromPlayback<double>(file);
+            kf._paused = readFromPlayback<bool>(file);
+            kf._requiresTimeJump = readFromPlayback<bool>(file);
+            if (!file) {
+                return false;
+            }
+            builder.addTime(timeOs, timeRec, timeSim, kf);
+        }
+        else {
+            const std::string script = readFromPlayback<std::string>(file);
+            if (!file) {
+                return false;
+            }
+            builder.addScript(timeOs, timeRec, timeSim, script);
+        }
+        return true;
+    }
+
+    void loadBinaryRecording(std::istream& file, const std::string& path,
+                             openspace::interaction::IndexedRecording::Builder& builder)
+    {
+        for (int entry = 0; ; ++entry) {
+            const unsigned char frameType = readFromPlayback<unsigned char>(file);
+            // Check if have reached EOF
+            if (!file) {
+                LINFO(fmt::format(
+                    "Finished parsing {} entries from playback file {}", entry, path
+                ));
+                return;
+            }
+            if (frameType != 'c' && frameType != 't' && frameType != 's') {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Unknown frame type {} @ index {} of playback file {}",
+                    frameType, entry, path
+                ), _loggerCat);
+            }
+
+            bool success = false;
+            try {
+                success = readBinaryKeyframe(file, frameType, builder);
+            }
+            catch (const std::bad_alloc&) {}
+            catch (const std::length_error&) {}
+            if (!success) {
+                LERROR(fmt::format(
+                    "Error reading playback from keyframe entry {} of playback file {}",
+                    entry, path
+                ));
+                return;
+            }
+        }
+    }
+
+    void loadAsciiRecording(std::istream& file, const std::string& path,
+                            openspace::interaction::IndexedRecording::Builder& builder)
+    {
+        using namespace openspace;
+
+        int lineNum = 1;
+        std::string line;
+        while (std::getline(file, line)) {
+            lineNum++;
+
+            std::istringstream iss(line);
+            std::string entryType;
+            if (!(iss >> entryType)) {
+                LERROR(fmt::format(
+                    "Error reading entry type @ line {} of playback file {}",
+                    lineNum, path
+                ));
+                break;
+            }
+
+            double timeOs;
+            double timeRec;
+            double timeSim;
+            iss >> timeOs >> timeRec >> timeSim;
+
+            if (entryType == "camera") {
+                interaction::KeyframeNavigator::CameraPose pose;
+                std::string rotationFollowing;
+                iss >> pose.position.x
+                    >> pose.position.y
+                    >> pose.position.z
+                    >> pose.rotation.x
+                    >> pose.rotation.y
+                    >> pose.rotation.z
+                    >> pose.rotation.w
+                    >> pose.scale
+                    >> rotationFollowing
+                    >> pose.focusNode;
+                if (iss.fail() || !iss.eof()) {
+                    LERROR(fmt::format(
+                        "Error parsing camera line {} of playback file", lineNum
+                    ));
+                    continue;
+                }
+                pose.followFocusNodeRotation = (rotationFollowing == "F");
+                builder.addCamera(timeOs, timeRec, timeSim, pose);
+            }
+            else if (entryType == "time") {
+                datamessagestructures::TimeKeyframe kf;
+                std::string paused;
+                std::string jump;
+                iss >> kf._dt >> paused >> jump;
+                if (iss.fail() || !iss.eof()) {
+                    LERROR(fmt::format(
+                        "Error parsing time line {} of playback file", lineNum
+                    ));
+                    continue;
+                }
+                kf._paused = (paused == "P");
+                kf._requiresTimeJump = (jump == "J");
+                builder.addTime(timeOs, timeRec, timeSim, kf);
+            }
+            else if (entryType == "script") {
+                unsigned int numScriptLines;
+                std::string script;
+                iss >> numScriptLines;
+                std::getline(iss, script);
+                if (iss.fail()) {
+                    LERROR(fmt::format(
+                        "Error parsing script line {} of playback file", lineNum
+                    ));
+                    continue;
+                }
+                else if (!iss.eof()) {
+                    LERROR(fmt::format(
+                        "Did not find an EOL at line {} of playback file", lineNum
+                    ));
+                    continue;
+                }
+                // Read any subsequent lines if this is a multi-line script
+                for (unsigned int i = 1; i < numScriptLines; ++i) {
+                    std::string scriptLine;
+                    std::getline(file, scriptLine);
+                    script.append("\n");
+                    script.append(scriptLine);
+                }
+                builder.addScript(timeOs, timeRec, timeSim, script);
+            }
+            else {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Unknown frame type {} @ line {} of playback file {}",
+                    entryType, lineNum, path
+                ), _loggerCat);
+            }
+        }
+        LINFO(fmt::format(
+            "Finished parsing {} entries from playback file {}", lineNum, path
+        ));
+    }
+
+    void loadLegacyRecording(const std::string& path, char dataMode,
+                             openspace::interaction::IndexedRecording::Builder& builder)
+    {
+        if (dataMode == DataFormatBinaryTag) {
+            std::ifstream file(path, std::ifstream::in | std::ios::binary);
+            file.seekg(FileHeaderSize);
+            loadBinaryRecording(file, path, builder);
+        }
+        else {
+            std::ifstream file(path);
+            // Skip the header line
+            std::string header;
+            std::getline(file, header);
+            loadAsciiRecording(file, path, builder);
+        }
+    }
+} // namespace
+
+namespace openspace::interaction {
+
+void IndexedRecording::Builder::addCamera(double timeOs, double timeRec, double timeSim,
+                                         const KeyframeNavigator::CameraPose& pose)
+{
+    CameraRecord record = {};
+    record.position[0] = pose.position.x;
+    record.position[1] = pose.position.y;
+    record.position[2] = pose.position.z;
+    record.rotation[0] = pose.rotation.x;
+    record.rotation[1] = pose.rotation.y;
+    record.rotation[2] = pose.rotation.z;
+    record.rotation[3] = pose.rotation.w;
+    record.scale = pose.scale;
+    record.followFocusNodeRotation = pose.followFocusNodeRotation ? 1 : 0;
+
+    // Most recordings only use a handful of focus nodes, so they are only stored once
+    const auto it = _nodeNameOffsets.find(pose.focusNode);
+    if (it != _nodeNameOffsets.end()) {
+        record.focusNodeOffset = it->second;
+    }
+    else {
+        record.focusNodeOffset = addString(pose.focusNode);
+        _nodeNameOffsets[pose.focusNode] = record.focusNodeOffset;
+    }
+    record.focusNodeLength = pose.focusNode.size();
+
+    const uint32_t index = static_cast<uint32_t>(_cameras.size() / sizeof(CameraRecord));
+    append(_cameras, record);
+    _entries.push_back({ timeOs, timeRec, timeSim, EntryType::Camera, index });
+}
+
+void IndexedRecording::Builder::addTime(double timeOs, double timeRec, double timeSim,
+                                   const datamessagestructures::TimeKeyframe& keyframe)
+{
+    TimeRecord record = {};
+    record.dt = keyframe._dt;
+    record.paused = keyframe._paused ? 1 : 0;
+    record.requiresTimeJump = keyframe._requiresTimeJump ? 1 : 0;
+
+    const uint32_t index = static_cast<uint32_t>(_times.size() / sizeof(TimeRecord));
+    append(_times, record);
+    _entries.push_back({ timeOs, timeRec, timeSim, EntryType::Time, index });
+}
+
+void IndexedRecording::Builder::addScript(double timeOs, double timeRec, double timeSim,
+                                          std::string_view script)
+{
+    const ScriptRecord record = { addString(script), script.size() };
+
+    const uint32_t index = static_cast<uint32_t>(_scripts.size() / sizeof(ScriptRecord));
+    append(_scripts, record);
+    _entries.push_back({ timeOs, timeRec, timeSim, EntryType::Script, index });
+}
+
+size_t IndexedRecording::Builder::nEntries() const {
+    return _entries.size();
+}
+
+uint64_t IndexedRecording::Builder::addString(std::string_view s) {
+    const uint64_t offset = _strings.size();
+    _strings += s;
+    return offset;
+}
+
+size_t IndexedRecording::Builder::fileSize() const {
+    const size_t entriesOffset = align(
+        FileHeaderSize + _cameras.size() + _times.size() + _scripts.size() +
+        _strings.size()
+    );
+    return entriesOffset + _entries.size() * sizeof(Entry) + sizeof(Trailer);
+}
+
+void IndexedRecording::Builder::write(std::byte* destination) const {
+    std::memset(destination, 0, fileSize());
+
+    // The header is the same as for the older formats, so they can be told apart by the
+    // data format tag
+    std::byte* p = destination;
+    std::memcpy(p, FileHeaderTitle, FileHeaderTitleLength);
+    p += FileHeaderTitleLength;
+    std::memcpy(p, IndexedFileHeaderVersion, FileHeaderVersionLength);
+    p += FileHeaderVersionLength;
+    *p++ = static_cast<std::byte>(DataFormatIndexedTag);
+    *p++ = static_cast<std::byte>('\n');
+
+    // All records are multiples of 8 bytes in size and the header is 32 bytes, so all
+    // sections except the string table are aligned without padding
+    static_assert(FileHeaderSize % SectionAlignment == 0);
+
+    Trailer trailer = {};
+    trailer.camerasOffset = FileHeaderSize;
+    trailer.nCameras = _cameras.size() / sizeof(CameraRecord);
+    trailer.timesOffset = trailer.camerasOffset + _cameras.size();
+    trailer.nTimes = _times.size() / sizeof(TimeRecord);
+    trailer.scriptsOffset = trailer.timesOffset + _times.size();
+    trailer.nScripts = _scripts.size() / sizeof(ScriptRecord);
+    trailer.stringsOffset = trailer.scriptsOffset + _scripts.size();
+    trailer.stringsSize = _strings.size();
+    trailer.entriesOffset = align(trailer.stringsOffset + _strings.size());
+    trailer.nEntries = _entries.size();
+    trailer.formatVersion = FormatVersion;
+    trailer.magic = Magic;
+
+    auto copy = [destination](uint64_t offset, const void* source, size_t size) {
+        if (size > 0) {
+            std::memcpy(destination + offset, source, size);
+        }
+    };
+    copy(trailer.camerasOffset, _cameras.data(), _cameras.size());
+    copy(trailer.timesOffset, _times.data(), _times.size());
+    copy(trailer.scriptsOffset, _scripts.data(), _scripts.size());
+    copy(trailer.stringsOffset, _strings.data(), _strings.size());
+    copy(trailer.entriesOffset, _entries.data(), _entries.size() * sizeof(Entry));
+    copy(fileSize() - sizeof(Trailer), &trailer, sizeof(Trailer));
+}
+
+std::vector<std::byte> IndexedRecording::Builder::build() const {
+    std::vector<std::byte> result(fileSize());
+    write(result.data());
+    return result;
+}
+
+void IndexedRecording::Builder::save(const std::string& path) const {
+    const std::string temporaryPath = path + ".tmp";
+    {
+        MemoryMappedFile file(temporaryPath, MemoryMappedFile::Writable::Yes, fileSize());
+        write(file.data());
+        file.flush();
+    }
+
+    // std::rename does not replace existing files on all platforms
+    std::remove(path.c_str());
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw ghoul::RuntimeError(
+            fmt::format("Error moving recording into place at '{}'", path),
+            _loggerCat
+        );
+    }
+}
+
+IndexedRecording::IndexedRecording(const std::string& path) {
+    char dataMode;
+    {
+        std::ifstream file(path, std::ifstream::in | std::ios::binary);
+        if (!file.good()) {
+            throw ghoul::RuntimeError(
+                fmt::format("Unable to open file {} for keyframe playback", path),
+                _loggerCat
+            );
+        }
+        dataMode = readFileHeader(file, path);
+    }
+
+    if (dataMode == DataFormatIndexedTag) {
+        _file.emplace(path);
+        initialize(_file->data(), _file->size(), path);
+    }
+    else if (dataMode == DataFormatAsciiTag || dataMode == DataFormatBinaryTag) {
+        Builder builder;
+        loadLegacyRecording(path, dataMode, builder);
+        _buffer = builder.build();
+        initialize(_buffer.data(), _buffer.size(), path);
+    }
+    else {
+        throw ghoul::RuntimeError(
+            "Unknown data type in header (should be Ascii, Binary, or Indexed)",
+            _loggerCat
+        );
+    }
+}
+
+IndexedRecording::IndexedRecording(const Builder& builder)
+    : _buffer(builder.build())
+{
+    initialize(_buffer.data(), _buffer.size(), "");
+}
+
+void IndexedRecording::initialize(const std::byte* data, size_t size,
+                                  const std::string& path)
+{
+    auto invalid = [&path](const std::string& reason) {
+        return ghoul::RuntimeError(
+            fmt::format("Invalid indexed recording '{}': {}", path, reason),
+            _loggerCat
+        );
+    };
+
+    if (size < FileHeaderSize + sizeof(Trailer)) {
+        throw invalid("File is too small");
+    }
+    Trailer trailer;
+    std::memcpy(&trailer, data + size - sizeof(Trailer), sizeof(Trailer));
+    if (trailer.magic != Magic) {
+        throw invalid("File is truncated or not an indexed recording");
+    }
+    if (trailer.formatVersion != FormatVersion) {
+        throw invalid(fmt::format("Unsupported version {}", trailer.formatVersion));
+    }
+
+    // Checks that a section is aligned and lies between the header and the trailer
+    const size_t end = size - sizeof(Trailer);
+    auto isValidSection = [end](uint64_t offset, uint64_t count, size_t elementSize) {
+        return offset >= FileHeaderSize && offset <= end &&
+            count <= (end - offset) / elementSize;
+    };
+    if (!isValidSection(trailer.camerasOffset, trailer.nCameras, sizeof(CameraRecord)) ||
+        !isValidSection(trailer.timesOffset, trailer.nTimes, sizeof(TimeRecord)) ||
+        !isValidSection(trailer.scriptsOffset, trailer.nScripts, sizeof(ScriptRecord)) ||
+        !isValidSection(trailer.stringsOffset, trailer.stringsSize, 1) ||
+        !isValidSection(trailer.entriesOffset, trailer.nEntries, sizeof(Entry)) ||
+        trailer.entriesOffset % alignof(Entry) != 0)
+    {
+        throw invalid("Section is out of bounds");
+    }
+
+    _cameras = data + trailer.camerasOffset;
+    _nCameras = trailer.nCameras;
+    _times = data + trailer.timesOffset;
+    _nTimes = trailer.nTimes;
+    _scripts = data + trailer.scriptsOffset;
+    _nScripts = trailer.nScripts;
+    _strings = reinterpret_cast<const char*>(data + trailer.stringsOffset);
+    _stringsSize = trailer.stringsSize;
+    _entries = reinterpret_cast<const Entry*>(data + trailer.entriesOffset);
+    _nEntries = trailer.nEntries;
+
+    // The index is the only section that is touched as a whole when the file is opened,
+    // which ensures that the records can be accessed without any further checks
+    for (size_t i = 0; i < _nEntries; ++i) {
+        const Entry& e = _entries[i];
+        const bool isValid =
+            (e.type == EntryType::Camera && e.index < _nCameras) ||
+            (e.type == EntryType::Time && e.index < _nTimes) ||
+            (e.type == EntryType::Script && e.index < _nScripts);
+        if (!isValid) {
+            throw invalid(fmt::format("Entry {} is invalid", i));
+        }
+    }
+}
+
+bool IndexedRecording::isMapped() const {
+    return _file.has_value();
+}
+
+size_t IndexedRecording::nEntries() const {
+    return _nEntries;
+}
+
+size_t IndexedRecording::nCameraKeyframes() const {
+    return _nCameras;
+}
+
+size_t IndexedRecording::nTimeKeyframes() const {
+    return _nTimes;
+}
+
+size_t IndexedRecording::nScripts() const {
+    return _nScripts;
+}
+
+const IndexedRecording::Entry& IndexedRecording::entry(size_t index) const {
+    ghoul_assert(index < _nEntries, "index must be smaller than the number of entries");
+    return _entries[index];
+}
+
+KeyframeNavigator::CameraPose IndexedRecording::cameraPose(uint32_t index) const {
+    ghoul_assert(index < _nCameras, "index must be smaller than the number of cameras");
+
+    CameraRecord record;
+    std::memcpy(&record, _cameras + index * sizeof(CameraRecord), sizeof(CameraRecord));
+
+    KeyframeNavigator::CameraPose pose;
+    pose.position = glm::dvec3(
+        record.position[0],
+        record.position[1],
+        record.position[2]
+    );
+    pose.rotation = glm::quat(
+        record.rotation[3],
+        record.rotation[0],
+        record.rotation[1],
+        record.rotation[2]
+    );
+    pose.focusNode = std::string(string(record.focusNodeOffset, record.focusNodeLength));
+    pose.scale = record.scale;
+    pose.followFocusNodeRotation = (record.followFocusNodeRotation != 0);
+    return pose;
+}
+
+datamessagestructures::TimeKeyframe IndexedRecording::timeKeyframe(uint32_t index) const
+{
+    ghoul_assert(index < _nTimes, "index must be smaller than the number of times");
+
+    TimeRecord record;
+    std::memcpy(&record, _times + index * sizeof(TimeRecord), sizeof(TimeRecord));
+
+    datamessagestructures::TimeKeyframe keyframe;
+    keyframe._dt = record.dt;
+    keyframe._paused = (record.paused != 0);
+    keyframe._requiresTimeJump = (record.requiresTimeJump != 0);
+    return keyframe;
+}
+
+std::string_view IndexedRecording::script(uint32_t index) const {
+    ghoul_assert(index < _nScripts, "index must be smaller than the number of scripts");
+
+    ScriptRecord record;
+    std::memcpy(&record, _scripts + index * sizeof(ScriptRecord), sizeof(ScriptRecord));
+    return string(record.offset, record.length);
+}
+
+std::string_view IndexedRecording::string(uint64_t offset, uint64_t length) const {
+    if (offset > _stringsSize || length > _stringsSize - offset) {
+        LERROR(fmt::format("String at offset {} is out of bounds", offset));
+        return std::string_view();
+    }
+    return std::string_view(_strings + offset, length);
+}
+
+size_t IndexedRecording::seek(double timestamp, KeyframeTimeRef timeRef) const {
+    const Entry* it = std::partition_point(
+        _entries,
+        _entries + _nEntries,
+        [timestamp, timeRef](const Entry& e) {
+            return IndexedRecording::timestamp(e, timeRef) < timestamp;
+        }
+    );
+    return it - _entries;
+}
+
+double IndexedRecording::timestamp(const Entry& entry, KeyframeTimeRef timeRef) {
+    if (timeRef == KeyframeTimeRef::Relative_recordedStart) {
+        return entry.timeRec;
+    }
+    else if (timeRef == KeyframeTimeRef::Absolute_simTimeJ2000) {
+        return entry.timeSim;
+    }
+    else {
+        return entry.timeOs;
+    }
+}
+
+void convertToIndexedRecording(const std::string& source, const std::string& destination)
+{
+    char dataMode;
+    {
+        std::ifstream file(source, std::ifstream::in | std::ios::binary);
+        if (!file.good()) {
+            throw ghoul::RuntimeError(
+                fmt::format("Unable to open file {} for conversion", source),
+                _loggerCat
+            );
+        }
+        dataMode = readFileHeader(file, source);
+    }
+    if (dataMode != DataFormatAsciiTag && dataMode != DataFormatBinaryTag) {
+        throw ghoul::RuntimeError(
+            fmt::format("File {} is not an ASCII or binary recording", source),
+            _loggerCat
+        );
+    }
+
+    IndexedRecording::Builder builder;
+    loadLegacyRecording(source, dataMode, builder);
+    builder.save(destination);
+}
+
+} // namespace openspace::interaction
@@ -0,0 +1,357 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <openspace/interaction/recordingwriter.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    constexpr const char* _loggerCat = "RecordingWriter";
+
+    const std::string FileHeaderTitle = "OpenSpace_record/playback";
+    constexpr const size_t FileHeaderVersionLength = 5;
+    constexpr const char FileHeaderVersion[FileHeaderVersionLength] = {
+        '0', '0', '.', '8', '5'
+    };
+    constexpr const char DataFormatAsciiTag = 'A';
+    constexpr const char DataFormatBinaryTag = 'B';
+
+    constexpr const size_t WriteBatchSize = 256;
+    constexpr const std::chrono::milliseconds WriterIdleInterval(10);
+
+    using Keyframe = openspace::interaction::RecordingWriter::Keyframe;
+
+    void syncToDisk(std::FILE* file) {
+#ifdef WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif // WIN32
+    }
+
+    void writeToBuffer(std::vector<char>& buffer, double value) {
+        const char* p = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), p, p + sizeof(double));
+    }
+
+    void writeToBuffer(std::vector<char>& buffer, bool value) {
+        buffer.push_back(value ? 1 : 0);
+    }
+
+    void writeToBuffer(std::vector<char>& buffer, const std::string& s) {
+        const size_t length = s.size();
+        const char* p = reinterpret_cast<const char*>(&length);
+        buffer.insert(buffer.end(), p, p + sizeof(size_t));
+        buffer.insert(buffer.end(), s.begin(), s.end());
+    }
+
+    void writeLineToBuffer(std::vector<char>& buffer, const std::string& line) {
+        buffer.insert(buffer.end(), line.begin(), line.end());
+        buffer.push_back('\n');
+    }
+
+    void writeBinaryHeader(std::vector<char>& buffer, char type, const Keyframe& kf) {
+        buffer.push_back(type);
+        writeToBuffer(buffer, kf.timestamp);
+        writeToBuffer(buffer, kf.timestampRelative);
+        writeToBuffer(buffer, kf.simulationTime);
+    }
+
+    void writeCameraKeyframe(std::vector<char>& buffer, const Keyframe& keyframe,
+                             bool isBinary)
+    {
+        const openspace::datamessagestructures::CameraKeyframe& kf = keyframe.camera;
+
+        if (isBinary) {
+            writeBinaryHeader(buffer, 'c', keyframe);
+            kf.serialize(buffer);
+        }
+        else {
+            std::stringstream keyframeLine = std::stringstream();
+            // Add simulation timestamp, timestamp relative, simulation time to recording
+            // start
+            keyframeLine << "camera ";
+            keyframeLine << keyframe.timestamp << ' ';
+            keyframeLine << keyframe.timestampRelative << ' ';
+            keyframeLine << std::fixed << std::setprecision(3) << keyframe.simulationTime;
+            keyframeLine << ' ';
+            // Add camera position
+            keyframeLine << std::fixed << std::setprecision(7) << kf._position.x << ' '
+                << std::fixed << std::setprecision(7) << kf._position.y << ' '
+                << std::fixed << std::setprecision(7) << kf._position.z << ' ';
+            // Add camera rotation
+            keyframeLine << std::fixed << std::setprecision(7) << kf._rotation.x << ' '
+                << std::fixed << std::setprecision(7) << kf._rotation.y << ' '
+                << std::fixed << std::setprecision(7) << kf._rotation.z << ' '
+                << std::fixed << std::setprecision(7) << kf._rotation.w << ' ';
+            keyframeLine << std::scientific << kf._scale << ' ';
+            if (kf._followNodeRotation) {
+                keyframeLine << "F ";
+            }
+            else {
+                keyframeLine << "- ";
+            }
+            keyframeLine << kf._focusNode;
+
+            writeLineToBuffer(buffer, keyframeLine.str());
+        }
+    }
+
+    void writeTimeKeyframe(std::vector<char>& buffer, const Keyframe& keyframe,
+                           bool isBinary)
+    {
+        const openspace::datamessagestructures::TimeKeyframe& kf = keyframe.time;
+
+        if (isBinary) {
+            writeBinaryHeader(buffer, 't', keyframe);
+            writeToBuffer(buffer, kf._dt);
+            writeToBuffer(buffer, kf._paused);
+            writeToBuffer(buffer, kf._requiresTimeJump);
+        }
+        else {
+            std::stringstream keyframeLine = std::stringstream();
+            // Add simulation timestamp, timestamp relative, simulation time to recording
+            // start
+            keyframeLine << "time ";
+            keyframeLine << keyframe.timestamp << ' ';
+            keyframeLine << keyframe.timestampRelative << ' ';
+
+            keyframeLine << std::fixed << std::setprecision(3) << keyframe.simulationTime;
+
+            keyframeLine << ' ' << kf._dt;
+            if (kf._paused) {
+                keyframeLine << " P";
+            }
+            else {
+                keyframeLine << " R";
+            }
+            if (kf._requiresTimeJump) {
+                keyframeLine << " J";
+            }
+            else {
+                keyframeLine << " -";
+            }
+            writeLineToBuffer(buffer, keyframeLine.str());
+        }
+    }
+
+    void writeScriptKeyframe(std::vector<char>& buffer, const Keyframe& keyframe,
+                             bool isBinary)
+    {
+        const std::string& script = keyframe.script;
+
+        if (isBinary) {
+            writeBinaryHeader(buffer, 's', keyframe);
+            writeToBuffer(buffer, script);
+        }
+        else {
+            unsigned int numLinesInScript = static_cast<unsigned int>(
+                std::count(script.begin(), script.end(), '\n')
+            );
+            std::stringstream keyframeLine = std::stringstream();
+            // Add simulation timestamp, timestamp relative, simulation time to recording
+            // start
+            keyframeLine << "script ";
+            keyframeLine << keyframe.timestamp << ' ';
+            keyframeLine << keyframe.timestampRelative << ' ';
+            keyframeLine << std::fixed << std::setprecision(3) << keyframe.simulationTime;
+            keyframeLine << ' ';
+            keyframeLine << (numLinesInScript + 1) << ' ';
+            keyframeLine << script;
+
+            writeLineToBuffer(buffer, keyframeLine.str());
+        }
+    }
+} // namespace
+
+namespace openspace::interaction {
+
+RecordingWriter::RecordingWriter(size_t queueCapacity)
+    : _queueCapacity(queueCapacity)
+{}
+
+RecordingWriter::~RecordingWriter() {
+    // The writer thread must not outlive the file it writes to
+    close();
+}
+
+bool RecordingWriter::open(const std::string& filename, DataMode dataMode) {
+    ghoul_assert(!isOpen(), "Recording file must not be open already");
+
+    const bool isBinary = (dataMode == DataMode::Binary);
+    _file = std::fopen(filename.c_str(), isBinary ? "wb" : "w");
+    if (!_file) {
+        return false;
+    }
+    _dataMode = dataMode;
+
+    _buffer.clear();
+    _buffer.insert(_buffer.end(), FileHeaderTitle.begin(), FileHeaderTitle.end());
+    _buffer.insert(
+        _buffer.end(),
+        FileHeaderVersion,
+        FileHeaderVersion + FileHeaderVersionLength
+    );
+    _buffer.push_back(isBinary ? DataFormatBinaryTag : DataFormatAsciiTag);
+    _buffer.push_back('\n');
+
+    _hasWriteFailed = false;
+    _nDroppedKeyframes = 0;
+    _maxBacklog = 0;
+    _queue = std::make_unique<BoundedConcurrentQueue<Keyframe>>(_queueCapacity);
+    return true;
+}
+
+void RecordingWriter::start() {
+    ghoul_assert(isOpen(), "Recording file must be open");
+    ghoul_assert(!_thread.joinable(), "Writer thread must not be running already");
+
+    _isRunning = true;
+    _thread = std::thread([this]() { run(); });
+}
+
+void RecordingWriter::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    if (_thread.joinable()) {
+        // The writer thread writes all remaining keyframes before it finishes
+        _isRunning = false;
+        _thread.join();
+    }
+    // Without a writer thread, the keyframes that were queued are written here
+    while (writeQueuedKeyframes()) {}
+    _queue = nullptr;
+
+    if (_nDroppedKeyframes > 0) {
+        LWARNING(fmt::format(
+            "Dropped {} keyframes while recording, the maximum backlog was {}",
+            _nDroppedKeyframes, _maxBacklog
+        ));
+    }
+
+    std::fflush(_file);
+    syncToDisk(_file);
+    std::fclose(_file);
+    _file = nullptr;
+}
+
+bool RecordingWriter::isOpen() const {
+    return _file != nullptr;
+}
+
+void RecordingWriter::queueKeyframe(Keyframe keyframe) {
+    ghoul_assert(isOpen(), "Recording file must be open");
+
+    _maxBacklog = std::max(_maxBacklog, _queue->size());
+
+    if (keyframe.type == Keyframe::Type::Script) {
+        // Missing scripts would change the outcome of the playback, so they are worth
+        // waiting for
+        _queue->push(std::move(keyframe));
+    }
+    else if (!_queue->tryPush(std::move(keyframe))) {
+        _nDroppedKeyframes++;
+    }
+}
+
+size_t RecordingWriter::nDroppedKeyframes() const {
+    return _nDroppedKeyframes;
+}
+
+size_t RecordingWriter::backlog() const {
+    return _queue ? _queue->size() : 0;
+}
+
+size_t RecordingWriter::maxBacklog() const {
+    return _maxBacklog;
+}
+
+void RecordingWriter::run() {
+    while (true) {
+        // The flag has to be read before the queue is drained, as keyframes that were
+        // queued before the recording was stopped must not be lost
+        const bool isRunning = _isRunning;
+
+        if (!writeQueuedKeyframes()) {
+            if (!isRunning) {
+                break;
+            }
+            std::this_thread::sleep_for(WriterIdleInterval);
+        }
+    }
+}
+
+bool RecordingWriter::writeQueuedKeyframes() {
+    const bool isBinary = (_dataMode == DataMode::Binary);
+
+    _batch.clear();
+    _queue->tryPopBulk(std::back_inserter(_batch), WriteBatchSize);
+    for (const Keyframe& keyframe : _batch) {
+        switch (keyframe.type) {
+            case Keyframe::Type::Camera:
+                writeCameraKeyframe(_buffer, keyframe, isBinary);
+                break;
+            case Keyframe::Type::Time:
+                writeTimeKeyframe(_buffer, keyframe, isBinary);
+                break;
+            case Keyframe::Type::Script:
+                writeScriptKeyframe(_buffer, keyframe, isBinary);
+                break;
+        }
+    }
+
+    if (!_buffer.empty()) {
+        const size_t written = std::fwrite(
+            _buffer.data(),
+            sizeof(char),
+            _buffer.size(),
+            _file
+        );
+        if (written != _buffer.size() && !_hasWriteFailed) {
+            LERROR("Error writing keyframes to the recording file");
+            _hasWriteFailed = true;
+        }
+        _buffer.clear();
+    }
+
+    return !_batch.empty();
+}
+
+} // namespace openspace::interaction
@@ -40,58 +40,14 @@
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
 #include <iomanip>
 
 namespace {
     constexpr const char* _loggerCat = "SessionRecording";
 
     constexpr const bool UsingTimeKeyframes = false;
-    const std::string FileHeaderTitle = "OpenSpace_record/playback";
-    constexpr const size_t FileHeaderVersionLength = 5;
-    constexpr const char FileHeaderVersion[FileHeaderVersionLength] = {
-        '0', '0', '.', '8', '5'
-    };
-    constexpr const char DataFormatAsciiTag = 'A';
-    constexpr const char DataFormatBinaryTag = 'B';
-
-
-    template <typename T>
-    T readFromPlayback(std::ifstream& stream) {
-        T res;
-        stream.read(reinterpret_cast<char*>(&res), sizeof(T));
-        return res;
-    }
-
-    template <>
-    bool readFromPlayback(std::ifstream& stream) {
-        unsigned char b;
-        stream.read(reinterpret_cast<char*>(&b), sizeof(unsigned char));
-        if (b == 0) {
-            return false;
-        }
-        else {
-            return true;
-        }
-    }
-
-    template <>
-    std::string readFromPlayback(std::ifstream& stream) {
-        size_t strLen;
-        // Read string length from file
-        stream.read(reinterpret_cast<char*>(&strLen), sizeof(strLen));
-        // Read back full string
-        std::vector<char> temp(strLen + 1);
-        stream.read(temp.data(), strLen);
-        temp[strLen] = '\0';
-        return temp.data();
-    }
-
-    std::string readHeaderElement(std::ifstream& stream, size_t readLen_chars) {
-        std::vector<char> readTemp(readLen_chars);
-        stream.read(&readTemp[0], readLen_chars);
-        return std::string(readTemp.begin(), readTemp.end());
-    }
-
 } // namespace
 
 #include "sessionrecording_lua.inl"
@@ -141,32 +97,18 @@ bool SessionRecording::startRecording(const std::string& filename) {
         return false;
     }
 
-    _state = SessionState::Recording;
-    _playbackActive_camera = false;
-    _playbackActive_time = false;
-    _playbackActive_script = false;
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        _recordFile.open(absFilename, std::ios::binary);
-    }
-    else {
-        _recordFile.open(absFilename);
-    }
-
-    if (!_recordFile.is_open() || !_recordFile.good()) {
+    if (!_recordingWriter.open(absFilename, _recordingDataMode)) {
         LERROR(fmt::format(
             "Unable to open file {} for keyframe recording", absFilename.c_str()
         ));
         return false;
     }
-    _recordFile << FileHeaderTitle;
-    _recordFile.write(FileHeaderVersion, FileHeaderVersionLength);
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        _recordFile << DataFormatBinaryTag;
-    }
-    else {
-        _recordFile << DataFormatAsciiTag;
-    }
-    _recordFile << '\n';
+    _recordingWriter.start();
+
+    _state = SessionState::Recording;
+    _playbackActive_camera = false;
+    _playbackActive_time = false;
+    _playbackActive_script = false;
 
     LINFO("Session recording started");
     _timestampRecordStarted = global::windowDelegate.applicationTime();
@@ -178,8 +120,17 @@ void SessionRecording::stopRecording() {
         _state = SessionState::Idle;
         LINFO("Session recording stopped");
     }
-    // Close the recording file
-    _recordFile.close();
+
+    // Write the remaining keyframes and close the recording file
+    _recordingWriter.close();
+}
+
+size_t SessionRecording::nDroppedKeyframes() const {
+    return _recordingWriter.nDroppedKeyframes();
+}
+
+size_t SessionRecording::recordingBacklog() const {
+    return _recordingWriter.backlog();
 }
 
 bool SessionRecording::startPlayback(const std::string& filename,
@@ -206,53 +157,16 @@ bool SessionRecording::startPlayback(const std::string& filename,
         return false;
     }
 
-    _playbackLineNum = 1;
     _playbackFilename = absFilename;
-
-    // Open in ASCII first
-    _playbackFile.open(_playbackFilename, std::ifstream::in);
-    // Read header
-    std::string readBackHeaderString = readHeaderElement(
-        _playbackFile,
-        FileHeaderTitle.length()
-    );
-    if (readBackHeaderString != FileHeaderTitle) {
-        LERROR("Specified playback file does not contain expected header.");
-        cleanUpPlayback();
-        return false;
-    }
-    readHeaderElement(_playbackFile, FileHeaderVersionLength);
-    std::string readDataMode = readHeaderElement(_playbackFile, 1);
-    if (readDataMode[0] == DataFormatAsciiTag) {
-        _recordingDataMode = RecordedDataMode::Ascii;
+    try {
+        _playback = std::make_unique<IndexedRecording>(_playbackFilename);
     }
-    else if (readDataMode[0] == DataFormatBinaryTag) {
-        _recordingDataMode = RecordedDataMode::Binary;
-    }
-    else {
-        LERROR("Unknown data type in header (should be Ascii or Binary)");
-        cleanUpPlayback();
-    }
-    std::string throwawayNewlineChar = readHeaderElement(_playbackFile, 1);
-
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        //Close & re-open the file, starting from the beginning, and do dummy read
-        // past the header, version, and data type
-        _playbackFile.close();
-        _playbackFile.open(_playbackFilename, std::ifstream::in | std::ios::binary);
-        size_t headerSize = FileHeaderTitle.length() + FileHeaderVersionLength +
-                            sizeof(DataFormatBinaryTag) + sizeof('\n');
-        _playbackFile.read(reinterpret_cast<char*>(&_keyframeBuffer), headerSize);
-    }
-
-    if (!_playbackFile.is_open() || !_playbackFile.good()) {
-        LERROR(fmt::format(
-            "Unable to open file {} for keyframe playback", absFilename.c_str()
-        ));
-        stopPlayback();
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
         cleanUpPlayback();
         return false;
     }
+
     //Set time reference mode
     double now = global::windowDelegate.applicationTime();
     _timestampPlaybackStarted_application = now;
@@ -270,20 +184,21 @@ bool SessionRecording::startPlayback(const std::string& filename,
     global::navigationHandler.keyframeNavigator().setTimeReferenceMode(timeMode, now);
     global::scriptScheduler.setTimeReferenceMode(timeMode);
 
-    _setSimulationTimeWithNextCameraKeyframe = forceSimTimeAtStart;
-    if (!playbackAddEntriesToTimeline()) {
-        cleanUpPlayback();
-        return false;
-    }
-
     _hasHitEndOfCameraKeyframes = false;
     findFirstCameraKeyframeInTimeline();
+    if (forceSimTimeAtStart && _playbackActive_camera) {
+        const IndexedRecording::Entry& first = _playback->entry(
+            _idxTimeline_cameraFirstInTimeline
+        );
+        global::timeManager.setTimeNextFrame(first.timeSim);
+        _saveRenderingCurrentRecordedTime = first.timeRec;
+    }
 
     LINFO(fmt::format(
         "Playback session started: ({:8.3f},0.0,{:13.3f}) with {}/{}/{} entries, "
         "forceTime={}",
-        now, _timestampPlaybackStarted_simulation, _keyframesCamera.size(),
-        _keyframesTime.size(), _keyframesScript.size(), (forceSimTimeAtStart ? 1 : 0)
+        now, _timestampPlaybackStarted_simulation, _playback->nCameraKeyframes(),
+        _playback->nTimeKeyframes(), _playback->nScripts(), (forceSimTimeAtStart ? 1 : 0)
     ));
 
     global::navigationHandler.triggerPlaybackStart();
@@ -296,13 +211,14 @@ bool SessionRecording::startPlayback(const std::string& filename,
 
 void SessionRecording::findFirstCameraKeyframeInTimeline() {
     bool foundCameraKeyframe = false;
-    for (unsigned int i = 0; i < _timeline.size(); i++) {
+    for (unsigned int i = 0; i < timelineSize(); i++) {
         if (doesTimelineEntryContainCamera(i)) {
             _idxTimeline_cameraFirstInTimeline = i;
             _idxTimeline_cameraPtrPrev = _idxTimeline_cameraFirstInTimeline;
             _idxTimeline_cameraPtrNext = _idxTimeline_cameraFirstInTimeline;
-            _cameraFirstInTimeline_timestamp
-                = _timeline[_idxTimeline_cameraFirstInTimeline].timestamp;
+            _cameraFirstInTimeline_timestamp = timelineTimestamp(
+                _idxTimeline_cameraFirstInTimeline
+            );
             foundCameraKeyframe = true;
             break;
         }
@@ -351,28 +267,125 @@ void SessionRecording::stopPlayback() {
     }
 }
 
+bool SessionRecording::seekPlayback(double timestamp) {
+    if (_state != SessionState::Playback) {
+        LERROR("Unable to seek while not in session playback mode");
+        return false;
+    }
+
+    if (_playbackTimeReferenceMode == KeyframeTimeRef::Relative_recordedStart) {
+        const double now = global::windowDelegate.applicationTime();
+        _timestampPlaybackStarted_application = now - timestamp;
+        _saveRenderingCurrentRecordedTime = timestamp;
+        global::navigationHandler.keyframeNavigator().setTimeReferenceMode(
+            _playbackTimeReferenceMode,
+            _timestampPlaybackStarted_application
+        );
+    }
+    else if (_playbackTimeReferenceMode == KeyframeTimeRef::Absolute_simTimeJ2000) {
+        global::timeManager.setTimeNextFrame(timestamp);
+    }
+    else {
+        LERROR("Unable to seek in a playback that is relative to the application time");
+        return false;
+    }
+
+    if (timelineSize() == 0) {
+        return true;
+    }
+
+    // Entries before the timestamp are skipped, the first one after it is up next
+    const unsigned int next = static_cast<unsigned int>(
+        _playback->seek(timestamp, _playbackTimeReferenceMode)
+    );
+
+    if (_playback->nCameraKeyframes() > 0) {
+        // The camera interpolates from the last camera keyframe before the timestamp,
+        // or waits at the first keyframe if the timestamp is before it
+        unsigned int prev = _idxTimeline_cameraFirstInTimeline;
+        for (unsigned int i = next; i > _idxTimeline_cameraFirstInTimeline; --i) {
+            if (doesTimelineEntryContainCamera(i - 1)) {
+                prev = i - 1;
+                break;
+            }
+        }
+        _idxTimeline_cameraPtrPrev = prev;
+        _idxTimeline_cameraPtrNext = prev;
+        _hasHitEndOfCameraKeyframes = false;
+        _playbackActive_camera = true;
+    }
+
+    _playbackActive_script = true;
+    _playbackActive_time = UsingTimeKeyframes;
+    if (next < timelineSize()) {
+        _idxTimeline_nonCamera = next;
+    }
+    else {
+        _idxTimeline_nonCamera = timelineSize() - 1;
+        signalPlaybackFinishedForComponent(RecordedType::Script);
+        if (_playbackActive_time) {
+            signalPlaybackFinishedForComponent(RecordedType::Time);
+        }
+    }
+
+    LINFO(fmt::format("Playback moved to {:13.3f}", timestamp));
+    return true;
+}
+
+bool SessionRecording::convertRecording(const std::string& source,
+                                        const std::string& destination)
+{
+    if (source.find("/") != std::string::npos ||
+        destination.find("/") != std::string::npos)
+    {
+        LERROR("Recording filenames must not contain path (/) elements");
+        return false;
+    }
+    const std::string absSource = absPath("${RECORDINGS}/" + source);
+    const std::string absDestination = absPath("${RECORDINGS}/" + destination);
+
+    if (!FileSys.fileExists(absSource)) {
+        LERROR(fmt::format("Cannot find the recording {}", absSource));
+        return false;
+    }
+    if (FileSys.fileExists(absDestination)) {
+        LERROR(fmt::format(
+            "Unable to convert recording; file {} already exists", absDestination
+        ));
+        return false;
+    }
+
+    try {
+        convertToIndexedRecording(absSource, absDestination);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
+        return false;
+    }
+    LINFO(fmt::format("Converted recording {} to {}", absSource, absDestination));
+    return true;
+}
+
 void SessionRecording::cleanUpPlayback() {
     global::navigationHandler.stopPlayback();
 
     Camera* camera = global::navigationHandler.camera();
     ghoul_assert(camera != nullptr, "Camera must not be nullptr");
     Scene* scene = camera->parent()->scene();
-    if (!_timeline.empty()) {
-        unsigned int p = _timeline[_idxTimeline_cameraPtrPrev].idxIntoKeyframeTypeArray;
-        const SceneGraphNode* node = scene->sceneGraphNode(_keyframesCamera[p].focusNode);
+    if (timelineSize() > 0 && doesTimelineEntryContainCamera(_idxTimeline_cameraPtrPrev))
+    {
+        const unsigned int p = _playback->entry(_idxTimeline_cameraPtrPrev).index;
+        const SceneGraphNode* node = scene->sceneGraphNode(
+            _playback->cameraPose(p).focusNode
+        );
         if (node) {
             global::navigationHandler.orbitalNavigator().setFocusNode(node->identifier());
         }
     }
     global::scriptScheduler.stopPlayback();
 
-    _playbackFile.close();
-
-    // Clear all timelines and keyframes
-    _timeline.clear();
-    _keyframesCamera.clear();
-    _keyframesTime.clear();
-    _keyframesScript.clear();
+    // Close the playback file and release all keyframes
+    _playback = nullptr;
     _idxTimeline_nonCamera = 0;
     _idxTime = 0;
     _idxScript = 0;
@@ -384,43 +397,6 @@ void SessionRecording::cleanUpPlayback() {
     _cleanupNeeded = false;
 }
 
-void SessionRecording::writeToFileBuffer(double src) {
-    const size_t writeSize_bytes = sizeof(double);
-    unsigned char const *p = reinterpret_cast<unsigned char const*>(&src);
-    memcpy((_keyframeBuffer + _bufferIndex), p, writeSize_bytes);
-    _bufferIndex += writeSize_bytes;
-}
-
-void SessionRecording::writeToFileBuffer(std::vector<char>& cvec) {
-    const size_t writeSize_bytes = cvec.size() * sizeof(char);
-    memcpy((_keyframeBuffer + _bufferIndex), cvec.data(), writeSize_bytes);
-    _bufferIndex += writeSize_bytes;
-}
-
-void SessionRecording::writeToFileBuffer(unsigned char c) {
-    const size_t writeSize_bytes = sizeof(char);
-    _keyframeBuffer[_bufferIndex] = c;
-    _bufferIndex += writeSize_bytes;
-}
-
-void SessionRecording::writeToFileBuffer(bool b) {
-    _keyframeBuffer[_bufferIndex] = b ? 1 : 0;
-    _bufferIndex += sizeof(char);
-}
-
-void SessionRecording::saveStringToFile(const std::string& s) {
-    size_t strLen = s.size();
-    size_t writeSize_bytes = sizeof(size_t);
-
-    _bufferIndex = 0;
-    unsigned char const *p = reinterpret_cast<unsigned char const*>(&strLen);
-    memcpy((_keyframeBuffer + _bufferIndex), p, writeSize_bytes);
-    _bufferIndex += static_cast<unsigned int>(writeSize_bytes);
-    saveKeyframeToFileBinary(_keyframeBuffer, _bufferIndex);
-
-    _recordFile.write(s.c_str(), s.size());
-}
-
 bool SessionRecording::hasCameraChangedFromPrev(
                                               datamessagestructures::CameraKeyframe kfNew)
 {
@@ -453,54 +429,13 @@ void SessionRecording::saveCameraKeyframe() {
 
     // Create a camera keyframe, then call to populate it with current position
     // & orientation of camera
-    datamessagestructures::CameraKeyframe kf = _externInteract.generateCameraKeyframe();
-
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        // Writing to a binary session recording file
-        _bufferIndex = 0;
-        _keyframeBuffer[_bufferIndex++] = 'c';
-
-        // Writing to internal buffer, and then to file, for performance reasons
-        writeToFileBuffer(kf._timestamp);
-        writeToFileBuffer(kf._timestamp - _timestampRecordStarted);
-        writeToFileBuffer(global::timeManager.time().j2000Seconds());
-        std::vector<char> kfBuffer;
-        kf.serialize(kfBuffer);
-        writeToFileBuffer(kfBuffer);
-
-        saveKeyframeToFileBinary(_keyframeBuffer, _bufferIndex);
-    }
-    else {
-        // Writing to an ASCII session recording file
-        std::stringstream keyframeLine = std::stringstream();
-        // Add simulation timestamp, timestamp relative, simulation time to recording
-        // start
-        keyframeLine << "camera ";
-        keyframeLine << kf._timestamp << ' ';
-        keyframeLine << (kf._timestamp - _timestampRecordStarted) << ' ';
-        keyframeLine << std::fixed << std::setprecision(3) <<
-                        global::timeManager.time().j2000Seconds();
-        keyframeLine << ' ';
-        // Add camera position
-        keyframeLine << std::fixed << std::setprecision(7) << kf._position.x << ' '
-            << std::fixed << std::setprecision(7) << kf._position.y << ' '
-            << std::fixed << std::setprecision(7) << kf._position.z << ' ';
-        // Add camera rotation
-        keyframeLine << std::fixed << std::setprecision(7) << kf._rotation.x << ' '
-            << std::fixed << std::setprecision(7) << kf._rotation.y << ' '
-            << std::fixed << std::setprecision(7) << kf._rotation.z << ' '
-            << std::fixed << std::setprecision(7) << kf._rotation.w << ' ';
-        keyframeLine << std::scientific << kf._scale << ' ';
-        if (kf._followNodeRotation) {
-            keyframeLine << "F ";
-        }
-        else {
-            keyframeLine << "- ";
-        }
-        keyframeLine << kf._focusNode;
-
-        saveKeyframeToFile(keyframeLine.str());
-    }
+    RecordingWriter::Keyframe keyframe;
+    keyframe.type = RecordingWriter::Keyframe::Type::Camera;
+    keyframe.camera = _externInteract.generateCameraKeyframe();
+    keyframe.timestamp = keyframe.camera._timestamp;
+    keyframe.timestampRelative = keyframe.camera._timestamp - _timestampRecordStarted;
+    keyframe.simulationTime = global::timeManager.time().j2000Seconds();
+    _recordingWriter.queueKeyframe(std::move(keyframe));
 }
 
 void SessionRecording::saveTimeKeyframe() {
@@ -509,43 +444,13 @@ void SessionRecording::saveTimeKeyframe() {
     }
 
     //Create a time keyframe, then call to populate it with current time props
-    datamessagestructures::TimeKeyframe kf = _externInteract.generateTimeKeyframe();
-
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        _bufferIndex = 0;
-        _keyframeBuffer[_bufferIndex++] = 't';
-        writeToFileBuffer(kf._timestamp);
-        writeToFileBuffer(kf._timestamp - _timestampRecordStarted);
-        writeToFileBuffer(kf._time);
-        writeToFileBuffer(kf._dt);
-        writeToFileBuffer(kf._paused);
-        writeToFileBuffer(kf._requiresTimeJump);
-
-        saveKeyframeToFileBinary(_keyframeBuffer, _bufferIndex);
-    } else {
-        std::stringstream keyframeLine = std::stringstream();
-        //Add simulation timestamp, timestamp relative, simulation time to recording start
-        keyframeLine << "time ";
-        keyframeLine << kf._timestamp << ' ';
-        keyframeLine << (kf._timestamp - _timestampRecordStarted) << ' ';
-
-        keyframeLine << std::fixed << std::setprecision(3) << kf._time;
-
-        keyframeLine << ' ' << kf._dt;
-        if (kf._paused) {
-            keyframeLine << " P";
-        }
-        else {
-            keyframeLine << " R";
-        }
-        if (kf._requiresTimeJump) {
-            keyframeLine << " J";
-        }
-        else {
-            keyframeLine << " -";
-        }
-        saveKeyframeToFile(keyframeLine.str());
-    }
+    RecordingWriter::Keyframe keyframe;
+    keyframe.type = RecordingWriter::Keyframe::Type::Time;
+    keyframe.time = _externInteract.generateTimeKeyframe();
+    keyframe.timestamp = keyframe.time._timestamp;
+    keyframe.timestampRelative = keyframe.time._timestamp - _timestampRecordStarted;
+    keyframe.simulationTime = keyframe.time._time;
+    _recordingWriter.queueKeyframe(std::move(keyframe));
 }
 
 void SessionRecording::saveScriptKeyframe(std::string scriptToSave) {
@@ -556,34 +461,13 @@ void SessionRecording::saveScriptKeyframe(std::string scriptToSave) {
     datamessagestructures::ScriptMessage sm
         = _externInteract.generateScriptMessage(scriptToSave);
 
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        _bufferIndex = 0;
-        _keyframeBuffer[_bufferIndex++] = 's';
-        writeToFileBuffer(sm._timestamp);
-        writeToFileBuffer(sm._timestamp - _timestampRecordStarted);
-        writeToFileBuffer(global::timeManager.time().j2000Seconds());
-        //Write header to file
-        saveKeyframeToFileBinary(_keyframeBuffer, _bufferIndex);
-
-        saveStringToFile(scriptToSave);
-    }
-    else {
-        unsigned int numLinesInScript = static_cast<unsigned int>(
-            std::count(scriptToSave.begin(), scriptToSave.end(), '\n')
-        );
-        std::stringstream keyframeLine = std::stringstream();
-        //Add simulation timestamp, timestamp relative, simulation time to recording start
-        keyframeLine << "script ";
-        keyframeLine << sm._timestamp << ' ';
-        keyframeLine << (sm._timestamp - _timestampRecordStarted) << ' ';
-        keyframeLine << std::fixed << std::setprecision(3) <<
-                        global::timeManager.time().j2000Seconds();
-        keyframeLine << ' ';
-        keyframeLine << (numLinesInScript + 1) << ' ';
-        keyframeLine << scriptToSave;
-
-        saveKeyframeToFile(keyframeLine.str());
-    }
+    RecordingWriter::Keyframe keyframe;
+    keyframe.type = RecordingWriter::Keyframe::Type::Script;
+    keyframe.timestamp = sm._timestamp;
+    keyframe.timestampRelative = sm._timestamp - _timestampRecordStarted;
+    keyframe.simulationTime = global::timeManager.time().j2000Seconds();
+    keyframe.script = std::move(scriptToSave);
+    _recordingWriter.queueKeyframe(std::move(keyframe));
 }
 
 void SessionRecording::preSynchronization() {
@@ -627,100 +511,6 @@ SessionRecording::SessionState SessionRecording::state() const {
     return _state;
 }
 
-bool SessionRecording::playbackAddEntriesToTimeline() {
-    bool parsingErrorsFound = false;
-
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        unsigned char frameType;
-        bool fileReadOk = true;
-
-        while (fileReadOk) {
-            frameType = readFromPlayback<unsigned char>(_playbackFile);
-            // Check if have reached EOF
-            if (!_playbackFile) {
-                LINFO(fmt::format(
-                    "Finished parsing {} entries from playback file {}",
-                    _playbackLineNum - 1, _playbackFilename
-                ));
-                fileReadOk = false;
-                break;
-            }
-            if (frameType == 'c') {
-                playbackCamera();
-            }
-            else if (frameType == 't') {
-                playbackTimeChange();
-            }
-            else if (frameType == 's') {
-                playbackScript();
-            }
-            else {
-                LERROR(fmt::format(
-                    "Unknown frame type {} @ index {} of playback file {}",
-                    frameType, _playbackLineNum - 1, _playbackFilename
-                ));
-                parsingErrorsFound = true;
-                break;
-            }
-
-            _playbackLineNum++;
-        }
-    }
-    else {
-        while (std::getline(_playbackFile, _playbackLineParsing)) {
-            _playbackLineNum++;
-
-            std::istringstream iss(_playbackLineParsing);
-            std::string entryType;
-            if (!(iss >> entryType)) {
-                LERROR(fmt::format(
-                    "Error reading entry type @ line {} of playback file {}",
-                    _playbackLineNum, _playbackFilename
-                ));
-                break;
-            }
-
-            if (entryType == "camera") {
-                playbackCamera();
-            }
-            else if (entryType == "time") {
-                playbackTimeChange();
-            }
-            else if (entryType == "script") {
-                playbackScript();
-            }
-            else {
-                LERROR(fmt::format(
-                    "Unknown frame type {} @ line {} of playback file {}",
-                    entryType, _playbackLineNum, _playbackFilename
-                ));
-                parsingErrorsFound = true;
-                break;
-            }
-        }
-        LINFO(fmt::format(
-            "Finished parsing {} entries from playback file {}",
-            _playbackLineNum, _playbackFilename
-        ));
-    }
-
-    return !parsingErrorsFound;
-}
-
-double SessionRecording::appropriateTimestamp(double timeOs, double timeRec,
-                                              double timeSim)
-{
-    if (_playbackTimeReferenceMode == KeyframeTimeRef::Relative_recordedStart) {
-        return timeRec;
-    }
-    else if (_playbackTimeReferenceMode == KeyframeTimeRef::Absolute_simTimeJ2000) {
-        return timeSim;
-    }
-    else {
-        return timeOs;
-    }
-}
-
 double SessionRecording::equivalentSimulationTime(double timeOs, double timeRec,
                                                   double timeSim)
 {
@@ -779,248 +569,6 @@ double SessionRecording::fixedDeltaTimeDuringFrameOutput() const {
     }
 }
 
-void SessionRecording::playbackCamera() {
-    double timeOs;
-    double timeRec;
-    double timeSim;
-    std::string rotationFollowing;
-    interaction::KeyframeNavigator::CameraPose pbFrame;
-    datamessagestructures::CameraKeyframe kf;
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        try {
-            kf.read(&_playbackFile);
-        }
-        catch (std::bad_alloc&) {
-            LERROR(fmt::format(
-                "Allocation error with camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-        catch (std::length_error&) {
-            LERROR(fmt::format(
-                "length_error with camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-
-        timeOs = kf._timestamp;
-
-        pbFrame.focusNode = kf._focusNode;
-        pbFrame.position = kf._position;
-        pbFrame.rotation = kf._rotation;
-        pbFrame.scale = kf._scale;
-        pbFrame.followFocusNodeRotation = kf._followNodeRotation;
-
-        if (!_playbackFile) {
-            LINFO(fmt::format(
-                "Error reading camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-    }
-    else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> pbFrame.position.x
-            >> pbFrame.position.y
-            >> pbFrame.position.z
-            >> pbFrame.rotation.x
-            >> pbFrame.rotation.y
-            >> pbFrame.rotation.z
-            >> pbFrame.rotation.w
-            >> pbFrame.scale
-            >> rotationFollowing
-            >> pbFrame.focusNode;
-        if (iss.fail() || !iss.eof()) {
-            LERROR(fmt::format(
-                "Error parsing camera line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        pbFrame.followFocusNodeRotation = (rotationFollowing == "F");
-    }
-    if (_setSimulationTimeWithNextCameraKeyframe) {
-        global::timeManager.setTimeNextFrame(timeSim);
-        _setSimulationTimeWithNextCameraKeyframe = false;
-        _saveRenderingCurrentRecordedTime = timeRec;
-    }
-    double timeRef = appropriateTimestamp(timeOs, timeRec, timeSim);
-
-    //global::navigationHandler.keyframeNavigator().addKeyframe(timeRef, pbFrame);
-    addKeyframe(timeRef, pbFrame);
-}
-
-void SessionRecording::playbackTimeChange() {
-    double timeOs;
-    double timeRec;
-    double timeSim;
-    datamessagestructures::TimeKeyframe pbFrame;
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        pbFrame._dt = readFromPlayback<double>(_playbackFile);
-        pbFrame._paused = readFromPlayback<bool>(_playbackFile);
-        pbFrame._requiresTimeJump = readFromPlayback<bool>(_playbackFile);
-
-        if (!_playbackFile) {
-            LERROR(fmt::format(
-                "Error reading time playback from keyframe entry {}", _playbackLineNum - 1
-            ));
-            return;
-        }
-    } else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        //double timeRef;
-        std::string paused, jump;
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> pbFrame._dt
-            >> paused
-            >> jump;
-        if (iss.fail() || !iss.eof()) {
-            LERROR(fmt::format(
-                "Error parsing time line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        pbFrame._paused = (paused == "P");
-        pbFrame._requiresTimeJump = (jump == "J");
-    }
-    pbFrame._timestamp = equivalentApplicationTime(timeOs, timeRec, timeSim);
-
-    pbFrame._time = pbFrame._timestamp + _timestampApplicationStarted_simulation;
-    //global::timeManager.addKeyframe(timeRef, pbFrame._timestamp);
-    //_externInteract.timeInteraction(pbFrame);
-    addKeyframe(pbFrame._timestamp, pbFrame);
-}
-
-void SessionRecording::playbackScript() {
-    double timeOs;
-    double timeRec;
-    double timeSim;
-    unsigned int numScriptLines;
-    datamessagestructures::ScriptMessage pbFrame;
-
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        try {
-            pbFrame._script = readFromPlayback<std::string>(_playbackFile);
-        }
-        catch (std::bad_alloc&) {
-            LERROR(fmt::format(
-                "Allocation error with script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-        catch (std::length_error&) {
-            LERROR(fmt::format(
-                "length_error with script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-
-        if (!_playbackFile) {
-            LERROR(fmt::format(
-                "Error reading script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-    } else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        std::string tmpReadbackScript;
-
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> numScriptLines;
-        std::getline(iss, tmpReadbackScript); //iss >> tmpReadbackScript;
-        pbFrame._script.append(tmpReadbackScript);
-        if (iss.fail()) {
-            LERROR(fmt::format(
-                "Error parsing script line {} of playback file", _playbackLineNum
-            ));
-            return;
-        } else if (!iss.eof()) {
-            LERROR(fmt::format(
-                "Did not find an EOL at line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        if (numScriptLines > 1) {
-            //Now loop to read any subsequent lines if is a multi-line script
-            for (unsigned int i = 1; i < numScriptLines; ++i) {
-                pbFrame._script.append("\n");
-                std::getline(_playbackFile, tmpReadbackScript);
-                pbFrame._script.append(tmpReadbackScript);
-            }
-        }
-    }
-    double timeRef = appropriateTimestamp(timeOs, timeRec, timeSim);
-    //timeRef = getEquivalentSimulationTime(timeOs, timeRec, timeSim);
-
-    //Call script scheduler with this new script entry
-    //std::string timeDescription = SpiceManager::ref().dateFromEphemerisTime(
-    //  timeRef,
-    //  "YYYY MON DD HR:MN:SC.###"
-    //);
-    //ghoul::Dictionary scriptDict(ghoul::Dictionary{
-    //  { KeyTime, timeDescription },
-    //  { KeyForwardScript, pbFrame._script}
-    //}
-    //                            );
-    //global::scriptScheduler.loadScripts({ { "1", scriptDict } });
-    addKeyframe(timeRef, pbFrame._script);
-}
-
-void SessionRecording::addKeyframe(double timestamp,
-                                   interaction::KeyframeNavigator::CameraPose keyframe)
-{
-    size_t indexIntoCameraKeyframesFromMainTimeline = _keyframesCamera.size();
-    _keyframesCamera.push_back(std::move(keyframe));
-    _timeline.push_back({
-        RecordedType::Camera,
-        static_cast<unsigned int>(indexIntoCameraKeyframesFromMainTimeline),
-        timestamp
-    });
-}
-
-void SessionRecording::addKeyframe(double timestamp,
-                                   datamessagestructures::TimeKeyframe keyframe)
-{
-    size_t indexIntoTimeKeyframesFromMainTimeline = _keyframesTime.size();
-    _keyframesTime.push_back(std::move(keyframe));
-    _timeline.push_back({
-        RecordedType::Time,
-        static_cast<unsigned int>(indexIntoTimeKeyframesFromMainTimeline),
-        timestamp
-    });
-}
-
-void SessionRecording::addKeyframe(double timestamp, std::string scriptToQueue) {
-    size_t indexIntoScriptKeyframesFromMainTimeline = _keyframesScript.size();
-    _keyframesScript.push_back(std::move(scriptToQueue));
-    _timeline.push_back({
-        RecordedType::Script,
-        static_cast<unsigned int>(indexIntoScriptKeyframesFromMainTimeline),
-        timestamp
-    });
-}
-
 void SessionRecording::moveAheadInTime() {
     double currTime = currentTime();
     lookForNonCameraKeyframesThatHaveComeDue(currTime);
@@ -1044,7 +592,7 @@ void SessionRecording::lookForNonCameraKeyframesThatHaveComeDue(double currTime)
             break;
         }
 
-        if (++_idxTimeline_nonCamera >= _timeline.size()) {
+        if (++_idxTimeline_nonCamera >= timelineSize()) {
             _idxTimeline_nonCamera--;
             if (_playbackActive_time) {
                 signalPlaybackFinishedForComponent(RecordedType::Time);
@@ -1086,16 +634,16 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
     unsigned int seekAheadIndex = _idxTimeline_cameraPtrPrev;
     while (true) {
         seekAheadIndex++;
-        if (seekAheadIndex >= static_cast<unsigned int>(_timeline.size())) {
-            seekAheadIndex = static_cast<unsigned int>(_timeline.size()) - 1;
+        if (seekAheadIndex >= timelineSize()) {
+            seekAheadIndex = timelineSize() - 1;
         }
 
         if (doesTimelineEntryContainCamera(seekAheadIndex)) {
             unsigned int indexIntoCameraKeyframes =
-                _timeline[seekAheadIndex].idxIntoKeyframeTypeArray;
-            double seekAheadKeyframeTimestamp = _timeline[seekAheadIndex].timestamp;
+                _playback->entry(seekAheadIndex).index;
+            double seekAheadKeyframeTimestamp = timelineTimestamp(seekAheadIndex);
 
-            if (indexIntoCameraKeyframes >= (_keyframesCamera.size() - 1)) {
+            if (indexIntoCameraKeyframes >= (_playback->nCameraKeyframes() - 1)) {
                 _hasHitEndOfCameraKeyframes = true;
             }
 
@@ -1112,14 +660,14 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
         }
 
         double interpolationUpperBoundTimestamp =
-            _timeline[_idxTimeline_cameraPtrNext].timestamp;
+            timelineTimestamp(_idxTimeline_cameraPtrNext);
         if ((currTime > interpolationUpperBoundTimestamp) && _hasHitEndOfCameraKeyframes)
         {
             _idxTimeline_cameraPtrPrev = _idxTimeline_cameraPtrNext;
             return false;
         }
 
-        if (seekAheadIndex == (_timeline.size() - 1)) {
+        if (seekAheadIndex == (timelineSize() - 1)) {
             break;
         }
     }
@@ -1127,7 +675,33 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
 }
 
 bool SessionRecording::doesTimelineEntryContainCamera(unsigned int index) const {
-    return (_timeline[index].keyframeType == RecordedType::Camera);
+    return (timelineEntryType(index) == RecordedType::Camera);
+}
+
+unsigned int SessionRecording::timelineSize() const {
+    return _playback ? static_cast<unsigned int>(_playback->nEntries()) : 0;
+}
+
+SessionRecording::RecordedType SessionRecording::timelineEntryType(
+                                                               unsigned int index) const
+{
+    switch (_playback->entry(index).type) {
+        case IndexedRecording::EntryType::Camera:
+            return RecordedType::Camera;
+        case IndexedRecording::EntryType::Time:
+            return RecordedType::Time;
+        case IndexedRecording::EntryType::Script:
+            return RecordedType::Script;
+        default:
+            return RecordedType::Invalid;
+    }
+}
+
+double SessionRecording::timelineTimestamp(unsigned int index) const {
+    return IndexedRecording::timestamp(
+        _playback->entry(index),
+        _playbackTimeReferenceMode
+    );
 }
 
 bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
@@ -1141,15 +715,15 @@ bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
             // Just return true since this function no longer handles camera keyframes
             return true;
         case RecordedType::Time:
-            _idxTime = _timeline[_idxTimeline_nonCamera].idxIntoKeyframeTypeArray;
-            if (_keyframesTime.empty()) {
+            _idxTime = _playback->entry(_idxTimeline_nonCamera).index;
+            if (_playback->nTimeKeyframes() == 0) {
                 return false;
             }
             LINFO("Time keyframe type");
             // TBD: the TimeManager restricts setting time directly
             return false;
         case RecordedType::Script:
-            _idxScript = _timeline[_idxTimeline_nonCamera].idxIntoKeyframeTypeArray;
+            _idxScript = _playback->entry(_idxTimeline_nonCamera).index;
             return processScriptKeyframe();
         default:
             LERROR(fmt::format(
@@ -1163,9 +737,9 @@ bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
 //void SessionRecording::moveBackInTime() { } //for future use
 
 unsigned int SessionRecording::findIndexOfLastCameraKeyframeInTimeline() {
-    unsigned int i = static_cast<unsigned int>(_timeline.size()) - 1;
+    unsigned int i = timelineSize() - 1;
     for (; i > 0; i--) {
-        if (_timeline[i].keyframeType == RecordedType::Camera) {
+        if (doesTimelineEntryContainCamera(i)) {
             break;
         }
     }
@@ -1181,20 +755,20 @@ bool SessionRecording::processCameraKeyframe(double now) {
     if (!_playbackActive_camera) {
         return false;
     }
-    else if (_keyframesCamera.empty()) {
+    else if (_playback->nCameraKeyframes() == 0) {
         return false;
     }
     else {
-        prevIdx = _timeline[_idxTimeline_cameraPtrPrev].idxIntoKeyframeTypeArray;
-        prevPose = _keyframesCamera[prevIdx];
-        nextIdx = _timeline[_idxTimeline_cameraPtrNext].idxIntoKeyframeTypeArray;
-        nextPose = _keyframesCamera[nextIdx];
+        prevIdx = _playback->entry(_idxTimeline_cameraPtrPrev).index;
+        prevPose = _playback->cameraPose(prevIdx);
+        nextIdx = _playback->entry(_idxTimeline_cameraPtrNext).index;
+        nextPose = _playback->cameraPose(nextIdx);
     }
 
     // getPrevTimestamp();
-    double prevTime = _timeline[_idxTimeline_cameraPtrPrev].timestamp;
+    double prevTime = timelineTimestamp(_idxTimeline_cameraPtrPrev);
     // getNextTimestamp();
-    double nextTime = _timeline[_idxTimeline_cameraPtrNext].timestamp;
+    double nextTime = timelineTimestamp(_idxTimeline_cameraPtrNext);
 
     double t;
     if ((nextTime - prevTime) < 1e-7) {
@@ -1215,7 +789,7 @@ bool SessionRecording::processCameraKeyframe(double now) {
     Camera* camera = global::navigationHandler.camera();
     Scene* scene = camera->parent()->scene();
 
-    const SceneGraphNode* n = scene->sceneGraphNode(_keyframesCamera[prevIdx].focusNode);
+    const SceneGraphNode* n = scene->sceneGraphNode(prevPose.focusNode);
 
     if (n) {
         global::navigationHandler.orbitalNavigator().setFocusNode(n->identifier());
@@ -1234,88 +808,80 @@ bool SessionRecording::processScriptKeyframe() {
     if (!_playbackActive_script) {
         return false;
     }
-    else if (_keyframesScript.empty()) {
+    else if (_playback->nScripts() == 0) {
         return false;
     }
     else {
-        std::string nextScript = nextKeyframeObj(
-            _idxScript,
-            _keyframesScript,
-            ([this]() { signalPlaybackFinishedForComponent(RecordedType::Script); })
-        );
+        const unsigned int nScripts = static_cast<unsigned int>(_playback->nScripts());
+        const unsigned int index = std::min(_idxScript, nScripts - 1);
         global::scriptEngine.queueScript(
-            nextScript,
+            std::string(_playback->script(index)),
             scripting::ScriptEngine::RemoteScripting::Yes
         );
+        if (_idxScript >= nScripts - 1) {
+            signalPlaybackFinishedForComponent(RecordedType::Script);
+        }
     }
 
     return true;
 }
 
 double SessionRecording::getNextTimestamp() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return 0.0;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return _timeline[_idxTimeline_nonCamera].timestamp;
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return timelineTimestamp(_idxTimeline_nonCamera);
     }
     else {
-        return _timeline.back().timestamp;
+        return timelineTimestamp(timelineSize() - 1);
     }
 }
 
 double SessionRecording::getPrevTimestamp() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return 0.0;
     }
     else if (_idxTimeline_nonCamera == 0) {
-        return _timeline.front().timestamp;
+        return timelineTimestamp(0);
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return _timeline[_idxTimeline_nonCamera - 1].timestamp;
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return timelineTimestamp(_idxTimeline_nonCamera - 1);
     }
     else {
-        return _timeline.back().timestamp;
+        return timelineTimestamp(timelineSize() - 1);
     }
 }
 
 SessionRecording::RecordedType SessionRecording::getNextKeyframeType() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return RecordedType::Invalid;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return _timeline[_idxTimeline_nonCamera].keyframeType;
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return timelineEntryType(_idxTimeline_nonCamera);
     }
     else {
-        return _timeline.back().keyframeType;
+        return timelineEntryType(timelineSize() - 1);
     }
 }
 
 SessionRecording::RecordedType SessionRecording::getPrevKeyframeType() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return RecordedType::Invalid;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
+    else if (_idxTimeline_nonCamera < timelineSize()) {
         if (_idxTimeline_nonCamera > 0) {
-            return _timeline[_idxTimeline_nonCamera - 1].keyframeType;
+            return timelineEntryType(_idxTimeline_nonCamera - 1);
         }
         else {
-            return _timeline.front().keyframeType;
+            return timelineEntryType(0);
         }
     }
     else {
-        return _timeline.back().keyframeType;
+        return timelineEntryType(timelineSize() - 1);
     }
 }
 
-void SessionRecording::saveKeyframeToFileBinary(unsigned char* buffer, size_t size) {
-    _recordFile.write(reinterpret_cast<char*>(buffer), size);
-}
-
-void SessionRecording::saveKeyframeToFile(std::string entry) {
-    _recordFile << std::move(entry) << std::endl;
-}
-
 SessionRecording::CallbackHandle SessionRecording::addStateChangeCallback(
                                                                    StateChangeCallback cb)
 {
@@ -1429,6 +995,26 @@ scripting::LuaLibrary SessionRecording::luaLibrary() {
                 "void",
                 "Stops a playback session before playback of all keyframes is complete"
             },
+            {
+                "seekPlayback",
+                &luascriptfunctions::seekPlayback,
+                {},
+                "number",
+                "Moves the playback session in progress to the provided time, which is "
+                "interpreted in the time mode of the playback (seconds since the "
+                "recording was started, or simulation time in J2000 seconds). Playback "
+                "sessions that are relative to the application time cannot be moved."
+            },
+            {
+                "convertRecording",
+                &luascriptfunctions::convertRecording,
+                {},
+                "string, string",
+                "Converts the ASCII or binary recording with the filename provided as "
+                "the first argument into an indexed recording with the filename provided "
+                "as the second argument. Indexed recordings start playing back "
+                "immediately and can be moved to any time using seekPlayback."
+            },
             {
                 "enableTakeScreenShotDuringPlayback",
                 &luascriptfunctions::enableTakeScreenShotDuringPlayback,
@@ -142,6 +142,34 @@ int stopPlayback(lua_State* L) {
     return 0;
 }
 
+int seekPlayback(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 1, "lua::seekPlayback");
+
+    const double timestamp = ghoul::lua::value<double>(L, 1, ghoul::lua::PopValue::Yes);
+
+    global::sessionRecording.seekPlayback(timestamp);
+
+    ghoul_assert(lua_gettop(L) == 0, "Incorrect number of items left on stack");
+    return 0;
+}
+
+int convertRecording(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 2, "lua::convertRecording");
+
+    const std::string source = ghoul::lua::value<std::string>(L, 1);
+    const std::string destination = ghoul::lua::value<std::string>(L, 2);
+    lua_settop(L, 0);
+
+    if (source.empty() || destination.empty()) {
+        return luaL_error(L, "filepath string is empty");
+    }
+
+    global::sessionRecording.convertRecording(source, destination);
+
+    ghoul_assert(lua_gettop(L) == 0, "Incorrect number of items left on stack");
+    return 0;
+}
+
 int enableTakeScreenShotDuringPlayback(lua_State* L) {
     ghoul::lua::checkArgumentsAndThrow(L, 1, "lua::enableTakeScreenShotDuringPlayback");
 
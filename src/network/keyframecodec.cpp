@@ -0,0 +1,362 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/network/keyframecodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    enum BatchFlags : uint8_t {
+        Reset = 1,
+        HasTimeline = 2,
+        ClearTimeline = 4
+    };
+
+    enum CameraFlags : uint8_t {
+        LargestComponentMask = 3,
+        FollowNodeRotation = 4,
+        DeltaPosition = 8
+    };
+
+    enum TimeFlags : uint8_t {
+        Paused = 1,
+        RequiresTimeJump = 2
+    };
+
+    // Single precision position deltas are only used if the reconstructed position is
+    // within this distance of the real position, relative to the distance to the focus
+    // node. The decoder reconstructs positions exactly as the encoder does, so the error
+    // does not accumulate over consecutive deltas
+    constexpr const double PositionTolerance = 1e-9;
+
+    // The three smallest components of a unit quaternion are in [-1/sqrt(2), 1/sqrt(2)]
+    constexpr const double RotationScale = 32767.0 * 1.4142135623730951;
+
+    template <typename T>
+    void append(std::vector<char>& buffer, const T& value) {
+        buffer.insert(
+            buffer.end(),
+            reinterpret_cast<const char*>(&value),
+            reinterpret_cast<const char*>(&value) + sizeof(T)
+        );
+    }
+
+    template <typename T>
+    bool read(const std::vector<char>& buffer, size_t& offset, T& value) {
+        if (offset + sizeof(T) > buffer.size()) {
+            return false;
+        }
+        std::memcpy(&value, buffer.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    uint8_t quantizeRotation(const glm::dquat& rotation, int16_t components[3]) {
+        const glm::dquat q = glm::normalize(rotation);
+        const double c[4] = { q.x, q.y, q.z, q.w };
+
+        uint8_t largest = 0;
+        for (uint8_t i = 1; i < 4; ++i) {
+            if (std::abs(c[i]) > std::abs(c[largest])) {
+                largest = i;
+            }
+        }
+
+        // q and -q are the same rotation, so the largest component can always be made
+        // positive and does not have to be sent
+        const double sign = c[largest] < 0.0 ? -1.0 : 1.0;
+        int j = 0;
+        for (uint8_t i = 0; i < 4; ++i) {
+            if (i != largest) {
+                const double v = std::round(sign * c[i] * RotationScale);
+                components[j++] = static_cast<int16_t>(std::clamp(v, -32767.0, 32767.0));
+            }
+        }
+        return largest;
+    }
+
+    glm::dquat dequantizeRotation(uint8_t largest, const int16_t components[3]) {
+        double c[4];
+        double sumSquared = 0.0;
+        int j = 0;
+        for (uint8_t i = 0; i < 4; ++i) {
+            if (i != largest) {
+                c[i] = components[j++] / RotationScale;
+                sumSquared += c[i] * c[i];
+            }
+        }
+        c[largest] = std::sqrt(std::max(0.0, 1.0 - sumSquared));
+        return glm::normalize(glm::dquat(c[3], c[0], c[1], c[2]));
+    }
+} // namespace
+
+namespace openspace::datamessagestructures {
+
+void KeyframeEncoder::encode(const KeyframeBatch& batch, std::vector<char>& buffer) {
+    const bool reset = _resetRequested || _batchesSinceReset >= ResetInterval ||
+        _nodeIds.size() + batch.cameraKeyframes.size() >
+        std::numeric_limits<uint16_t>::max();
+
+    if (reset) {
+        _nodeIds.clear();
+        _lastPositions.clear();
+        _hasLastPosition.clear();
+        _batchesSinceReset = 0;
+        _resetRequested = false;
+    }
+    ++_batchesSinceReset;
+
+    // Focus nodes that are used for the first time are assigned the next free id
+    std::vector<const std::string*> newNodes;
+    for (const CameraKeyframe& kf : batch.cameraKeyframes) {
+        if (_nodeIds.find(kf._focusNode) == _nodeIds.end()) {
+            _nodeIds[kf._focusNode] = static_cast<uint16_t>(_lastPositions.size());
+            _lastPositions.emplace_back(0.0);
+            _hasLastPosition.push_back(false);
+            newNodes.push_back(&kf._focusNode);
+        }
+    }
+
+    double baseTimestamp = 0.0;
+    if (!batch.cameraKeyframes.empty()) {
+        baseTimestamp = batch.cameraKeyframes.front()._timestamp;
+    }
+    else if (batch.hasTimeline && !batch.timeline._keyframes.empty()) {
+        baseTimestamp = batch.timeline._keyframes.front()._timestamp;
+    }
+
+    uint8_t flags = 0;
+    if (reset) {
+        flags |= BatchFlags::Reset;
+    }
+    if (batch.hasTimeline) {
+        flags |= BatchFlags::HasTimeline;
+        if (batch.timeline._clear) {
+            flags |= BatchFlags::ClearTimeline;
+        }
+    }
+
+    append(buffer, static_cast<uint8_t>(KeyframeCodecVersion));
+    append(buffer, flags);
+    append(buffer, _sequenceNumber++);
+    append(buffer, baseTimestamp);
+
+    append(buffer, static_cast<uint16_t>(newNodes.size()));
+    for (const std::string* name : newNodes) {
+        const uint16_t length = static_cast<uint16_t>(
+            std::min<size_t>(name->size(), std::numeric_limits<uint16_t>::max())
+        );
+        append(buffer, length);
+        buffer.insert(buffer.end(), name->data(), name->data() + length);
+    }
+
+    append(buffer, static_cast<uint16_t>(batch.cameraKeyframes.size()));
+    for (const CameraKeyframe& kf : batch.cameraKeyframes) {
+        const uint16_t id = _nodeIds[kf._focusNode];
+
+        int16_t rotation[3];
+        uint8_t cameraFlags = quantizeRotation(kf._rotation, rotation);
+        if (kf._followNodeRotation) {
+            cameraFlags |= CameraFlags::FollowNodeRotation;
+        }
+
+        const glm::vec3 delta = glm::vec3(kf._position - _lastPositions[id]);
+        const glm::dvec3 reconstructed = _lastPositions[id] + glm::dvec3(delta);
+        const bool useDelta = _hasLastPosition[id] &&
+            glm::length(reconstructed - kf._position) <=
+            PositionTolerance * std::max(glm::length(kf._position), 1.0);
+
+        if (useDelta) {
+            cameraFlags |= CameraFlags::DeltaPosition;
+        }
+
+        append(buffer, id);
+        append(buffer, cameraFlags);
+        if (useDelta) {
+            append(buffer, delta);
+            _lastPositions[id] = reconstructed;
+        }
+        else {
+            append(buffer, kf._position);
+            _lastPositions[id] = kf._position;
+        }
+        _hasLastPosition[id] = true;
+
+        append(buffer, rotation);
+        append(buffer, kf._scale);
+        append(buffer, static_cast<float>(kf._timestamp - baseTimestamp));
+    }
+
+    if (batch.hasTimeline) {
+        append(buffer, static_cast<uint16_t>(batch.timeline._keyframes.size()));
+        for (const TimeKeyframe& kf : batch.timeline._keyframes) {
+            uint8_t timeFlags = 0;
+            if (kf._paused) {
+                timeFlags |= TimeFlags::Paused;
+            }
+            if (kf._requiresTimeJump) {
+                timeFlags |= TimeFlags::RequiresTimeJump;
+            }
+
+            append(buffer, kf._time);
+            append(buffer, kf._dt);
+            append(buffer, timeFlags);
+            append(buffer, static_cast<float>(kf._timestamp - baseTimestamp));
+        }
+    }
+}
+
+void KeyframeEncoder::requestReset() {
+    _resetRequested = true;
+}
+
+bool KeyframeDecoder::decode(const std::vector<char>& buffer, KeyframeBatch& batch,
+                             size_t offset)
+{
+    uint8_t version = 0;
+    uint8_t flags = 0;
+    uint16_t sequenceNumber = 0;
+    double baseTimestamp = 0.0;
+    if (!read(buffer, offset, version) || !read(buffer, offset, flags) ||
+        !read(buffer, offset, sequenceNumber) || !read(buffer, offset, baseTimestamp) ||
+        version != KeyframeCodecVersion)
+    {
+        _isValid = false;
+        return false;
+    }
+
+    if (flags & BatchFlags::Reset) {
+        _nodeNames.clear();
+        _lastPositions.clear();
+        _hasLastPosition.clear();
+        _isValid = true;
+    }
+    else if (!_isValid || sequenceNumber != _expectedSequenceNumber) {
+        // We have missed a batch that this one depends on
+        _isValid = false;
+        return false;
+    }
+
+    // From here on, any failure means the buffer was malformed
+    _isValid = false;
+
+    uint16_t nNewNodes = 0;
+    if (!read(buffer, offset, nNewNodes)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < nNewNodes; ++i) {
+        uint16_t length = 0;
+        if (!read(buffer, offset, length) || offset + length > buffer.size()) {
+            return false;
+        }
+        _nodeNames.emplace_back(buffer.data() + offset, buffer.data() + offset + length);
+        _lastPositions.emplace_back(0.0);
+        _hasLastPosition.push_back(false);
+        offset += length;
+    }
+
+    uint16_t nCameraKeyframes = 0;
+    if (!read(buffer, offset, nCameraKeyframes)) {
+        return false;
+    }
+    batch.cameraKeyframes.resize(nCameraKeyframes);
+    for (CameraKeyframe& kf : batch.cameraKeyframes) {
+        uint16_t id = 0;
+        uint8_t cameraFlags = 0;
+        if (!read(buffer, offset, id) || !read(buffer, offset, cameraFlags) ||
+            id >= _nodeNames.size())
+        {
+            return false;
+        }
+
+        if (cameraFlags & CameraFlags::DeltaPosition) {
+            glm::vec3 delta;
+            if (!_hasLastPosition[id] || !read(buffer, offset, delta)) {
+                return false;
+            }
+            _lastPositions[id] += glm::dvec3(delta);
+        }
+        else if (!read(buffer, offset, _lastPositions[id])) {
+            return false;
+        }
+        _hasLastPosition[id] = true;
+
+        int16_t rotation[3];
+        float timestampOffset = 0.f;
+        if (!read(buffer, offset, rotation) || !read(buffer, offset, kf._scale) ||
+            !read(buffer, offset, timestampOffset))
+        {
+            return false;
+        }
+
+        kf._focusNode = _nodeNames[id];
+        kf._position = _lastPositions[id];
+        kf._rotation = dequantizeRotation(
+            cameraFlags & CameraFlags::LargestComponentMask,
+            rotation
+        );
+        kf._followNodeRotation = (cameraFlags & CameraFlags::FollowNodeRotation) != 0;
+        kf._timestamp = baseTimestamp + timestampOffset;
+    }
+
+    batch.hasTimeline = (flags & BatchFlags::HasTimeline) != 0;
+    batch.timeline._clear = (flags & BatchFlags::ClearTimeline) != 0;
+    batch.timeline._keyframes.clear();
+    if (batch.hasTimeline) {
+        uint16_t nTimeKeyframes = 0;
+        if (!read(buffer, offset, nTimeKeyframes)) {
+            return false;
+        }
+        batch.timeline._keyframes.resize(nTimeKeyframes);
+        for (TimeKeyframe& kf : batch.timeline._keyframes) {
+            uint8_t timeFlags = 0;
+            float timestampOffset = 0.f;
+            if (!read(buffer, offset, kf._time) || !read(buffer, offset, kf._dt) ||
+                !read(buffer, offset, timeFlags) ||
+                !read(buffer, offset, timestampOffset))
+            {
+                return false;
+            }
+            kf._paused = (timeFlags & TimeFlags::Paused) != 0;
+            kf._requiresTimeJump = (timeFlags & TimeFlags::RequiresTimeJump) != 0;
+            kf._timestamp = baseTimestamp + timestampOffset;
+        }
+    }
+
+    _isValid = true;
+    _expectedSequenceNumber = static_cast<uint16_t>(sequenceNumber + 1);
+    return true;
+}
+
+void KeyframeDecoder::reset() {
+    _nodeNames.clear();
+    _lastPositions.clear();
+    _hasLastPosition.clear();
+    _isValid = false;
+}
+
+} // namespace openspace::datamessagestructures
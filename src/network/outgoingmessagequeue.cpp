@@ -0,0 +1,96 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <openspace/network/outgoingmessagequeue.h>
+
+#include <algorithm>
+
+namespace openspace {
+
+OutgoingMessageQueue::OutgoingMessageQueue(size_t maxMessages)
+    : _maxMessages(maxMessages)
+{}
+
+OutgoingMessageQueue::PushResult OutgoingMessageQueue::push(Message message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_hasOverflowed) {
+        return PushResult::Rejected;
+    }
+
+    if (message.isCameraKeyframe) {
+        // A camera keyframe that has not been sent yet is superseded by the new one
+        auto it = std::find_if(
+            _messages.begin(),
+            _messages.end(),
+            [](const Message& m) { return m.isCameraKeyframe; }
+        );
+        if (it != _messages.end()) {
+            _messages.erase(it);
+        }
+    }
+
+    if (_messages.size() >= _maxMessages) {
+        _hasOverflowed = true;
+        _messages.clear();
+        return PushResult::Overflow;
+    }
+
+    _messages.push_back(std::move(message));
+    if (_isSending) {
+        return PushResult::Queued;
+    }
+    _isSending = true;
+    return PushResult::StartSending;
+}
+
+std::shared_ptr<const std::vector<char>> OutgoingMessageQueue::pop() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_messages.empty()) {
+        _isSending = false;
+        return nullptr;
+    }
+    std::shared_ptr<const std::vector<char>> encoded =
+        std::move(_messages.front().encoded);
+    _messages.pop_front();
+    return encoded;
+}
+
+void OutgoingMessageQueue::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _messages.clear();
+    _isSending = false;
+}
+
+size_t OutgoingMessageQueue::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _messages.size();
+}
+
+bool OutgoingMessageQueue::hasOverflowed() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hasOverflowed;
+}
+
+} // namespace openspace
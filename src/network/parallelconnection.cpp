@@ -90,36 +90,42 @@ void ParallelConnection::sendDataMessage(const DataMessage& dataMessage) {
 }
 
 bool ParallelConnection::sendMessage(const Message& message) {
-    const uint32_t messageTypeOut = static_cast<uint32_t>(message.type);
-    const uint32_t messageSizeOut = static_cast<uint32_t>(message.content.size());
-    std::vector<char> header;
+    return sendEncodedMessage(encodeMessage(message.type, message.content));
+}
+
+bool ParallelConnection::sendEncodedMessage(const std::vector<char>& encodedMessage) {
+    return _socket->put<char>(encodedMessage.data(), encodedMessage.size());
+}
+
+std::vector<char> ParallelConnection::encodeMessage(MessageType type,
+                                                    const std::vector<char>& content)
+{
+    const uint32_t messageTypeOut = static_cast<uint32_t>(type);
+    const uint32_t messageSizeOut = static_cast<uint32_t>(content.size());
+    std::vector<char> message;
+    message.reserve(2 * sizeof(char) + 3 * sizeof(uint32_t) + content.size());
 
     //insert header into buffer
-    header.push_back('O');
-    header.push_back('S');
+    message.push_back('O');
+    message.push_back('S');
 
-    header.insert(header.end(),
+    message.insert(message.end(),
         reinterpret_cast<const char*>(&ProtocolVersion),
         reinterpret_cast<const char*>(&ProtocolVersion) + sizeof(uint32_t)
     );
 
-    header.insert(header.end(),
+    message.insert(message.end(),
         reinterpret_cast<const char*>(&messageTypeOut),
         reinterpret_cast<const char*>(&messageTypeOut) + sizeof(uint32_t)
     );
 
-    header.insert(header.end(),
+    message.insert(message.end(),
         reinterpret_cast<const char*>(&messageSizeOut),
         reinterpret_cast<const char*>(&messageSizeOut) + sizeof(uint32_t)
     );
 
-    if (!_socket->put<char>(header.data(), header.size())) {
-        return false;
-    }
-    if (!_socket->put<char>(message.content.data(), message.content.size())) {
-        return false;
-    }
-    return true;
+    message.insert(message.end(), content.begin(), content.end());
+    return message;
 }
 
 void ParallelConnection::disconnect() {
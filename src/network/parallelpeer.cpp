@@ -29,6 +29,7 @@
 #include <openspace/interaction/keyframenavigator.h>
 #include <openspace/interaction/navigationhandler.h>
 #include <openspace/interaction/orbitalnavigator.h>
+#include <openspace/network/keyframecodec.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/util/camera.h>
@@ -36,6 +37,7 @@
 #include <openspace/util/timemanager.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/io/socket/tcpsocket.h>
+#include <algorithm>
 
 #include "parallelpeer_lua.inl"
 
@@ -194,6 +196,15 @@ void ParallelPeer::sendAuthentication() {
     // Write this node's name to buffer
     buffer.insert(buffer.end(), name.begin(), name.end());
 
+    // Write the newest keyframe codec version that this node supports. Servers that
+    // don't know about the codecs ignore it
+    const uint32_t codecVersion = datamessagestructures::KeyframeCodecVersion;
+    buffer.insert(
+        buffer.end(),
+        reinterpret_cast<const char*>(&codecVersion),
+        reinterpret_cast<const char*>(&codecVersion) + sizeof(uint32_t)
+    );
+
     // Send message
     _connection.sendMessage(ParallelConnection::Message(
         ParallelConnection::MessageType::Authentication,
@@ -279,66 +290,26 @@ void ParallelPeer::dataMessageReceived(const std::vector<char>& message)
 
     switch (static_cast<datamessagestructures::Type>(type)) {
         case datamessagestructures::Type::CameraData: {
-            datamessagestructures::CameraKeyframe kf(buffer);
-            const double convertedTimestamp = convertTimestamp(kf._timestamp);
-
-            global::navigationHandler.keyframeNavigator().removeKeyframesAfter(
-                convertedTimestamp
-            );
-
-            interaction::KeyframeNavigator::CameraPose pose;
-            pose.focusNode = kf._focusNode;
-            pose.position = kf._position;
-            pose.rotation = kf._rotation;
-            pose.scale = kf._scale;
-            pose.followFocusNodeRotation = kf._followNodeRotation;
-
-            global::navigationHandler.keyframeNavigator().addKeyframe(convertedTimestamp,
-                                                                      pose);
+            applyCameraKeyframe(datamessagestructures::CameraKeyframe(buffer));
             break;
         }
         case datamessagestructures::Type::TimelineData: {
-            const double now = global::windowDelegate.applicationTime();
-            datamessagestructures::TimeTimeline timelineMessage(buffer);
-
-            if (timelineMessage._clear) {
-                global::timeManager.removeKeyframesAfter(
-                    convertTimestamp(timestamp),
-                    true
-                );
-            }
-
-            const std::vector<datamessagestructures::TimeKeyframe>& keyframesMessage =
-                timelineMessage._keyframes;
-
-            // If there are new keyframes incoming, make sure to erase all keyframes
-            // that already exist after the first new keyframe.
-            if (!keyframesMessage.empty()) {
-                const double convertedTimestamp =
-                    convertTimestamp(keyframesMessage[0]._timestamp);
-
-                global::timeManager.removeKeyframesAfter(convertedTimestamp, true);
+            applyTimeTimeline(datamessagestructures::TimeTimeline(buffer), timestamp);
+            break;
+        }
+        case datamessagestructures::Type::KeyframeBatch: {
+            datamessagestructures::KeyframeBatch batch;
+            if (!_keyframeDecoder.decode(buffer, batch)) {
+                // The host sends batches continuously, so we skip ahead until there is
+                // one that does not depend on the batches that we missed
+                break;
             }
-
-            for (const datamessagestructures::TimeKeyframe& kfMessage : keyframesMessage)
+            for (const datamessagestructures::CameraKeyframe& kf : batch.cameraKeyframes)
             {
-                TimeKeyframeData timeKeyframeData;
-                timeKeyframeData.delta = kfMessage._dt;
-                timeKeyframeData.pause = kfMessage._paused;
-                timeKeyframeData.time = kfMessage._time;
-                timeKeyframeData.jump = kfMessage._requiresTimeJump;
-
-                const double kfTimestamp = convertTimestamp(kfMessage._timestamp);
-
-                // We only need at least one keyframe before the current timestamp,
-                // so we can remove any other previous ones
-                if (kfTimestamp < now) {
-                    global::timeManager.removeKeyframesBefore(kfTimestamp, true);
-                }
-                global::timeManager.addKeyframe(
-                    kfTimestamp,
-                    timeKeyframeData
-                );
+                applyCameraKeyframe(kf);
+            }
+            if (batch.hasTimeline) {
+                applyTimeTimeline(batch.timeline, timestamp);
             }
             break;
         }
@@ -362,6 +333,65 @@ void ParallelPeer::dataMessageReceived(const std::vector<char>& message)
     }
 }
 
+void ParallelPeer::applyCameraKeyframe(const datamessagestructures::CameraKeyframe& kf) {
+    const double convertedTimestamp = convertTimestamp(kf._timestamp);
+
+    global::navigationHandler.keyframeNavigator().removeKeyframesAfter(
+        convertedTimestamp
+    );
+
+    interaction::KeyframeNavigator::CameraPose pose;
+    pose.focusNode = kf._focusNode;
+    pose.position = kf._position;
+    pose.rotation = kf._rotation;
+    pose.scale = kf._scale;
+    pose.followFocusNodeRotation = kf._followNodeRotation;
+
+    global::navigationHandler.keyframeNavigator().addKeyframe(convertedTimestamp, pose);
+}
+
+void ParallelPeer::applyTimeTimeline(const datamessagestructures::TimeTimeline& timeline,
+                                     double timestamp)
+{
+    const double now = global::windowDelegate.applicationTime();
+
+    if (timeline._clear) {
+        global::timeManager.removeKeyframesAfter(convertTimestamp(timestamp), true);
+    }
+
+    const std::vector<datamessagestructures::TimeKeyframe>& keyframesMessage =
+        timeline._keyframes;
+
+    // If there are new keyframes incoming, make sure to erase all keyframes
+    // that already exist after the first new keyframe.
+    if (!keyframesMessage.empty()) {
+        const double convertedTimestamp =
+            convertTimestamp(keyframesMessage[0]._timestamp);
+
+        global::timeManager.removeKeyframesAfter(convertedTimestamp, true);
+    }
+
+    for (const datamessagestructures::TimeKeyframe& kfMessage : keyframesMessage) {
+        TimeKeyframeData timeKeyframeData;
+        timeKeyframeData.delta = kfMessage._dt;
+        timeKeyframeData.pause = kfMessage._paused;
+        timeKeyframeData.time = kfMessage._time;
+        timeKeyframeData.jump = kfMessage._requiresTimeJump;
+
+        const double kfTimestamp = convertTimestamp(kfMessage._timestamp);
+
+        // We only need at least one keyframe before the current timestamp,
+        // so we can remove any other previous ones
+        if (kfTimestamp < now) {
+            global::timeManager.removeKeyframesBefore(kfTimestamp, true);
+        }
+        global::timeManager.addKeyframe(
+            kfTimestamp,
+            timeKeyframeData
+        );
+    }
+}
+
 void ParallelPeer::connectionStatusMessageReceived(const std::vector<char>& message)
  {
     if (message.size() < 2 * sizeof(uint32_t)) {
@@ -394,6 +424,18 @@ void ParallelPeer::connectionStatusMessageReceived(const std::vector<char>& mess
         return;
     }
 
+    // Servers that negotiate the keyframe codec append the newest version that all
+    // connected peers support
+    uint32_t codecVersion = 0;
+    if (message.size() - pointer >= sizeof(uint32_t)) {
+        codecVersion = *(reinterpret_cast<const uint32_t*>(&message[pointer]));
+    }
+    codecVersion = std::min(codecVersion, datamessagestructures::KeyframeCodecVersion);
+    if (codecVersion != _keyframeCodecVersion) {
+        _keyframeCodecVersion = codecVersion;
+        _keyframeEncoder.requestReset();
+    }
+
     _latencyMutex.lock();
     _latencyDiffs.clear();
     _latencyMutex.unlock();
@@ -417,6 +459,10 @@ void ParallelPeer::nConnectionsMessageReceived(const std::vector<char>& message)
         return;
     }
     const uint32_t nConnections = *(reinterpret_cast<const uint32_t*>(&message[0]));
+    if (nConnections > _nConnections) {
+        // The new peers can only start decoding batches that don't depend on earlier ones
+        _keyframeEncoder.requestReset();
+    }
     setNConnections(nConnections);
 }
 
@@ -513,14 +559,29 @@ void ParallelPeer::preSynchronization() {
     if (isHost()) {
         double now = global::windowDelegate.applicationTime();
 
-        if (_lastCameraKeyframeTimestamp + _cameraKeyframeInterval < now) {
-            sendCameraKeyframe();
+        const bool sendCamera = _lastCameraKeyframeTimestamp + _cameraKeyframeInterval <
+                                now;
+        const bool sendTime = _timeTimelineChanged ||
+                              _lastTimeKeyframeTimestamp + _timeKeyframeInterval < now;
+
+        if (_keyframeCodecVersion > 0) {
+            if (sendCamera || sendTime) {
+                sendKeyframeBatch(sendCamera, sendTime);
+            }
+        }
+        else {
+            if (sendCamera) {
+                sendCameraKeyframe();
+            }
+            if (sendTime) {
+                sendTimeTimeline();
+            }
+        }
+
+        if (sendCamera) {
             _lastCameraKeyframeTimestamp = now;
         }
-        if (_timeTimelineChanged ||
-            _lastTimeKeyframeTimestamp + _timeKeyframeInterval < now)
-        {
-            sendTimeTimeline();
+        if (sendTime) {
             _lastTimeKeyframeTimestamp = now;
             _timeJumped = false;
             _timeTimelineChanged = false;
@@ -535,6 +596,8 @@ void ParallelPeer::setStatus(ParallelConnection::Status status) {
     if (_status != status) {
         _status = status;
         _timeJumped = true;
+        _keyframeEncoder.requestReset();
+        _keyframeDecoder.reset();
         _connectionEvent->publish("statusChanged");
     }
     if (isHost()) {
@@ -584,17 +647,16 @@ const std::string& ParallelPeer::hostName() {
     return _hostName;
 }
 
-void ParallelPeer::sendCameraKeyframe() {
+bool ParallelPeer::createCameraKeyframe(datamessagestructures::CameraKeyframe& kf) {
     interaction::NavigationHandler& navHandler = global::navigationHandler;
 
     const SceneGraphNode* focusNode =
         navHandler.orbitalNavigator().anchorNode();
     if (!focusNode) {
-        return;
+        return false;
     }
 
     // Create a keyframe with current position and orientation of camera
-    datamessagestructures::CameraKeyframe kf;
     kf._position = navHandler.orbitalNavigator().anchorNodeToCameraVector();
 
     kf._followNodeRotation = navHandler.orbitalNavigator().followingNodeRotation();
@@ -611,6 +673,14 @@ void ParallelPeer::sendCameraKeyframe() {
 
     // Timestamp as current runtime of OpenSpace instance
     kf._timestamp = global::windowDelegate.applicationTime();
+    return true;
+}
+
+void ParallelPeer::sendCameraKeyframe() {
+    datamessagestructures::CameraKeyframe kf;
+    if (!createCameraKeyframe(kf)) {
+        return;
+    }
 
     // Create a buffer for the keyframe
     std::vector<char> buffer;
@@ -627,8 +697,7 @@ void ParallelPeer::sendCameraKeyframe() {
     ));
 }
 
-void ParallelPeer::sendTimeTimeline() {
-    // Create a keyframe with current position and orientation of camera
+datamessagestructures::TimeTimeline ParallelPeer::createTimeTimeline() {
     const Timeline<TimeKeyframeData>& timeline = global::timeManager.timeline();
     std::deque<Keyframe<TimeKeyframeData>> keyframes = timeline.keyframes();
 
@@ -661,6 +730,12 @@ void ParallelPeer::sendTimeTimeline() {
         kfMessage._requiresTimeJump = _timeJumped;
         timelineMessage._keyframes.push_back(kfMessage);
     }
+    return timelineMessage;
+}
+
+void ParallelPeer::sendTimeTimeline() {
+    datamessagestructures::TimeTimeline timelineMessage = createTimeTimeline();
+
     // Create a buffer for the keyframe
     std::vector<char> buffer;
 
@@ -676,6 +751,33 @@ void ParallelPeer::sendTimeTimeline() {
     ));
 }
 
+void ParallelPeer::sendKeyframeBatch(bool includeCamera, bool includeTimeline) {
+    datamessagestructures::KeyframeBatch batch;
+
+    if (includeCamera) {
+        datamessagestructures::CameraKeyframe kf;
+        if (createCameraKeyframe(kf)) {
+            batch.cameraKeyframes.push_back(std::move(kf));
+        }
+    }
+    if (includeTimeline) {
+        batch.hasTimeline = true;
+        batch.timeline = createTimeTimeline();
+    }
+    if (batch.cameraKeyframes.empty() && !batch.hasTimeline) {
+        return;
+    }
+
+    std::vector<char> buffer;
+    _keyframeEncoder.encode(batch, buffer);
+
+    _connection.sendDataMessage(ParallelConnection::DataMessage(
+        datamessagestructures::Type::KeyframeBatch,
+        global::windowDelegate.applicationTime(),
+        buffer
+    ));
+}
+
 ghoul::Event<>& ParallelPeer::connectionEvent() {
     return *_connectionEvent;
 }
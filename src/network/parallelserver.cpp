@@ -24,20 +24,53 @@
 
 #include <openspace/network/parallelserver.h>
 
+#include <openspace/network/messagestructures.h>
 #include <ghoul/fmt.h>
 #include <ghoul/io/socket/tcpsocket.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <limits>
 
 // @TODO(abock): In the entire class remove std::shared_ptr<Peer> by const Peer& where
 //               possible to simplify the interface
 
 namespace {
     constexpr const char* _loggerCat = "ParallelServer";
+
+    // The number of threads that write the queued messages to the peers' sockets
+    constexpr const size_t NumberOfSendThreads = 4;
+
+    // The number of messages that can be queued for a single peer before it is
+    // considered to be unable to keep up and is disconnected
+    constexpr const size_t MaxQueuedMessages = 512;
+
+    bool isCameraKeyframe(openspace::ParallelConnection::MessageType messageType,
+                          const std::vector<char>& message)
+    {
+        using namespace openspace;
+        if (messageType != ParallelConnection::MessageType::Data ||
+            message.size() < sizeof(uint32_t))
+        {
+            return false;
+        }
+        uint32_t type;
+        std::memcpy(&type, message.data(), sizeof(uint32_t));
+        return type == static_cast<uint32_t>(datamessagestructures::Type::CameraData);
+    }
 } // namespace
 
 namespace openspace {
 
+ParallelServer::Peer::Peer(size_t id_, ParallelConnection parallelConnection_)
+    : id(id_)
+    , parallelConnection(std::move(parallelConnection_))
+    , outgoing(MaxQueuedMessages)
+{}
+
+ParallelServer::ParallelServer() : _sendPool(NumberOfSendThreads) {}
+
 void ParallelServer::start(int port, const std::string& password,
                            const std::string& changeHostPassword)
 {
@@ -62,23 +95,46 @@ std::string ParallelServer::defaultHostAddress() const {
 void ParallelServer::stop() {
     _shouldStop = true;
     _socketServer.close();
+
+    // Wake up the event loop, peer ids start at 1 so the message is ignored
+    _incomingMessages.push({
+        0,
+        ParallelConnection::Message(
+            ParallelConnection::MessageType::Disconnection, std::vector<char>()
+        )
+    });
+    if (_serverThread.joinable()) {
+        _serverThread.join();
+    }
+    if (_eventLoopThread.joinable()) {
+        _eventLoopThread.join();
+    }
+
+    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
+        it.second->parallelConnection.disconnect();
+        if (it.second->thread.joinable()) {
+            it.second->thread.join();
+        }
+    }
+    _peers.clear();
 }
 
 void ParallelServer::handleNewPeers() {
     while (!_shouldStop) {
         std::unique_ptr<ghoul::io::TcpSocket> socket =
             _socketServer.awaitPendingTcpSocket();
+        if (!socket) {
+            // The server socket was closed
+            continue;
+        }
 
         socket->startStreams();
 
         const size_t id = _nextConnectionId++;
-        std::shared_ptr<Peer> p = std::make_shared<Peer>(Peer{
+        std::shared_ptr<Peer> p = std::make_shared<Peer>(
             id,
-            "",
-            ParallelConnection(std::move(socket)),
-            ParallelConnection::Status::Connecting,
-            std::thread()
-        });
+            ParallelConnection(std::move(socket))
+        );
         auto it = _peers.emplace(p->id, p);
         it.first->second->thread = std::thread([this, id]() {
             handlePeer(id);
@@ -190,6 +246,13 @@ void ParallelServer::handleAuthentication(std::shared_ptr<Peer> peer,
         name = "Anonymous";
     }
 
+    // 4 bytes keyframe codec version, only sent by peers that support the compact codec
+    uint32_t codecVersion = 0;
+    input.read(reinterpret_cast<char*>(&codecVersion), sizeof(uint32_t));
+    if (input.gcount() == sizeof(uint32_t)) {
+        peer->keyframeCodecVersion = codecVersion;
+    }
+
     setName(*peer, name);
 
     LINFO(fmt::format("Connection established with {} \"{}\"", peer->id, name));
@@ -216,6 +279,7 @@ void ParallelServer::handleAuthentication(std::shared_ptr<Peer> peer,
     }
 
     setNConnections(nConnections() + 1);
+    updateKeyframeCodecVersion();
 }
 
 void ParallelServer::handleData(const Peer& peer, std::vector<char> data) {
@@ -281,15 +345,26 @@ void ParallelServer::sendMessage(Peer& peer,
                                  ParallelConnection::MessageType messageType,
                                  const std::vector<char>& message)
 {
-    peer.parallelConnection.sendMessage({ messageType, message });
+    queueMessage(peer, {
+        std::make_shared<const std::vector<char>>(
+            ParallelConnection::encodeMessage(messageType, message)
+        ),
+        isCameraKeyframe(messageType, message)
+    });
 }
 
 void ParallelServer::sendMessageToAll(ParallelConnection::MessageType messageType,
                                       const std::vector<char>& message)
 {
+    const OutgoingMessageQueue::Message outgoing = {
+        std::make_shared<const std::vector<char>>(
+            ParallelConnection::encodeMessage(messageType, message)
+        ),
+        isCameraKeyframe(messageType, message)
+    };
     for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
         if (isConnected(*it.second)) {
-            it.second->parallelConnection.sendMessage({ messageType, message });
+            queueMessage(*it.second, outgoing);
         }
     }
 }
@@ -297,9 +372,49 @@ void ParallelServer::sendMessageToAll(ParallelConnection::MessageType messageTyp
 void ParallelServer::sendMessageToClients(ParallelConnection::MessageType messageType,
                                           const std::vector<char>& message)
 {
+    const OutgoingMessageQueue::Message outgoing = {
+        std::make_shared<const std::vector<char>>(
+            ParallelConnection::encodeMessage(messageType, message)
+        ),
+        isCameraKeyframe(messageType, message)
+    };
     for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
         if (it.second->status == ParallelConnection::Status::ClientWithHost) {
-            it.second->parallelConnection.sendMessage({ messageType, message });
+            queueMessage(*it.second, outgoing);
+        }
+    }
+}
+
+void ParallelServer::queueMessage(Peer& peer, OutgoingMessageQueue::Message message) {
+    using PushResult = OutgoingMessageQueue::PushResult;
+
+    const PushResult result = peer.outgoing.push(std::move(message));
+    if (result == PushResult::StartSending) {
+        std::shared_ptr<Peer> p = peer.shared_from_this();
+        _sendPool.enqueue([this, p]() { sendQueuedMessages(p); });
+    }
+    else if (result == PushResult::Overflow) {
+        // The peer can't keep up even with the camera keyframes being coalesced, so we
+        // drop the connection rather than letting it fall further behind
+        LWARNING(fmt::format(
+            "Connection {} is not keeping up with the messages. Disconnecting", peer.id
+        ));
+        _incomingMessages.push({
+            peer.id,
+            ParallelConnection::Message(
+                ParallelConnection::MessageType::Disconnection, std::vector<char>()
+            )
+        });
+    }
+}
+
+void ParallelServer::sendQueuedMessages(std::shared_ptr<Peer> peer) {
+    while (std::shared_ptr<const std::vector<char>> encoded = peer->outgoing.pop()) {
+        if (!peer->parallelConnection.sendEncodedMessage(*encoded)) {
+            // The receiving thread of the peer notices the lost connection and takes
+            // care of the disconnection
+            peer->outgoing.clear();
+            return;
         }
     }
 }
@@ -324,6 +439,8 @@ void ParallelServer::disconnect(Peer& peer) {
     peer.parallelConnection.disconnect();
     peer.thread.join();
     _peers.erase(peer.id);
+
+    updateKeyframeCodecVersion();
 }
 
 void ParallelServer::setName(Peer& peer, std::string name) {
@@ -424,9 +541,40 @@ void ParallelServer::sendConnectionStatus(Peer& peer) {
         reinterpret_cast<const char*>(_hostName.data() + outHostNameSize)
     );
 
+    // Appended after the fields that older peers read, so they ignore it
+    data.insert(
+        data.end(),
+        reinterpret_cast<const char*>(&_keyframeCodecVersion),
+        reinterpret_cast<const char*>(&_keyframeCodecVersion) + sizeof(uint32_t)
+    );
+
     sendMessage(peer, ParallelConnection::MessageType::ConnectionStatus, data);
 }
 
+void ParallelServer::updateKeyframeCodecVersion() {
+    // The host's keyframes go to every peer, so they have to be encoded with a codec
+    // that everyone understands
+    uint32_t codecVersion = std::numeric_limits<uint32_t>::max();
+    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
+        if (isConnected(*it.second)) {
+            codecVersion = std::min(codecVersion, it.second->keyframeCodecVersion);
+        }
+    }
+    if (codecVersion == std::numeric_limits<uint32_t>::max()) {
+        codecVersion = 0;
+    }
+
+    if (codecVersion == _keyframeCodecVersion) {
+        return;
+    }
+    _keyframeCodecVersion = codecVersion;
+    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
+        if (isConnected(*it.second)) {
+            sendConnectionStatus(*it.second);
+        }
+    }
+}
+
 size_t ParallelServer::nConnections() const {
     return _nConnections;
 }
@@ -34,9 +34,12 @@
 #include <openspace/scene/sceneinitializer.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/camera.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/logging/logmanager.h>
 
+#include <exception>
+#include <mutex>
 #include <string>
 #include <stack>
 
@@ -46,6 +49,13 @@ namespace {
     constexpr const char* _loggerCat = "Scene";
     constexpr const char* KeyIdentifier = "Identifier";
     constexpr const char* KeyParent = "Parent";
+
+    // Levels with fewer nodes than this are updated on the calling thread as the cost of
+    // distributing the work would outweigh the gain of the parallel update
+    constexpr const size_t MinNodesForParallelLevel = 32;
+
+    // The number of nodes that a thread claims at a time during a parallel update
+    constexpr const size_t NodesPerBatch = 8;
 } // namespace
 
 namespace openspace {
@@ -199,6 +209,48 @@ void Scene::sortTopologically() {
     }
 
     _topologicallySortedNodes = nodes;
+
+    if (_updateThreadPool) {
+        computeUpdateLevels();
+    }
+}
+
+void Scene::computeUpdateLevels() {
+    _levelSortedNodes.clear();
+    _levelOffsets.clear();
+
+    // As the nodes are sorted topologically, the parent and all dependencies of a node
+    // have already been assigned a level when the node itself is visited
+    std::unordered_map<SceneGraphNode*, size_t> levels;
+    levels.reserve(_topologicallySortedNodes.size());
+    size_t nLevels = 0;
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        size_t level = 0;
+        if (node->parent()) {
+            level = levels[node->parent()] + 1;
+        }
+        for (SceneGraphNode* dep : node->dependencies()) {
+            level = std::max(level, levels[dep] + 1);
+        }
+        levels[node] = level;
+        nLevels = std::max(nLevels, level + 1);
+    }
+
+    // Counting sort of the nodes by level, which retains the topological order within
+    // each level
+    _levelOffsets.resize(nLevels + 1, 0);
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        _levelOffsets[levels[node] + 1]++;
+    }
+    for (size_t i = 1; i < _levelOffsets.size(); ++i) {
+        _levelOffsets[i] += _levelOffsets[i - 1];
+    }
+
+    _levelSortedNodes.resize(_topologicallySortedNodes.size());
+    std::vector<size_t> insertPositions(_levelOffsets.begin(), _levelOffsets.end() - 1);
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        _levelSortedNodes[insertPositions[levels[node]]++] = node;
+    }
 }
 
 void Scene::initializeNode(SceneGraphNode* node) {
@@ -291,6 +343,17 @@ void Scene::update(const UpdateData& data) {
     if (_dirtyNodeRegistry) {
         updateNodeRegistry();
     }
+
+    // The performance measurements call glFinish, which requires the OpenGL context
+    if (_updateThreadPool && !data.doPerformanceMeasurement) {
+        updateInParallel(data);
+    }
+    else {
+        updateSerially(data);
+    }
+}
+
+void Scene::updateSerially(const UpdateData& data) {
     for (SceneGraphNode* node : _topologicallySortedNodes) {
         try {
             LTRACE("Scene::update(begin '" + node->identifier() + "')");
@@ -303,6 +366,77 @@ void Scene::update(const UpdateData& data) {
     }
 }
 
+void Scene::updateInParallel(const UpdateData& data) {
+    // Any other exception would terminate the worker thread it was thrown on, so the
+    // first one is stored and rethrown on this thread, like the serial update would
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+    auto updateTransform = [&data, &exception, &exceptionMutex](SceneGraphNode* node) {
+        try {
+            node->updateTransform(data);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.what());
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(exceptionMutex);
+            if (!exception) {
+                exception = std::current_exception();
+            }
+        }
+    };
+
+    for (size_t level = 0; level + 1 < _levelOffsets.size(); ++level) {
+        const size_t begin = _levelOffsets[level];
+        const size_t end = _levelOffsets[level + 1];
+
+        if (end - begin < MinNodesForParallelLevel) {
+            for (size_t i = begin; i < end; ++i) {
+                updateTransform(_levelSortedNodes[i]);
+            }
+        }
+        else {
+            // The next level depends on the results of this one, so parallelFor
+            // returning only after all nodes have been updated acts as the barrier
+            // between levels
+            _updateThreadPool->parallelFor(
+                begin,
+                end,
+                [this, &updateTransform](size_t i) {
+                    updateTransform(_levelSortedNodes[i]);
+                },
+                NodesPerBatch
+            );
+        }
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // Renderables might use the OpenGL context, so they are updated on this thread
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        try {
+            node->updateRenderable(data);
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.what());
+        }
+    }
+}
+
+void Scene::setNumberOfUpdateThreads(unsigned int nThreads) {
+    if (nThreads > 0) {
+        _updateThreadPool = std::make_unique<ThreadPool>(nThreads);
+    }
+    else {
+        _updateThreadPool = nullptr;
+        _levelSortedNodes.clear();
+        _levelOffsets.clear();
+    }
+    _dirtyNodeRegistry = true;
+}
+
 void Scene::render(const RenderData& data, RendererTasks& tasks) {
     for (SceneGraphNode* node : _topologicallySortedNodes) {
         try {
@@ -33,6 +33,7 @@
 #include <openspace/util/updatestructures.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <algorithm>
 
 #include "scenegraphnode_doc.inl"
 
@@ -75,6 +76,23 @@ namespace {
         openspace::properties::Property::Visibility::Hidden
     };
 
+    // Replaces one part of the transformation of a node and keeps the property sub
+    // owners of the node in sync with it
+    template <typename T>
+    void replaceTransformPart(openspace::properties::PropertyOwner& node,
+                              std::unique_ptr<T>& part, std::unique_ptr<T> replacement)
+    {
+        using PropertyOwner = openspace::properties::PropertyOwner;
+        const std::vector<PropertyOwner*>& owners = node.propertySubOwners();
+        if (part && std::find(owners.begin(), owners.end(), part.get()) != owners.end()) {
+            node.removePropertySubOwner(part.get());
+        }
+        part = std::move(replacement);
+        if (part) {
+            node.addPropertySubOwner(part.get());
+        }
+    }
+
 } // namespace
 
 namespace openspace {
@@ -317,6 +335,11 @@ void SceneGraphNode::traversePostOrder(const std::function<void(SceneGraphNode*)
 }
 
 void SceneGraphNode::update(const UpdateData& data) {
+    updateTransform(data);
+    updateRenderable(data);
+}
+
+void SceneGraphNode::updateTransform(const UpdateData& data) {
     State s = _state;
     if (s != State::Initialized && _state != State::GLInitialized) {
         return;
@@ -372,33 +395,36 @@ void SceneGraphNode::update(const UpdateData& data) {
             _transform.scale->update(data);
         }
     }
-    UpdateData newUpdateData = data;
 
     _worldRotationCached = calculateWorldRotation();
     _worldScaleCached = calculateWorldScale();
     // Assumes _worldRotationCached and _worldScaleCached have been calculated for parent
     _worldPositionCached = calculateWorldPosition();
 
-    newUpdateData.modelTransform.translation = worldPosition();
-    newUpdateData.modelTransform.rotation = worldRotationMatrix();
-    newUpdateData.modelTransform.scale = worldScale();
-
-    glm::dmat4 translation = glm::translate(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.translation
-    );
-    glm::dmat4 rotation = glm::dmat4(newUpdateData.modelTransform.rotation);
+    glm::dmat4 translation = glm::translate(glm::dmat4(1.0), _worldPositionCached);
+    glm::dmat4 rotation = glm::dmat4(_worldRotationCached);
     glm::dmat4 scaling = glm::scale(
         glm::dmat4(1.0),
-        glm::dvec3(
-            newUpdateData.modelTransform.scale,
-            newUpdateData.modelTransform.scale,
-            newUpdateData.modelTransform.scale
-        )
+        glm::dvec3(_worldScaleCached, _worldScaleCached, _worldScaleCached)
     );
 
     _modelTransformCached = translation * rotation * scaling;
     _inverseModelTransformCached = glm::inverse(_modelTransformCached);
+}
+
+void SceneGraphNode::updateRenderable(const UpdateData& data) {
+    State s = _state;
+    if (s != State::Initialized && _state != State::GLInitialized) {
+        return;
+    }
+    if (!isTimeFrameActive(data.time)) {
+        return;
+    }
+
+    UpdateData newUpdateData = data;
+    newUpdateData.modelTransform.translation = worldPosition();
+    newUpdateData.modelTransform.rotation = worldRotationMatrix();
+    newUpdateData.modelTransform.scale = worldScale();
 
     if (_renderable && _renderable->isReady()) {
         if (data.doPerformanceMeasurement) {
@@ -746,6 +772,18 @@ float SceneGraphNode::boundingSphere() const {
     return _fixedBoundingSphere;
 }
 
+void SceneGraphNode::setTranslation(std::unique_ptr<Translation> translation) {
+    replaceTransformPart(*this, _transform.translation, std::move(translation));
+}
+
+void SceneGraphNode::setRotation(std::unique_ptr<Rotation> rotation) {
+    replaceTransformPart(*this, _transform.rotation, std::move(rotation));
+}
+
+void SceneGraphNode::setScale(std::unique_ptr<Scale> scale) {
+    replaceTransformPart(*this, _transform.scale, std::move(scale));
+}
+
 // renderable
 void SceneGraphNode::setRenderable(std::unique_ptr<Renderable> renderable) {
     _renderable = std::move(renderable);
@@ -661,6 +661,10 @@ void ScriptEngine::preSync(bool isMaster) {
     }
 }
 
+bool ScriptEngine::hasChanged() {
+    return !_scriptsToSync.empty();
+}
+
 void ScriptEngine::encode(SyncBuffer* syncBuffer) {
     size_t nScripts = _scriptsToSync.size();
     syncBuffer->encode(nScripts);
@@ -0,0 +1,295 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/memorymappedfile.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/misc/exception.h>
+#include <utility>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    constexpr const char* _loggerCat = "MemoryMappedFile";
+
+#ifndef WIN32
+    // Allocates the disk blocks for the first size bytes of the file. File systems that
+    // do not support the allocation are accepted, as there is nothing else to be done
+    bool reserve(int fileDescriptor, size_t size) {
+#ifdef __APPLE__
+        fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0 };
+        if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+            return errno != ENOSPC;
+        }
+        return true;
+#else
+        const int res = posix_fallocate(fileDescriptor, 0, static_cast<off_t>(size));
+        return res == 0 || res == EOPNOTSUPP || res == EINVAL;
+#endif // __APPLE__
+    }
+#endif // WIN32
+} // namespace
+
+namespace openspace {
+
+#ifdef WIN32
+
+MemoryMappedFile::MemoryMappedFile(std::string path, Writable writable, size_t size)
+    : _path(std::move(path))
+    , _isWritable(writable)
+{
+    HANDLE file = CreateFileA(
+        _path.c_str(),
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ | (writable ? 0 : FILE_SHARE_WRITE),
+        nullptr,
+        writable ? OPEN_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw ghoul::RuntimeError(
+            fmt::format("Error opening file '{}'", _path),
+            _loggerCat
+        );
+    }
+    _fileHandle = file;
+
+    if (writable && size > 0) {
+        LARGE_INTEGER s;
+        s.QuadPart = static_cast<LONGLONG>(size);
+        if (!SetFilePointerEx(file, s, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            unmap();
+            throw ghoul::RuntimeError(
+                fmt::format("Error resizing file '{}' to {} bytes", _path, size),
+                _loggerCat
+            );
+        }
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size == 0) {
+        // Empty files cannot be mapped, but are still valid
+        return;
+    }
+
+    _mappingHandle = CreateFileMappingA(
+        file,
+        nullptr,
+        writable ? PAGE_READWRITE : PAGE_READONLY,
+        0,
+        0,
+        nullptr
+    );
+    if (!_mappingHandle) {
+        unmap();
+        throw ghoul::RuntimeError(
+            fmt::format("Error creating file mapping for '{}'", _path),
+            _loggerCat
+        );
+    }
+
+    void* ptr = MapViewOfFile(
+        _mappingHandle,
+        writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+        0,
+        0,
+        0
+    );
+    if (!ptr) {
+        unmap();
+        throw ghoul::RuntimeError(
+            fmt::format("Error mapping file '{}'", _path),
+            _loggerCat
+        );
+    }
+    _data = reinterpret_cast<std::byte*>(ptr);
+}
+
+void MemoryMappedFile::unmap() {
+    if (_data) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+    if (_mappingHandle) {
+        CloseHandle(_mappingHandle);
+        _mappingHandle = nullptr;
+    }
+    if (_fileHandle) {
+        CloseHandle(_fileHandle);
+        _fileHandle = nullptr;
+    }
+    _size = 0;
+}
+
+void MemoryMappedFile::flush() {
+    if (_data && _isWritable) {
+        FlushViewOfFile(_data, 0);
+    }
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(std::string path, Writable writable, size_t size)
+    : _path(std::move(path))
+    , _isWritable(writable)
+{
+    _fileDescriptor = writable ?
+        open(_path.c_str(), O_RDWR | O_CREAT, 0644) :
+        open(_path.c_str(), O_RDONLY);
+    if (_fileDescriptor == -1) {
+        throw ghoul::RuntimeError(
+            fmt::format("Error opening file '{}'", _path),
+            _loggerCat
+        );
+    }
+
+    if (writable && size > 0) {
+        if (ftruncate(_fileDescriptor, static_cast<off_t>(size)) != 0) {
+            unmap();
+            throw ghoul::RuntimeError(
+                fmt::format("Error resizing file '{}' to {} bytes", _path, size),
+                _loggerCat
+            );
+        }
+
+        // ftruncate only creates a sparse file. Writing into the mapping of a sparse file
+        // on a full disk raises SIGBUS, so the disk space is reserved up front instead
+        if (!reserve(_fileDescriptor, size)) {
+            unmap();
+            throw ghoul::RuntimeError(
+                fmt::format("Error reserving {} bytes for file '{}'", size, _path),
+                _loggerCat
+            );
+        }
+    }
+
+    struct stat s;
+    if (fstat(_fileDescriptor, &s) != 0) {
+        unmap();
+        throw ghoul::RuntimeError(
+            fmt::format("Error querying size of file '{}'", _path),
+            _loggerCat
+        );
+    }
+    _size = static_cast<size_t>(s.st_size);
+    if (_size == 0) {
+        // Empty files cannot be mapped, but are still valid
+        return;
+    }
+
+    void* ptr = mmap(
+        nullptr,
+        _size,
+        writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+        MAP_SHARED,
+        _fileDescriptor,
+        0
+    );
+    if (ptr == MAP_FAILED) {
+        unmap();
+        throw ghoul::RuntimeError(
+            fmt::format("Error mapping file '{}'", _path),
+            _loggerCat
+        );
+    }
+    _data = reinterpret_cast<std::byte*>(ptr);
+}
+
+void MemoryMappedFile::unmap() {
+    if (_data) {
+        munmap(_data, _size);
+        _data = nullptr;
+    }
+    if (_fileDescriptor != -1) {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+    _size = 0;
+}
+
+void MemoryMappedFile::flush() {
+    if (_data && _isWritable) {
+        msync(_data, _size, MS_ASYNC);
+    }
+}
+
+#endif // WIN32
+
+MemoryMappedFile::~MemoryMappedFile() {
+    unmap();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _path = std::move(other._path);
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _isWritable = other._isWritable;
+#ifdef WIN32
+        _fileHandle = std::exchange(other._fileHandle, nullptr);
+        _mappingHandle = std::exchange(other._mappingHandle, nullptr);
+#else
+        _fileDescriptor = std::exchange(other._fileDescriptor, -1);
+#endif // WIN32
+    }
+    return *this;
+}
+
+std::byte* MemoryMappedFile::data() {
+    return _data;
+}
+
+const std::byte* MemoryMappedFile::data() const {
+    return _data;
+}
+
+size_t MemoryMappedFile::size() const {
+    return _size;
+}
+
+const std::string& MemoryMappedFile::path() const {
+    return _path;
+}
+
+bool MemoryMappedFile::isWritable() const {
+    return _isWritable;
+}
+
+} // namespace openspace
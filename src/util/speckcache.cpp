@@ -0,0 +1,489 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/speckcache.h>
+
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <sys/stat.h>
+
+namespace {
+    constexpr const char* _loggerCat = "SpeckCache";
+
+    constexpr const uint32_t Magic = 0x4344534F; // 'OSDC'
+    constexpr const uint32_t FormatVersion = 1;
+
+    // The values of each column start at a multiple of this many bytes
+    constexpr const size_t ColumnAlignment = 64;
+
+    constexpr const char* PositionNames[] = { "x", "y", "z" };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t formatVersion;
+        uint32_t datasetVersion;
+        uint32_t nColumns;
+        uint64_t nRows;
+        uint64_t sourceChecksum;
+        int32_t textureDataIndex;
+        int32_t orientationDataIndex;
+        uint32_t nTextures;
+        uint32_t stringTableSize;
+        // Size and modification time of the source file, which are compared before the
+        // checksum is computed. Both are 0 in files written before they were added
+        uint64_t sourceSize;
+        int64_t sourceModificationTime;
+    };
+    static_assert(sizeof(FileHeader) == 64);
+
+    struct ColumnHeader {
+        uint32_t type;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        float minimum;
+        float maximum;
+        uint32_t padding;
+        uint64_t dataOffset;
+    };
+    static_assert(sizeof(ColumnHeader) == 32);
+
+    struct TextureHeader {
+        int32_t index;
+        uint32_t fileOffset;
+        uint32_t fileLength;
+        uint32_t padding;
+    };
+    static_assert(sizeof(TextureHeader) == 16);
+
+    size_t align(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Returns the name that is stored for the column at the provided index
+    std::string_view columnName(const openspace::speck::Dataset& dataset, int column) {
+        if (column < 3) {
+            return PositionNames[column];
+        }
+        const auto it = std::find_if(
+            dataset.variables.begin(),
+            dataset.variables.end(),
+            [column](const openspace::speck::Dataset::Variable& v) {
+                return v.index == column;
+            }
+        );
+        return it != dataset.variables.end() ? std::string_view(it->name) : "";
+    }
+
+    // Returns the size and the modification time of the file at the provided path
+    std::pair<uint64_t, int64_t> fileStatus(const std::string& path) {
+#ifdef WIN32
+        struct _stat64 s;
+        if (_stat64(path.c_str(), &s) != 0) {
+            return { 0, 0 };
+        }
+#else
+        struct stat s;
+        if (stat(path.c_str(), &s) != 0) {
+            return { 0, 0 };
+        }
+#endif // WIN32
+        return { static_cast<uint64_t>(s.st_size), static_cast<int64_t>(s.st_mtime) };
+    }
+
+    std::pair<float, float> minMax(const std::vector<float>& values) {
+        if (values.empty()) {
+            return { 0.f, 0.f };
+        }
+        const auto [min, max] = std::minmax_element(values.begin(), values.end());
+        return { *min, *max };
+    }
+} // namespace
+
+namespace openspace::speck {
+
+CachedDataset::CachedDataset(const std::string& path) {
+    _file.emplace(path);
+    initializeFromFile();
+}
+
+CachedDataset::CachedDataset(Dataset dataset)
+    : _dataset(std::move(dataset))
+    , _nRows(_dataset->nRows())
+    , _variables(_dataset->variables)
+    , _textures(_dataset->textures)
+    , _textureDataIndex(_dataset->textureDataIndex)
+    , _orientationDataIndex(_dataset->orientationDataIndex)
+{
+    _columns.reserve(_dataset->columns.size());
+    for (size_t i = 0; i < _dataset->columns.size(); ++i) {
+        const std::vector<float>& values = _dataset->columns[i];
+        const auto [minimum, maximum] = minMax(values);
+
+        Column column;
+        column.name = columnName(*_dataset, static_cast<int>(i));
+        column.minimum = minimum;
+        column.maximum = maximum;
+        column.values = values.data();
+        _columns.push_back(std::move(column));
+    }
+}
+
+void CachedDataset::initializeFromFile() {
+    const std::byte* data = _file->data();
+    const size_t size = _file->size();
+    auto invalid = [this](const std::string& reason) {
+        return ghoul::RuntimeError(
+            fmt::format("Invalid cache file '{}': {}", _file->path(), reason),
+            "SpeckCache"
+        );
+    };
+
+    if (size < sizeof(FileHeader)) {
+        throw invalid("File is too small");
+    }
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(FileHeader));
+    if (header.magic != Magic) {
+        throw invalid("Wrong file type");
+    }
+    if (header.formatVersion != FormatVersion) {
+        throw invalid(fmt::format("Unsupported version {}", header.formatVersion));
+    }
+
+    const size_t columnsOffset = sizeof(FileHeader);
+    const size_t texturesOffset = columnsOffset + header.nColumns * sizeof(ColumnHeader);
+    const size_t stringsOffset =
+        texturesOffset + header.nTextures * sizeof(TextureHeader);
+    if (stringsOffset + header.stringTableSize > size) {
+        throw invalid("File is truncated");
+    }
+    const char* strings = reinterpret_cast<const char*>(data + stringsOffset);
+    auto string = [&](uint32_t offset, uint32_t length) {
+        if (static_cast<size_t>(offset) + length > header.stringTableSize) {
+            throw invalid("String out of bounds");
+        }
+        return std::string(strings + offset, length);
+    };
+
+    _nRows = header.nRows;
+    _sourceChecksum = header.sourceChecksum;
+    _sourceSize = header.sourceSize;
+    _sourceModificationTime = header.sourceModificationTime;
+    _datasetVersion = header.datasetVersion;
+    _textureDataIndex = header.textureDataIndex;
+    _orientationDataIndex = header.orientationDataIndex;
+
+    const size_t columnSize = _nRows * sizeof(float);
+    _columns.reserve(header.nColumns);
+    for (uint32_t i = 0; i < header.nColumns; ++i) {
+        ColumnHeader c;
+        std::memcpy(&c, data + columnsOffset + i * sizeof(ColumnHeader), sizeof(c));
+        if (c.type != static_cast<uint32_t>(ColumnType::Float32)) {
+            throw invalid(fmt::format("Unsupported type {} in column {}", c.type, i));
+        }
+        if (c.dataOffset % alignof(float) != 0 || c.dataOffset > size ||
+            size - c.dataOffset < columnSize)
+        {
+            throw invalid(fmt::format("Column {} is out of bounds", i));
+        }
+
+        Column column;
+        column.name = string(c.nameOffset, c.nameLength);
+        column.type = ColumnType::Float32;
+        column.minimum = c.minimum;
+        column.maximum = c.maximum;
+        column.values = reinterpret_cast<const float*>(data + c.dataOffset);
+        if (i >= 3 && !column.name.empty()) {
+            _variables.push_back({ static_cast<int>(i), column.name });
+        }
+        _columns.push_back(std::move(column));
+    }
+
+    _textures.reserve(header.nTextures);
+    for (uint32_t i = 0; i < header.nTextures; ++i) {
+        TextureHeader t;
+        std::memcpy(&t, data + texturesOffset + i * sizeof(TextureHeader), sizeof(t));
+        _textures.push_back({ t.index, string(t.fileOffset, t.fileLength) });
+    }
+}
+
+size_t CachedDataset::nRows() const {
+    return _nRows;
+}
+
+size_t CachedDataset::nColumns() const {
+    return _columns.size();
+}
+
+const CachedDataset::Column& CachedDataset::column(size_t index) const {
+    ghoul_assert(index < _columns.size(), "Column index out of bounds");
+    return _columns[index];
+}
+
+int CachedDataset::index(std::string_view name) const {
+    const auto it = std::find_if(
+        _columns.begin(),
+        _columns.end(),
+        [name](const Column& c) { return c.name == name; }
+    );
+    return it != _columns.end() ? static_cast<int>(it - _columns.begin()) : -1;
+}
+
+const std::vector<Dataset::Variable>& CachedDataset::variables() const {
+    return _variables;
+}
+
+const std::vector<Dataset::Texture>& CachedDataset::textures() const {
+    return _textures;
+}
+
+int CachedDataset::textureDataIndex() const {
+    return _textureDataIndex;
+}
+
+int CachedDataset::orientationDataIndex() const {
+    return _orientationDataIndex;
+}
+
+uint64_t CachedDataset::sourceChecksum() const {
+    return _sourceChecksum;
+}
+
+uint64_t CachedDataset::sourceSize() const {
+    return _sourceSize;
+}
+
+int64_t CachedDataset::sourceModificationTime() const {
+    return _sourceModificationTime;
+}
+
+uint32_t CachedDataset::datasetVersion() const {
+    return _datasetVersion;
+}
+
+void saveCache(const Dataset& dataset, const std::string& path, uint64_t sourceChecksum,
+               uint32_t datasetVersion, uint64_t sourceSize,
+               int64_t sourceModificationTime)
+{
+    const size_t nColumns = dataset.columns.size();
+    const size_t nRows = dataset.nRows();
+
+    // Collect all strings and their offsets into the string table first
+    std::string strings;
+    auto addString = [&strings](std::string_view s) {
+        const uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings += s;
+        return std::make_pair(offset, static_cast<uint32_t>(s.size()));
+    };
+
+    std::vector<ColumnHeader> columns(nColumns);
+    for (size_t i = 0; i < nColumns; ++i) {
+        const auto [offset, length] = addString(columnName(dataset, static_cast<int>(i)));
+        const auto [minimum, maximum] = minMax(dataset.columns[i]);
+        columns[i] = {
+            static_cast<uint32_t>(CachedDataset::ColumnType::Float32),
+            offset,
+            length,
+            minimum,
+            maximum,
+            0,
+            0
+        };
+    }
+
+    std::vector<TextureHeader> textures(dataset.textures.size());
+    for (size_t i = 0; i < dataset.textures.size(); ++i) {
+        const auto [offset, length] = addString(dataset.textures[i].file);
+        textures[i] = { dataset.textures[i].index, offset, length, 0 };
+    }
+
+    const size_t columnsOffset = sizeof(FileHeader);
+    const size_t texturesOffset = columnsOffset + nColumns * sizeof(ColumnHeader);
+    const size_t stringsOffset = texturesOffset + textures.size() * sizeof(TextureHeader);
+
+    size_t fileSize = align(stringsOffset + strings.size(), ColumnAlignment);
+    for (ColumnHeader& c : columns) {
+        c.dataOffset = fileSize;
+        fileSize = align(fileSize + nRows * sizeof(float), ColumnAlignment);
+    }
+
+    FileHeader header = {};
+    header.magic = Magic;
+    header.formatVersion = FormatVersion;
+    header.datasetVersion = datasetVersion;
+    header.nColumns = static_cast<uint32_t>(nColumns);
+    header.nRows = nRows;
+    header.sourceChecksum = sourceChecksum;
+    header.textureDataIndex = dataset.textureDataIndex;
+    header.orientationDataIndex = dataset.orientationDataIndex;
+    header.nTextures = static_cast<uint32_t>(textures.size());
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.sourceSize = sourceSize;
+    header.sourceModificationTime = sourceModificationTime;
+
+    const std::string temporaryPath = path + ".tmp";
+    {
+        MemoryMappedFile file(temporaryPath, MemoryMappedFile::Writable::Yes, fileSize);
+        std::byte* data = file.data();
+        std::memset(data, 0, fileSize);
+        std::memcpy(data, &header, sizeof(FileHeader));
+        if (!columns.empty()) {
+            std::memcpy(
+                data + columnsOffset,
+                columns.data(),
+                columns.size() * sizeof(ColumnHeader)
+            );
+        }
+        if (!textures.empty()) {
+            std::memcpy(
+                data + texturesOffset,
+                textures.data(),
+                textures.size() * sizeof(TextureHeader)
+            );
+        }
+        std::memcpy(data + stringsOffset, strings.data(), strings.size());
+        for (size_t i = 0; i < nColumns; ++i) {
+            std::memcpy(
+                data + columns[i].dataOffset,
+                dataset.columns[i].data(),
+                nRows * sizeof(float)
+            );
+        }
+        file.flush();
+    }
+
+    // std::rename does not replace existing files on all platforms
+    std::remove(path.c_str());
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw ghoul::RuntimeError(
+            fmt::format("Error moving cache file into place at '{}'", path),
+            "SpeckCache"
+        );
+    }
+}
+
+uint64_t fileChecksum(const std::string& path) {
+    MemoryMappedFile file(path);
+    const std::byte* data = file.data();
+    const size_t size = file.size();
+
+    // FNV-1a, but processing 64-bit words instead of single bytes to keep up with the
+    // speed at which the cache file itself can be read
+    constexpr const uint64_t Offset = 14695981039346656037ull;
+    constexpr const uint64_t Prime = 1099511628211ull;
+
+    uint64_t hash = Offset ^ size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word) * Prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<uint64_t>(data[i])) * Prime;
+    }
+    return hash;
+}
+
+std::unique_ptr<CachedDataset> loadCachedFile(const std::string& path,
+                                              const std::string& cacheInformation,
+                                              uint32_t datasetVersion,
+                                              SkipAllZeroRows skipAllZeroRows,
+                                        const std::function<void(Dataset&)>& preprocess)
+{
+    const auto [size, modificationTime] = fileStatus(path);
+    const std::string cachedFile = FileSys.cacheManager()->cachedFilename(
+        ghoul::filesystem::File(path),
+        cacheInformation,
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+
+    // The checksum requires reading the whole source file, so it is only computed if
+    // the size or modification time of the source file differ from the cached ones
+    std::optional<uint64_t> checksum;
+    if (FileSys.fileExists(cachedFile)) {
+        try {
+            auto dataset = std::make_unique<CachedDataset>(cachedFile);
+            const bool isSameFile =
+                dataset->sourceSize() == size &&
+                dataset->sourceModificationTime() == modificationTime;
+            if (!isSameFile) {
+                checksum = fileChecksum(path);
+            }
+            if ((isSameFile || dataset->sourceChecksum() == *checksum) &&
+                dataset->datasetVersion() == datasetVersion)
+            {
+                LINFO(fmt::format(
+                    "Cached file '{}' used for Speck file '{}'", cachedFile, path
+                ));
+                return dataset;
+            }
+            // The cache file is replaced below
+            LINFO(fmt::format("Cached file for Speck file '{}' is out of date", path));
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LWARNINGC(e.component, e.message);
+        }
+    }
+    else {
+        LINFO(fmt::format("Cache for Speck file '{}' not found", path));
+    }
+
+    LINFO(fmt::format("Loading Speck file '{}'", path));
+    Dataset dataset = loadFile(path, skipAllZeroRows);
+    if (preprocess) {
+        preprocess(dataset);
+    }
+
+    try {
+        saveCache(
+            dataset,
+            cachedFile,
+            checksum.has_value() ? *checksum : fileChecksum(path),
+            datasetVersion,
+            size,
+            modificationTime
+        );
+        return std::make_unique<CachedDataset>(cachedFile);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        // Not being able to write the cache is not fatal, the dataset is just used from
+        // memory in that case
+        LWARNINGC(e.component, e.message);
+        return std::make_unique<CachedDataset>(std::move(dataset));
+    }
+}
+
+} // namespace openspace::speck
@@ -0,0 +1,445 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/speckloader.h>
+
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+    constexpr const char* _loggerCat = "SpeckLoader";
+
+    // The data section is split into chunks of roughly this size that are parsed in
+    // parallel. Smaller files are parsed on the calling thread only
+    constexpr const size_t ChunkSize = 1024 * 1024;
+
+    constexpr bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    constexpr bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    std::string_view trimLeft(std::string_view s) {
+        size_t i = 0;
+        while (i < s.size() && isSpace(s[i])) {
+            ++i;
+        }
+        return s.substr(i);
+    }
+
+    // Returns the next whitespace separated token of s and removes it from s
+    std::string_view nextToken(std::string_view& s) {
+        s = trimLeft(s);
+        size_t i = 0;
+        while (i < s.size() && !isSpace(s[i])) {
+            ++i;
+        }
+        std::string_view token = s.substr(0, i);
+        s = s.substr(i);
+        return token;
+    }
+
+    int parseInt(std::string_view token) {
+        int value = 0;
+        std::from_chars(token.data(), token.data() + token.size(), value);
+        return value;
+    }
+
+    // A line is part of the data table if it is neither empty nor a comment
+    bool isDataLine(std::string_view line) {
+        line = trimLeft(line);
+        return !line.empty() && line[0] != '#';
+    }
+
+    // Parses a single floating point number starting at p, which must not point to a
+    // whitespace character. Returns the pointer behind the number or nullptr if no
+    // number could be parsed. Decimal numbers with up to 19 significant digits and small
+    // exponents, which covers the values in Speck files, are converted using exact
+    // powers of 10; all other numbers fall back to strtod
+    const char* parseFloat(const char* p, const char* end, float& value) {
+        constexpr const double Powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+            1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        constexpr const int MaxExactPower = 22;
+        constexpr const int MaxMantissaDigits = 19;
+
+        const char* begin = p;
+        bool isNegative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            isNegative = (*p == '-');
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int nSignificantDigits = 0;
+        int exponent = 0;
+        bool hasDigits = false;
+
+        while (p != end && isDigit(*p)) {
+            if (nSignificantDigits < MaxMantissaDigits) {
+                mantissa = mantissa * 10 + (*p - '0');
+                nSignificantDigits += (mantissa > 0) ? 1 : 0;
+            }
+            else {
+                ++exponent;
+            }
+            hasDigits = true;
+            ++p;
+        }
+        if (p != end && *p == '.') {
+            ++p;
+            while (p != end && isDigit(*p)) {
+                if (nSignificantDigits < MaxMantissaDigits) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    nSignificantDigits += (mantissa > 0) ? 1 : 0;
+                    --exponent;
+                }
+                hasDigits = true;
+                ++p;
+            }
+        }
+
+        if (hasDigits && p != end && (*p == 'e' || *p == 'E')) {
+            const char* exponentBegin = p;
+            ++p;
+            bool isNegativeExponent = false;
+            if (p != end && (*p == '-' || *p == '+')) {
+                isNegativeExponent = (*p == '-');
+                ++p;
+            }
+            if (p != end && isDigit(*p)) {
+                int e = 0;
+                while (p != end && isDigit(*p)) {
+                    e = std::min(e * 10 + (*p - '0'), 100000);
+                    ++p;
+                }
+                exponent += isNegativeExponent ? -e : e;
+            }
+            else {
+                // Not an exponent after all, for example "1e" followed by a space
+                p = exponentBegin;
+            }
+        }
+
+        const bool isEndOfToken = (p == end) || isSpace(*p) || *p == '#';
+        if (!hasDigits || !isEndOfToken ||
+            exponent < -MaxExactPower || exponent > MaxExactPower)
+        {
+            // Everything else (nan, inf, hexadecimal numbers, large exponents) is handled
+            // by strtod, which needs a null-terminated string
+            char buffer[64];
+            const char* tokenEnd = begin;
+            while (tokenEnd != end && !isSpace(*tokenEnd) &&
+                   tokenEnd - begin < static_cast<ptrdiff_t>(sizeof(buffer) - 1))
+            {
+                ++tokenEnd;
+            }
+            const size_t length = static_cast<size_t>(tokenEnd - begin);
+            std::memcpy(buffer, begin, length);
+            buffer[length] = '\0';
+
+            char* parseEnd = nullptr;
+            const double v = std::strtod(buffer, &parseEnd);
+            if (parseEnd == buffer) {
+                return nullptr;
+            }
+            value = static_cast<float>(v);
+            return begin + (parseEnd - buffer);
+        }
+
+        double v = static_cast<double>(mantissa);
+        v = (exponent < 0) ? v / Powers[-exponent] : v * Powers[exponent];
+        value = static_cast<float>(isNegative ? -v : v);
+        return p;
+    }
+
+    // Parses the header of the Speck file and returns the data section
+    std::string_view parseHeader(std::string_view contents, openspace::speck::Dataset& d)
+    {
+        // The beginning of the speck file has a header that either contains comments
+        // (signaled by a preceding '#') or information about the structure of the file
+        // (signaled by the keywords 'datavar', 'texturevar', 'texture', 'polyorivar',
+        // and 'maxcomment')
+        int nValues = 0;
+        while (!contents.empty()) {
+            std::string_view rest = contents;
+            std::string_view line = trimLeft(openspace::speck::nextLine(rest));
+
+            if (line.empty() || line[0] == '#') {
+                contents = rest;
+                continue;
+            }
+
+            std::string_view tokens = line;
+            const std::string_view command = nextToken(tokens);
+            if (command == "datavar") {
+                // datavar lines are structured as follows:
+                // datavar # description
+                // where # is the index of the data variable; so if we repeatedly
+                // overwrite the 'nValues' variable with the latest index, we will end up
+                // with the total number of values (+3 since X Y Z are not counted in the
+                // Speck file index)
+                const int index = parseInt(nextToken(tokens));
+                const std::string_view name = nextToken(tokens);
+                d.variables.push_back({ index + 3, std::string(name) });
+
+                // Orientations are stored as two 3D vectors u and v
+                const bool isOrientation = (name == "orientation") || (name == "ori");
+                nValues = index + (isOrientation ? 6 : 1);
+            }
+            else if (command == "texturevar") {
+                d.textureDataIndex = parseInt(nextToken(tokens)) + 3;
+            }
+            else if (command == "polyorivar") {
+                d.orientationDataIndex = parseInt(nextToken(tokens)) + 3;
+            }
+            else if (command == "texture") {
+                // texture [-M] # filename
+                std::string_view token = nextToken(tokens);
+                if (!token.empty() && token[0] == '-') {
+                    token = nextToken(tokens);
+                }
+                const int index = parseInt(token);
+                const std::string_view file = nextToken(tokens);
+                d.textures.push_back({ index, std::string(file) });
+            }
+            else if (command != "maxcomment") {
+                // We read a line that doesn't belong to the header, so the data section
+                // starts at the beginning of this line
+                break;
+            }
+            contents = rest;
+        }
+
+        d.nValuesPerRow = nValues + 3; // X Y Z are not counted in the Speck file indices
+        return contents;
+    }
+
+    // Splits the data section into chunks that each start at the beginning of a line
+    std::vector<std::string_view> splitIntoChunks(std::string_view data) {
+        std::vector<std::string_view> chunks;
+        while (!data.empty()) {
+            size_t size = std::min(ChunkSize, data.size());
+            const size_t lineEnd = data.find('\n', size - 1);
+            size = (lineEnd == std::string_view::npos) ? data.size() : lineEnd + 1;
+            chunks.push_back(data.substr(0, size));
+            data = data.substr(size);
+        }
+        return chunks;
+    }
+
+    size_t countDataLines(std::string_view chunk) {
+        size_t nLines = 0;
+        while (!chunk.empty()) {
+            nLines += isDataLine(openspace::speck::nextLine(chunk)) ? 1 : 0;
+        }
+        return nLines;
+    }
+
+    void parseChunk(std::string_view chunk, size_t firstRow,
+                    std::vector<std::vector<float>>& columns)
+    {
+        const int nColumns = static_cast<int>(columns.size());
+        std::vector<float> values(nColumns);
+
+        size_t row = firstRow;
+        while (!chunk.empty()) {
+            const std::string_view line = openspace::speck::nextLine(chunk);
+            if (!isDataLine(line)) {
+                continue;
+            }
+
+            const int n = openspace::speck::parseValues(line, values.data(), nColumns);
+            std::fill(values.begin() + n, values.end(), 0.f);
+            for (int i = 0; i < nColumns; ++i) {
+                columns[i][row] = values[i];
+            }
+            ++row;
+        }
+    }
+
+    void removeAllZeroRows(std::vector<std::vector<float>>& columns) {
+        if (columns.empty()) {
+            return;
+        }
+
+        const size_t nRows = columns[0].size();
+        size_t nKept = 0;
+        for (size_t row = 0; row < nRows; ++row) {
+            const bool isAllZero = std::all_of(
+                columns.begin(),
+                columns.end(),
+                [row](const std::vector<float>& c) { return c[row] == 0.f; }
+            );
+            if (!isAllZero) {
+                if (nKept != row) {
+                    for (std::vector<float>& c : columns) {
+                        c[nKept] = c[row];
+                    }
+                }
+                ++nKept;
+            }
+        }
+
+        for (std::vector<float>& c : columns) {
+            c.resize(nKept);
+        }
+    }
+} // namespace
+
+namespace openspace::speck {
+
+size_t Dataset::nRows() const {
+    return columns.empty() ? 0 : columns[0].size();
+}
+
+int Dataset::index(std::string_view name) const {
+    const auto it = std::find_if(
+        variables.begin(),
+        variables.end(),
+        [name](const Variable& v) { return v.name == name; }
+    );
+    return it != variables.end() ? it->index : -1;
+}
+
+std::vector<float> Dataset::interleaved() const {
+    const size_t n = nRows();
+    const size_t nColumns = columns.size();
+
+    std::vector<float> result(n * nColumns);
+    for (size_t c = 0; c < nColumns; ++c) {
+        const float* column = columns[c].data();
+        for (size_t row = 0; row < n; ++row) {
+            result[row * nColumns + c] = column[row];
+        }
+    }
+    return result;
+}
+
+Dataset loadFile(const std::string& path, SkipAllZeroRows skipAllZeroRows) {
+    MemoryMappedFile file(path);
+    const std::string_view contents(
+        reinterpret_cast<const char*>(file.data()),
+        file.size()
+    );
+    Dataset dataset = parse(contents, skipAllZeroRows);
+    LDEBUG(fmt::format(
+        "Loaded {} rows with {} values from '{}'",
+        dataset.nRows(), dataset.nValuesPerRow, path
+    ));
+    return dataset;
+}
+
+Dataset parse(std::string_view contents, SkipAllZeroRows skipAllZeroRows) {
+    Dataset dataset;
+    const std::string_view data = parseHeader(contents, dataset);
+    const std::vector<std::string_view> chunks = splitIntoChunks(data);
+
+    std::unique_ptr<ThreadPool> pool;
+    if (chunks.size() > 1) {
+        // The calling thread participates in the parallelFor
+        const unsigned int nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        pool = std::make_unique<ThreadPool>(nThreads - 1);
+    }
+    auto forEachChunk = [&](auto f) {
+        if (pool) {
+            pool->parallelFor(0, chunks.size(), f);
+        }
+        else {
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                f(i);
+            }
+        }
+    };
+
+    // First pass: count the rows in each chunk to know where each chunk's rows start
+    std::vector<size_t> firstRow(chunks.size() + 1, 0);
+    forEachChunk([&](size_t i) { firstRow[i + 1] = countDataLines(chunks[i]); });
+    for (size_t i = 1; i < firstRow.size(); ++i) {
+        firstRow[i] += firstRow[i - 1];
+    }
+
+    // Second pass: parse all rows directly into their final location
+    dataset.columns.resize(dataset.nValuesPerRow);
+    for (std::vector<float>& column : dataset.columns) {
+        column.resize(firstRow.back());
+    }
+    forEachChunk([&](size_t i) { parseChunk(chunks[i], firstRow[i], dataset.columns); });
+
+    if (skipAllZeroRows) {
+        removeAllZeroRows(dataset.columns);
+    }
+
+    return dataset;
+}
+
+std::string_view nextLine(std::string_view& buffer) {
+    const size_t lineEnd = buffer.find('\n');
+    std::string_view line = buffer.substr(0, lineEnd);
+    buffer = (lineEnd == std::string_view::npos) ?
+        std::string_view() :
+        buffer.substr(lineEnd + 1);
+
+    // Guard against wrong line endings (copying files from Windows to Mac)
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+int parseValues(std::string_view line, float* values, int nValues) {
+    const char* p = line.data();
+    const char* end = line.data() + line.size();
+
+    int n = 0;
+    while (n < nValues) {
+        while (p != end && isSpace(*p)) {
+            ++p;
+        }
+        if (p == end || *p == '#') {
+            break;
+        }
+
+        p = parseFloat(p, end, values[n]);
+        if (!p) {
+            break;
+        }
+        ++n;
+    }
+    return n;
+}
+
+} // namespace openspace::speck
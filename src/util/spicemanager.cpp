@@ -220,6 +220,8 @@ SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
         )
     );
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     std::string path = absPath(std::move(filePath));
     const auto it = std::find_if(
         _loadedKernels.begin(),
@@ -273,6 +275,8 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
     ghoul_assert(kernelId <= _lastAssignedKernel, "Invalid unassigned kernel");
     ghoul_assert(kernelId != KernelHandle(0), "Invalid zero handle");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     const auto it = std::find_if(
         _loadedKernels.begin(),
         _loadedKernels.end(),
@@ -298,6 +302,8 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
 void SpiceManager::unloadKernel(std::string filePath) {
     ghoul_assert(!filePath.empty(), "Empty filename");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     std::string path = absPath(std::move(filePath));
 
     const auto it = std::find_if(
@@ -334,6 +340,8 @@ void SpiceManager::unloadKernel(std::string filePath) {
 bool SpiceManager::hasSpkCoverage(const std::string& target, double et) const {
     ghoul_assert(!target.empty(), "Empty target");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     const int id = naifId(target);
     const auto it = _spkIntervals.find(id);
     if (it != _spkIntervals.end()) {
@@ -350,6 +358,8 @@ bool SpiceManager::hasSpkCoverage(const std::string& target, double et) const {
 bool SpiceManager::hasCkCoverage(const std::string& frame, double et) const {
     ghoul_assert(!frame.empty(), "Empty target");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     const int id = frameId(frame);
     const auto it = _ckIntervals.find(id);
     if (it != _ckIntervals.end()) {
@@ -364,6 +374,8 @@ bool SpiceManager::hasCkCoverage(const std::string& frame, double et) const {
 }
 
 bool SpiceManager::hasValue(int naifId, const std::string& item) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     return bodfnd_c(naifId, item.c_str());
 }
 
@@ -378,6 +390,8 @@ bool SpiceManager::hasValue(const std::string& body, const std::string& item) co
 int SpiceManager::naifId(const std::string& body) const {
     ghoul_assert(!body.empty(), "Empty body");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     SpiceBoolean success;
     SpiceInt id;
     bods2c_c(body.c_str(), &id, &success);
@@ -390,6 +404,8 @@ int SpiceManager::naifId(const std::string& body) const {
 bool SpiceManager::hasNaifId(const std::string& body) const {
     ghoul_assert(!body.empty(), "Empty body");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     SpiceBoolean success;
     SpiceInt id;
     bods2c_c(body.c_str(), &id, &success);
@@ -400,6 +416,8 @@ bool SpiceManager::hasNaifId(const std::string& body) const {
 int SpiceManager::frameId(const std::string& frame) const {
     ghoul_assert(!frame.empty(), "Empty frame");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     SpiceInt id;
     namfrm_c(frame.c_str(), &id);
     if (id == 0 && _useExceptions) {
@@ -411,6 +429,8 @@ int SpiceManager::frameId(const std::string& frame) const {
 bool SpiceManager::hasFrameId(const std::string& frame) const {
     ghoul_assert(!frame.empty(), "Empty frame");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     SpiceInt id;
     namfrm_c(frame.c_str(), &id);
     return id != 0;
@@ -432,24 +452,32 @@ void getValueInternal(const std::string& body, const std::string& value, int siz
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             double& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     getValueInternal(body, value, 1, &v);
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec2& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     getValueInternal(body, value, 2, glm::value_ptr(v));
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec3& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     getValueInternal(body, value, 3, glm::value_ptr(v));
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec4& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     getValueInternal(body, value, 4, glm::value_ptr(v));
 }
 
@@ -458,12 +486,16 @@ void SpiceManager::getValue(const std::string& body, const std::string& value,
 {
     ghoul_assert(!v.empty(), "Array for values has to be preallocaed");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     getValueInternal(body, value, static_cast<int>(v.size()), v.data());
 }
 
 double SpiceManager::spacecraftClockToET(const std::string& craft, double craftTicks) {
     ghoul_assert(!craft.empty(), "Empty craft");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     int craftId = naifId(craft);
     double et;
     sct2e_c(craftId, craftTicks, &et);
@@ -476,6 +508,8 @@ double SpiceManager::spacecraftClockToET(const std::string& craft, double craftT
 double SpiceManager::ephemerisTimeFromDate(const std::string& timeString) const {
     ghoul_assert(!timeString.empty(), "Empty timeString");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     double et;
     str2et_c(timeString.c_str(), &et);
     throwOnSpiceError(fmt::format("Error converting date '{}'", timeString));
@@ -487,6 +521,8 @@ std::string SpiceManager::dateFromEphemerisTime(double ephemerisTime,
 {
     ghoul_assert(!formatString.empty(), "Format is empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     constexpr const int BufferSize = 256;
     SpiceChar buffer[BufferSize];
     timout_c(ephemerisTime, formatString.c_str(), BufferSize - 1, buffer);
@@ -509,6 +545,8 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
     ghoul_assert(!observer.empty(), "Observer is not empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame is not empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     bool targetHasCoverage = hasSpkCoverage(target, ephemerisTime);
     bool observerHasCoverage = hasSpkCoverage(observer, ephemerisTime);
     if (!targetHasCoverage && !observerHasCoverage) {
@@ -589,6 +627,8 @@ glm::dmat3 SpiceManager::frameTransformationMatrix(const std::string& from,
     ghoul_assert(!from.empty(), "From must not be empty");
     ghoul_assert(!to.empty(), "To must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     // get rotation matrix from frame A - frame B
     glm::dmat3 transform;
     pxform_c(
@@ -625,6 +665,8 @@ SpiceManager::SurfaceInterceptResult SpiceManager::surfaceIntercept(
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
     ghoul_assert(directionVector != glm::dvec3(0.0), "Direction vector must not be zero");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     const std::string ComputationMethod = "ELLIPSOID";
 
     SurfaceInterceptResult result;
@@ -668,6 +710,8 @@ bool SpiceManager::isTargetInFieldOfView(const std::string& target,
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
     ghoul_assert(!instrument.empty(), "Instrument must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     int visible;
     fovtrg_c(instrument.c_str(),
         target.c_str(),
@@ -715,6 +759,8 @@ SpiceManager::TargetStateResult SpiceManager::targetState(const std::string& tar
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     TargetStateResult result;
     result.lightTime = 0.0;
 
@@ -749,6 +795,8 @@ SpiceManager::TransformMatrix SpiceManager::stateTransformMatrix(
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "toFrame must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     TransformMatrix m;
     sxform_c(
         sourceFrame.c_str(),
@@ -771,6 +819,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     glm::dmat3 result;
     pxform_c(
         sourceFrame.c_str(),
@@ -801,6 +851,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     glm::dmat3 result;
 
     pxfrm2_c(
@@ -826,6 +878,8 @@ SpiceManager::fieldOfView(const std::string& instrument) const
 }
 
 SpiceManager::FieldOfViewResult SpiceManager::fieldOfView(int instrument) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     constexpr int MaxBoundsSize = 64;
     constexpr int BufferSize = 128;
 
@@ -887,6 +941,8 @@ SpiceManager::TerminatorEllipseResult SpiceManager::terminatorEllipse(
     ghoul_assert(!lightSource.empty(), "Light source must not be empty");
     ghoul_assert(numberOfTerminatorPoints >= 1, "Terminator points must be >= 1");
 
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     TerminatorEllipseResult res;
 
     // Warning: This assumes std::vector<glm::dvec3> to have all values memory contiguous
@@ -914,6 +970,8 @@ SpiceManager::TerminatorEllipseResult SpiceManager::terminatorEllipse(
 }
 
 bool SpiceManager::addFrame(std::string body, std::string frame) {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     if (body.empty() || frame.empty()) {
         return false;
     }
@@ -924,6 +982,8 @@ bool SpiceManager::addFrame(std::string body, std::string frame) {
 }
 
 std::string SpiceManager::frameFromBody(const std::string& body) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     for (const std::pair<std::string, std::string>& pair : _frameByBody) {
         if (pair.first == body) {
             return pair.second;
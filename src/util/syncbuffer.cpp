@@ -24,6 +24,8 @@
 
 #include <openspace/util/syncbuffer.h>
 
+#include <algorithm>
+
 namespace openspace {
 
 SyncBuffer::SyncBuffer(size_t n)
@@ -35,7 +37,7 @@ SyncBuffer::SyncBuffer(size_t n)
 SyncBuffer::~SyncBuffer() {} // NOLINT
 
 void SyncBuffer::encode(const std::string& s) {
-    ghoul_assert(_encodeOffset + sizeof(char) * s.size() + sizeof(int32_t) < _n, "");
+    reserveForEncode(sizeof(char) * s.size() + sizeof(int32_t));
 
     int32_t length = static_cast<int32_t>(s.length());
     memcpy(
@@ -49,6 +51,10 @@ void SyncBuffer::encode(const std::string& s) {
 }
 
 std::string SyncBuffer::decode() {
+    ghoul_assert(
+        _decodeOffset + sizeof(int32_t) <= _dataStream.size(),
+        "Reading past the data"
+    );
     int32_t length;
     memcpy(
         reinterpret_cast<char*>(&length),
@@ -75,13 +81,23 @@ void SyncBuffer::setData(std::vector<char> data) {
 std::vector<char> SyncBuffer::data() {
     _dataStream.resize(_encodeOffset);
 
-    return _dataStream;
+    return std::move(_dataStream);
 }
 
 void SyncBuffer::reset() {
+    // Remember how much the last frame needed so that the next one does not have to
+    // grow the buffer again
+    _n = std::max(_n, _encodeOffset);
+    _dataStream.clear();
     _dataStream.resize(_n);
     _encodeOffset = 0;
     _decodeOffset = 0;
 }
 
+void SyncBuffer::reserveForEncode(size_t size) {
+    if (_encodeOffset + size > _dataStream.size()) {
+        _dataStream.resize(std::max(_dataStream.size() * 2, _encodeOffset + size));
+    }
+}
+
 } // namespace openspace
@@ -24,79 +24,166 @@
 
 #include <openspace/util/threadpool.h>
 
-namespace openspace {
-
-Worker::Worker(ThreadPool& p) : pool(p) {}
-
-void Worker::operator()() {
-    std::function<void()> task;
-    while (true) {
-        // acquire lock
-        {
-            std::unique_lock<std::mutex> lock(pool.queue_mutex);
-
-            // look for a work item
-            while (!pool.stop && pool.tasks.empty()) {
-                // if there are none wait for notification
-                pool.condition.wait(lock);
-            }
+namespace {
+    // The number of times an idle worker looks for work before it goes to sleep. This
+    // avoids the cost of sleeping and waking up during bursts of small tasks
+    constexpr const int NumSearchesBeforeSleep = 16;
 
-            if (pool.stop) { // exit if the pool is stopped
-                return;
-            }
-
-            // get the task from the queue
-            task = pool.tasks.front();
-            pool.tasks.pop_front();
+    // The pool and the index of the worker that is executing on the current thread. These
+    // are used to place tasks that are created by a worker into that worker's own queue
+    thread_local const openspace::ThreadPool* CurrentPool = nullptr;
+    thread_local size_t CurrentWorker = 0;
+} // namespace
 
-        } // release lock
+namespace openspace {
 
-        // execute the task
-        task();
+ThreadPool::ThreadPool(size_t numThreads) {
+    // Even a pool without any threads needs a queue to store the enqueued tasks
+    const size_t nQueues = std::max<size_t>(numThreads, 1);
+    _queues.reserve(nQueues);
+    for (size_t i = 0; i < nQueues; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
     }
-}
 
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
+    _workers.reserve(numThreads);
     for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(std::thread(Worker(*this)));
+        _workers.emplace_back([this, i]() { workerLoop(i); });
     }
 }
 
-ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy.workers.size()) {}
+ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy._workers.size()) {}
 
 // the destructor joins all threads
 ThreadPool::~ThreadPool() {
-    // stop all threads
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
     }
-    condition.notify_all();
+    _sleepCondition.notify_all();
 
-    // join them
-    for (std::thread& w : workers) {
+    for (std::thread& w : _workers) {
         w.join();
     }
 }
 
-// add new work item to the pool
 void ThreadPool::enqueue(std::function<void()> f) {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-
-        // add the task
-        tasks.push_back(std::move(f));
-    } // release lock
+    push(std::move(f), Priority::Normal, false);
+}
 
-    // wake up one thread
-    condition.notify_one();
+void ThreadPool::enqueue(std::function<void()> f, Priority priority) {
+    push(std::move(f), priority, false);
 }
 
 void ThreadPool::clearTasks() {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.clear();
-    } // release lock
+    for (std::unique_ptr<WorkerQueue>& queue : _queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        for (int p = 0; p < NumPriorities; ++p) {
+            _nPendingTasks -= queue->tasks[p].size();
+            queue->tasks[p].clear();
+            queue->sizes[p] = 0;
+        }
+    }
+}
+
+size_t ThreadPool::numThreads() const {
+    return _workers.size();
+}
+
+void ThreadPool::push(std::function<void()> task, Priority priority, bool runNext) {
+    const bool isWorker = (CurrentPool == this);
+    const size_t index = isWorker ?
+        CurrentWorker :
+        _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+
+    WorkerQueue& queue = *_queues[index];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        const int p = static_cast<int>(priority);
+        if (runNext) {
+            queue.tasks[p].push_front(std::move(task));
+        }
+        else {
+            queue.tasks[p].push_back(std::move(task));
+        }
+        ++queue.sizes[p];
+        ++_nPendingTasks;
+    }
+
+    // A worker that is about to go to sleep increments the number of sleeping workers
+    // before it checks the pending tasks, so either it sees the new task or we see it
+    if (_nSleepingWorkers > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _sleepCondition.notify_one();
+    }
+}
+
+bool ThreadPool::pop(size_t index, std::function<void()>& task) {
+    for (int p = NumPriorities - 1; p >= 0; --p) {
+        // First look in our own queue, then try to steal a task from the other workers
+        for (size_t i = 0; i < _queues.size(); ++i) {
+            const bool isOwnQueue = (i == 0);
+            WorkerQueue& queue = *_queues[(index + i) % _queues.size()];
+            if (queue.sizes[p] == 0) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(queue.mutex, std::defer_lock);
+            if (isOwnQueue) {
+                lock.lock();
+            }
+            else if (!lock.try_lock()) {
+                continue;
+            }
+
+            std::deque<std::function<void()>>& tasks = queue.tasks[p];
+            if (tasks.empty()) {
+                continue;
+            }
+            if (isOwnQueue) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            else {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            --queue.sizes[p];
+            --_nPendingTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    CurrentPool = this;
+    CurrentWorker = index;
+
+    std::function<void()> task;
+    int nFailedSearches = 0;
+    while (!_stop) {
+        if (pop(index, task)) {
+            task();
+            task = nullptr;
+            nFailedSearches = 0;
+            continue;
+        }
+
+        if (nFailedSearches < NumSearchesBeforeSleep) {
+            ++nFailedSearches;
+            std::this_thread::yield();
+            continue;
+        }
+
+        // We didn't find any work, so we go to sleep until new tasks are enqueued. As the
+        // stealing uses try_lock, we might have missed a task, so we only go to sleep if
+        // there really is nothing left to do
+        nFailedSearches = 0;
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        ++_nSleepingWorkers;
+        _sleepCondition.wait(lock, [this]() { return _stop || _nPendingTasks > 0; });
+        --_nSleepingWorkers;
+    }
 }
 
 } // namespace openspace
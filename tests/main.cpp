@@ -64,27 +64,55 @@
 #include <test_common.inl>
 #include <test_assetloader.inl>
 #include <test_documentation.inl>
+#include <test_indexedrecording.inl>
+#include <test_keyframecodec.inl>
 #include <test_luaconversions.inl>
 #include <test_optionproperty.inl>
+#include <test_parallelserver.inl>
 #include <test_powerscalecoordinates.inl>
+#include <test_recordingwriter.inl>
+#include <test_sceneupdate.inl>
 #include <test_scriptscheduler.inl>
+#include <test_speckcache.inl>
+#include <test_speckloader.inl>
 #include <test_spicemanager.inl>
+#include <test_syncengine.inl>
+#include <test_threadpool.inl>
 #include <test_timeline.inl>
 
 #ifdef OPENSPACE_MODULE_GLOBEBROWSING_ENABLED
 #include <test_angle.inl>
+#include <test_chunktree.inl>
 #include <test_concurrentjobmanager.inl>
 #include <test_concurrentqueue.inl>
+#include <test_disktilecache.inl>
+#include <test_geodeticindex.inl>
+#include <test_heighttilecache.inl>
 #include <test_lrucache.inl>
+#include <test_temporalproviderpool.inl>
+#include <test_tilemetadatakernel.inl>
+#include <test_tileioscheduler.inl>
 #include <test_gdalwms.inl>
 #endif
 
+#ifdef OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
+#include <test_fieldlinesprefetch.inl>
+#include <test_fieldlinesstate.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+#include <test_constructoctreetask.inl>
+#include <test_octreemanager.inl>
+#include <test_octreenodeloader.inl>
+#endif
+
 #ifdef OPENSPACE_MODULE_ISWA_ENABLED
 #include <test_screenspaceimage.inl>
 #endif
 
 #ifdef OPENSPACE_MODULE_VOLUME_ENABLED
 #include <test_rawvolumeio.inl>
+#include <test_volumestreamingwindow.inl>
 #endif
 
 // Regression tests
@@ -0,0 +1,451 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/chunktree.h>
+#include <openspace/util/threadpool.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+    using openspace::globebrowsing::Chunk;
+    using openspace::globebrowsing::ChunkTree;
+    using openspace::globebrowsing::GeodeticPatch;
+    using openspace::globebrowsing::Quad;
+    using openspace::globebrowsing::TileIndex;
+
+    using TileSet = std::set<std::tuple<int, int, int>>;
+
+    constexpr const int MinLevel = 2;
+    constexpr const int MaxLevel = 16;
+
+    const TileIndex LeftRoot = TileIndex(0, 0, 1);
+    const TileIndex RightRoot = TileIndex(1, 0, 1);
+
+    // A simplified version of the culling and level of detail selection of the
+    // RenderableGlobe for a unit sphere that only depends on the camera position
+    struct View {
+        glm::dvec3 camera;
+        double lodScaleFactor = 4.0;
+    };
+
+    glm::dvec3 surfacePosition(const GeodeticPatch& patch) {
+        const double lat = patch.center().lat;
+        const double lon = patch.center().lon;
+        return glm::dvec3(
+            std::cos(lat) * std::cos(lon),
+            std::cos(lat) * std::sin(lon),
+            std::sin(lat)
+        );
+    }
+
+    std::pair<bool, Chunk::Status> evaluate(const View& view, const GeodeticPatch& patch,
+                                            int level)
+    {
+        const glm::dvec3 p = surfacePosition(patch);
+        const double radius = 2.0 * std::max(patch.halfSize().lat, patch.halfSize().lon);
+        const bool isVisible = glm::dot(p, glm::normalize(view.camera)) > -radius;
+
+        const double distance = std::max(glm::length(view.camera - p) - radius, 1e-9);
+        const int desiredLevel = std::clamp(
+            static_cast<int>(std::ceil(std::log2(view.lodScaleFactor / distance))),
+            MinLevel,
+            MaxLevel
+        );
+
+        Chunk::Status status = Chunk::Status::DoNothing;
+        if (desiredLevel < level) {
+            status = Chunk::Status::WantMerge;
+        }
+        else if (level < desiredLevel) {
+            status = Chunk::Status::WantSplit;
+        }
+        return { isVisible, status };
+    }
+
+    struct TestEvaluator : public ChunkTree::Evaluator {
+        void initializeChunk(Chunk&) override {
+            nInitialized++;
+        }
+
+        void prepareChunk(Chunk&) override {}
+
+        void evaluateChunk(Chunk& chunk) const override {
+            std::tie(chunk.isVisible, chunk.status) = evaluate(
+                view,
+                chunk.surfacePatch,
+                chunk.tileIndex.level
+            );
+        }
+
+        bool commitChunk(const Chunk& chunk) override {
+            return waitingForData.find(chunk.tileIndex.hashKey()) == waitingForData.end();
+        }
+
+        void removeChunk(const Chunk&) override {
+            nRemoved++;
+        }
+
+        View view;
+        std::set<TileIndex::TileHashKey> waitingForData;
+        size_t nInitialized = 0;
+        size_t nRemoved = 0;
+    };
+
+    // The pointer based tree that the RenderableGlobe used before the ChunkTree, which
+    // serves as the reference for the results and the performance
+    struct ReferenceNode {
+        ReferenceNode(const TileIndex& index) : tileIndex(index), patch(index) {}
+
+        TileIndex tileIndex;
+        GeodeticPatch patch;
+        Chunk::Status status = Chunk::Status::DoNothing;
+        bool isVisible = true;
+        std::array<std::unique_ptr<ReferenceNode>, 4> children;
+    };
+
+    bool isLeaf(const ReferenceNode& node) {
+        return node.children[0] == nullptr;
+    }
+
+    void split(ReferenceNode& node) {
+        for (int q = 0; q < 4; ++q) {
+            node.children[q] = std::make_unique<ReferenceNode>(
+                node.tileIndex.child(static_cast<Quad>(q))
+            );
+        }
+    }
+
+    bool updateReference(ReferenceNode& node, const View& view) {
+        if (isLeaf(node)) {
+            std::tie(node.isVisible, node.status) = evaluate(
+                view,
+                node.patch,
+                node.tileIndex.level
+            );
+            if (node.status == Chunk::Status::WantSplit) {
+                split(node);
+            }
+            return node.status == Chunk::Status::WantMerge;
+        }
+        else {
+            char requestedMergeMask = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (updateReference(*node.children[i], view)) {
+                    requestedMergeMask |= (1 << i);
+                }
+            }
+            std::tie(node.isVisible, node.status) = evaluate(
+                view,
+                node.patch,
+                node.tileIndex.level
+            );
+            if (requestedMergeMask == 0xf && node.status != Chunk::Status::WantSplit) {
+                for (std::unique_ptr<ReferenceNode>& child : node.children) {
+                    child = nullptr;
+                }
+            }
+            return false;
+        }
+    }
+
+    // The breadth first traversal that was used to collect the chunks to render
+    void collectReference(const ReferenceNode& root, std::vector<const ReferenceNode*>& r)
+    {
+        std::vector<const ReferenceNode*> Q;
+        Q.reserve(256);
+        Q.push_back(&root);
+        while (!Q.empty()) {
+            const ReferenceNode* n = Q.front();
+            Q.erase(Q.begin());
+
+            if (isLeaf(*n) && n->isVisible) {
+                r.push_back(n);
+            }
+            if (!isLeaf(*n)) {
+                for (int i = 0; i < 4; ++i) {
+                    Q.push_back(n->children[i].get());
+                }
+            }
+        }
+    }
+
+    TileSet visibleLeaves(const ChunkTree& tree) {
+        std::vector<const Chunk*> global;
+        std::vector<const Chunk*> local;
+        tree.collectVisibleLeaves(MaxLevel + 1, global, local);
+        EXPECT_TRUE(local.empty());
+
+        TileSet result;
+        for (const Chunk* c : global) {
+            result.emplace(c->tileIndex.level, c->tileIndex.x, c->tileIndex.y);
+        }
+        EXPECT_EQ(result.size(), global.size());
+        return result;
+    }
+
+    TileSet visibleLeaves(const ReferenceNode& left, const ReferenceNode& right) {
+        std::vector<const ReferenceNode*> nodes;
+        collectReference(left, nodes);
+        collectReference(right, nodes);
+
+        TileSet result;
+        for (const ReferenceNode* n : nodes) {
+            result.emplace(n->tileIndex.level, n->tileIndex.x, n->tileIndex.y);
+        }
+        return result;
+    }
+
+    // Returns the number of chunks that can be reached from the roots and checks that
+    // the children are the subdivisions of their parent
+    size_t validateSubtree(const ChunkTree& tree, const Chunk& chunk) {
+        if (chunk.isLeaf()) {
+            return 1;
+        }
+        size_t n = 1;
+        for (int q = 0; q < 4; ++q) {
+            const Chunk& child = tree.child(chunk, static_cast<Quad>(q));
+            EXPECT_EQ(child.tileIndex, chunk.tileIndex.child(static_cast<Quad>(q)));
+            n += validateSubtree(tree, child);
+        }
+        return n;
+    }
+
+    // A camera that approaches the globe, follows the surface at a low altitude for a
+    // while, and flies away again
+    std::vector<View> cameraPath(int nFrames) {
+        std::vector<View> path;
+        for (int i = 0; i < nFrames; ++i) {
+            const double t = static_cast<double>(i) / (nFrames - 1);
+            const double altitude = 1e-3 + 8.0 * std::pow(std::abs(2.0 * t - 1.0), 3.0);
+            const double angle = glm::two_pi<double>() * t;
+            const double r = 1.0 + altitude;
+            path.push_back({
+                glm::dvec3(r * std::cos(angle), r * std::sin(angle), 0.3 * r)
+            });
+        }
+        return path;
+    }
+} // namespace
+
+class ChunkTreeTest : public testing::Test {};
+
+TEST_F(ChunkTreeTest, MatchesRecursiveUpdate) {
+    ChunkTree tree({ LeftRoot, RightRoot });
+    TestEvaluator evaluator;
+    ReferenceNode left(LeftRoot);
+    ReferenceNode right(RightRoot);
+
+    for (const View& view : cameraPath(120)) {
+        evaluator.view = view;
+        tree.update(evaluator);
+        updateReference(left, view);
+        updateReference(right, view);
+
+        ASSERT_EQ(visibleLeaves(tree), visibleLeaves(left, right));
+        EXPECT_EQ(
+            validateSubtree(tree, tree.root(0)) + validateSubtree(tree, tree.root(1)),
+            tree.numChunks()
+        );
+    }
+    EXPECT_GT(evaluator.nRemoved, 0);
+    EXPECT_EQ(tree.numChunks(), 2 + evaluator.nInitialized - evaluator.nRemoved);
+}
+
+TEST_F(ChunkTreeTest, SkipsSettledSubtrees) {
+    ChunkTree tree({ LeftRoot, RightRoot });
+    TestEvaluator evaluator;
+    evaluator.view = { glm::dvec3(0.0, 1.01, 0.0) };
+
+    // Let the tree converge for the static view
+    size_t nChunks = 0;
+    do {
+        nChunks = tree.numChunks();
+        tree.update(evaluator);
+    } while (tree.numChunks() != nChunks);
+
+    tree.update(evaluator, ChunkTree::SkipSettled::Yes);
+    EXPECT_EQ(tree.numEvaluatedChunks(), 0);
+
+    // A chunk that is waiting for its tiles keeps the path to the root unsettled
+    const Chunk* leaf = &tree.root(1);
+    while (!leaf->isLeaf()) {
+        leaf = &tree.child(*leaf, Quad::NORTH_WEST);
+    }
+    const size_t depth = leaf->tileIndex.level - RightRoot.level + 1;
+    evaluator.waitingForData.insert(leaf->tileIndex.hashKey());
+    tree.update(evaluator);
+    EXPECT_EQ(tree.numEvaluatedChunks(), tree.numChunks());
+    for (int i = 0; i < 3; ++i) {
+        tree.update(evaluator, ChunkTree::SkipSettled::Yes);
+        EXPECT_EQ(tree.numEvaluatedChunks(), depth);
+    }
+
+    evaluator.waitingForData.clear();
+    tree.update(evaluator, ChunkTree::SkipSettled::Yes);
+    EXPECT_EQ(tree.numEvaluatedChunks(), depth);
+    tree.update(evaluator, ChunkTree::SkipSettled::Yes);
+    EXPECT_EQ(tree.numEvaluatedChunks(), 0);
+}
+
+TEST_F(ChunkTreeTest, SplitChunksAreSettledOnlyAfterEvaluation) {
+    ChunkTree tree({ LeftRoot, RightRoot });
+    TestEvaluator evaluator;
+    evaluator.view = { glm::dvec3(0.0, 1.01, 0.0) };
+
+    // Skipping settled chunks must still refine the tree as if everything was evaluated
+    ChunkTree reference({ LeftRoot, RightRoot });
+    TestEvaluator referenceEvaluator;
+    referenceEvaluator.view = evaluator.view;
+    for (int i = 0; i < 24; ++i) {
+        tree.update(evaluator, ChunkTree::SkipSettled::Yes);
+        reference.update(referenceEvaluator);
+        ASSERT_EQ(visibleLeaves(tree), visibleLeaves(reference));
+    }
+}
+
+TEST_F(ChunkTreeTest, NumberOfChunksIsUnbounded) {
+    ChunkTree tree({ LeftRoot, RightRoot });
+    TestEvaluator evaluator;
+    evaluator.view = { glm::dvec3(0.0, 1.0001, 0.0), 64.0 };
+
+    for (int i = 0; i < MaxLevel; ++i) {
+        tree.update(evaluator);
+    }
+
+    // The RenderableGlobe used to silently drop all chunks beyond 2048
+    const TileSet leaves = visibleLeaves(tree);
+    EXPECT_GT(leaves.size(), 2048);
+}
+
+TEST_F(ChunkTreeTest, ParallelEvaluationMatchesSerial) {
+    openspace::ThreadPool pool(4);
+    ChunkTree serialTree({ LeftRoot, RightRoot });
+    ChunkTree parallelTree({ LeftRoot, RightRoot }, &pool);
+    TestEvaluator serialEvaluator;
+    TestEvaluator parallelEvaluator;
+
+    for (View view : cameraPath(60)) {
+        view.lodScaleFactor = 32.0;
+        serialEvaluator.view = view;
+        parallelEvaluator.view = view;
+        serialTree.update(serialEvaluator);
+        parallelTree.update(parallelEvaluator);
+
+        ASSERT_EQ(visibleLeaves(parallelTree), visibleLeaves(serialTree));
+    }
+}
+
+TEST_F(ChunkTreeTest, DISABLED_Benchmark) {
+    // Runs the update of the tree and the collection of the chunks to render for a number
+    // of scripted camera paths, using the previous pointer based tree, the ChunkTree and
+    // the ChunkTree with a thread pool
+    constexpr const int NumberOfFrames = 400;
+
+    struct Path {
+        const char* name;
+        std::vector<View> views;
+    };
+    std::vector<Path> paths;
+    paths.push_back({ "Fly-by", cameraPath(NumberOfFrames) });
+    {
+        Path orbit = { "Low orbit", {} };
+        for (int i = 0; i < NumberOfFrames; ++i) {
+            const double angle = 0.25 * glm::two_pi<double>() * i / NumberOfFrames;
+            orbit.views.push_back({
+                glm::dvec3(1.002 * std::cos(angle), 1.002 * std::sin(angle), 0.0),
+                16.0
+            });
+        }
+        paths.push_back(orbit);
+    }
+    {
+        Path hover = { "Hover", {} };
+        for (int i = 0; i < NumberOfFrames; ++i) {
+            hover.views.push_back({ glm::dvec3(0.0, 0.0, 1.0005), 16.0 });
+        }
+        paths.push_back(hover);
+    }
+
+    auto msPerFrame = [](std::chrono::microseconds time) {
+        return std::chrono::duration<double, std::milli>(time).count() / NumberOfFrames;
+    };
+
+    openspace::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    for (const Path& path : paths) {
+        ReferenceNode left(LeftRoot);
+        ReferenceNode right(RightRoot);
+        std::vector<const ReferenceNode*> nodes;
+        const std::chrono::microseconds referenceTime = benchmark::measure([&]() {
+            for (const View& view : path.views) {
+                updateReference(left, view);
+                updateReference(right, view);
+                nodes.clear();
+                collectReference(left, nodes);
+                collectReference(right, nodes);
+            }
+        });
+
+        auto runTree = [&path](openspace::ThreadPool* threadPool) {
+            ChunkTree tree({ LeftRoot, RightRoot }, threadPool);
+            TestEvaluator evaluator;
+            std::vector<const Chunk*> global;
+            std::vector<const Chunk*> local;
+
+            return benchmark::measure([&]() {
+                const View* previous = nullptr;
+                for (const View& view : path.views) {
+                    const bool isUnchanged = previous &&
+                        previous->camera == view.camera &&
+                        previous->lodScaleFactor == view.lodScaleFactor;
+                    evaluator.view = view;
+                    tree.update(evaluator, ChunkTree::SkipSettled(isUnchanged));
+                    tree.collectVisibleLeaves(MaxLevel + 1, global, local);
+                    previous = &view;
+                }
+            });
+        };
+
+        const std::chrono::microseconds serialTime = runTree(nullptr);
+        const std::chrono::microseconds parallelTime = runTree(&pool);
+
+        benchmark::report(
+            "ChunkTree (" + std::string(path.name) + ", " + std::to_string(nodes.size()) +
+                " visible chunks)",
+            "pointer tree " + std::to_string(msPerFrame(referenceTime)) + " ms, " +
+                "flat tree " + std::to_string(msPerFrame(serialTime)) + " ms, " +
+                "flat tree with " + std::to_string(pool.numThreads()) + " threads " +
+                std::to_string(msPerFrame(parallelTime)) + " ms per frame"
+        );
+    }
+}
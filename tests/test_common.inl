@@ -108,3 +108,26 @@
 #endif
 
 #endif // GHL_TIMING_TESTS
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Helpers for the benchmark tests. The benchmarks are named DISABLED_* so that they only
+// run with --gtest_also_run_disabled_tests
+namespace benchmark {
+    // Returns the wall-clock time that a call to \p function takes
+    template <typename Function>
+    std::chrono::microseconds measure(Function&& function) {
+        const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start
+        );
+    }
+
+    inline void report(const std::string& benchmark, const std::string& result) {
+        std::cout << "[ BENCHMARK] " << benchmark << ": " << result << std::endl;
+    }
+} // namespace benchmark
@@ -32,6 +32,7 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <glm/glm.hpp>
+#include <algorithm>
 
 class ConcurrentJobManagerTest : public testing::Test {};
 
@@ -153,3 +154,44 @@ TEST_F(ConcurrentJobManagerTest, JobCreation) {
         auto product = finishedJob->product();
     }
 }
+
+TEST_F(ConcurrentJobManagerTest, FinishedJobsAreUnbounded) {
+    using namespace openspace;
+
+    struct IndexJob : public Job<int> {
+        IndexJob(int i) : index(i) {}
+        void execute() override {}
+        int product() override { return index; }
+        int index;
+    };
+
+    // More jobs than the lock-free part of the finished queue can hold, none of which are
+    // popped until all of them have finished
+    constexpr const int NumJobs = 5000;
+    ConcurrentJobManager<int> jobManager(ThreadPool(4));
+    for (int i = 0; i < NumJobs; ++i) {
+        jobManager.enqueueJob(std::make_shared<IndexJob>(i));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (jobManager.numFinishedJobs() < NumJobs &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(jobManager.numFinishedJobs(), NumJobs);
+
+    std::shared_ptr<Job<int>> first = jobManager.popFinishedJob();
+    ASSERT_NE(first, nullptr);
+    std::vector<std::shared_ptr<Job<int>>> rest = jobManager.popFinishedJobs();
+    ASSERT_EQ(rest.size(), NumJobs - 1);
+    EXPECT_EQ(jobManager.numFinishedJobs(), 0);
+
+    std::vector<bool> seen(NumJobs, false);
+    seen[first->product()] = true;
+    for (const std::shared_ptr<Job<int>>& job : rest) {
+        ASSERT_NE(job, nullptr);
+        seen[job->product()] = true;
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), NumJobs);
+}
@@ -24,11 +24,16 @@
 
 #include "gtest/gtest.h"
 
+#include <openspace/util/boundedconcurrentqueue.h>
 #include <openspace/util/concurrentqueue.h>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 class ConcurrentQueueTest : public testing::Test {};
 
@@ -51,3 +56,246 @@ TEST_F(ConcurrentQueueTest, SharedPtr) {
     std::cout << *val << std::endl;
 }
 */
+
+TEST_F(ConcurrentQueueTest, BoundedBasic) {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<int> q(3);
+    EXPECT_EQ(q.capacity(), 4);
+    EXPECT_TRUE(q.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(q.tryPush(i));
+    }
+    EXPECT_FALSE(q.tryPush(4)) << "Queue should be full";
+    EXPECT_EQ(q.size(), 4);
+
+    int val = -1;
+    EXPECT_TRUE(q.tryPop(val));
+    EXPECT_EQ(val, 0);
+
+    std::vector<int> values;
+    EXPECT_EQ(q.tryPopBulk(std::back_inserter(values), 10), 3);
+    EXPECT_EQ(values, std::vector<int>({ 1, 2, 3 }));
+    EXPECT_FALSE(q.tryPop(val)) << "Queue should be empty";
+
+    std::vector<int> input = { 10, 11, 12, 13, 14, 15 };
+    EXPECT_EQ(q.tryPushBulk(input.begin(), input.size()), 4);
+    values.clear();
+    EXPECT_EQ(q.tryPopBulk(std::back_inserter(values), 2), 2);
+    EXPECT_EQ(values, std::vector<int>({ 10, 11 }));
+}
+
+TEST_F(ConcurrentQueueTest, BoundedSizeCountsPublishedElements) {
+    using namespace openspace;
+
+    // Writing an element into the queue blocks until `release` is set, which leaves the
+    // cell claimed by the producer but not yet published
+    struct Element {
+        int value = 0;
+        std::atomic_bool* entered = nullptr;
+        std::atomic_bool* release = nullptr;
+
+        Element() = default;
+        Element(int v, std::atomic_bool* e = nullptr, std::atomic_bool* r = nullptr)
+            : value(v)
+            , entered(e)
+            , release(r)
+        {}
+        Element(Element&&) = default;
+
+        Element& operator=(Element&& rhs) {
+            if (rhs.entered) {
+                *rhs.entered = true;
+                while (!*rhs.release) {
+                    std::this_thread::yield();
+                }
+            }
+            value = rhs.value;
+            return *this;
+        }
+    };
+
+    BoundedConcurrentQueue<Element> q(8);
+    EXPECT_TRUE(q.tryPush(Element(1)));
+
+    std::atomic_bool entered = false;
+    std::atomic_bool release = false;
+    std::thread producer([&]() { q.tryPush(Element(2, &entered, &release)); });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(q.tryPush(Element(3)));
+
+    // Only the first element is in front of the one that is still being written
+    EXPECT_EQ(q.size(), 1);
+    Element e;
+    EXPECT_TRUE(q.tryPop(e));
+    EXPECT_EQ(e.value, 1);
+    EXPECT_EQ(q.size(), 0);
+    EXPECT_TRUE(q.empty());
+    EXPECT_FALSE(q.tryPop(e)) << "The front element has not been published yet";
+
+    release = true;
+    producer.join();
+    EXPECT_EQ(q.size(), 2);
+    EXPECT_FALSE(q.empty());
+    EXPECT_TRUE(q.tryPop(e));
+    EXPECT_EQ(e.value, 2);
+    EXPECT_TRUE(q.tryPop(e));
+    EXPECT_EQ(e.value, 3);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST_F(ConcurrentQueueTest, BoundedStress) {
+    using namespace openspace;
+
+    constexpr const int NumProducers = 4;
+    constexpr const int NumConsumers = 4;
+    constexpr const int ItemsPerProducer = 100000;
+
+    BoundedConcurrentQueue<int> q(256);
+    std::atomic_int nConsumed = 0;
+    std::atomic<long long> sum = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < NumProducers; ++p) {
+        threads.emplace_back([&q, p]() {
+            std::vector<int> batch;
+            for (int i = 0; i < ItemsPerProducer; ++i) {
+                const int value = p * ItemsPerProducer + i;
+                // Alternate between single and bulk pushes
+                if (p % 2 == 0) {
+                    q.push(value);
+                }
+                else {
+                    batch.push_back(value);
+                    if (batch.size() == 16 || i == ItemsPerProducer - 1) {
+                        q.pushBulk(batch.begin(), batch.size());
+                        batch.clear();
+                    }
+                }
+            }
+        });
+    }
+    for (int c = 0; c < NumConsumers; ++c) {
+        threads.emplace_back([&q, &nConsumed, &sum]() {
+            std::vector<int> values;
+            while (nConsumed < NumProducers * ItemsPerProducer) {
+                values.clear();
+                const size_t n = q.tryPopBulk(std::back_inserter(values), 32);
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (int v : values) {
+                    sum += v;
+                }
+                nConsumed += static_cast<int>(n);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    const long long n = static_cast<long long>(NumProducers) * ItemsPerProducer;
+    EXPECT_EQ(nConsumed, n);
+    EXPECT_EQ(sum, n * (n - 1) / 2) << "Every value must be consumed exactly once";
+    EXPECT_TRUE(q.empty());
+}
+
+TEST_F(ConcurrentQueueTest, BoundedOrderPerProducer) {
+    using namespace openspace;
+
+    constexpr const int NumItems = 200000;
+    BoundedConcurrentQueue<int> q(64);
+
+    std::thread producer([&q]() {
+        for (int i = 0; i < NumItems; ++i) {
+            q.push(i);
+        }
+    });
+
+    int expected = 0;
+    std::vector<int> values;
+    while (expected < NumItems) {
+        values.clear();
+        if (q.tryPopBulk(std::back_inserter(values), 16) == 0) {
+            std::this_thread::yield();
+        }
+        for (int v : values) {
+            ASSERT_EQ(v, expected) << "Items from one producer must keep their order";
+            ++expected;
+        }
+    }
+    producer.join();
+}
+
+TEST_F(ConcurrentQueueTest, DISABLED_ContentionBenchmark) {
+    using namespace openspace;
+
+    constexpr const int NumProducers = 4;
+    constexpr const int ItemsPerProducer = 250000;
+    constexpr const int NumItems = NumProducers * ItemsPerProducer;
+
+    // Producers push single items while a single consumer drains the queue, which
+    // mirrors the finished tile jobs that are collected by the render thread
+    auto measure = [](auto push, auto drain) {
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            std::vector<std::thread> producers;
+            for (int p = 0; p < NumProducers; ++p) {
+                producers.emplace_back([&push]() {
+                    for (int i = 0; i < ItemsPerProducer; ++i) {
+                        push(i);
+                    }
+                });
+            }
+            int nConsumed = 0;
+            while (nConsumed < NumItems) {
+                const int n = drain();
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                nConsumed += n;
+            }
+            for (std::thread& t : producers) {
+                t.join();
+            }
+        });
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
+    };
+
+    ConcurrentQueue<int> locked;
+    const long long lockedTime = measure(
+        [&locked](int v) { locked.push(v); },
+        [&locked]() {
+            int n = 0;
+            while (!locked.empty()) {
+                locked.pop();
+                ++n;
+            }
+            return n;
+        }
+    );
+
+    BoundedConcurrentQueue<int> lockFree(4096);
+    std::vector<int> buffer;
+    buffer.reserve(4096);
+    const long long lockFreeTime = measure(
+        [&lockFree](int v) { lockFree.push(v); },
+        [&lockFree, &buffer]() {
+            buffer.clear();
+            return static_cast<int>(
+                lockFree.tryPopBulk(std::back_inserter(buffer), 4096)
+            );
+        }
+    );
+
+    benchmark::report(
+        std::to_string(NumItems) + " items, " + std::to_string(NumProducers) +
+            " producers",
+        "ConcurrentQueue " + std::to_string(lockedTime) + " ms, " +
+            "BoundedConcurrentQueue " + std::to_string(lockFreeTime) + " ms"
+    );
+}
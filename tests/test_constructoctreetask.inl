@@ -0,0 +1,283 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/gaia/tasks/constructoctreetask.h>
+#include <modules/gaia/rendering/octreemanager.h>
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/dictionary.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using openspace::ConstructOctreeTask;
+    using openspace::OctreeManager;
+
+    constexpr const int ConstructMaxDist = 2; // [kPc]
+    constexpr const int ConstructMaxStarsPerNode = 256;
+
+    // The preprocessed files written by ReadFitsTask have 24 values per star
+    constexpr const int32_t ConstructValuesPerStar = 24;
+    constexpr const int RenderValues = 8;
+
+    // Only stars with a G magnitude in [0, 12] pass the filter
+    constexpr const float MinGMag = 0.f;
+    constexpr const float MaxGMag = 12.f;
+
+    // Generates stars that are clustered towards the center, similar to Gaia data
+    std::vector<float> createStars(int nStars) {
+        std::mt19937 gen(1337);
+        std::normal_distribution<float> pos(0.f, 0.3f);
+        std::uniform_real_distribution<float> mag(-5.f, 15.f);
+        std::uniform_real_distribution<float> other(-1.f, 3.f);
+
+        std::vector<float> stars(static_cast<size_t>(nStars) * ConstructValuesPerStar);
+        for (int i = 0; i < nStars; ++i) {
+            float* star = stars.data() + static_cast<size_t>(i) * ConstructValuesPerStar;
+            for (int j = 0; j < 3; ++j) {
+                star[j] = glm::clamp(
+                    pos(gen),
+                    -0.99f * ConstructMaxDist,
+                    0.99f * ConstructMaxDist
+                );
+            }
+            star[3] = mag(gen);
+            for (int j = 4; j < ConstructValuesPerStar; ++j) {
+                star[j] = other(gen);
+            }
+        }
+        return stars;
+    }
+
+    bool passesFilter(const float* star) {
+        return star[3] >= MinGMag && star[3] <= MaxGMag;
+    }
+
+    // Constructs the reference Octree one star at a time on a single thread
+    void createReferenceOctree(OctreeManager& octree, const std::vector<float>& stars) {
+        octree.initOctree(0, ConstructMaxDist, ConstructMaxStarsPerNode);
+        for (size_t i = 0; i < stars.size(); i += ConstructValuesPerStar) {
+            if (passesFilter(&stars[i])) {
+                octree.insert(std::vector<float>(
+                    stars.begin() + i,
+                    stars.begin() + i + RenderValues
+                ));
+            }
+        }
+        octree.sliceLodData();
+    }
+
+    ghoul::Dictionary taskDictionary(const std::string& inPath,
+                                     const std::string& outPath, bool singleFileInput,
+                                     int threadsToUse)
+    {
+        return {
+            { "Type", std::string("ConstructOctreeTask") },
+            { "InFileOrFolderPath", inPath },
+            { "OutFileOrFolderPath", outPath },
+            { "MaxDist", static_cast<double>(ConstructMaxDist) },
+            { "MaxStarsPerNode", static_cast<double>(ConstructMaxStarsPerNode) },
+            { "SingleFileInput", singleFileInput },
+            { "ThreadsToUse", static_cast<double>(threadsToUse) },
+            {
+                "FilterGMag",
+                ghoul::Dictionary {
+                    { "1", static_cast<double>(MinGMag) },
+                    { "2", static_cast<double>(MaxGMag) }
+                }
+            }
+        };
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ifstream::binary);
+        return std::string(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>()
+        );
+    }
+} // namespace
+
+class ConstructOctreeTaskTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _directory = absPath("${TESTDIR}/ConstructOctreeTaskTest");
+        _inFolder = _directory + "/in/";
+        _outFolder = _directory + "/out/";
+        _referenceFolder = _directory + "/reference/";
+        using Recursive = ghoul::filesystem::FileSystem::Recursive;
+        for (const std::string& folder : { _inFolder, _outFolder, _referenceFolder }) {
+            FileSys.createDirectory(folder, Recursive::Yes);
+        }
+    }
+
+    void TearDown() override {
+        FileSys.deleteDirectory(_directory);
+    }
+
+    void writeSingleFile(const std::string& path, const std::vector<float>& stars) {
+        std::ofstream file(path, std::ofstream::binary);
+        const int32_t nValues = static_cast<int32_t>(stars.size());
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+        file.write(
+            reinterpret_cast<const char*>(&ConstructValuesPerStar),
+            sizeof(int32_t)
+        );
+        file.write(
+            reinterpret_cast<const char*>(stars.data()),
+            stars.size() * sizeof(float)
+        );
+    }
+
+    // Writes one file per branch, in the same format as ReadFitsTask
+    void writeOctantFiles(const std::vector<float>& stars) {
+        OctreeManager octree;
+        octree.initOctree(0, ConstructMaxDist, ConstructMaxStarsPerNode);
+
+        std::vector<std::vector<float>> octants(8);
+        for (size_t i = 0; i < stars.size(); i += ConstructValuesPerStar) {
+            const size_t branch = octree.branchIndex(
+                stars[i],
+                stars[i + 1],
+                stars[i + 2]
+            );
+            octants[branch].insert(
+                octants[branch].end(),
+                stars.begin() + i,
+                stars.begin() + i + ConstructValuesPerStar
+            );
+        }
+
+        for (size_t branch = 0; branch < 8; ++branch) {
+            std::ofstream file(
+                _inFolder + "octant_" + std::to_string(branch) + ".bin",
+                std::ofstream::binary
+            );
+            file.write(
+                reinterpret_cast<const char*>(&ConstructValuesPerStar),
+                sizeof(int32_t)
+            );
+            file.write(
+                reinterpret_cast<const char*>(octants[branch].data()),
+                octants[branch].size() * sizeof(float)
+            );
+        }
+    }
+
+    std::string _directory;
+    std::string _inFolder;
+    std::string _outFolder;
+    std::string _referenceFolder;
+};
+
+TEST_F(ConstructOctreeTaskTest, SingleFileMatchesSerialConstruction) {
+    const std::vector<float> stars = createStars(50000);
+    const std::string inPath = _inFolder + "stars.bin";
+    const std::string outPath = _outFolder + "octree.bin";
+    const std::string referencePath = _referenceFolder + "octree.bin";
+    writeSingleFile(inPath, stars);
+
+    OctreeManager reference;
+    createReferenceOctree(reference, stars);
+    std::ofstream referenceFile(referencePath, std::ofstream::binary);
+    reference.writeToFile(referenceFile, true);
+    referenceFile.close();
+
+    ConstructOctreeTask task(taskDictionary(inPath, outPath, true, 4));
+    std::vector<float> progress;
+    task.perform([&progress](float p) { progress.push_back(p); });
+
+    ASSERT_FALSE(progress.empty());
+    EXPECT_EQ(progress.back(), 1.f);
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+
+    const std::string result = readFile(outPath);
+    ASSERT_FALSE(result.empty());
+    EXPECT_TRUE(result == readFile(referencePath));
+}
+
+TEST_F(ConstructOctreeTaskTest, FolderMatchesSerialConstruction) {
+    const std::vector<float> stars = createStars(50000);
+    writeOctantFiles(stars);
+
+    OctreeManager reference;
+    createReferenceOctree(reference, stars);
+    std::ofstream referenceIndex(_referenceFolder + "index.bin", std::ofstream::binary);
+    reference.writeToFile(referenceIndex, false);
+    referenceIndex.close();
+    for (size_t branch = 0; branch < 8; ++branch) {
+        reference.writeToMultipleFiles(_referenceFolder, branch);
+    }
+
+    ConstructOctreeTask task(taskDictionary(_inFolder, _outFolder, false, 4));
+    task.perform([](float) {});
+
+    // Every node file and the index file should be identical to the reference
+    const std::vector<std::string> referenceFiles =
+        ghoul::filesystem::Directory(_referenceFolder).readFiles();
+    const std::vector<std::string> files =
+        ghoul::filesystem::Directory(_outFolder).readFiles();
+    ASSERT_GT(referenceFiles.size(), 9u);
+    ASSERT_EQ(files.size(), referenceFiles.size());
+    for (const std::string& referenceFile : referenceFiles) {
+        const std::string name = ghoul::filesystem::File(referenceFile).filename();
+        EXPECT_TRUE(readFile(_outFolder + name) == readFile(referenceFile)) << name;
+    }
+}
+
+TEST_F(ConstructOctreeTaskTest, DISABLED_Benchmark) {
+    constexpr const int NStars = 500000;
+
+    const std::vector<float> stars = createStars(NStars);
+    const std::string inPath = _inFolder + "stars.bin";
+    writeSingleFile(inPath, stars);
+
+    auto construct = [&](int threadsToUse) {
+        const std::string outPath =
+            _outFolder + "octree_" + std::to_string(threadsToUse) + ".bin";
+        ConstructOctreeTask task(taskDictionary(inPath, outPath, true, threadsToUse));
+
+        const std::chrono::microseconds time = benchmark::measure([&task]() {
+            task.perform([](float) {});
+        });
+
+        const double seconds = std::chrono::duration<double>(time).count();
+        benchmark::report(
+            "ConstructOctreeTask (" + std::to_string(threadsToUse) + " threads)",
+            std::to_string(static_cast<int>(NStars / seconds)) + " stars/s"
+        );
+    };
+
+    construct(1);
+    construct(static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 2u, 8u)));
+}
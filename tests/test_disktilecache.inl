@@ -0,0 +1,279 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/disktilecache.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/exception.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    RawTile createTestTile(const TileTextureInitData& initData, TileIndex index,
+                           unsigned char fill)
+    {
+        RawTile tile;
+        tile.imageData = std::unique_ptr<std::byte[]>(
+            new std::byte[initData.totalNumBytes]
+        );
+        std::memset(tile.imageData.get(), fill, initData.totalNumBytes);
+        tile.tileMetaData.maxValues = { 1.f + fill, 2.f };
+        tile.tileMetaData.minValues = { -1.f, -2.f - fill };
+        tile.tileMetaData.hasMissingData = { true, false };
+        tile.textureInitData = initData;
+        tile.tileIndex = index;
+        tile.error = RawTile::ReadError::Warning;
+        return tile;
+    }
+
+    constexpr const uint64_t MB = 1024 * 1024;
+} // namespace
+
+class DiskTileCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _directory = absPath("${TESTDIR}/DiskTileCacheTest");
+    }
+
+    void TearDown() override {
+        // Remove all segment files that were created by the test
+        cache::DiskTileCache(_directory, 64 * MB).clear();
+    }
+
+    std::string _directory;
+};
+
+TEST_F(DiskTileCacheTest, PutAndGet) {
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::HeightLayers,
+        false
+    );
+    cache::DiskTileCache diskCache(_directory, 64 * MB);
+    diskCache.clear();
+
+    const uint64_t dataset = cache::DiskTileCache::datasetIdentifier(
+        "dataset.wms",
+        initData,
+        true
+    );
+    const cache::DiskTileKey key = { dataset, TileIndex(3, 2, 5) };
+    diskCache.put(key, createTestTile(initData, key.tileIndex, 42));
+
+    ASSERT_TRUE(diskCache.exist(key));
+    std::optional<RawTile> tile = diskCache.get(key, initData);
+    ASSERT_TRUE(tile.has_value());
+    EXPECT_TRUE(tile->tileIndex == key.tileIndex);
+    EXPECT_EQ(tile->error, RawTile::ReadError::Warning);
+    ASSERT_EQ(tile->tileMetaData.maxValues.size(), 2);
+    EXPECT_EQ(tile->tileMetaData.maxValues[0], 43.f);
+    EXPECT_EQ(tile->tileMetaData.minValues[1], -44.f);
+    EXPECT_TRUE(tile->tileMetaData.hasMissingData[0]);
+    EXPECT_FALSE(tile->tileMetaData.hasMissingData[1]);
+    for (size_t i = 0; i < initData.totalNumBytes; ++i) {
+        ASSERT_EQ(tile->imageData[i], std::byte(42));
+    }
+
+    // Other tiles, datasets, and mismatching texture sizes are not found
+    const cache::DiskTileKey otherTile = { dataset, TileIndex(2, 2, 5) };
+    EXPECT_FALSE(diskCache.get(otherTile, initData).has_value());
+
+    const cache::DiskTileKey otherDataset = {
+        cache::DiskTileCache::datasetIdentifier("dataset.wms", initData, false),
+        key.tileIndex
+    };
+    EXPECT_FALSE(diskCache.get(otherDataset, initData).has_value());
+
+    const TileTextureInitData colorData = tileTextureInitData(
+        layergroupid::GroupID::ColorLayers,
+        false
+    );
+    EXPECT_FALSE(diskCache.get(key, colorData).has_value());
+}
+
+TEST_F(DiskTileCacheTest, Persistence) {
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::HeightLayers,
+        false
+    );
+    const uint64_t dataset = cache::DiskTileCache::datasetIdentifier(
+        "dataset.wms",
+        initData,
+        true
+    );
+
+    {
+        cache::DiskTileCache diskCache(_directory, 64 * MB);
+        diskCache.clear();
+        for (int i = 0; i < 100; ++i) {
+            const cache::DiskTileKey key = { dataset, TileIndex(i, 0, 10) };
+            diskCache.put(key, createTestTile(initData, key.tileIndex, i % 256));
+        }
+    }
+
+    cache::DiskTileCache diskCache(_directory, 64 * MB);
+    for (int i = 0; i < 100; ++i) {
+        const cache::DiskTileKey key = { dataset, TileIndex(i, 0, 10) };
+        std::optional<RawTile> tile = diskCache.get(key, initData);
+        ASSERT_TRUE(tile.has_value());
+        EXPECT_EQ(tile->imageData[0], std::byte(i % 256));
+    }
+}
+
+TEST_F(DiskTileCacheTest, SizeBudget) {
+    // 1 MB per tile
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::ColorLayers,
+        false
+    );
+    const uint64_t dataset = cache::DiskTileCache::datasetIdentifier(
+        "dataset.wms",
+        initData,
+        false
+    );
+
+    cache::DiskTileCache diskCache(_directory, 48 * MB);
+    diskCache.clear();
+
+    for (int i = 0; i < 200; ++i) {
+        const cache::DiskTileKey key = { dataset, TileIndex(i, 0, 10) };
+        diskCache.put(key, createTestTile(initData, key.tileIndex, 1));
+        EXPECT_LE(diskCache.size(), 48 * MB);
+    }
+
+    EXPECT_FALSE(diskCache.exist({ dataset, TileIndex(0, 0, 10) }));
+    EXPECT_TRUE(diskCache.exist({ dataset, TileIndex(199, 0, 10) }));
+}
+
+TEST_F(DiskTileCacheTest, UsedTilesSurviveEviction) {
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::ColorLayers,
+        false
+    );
+    const uint64_t dataset = cache::DiskTileCache::datasetIdentifier(
+        "dataset.wms",
+        initData,
+        false
+    );
+
+    cache::DiskTileCache diskCache(_directory, 48 * MB);
+    diskCache.clear();
+
+    const cache::DiskTileKey used = { dataset, TileIndex(0, 0, 10) };
+    const cache::DiskTileKey unused = { dataset, TileIndex(1, 0, 10) };
+    for (int i = 0; i < 200; ++i) {
+        const cache::DiskTileKey key = { dataset, TileIndex(i, 0, 10) };
+        diskCache.put(key, createTestTile(initData, key.tileIndex, 1));
+        if (i > 1) {
+            ASSERT_TRUE(diskCache.get(used, initData).has_value());
+        }
+    }
+
+    EXPECT_TRUE(diskCache.exist(used));
+    EXPECT_FALSE(diskCache.exist(unused));
+}
+
+TEST_F(DiskTileCacheTest, ReplacedDatasetChangesIdentifier) {
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::HeightLayers,
+        false
+    );
+    cache::DiskTileCache diskCache(_directory, 64 * MB);
+
+    const std::string path = _directory + "/dataset.tif";
+    std::ofstream(path, std::ofstream::binary) << "first version";
+    const uint64_t original =
+        cache::DiskTileCache::datasetIdentifier(path, initData, false);
+    EXPECT_EQ(original, cache::DiskTileCache::datasetIdentifier(path, initData, false));
+
+    std::ofstream(path, std::ofstream::binary) << "the second version";
+    const uint64_t replaced =
+        cache::DiskTileCache::datasetIdentifier(path, initData, false);
+    EXPECT_NE(original, replaced) << "Replaced datasets must not reuse cached tiles";
+
+    std::remove(path.c_str());
+}
+
+TEST_F(DiskTileCacheTest, CorruptRecordsAreDiscarded) {
+    const TileTextureInitData initData = tileTextureInitData(
+        layergroupid::GroupID::HeightLayers,
+        false
+    );
+    const uint64_t dataset = cache::DiskTileCache::datasetIdentifier(
+        "dataset.wms",
+        initData,
+        true
+    );
+
+    {
+        cache::DiskTileCache diskCache(_directory, 64 * MB);
+        diskCache.clear();
+        for (int i = 0; i < 3; ++i) {
+            const cache::DiskTileKey key = { dataset, TileIndex(i, 0, 10) };
+            diskCache.put(key, createTestTile(initData, key.tileIndex, 7));
+        }
+    }
+
+    // Overwrite the image size of the second record with a value that would point far
+    // outside of the segment. The first record starts behind the 64 byte segment header
+    // and its size is stored at byte 24 of its header, the image size at byte 32
+    {
+        std::fstream segment(
+            _directory + "/0000000000.tilesegment",
+            std::fstream::in | std::fstream::out | std::fstream::binary
+        );
+        ASSERT_TRUE(segment.good());
+        uint64_t firstRecordSize = 0;
+        segment.seekg(64 + 24);
+        segment.read(reinterpret_cast<char*>(&firstRecordSize), sizeof(uint64_t));
+        const uint64_t imageSize = 1ULL << 40;
+        segment.seekp(64 + firstRecordSize + 32);
+        segment.write(reinterpret_cast<const char*>(&imageSize), sizeof(uint64_t));
+    }
+
+    cache::DiskTileCache diskCache(_directory, 64 * MB);
+    EXPECT_TRUE(diskCache.get({ dataset, TileIndex(0, 0, 10) }, initData).has_value());
+    EXPECT_FALSE(diskCache.exist({ dataset, TileIndex(1, 0, 10) }));
+    EXPECT_FALSE(diskCache.exist({ dataset, TileIndex(2, 0, 10) }));
+
+    // New tiles are written over the discarded records
+    const cache::DiskTileKey key = { dataset, TileIndex(3, 0, 10) };
+    diskCache.put(key, createTestTile(initData, key.tileIndex, 9));
+    std::optional<RawTile> tile = diskCache.get(key, initData);
+    ASSERT_TRUE(tile.has_value());
+    EXPECT_EQ(tile->imageData[0], std::byte(9));
+}
+
+TEST_F(DiskTileCacheTest, DirectoryIsLocked) {
+    {
+        cache::DiskTileCache diskCache(_directory, 64 * MB);
+        EXPECT_THROW(cache::DiskTileCache{ _directory, 64 * MB }, ghoul::RuntimeError);
+    }
+
+    // The lock is released together with the cache
+    EXPECT_NO_THROW(cache::DiskTileCache{ _directory, 64 * MB });
+}
@@ -0,0 +1,112 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/fieldlinessequence/util/commons.h>
+
+#include <vector>
+
+namespace {
+    // Ten states that each last for ten seconds, starting at 0
+    const std::vector<double> PrefetchStartTimes = {
+        0.0, 10.0, 20.0, 30.0, 40.0, 50.0, 60.0, 70.0, 80.0, 90.0
+    };
+} // namespace
+
+class FieldlinesPrefetchTest : public testing::Test {};
+
+TEST_F(FieldlinesPrefetchTest, ForwardWindowFollowsLookAhead) {
+    using namespace openspace;
+
+    // At t = 25 looking 20 s ahead, the states starting at 30 and 40 become active
+    const std::vector<int> window = fls::prefetchWindow(
+        PrefetchStartTimes,
+        2,
+        25.0,
+        20.0,
+        8
+    );
+    EXPECT_EQ(std::vector<int>({ 2, 3, 4 }), window);
+}
+
+TEST_F(FieldlinesPrefetchTest, BackwardWindowUsesEndOfStates) {
+    using namespace openspace;
+
+    // Going backward from t = 55, state 4 becomes active when crossing 50 and state 3
+    // when crossing 40; state 2 is not reached before t = 30
+    const std::vector<int> window = fls::prefetchWindow(
+        PrefetchStartTimes,
+        5,
+        55.0,
+        -20.0,
+        8
+    );
+    EXPECT_EQ(std::vector<int>({ 5, 4, 3 }), window);
+}
+
+TEST_F(FieldlinesPrefetchTest, NextStateIsAlwaysIncluded) {
+    using namespace openspace;
+
+    // Paused time still prepares the state that follows in the forward direction
+    EXPECT_EQ(
+        std::vector<int>({ 2, 3 }),
+        fls::prefetchWindow(PrefetchStartTimes, 2, 25.0, 0.0, 8)
+    );
+    EXPECT_EQ(
+        std::vector<int>({ 5, 4 }),
+        fls::prefetchWindow(PrefetchStartTimes, 5, 55.0, -0.001, 8)
+    );
+}
+
+TEST_F(FieldlinesPrefetchTest, WindowIsBoundedByMaxStates) {
+    using namespace openspace;
+
+    EXPECT_EQ(
+        std::vector<int>({ 0, 1, 2 }),
+        fls::prefetchWindow(PrefetchStartTimes, 0, 0.0, 1000.0, 3)
+    );
+    // The active state is kept even if there is only room for one state
+    EXPECT_EQ(
+        std::vector<int>({ 4 }),
+        fls::prefetchWindow(PrefetchStartTimes, 4, 45.0, 1000.0, 1)
+    );
+}
+
+TEST_F(FieldlinesPrefetchTest, WindowStopsAtEndsOfSequence) {
+    using namespace openspace;
+
+    EXPECT_EQ(
+        std::vector<int>({ 8, 9 }),
+        fls::prefetchWindow(PrefetchStartTimes, 8, 85.0, 1000.0, 8)
+    );
+    EXPECT_EQ(
+        std::vector<int>({ 1, 0 }),
+        fls::prefetchWindow(PrefetchStartTimes, 1, 15.0, -1000.0, 8)
+    );
+    EXPECT_EQ(
+        std::vector<int>({ 0 }),
+        fls::prefetchWindow(PrefetchStartTimes, 0, 5.0, -1000.0, 8)
+    );
+}
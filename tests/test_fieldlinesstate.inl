@@ -0,0 +1,280 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/fieldlinessequence/util/fieldlinesstate.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    openspace::FieldlinesState createState(int nLines, int nPointsPerLine,
+                                           double triggerTime)
+    {
+        openspace::FieldlinesState state;
+        state.setModel(openspace::fls::Model::Batsrus);
+        state.setTriggerTime(triggerTime);
+        state.setExtraQuantityNames({ "temperature", "rho" });
+        for (int l = 0; l < nLines; ++l) {
+            std::vector<glm::vec3> line;
+            for (int p = 0; p < nPointsPerLine; ++p) {
+                line.emplace_back(l, p, l * p);
+                state.appendToExtra(0, static_cast<float>(l + p));
+                state.appendToExtra(1, static_cast<float>(l - p));
+            }
+            state.addLine(line);
+        }
+        return state;
+    }
+
+    // Writes the state in the unaligned version 0 layout that was used before the files
+    // could be memory mapped
+    void saveVersion0(const openspace::FieldlinesState& state, const std::string& path) {
+        std::ofstream ofs(path, std::ofstream::binary | std::ofstream::trunc);
+
+        std::string names;
+        for (const std::string& name : state.extraQuantityNames()) {
+            names += name + '\0';
+        }
+
+        const int32_t version = 0;
+        const double triggerTime = state.triggerTime();
+        const int32_t model = static_cast<int32_t>(state.model());
+        const bool isMorphable = false;
+        const uint64_t nLines = state.lineStart().size();
+        const uint64_t nPoints = state.vertexPositions().size();
+        const uint64_t nExtras = state.nExtraQuantities();
+        const uint64_t nStringBytes = names.size();
+
+        ofs.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+        ofs.write(reinterpret_cast<const char*>(&triggerTime), sizeof(double));
+        ofs.write(reinterpret_cast<const char*>(&model), sizeof(int32_t));
+        ofs.write(reinterpret_cast<const char*>(&isMorphable), sizeof(bool));
+        ofs.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nStringBytes), sizeof(uint64_t));
+        ofs.write(
+            reinterpret_cast<const char*>(state.lineStart().data()),
+            nLines * sizeof(GLint)
+        );
+        ofs.write(
+            reinterpret_cast<const char*>(state.lineCount().data()),
+            nLines * sizeof(GLsizei)
+        );
+        ofs.write(
+            reinterpret_cast<const char*>(state.vertexPositions().data()),
+            nPoints * sizeof(glm::vec3)
+        );
+        for (size_t i = 0; i < nExtras; ++i) {
+            bool isSuccessful;
+            const openspace::fls::ArrayView<float> q =
+                state.extraQuantity(i, isSuccessful);
+            ofs.write(reinterpret_cast<const char*>(q.data()), nPoints * sizeof(float));
+        }
+        ofs.write(names.data(), names.size());
+    }
+
+    void expectEqualStates(const openspace::FieldlinesState& a,
+                           const openspace::FieldlinesState& b)
+    {
+        EXPECT_EQ(a.triggerTime(), b.triggerTime());
+        EXPECT_EQ(a.model(), b.model());
+        EXPECT_EQ(a.extraQuantityNames(), b.extraQuantityNames());
+        ASSERT_EQ(a.lineStart().size(), b.lineStart().size());
+        ASSERT_EQ(a.vertexPositions().size(), b.vertexPositions().size());
+        ASSERT_EQ(a.nExtraQuantities(), b.nExtraQuantities());
+
+        for (size_t i = 0; i < a.lineStart().size(); ++i) {
+            EXPECT_EQ(a.lineStart()[i], b.lineStart()[i]);
+            EXPECT_EQ(a.lineCount()[i], b.lineCount()[i]);
+        }
+        for (size_t i = 0; i < a.vertexPositions().size(); ++i) {
+            EXPECT_EQ(a.vertexPositions()[i], b.vertexPositions()[i]);
+        }
+        for (size_t q = 0; q < a.nExtraQuantities(); ++q) {
+            bool isSuccessful;
+            const openspace::fls::ArrayView<float> qa = a.extraQuantity(q, isSuccessful);
+            const openspace::fls::ArrayView<float> qb = b.extraQuantity(q, isSuccessful);
+            ASSERT_EQ(qa.size(), qb.size());
+            for (size_t i = 0; i < qa.size(); ++i) {
+                EXPECT_EQ(qa[i], qb[i]);
+            }
+        }
+    }
+} // namespace
+
+class FieldlinesStateTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _version0Path = absPath("${TESTDIR}/fieldlinesstatetest_v0.osfls");
+        _version1Path = absPath("${TESTDIR}/fieldlinesstatetest_v1.osfls");
+    }
+
+    void TearDown() override {
+        std::remove(_version0Path.c_str());
+        std::remove(_version1Path.c_str());
+    }
+
+    std::string _version0Path;
+    std::string _version1Path;
+};
+
+TEST_F(FieldlinesStateTest, LoadVersion0) {
+    const openspace::FieldlinesState original = createState(10, 20, 1000.0);
+    saveVersion0(original, _version0Path);
+
+    openspace::FieldlinesState loaded;
+    ASSERT_TRUE(loaded.loadStateFromOsfls(_version0Path));
+    expectEqualStates(original, loaded);
+}
+
+TEST_F(FieldlinesStateTest, ConvertToVersion1) {
+    const openspace::FieldlinesState original = createState(10, 20, 1000.0);
+    saveVersion0(original, _version0Path);
+
+    ASSERT_TRUE(
+        openspace::FieldlinesState::convertOsflsFile(_version0Path, _version1Path)
+    );
+
+    openspace::FieldlinesState loaded;
+    ASSERT_TRUE(loaded.loadStateFromOsfls(_version1Path));
+    expectEqualStates(original, loaded);
+
+    // The arrays are used directly from the mapping, so they have to be aligned
+    const uintptr_t positions =
+        reinterpret_cast<uintptr_t>(loaded.vertexPositions().data());
+    EXPECT_EQ(positions % 64, 0);
+
+    // Copies share the mapping and stay valid after the original is gone
+    openspace::FieldlinesState copy = loaded;
+    loaded = openspace::FieldlinesState();
+    expectEqualStates(original, copy);
+
+    // Modifying a mapped state copies the data out of the file first
+    copy.scalePositions(2.f);
+    EXPECT_EQ(copy.vertexPositions()[21], 2.f * original.vertexPositions()[21]);
+}
+
+TEST_F(FieldlinesStateTest, InvalidFiles) {
+    openspace::FieldlinesState state;
+    EXPECT_FALSE(state.loadStateFromOsfls(_version0Path));
+
+    // A version 1 file whose arrays are cut off
+    const openspace::FieldlinesState original = createState(10, 20, 1000.0);
+    saveVersion0(original, _version0Path);
+    ASSERT_TRUE(
+        openspace::FieldlinesState::convertOsflsFile(_version0Path, _version1Path)
+    );
+    std::ifstream in(_version1Path, std::ifstream::binary);
+    std::string contents(
+        (std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>()
+    );
+    in.close();
+    std::ofstream(_version1Path, std::ofstream::binary | std::ofstream::trunc).write(
+        contents.data(),
+        contents.size() / 2
+    );
+    EXPECT_FALSE(state.loadStateFromOsfls(_version1Path));
+
+    // A version 0 file whose array sizes overflow when they are multiplied
+    {
+        const int32_t version = 0;
+        const double triggerTime = 0.0;
+        const int32_t model = 0;
+        const bool isMorphable = false;
+        const uint64_t nLines = uint64_t(1) << 61;
+        const uint64_t nPoints = 0;
+        const uint64_t nExtras = 0;
+        const uint64_t nStringBytes = 0;
+
+        std::ofstream ofs(_version0Path, std::ofstream::binary | std::ofstream::trunc);
+        ofs.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+        ofs.write(reinterpret_cast<const char*>(&triggerTime), sizeof(double));
+        ofs.write(reinterpret_cast<const char*>(&model), sizeof(int32_t));
+        ofs.write(reinterpret_cast<const char*>(&isMorphable), sizeof(bool));
+        ofs.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
+        ofs.write(reinterpret_cast<const char*>(&nStringBytes), sizeof(uint64_t));
+    }
+    EXPECT_FALSE(state.loadStateFromOsfls(_version0Path));
+}
+
+TEST_F(FieldlinesStateTest, DISABLED_Benchmark) {
+    constexpr const int NStates = 500;
+
+    std::vector<std::string> version0Paths;
+    std::vector<std::string> version1Paths;
+    for (int i = 0; i < NStates; ++i) {
+        const std::string base = absPath(
+            "${TESTDIR}/fieldlinesstatebenchmark_" + std::to_string(i)
+        );
+        version0Paths.push_back(base + "_v0.osfls");
+        version1Paths.push_back(base + "_v1.osfls");
+
+        const openspace::FieldlinesState state = createState(40, 100, i * 60.0);
+        saveVersion0(state, version0Paths.back());
+        ASSERT_TRUE(openspace::FieldlinesState::convertOsflsFile(
+            version0Paths.back(),
+            version1Paths.back()
+        ));
+    }
+
+    // Touch the first extra quantity, as a renderable would when coloring the lines
+    auto loadAll = [](const std::vector<std::string>& paths) {
+        volatile double sum = 0.0;
+        return benchmark::measure([&]() {
+            for (const std::string& path : paths) {
+                openspace::FieldlinesState state;
+                state.loadStateFromOsfls(path);
+                bool isSuccessful;
+                for (float v : state.extraQuantity(0, isSuccessful)) {
+                    sum = sum + v;
+                }
+            }
+        });
+    };
+
+    // Warm the file system cache for both versions before measuring
+    loadAll(version0Paths);
+    loadAll(version1Paths);
+    const std::chrono::microseconds version0 = loadAll(version0Paths);
+    const std::chrono::microseconds version1 = loadAll(version1Paths);
+
+    benchmark::report(
+        "Loading " + std::to_string(NStates) + " states",
+        "version 0 " + std::to_string(version0.count()) + " us, version 1 (mapped) " +
+            std::to_string(version1.count()) + " us"
+    );
+
+    for (int i = 0; i < NStates; ++i) {
+        std::remove(version0Paths[i].c_str());
+        std::remove(version1Paths[i].c_str());
+    }
+}
@@ -0,0 +1,219 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/geodeticindex.h>
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+    using openspace::globebrowsing::GeodeticIndex;
+    using openspace::globebrowsing::GeodeticPatch;
+    using openspace::globebrowsing::Geodetic2;
+    using openspace::globebrowsing::TileIndex;
+
+    struct Points {
+        std::vector<Geodetic2> locations;
+        std::vector<glm::vec3> positions;
+    };
+
+    Points randomPoints(size_t n) {
+        std::mt19937 gen(1337);
+        std::uniform_real_distribution<double> lat(-glm::half_pi<double>(),
+                                                   glm::half_pi<double>());
+        std::uniform_real_distribution<double> lon(-glm::pi<double>(),
+                                                   glm::pi<double>());
+
+        Points points;
+        for (size_t i = 0; i < n; ++i) {
+            const Geodetic2 g = { lat(gen), lon(gen) };
+            points.locations.push_back(g);
+            points.positions.emplace_back(
+                std::cos(g.lat) * std::cos(g.lon),
+                std::cos(g.lat) * std::sin(g.lon),
+                std::sin(g.lat)
+            );
+        }
+        return points;
+    }
+} // namespace
+
+class GeodeticIndexTest : public testing::Test {};
+
+TEST_F(GeodeticIndexTest, LeavesPartitionPoints) {
+    const Points points = randomPoints(5000);
+    std::vector<uint32_t> order;
+    GeodeticIndex index(points.locations, points.positions, order, 16);
+
+    ASSERT_EQ(order.size(), points.locations.size());
+    EXPECT_EQ(index.numPoints(), points.locations.size());
+
+    std::vector<int> count(points.locations.size(), 0);
+    for (const GeodeticIndex::Cell& cell : index.cells()) {
+        if (cell.firstChild != GeodeticIndex::NoChild) {
+            // The children cover exactly the points of their parent
+            const std::vector<GeodeticIndex::Cell>& cells = index.cells();
+            EXPECT_EQ(cells[cell.firstChild].begin, cell.begin);
+            EXPECT_EQ(cells[cell.firstChild + 3].end, cell.end);
+            continue;
+        }
+
+        EXPECT_LE(cell.end - cell.begin, 16u);
+        const GeodeticPatch patch(TileIndex(cell.x, cell.y, cell.level));
+        for (uint32_t i = cell.begin; i < cell.end; ++i) {
+            const uint32_t p = order[i];
+            count[p]++;
+
+            const Geodetic2& g = points.locations[p];
+            EXPECT_LE(std::abs(g.lat - patch.center().lat), patch.halfSize().lat + 1e-9);
+            EXPECT_LE(std::abs(g.lon - patch.center().lon), patch.halfSize().lon + 1e-9);
+
+            const float d = glm::length(points.positions[p] - cell.center);
+            EXPECT_LE(d, cell.radius + 1e-5f);
+        }
+    }
+
+    for (int c : count) {
+        EXPECT_EQ(c, 1);
+    }
+}
+
+TEST_F(GeodeticIndexTest, QueryVisibleReturnsRoots) {
+    const Points points = randomPoints(1000);
+    std::vector<uint32_t> order;
+    GeodeticIndex index(points.locations, points.positions, order);
+
+    std::vector<GeodeticIndex::Range> ranges;
+    index.query(
+        [](const GeodeticIndex::Cell&) { return GeodeticIndex::Visibility::Visible; },
+        ranges
+    );
+
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].begin, 0u);
+    EXPECT_EQ(ranges[0].end, ranges[1].begin);
+    EXPECT_EQ(ranges[1].end, 1000u);
+    EXPECT_TRUE(ranges[0].isVisible);
+    EXPECT_TRUE(ranges[1].isVisible);
+}
+
+TEST_F(GeodeticIndexTest, QueryCullsHemisphere) {
+    const Points points = randomPoints(2000);
+    std::vector<uint32_t> order;
+    GeodeticIndex index(points.locations, points.positions, order, 8);
+
+    // Only keep the points with positive x coordinates, cells are tested with their
+    // bounding spheres like the label culling does
+    auto classify = [](const GeodeticIndex::Cell& cell) {
+        if (cell.center.x + cell.radius < 0.f) {
+            return GeodeticIndex::Visibility::Hidden;
+        }
+        if (cell.center.x - cell.radius >= 0.f) {
+            return GeodeticIndex::Visibility::Visible;
+        }
+        return GeodeticIndex::Visibility::Partial;
+    };
+
+    std::vector<GeodeticIndex::Range> ranges;
+    index.query(classify, ranges);
+
+    size_t nFound = 0;
+    size_t nTested = 0;
+    for (const GeodeticIndex::Range& range : ranges) {
+        for (uint32_t i = range.begin; i < range.end; ++i) {
+            const glm::vec3& p = points.positions[order[i]];
+            if (range.isVisible) {
+                EXPECT_GE(p.x, 0.f);
+            }
+            else {
+                nTested++;
+            }
+            if (p.x >= 0.f) {
+                nFound++;
+            }
+        }
+    }
+
+    size_t nExpected = 0;
+    for (const glm::vec3& p : points.positions) {
+        if (p.x >= 0.f) {
+            nExpected++;
+        }
+    }
+
+    EXPECT_EQ(nFound, nExpected);
+    // Most of the points are accepted or rejected with their cell
+    EXPECT_LT(nTested, points.positions.size() / 2);
+}
+
+TEST_F(GeodeticIndexTest, RestoreFromCells) {
+    const Points points = randomPoints(500);
+    std::vector<uint32_t> order;
+    GeodeticIndex index(points.locations, points.positions, order);
+
+    GeodeticIndex restored(index.cells());
+    ASSERT_EQ(restored.cells().size(), index.cells().size());
+    EXPECT_EQ(restored.numPoints(), 500u);
+}
+
+TEST_F(GeodeticIndexTest, ValidateCells) {
+    const Points points = randomPoints(500);
+    std::vector<uint32_t> order;
+    GeodeticIndex index(points.locations, points.positions, order, 8);
+    EXPECT_TRUE(index.isValid());
+    EXPECT_TRUE(GeodeticIndex().isValid());
+
+    const std::vector<GeodeticIndex::Cell>& cells = index.cells();
+    ASSERT_NE(cells[0].firstChild, GeodeticIndex::NoChild);
+
+    // A range that reaches beyond the points
+    std::vector<GeodeticIndex::Cell> invalid = cells;
+    invalid.back().end = 1000;
+    EXPECT_FALSE(GeodeticIndex(invalid).isValid());
+
+    // A child index beyond the cells
+    invalid = cells;
+    invalid[0].firstChild = static_cast<uint32_t>(cells.size());
+    EXPECT_FALSE(GeodeticIndex(invalid).isValid());
+
+    // A cycle back to a root
+    invalid = cells;
+    invalid[cells[0].firstChild].firstChild = 0;
+    EXPECT_FALSE(GeodeticIndex(invalid).isValid());
+
+    // Children that don't split the range of their parent
+    invalid = cells;
+    invalid[cells[0].firstChild + 1].begin += 1;
+    EXPECT_FALSE(GeodeticIndex(invalid).isValid());
+
+    // A level beyond the finest supported level
+    invalid = cells;
+    invalid.back().level = GeodeticIndex::MaxLevel + 1;
+    EXPECT_FALSE(GeodeticIndex(invalid).isValid());
+}
@@ -0,0 +1,348 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/heighttilecache.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+namespace {
+    using openspace::globebrowsing::Geodetic2;
+    using openspace::globebrowsing::TileIndex;
+    using openspace::globebrowsing::cache::HeightSamplingLayer;
+    using openspace::globebrowsing::cache::HeightTile;
+    using openspace::globebrowsing::cache::HeightTileCache;
+    using openspace::globebrowsing::cache::HeightTileSource;
+    using ReadMissing = HeightTileCache::ReadMissingTiles;
+
+    // A 4x4 tile without padding whose samples increase by 1 to the east and by 10 to
+    // the north
+    HeightTile gradientTile() {
+        HeightTile tile;
+        tile.dimensions = glm::ivec2(4, 4);
+        tile.pixelStartOffset = glm::ivec2(0);
+        tile.pixelSizeDifference = glm::ivec2(0);
+        tile.depthTransform = { 1.f, 0.f };
+        tile.noDataValue = std::numeric_limits<float>::lowest();
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                tile.samples.push_back(static_cast<float>(x + 10 * y));
+            }
+        }
+        return tile;
+    }
+
+    // The height of the flat tiles of the FakeHeightSource, which encodes the tile index
+    float tileHeight(const TileIndex& tileIndex) {
+        return 100.f * tileIndex.level + 10.f * tileIndex.x + tileIndex.y;
+    }
+
+    class FakeHeightSource : public HeightTileSource {
+    public:
+        FakeHeightSource(uint64_t identifier, int maxLevel)
+            : _identifier(identifier)
+            , _maxLevel(maxLevel)
+        {}
+
+        uint64_t datasetIdentifier() const override {
+            return _identifier;
+        }
+
+        int maxChunkLevel() const override {
+            return _maxLevel;
+        }
+
+        std::shared_ptr<const HeightTile> readTile(
+                                                const TileIndex& tileIndex) const override
+        {
+            while (isBlocked) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            nReads++;
+
+            auto tile = std::make_shared<HeightTile>();
+            tile->dimensions = glm::ivec2(2, 2);
+            tile->pixelStartOffset = glm::ivec2(0);
+            tile->pixelSizeDifference = glm::ivec2(0);
+            tile->depthTransform = { 1.f, 0.f };
+            tile->noDataValue = std::numeric_limits<float>::lowest();
+            tile->samples.assign(4, tileHeight(tileIndex));
+            return tile;
+        }
+
+        mutable std::atomic_int nReads = 0;
+        std::atomic_bool isBlocked = false;
+
+    private:
+        const uint64_t _identifier;
+        const int _maxLevel;
+    };
+
+    bool waitForTile(HeightTileCache& cache, const HeightTileSource& source,
+                     const TileIndex& tileIndex)
+    {
+        for (int i = 0; i < 5000; ++i) {
+            if (cache.get(source, tileIndex)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    // Lies in the tiles (1, 0, 1), (4, 1, 3) and (8, 3, 4)
+    const Geodetic2 SamplePosition = { 0.1, 0.1 };
+} // namespace
+
+class HeightTileTest : public testing::Test {};
+
+TEST_F(HeightTileTest, SamplesCorners) {
+    const HeightTile tile = gradientTile();
+
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(0.f, 0.f)), 0.f);
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(1.f, 0.f)), 3.f);
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(0.f, 1.f)), 30.f);
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(1.f, 1.f)), 33.f);
+}
+
+TEST_F(HeightTileTest, InterpolatesBilinearly) {
+    const HeightTile tile = gradientTile();
+
+    // (0.375, 0.625) is between the texels 1 and 2 in x and 2 and 3 in y
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(0.375f, 0.625f)), 1.5f + 25.f);
+}
+
+TEST_F(HeightTileTest, AppliesDepthTransform) {
+    HeightTile tile = gradientTile();
+    tile.depthTransform = { 2.f, 100.f };
+
+    EXPECT_FLOAT_EQ(*tile.sample(glm::vec2(1.f, 1.f)), 100.f + 2.f * 33.f);
+}
+
+TEST_F(HeightTileTest, SkipsPadding) {
+    // The same gradient with a padding of one texel around it that contains -1
+    HeightTile tile = gradientTile();
+    tile.dimensions = glm::ivec2(6, 6);
+    tile.pixelStartOffset = glm::ivec2(-1);
+    tile.pixelSizeDifference = glm::ivec2(2);
+    std::vector<float> padded(36, -1.f);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            padded[(y + 1) * 6 + (x + 1)] = static_cast<float>(x + 10 * y);
+        }
+    }
+    tile.samples = padded;
+
+    // Converting the uv coordinates into the padded texture follows
+    // Layer::tileUvToTextureSamplePosition, which maps the tile into the inner texels
+    const std::optional<float> inner = tile.sample(glm::vec2(0.5f, 0.5f));
+    ASSERT_TRUE(inner.has_value());
+    EXPECT_GT(*inner, 0.f);
+    EXPECT_LT(*inner, 33.f);
+}
+
+TEST_F(HeightTileTest, MissingSamples) {
+    HeightTile tile = gradientTile();
+    tile.noDataValue = 2.f;
+
+    // The texel with the value 2 is used for all positions in its neighborhood
+    EXPECT_FALSE(tile.sample(glm::vec2(0.375f, 0.125f)).has_value());
+    EXPECT_TRUE(tile.sample(glm::vec2(0.875f, 0.875f)).has_value());
+
+    tile.noDataValue = std::numeric_limits<float>::lowest();
+    tile.samples[0] = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_FALSE(tile.sample(glm::vec2(0.f, 0.f)).has_value());
+
+    // Values below the cut-off are treated as missing, just like in the shaders
+    tile.samples[0] = -200000.f;
+    EXPECT_FALSE(tile.sample(glm::vec2(0.f, 0.f)).has_value());
+}
+
+class HeightTileCacheTest : public testing::Test {};
+
+TEST_F(HeightTileCacheTest, HitAndMiss) {
+    HeightTileCache cache(2);
+    FakeHeightSource source(1, 10);
+    const TileIndex a(1, 0, 1);
+    const TileIndex b(2, 1, 3);
+    const TileIndex c(0, 0, 2);
+
+    EXPECT_FALSE(cache.get(source, a));
+    EXPECT_EQ(source.nReads, 0);
+
+    const std::shared_ptr<const HeightTile> tile = cache.read(source, a);
+    ASSERT_TRUE(tile);
+    EXPECT_FLOAT_EQ(tile->samples[0], tileHeight(a));
+    EXPECT_EQ(source.nReads, 1);
+
+    EXPECT_EQ(cache.get(source, a), tile);
+    EXPECT_EQ(cache.read(source, a), tile);
+    EXPECT_EQ(source.nReads, 1);
+
+    // The same tile index of another dataset is a different tile
+    FakeHeightSource other(2, 10);
+    EXPECT_FALSE(cache.get(other, a));
+
+    // The least recently used tile is evicted
+    cache.read(source, b);
+    cache.read(source, c);
+    EXPECT_EQ(source.nReads, 3);
+    EXPECT_FALSE(cache.get(source, a));
+    EXPECT_TRUE(cache.get(source, b));
+    EXPECT_TRUE(cache.get(source, c));
+
+    cache.clear();
+    EXPECT_FALSE(cache.get(source, b));
+}
+
+TEST_F(HeightTileCacheTest, RequestsAreDeduplicated) {
+    HeightTileCache cache(8);
+    auto source = std::make_shared<FakeHeightSource>(1, 10);
+    const TileIndex index(3, 1, 3);
+
+    // Requests for a tile that is being read do not read it again
+    source->isBlocked = true;
+    cache.request(source, index);
+    cache.request(source, index);
+    cache.request(source, index);
+    source->isBlocked = false;
+    ASSERT_TRUE(waitForTile(cache, *source, index));
+    EXPECT_EQ(source->nReads, 1);
+
+    // Neither do requests for cached tiles. The requests are read in order, so once the
+    // second tile is cached, the first one would have been read again
+    const TileIndex next(4, 1, 3);
+    cache.request(source, index);
+    cache.request(source, next);
+    ASSERT_TRUE(waitForTile(cache, *source, next));
+    EXPECT_EQ(source->nReads, 2);
+}
+
+TEST_F(HeightTileCacheTest, SampleReadsMissingTiles) {
+    // This is how RenderableGlobe::heights samples the height layers
+    HeightTileCache cache(16);
+    auto source = std::make_shared<FakeHeightSource>(1, 3);
+    HeightSamplingLayer layer;
+    layer.sources.assign(11, source);
+    const std::vector<HeightSamplingLayer> layers = { layer };
+
+    // Levels beyond the dataset are read from its finest level
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 5, ReadMissing::Yes),
+        tileHeight(TileIndex(4, 1, 3))
+    );
+    EXPECT_EQ(source->nReads, 1);
+    EXPECT_TRUE(cache.get(*source, TileIndex(4, 1, 3)));
+
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 1, ReadMissing::Yes),
+        tileHeight(TileIndex(1, 0, 1))
+    );
+    EXPECT_EQ(source->nReads, 2);
+
+    // A dataset that is being reset does not provide heights
+    auto resetting = std::make_shared<FakeHeightSource>(2, -1);
+    layer.sources.assign(11, resetting);
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight({ layer }, SamplePosition, 3, ReadMissing::Yes),
+        0.f
+    );
+    EXPECT_EQ(resetting->nReads, 0);
+}
+
+TEST_F(HeightTileCacheTest, SampleAppliesLayerSettings) {
+    HeightTileCache cache(16);
+    auto source = std::make_shared<FakeHeightSource>(1, 10);
+    const float height = tileHeight(TileIndex(4, 1, 3));
+
+    HeightSamplingLayer base;
+    base.sources.assign(11, source);
+    HeightSamplingLayer scaled = base;
+    scaled.multiplier = 2.f;
+    scaled.offset = 5.f;
+    scaled.opacity = 0.5f;
+    // Layers without a dataset, for example while they are loading, are skipped
+    HeightSamplingLayer empty;
+    empty.sources.resize(11);
+
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(
+            { scaled, empty },
+            SamplePosition,
+            3,
+            ReadMissing::Yes
+        ),
+        (height * 2.f + 5.f) * 0.5f
+    );
+    // The last layer determines the height
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(
+            { scaled, base },
+            SamplePosition,
+            3,
+            ReadMissing::Yes
+        ),
+        height
+    );
+}
+
+TEST_F(HeightTileCacheTest, SampleFallsBackToCoarserTiles) {
+    // This is how RenderableGlobe::getHeight samples the height layers every frame
+    HeightTileCache cache(16);
+    auto source = std::make_shared<FakeHeightSource>(1, 10);
+    HeightSamplingLayer layer;
+    layer.sources.assign(11, source);
+    const std::vector<HeightSamplingLayer> layers = { layer };
+
+    // Nothing is cached yet, so the tile is only requested
+    source->isBlocked = true;
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 3, ReadMissing::No),
+        0.f
+    );
+    source->isBlocked = false;
+    ASSERT_TRUE(waitForTile(cache, *source, TileIndex(4, 1, 3)));
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 3, ReadMissing::No),
+        tileHeight(TileIndex(4, 1, 3))
+    );
+
+    // The finer tile is used as soon as it has been read in the background
+    source->isBlocked = true;
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 4, ReadMissing::No),
+        tileHeight(TileIndex(4, 1, 3))
+    );
+    source->isBlocked = false;
+    ASSERT_TRUE(waitForTile(cache, *source, TileIndex(8, 3, 4)));
+    EXPECT_FLOAT_EQ(
+        cache.sampleHeight(layers, SamplePosition, 4, ReadMissing::No),
+        tileHeight(TileIndex(8, 3, 4))
+    );
+    EXPECT_EQ(source->nReads, 2);
+}
@@ -0,0 +1,320 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/interaction/indexedrecording.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/exception.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+
+namespace {
+    constexpr const char AsciiHeader[] = "OpenSpace_record/playback00.85A\n";
+    constexpr const char BinaryHeader[] = "OpenSpace_record/playback00.85B\n";
+
+    template <typename T>
+    void writeBinary(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Writes a recording in the binary format in the same way as SessionRecording does,
+    // with one script after every scriptInterval camera keyframes
+    void writeBinaryRecording(const std::string& path, size_t nCameras,
+                              size_t scriptInterval)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << BinaryHeader;
+        for (size_t i = 0; i < nCameras; ++i) {
+            const double timeRec = static_cast<double>(i) / 60.0;
+
+            openspace::datamessagestructures::CameraKeyframe kf;
+            kf._position = glm::dvec3(1e7 + i, 2e7 - i, 0.5 * i);
+            kf._rotation = glm::dquat(1.0, 0.0, 0.0, 0.0);
+            kf._followNodeRotation = (i % 2 == 0);
+            kf._focusNode = (i % 3 == 0) ? "Earth" : "Moon";
+            kf._scale = 1.f;
+            kf._timestamp = 100.0 + timeRec;
+            std::vector<char> buffer;
+            kf.serialize(buffer);
+
+            file << 'c';
+            writeBinary(file, kf._timestamp);
+            writeBinary(file, timeRec);
+            writeBinary(file, 5e8 + timeRec);
+            file.write(buffer.data(), buffer.size());
+
+            if ((i + 1) % scriptInterval == 0) {
+                const std::string script = "openspace.printInfo('" +
+                    std::to_string(i) + "')";
+                file << 's';
+                writeBinary(file, 100.0 + timeRec);
+                writeBinary(file, timeRec);
+                writeBinary(file, 5e8 + timeRec);
+                writeBinary(file, script.size());
+                file.write(script.data(), script.size());
+            }
+        }
+    }
+
+    size_t linearSeek(const openspace::interaction::IndexedRecording& recording,
+                      double timestamp, openspace::interaction::KeyframeTimeRef timeRef)
+    {
+        using openspace::interaction::IndexedRecording;
+        for (size_t i = 0; i < recording.nEntries(); ++i) {
+            if (IndexedRecording::timestamp(recording.entry(i), timeRef) >= timestamp) {
+                return i;
+            }
+        }
+        return recording.nEntries();
+    }
+} // namespace
+
+class IndexedRecordingTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _legacyPath = absPath("${TESTDIR}/indexedrecordingtest.osrec");
+        _indexedPath = absPath("${TESTDIR}/indexedrecordingtest_indexed.osrec");
+    }
+
+    void TearDown() override {
+        std::remove(_legacyPath.c_str());
+        std::remove(_indexedPath.c_str());
+    }
+
+    std::string _legacyPath;
+    std::string _indexedPath;
+};
+
+TEST_F(IndexedRecordingTest, ConvertAscii) {
+    using namespace openspace::interaction;
+
+    {
+        std::ofstream file(_legacyPath);
+        file << AsciiHeader;
+        file << "camera 10.5 0.5 1000.000 1.0000000 2.0000000 3.0000000 0.0000000 "
+                "0.0000000 0.7071068 0.7071068 1.000000e+00 F Earth\n";
+        file << "script 11 1 1000.500 2 openspace.time.setPause(true)\n";
+        file << "openspace.printInfo('paused')\n";
+        file << "time 11.5 1.5 1001.000 2.0 P -\n";
+        file << "camera 12 2 1002.000 4.0000000 5.0000000 6.0000000 0.0000000 "
+                "0.0000000 0.0000000 1.0000000 2.000000e+00 - Moon\n";
+    }
+
+    convertToIndexedRecording(_legacyPath, _indexedPath);
+    const IndexedRecording recording(_indexedPath);
+    EXPECT_TRUE(recording.isMapped());
+    ASSERT_EQ(recording.nEntries(), 4);
+    ASSERT_EQ(recording.nCameraKeyframes(), 2);
+    ASSERT_EQ(recording.nTimeKeyframes(), 1);
+    ASSERT_EQ(recording.nScripts(), 1);
+
+    EXPECT_EQ(recording.entry(0).type, IndexedRecording::EntryType::Camera);
+    EXPECT_EQ(recording.entry(1).type, IndexedRecording::EntryType::Script);
+    EXPECT_EQ(recording.entry(2).type, IndexedRecording::EntryType::Time);
+    EXPECT_EQ(recording.entry(3).type, IndexedRecording::EntryType::Camera);
+    EXPECT_EQ(recording.entry(3).index, 1);
+    EXPECT_EQ(recording.entry(1).timeOs, 11.0);
+    EXPECT_EQ(recording.entry(1).timeRec, 1.0);
+    EXPECT_EQ(recording.entry(1).timeSim, 1000.5);
+
+    const KeyframeNavigator::CameraPose first = recording.cameraPose(0);
+    EXPECT_EQ(first.position, glm::dvec3(1.0, 2.0, 3.0));
+    EXPECT_NEAR(first.rotation.z, 0.7071068f, 1e-6f);
+    EXPECT_NEAR(first.rotation.w, 0.7071068f, 1e-6f);
+    EXPECT_EQ(first.scale, 1.f);
+    EXPECT_TRUE(first.followFocusNodeRotation);
+    EXPECT_EQ(first.focusNode, "Earth");
+
+    const KeyframeNavigator::CameraPose second = recording.cameraPose(1);
+    EXPECT_EQ(second.scale, 2.f);
+    EXPECT_FALSE(second.followFocusNodeRotation);
+    EXPECT_EQ(second.focusNode, "Moon");
+
+    EXPECT_EQ(
+        recording.script(0),
+        " openspace.time.setPause(true)\nopenspace.printInfo('paused')"
+    );
+    EXPECT_EQ(recording.timeKeyframe(0)._dt, 2.0);
+    EXPECT_TRUE(recording.timeKeyframe(0)._paused);
+    EXPECT_FALSE(recording.timeKeyframe(0)._requiresTimeJump);
+
+    // Opening the ASCII file directly results in the same keyframes
+    const IndexedRecording parsed(_legacyPath);
+    EXPECT_FALSE(parsed.isMapped());
+    ASSERT_EQ(parsed.nEntries(), 4);
+    EXPECT_EQ(parsed.script(0), recording.script(0));
+    EXPECT_EQ(parsed.cameraPose(1).focusNode, "Moon");
+}
+
+TEST_F(IndexedRecordingTest, ConvertBinary) {
+    using namespace openspace::interaction;
+
+    writeBinaryRecording(_legacyPath, 1000, 100);
+    convertToIndexedRecording(_legacyPath, _indexedPath);
+
+    const IndexedRecording parsed(_legacyPath);
+    const IndexedRecording recording(_indexedPath);
+    ASSERT_EQ(recording.nEntries(), 1010);
+    ASSERT_EQ(recording.nCameraKeyframes(), 1000);
+    ASSERT_EQ(recording.nScripts(), 10);
+    ASSERT_EQ(parsed.nEntries(), recording.nEntries());
+
+    for (size_t i = 0; i < recording.nEntries(); ++i) {
+        const IndexedRecording::Entry& e = recording.entry(i);
+        EXPECT_EQ(e.type, parsed.entry(i).type);
+        EXPECT_EQ(e.index, parsed.entry(i).index);
+        EXPECT_EQ(e.timeOs, parsed.entry(i).timeOs);
+        EXPECT_EQ(e.timeRec, parsed.entry(i).timeRec);
+        EXPECT_EQ(e.timeSim, parsed.entry(i).timeSim);
+    }
+
+    const KeyframeNavigator::CameraPose pose = recording.cameraPose(123);
+    EXPECT_EQ(pose.position, glm::dvec3(1e7 + 123, 2e7 - 123, 0.5 * 123));
+    EXPECT_EQ(pose.focusNode, "Earth");
+    EXPECT_FALSE(pose.followFocusNodeRotation);
+    EXPECT_EQ(recording.script(9), "openspace.printInfo('999')");
+}
+
+TEST_F(IndexedRecordingTest, SeekMatchesLinearSearch) {
+    using namespace openspace::interaction;
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<double> gap(0.0, 0.1);
+
+    IndexedRecording::Builder builder;
+    double time = 0.0;
+    for (int i = 0; i < 10000; ++i) {
+        // Keyframes with the same timestamp are allowed
+        time += (i % 10 == 0) ? 0.0 : gap(random);
+        if (i % 50 == 0) {
+            builder.addScript(100.0 + time, time, 5e8 + 2.0 * time, "script");
+        }
+        else {
+            KeyframeNavigator::CameraPose pose;
+            pose.focusNode = "Earth";
+            pose.scale = 1.f;
+            pose.followFocusNodeRotation = false;
+            builder.addCamera(100.0 + time, time, 5e8 + 2.0 * time, pose);
+        }
+    }
+    const IndexedRecording recording(builder);
+
+    std::uniform_real_distribution<double> target(-1.0, time + 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        const double t = target(random);
+        EXPECT_EQ(
+            recording.seek(t, KeyframeTimeRef::Relative_recordedStart),
+            linearSeek(recording, t, KeyframeTimeRef::Relative_recordedStart)
+        );
+        EXPECT_EQ(
+            recording.seek(100.0 + t, KeyframeTimeRef::Relative_applicationStart),
+            linearSeek(recording, 100.0 + t, KeyframeTimeRef::Relative_applicationStart)
+        );
+        EXPECT_EQ(
+            recording.seek(5e8 + 2.0 * t, KeyframeTimeRef::Absolute_simTimeJ2000),
+            linearSeek(recording, 5e8 + 2.0 * t, KeyframeTimeRef::Absolute_simTimeJ2000)
+        );
+    }
+    EXPECT_EQ(recording.seek(-1.0, KeyframeTimeRef::Relative_recordedStart), 0);
+    EXPECT_EQ(
+        recording.seek(time + 1.0, KeyframeTimeRef::Relative_recordedStart),
+        recording.nEntries()
+    );
+}
+
+TEST_F(IndexedRecordingTest, RejectsInvalidFiles) {
+    using namespace openspace::interaction;
+
+    {
+        std::ofstream file(_legacyPath);
+        file << "Not a recording at all\n";
+    }
+    EXPECT_THROW(IndexedRecording{ _legacyPath }, ghoul::RuntimeError);
+
+    writeBinaryRecording(_legacyPath, 100, 10);
+    convertToIndexedRecording(_legacyPath, _indexedPath);
+    EXPECT_THROW(
+        convertToIndexedRecording(_indexedPath, _legacyPath),
+        ghoul::RuntimeError
+    );
+
+    // Removing the trailer makes the file unusable
+    std::vector<char> content;
+    {
+        std::ifstream file(_indexedPath, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    {
+        std::ofstream file(_indexedPath, std::ios::binary);
+        file.write(content.data(), content.size() - 8);
+    }
+    EXPECT_THROW(IndexedRecording{ _indexedPath }, ghoul::RuntimeError);
+}
+
+TEST_F(IndexedRecordingTest, DISABLED_Benchmark) {
+    using namespace openspace::interaction;
+
+    // One hour of recording at 60 frames per second with a script every second
+    writeBinaryRecording(_legacyPath, 60 * 60 * 60, 60);
+
+    const std::chrono::microseconds parse = benchmark::measure([&]() {
+        IndexedRecording parsed(_legacyPath);
+    });
+    const std::chrono::microseconds convert = benchmark::measure([&]() {
+        convertToIndexedRecording(_legacyPath, _indexedPath);
+    });
+    std::unique_ptr<const IndexedRecording> recording;
+    const std::chrono::microseconds open = benchmark::measure([&]() {
+        recording = std::make_unique<const IndexedRecording>(_indexedPath);
+    });
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<double> target(0.0, 3600.0);
+    constexpr const int nSeeks = 100000;
+    const std::chrono::microseconds seek = benchmark::measure([&]() {
+        volatile size_t checksum = 0;
+        for (int i = 0; i < nSeeks; ++i) {
+            checksum = checksum + recording->seek(
+                target(random),
+                KeyframeTimeRef::Relative_recordedStart
+            );
+        }
+    });
+
+    benchmark::report(
+        "Binary recording",
+        "parse " + std::to_string(parse.count()) + " us, convert " +
+            std::to_string(convert.count()) + " us"
+    );
+    benchmark::report(
+        "Indexed recording",
+        "open " + std::to_string(open.count()) + " us, seek " +
+            std::to_string(seek.count() * 1000 / nSeeks) + " ns"
+    );
+}
@@ -0,0 +1,238 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/network/keyframecodec.h>
+#include <openspace/network/messagestructures.h>
+#include <ghoul/glm.h>
+#include <cmath>
+#include <random>
+
+class KeyframeCodecTest : public testing::Test {};
+
+namespace {
+    // Angle of the rotation between two unit quaternions
+    double angleBetween(const glm::dquat& a, const glm::dquat& b) {
+        const double d = std::abs(glm::dot(a, b));
+        return 2.0 * std::acos(std::min(d, 1.0));
+    }
+
+    openspace::datamessagestructures::CameraKeyframe cameraKeyframe(
+                                                                     std::mt19937& random,
+                                                               const glm::dvec3& position,
+                                                             const std::string& focusNode,
+                                                                         double timestamp)
+    {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        openspace::datamessagestructures::CameraKeyframe kf;
+        kf._position = position;
+        kf._rotation = glm::normalize(
+            glm::dquat(dist(random), dist(random), dist(random), dist(random))
+        );
+        kf._followNodeRotation = dist(random) > 0.0;
+        kf._focusNode = focusNode;
+        kf._scale = 1.f;
+        kf._timestamp = timestamp;
+        return kf;
+    }
+
+    openspace::datamessagestructures::TimeKeyframe timeKeyframe(double time,
+                                                                double timestamp)
+    {
+        openspace::datamessagestructures::TimeKeyframe kf;
+        kf._time = time;
+        kf._dt = 3600.0;
+        kf._paused = false;
+        kf._requiresTimeJump = false;
+        kf._timestamp = timestamp;
+        return kf;
+    }
+} // namespace
+
+TEST_F(KeyframeCodecTest, RoundTripPrecision) {
+    using namespace openspace::datamessagestructures;
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<double> step(-1000.0, 1000.0);
+
+    KeyframeEncoder encoder;
+    KeyframeDecoder decoder;
+
+    glm::dvec3 position(7e6, 1e5, -3e6);
+    double maxAngle = 0.0;
+    double maxRelativePositionError = 0.0;
+    for (int i = 0; i < 1000; ++i) {
+        position += glm::dvec3(step(random), step(random), step(random));
+
+        KeyframeBatch batch;
+        batch.cameraKeyframes.push_back(cameraKeyframe(
+            random,
+            position,
+            i < 500 ? "Earth" : "Moon",
+            1000.0 + 0.1 * i
+        ));
+        batch.hasTimeline = true;
+        batch.timeline._keyframes.push_back(timeKeyframe(6e8 + i, 1000.0 + 0.1 * i));
+        batch.timeline._keyframes.back()._requiresTimeJump = (i == 10);
+
+        std::vector<char> buffer;
+        encoder.encode(batch, buffer);
+
+        KeyframeBatch decoded;
+        ASSERT_TRUE(decoder.decode(buffer, decoded));
+        ASSERT_EQ(decoded.cameraKeyframes.size(), 1);
+
+        const CameraKeyframe& in = batch.cameraKeyframes[0];
+        const CameraKeyframe& out = decoded.cameraKeyframes[0];
+        EXPECT_EQ(out._focusNode, in._focusNode);
+        EXPECT_EQ(out._followNodeRotation, in._followNodeRotation);
+        EXPECT_EQ(out._scale, in._scale);
+        EXPECT_NEAR(out._timestamp, in._timestamp, 1e-4);
+
+        maxAngle = std::max(maxAngle, angleBetween(out._rotation, in._rotation));
+        maxRelativePositionError = std::max(
+            maxRelativePositionError,
+            glm::length(out._position - in._position) / glm::length(in._position)
+        );
+
+        ASSERT_TRUE(decoded.hasTimeline);
+        ASSERT_EQ(decoded.timeline._keyframes.size(), 1);
+        const TimeKeyframe& tIn = batch.timeline._keyframes[0];
+        const TimeKeyframe& tOut = decoded.timeline._keyframes[0];
+        EXPECT_EQ(tOut._time, tIn._time);
+        EXPECT_EQ(tOut._dt, tIn._dt);
+        EXPECT_EQ(tOut._paused, tIn._paused);
+        EXPECT_EQ(tOut._requiresTimeJump, tIn._requiresTimeJump);
+        EXPECT_NEAR(tOut._timestamp, tIn._timestamp, 1e-4);
+    }
+
+    // 16 bits per smallest-three component is well below a thousandth of a degree
+    EXPECT_LT(maxAngle, 1e-4);
+    // Positions do not drift even though most of them are sent as deltas
+    EXPECT_LT(maxRelativePositionError, 1e-9);
+}
+
+TEST_F(KeyframeCodecTest, LateJoinerWaitsForReset) {
+    using namespace openspace::datamessagestructures;
+
+    std::mt19937 random(42);
+    KeyframeEncoder encoder;
+    KeyframeDecoder decoder;
+
+    auto encode = [&](int i) {
+        KeyframeBatch batch;
+        batch.cameraKeyframes.push_back(
+            cameraKeyframe(random, glm::dvec3(1e7 + i), "Earth", 0.1 * i)
+        );
+        std::vector<char> buffer;
+        encoder.encode(batch, buffer);
+        return buffer;
+    };
+
+    // The decoder misses the first batches
+    for (int i = 0; i < 5; ++i) {
+        encode(i);
+    }
+
+    KeyframeBatch decoded;
+    EXPECT_FALSE(decoder.decode(encode(5), decoded));
+
+    // Until the host is asked to reset, the decoder can't follow
+    encoder.requestReset();
+    ASSERT_TRUE(decoder.decode(encode(6), decoded));
+    EXPECT_EQ(decoded.cameraKeyframes[0]._focusNode, "Earth");
+    ASSERT_TRUE(decoder.decode(encode(7), decoded));
+    EXPECT_EQ(decoded.cameraKeyframes[0]._position, glm::dvec3(1e7 + 7));
+
+    // A lost batch makes the decoder wait for the next reset
+    encode(8);
+    EXPECT_FALSE(decoder.decode(encode(9), decoded));
+}
+
+TEST_F(KeyframeCodecTest, MalformedBatchIsRejected) {
+    using namespace openspace::datamessagestructures;
+
+    std::mt19937 random(7);
+    KeyframeEncoder encoder;
+    KeyframeBatch batch;
+    batch.cameraKeyframes.push_back(cameraKeyframe(random, glm::dvec3(1.0), "Sun", 0.0));
+
+    std::vector<char> buffer;
+    encoder.encode(batch, buffer);
+    buffer.resize(buffer.size() - 1);
+
+    KeyframeDecoder decoder;
+    KeyframeBatch decoded;
+    EXPECT_FALSE(decoder.decode(buffer, decoded));
+}
+
+TEST_F(KeyframeCodecTest, BytesPerSecond) {
+    using namespace openspace::datamessagestructures;
+
+    // The host sends a camera keyframe and the time timeline ten times per second
+    constexpr const int KeyframesPerSecond = 10;
+    constexpr const int Seconds = 60;
+    // Data message (type and timestamp) and parallel connection (magic, protocol
+    // version, type, and size) headers
+    constexpr const size_t MessageOverhead = sizeof(uint32_t) + sizeof(double) +
+                                             2 * sizeof(char) + 3 * sizeof(uint32_t);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> step(-100.0, 100.0);
+    KeyframeEncoder encoder;
+
+    glm::dvec3 position(2e7, 0.0, 0.0);
+    size_t legacyBytes = 0;
+    size_t compactBytes = 0;
+    for (int i = 0; i < KeyframesPerSecond * Seconds; ++i) {
+        position += glm::dvec3(step(random), step(random), step(random));
+        const double timestamp = static_cast<double>(i) / KeyframesPerSecond;
+
+        KeyframeBatch batch;
+        batch.cameraKeyframes.push_back(
+            cameraKeyframe(random, position, "EarthBarycenter", timestamp)
+        );
+        batch.hasTimeline = true;
+        batch.timeline._keyframes.push_back(timeKeyframe(6e8 + timestamp, timestamp));
+
+        // The legacy encoding sends camera and time in separate messages
+        std::vector<char> camera;
+        batch.cameraKeyframes[0].serialize(camera);
+        std::vector<char> timeline;
+        batch.timeline.serialize(timeline);
+        legacyBytes += camera.size() + timeline.size() + 2 * MessageOverhead;
+
+        std::vector<char> compact;
+        encoder.encode(batch, compact);
+        compactBytes += compact.size() + MessageOverhead;
+    }
+
+    benchmark::report(
+        "Keyframe traffic",
+        "legacy " + std::to_string(legacyBytes / Seconds) + " bytes/s, compact " +
+            std::to_string(compactBytes / Seconds) + " bytes/s"
+    );
+    EXPECT_LT(compactBytes, legacyBytes);
+}
@@ -27,6 +27,36 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <random>
+#include <unordered_map>
+
+namespace {
+    // Number of calls to the global operator new, used to measure the allocations of the
+    // LRU cache implementations in the benchmark below
+    std::atomic<size_t> NumberOfAllocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+    ++NumberOfAllocations;
+    void* ptr = std::malloc(size > 0 ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
 
 class LRUCacheTest : public testing::Test {};
 
@@ -95,3 +125,274 @@ TEST_F(LRUCacheTest, StructKey) {
     ASSERT_EQ(lru.get(key1), val2);
     ASSERT_EQ(lru.get(key2), val2);
 }
+
+TEST_F(LRUCacheTest, EvictionCallback) {
+    std::vector<std::pair<int, double>> evicted;
+    openspace::globebrowsing::cache::LRUCache<int, double, DefaultHasher> lru(
+        2,
+        [&evicted](int key, double value) { evicted.emplace_back(key, value); }
+    );
+    lru.put(1, 1.0);
+    lru.put(2, 2.0);
+    ASSERT_TRUE(evicted.empty());
+
+    // Touching 1 makes 2 the least recently used item
+    ASSERT_TRUE(lru.touch(1));
+    lru.put(3, 3.0);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].first, 2);
+    EXPECT_EQ(evicted[0].second, 2.0);
+    EXPECT_TRUE(lru.exist(1));
+    EXPECT_TRUE(lru.exist(3));
+    EXPECT_EQ(lru.size(), 2);
+}
+
+TEST_F(LRUCacheTest, PopOrder) {
+    openspace::globebrowsing::cache::LRUCache<int, int, DefaultHasher> lru(10);
+    for (int i = 0; i < 5; ++i) {
+        lru.put(i, i * 10);
+    }
+    lru.touch(0);
+
+    EXPECT_EQ(lru.popMRU().first, 0);
+    EXPECT_EQ(lru.popLRU().first, 1);
+    EXPECT_EQ(lru.popMRU().first, 4);
+    EXPECT_EQ(lru.popLRU().first, 2);
+    EXPECT_EQ(lru.popLRU().second, 30);
+    EXPECT_TRUE(lru.isEmpty());
+
+    // The cache has to be usable after being emptied
+    lru.put(7, 70);
+    EXPECT_EQ(lru.get(7), 70);
+    lru.clear();
+    EXPECT_FALSE(lru.exist(7));
+    lru.put(8, 80);
+    EXPECT_EQ(lru.get(8), 80);
+}
+
+TEST_F(LRUCacheTest, MatchesReference) {
+    // Compare against a straightforward std::list implementation on random operations
+    constexpr const size_t CacheSize = 64;
+    openspace::globebrowsing::cache::LRUCache<int, int, DefaultHasher> lru(CacheSize);
+    std::list<std::pair<int, int>> reference;
+
+    auto find = [&reference](int key) {
+        return std::find_if(
+            reference.begin(),
+            reference.end(),
+            [key](const std::pair<int, int>& p) { return p.first == key; }
+        );
+    };
+
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<int> keyDist(0, 200);
+    std::uniform_int_distribution<int> opDist(0, 9);
+    for (int i = 0; i < 100000; ++i) {
+        const int key = keyDist(random);
+        const int op = opDist(random);
+        if (op < 5) {
+            lru.put(key, i);
+            auto it = find(key);
+            if (it != reference.end()) {
+                reference.erase(it);
+            }
+            reference.emplace_front(key, i);
+            if (reference.size() > CacheSize) {
+                reference.pop_back();
+            }
+        }
+        else if (op < 9) {
+            auto it = find(key);
+            ASSERT_EQ(lru.touch(key), it != reference.end());
+            if (it != reference.end()) {
+                reference.splice(reference.begin(), reference, it);
+            }
+        }
+        else if (!reference.empty()) {
+            ASSERT_EQ(lru.popLRU(), reference.back());
+            reference.pop_back();
+        }
+        ASSERT_EQ(lru.size(), reference.size());
+    }
+
+    while (!reference.empty()) {
+        ASSERT_EQ(lru.popMRU(), reference.front());
+        reference.pop_front();
+    }
+}
+
+namespace {
+    // The previous LRU cache implementation based on std::list and an unordered_map of
+    // iterators, which is used as a baseline for the benchmark
+    template <typename KeyType, typename ValueType, typename HasherType>
+    class ListLRUCache {
+    public:
+        using Item = std::pair<KeyType, ValueType>;
+
+        ListLRUCache(size_t size) : _maximumCacheSize(size) {}
+
+        bool exist(const KeyType& key) const {
+            return _itemMap.count(key) > 0;
+        }
+
+        ValueType get(const KeyType& key) {
+            const auto it = _itemMap.find(key);
+            _itemList.splice(_itemList.begin(), _itemList, it->second);
+            return it->second->second;
+        }
+
+        std::vector<Item> putAndFetchPopped(KeyType key, ValueType value) {
+            const auto it = _itemMap.find(key);
+            if (it != _itemMap.end()) {
+                _itemList.erase(it->second);
+                _itemMap.erase(it);
+            }
+            _itemList.emplace_front(key, std::move(value));
+            _itemMap.emplace(std::move(key), _itemList.begin());
+
+            std::vector<Item> toReturn;
+            while (_itemMap.size() > _maximumCacheSize) {
+                _itemMap.erase(_itemList.back().first);
+                toReturn.push_back(_itemList.back());
+                _itemList.pop_back();
+            }
+            return toReturn;
+        }
+
+        Item popLRU() {
+            _itemMap.erase(_itemList.back().first);
+            Item item = _itemList.back();
+            _itemList.pop_back();
+            return item;
+        }
+
+        size_t size() const {
+            return _itemMap.size();
+        }
+
+    private:
+        std::list<Item> _itemList;
+        std::unordered_map<KeyType, typename std::list<Item>::const_iterator, HasherType>
+            _itemMap;
+        size_t _maximumCacheSize;
+    };
+
+    struct BenchmarkTile {
+        void* texture;
+        float minValue;
+        float maxValue;
+        int status;
+    };
+
+    struct BenchmarkResult {
+        double allocationsPerFrame;
+        double microsecondsPerFrame;
+    };
+
+    // Mimics the access pattern of the MemoryAwareTileCache: A fixed number of textures
+    // is recycled from the least recently used tile and every frame looks up all visible
+    // tiles, while the visible set slowly moves. In addition, a small job queue is fed
+    // with requests for the missing tiles, like the LRUThreadPool
+    template <typename TileCache, typename QueueCache, typename Put>
+    BenchmarkResult runFrames(TileCache& tiles, QueueCache& queue, Put put) {
+        constexpr const int NumberOfFrames = 1000;
+        constexpr const int VisibleTiles = 400;
+        constexpr const size_t NumberOfTextures = 500;
+        std::vector<int> unqueued;
+        unqueued.reserve(1024);
+
+        // Warm up so that the caches have reached their working size
+        for (int i = 0; i < 2 * VisibleTiles; ++i) {
+            put(tiles, queue, i, NumberOfTextures, unqueued);
+        }
+        unqueued.clear();
+
+        const size_t allocationsBefore = NumberOfAllocations;
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            for (int frame = 0; frame < NumberOfFrames; ++frame) {
+                const int first = 2 * frame;
+                for (int i = first; i < first + VisibleTiles; ++i) {
+                    if (tiles.exist(i)) {
+                        volatile BenchmarkTile t = tiles.get(i);
+                        (void)t;
+                    }
+                    else {
+                        put(tiles, queue, i, NumberOfTextures, unqueued);
+                    }
+                }
+                unqueued.clear();
+            }
+        });
+        const size_t allocations = NumberOfAllocations - allocationsBefore;
+
+        return {
+            static_cast<double>(allocations) / NumberOfFrames,
+            static_cast<double>(time.count()) / NumberOfFrames
+        };
+    }
+
+    BenchmarkResult runListLRUCache() {
+        using namespace openspace::globebrowsing::cache;
+
+        ListLRUCache<int, BenchmarkTile, DefaultHasher> tiles(
+            std::numeric_limits<size_t>::max()
+        );
+        ListLRUCache<int, int, DefaultHasher> queue(10);
+        return runFrames(
+            tiles,
+            queue,
+            [](auto& t, auto& q, int key, size_t nTextures, std::vector<int>& unqueued) {
+                for (const std::pair<int, int>& p : q.putAndFetchPopped(key, key)) {
+                    unqueued.push_back(p.first);
+                }
+                if (t.size() >= nTextures) {
+                    t.popLRU();
+                }
+                t.putAndFetchPopped(key, BenchmarkTile{ nullptr, 0.f, 1.f, 0 });
+            }
+        );
+    }
+
+    BenchmarkResult runIntrusiveLRUCache() {
+        using namespace openspace::globebrowsing::cache;
+
+        std::vector<int>* unqueuedTarget = nullptr;
+        LRUCache<int, BenchmarkTile, DefaultHasher> tiles(
+            std::numeric_limits<size_t>::max()
+        );
+        tiles.reserve(500);
+        LRUCache<int, int, DefaultHasher> queue(
+            10,
+            [&unqueuedTarget](int key, int) { unqueuedTarget->push_back(key); }
+        );
+        queue.reserve(11);
+        return runFrames(
+            tiles,
+            queue,
+            [&unqueuedTarget](auto& t, auto& q, int key, size_t nTextures,
+                              std::vector<int>& unqueued)
+            {
+                unqueuedTarget = &unqueued;
+                q.put(key, key);
+                if (t.size() >= nTextures) {
+                    t.popLRU();
+                }
+                t.put(key, BenchmarkTile{ nullptr, 0.f, 1.f, 0 });
+            }
+        );
+    }
+} // namespace
+
+TEST_F(LRUCacheTest, NoAllocationsPerFrame) {
+    EXPECT_EQ(runIntrusiveLRUCache().allocationsPerFrame, 0.0);
+}
+
+TEST_F(LRUCacheTest, DISABLED_AllocationBenchmark) {
+    auto toString = [](const BenchmarkResult& result) {
+        return std::to_string(result.allocationsPerFrame) + " allocations/frame, " +
+            std::to_string(result.microsecondsPerFrame) + " us/frame";
+    };
+
+    benchmark::report("std::list LRU cache", toString(runListLRUCache()));
+    benchmark::report("Intrusive LRU cache", toString(runIntrusiveLRUCache()));
+}
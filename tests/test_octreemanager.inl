@@ -0,0 +1,263 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <modules/gaia/rendering/octreemanager.h>
+#include <openspace/util/distanceconstants.h>
+#include <ghoul/glm.h>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+    using openspace::OctreeManager;
+
+    constexpr const int MaxDist = 2; // [kPc]
+    constexpr const int MaxStarsPerNode = 64;
+    constexpr const float LodPixelThreshold = 250.f;
+    const glm::vec2 ScreenSize = glm::vec2(1920.f, 1080.f);
+
+    // Values per star for the Color render option with SSBOs: position and color
+    constexpr const size_t ValuesPerStar = 5;
+
+    // Creates an octree with stars that are clustered towards the center, which is where
+    // the camera is placed, similar to the Gaia datasets
+    void createOctree(OctreeManager& octree, int nStars) {
+        octree.initOctree(0, MaxDist, MaxStarsPerNode);
+
+        std::mt19937 gen(1337);
+        std::normal_distribution<float> pos(0.f, 0.3f);
+        std::uniform_real_distribution<float> mag(-5.f, 15.f);
+        std::uniform_real_distribution<float> col(-1.f, 3.f);
+        std::uniform_real_distribution<float> vel(-100.f, 100.f);
+
+        std::vector<float> star(8);
+        for (int i = 0; i < nStars; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                star[j] = glm::clamp(pos(gen), -0.99f * MaxDist, 0.99f * MaxDist);
+            }
+            star[3] = mag(gen);
+            star[4] = col(gen);
+            star[5] = vel(gen);
+            star[6] = vel(gen);
+            star[7] = vel(gen);
+            octree.insert(star);
+        }
+        for (size_t branch = 0; branch < 8; ++branch) {
+            octree.sliceLodData(branch);
+        }
+        octree.initBufferIndexStack(octree.totalNodes(), false, true);
+    }
+
+    glm::dmat4 viewProjection(double angle) {
+        const glm::dvec3 direction = glm::dvec3(std::cos(angle), std::sin(angle), 0.1);
+        const glm::dmat4 view = glm::lookAt(
+            glm::dvec3(0.0),
+            direction,
+            glm::dvec3(0.0, 0.0, 1.0)
+        );
+        const glm::dmat4 projection = glm::perspective(
+            glm::radians(60.0),
+            static_cast<double>(ScreenSize.x / ScreenSize.y),
+            1e10,
+            1e25
+        );
+        return projection * view;
+    }
+
+    std::vector<glm::dmat4> orbit(int nFrames, double turns) {
+        std::vector<glm::dmat4> views;
+        for (int i = 0; i < nFrames; ++i) {
+            views.push_back(viewProjection(glm::two_pi<double>() * turns * i / nFrames));
+        }
+        return views;
+    }
+
+    int traverse(OctreeManager& octree, const glm::dmat4& mvp) {
+        int deltaStars = 0;
+        octree.traverseData(
+            mvp,
+            ScreenSize,
+            deltaStars,
+            openspace::gaia::RenderOption::Color,
+            LodPixelThreshold
+        );
+        return deltaStars;
+    }
+} // namespace
+
+class OctreeManagerTest : public testing::Test {};
+
+TEST_F(OctreeManagerTest, StagesEveryChunkOnce) {
+    OctreeManager octree;
+    createOctree(octree, 50000);
+
+    int deltaStars = 0;
+    const OctreeManager::BufferUpdates& updates = octree.traverseData(
+        viewProjection(0.0),
+        ScreenSize,
+        deltaStars,
+        openspace::gaia::RenderOption::Color,
+        LodPixelThreshold
+    );
+
+    ASSERT_FALSE(updates.chunks.empty());
+    size_t nValues = 0;
+    std::set<int> indices;
+    for (size_t i = 0; i < updates.chunks.size(); ++i) {
+        const OctreeManager::BufferUpdates::Chunk& chunk = updates.chunks[i];
+        if (i > 0) {
+            EXPECT_LT(updates.chunks[i - 1].bufferIndex, chunk.bufferIndex);
+        }
+        indices.insert(chunk.bufferIndex);
+
+        EXPECT_EQ(chunk.size % ValuesPerStar, 0u);
+        EXPECT_LE(chunk.offset + chunk.size, updates.values.size());
+        nValues += chunk.size;
+    }
+    EXPECT_EQ(indices.size(), updates.chunks.size());
+    EXPECT_EQ(nValues, updates.values.size());
+    EXPECT_EQ(static_cast<size_t>(deltaStars), nValues / ValuesPerStar);
+}
+
+TEST_F(OctreeManagerTest, UnchangedViewStagesNothing) {
+    OctreeManager octree;
+    createOctree(octree, 50000);
+
+    const glm::dmat4 mvp = viewProjection(0.0);
+    EXPECT_GT(traverse(octree, mvp), 0);
+
+    int deltaStars = 0;
+    const OctreeManager::BufferUpdates& updates = octree.traverseData(
+        mvp,
+        ScreenSize,
+        deltaStars,
+        openspace::gaia::RenderOption::Color,
+        LodPixelThreshold
+    );
+    EXPECT_EQ(deltaStars, 0);
+    EXPECT_TRUE(updates.chunks.empty());
+    EXPECT_TRUE(updates.values.empty());
+}
+
+TEST_F(OctreeManagerTest, RemovedNodesClearTheirChunks) {
+    OctreeManager octree;
+    createOctree(octree, 50000);
+
+    // Looking in the opposite direction removes most of the nodes from the buffer
+    int nStars = traverse(octree, viewProjection(0.0));
+    int deltaStars = 0;
+    const OctreeManager::BufferUpdates& updates = octree.traverseData(
+        viewProjection(glm::pi<double>()),
+        ScreenSize,
+        deltaStars,
+        openspace::gaia::RenderOption::Color,
+        LodPixelThreshold
+    );
+    nStars += deltaStars;
+
+    size_t nCleared = 0;
+    for (const OctreeManager::BufferUpdates::Chunk& chunk : updates.chunks) {
+        if (chunk.size == 0) {
+            nCleared++;
+        }
+    }
+    EXPECT_GT(nCleared, 0u);
+    EXPECT_GT(nStars, 0);
+}
+
+TEST_F(OctreeManagerTest, SteadyStateDoesNotAllocate) {
+    OctreeManager octree;
+    createOctree(octree, 50000);
+
+    const std::vector<glm::dmat4> views = orbit(60, 1.0);
+    auto runOrbit = [&]() {
+        for (const glm::dmat4& mvp : views) {
+            traverse(octree, mvp);
+        }
+    };
+
+    // The first orbits grow the staging arena to the size of the largest update, after
+    // that the same orbit must not need any more memory
+    runOrbit();
+    runOrbit();
+
+    int deltaStars = 0;
+    const OctreeManager::BufferUpdates& updates = octree.traverseData(
+        views.back(),
+        ScreenSize,
+        deltaStars,
+        openspace::gaia::RenderOption::Color,
+        LodPixelThreshold
+    );
+    const size_t chunkCapacity = updates.chunks.capacity();
+    const size_t valueCapacity = updates.values.capacity();
+    const float* values = updates.values.data();
+
+    runOrbit();
+
+    EXPECT_EQ(updates.chunks.capacity(), chunkCapacity);
+    EXPECT_EQ(updates.values.capacity(), valueCapacity);
+    EXPECT_EQ(updates.values.data(), values);
+}
+
+TEST_F(OctreeManagerTest, DISABLED_Benchmark) {
+    // Measures the CPU time of the traversal for a camera that turns around in the
+    // center of a synthetic octree, which continuously streams nodes in and out
+    constexpr const int NumberOfFrames = 400;
+
+    OctreeManager octree;
+    createOctree(octree, 500000);
+    const std::vector<glm::dmat4> views = orbit(NumberOfFrames, 2.0);
+
+    size_t nChunks = 0;
+    size_t nValues = 0;
+    const std::chrono::microseconds time = benchmark::measure([&]() {
+        for (const glm::dmat4& mvp : views) {
+            int deltaStars = 0;
+            const OctreeManager::BufferUpdates& updates = octree.traverseData(
+                mvp,
+                ScreenSize,
+                deltaStars,
+                openspace::gaia::RenderOption::Color,
+                LodPixelThreshold
+            );
+            nChunks += updates.chunks.size();
+            nValues += updates.values.size();
+        }
+    });
+    const double ms = std::chrono::duration<double, std::milli>(time).count();
+
+    benchmark::report(
+        "OctreeManager traversal (" + std::to_string(octree.totalNodes()) + " nodes)",
+        std::to_string(ms / NumberOfFrames) + " ms per frame, " +
+            std::to_string(nChunks / NumberOfFrames) + " chunks and " +
+            std::to_string(nValues * sizeof(float) / NumberOfFrames) +
+            " bytes staged per frame"
+    );
+}
@@ -0,0 +1,180 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <modules/gaia/rendering/octreenodeloader.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    using openspace::OctreeNodeLoader;
+
+    // Blocks the single worker thread of a loader until it is released, so that the
+    // requests that are made in the meantime stay queued
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool isOpen = false;
+        bool isEntered = false;
+
+        void block() {
+            std::unique_lock lock(mutex);
+            isEntered = true;
+            condition.notify_all();
+            condition.wait(lock, [this]() { return isOpen; });
+        }
+
+        void waitUntilEntered() {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() { return isEntered; });
+        }
+
+        void open() {
+            std::lock_guard lock(mutex);
+            isOpen = true;
+            condition.notify_all();
+        }
+    };
+} // namespace
+
+class OctreeNodeLoaderTest : public testing::Test {};
+
+TEST_F(OctreeNodeLoaderTest, LoadsClosestNodesFirst) {
+    OctreeNodeLoader loader(1);
+    Gate gate;
+    loader.request(0, 0.f, [&gate]() { gate.block(); });
+    gate.waitUntilEntered();
+
+    std::mutex orderMutex;
+    std::vector<OctreeNodeLoader::NodeId> order;
+    auto record = [&](OctreeNodeLoader::NodeId id) {
+        return [&, id]() {
+            std::lock_guard lock(orderMutex);
+            order.push_back(id);
+        };
+    };
+    loader.request(1, 3.f, record(1));
+    loader.request(2, 1.f, record(2));
+    loader.request(3, 2.f, record(3));
+    // Requesting a queued node again only changes its priority
+    loader.request(1, 0.5f, record(100));
+    EXPECT_EQ(loader.numQueuedRequests(), 3u);
+
+    gate.open();
+    loader.waitUntilIdle();
+
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order[0], 1u);
+    EXPECT_EQ(order[1], 2u);
+    EXPECT_EQ(order[2], 3u);
+}
+
+TEST_F(OctreeNodeLoaderTest, CancelsStaleRequests) {
+    OctreeNodeLoader loader(1);
+    Gate gate;
+    loader.request(0, 0.f, [&gate]() { gate.block(); });
+    gate.waitUntilEntered();
+
+    std::atomic_int nLoaded = 0;
+    auto load = [&nLoaded]() { nLoaded++; };
+
+    loader.beginRequests();
+    loader.request(1, 1.f, load);
+    loader.request(2, 2.f, load);
+    loader.request(3, 3.f, load);
+
+    // The camera moved, only node 2 and a new node are still needed
+    loader.beginRequests();
+    loader.request(2, 1.f, load);
+    loader.request(4, 2.f, load);
+    EXPECT_EQ(loader.cancelStaleRequests(), 2u);
+
+    EXPECT_TRUE(loader.isPending(0));
+    EXPECT_FALSE(loader.isPending(1));
+    EXPECT_TRUE(loader.isPending(2));
+    EXPECT_FALSE(loader.isPending(3));
+    EXPECT_TRUE(loader.isPending(4));
+
+    gate.open();
+    loader.waitUntilIdle();
+    EXPECT_EQ(nLoaded, 2);
+    EXPECT_FALSE(loader.isPending(0));
+}
+
+TEST_F(OctreeNodeLoaderTest, IgnoresRequestsForRunningLoads) {
+    OctreeNodeLoader loader(1);
+    Gate gate;
+    std::atomic_int nLoaded = 0;
+    loader.request(0, 0.f, [&]() { gate.block(); nLoaded++; });
+    gate.waitUntilEntered();
+
+    loader.request(0, 0.f, [&nLoaded]() { nLoaded++; });
+    EXPECT_EQ(loader.numQueuedRequests(), 0u);
+
+    gate.open();
+    loader.waitUntilIdle();
+    EXPECT_EQ(nLoaded, 1);
+}
+
+TEST_F(OctreeNodeLoaderTest, BoundedConcurrency) {
+    constexpr const size_t NumThreads = 3;
+
+    std::atomic_int nRunning = 0;
+    std::atomic_int maxRunning = 0;
+    std::atomic_int nLoaded = 0;
+    {
+        OctreeNodeLoader loader(NumThreads);
+        EXPECT_EQ(loader.numThreads(), NumThreads);
+        for (OctreeNodeLoader::NodeId id = 0; id < 200; ++id) {
+            loader.request(id, static_cast<float>(id), [&]() {
+                const int running = ++nRunning;
+                int previous = maxRunning;
+                while (running > previous &&
+                       !maxRunning.compare_exchange_weak(previous, running))
+                {}
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                nRunning--;
+                nLoaded++;
+            });
+        }
+        loader.waitUntilIdle();
+
+        // Requests that are still queued when the loader is destroyed are discarded
+        for (OctreeNodeLoader::NodeId id = 200; id < 400; ++id) {
+            loader.request(id, static_cast<float>(id), [&]() { nLoaded++; });
+        }
+    }
+
+    EXPECT_EQ(nRunning, 0);
+    EXPECT_GE(nLoaded, 200);
+    EXPECT_LE(nLoaded, 400);
+    EXPECT_LE(maxRunning, static_cast<int>(NumThreads));
+    EXPECT_GE(maxRunning, 1);
+}
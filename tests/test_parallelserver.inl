@@ -0,0 +1,277 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/network/messagestructures.h>
+#include <openspace/network/outgoingmessagequeue.h>
+#include <openspace/network/parallelconnection.h>
+#include <openspace/network/parallelserver.h>
+#include <ghoul/io/socket/tcpsocket.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+class ParallelServerTest : public testing::Test {};
+
+namespace {
+    constexpr const int ServerPort = 25117;
+    constexpr const char* ServerPassword = "password";
+
+    long long nanosecondsNow() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    std::unique_ptr<openspace::ParallelConnection> connectPeer(const std::string& name) {
+        using namespace openspace;
+
+        std::unique_ptr<ghoul::io::TcpSocket> socket =
+            std::make_unique<ghoul::io::TcpSocket>("127.0.0.1", ServerPort);
+        socket->connect();
+        std::unique_ptr<ParallelConnection> connection =
+            std::make_unique<ParallelConnection>(std::move(socket));
+
+        const uint64_t passCode = std::hash<std::string>{}(ServerPassword);
+        const uint32_t nameLength = static_cast<uint32_t>(name.length());
+        std::vector<char> buffer;
+        buffer.insert(
+            buffer.end(),
+            reinterpret_cast<const char*>(&passCode),
+            reinterpret_cast<const char*>(&passCode) + sizeof(uint64_t)
+        );
+        buffer.insert(
+            buffer.end(),
+            reinterpret_cast<const char*>(&nameLength),
+            reinterpret_cast<const char*>(&nameLength) + sizeof(uint32_t)
+        );
+        buffer.insert(buffer.end(), name.begin(), name.end());
+
+        connection->sendMessage(ParallelConnection::Message(
+            ParallelConnection::MessageType::Authentication,
+            buffer
+        ));
+        return connection;
+    }
+
+    openspace::OutgoingMessageQueue::Message queuedMessage(char content,
+                                                           bool isCameraKeyframe)
+    {
+        return {
+            std::make_shared<const std::vector<char>>(1, content),
+            isCameraKeyframe
+        };
+    }
+} // namespace
+
+TEST_F(ParallelServerTest, CameraKeyframesReplaceQueuedOnes) {
+    using namespace openspace;
+    using PushResult = OutgoingMessageQueue::PushResult;
+
+    OutgoingMessageQueue queue(8);
+    EXPECT_EQ(queue.push(queuedMessage('a', false)), PushResult::StartSending);
+    EXPECT_EQ(queue.push(queuedMessage('1', true)), PushResult::Queued);
+    EXPECT_EQ(queue.push(queuedMessage('b', false)), PushResult::Queued);
+
+    // The peer lags behind, so the newer camera keyframe replaces the queued one
+    EXPECT_EQ(queue.push(queuedMessage('2', true)), PushResult::Queued);
+    EXPECT_EQ(queue.size(), 3);
+
+    std::string sent;
+    while (std::shared_ptr<const std::vector<char>> m = queue.pop()) {
+        sent += m->front();
+    }
+    EXPECT_EQ(sent, "ab2");
+
+    // The sender stopped on the empty queue, so the next message starts a new one
+    EXPECT_EQ(queue.push(queuedMessage('3', true)), PushResult::StartSending);
+}
+
+TEST_F(ParallelServerTest, OverflowDisconnectsLaggingPeers) {
+    using namespace openspace;
+    using PushResult = OutgoingMessageQueue::PushResult;
+
+    constexpr const size_t MaxMessages = 4;
+    OutgoingMessageQueue queue(MaxMessages);
+    queue.push(queuedMessage('c', true));
+    for (size_t i = 1; i < MaxMessages; ++i) {
+        queue.push(queuedMessage('d', false));
+    }
+
+    // Replacing the camera keyframe in a full queue does not overflow it
+    EXPECT_EQ(queue.push(queuedMessage('c', true)), PushResult::Queued);
+    EXPECT_FALSE(queue.hasOverflowed());
+
+    EXPECT_EQ(queue.push(queuedMessage('d', false)), PushResult::Overflow);
+    EXPECT_TRUE(queue.hasOverflowed());
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_EQ(queue.pop(), nullptr);
+
+    // Nothing more is queued for a peer that is being disconnected
+    EXPECT_EQ(queue.push(queuedMessage('c', true)), PushResult::Rejected);
+    EXPECT_EQ(queue.push(queuedMessage('d', false)), PushResult::Rejected);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST_F(ParallelServerTest, StopJoinsThreads) {
+    using namespace openspace;
+
+    std::unique_ptr<ParallelConnection> peer;
+    {
+        ParallelServer server;
+        server.start(ServerPort, ServerPassword, "hostpassword");
+
+        peer = connectPeer("Peer");
+        while (server.nConnections() < 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        // Returns only after the server, event loop, and peer threads have finished
+        server.stop();
+
+        // Stopping twice and destroying a stopped server are both harmless
+        server.stop();
+    }
+
+    // The server has closed the connection, so the peer only receives the messages that
+    // were sent before that
+    EXPECT_THROW(
+        while (true) {
+            peer->receiveMessage();
+        },
+        ParallelConnection::ConnectionLostError
+    );
+    peer->disconnect();
+}
+
+// A load test that connects 500 peers to report the fan-out latency. It is disabled by
+// default and can be run with --gtest_also_run_disabled_tests
+TEST_F(ParallelServerTest, DISABLED_FanOutLatency) {
+    using namespace openspace;
+
+    constexpr const size_t NumberOfPeers = 500;
+    constexpr const int NumberOfMessages = 200;
+
+    ParallelServer server;
+    server.setDefaultHostAddress("127.0.0.1");
+    server.start(ServerPort, ServerPassword, "hostpassword");
+
+    // The first peer from the default host address becomes the host
+    std::unique_ptr<ParallelConnection> host = connectPeer("Host");
+    while (true) {
+        ParallelConnection::Message m = host->receiveMessage();
+        uint32_t status = 0;
+        if (m.type == ParallelConnection::MessageType::ConnectionStatus) {
+            std::memcpy(&status, m.content.data(), sizeof(uint32_t));
+        }
+        if (status == static_cast<uint32_t>(ParallelConnection::Status::Host)) {
+            break;
+        }
+    }
+
+    std::vector<std::unique_ptr<ParallelConnection>> peers;
+    std::vector<std::vector<long long>> latencies(NumberOfPeers);
+    std::vector<std::thread> receivers;
+    std::atomic_size_t nFinishedPeers = 0;
+    for (size_t i = 0; i < NumberOfPeers; ++i) {
+        peers.push_back(connectPeer("Peer " + std::to_string(i)));
+        ParallelConnection* connection = peers.back().get();
+        std::vector<long long>& peerLatencies = latencies[i];
+
+        receivers.emplace_back([connection, &peerLatencies, &nFinishedPeers]() {
+            try {
+                while (peerLatencies.size() < NumberOfMessages) {
+                    ParallelConnection::Message m = connection->receiveMessage();
+                    if (m.type != ParallelConnection::MessageType::Data) {
+                        continue;
+                    }
+                    // Type and timestamp of the data message precede the payload
+                    const size_t offset = sizeof(uint32_t) + sizeof(double);
+                    long long sendTime = 0;
+                    std::memcpy(&sendTime, m.content.data() + offset, sizeof(long long));
+                    peerLatencies.push_back(nanosecondsNow() - sendTime);
+                }
+                ++nFinishedPeers;
+            }
+            catch (const ParallelConnection::ConnectionLostError&) {}
+        });
+    }
+
+    while (server.nConnections() < NumberOfPeers + 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (int i = 0; i < NumberOfMessages; ++i) {
+        const long long now = nanosecondsNow();
+        std::vector<char> payload(
+            reinterpret_cast<const char*>(&now),
+            reinterpret_cast<const char*>(&now) + sizeof(long long)
+        );
+        host->sendDataMessage(ParallelConnection::DataMessage(
+            datamessagestructures::Type::TimelineData,
+            static_cast<double>(i),
+            std::move(payload)
+        ));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (nFinishedPeers < NumberOfPeers && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (std::unique_ptr<ParallelConnection>& peer : peers) {
+        peer->disconnect();
+    }
+    for (std::thread& receiver : receivers) {
+        receiver.join();
+    }
+    host->disconnect();
+    server.stop();
+
+    EXPECT_EQ(nFinishedPeers, NumberOfPeers);
+
+    std::vector<long long> all;
+    for (const std::vector<long long>& l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    ASSERT_FALSE(all.empty());
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        const size_t i = static_cast<size_t>(p * (all.size() - 1));
+        return all[i] / 1000;
+    };
+    benchmark::report(
+        std::to_string(NumberOfPeers) + " peers fan-out latency",
+        "p50 " + std::to_string(percentile(0.5)) + " us, p90 " +
+            std::to_string(percentile(0.9)) + " us, p99 " +
+            std::to_string(percentile(0.99)) + " us, max " +
+            std::to_string(all.back() / 1000) + " us"
+    );
+}
@@ -85,3 +85,41 @@ TEST_F(RawVolumeIoTest, BasicInputOutput) {
         ASSERT_EQ(v, value(x));
     });
 }
+
+TEST_F(RawVolumeIoTest, SliceGroupOutput) {
+    using namespace openspace::volume;
+
+    glm::uvec3 dims{ 3, 4, 7 };
+    auto value = [dims](glm::uvec3 v) {
+        return static_cast<float>(v.z * dims.x * dims.y + v.y * dims.x + v.x);
+    };
+
+    std::string volumePath = absPath("${TESTDIR}/slicevolume.rawvolume");
+
+    // Write the 3x4x7 volume to disk in groups of 3 slices, the last group is partial
+    RawVolumeWriter<float> writer(volumePath);
+    writer.setDimensions(dims);
+    std::vector<unsigned int> groupSizes;
+    writer.writeSlices(
+        [&](unsigned int firstSlice, unsigned int nSlices, float* buffer) {
+            groupSizes.push_back(nSlices);
+            for (unsigned int z = 0; z < nSlices; ++z) {
+                for (unsigned int y = 0; y < dims.y; ++y) {
+                    for (unsigned int x = 0; x < dims.x; ++x) {
+                        buffer[x + y * dims.x + z * dims.x * dims.y] =
+                            value({ x, y, firstSlice + z });
+                    }
+                }
+            }
+        },
+        3
+    );
+    ASSERT_EQ(groupSizes, std::vector<unsigned int>({ 3, 3, 1 }));
+
+    // Read the volume back and make sure it matches a volume written in one piece
+    RawVolumeReader<float> reader(volumePath, dims);
+    std::unique_ptr<RawVolume<float>> storedVolume = reader.read();
+    storedVolume->forEachVoxel([&value](glm::uvec3 x, float v) {
+        ASSERT_EQ(v, value(x));
+    });
+}
@@ -0,0 +1,311 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/interaction/recordingwriter.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+namespace recordingwritertest {
+    using openspace::interaction::RecordingWriter;
+    using Keyframe = RecordingWriter::Keyframe;
+
+    constexpr const char AsciiHeader[] = "OpenSpace_record/playback00.85A\n";
+    constexpr const char BinaryHeader[] = "OpenSpace_record/playback00.85B\n";
+
+    Keyframe cameraKeyframe(size_t i) {
+        Keyframe keyframe;
+        keyframe.type = Keyframe::Type::Camera;
+        keyframe.timestamp = 100.0 + i / 60.0;
+        keyframe.timestampRelative = i / 60.0;
+        keyframe.simulationTime = 5e8 + i;
+        keyframe.camera._position = glm::dvec3(1e7 + i, 2e7 - i, 0.5 * i);
+        keyframe.camera._rotation = glm::dquat(0.5, 0.5, 0.5, 0.5);
+        keyframe.camera._followNodeRotation = (i % 2 == 0);
+        keyframe.camera._focusNode = (i % 3 == 0) ? "Earth" : "Moon";
+        keyframe.camera._scale = 1.f + i;
+        keyframe.camera._timestamp = keyframe.timestamp;
+        return keyframe;
+    }
+
+    Keyframe timeKeyframe(size_t i) {
+        Keyframe keyframe;
+        keyframe.type = Keyframe::Type::Time;
+        keyframe.timestamp = 100.25 + i / 60.0;
+        keyframe.timestampRelative = 0.25 + i / 60.0;
+        keyframe.time._time = 5e8 + 0.5 * i;
+        keyframe.time._dt = (i % 2 == 0) ? 1.0 : -3600.0;
+        keyframe.time._paused = (i % 3 == 0);
+        keyframe.time._requiresTimeJump = (i % 5 == 0);
+        keyframe.time._timestamp = keyframe.timestamp;
+        keyframe.simulationTime = keyframe.time._time;
+        return keyframe;
+    }
+
+    Keyframe scriptKeyframe(size_t i) {
+        Keyframe keyframe;
+        keyframe.type = Keyframe::Type::Script;
+        keyframe.timestamp = 100.5 + i / 60.0;
+        keyframe.timestampRelative = 0.5 + i / 60.0;
+        keyframe.simulationTime = 5e8 + i;
+        keyframe.script = (i % 2 == 0) ?
+            "openspace.printInfo('" + std::to_string(i) + "')" :
+            "openspace.time.setPause(true)\nopenspace.printInfo('paused')";
+        return keyframe;
+    }
+
+    // A recording with a time keyframe after every 7th and a script after every 10th
+    // camera keyframe
+    std::vector<Keyframe> recording(size_t nCameras) {
+        std::vector<Keyframe> keyframes;
+        for (size_t i = 0; i < nCameras; ++i) {
+            keyframes.push_back(cameraKeyframe(i));
+            if (i % 7 == 0) {
+                keyframes.push_back(timeKeyframe(i));
+            }
+            if (i % 10 == 0) {
+                keyframes.push_back(scriptKeyframe(i));
+            }
+        }
+        return keyframes;
+    }
+
+    template <typename T>
+    void writeBinary(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Writes the keyframes in the same way that SessionRecording wrote them on the main
+    // thread before the RecordingWriter existed
+    void writeSynchronously(const std::string& path,
+                            const std::vector<Keyframe>& keyframes, bool isBinary)
+    {
+        std::ofstream file;
+        if (isBinary) {
+            file.open(path, std::ios::binary);
+            file << BinaryHeader;
+        }
+        else {
+            file.open(path);
+            file << AsciiHeader;
+        }
+
+        for (const Keyframe& k : keyframes) {
+            if (isBinary) {
+                const char type = (k.type == Keyframe::Type::Camera) ? 'c' :
+                                  (k.type == Keyframe::Type::Time) ? 't' : 's';
+                file << type;
+                writeBinary(file, k.timestamp);
+                writeBinary(file, k.timestampRelative);
+                if (k.type == Keyframe::Type::Camera) {
+                    writeBinary(file, k.simulationTime);
+                    std::vector<char> buffer;
+                    k.camera.serialize(buffer);
+                    file.write(buffer.data(), buffer.size());
+                }
+                else if (k.type == Keyframe::Type::Time) {
+                    writeBinary(file, k.time._time);
+                    writeBinary(file, k.time._dt);
+                    file << static_cast<char>(k.time._paused ? 1 : 0);
+                    file << static_cast<char>(k.time._requiresTimeJump ? 1 : 0);
+                }
+                else {
+                    writeBinary(file, k.simulationTime);
+                    writeBinary(file, k.script.size());
+                    file.write(k.script.c_str(), k.script.size());
+                }
+                continue;
+            }
+
+            std::stringstream line;
+            if (k.type == Keyframe::Type::Camera) {
+                const openspace::datamessagestructures::CameraKeyframe& kf = k.camera;
+                line << "camera " << k.timestamp << ' ' << k.timestampRelative << ' ';
+                line << std::fixed << std::setprecision(3) << k.simulationTime << ' ';
+                line << std::fixed << std::setprecision(7) << kf._position.x << ' '
+                    << kf._position.y << ' ' << kf._position.z << ' ';
+                line << kf._rotation.x << ' ' << kf._rotation.y << ' ' <<
+                    kf._rotation.z << ' ' << kf._rotation.w << ' ';
+                line << std::scientific << kf._scale << ' ';
+                line << (kf._followNodeRotation ? "F " : "- ") << kf._focusNode;
+            }
+            else if (k.type == Keyframe::Type::Time) {
+                line << "time " << k.timestamp << ' ' << k.timestampRelative << ' ';
+                line << std::fixed << std::setprecision(3) << k.time._time;
+                line << ' ' << k.time._dt;
+                line << (k.time._paused ? " P" : " R");
+                line << (k.time._requiresTimeJump ? " J" : " -");
+            }
+            else {
+                const long nLines = std::count(k.script.begin(), k.script.end(), '\n');
+                line << "script " << k.timestamp << ' ' << k.timestampRelative << ' ';
+                line << std::fixed << std::setprecision(3) << k.simulationTime << ' ';
+                line << (nLines + 1) << ' ' << k.script;
+            }
+            file << line.str() << std::endl;
+        }
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+    }
+} // namespace recordingwritertest
+
+class RecordingWriterTest : public testing::Test {
+protected:
+    using RecordingWriter = openspace::interaction::RecordingWriter;
+    using Keyframe = RecordingWriter::Keyframe;
+
+    void SetUp() override {
+        _path = absPath("${TESTDIR}/recordingwritertest.osrec");
+        _referencePath = absPath("${TESTDIR}/recordingwritertest_reference.osrec");
+    }
+
+    void TearDown() override {
+        std::remove(_path.c_str());
+        std::remove(_referencePath.c_str());
+    }
+
+    void expectSameAsSynchronousWriter(const std::vector<Keyframe>& keyframes,
+                                       RecordingWriter::DataMode dataMode)
+    {
+        const bool isBinary = (dataMode == RecordingWriter::DataMode::Binary);
+        recordingwritertest::writeSynchronously(_referencePath, keyframes, isBinary);
+        const std::string expected = recordingwritertest::readFile(_referencePath);
+        const std::string written = recordingwritertest::readFile(_path);
+        EXPECT_EQ(written.size(), expected.size());
+        EXPECT_TRUE(written == expected);
+    }
+
+    std::string _path;
+    std::string _referencePath;
+};
+
+TEST_F(RecordingWriterTest, AsciiMatchesSynchronousWriter) {
+    const std::vector<Keyframe> keyframes = recordingwritertest::recording(100);
+
+    RecordingWriter writer;
+    ASSERT_TRUE(writer.open(_path, RecordingWriter::DataMode::Ascii));
+    writer.start();
+    for (const Keyframe& keyframe : keyframes) {
+        writer.queueKeyframe(keyframe);
+    }
+    writer.close();
+
+    EXPECT_EQ(writer.nDroppedKeyframes(), 0);
+    expectSameAsSynchronousWriter(keyframes, RecordingWriter::DataMode::Ascii);
+}
+
+TEST_F(RecordingWriterTest, BinaryMatchesSynchronousWriter) {
+    const std::vector<Keyframe> keyframes = recordingwritertest::recording(100);
+
+    RecordingWriter writer;
+    ASSERT_TRUE(writer.open(_path, RecordingWriter::DataMode::Binary));
+    writer.start();
+    for (const Keyframe& keyframe : keyframes) {
+        writer.queueKeyframe(keyframe);
+    }
+    writer.close();
+
+    EXPECT_EQ(writer.nDroppedKeyframes(), 0);
+    expectSameAsSynchronousWriter(keyframes, RecordingWriter::DataMode::Binary);
+}
+
+TEST_F(RecordingWriterTest, CloseDrainsQueue) {
+    // More keyframes than the writer thread writes in one batch, queued faster than it
+    // can write them
+    const std::vector<Keyframe> keyframes = recordingwritertest::recording(2000);
+    ASSERT_LT(keyframes.size(), RecordingWriter::DefaultQueueCapacity);
+
+    RecordingWriter writer;
+    ASSERT_TRUE(writer.open(_path, RecordingWriter::DataMode::Binary));
+    writer.start();
+    for (const Keyframe& keyframe : keyframes) {
+        writer.queueKeyframe(keyframe);
+    }
+    writer.close();
+
+    EXPECT_FALSE(writer.isOpen());
+    EXPECT_EQ(writer.backlog(), 0);
+    EXPECT_EQ(writer.nDroppedKeyframes(), 0);
+    expectSameAsSynchronousWriter(keyframes, RecordingWriter::DataMode::Binary);
+}
+
+TEST_F(RecordingWriterTest, CloseDrainsQueueWithoutWriterThread) {
+    const std::vector<Keyframe> keyframes = recordingwritertest::recording(50);
+
+    RecordingWriter writer;
+    ASSERT_TRUE(writer.open(_path, RecordingWriter::DataMode::Ascii));
+    for (const Keyframe& keyframe : keyframes) {
+        writer.queueKeyframe(keyframe);
+    }
+    EXPECT_EQ(writer.backlog(), keyframes.size());
+    writer.close();
+
+    expectSameAsSynchronousWriter(keyframes, RecordingWriter::DataMode::Ascii);
+}
+
+TEST_F(RecordingWriterTest, OverflowDropsCameraAndTimeKeyframesOnly) {
+    constexpr const size_t Capacity = 8;
+
+    // The writer thread is not started yet, so the queue fills up deterministically
+    RecordingWriter writer(Capacity);
+    ASSERT_TRUE(writer.open(_path, RecordingWriter::DataMode::Binary));
+    std::vector<Keyframe> expected;
+    for (size_t i = 0; i < Capacity; ++i) {
+        expected.push_back(recordingwritertest::cameraKeyframe(i));
+        writer.queueKeyframe(expected.back());
+    }
+    EXPECT_EQ(writer.nDroppedKeyframes(), 0);
+
+    writer.queueKeyframe(recordingwritertest::cameraKeyframe(Capacity));
+    writer.queueKeyframe(recordingwritertest::timeKeyframe(Capacity));
+    EXPECT_EQ(writer.nDroppedKeyframes(), 2);
+    EXPECT_EQ(writer.backlog(), Capacity);
+    EXPECT_EQ(writer.maxBacklog(), Capacity);
+
+    // A script waits until the writer thread has made space for it
+    expected.push_back(recordingwritertest::scriptKeyframe(Capacity));
+    std::thread producer([&writer, &expected]() {
+        writer.queueKeyframe(expected.back());
+    });
+    writer.start();
+    producer.join();
+    writer.close();
+
+    EXPECT_EQ(writer.nDroppedKeyframes(), 2);
+    expectSameAsSynchronousWriter(expected, RecordingWriter::DataMode::Binary);
+}
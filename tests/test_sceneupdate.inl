@@ -0,0 +1,240 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/scene/rotation.h>
+#include <openspace/scene/scale.h>
+#include <openspace/scene/scene.h>
+#include <openspace/scene/scenegraphnode.h>
+#include <openspace/scene/sceneinitializer.h>
+#include <openspace/scene/translation.h>
+#include <openspace/util/updatestructures.h>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+class SceneUpdateTest : public testing::Test {
+protected:
+    // Moves with time and, if a reference node is provided, is offset by the world
+    // position of that node so that the result depends on the update order
+    class TestTranslation : public openspace::Translation {
+    public:
+        TestTranslation(glm::dvec3 offset, const openspace::SceneGraphNode* reference)
+            : _offset(offset)
+            , _reference(reference)
+        {}
+
+        glm::dvec3 position(const openspace::UpdateData& data) const override {
+            glm::dvec3 p = _offset * (1.0 + data.time.j2000Seconds());
+            if (_reference) {
+                p += 0.5 * _reference->worldPosition();
+            }
+            return p;
+        }
+
+    private:
+        glm::dvec3 _offset;
+        const openspace::SceneGraphNode* _reference;
+    };
+
+    class TestRotation : public openspace::Rotation {
+    public:
+        TestRotation(double angle) : _angle(angle) {}
+
+        glm::dmat3 matrix(const openspace::UpdateData& data) const override {
+            const double a = _angle * (1.0 + data.time.j2000Seconds());
+            return glm::dmat3(
+                std::cos(a), std::sin(a), 0.0,
+                -std::sin(a), std::cos(a), 0.0,
+                0.0, 0.0, 1.0
+            );
+        }
+
+    private:
+        double _angle;
+    };
+
+    class TestScale : public openspace::Scale {
+    public:
+        TestScale(double scale) : _scale(scale) {}
+
+        double scaleValue(const openspace::UpdateData&) const override {
+            return _scale;
+        }
+
+    private:
+        double _scale;
+    };
+
+    class ThrowingTranslation : public openspace::Translation {
+    public:
+        glm::dvec3 position(const openspace::UpdateData&) const override {
+            throw std::logic_error("ThrowingTranslation");
+        }
+    };
+
+    // Creates a synthetic scene with 100 nodes directly attached to the root, each of
+    // which has 99 children. Every tenth grandchild additionally depends on a grandchild
+    // of the previous branch to create deeper update levels. All nodes have a distinct
+    // translation, rotation, and scale, and the translation of the dependent nodes is
+    // relative to the node they depend on
+    std::unique_ptr<openspace::Scene> createScene() {
+        using namespace openspace;
+
+        std::unique_ptr<Scene> scene = std::make_unique<Scene>(
+            std::make_unique<SingleThreadedSceneInitializer>()
+        );
+
+        auto setTransform = [](SceneGraphNode& node, int i, int j,
+                               const SceneGraphNode* reference)
+        {
+            const glm::dvec3 offset = glm::dvec3(1.0 + i, 0.5 * j, 0.25 * (i - j));
+            node.setTranslation(std::make_unique<TestTranslation>(offset, reference));
+            node.setRotation(std::make_unique<TestRotation>(0.01 * i + 0.001 * j));
+            node.setScale(std::make_unique<TestScale>(1.0 + 0.001 * (i + j)));
+        };
+
+        std::vector<SceneGraphNode*> previousBranch;
+        for (int i = 0; i < 100; ++i) {
+            std::unique_ptr<SceneGraphNode> branch = std::make_unique<SceneGraphNode>();
+            branch->setIdentifier("Branch" + std::to_string(i));
+            setTransform(*branch, i, 0, nullptr);
+            SceneGraphNode* branchRaw = branch.get();
+            scene->attachNode(std::move(branch));
+            branchRaw->initialize();
+
+            std::vector<SceneGraphNode*> currentBranch;
+            for (int j = 0; j < 99; ++j) {
+                std::unique_ptr<SceneGraphNode> leaf = std::make_unique<SceneGraphNode>();
+                leaf->setIdentifier(
+                    "Leaf" + std::to_string(i) + "_" + std::to_string(j)
+                );
+                SceneGraphNode* leafRaw = leaf.get();
+                branchRaw->attachChild(std::move(leaf));
+
+                if (j % 10 == 0 && !previousBranch.empty()) {
+                    leafRaw->addDependency(*previousBranch[j]);
+                    setTransform(*leafRaw, i, j + 1, previousBranch[j]);
+                }
+                else {
+                    setTransform(*leafRaw, i, j + 1, nullptr);
+                }
+                leafRaw->initialize();
+                currentBranch.push_back(leafRaw);
+            }
+            previousBranch = std::move(currentBranch);
+        }
+        scene->root()->initialize();
+        return scene;
+    }
+
+    openspace::UpdateData updateData(double time = 0.0) const {
+        return {
+            openspace::TransformData{ glm::dvec3(0.0), glm::dmat3(1.0), 1.0 },
+            openspace::Time(time),
+            openspace::Time(time),
+            false
+        };
+    }
+};
+
+TEST_F(SceneUpdateTest, ParallelMatchesSerial) {
+    using namespace openspace;
+
+    std::unique_ptr<Scene> serial = createScene();
+    std::unique_ptr<Scene> parallel = createScene();
+    parallel->setNumberOfUpdateThreads(4);
+
+    for (double time : { 0.0, 1.0, 2.5 }) {
+        serial->update(updateData(time));
+        parallel->update(updateData(time));
+
+        const std::vector<SceneGraphNode*>& serialNodes = serial->allSceneGraphNodes();
+        ASSERT_EQ(serialNodes.size(), parallel->allSceneGraphNodes().size());
+        for (SceneGraphNode* node : serialNodes) {
+            SceneGraphNode* other = parallel->sceneGraphNode(node->identifier());
+            ASSERT_NE(other, nullptr);
+            EXPECT_EQ(node->modelTransform(), other->modelTransform()) <<
+                node->identifier() << " at time " << time;
+        }
+    }
+
+    // Make sure that the transforms are not trivially equal
+    const SceneGraphNode* dependent = serial->sceneGraphNode("Leaf99_10");
+    ASSERT_NE(dependent, nullptr);
+    EXPECT_NE(dependent->modelTransform(), glm::dmat4(1.0));
+    EXPECT_NE(
+        dependent->worldPosition(),
+        serial->sceneGraphNode("Leaf99_11")->worldPosition()
+    );
+}
+
+TEST_F(SceneUpdateTest, ParallelUpdatePropagatesExceptions) {
+    using namespace openspace;
+
+    for (unsigned int nThreads : { 0u, 4u }) {
+        std::unique_ptr<Scene> scene = createScene();
+        scene->setNumberOfUpdateThreads(nThreads);
+        scene->sceneGraphNode("Leaf50_50")->setTranslation(
+            std::make_unique<ThrowingTranslation>()
+        );
+        EXPECT_THROW(scene->update(updateData()), std::logic_error) <<
+            nThreads << " threads";
+    }
+}
+
+TEST_F(SceneUpdateTest, DISABLED_Benchmark) {
+    using namespace openspace;
+
+    constexpr const int Iterations = 100;
+
+    auto measure = [this](Scene& scene) {
+        // The first update sorts the nodes and computes the update levels
+        scene.update(updateData());
+
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            for (int i = 0; i < Iterations; ++i) {
+                scene.update(updateData());
+            }
+        });
+        return std::to_string(time.count() / Iterations) + " us";
+    };
+
+    std::unique_ptr<Scene> serial = createScene();
+    benchmark::report(
+        "Serial update of " + std::to_string(serial->allSceneGraphNodes().size()) +
+        " nodes",
+        measure(*serial)
+    );
+
+    for (unsigned int nThreads : { 1u, 2u, 4u, 8u }) {
+        std::unique_ptr<Scene> parallel = createScene();
+        parallel->setNumberOfUpdateThreads(nThreads);
+        benchmark::report(
+            "Parallel update with " + std::to_string(nThreads) + " threads",
+            measure(*parallel)
+        );
+    }
+}
@@ -0,0 +1,257 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/speckcache.h>
+
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/exception.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace {
+    openspace::speck::Dataset createDataset(size_t nRows) {
+        openspace::speck::Dataset d;
+        d.variables = { { 3, "lum" }, { 4, "orientation" }, { 10, "texnum" } };
+        d.textures = { { 1, "galaxy.sgi" } };
+        d.textureDataIndex = 10;
+        d.orientationDataIndex = 4;
+        d.nValuesPerRow = 11;
+        d.columns.resize(d.nValuesPerRow);
+        for (int c = 0; c < d.nValuesPerRow; ++c) {
+            d.columns[c].resize(nRows);
+            for (size_t r = 0; r < nRows; ++r) {
+                d.columns[c][r] = static_cast<float>(c * 1000) - static_cast<float>(r);
+            }
+        }
+        return d;
+    }
+} // namespace
+
+class SpeckCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _path = absPath("${TESTDIR}/speckcachetest.cache");
+    }
+
+    void TearDown() override {
+        std::remove(_path.c_str());
+    }
+
+    std::string _path;
+};
+
+TEST_F(SpeckCacheTest, RoundTrip) {
+    using namespace openspace::speck;
+
+    const Dataset dataset = createDataset(1000);
+    saveCache(dataset, _path, 1234, 7);
+
+    const CachedDataset cached(_path);
+    EXPECT_EQ(cached.sourceChecksum(), 1234);
+    EXPECT_EQ(cached.datasetVersion(), 7);
+    ASSERT_EQ(cached.nRows(), 1000);
+    ASSERT_EQ(cached.nColumns(), 11);
+    EXPECT_EQ(cached.textureDataIndex(), 10);
+    EXPECT_EQ(cached.orientationDataIndex(), 4);
+
+    EXPECT_EQ(cached.column(0).name, "x");
+    EXPECT_EQ(cached.index("lum"), 3);
+    EXPECT_EQ(cached.index("texnum"), 10);
+    EXPECT_TRUE(cached.column(5).name.empty());
+
+    ASSERT_EQ(cached.variables().size(), 3);
+    EXPECT_EQ(cached.variables()[1].name, "orientation");
+    EXPECT_EQ(cached.variables()[1].index, 4);
+    ASSERT_EQ(cached.textures().size(), 1);
+    EXPECT_EQ(cached.textures()[0].index, 1);
+    EXPECT_EQ(cached.textures()[0].file, "galaxy.sgi");
+
+    for (size_t c = 0; c < cached.nColumns(); ++c) {
+        const CachedDataset::Column& column = cached.column(c);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(column.values) % 64, 0);
+        EXPECT_EQ(column.maximum, static_cast<float>(c * 1000));
+        EXPECT_EQ(column.minimum, static_cast<float>(c * 1000) - 999.f);
+        for (size_t r = 0; r < cached.nRows(); ++r) {
+            ASSERT_EQ(column.values[r], dataset.columns[c][r]);
+        }
+    }
+}
+
+TEST_F(SpeckCacheTest, InvalidFile) {
+    using namespace openspace::speck;
+
+    EXPECT_THROW(CachedDataset{ _path }, ghoul::RuntimeError);
+
+    {
+        std::ofstream file(_path, std::ofstream::binary);
+        file << "This is not a cache file, but it is long enough to contain a header";
+    }
+    EXPECT_THROW(CachedDataset{ _path }, ghoul::RuntimeError);
+
+    // A cache file whose column data has been cut off
+    saveCache(createDataset(1000), _path, 0, 0);
+    {
+        std::ifstream in(_path, std::ifstream::binary);
+        std::string contents(1024, '\0');
+        in.read(contents.data(), contents.size());
+        in.close();
+        std::ofstream out(_path, std::ofstream::binary | std::ofstream::trunc);
+        out.write(contents.data(), contents.size());
+    }
+    EXPECT_THROW(CachedDataset{ _path }, ghoul::RuntimeError);
+}
+
+TEST_F(SpeckCacheTest, LoadCachedFile) {
+    using namespace openspace::speck;
+
+    const std::string speckPath = absPath("${TESTDIR}/speckcachetest.speck");
+    {
+        std::ofstream file(speckPath);
+        file << "datavar 0 lum\n1 2 3 4\n5 6 7 8\n";
+    }
+    const std::string cachePath = FileSys.cacheManager()->cachedFilename(
+        ghoul::filesystem::File(speckPath),
+        "SpeckCacheTest",
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+
+    int nPreprocessed = 0;
+    auto preprocess = [&nPreprocessed](Dataset& d) {
+        ++nPreprocessed;
+        d.columns[3][0] = 42.f;
+    };
+
+    std::unique_ptr<CachedDataset> d = loadCachedFile(
+        speckPath,
+        "SpeckCacheTest",
+        1,
+        SkipAllZeroRows::No,
+        preprocess
+    );
+    ASSERT_EQ(d->nRows(), 2);
+    EXPECT_EQ(d->column(3).values[0], 42.f);
+    EXPECT_EQ(nPreprocessed, 1);
+    d = nullptr;
+
+    // Same source and version: the cache is used
+    d = loadCachedFile(speckPath, "SpeckCacheTest", 1, SkipAllZeroRows::No, preprocess);
+    EXPECT_EQ(d->column(3).values[0], 42.f);
+    EXPECT_EQ(nPreprocessed, 1);
+    d = nullptr;
+
+    // Different version: the cache is recreated
+    d = loadCachedFile(speckPath, "SpeckCacheTest", 2, SkipAllZeroRows::No, preprocess);
+    EXPECT_EQ(nPreprocessed, 2);
+    d = nullptr;
+
+    // Touched source file with the same contents: the checksum still matches
+    {
+        std::ofstream file(speckPath);
+        file << "datavar 0 lum\n1 2 3 4\n5 6 7 8\n";
+    }
+    std::filesystem::last_write_time(
+        speckPath,
+        std::filesystem::last_write_time(speckPath) + std::chrono::seconds(10)
+    );
+    d = loadCachedFile(speckPath, "SpeckCacheTest", 2, SkipAllZeroRows::No, preprocess);
+    EXPECT_EQ(d->column(3).values[0], 42.f);
+    EXPECT_EQ(nPreprocessed, 2);
+    d = nullptr;
+
+    // Changed source file: the cache is recreated
+    {
+        std::ofstream file(speckPath);
+        file << "datavar 0 lum\n1 2 3 4\n5 6 7 8\n9 10 11 12\n";
+    }
+    d = loadCachedFile(speckPath, "SpeckCacheTest", 2, SkipAllZeroRows::No, preprocess);
+    EXPECT_EQ(d->nRows(), 3);
+    EXPECT_EQ(nPreprocessed, 3);
+    d = nullptr;
+
+    std::remove(speckPath.c_str());
+    std::remove(cachePath.c_str());
+}
+
+TEST_F(SpeckCacheTest, DISABLED_Benchmark) {
+    using namespace openspace::speck;
+
+    constexpr const size_t NRows = 2000000;
+    const Dataset dataset = createDataset(NRows);
+    const std::vector<float> interleaved = dataset.interleaved();
+
+    // The format that was used by the renderables before: a few header fields followed
+    // by all values in row-major order, read with a single ifstream::read
+    const std::string oldPath = _path + ".old";
+    {
+        std::ofstream file(oldPath, std::ofstream::binary);
+        const int32_t nValues = static_cast<int32_t>(interleaved.size());
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+        file.write(
+            reinterpret_cast<const char*>(interleaved.data()),
+            interleaved.size() * sizeof(float)
+        );
+    }
+    saveCache(dataset, _path, 0, 0);
+
+    const std::chrono::microseconds rowMajor = benchmark::measure([&]() {
+        std::ifstream file(oldPath, std::ifstream::binary);
+        int32_t nValues = 0;
+        file.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
+        std::vector<float> oldData(nValues);
+        file.read(reinterpret_cast<char*>(oldData.data()), nValues * sizeof(float));
+    });
+
+    std::unique_ptr<const CachedDataset> cached;
+    const std::chrono::microseconds open = benchmark::measure([&]() {
+        cached = std::make_unique<const CachedDataset>(_path);
+    });
+
+    // Accessing a single column only touches the pages of that column
+    const std::chrono::microseconds firstColumn = benchmark::measure([&]() {
+        volatile float sum = 0.f;
+        const float* lum = cached->column(cached->index("lum")).values;
+        for (size_t i = 0; i < cached->nRows(); ++i) {
+            sum = sum + lum[i];
+        }
+    });
+
+    benchmark::report(
+        "Row-major cache",
+        "ifstream::read " + std::to_string(rowMajor.count()) + " us"
+    );
+    benchmark::report(
+        "Columnar cache",
+        "open " + std::to_string(open.count()) + " us, first column read " +
+            std::to_string(firstColumn.count()) + " us"
+    );
+
+    std::remove(oldPath.c_str());
+}
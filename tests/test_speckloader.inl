@@ -0,0 +1,230 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/speckloader.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/exception.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+    // Creates the contents of a Speck file with the provided number of rows that each
+    // contain the x, y, z position and nVariables additional values
+    std::string createSpeckFile(size_t nRows, int nVariables) {
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+
+        std::string result = "# A synthetic Speck file\n";
+        for (int i = 0; i < nVariables; ++i) {
+            result += "datavar " + std::to_string(i) + " var" + std::to_string(i) + '\n';
+        }
+        result += '\n';
+
+        char buffer[32];
+        for (size_t row = 0; row < nRows; ++row) {
+            for (int i = 0; i < nVariables + 3; ++i) {
+                std::snprintf(buffer, sizeof(buffer), "%.6g ", dist(rng));
+                result += buffer;
+            }
+            result += '\n';
+        }
+        return result;
+    }
+
+    // The reference implementation that was used by the renderables before
+    std::vector<float> readWithStringStream(const std::string& contents, int nValues) {
+        std::stringstream file(contents);
+        std::string line;
+        while (true) {
+            std::streampos position = file.tellg();
+            std::getline(file, line);
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            if (line.substr(0, 7) != "datavar") {
+                file.seekg(position);
+                break;
+            }
+        }
+
+        std::vector<float> result;
+        do {
+            std::vector<float> values(nValues);
+            std::getline(file, line);
+            if (line.empty()) {
+                continue;
+            }
+            std::stringstream str(line);
+            for (int i = 0; i < nValues; ++i) {
+                str >> values[i];
+            }
+            result.insert(result.end(), values.begin(), values.end());
+        } while (!file.eof());
+        return result;
+    }
+} // namespace
+
+class SpeckLoaderTest : public testing::Test {};
+
+TEST_F(SpeckLoaderTest, Header) {
+    const std::string contents =
+        "# Comment\n"
+        "datavar 0 colorb_v\n"
+        "datavar 1 lum\n"
+        "datavar 2 orientation\n"
+        "datavar 8 texnum\n"
+        "texturevar 8\n"
+        "polyorivar 2\n"
+        "texture -M 1 galaxy.sgi\n"
+        "texture 2 nebula.png\n"
+        "maxcomment 16\n"
+        "1 2 3 4 5 6 7 8 9 10 11 12 13 14\n";
+
+    const openspace::speck::Dataset d = openspace::speck::parse(contents);
+
+    ASSERT_EQ(d.variables.size(), 4);
+    EXPECT_EQ(d.variables[0].name, "colorb_v");
+    EXPECT_EQ(d.variables[0].index, 3);
+    EXPECT_EQ(d.index("lum"), 4);
+    EXPECT_EQ(d.index("orientation"), 5);
+    EXPECT_EQ(d.index("texnum"), 11);
+    EXPECT_EQ(d.index("missing"), -1);
+    EXPECT_EQ(d.nValuesPerRow, 12);
+    EXPECT_EQ(d.textureDataIndex, 11);
+    EXPECT_EQ(d.orientationDataIndex, 5);
+
+    ASSERT_EQ(d.textures.size(), 2);
+    EXPECT_EQ(d.textures[0].index, 1);
+    EXPECT_EQ(d.textures[0].file, "galaxy.sgi");
+    EXPECT_EQ(d.textures[1].index, 2);
+    EXPECT_EQ(d.textures[1].file, "nebula.png");
+
+    ASSERT_EQ(d.nRows(), 1);
+    EXPECT_EQ(d.columns[11][0], 12.f);
+}
+
+TEST_F(SpeckLoaderTest, DataLines) {
+    const std::string contents =
+        "datavar 0 a\r\n"
+        "datavar 1 b\r\n"
+        "1 2 3 4 5\r\n"
+        "\r\n"
+        "# A comment in the data section\r\n"
+        "-1.5e2 .25 +3. 1e-3\r\n"
+        "  7 8 9 10 11 12 # trailing comment\r\n"
+        "0 0 0 0 0\r\n"
+        "1 2 3 nan 4";
+
+    const openspace::speck::Dataset d = openspace::speck::parse(contents);
+    ASSERT_EQ(d.nValuesPerRow, 5);
+    ASSERT_EQ(d.nRows(), 5);
+
+    const std::vector<float> values = d.interleaved();
+    const std::vector<float> expected = {
+        1.f, 2.f, 3.f, 4.f, 5.f,
+        -150.f, 0.25f, 3.f, 0.001f, 0.f,
+        7.f, 8.f, 9.f, 10.f, 11.f,
+        0.f, 0.f, 0.f, 0.f, 0.f,
+        1.f, 2.f, 3.f, 0.f, 4.f
+    };
+    ASSERT_EQ(values.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (i == 23) {
+            EXPECT_TRUE(std::isnan(values[i]));
+        }
+        else {
+            EXPECT_FLOAT_EQ(values[i], expected[i]) << "Index " << i;
+        }
+    }
+
+    const openspace::speck::Dataset skipped = openspace::speck::parse(
+        contents,
+        openspace::speck::SkipAllZeroRows::Yes
+    );
+    EXPECT_EQ(skipped.nRows(), 4);
+    EXPECT_EQ(skipped.columns[0][3], 1.f);
+}
+
+TEST_F(SpeckLoaderTest, LoadFile) {
+    const std::string path = absPath("${TESTDIR}/speckloadertest.speck");
+    {
+        std::ofstream file(path);
+        file << "datavar 0 lum\n1 2 3 4\n5 6 7 8\n";
+    }
+
+    const openspace::speck::Dataset d = openspace::speck::loadFile(path);
+    ASSERT_EQ(d.nRows(), 2);
+    EXPECT_EQ(d.columns[3][1], 8.f);
+
+    std::remove(path.c_str());
+    EXPECT_THROW(openspace::speck::loadFile(path), ghoul::RuntimeError);
+}
+
+TEST_F(SpeckLoaderTest, MatchesReference) {
+    // Large enough to be split into multiple chunks that are parsed in parallel
+    constexpr const size_t NRows = 100000;
+    constexpr const int NVariables = 9;
+    const std::string contents = createSpeckFile(NRows, NVariables);
+
+    const std::vector<float> reference = readWithStringStream(contents, NVariables + 3);
+    const std::vector<float> values = openspace::speck::parse(contents).interleaved();
+
+    ASSERT_EQ(values.size(), reference.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_FLOAT_EQ(values[i], reference[i]) << "Index " << i;
+    }
+}
+
+TEST_F(SpeckLoaderTest, DISABLED_Benchmark) {
+    constexpr const size_t NRows = 500000;
+    constexpr const int NVariables = 13;
+    const std::string contents = createSpeckFile(NRows, NVariables);
+
+    auto toString = [](std::chrono::microseconds time) {
+        return std::to_string(
+            std::chrono::duration_cast<std::chrono::milliseconds>(time).count()
+        ) + " ms";
+    };
+
+    const std::string name =
+        "Speck file with " + std::to_string(contents.size() / (1024 * 1024)) + " MB";
+
+    const std::chrono::microseconds stringStream = benchmark::measure([&]() {
+        readWithStringStream(contents, NVariables + 3);
+    });
+    benchmark::report(name, "getline + stringstream " + toString(stringStream));
+
+    const std::chrono::microseconds parse = benchmark::measure([&]() {
+        openspace::speck::parse(contents).interleaved();
+    });
+    benchmark::report(name, "speck::parse " + toString(parse));
+}
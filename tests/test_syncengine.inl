@@ -0,0 +1,215 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/engine/syncengine.h>
+#include <openspace/util/syncdata.h>
+#include <ghoul/glm.h>
+#include <chrono>
+#include <memory>
+
+class SyncEngineTest : public testing::Test {};
+
+namespace {
+    using IsMaster = openspace::SyncEngine::IsMaster;
+
+    struct Cluster {
+        Cluster(size_t nSyncables, unsigned int keyframeInterval)
+            : master(4096, keyframeInterval)
+            , slave(4096, keyframeInterval)
+        {
+            for (size_t i = 0; i < nSyncables; ++i) {
+                masterData.push_back(
+                    std::make_unique<openspace::SyncData<glm::dvec3>>(glm::dvec3(0.0))
+                );
+                slaveData.push_back(
+                    std::make_unique<openspace::SyncData<glm::dvec3>>(glm::dvec3(0.0))
+                );
+                master.addSyncable(masterData.back().get());
+                slave.addSyncable(slaveData.back().get());
+            }
+        }
+
+        // Runs a single frame on the master and returns the data it sends to the slave
+        std::vector<char> encode() {
+            master.preSynchronization(IsMaster::Yes);
+            std::vector<char> data = master.encodeSyncables();
+            master.postSynchronization(IsMaster::Yes);
+            return data;
+        }
+
+        // Hands a frame to the slave, possibly late or out of order
+        void deliver(std::vector<char> data) {
+            slave.decodeSyncables(std::move(data));
+            slave.postSynchronization(IsMaster::No);
+        }
+
+        // Runs a single frame and returns the size of the transferred data
+        size_t synchronize() {
+            std::vector<char> data = encode();
+            const size_t size = data.size();
+            deliver(std::move(data));
+            return size;
+        }
+
+        openspace::SyncEngine master;
+        openspace::SyncEngine slave;
+        std::vector<std::unique_ptr<openspace::SyncData<glm::dvec3>>> masterData;
+        std::vector<std::unique_ptr<openspace::SyncData<glm::dvec3>>> slaveData;
+    };
+} // namespace
+
+TEST_F(SyncEngineTest, DeltaFramesOnlyCarryChanges) {
+    Cluster cluster(10, 1000);
+
+    // The first frame is always a keyframe
+    const size_t keyframeSize = cluster.synchronize();
+    const size_t emptySize = cluster.synchronize();
+    EXPECT_LT(emptySize, keyframeSize);
+
+    cluster.masterData[3]->data() = glm::dvec3(1.0, 2.0, 3.0);
+    cluster.masterData[7]->data() = glm::dvec3(4.0, 5.0, 6.0);
+    const size_t deltaSize = cluster.synchronize();
+    EXPECT_EQ(
+        deltaSize,
+        emptySize + 2 * (sizeof(uint32_t) + sizeof(glm::dvec3))
+    );
+
+    for (size_t i = 0; i < cluster.masterData.size(); ++i) {
+        EXPECT_EQ(cluster.slaveData[i]->data(), cluster.masterData[i]->data());
+    }
+
+    // Unchanged values are not sent again
+    EXPECT_EQ(cluster.synchronize(), emptySize);
+}
+
+TEST_F(SyncEngineTest, KeyframesRestoreSlaves) {
+    Cluster cluster(4, 3);
+
+    // Frame 1 is a keyframe as the Syncables were just added
+    cluster.masterData[0]->data() = glm::dvec3(1.0);
+    cluster.synchronize();
+    EXPECT_EQ(cluster.slaveData[0]->data(), glm::dvec3(1.0));
+
+    // Frame 2 is a delta frame that never reaches the slave.  The master has encoded
+    // the change, so it is not sent again in the following delta frame
+    cluster.masterData[1]->data() = glm::dvec3(2.0);
+    cluster.encode();
+    cluster.synchronize();
+    EXPECT_EQ(cluster.slaveData[1]->data(), glm::dvec3(0.0));
+
+    // Frame 4 is the next keyframe and restores the lost change
+    cluster.synchronize();
+    for (size_t i = 0; i < cluster.masterData.size(); ++i) {
+        EXPECT_EQ(cluster.slaveData[i]->data(), cluster.masterData[i]->data());
+    }
+}
+
+TEST_F(SyncEngineTest, KeyframesRestoreReorderedFrames) {
+    Cluster cluster(4, 4);
+    cluster.synchronize();
+
+    // Frames 2 and 3 both change the same value but arrive in the wrong order
+    cluster.masterData[2]->data() = glm::dvec3(1.0);
+    std::vector<char> second = cluster.encode();
+    cluster.masterData[2]->data() = glm::dvec3(2.0);
+    std::vector<char> third = cluster.encode();
+    cluster.deliver(std::move(third));
+    cluster.deliver(std::move(second));
+    EXPECT_EQ(cluster.slaveData[2]->data(), glm::dvec3(1.0));
+
+    // Frame 4 is another delta frame without changes, so the slave stays stale
+    cluster.synchronize();
+    EXPECT_EQ(cluster.slaveData[2]->data(), glm::dvec3(1.0));
+
+    // Frame 5 is the next keyframe
+    cluster.synchronize();
+    EXPECT_EQ(cluster.slaveData[2]->data(), glm::dvec3(2.0));
+}
+
+TEST_F(SyncEngineTest, KeyframesRestoreLateSlaves) {
+    Cluster cluster(4, 4);
+
+    // The slave has not joined yet and misses the keyframe and the first delta frame
+    cluster.masterData[0]->data() = glm::dvec3(1.0);
+    cluster.encode();
+    cluster.masterData[1]->data() = glm::dvec3(2.0);
+    cluster.encode();
+
+    // After joining, delta frames only bring the slave the values that change
+    cluster.masterData[2]->data() = glm::dvec3(3.0);
+    cluster.synchronize();
+    cluster.synchronize();
+    EXPECT_EQ(cluster.slaveData[0]->data(), glm::dvec3(0.0));
+    EXPECT_EQ(cluster.slaveData[1]->data(), glm::dvec3(0.0));
+    EXPECT_EQ(cluster.slaveData[2]->data(), glm::dvec3(3.0));
+
+    // Frame 5 is the next keyframe
+    cluster.synchronize();
+    for (size_t i = 0; i < cluster.masterData.size(); ++i) {
+        EXPECT_EQ(cluster.slaveData[i]->data(), cluster.masterData[i]->data());
+    }
+}
+
+TEST_F(SyncEngineTest, KeyframeIntervalOneMatchesFullSync) {
+    Cluster cluster(8, 1);
+
+    for (int frame = 0; frame < 4; ++frame) {
+        cluster.masterData[frame]->data() = glm::dvec3(frame);
+        const size_t size = cluster.synchronize();
+        EXPECT_EQ(size, sizeof(uint8_t) + 8 * sizeof(glm::dvec3));
+        for (size_t i = 0; i < cluster.masterData.size(); ++i) {
+            EXPECT_EQ(cluster.slaveData[i]->data(), cluster.masterData[i]->data());
+        }
+    }
+}
+
+TEST_F(SyncEngineTest, DISABLED_Benchmark) {
+    constexpr const size_t NumberOfSyncables = 5000;
+    constexpr const int NumberOfFrames = 600;
+    constexpr const size_t ChangesPerFrame = 50;
+
+    for (unsigned int keyframeInterval : { 1, 60 }) {
+        Cluster cluster(NumberOfSyncables, keyframeInterval);
+
+        size_t bytes = 0;
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            for (int frame = 0; frame < NumberOfFrames; ++frame) {
+                for (size_t i = 0; i < ChangesPerFrame; ++i) {
+                    const size_t index =
+                        (frame * ChangesPerFrame + i) % NumberOfSyncables;
+                    cluster.masterData[index]->data() = glm::dvec3(frame);
+                }
+                bytes += cluster.synchronize();
+            }
+        });
+
+        benchmark::report(
+            "Keyframe interval " + std::to_string(keyframeInterval),
+            std::to_string(bytes / NumberOfFrames) + " bytes/frame, " +
+                std::to_string(time.count() / NumberOfFrames) + " us/frame"
+        );
+    }
+}
@@ -0,0 +1,94 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/temporalproviderpool.h>
+
+#include <vector>
+
+class TemporalProviderPoolTest : public testing::Test {};
+
+TEST_F(TemporalProviderPoolTest, PrefetchFollowsTimeDirection) {
+    using namespace openspace::globebrowsing;
+
+    EXPECT_EQ(providerpool::prefetchSteps(3, 60.0), std::vector<int>({ 1, 2, 3 }));
+    EXPECT_EQ(
+        providerpool::prefetchSteps(3, -60.0),
+        std::vector<int>({ -1, -2, -3 })
+    );
+    // Paused time prefetches the closest neighbors on both sides first
+    EXPECT_EQ(
+        providerpool::prefetchSteps(2, 0.0),
+        std::vector<int>({ 1, -1, 2, -2 })
+    );
+    EXPECT_TRUE(providerpool::prefetchSteps(0, 60.0).empty());
+}
+
+TEST_F(TemporalProviderPoolTest, CapacityIsBoundedByBudget) {
+    using namespace openspace::globebrowsing;
+
+    // Levels 1, 2 and 3 consist of 2, 8 and 32 tiles
+    EXPECT_EQ(providerpool::numberOfTiles(1), 2);
+    EXPECT_EQ(providerpool::numberOfTiles(3), 42);
+
+    const size_t tileBytes = 512 * 512 * 4;
+    const size_t providerBytes = providerpool::numberOfTiles(3) * tileBytes;
+    EXPECT_EQ(providerpool::capacity(providerBytes, 5 * providerBytes + 1, 3), 5);
+    // The provider for the current time is always kept, even if it exceeds the budget
+    EXPECT_EQ(providerpool::capacity(providerBytes, providerBytes / 2, 3), 1);
+    // Unknown provider sizes fall back to the number of prefetched times
+    EXPECT_EQ(providerpool::capacity(0, 1024, 3), 3);
+}
+
+TEST_F(TemporalProviderPoolTest, EvictsLeastRecentlyUsed) {
+    using namespace openspace::globebrowsing;
+
+    const std::vector<providerpool::PoolEntry> entries = {
+        { 7, false },
+        { 2, false },
+        { 10, false },
+        { 5, false },
+        { 1, true }
+    };
+
+    // Entry 4 is older, but it is the provider for the current time
+    EXPECT_EQ(providerpool::evictions(entries, 10, 3), std::vector<size_t>({ 1, 3 }));
+    EXPECT_TRUE(providerpool::evictions(entries, 10, 5).empty());
+    EXPECT_TRUE(providerpool::evictions(entries, 10, 8).empty());
+}
+
+TEST_F(TemporalProviderPoolTest, KeepsProvidersInUse) {
+    using namespace openspace::globebrowsing;
+
+    // The current provider and the prefetched providers of this frame are never
+    // removed, even if they exceed the capacity
+    const std::vector<providerpool::PoolEntry> entries = {
+        { 4, false },
+        { 4, false },
+        { 3, true },
+        { 2, false }
+    };
+    EXPECT_EQ(providerpool::evictions(entries, 4, 1), std::vector<size_t>({ 3 }));
+}
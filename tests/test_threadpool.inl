@@ -0,0 +1,216 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/threadpool.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <numeric>
+
+class ThreadPoolTest : public testing::Test {};
+
+namespace {
+    // Reference implementation of a pool with a single task queue guarded by a single
+    // mutex, which is the design that was used before the work-stealing pool
+    class SingleQueueThreadPool {
+    public:
+        SingleQueueThreadPool(size_t numThreads) {
+            for (size_t i = 0; i < numThreads; ++i) {
+                _workers.emplace_back([this]() {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _condition.wait(lock, [this]() {
+                                return _stop || !_tasks.empty();
+                            });
+                            if (_stop) {
+                                return;
+                            }
+                            task = std::move(_tasks.front());
+                            _tasks.pop_front();
+                        }
+                        task();
+                    }
+                });
+            }
+        }
+
+        ~SingleQueueThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _condition.notify_all();
+            for (std::thread& w : _workers) {
+                w.join();
+            }
+        }
+
+        void enqueue(std::function<void()> f) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _tasks.push_back(std::move(f));
+            }
+            _condition.notify_one();
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stop = false;
+    };
+
+    template <typename Pool>
+    long long measureThroughput(Pool& pool, int nTasks) {
+        std::atomic_int counter = 0;
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            for (int i = 0; i < nTasks; ++i) {
+                pool.enqueue([&counter]() { counter++; });
+            }
+            while (counter < nTasks) {
+                std::this_thread::yield();
+            }
+        });
+        const long long us = time.count();
+        // Tasks per second
+        return static_cast<long long>(nTasks) * 1000000 / std::max(us, 1LL);
+    }
+} // namespace
+
+TEST_F(ThreadPoolTest, Enqueue) {
+    openspace::ThreadPool pool(4);
+
+    std::atomic_int counter = 0;
+    for (int i = 0; i < 1000; ++i) {
+        pool.enqueue([&counter]() { counter++; });
+    }
+    while (counter < 1000) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST_F(ThreadPoolTest, Submit) {
+    using namespace openspace;
+    ThreadPool pool(2);
+
+    std::future<int> value = pool.submit([]() { return 1337; });
+    EXPECT_EQ(value.get(), 1337);
+
+    std::future<int> failing = pool.submit([]() -> int {
+        throw std::runtime_error("Failure");
+    });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+
+    std::future<int> highPriority = pool.submit(
+        []() { return 42; },
+        ThreadPool::Priority::High
+    );
+    EXPECT_EQ(highPriority.get(), 42);
+}
+
+TEST_F(ThreadPoolTest, Continuation) {
+    openspace::ThreadPool pool(2);
+
+    std::future<std::string> chained = pool.submitWithContinuation(
+        []() { return 21; },
+        [](int v) { return std::to_string(v * 2); }
+    );
+    EXPECT_EQ(chained.get(), "42");
+
+    std::future<int> afterVoid = pool.submitWithContinuation([]() {}, []() { return 1; });
+    EXPECT_EQ(afterVoid.get(), 1);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor) {
+    openspace::ThreadPool pool(4);
+
+    std::vector<int> values(10000, 0);
+    pool.parallelFor(0, values.size(), [&values](size_t i) { values[i] = 1; }, 64);
+    EXPECT_EQ(std::accumulate(values.begin(), values.end(), 0), 10000);
+
+    // Nested calls from within the worker threads must not deadlock
+    std::atomic_int counter = 0;
+    pool.parallelFor(0, 16, [&pool, &counter](size_t) {
+        pool.parallelFor(0, 100, [&counter](size_t) { counter++; });
+    });
+    EXPECT_EQ(counter, 1600);
+}
+
+TEST_F(ThreadPoolTest, ZeroThreadsParallelFor) {
+    openspace::ThreadPool pool(0);
+
+    std::atomic_int counter = 0;
+    pool.parallelFor(0, 100, [&counter](size_t) { counter++; });
+    EXPECT_EQ(counter, 100);
+}
+
+TEST_F(ThreadPoolTest, ClearTasks) {
+    openspace::ThreadPool pool(1);
+
+    std::atomic_bool blocked = true;
+    std::atomic_int counter = 0;
+    pool.enqueue([&blocked]() {
+        while (blocked) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (int i = 0; i < 10; ++i) {
+        pool.enqueue([&counter]() { counter++; });
+    }
+    pool.clearTasks();
+    blocked = false;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(counter, 0);
+}
+
+TEST_F(ThreadPoolTest, DISABLED_Benchmark) {
+    constexpr const int NumberOfTasks = 200000;
+
+    for (size_t nThreads : { 1, 2, 4, 8, 16, 32, 64 }) {
+        long long singleQueue = 0;
+        {
+            SingleQueueThreadPool pool(nThreads);
+            singleQueue = measureThroughput(pool, NumberOfTasks);
+        }
+        long long workStealing = 0;
+        {
+            openspace::ThreadPool pool(nThreads);
+            workStealing = measureThroughput(pool, NumberOfTasks);
+        }
+
+        benchmark::report(
+            std::to_string(nThreads) + " threads",
+            "single queue " + std::to_string(singleQueue) + " tasks/s, work stealing " +
+                std::to_string(workStealing) + " tasks/s"
+        );
+    }
+}
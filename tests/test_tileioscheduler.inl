@@ -0,0 +1,433 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tileioscheduler.h>
+#include <openspace/util/job.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using openspace::globebrowsing::RawTile;
+    using openspace::globebrowsing::TileIndex;
+    using openspace::globebrowsing::TileIOScheduler;
+
+    // Records the order in which the tiles are read
+    struct ExecutionLog {
+        std::mutex mutex;
+        std::vector<TileIndex::TileHashKey> order;
+    };
+
+    struct FakeTileLoadJob : public openspace::Job<RawTile> {
+        FakeTileLoadJob(TileIndex index, ExecutionLog* log,
+                        std::chrono::microseconds duration)
+            : _index(index)
+            , _log(log)
+            , _duration(duration)
+        {}
+
+        void execute() override {
+            std::this_thread::sleep_for(_duration);
+            if (_log) {
+                std::lock_guard lock(_log->mutex);
+                _log->order.push_back(_index.hashKey());
+            }
+        }
+
+        RawTile product() override {
+            RawTile tile;
+            tile.tileIndex = _index;
+            return tile;
+        }
+
+        TileIndex _index;
+        ExecutionLog* _log;
+        std::chrono::microseconds _duration;
+    };
+
+    // Keeps a worker busy until it is released, so that requests pile up in the queue
+    struct BlockingJob : public openspace::Job<RawTile> {
+        void execute() override {
+            while (!released) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        RawTile product() override {
+            return RawTile();
+        }
+
+        std::atomic_bool released = false;
+    };
+
+    // Tracks how many jobs of a single client are executed at the same time
+    struct ConcurrencyProbe {
+        std::atomic_int nRunning = 0;
+        std::atomic_int maxRunning = 0;
+    };
+
+    struct ProbingJob : public openspace::Job<RawTile> {
+        explicit ProbingJob(ConcurrencyProbe& probe) : _probe(probe) {}
+
+        void execute() override {
+            const int n = ++_probe.nRunning;
+            int max = _probe.maxRunning;
+            while (n > max && !_probe.maxRunning.compare_exchange_weak(max, n)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            --_probe.nRunning;
+        }
+
+        RawTile product() override {
+            return RawTile();
+        }
+
+        ConcurrencyProbe& _probe;
+    };
+
+    std::shared_ptr<FakeTileLoadJob> fakeJob(TileIndex index, ExecutionLog* log) {
+        return std::make_shared<FakeTileLoadJob>(
+            index,
+            log,
+            std::chrono::microseconds(0)
+        );
+    }
+
+    void waitForFinishedJobs(TileIOScheduler& scheduler, TileIOScheduler::ClientId c,
+                             size_t n)
+    {
+        while (scheduler.numFinishedJobs(c) < n) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+} // namespace
+
+class TileIOSchedulerTest : public testing::Test {};
+
+TEST_F(TileIOSchedulerTest, PriorityOrder) {
+    TileIOScheduler scheduler(1, 64);
+    const TileIOScheduler::ClientId client = scheduler.registerClient();
+
+    auto blocker = std::make_shared<BlockingJob>();
+    scheduler.enqueue(client, TileIndex(0, 0, 1), blocker);
+    while (scheduler.numQueuedRequests() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ExecutionLog log;
+    const TileIndex unprioritized(3, 3, 5);
+    const TileIndex fine(1, 1, 6);
+    const TileIndex coarse(0, 1, 3);
+    const TileIndex important(7, 2, 8);
+    const TileIndex older(2, 2, 6);
+    scheduler.enqueue(client, unprioritized, fakeJob(unprioritized, &log));
+    scheduler.enqueue(client, older, fakeJob(older, &log));
+    scheduler.enqueue(client, fine, fakeJob(fine, &log));
+    scheduler.enqueue(client, coarse, fakeJob(coarse, &log));
+    scheduler.enqueue(client, important, fakeJob(important, &log));
+
+    scheduler.setPriority(fine, 1.f);
+    scheduler.setPriority(older, 1.f);
+    scheduler.setPriority(coarse, 1.f);
+    scheduler.setPriority(important, 1.f);
+    // Another globe needs the same tile more urgently
+    scheduler.setPriority(important, 4.f);
+    scheduler.update();
+
+    blocker->released = true;
+    waitForFinishedJobs(scheduler, client, 6);
+
+    // Highest priority first, then coarser levels, then the most recent request
+    const std::vector<TileIndex::TileHashKey> expected = {
+        important.hashKey(),
+        coarse.hashKey(),
+        fine.hashKey(),
+        older.hashKey(),
+        unprioritized.hashKey()
+    };
+    EXPECT_EQ(log.order, expected);
+
+    scheduler.unregisterClient(client);
+}
+
+TEST_F(TileIOSchedulerTest, Touch) {
+    TileIOScheduler scheduler(1, 64);
+    const TileIOScheduler::ClientId client = scheduler.registerClient();
+
+    auto blocker = std::make_shared<BlockingJob>();
+    scheduler.enqueue(client, TileIndex(0, 0, 1), blocker);
+
+    ExecutionLog log;
+    const TileIndex a(0, 0, 4);
+    const TileIndex b(1, 0, 4);
+    scheduler.enqueue(client, a, fakeJob(a, &log));
+    scheduler.enqueue(client, b, fakeJob(b, &log));
+
+    EXPECT_TRUE(scheduler.touch(client, a));
+    EXPECT_FALSE(scheduler.touch(client, TileIndex(5, 5, 4)));
+
+    blocker->released = true;
+    waitForFinishedJobs(scheduler, client, 3);
+
+    const std::vector<TileIndex::TileHashKey> expected = { a.hashKey(), b.hashKey() };
+    EXPECT_EQ(log.order, expected);
+
+    scheduler.unregisterClient(client);
+}
+
+TEST_F(TileIOSchedulerTest, Cancel) {
+    TileIOScheduler scheduler(1, 64);
+    const TileIOScheduler::ClientId c1 = scheduler.registerClient();
+    const TileIOScheduler::ClientId c2 = scheduler.registerClient();
+
+    auto blocker = std::make_shared<BlockingJob>();
+    scheduler.enqueue(c1, TileIndex(0, 0, 1), blocker);
+
+    ExecutionLog log;
+    const TileIndex merged(4, 4, 7);
+    const TileIndex kept(4, 5, 7);
+    scheduler.enqueue(c1, merged, fakeJob(merged, &log));
+    scheduler.enqueue(c2, merged, fakeJob(merged, &log));
+    scheduler.enqueue(c2, kept, fakeJob(kept, &log));
+
+    // The chunk was merged on the globe of the first client; the second client belongs
+    // to another globe that still needs the same tile index
+    scheduler.cancel(c1, merged);
+    scheduler.cancel(c1, kept);
+
+    const std::vector<TileIndex::TileHashKey> dropped1 = scheduler.popDroppedRequests(c1);
+    ASSERT_EQ(dropped1.size(), 1);
+    EXPECT_EQ(dropped1[0], merged.hashKey());
+    EXPECT_TRUE(scheduler.popDroppedRequests(c1).empty());
+    EXPECT_TRUE(scheduler.popDroppedRequests(c2).empty());
+    EXPECT_FALSE(scheduler.touch(c1, merged));
+    EXPECT_TRUE(scheduler.touch(c2, merged));
+
+    const std::vector<TileIndex::TileHashKey> enqueued =
+        scheduler.cancelEnqueuedRequests(c2);
+    ASSERT_EQ(enqueued.size(), 2);
+
+    blocker->released = true;
+    waitForFinishedJobs(scheduler, c1, 1);
+    EXPECT_TRUE(log.order.empty());
+    EXPECT_EQ(scheduler.statistics().nCancelled, 3);
+
+    scheduler.unregisterClient(c1);
+    scheduler.unregisterClient(c2);
+}
+
+TEST_F(TileIOSchedulerTest, DropLowestPriority) {
+    TileIOScheduler scheduler(1, 2);
+    const TileIOScheduler::ClientId client = scheduler.registerClient();
+
+    auto blocker = std::make_shared<BlockingJob>();
+    scheduler.enqueue(client, TileIndex(0, 0, 1), blocker);
+    while (scheduler.numQueuedRequests() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const TileIndex low(0, 0, 9);
+    const TileIndex high(1, 0, 9);
+    const TileIndex lower(2, 0, 10);
+    const TileIndex highest(3, 0, 9);
+    scheduler.setPriority(high, 2.f);
+    scheduler.setPriority(highest, 3.f);
+
+    EXPECT_TRUE(scheduler.enqueue(client, low, fakeJob(low, nullptr)));
+    EXPECT_TRUE(scheduler.enqueue(client, high, fakeJob(high, nullptr)));
+    // The queue is full and the finer level has no priority either
+    EXPECT_FALSE(scheduler.enqueue(client, lower, fakeJob(lower, nullptr)));
+    // Replaces the request with the lowest priority
+    EXPECT_TRUE(scheduler.enqueue(client, highest, fakeJob(highest, nullptr)));
+
+    const std::vector<TileIndex::TileHashKey> dropped =
+        scheduler.popDroppedRequests(client);
+    ASSERT_EQ(dropped.size(), 1);
+    EXPECT_EQ(dropped[0], low.hashKey());
+    EXPECT_EQ(scheduler.numQueuedRequests(), 2);
+    EXPECT_EQ(scheduler.statistics().nDropped, 2);
+
+    blocker->released = true;
+    waitForFinishedJobs(scheduler, client, 3);
+    scheduler.unregisterClient(client);
+}
+
+TEST_F(TileIOSchedulerTest, UnregisterWaitsForRunningJobs) {
+    TileIOScheduler scheduler(2, 64);
+    const TileIOScheduler::ClientId client = scheduler.registerClient();
+
+    ExecutionLog log;
+    const TileIndex slow(0, 0, 2);
+    auto job = std::make_shared<FakeTileLoadJob>(
+        slow,
+        &log,
+        std::chrono::milliseconds(50)
+    );
+    scheduler.enqueue(client, slow, job);
+    while (scheduler.numQueuedRequests() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 10; ++i) {
+        const TileIndex index(i, 1, 5);
+        scheduler.enqueue(client, index, fakeJob(index, nullptr));
+    }
+
+    scheduler.unregisterClient(client);
+    EXPECT_EQ(scheduler.numQueuedRequests(), 0);
+    ASSERT_FALSE(log.order.empty());
+    EXPECT_EQ(log.order[0], slow.hashKey());
+}
+
+TEST_F(TileIOSchedulerTest, OneJobPerClient) {
+    // The clients read from GDAL datasets that must not be used concurrently, so idle
+    // workers may only pick up requests of clients that are not running a job
+    TileIOScheduler scheduler(4, 256);
+    std::vector<TileIOScheduler::ClientId> clients;
+    std::vector<ConcurrencyProbe> probes(3);
+    for (size_t i = 0; i < probes.size(); ++i) {
+        clients.push_back(scheduler.registerClient());
+    }
+
+    for (int r = 0; r < 20; ++r) {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            scheduler.enqueue(
+                clients[i],
+                TileIndex(r, 0, 6),
+                std::make_shared<ProbingJob>(probes[i])
+            );
+        }
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        waitForFinishedJobs(scheduler, clients[i], 20);
+        EXPECT_EQ(probes[i].maxRunning, 1);
+        scheduler.unregisterClient(clients[i]);
+    }
+    EXPECT_EQ(scheduler.numQueuedRequests(), 0);
+}
+
+namespace {
+    constexpr const int NumberOfStreamClients = 8;
+    constexpr const int RequestsPerFrame = 16;
+
+    // Drives the scheduler with synthetic request streams, similar to a number of layers
+    // of a globe requesting tiles while the camera is moving. Every frame, each layer
+    // requests the tiles of a moving window of chunks at the current level and the
+    // priorities of the previous frame are reranked. Returns the statistics of the
+    // scheduler once all requests have been handled
+    TileIOScheduler::Statistics runRequestStreams(size_t nThreads, int nFrames) {
+        constexpr const std::chrono::microseconds ReadTime(200);
+
+        TileIOScheduler scheduler(nThreads, 512);
+        std::vector<TileIOScheduler::ClientId> clients;
+        for (int i = 0; i < NumberOfStreamClients; ++i) {
+            clients.push_back(scheduler.registerClient());
+        }
+
+        std::mt19937 random(1337);
+        std::uniform_int_distribution<int> levelDist(2, 16);
+        std::vector<std::vector<TileIndex>> requested;
+
+        for (int frame = 0; frame < nFrames; ++frame) {
+            std::vector<TileIndex> indices;
+            for (int r = 0; r < RequestsPerFrame; ++r) {
+                const int level = levelDist(random);
+                const TileIndex index(frame + r, r, level);
+                indices.push_back(index);
+                scheduler.setPriority(index, static_cast<float>(16 - level));
+                for (TileIOScheduler::ClientId c : clients) {
+                    scheduler.enqueue(
+                        c,
+                        index,
+                        std::make_shared<FakeTileLoadJob>(index, nullptr, ReadTime)
+                    );
+                }
+            }
+            requested.push_back(std::move(indices));
+
+            // Half of the chunks of two frames ago have been merged since
+            if (frame >= 2) {
+                const std::vector<TileIndex>& merged = requested[frame - 2];
+                for (int r = 0; r < RequestsPerFrame / 2; ++r) {
+                    for (TileIOScheduler::ClientId c : clients) {
+                        scheduler.cancel(c, merged[r]);
+                    }
+                }
+            }
+            scheduler.update();
+            for (TileIOScheduler::ClientId c : clients) {
+                scheduler.popFinishedJobs(c);
+                scheduler.popDroppedRequests(c);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (scheduler.numQueuedRequests() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (TileIOScheduler::ClientId c : clients) {
+            scheduler.unregisterClient(c);
+        }
+        return scheduler.statistics();
+    }
+} // namespace
+
+TEST_F(TileIOSchedulerTest, RequestStreamsAreAccountedFor) {
+    constexpr const int NumberOfFrames = 20;
+
+    const TileIOScheduler::Statistics stats = runRequestStreams(2, NumberOfFrames);
+    EXPECT_EQ(
+        stats.nCompleted + stats.nCancelled + stats.nDropped,
+        static_cast<uint64_t>(NumberOfStreamClients * NumberOfFrames * RequestsPerFrame)
+    );
+}
+
+TEST_F(TileIOSchedulerTest, DISABLED_Benchmark) {
+    constexpr const int NumberOfFrames = 200;
+
+    for (size_t nThreads : { 1, 2, 4, 8 }) {
+        TileIOScheduler::Statistics stats;
+        const std::chrono::microseconds time = benchmark::measure([&]() {
+            stats = runRequestStreams(nThreads, NumberOfFrames);
+        });
+
+        const double seconds = std::chrono::duration<double>(time).count();
+        const double latency = stats.nCompleted > 0 ?
+            stats.totalLatency.count() / 1000.0 / stats.nCompleted :
+            0.0;
+        benchmark::report(
+            "TileIOScheduler (" + std::to_string(nThreads) + " threads)",
+            std::to_string(stats.nCompleted) + " tiles in " +
+                std::to_string(seconds * 1000.0) + " ms (" +
+                std::to_string(stats.nCompleted / seconds) + " tiles/s), " +
+                "average latency " + std::to_string(latency) + " ms, " +
+                std::to_string(stats.nDropped) + " dropped, " +
+                std::to_string(stats.nCancelled) + " cancelled"
+        );
+    }
+}
@@ -0,0 +1,240 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/tilemetadatakernel.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    struct TestData {
+        std::unique_ptr<std::byte[]> data;
+        size_t nBytes;
+    };
+
+    // Creates random pixels of which about every tenth value is the no data value and,
+    // for floating point types, about every twentieth is NaN
+    template <typename T>
+    TestData createTestData(size_t nPixels, size_t nRasters, T noDataValue,
+                            unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> kind(0, 19);
+        std::uniform_real_distribution<double> value(
+            static_cast<double>(std::numeric_limits<T>::lowest() / 2),
+            static_cast<double>(std::numeric_limits<T>::max() / 2)
+        );
+
+        const size_t nValues = nPixels * nRasters;
+        TestData res;
+        res.nBytes = nValues * sizeof(T);
+        res.data = std::unique_ptr<std::byte[]>(new std::byte[res.nBytes]);
+        T* values = reinterpret_cast<T*>(res.data.get());
+        for (size_t i = 0; i < nValues; ++i) {
+            const int k = kind(random);
+            if (k < 2) {
+                values[i] = noDataValue;
+            }
+            else if (k == 2 && std::numeric_limits<T>::has_quiet_NaN) {
+                values[i] = std::numeric_limits<T>::quiet_NaN();
+            }
+            else {
+                values[i] = static_cast<T>(value(random));
+            }
+        }
+        return res;
+    }
+
+    template <typename T>
+    void compareWithScalar(GLenum glType, T noDataValue) {
+        for (size_t nRasters = 1; nRasters <= 4; ++nRasters) {
+            TileMetaDataKernel kernel = tileMetaDataKernel(glType, nRasters);
+            ASSERT_NE(kernel, nullptr);
+
+            // Tiles that are smaller than, equal to, and larger than a block
+            for (size_t nPixels : { 1, 15, 16, 17, 100, 64 * 64, 65 * 65 }) {
+                TestData scalarData = createTestData<T>(
+                    nPixels,
+                    nRasters,
+                    noDataValue,
+                    static_cast<unsigned int>(nPixels * nRasters)
+                );
+                TestData kernelData;
+                kernelData.nBytes = scalarData.nBytes;
+                kernelData.data = std::unique_ptr<std::byte[]>(
+                    new std::byte[kernelData.nBytes]
+                );
+                std::memcpy(
+                    kernelData.data.get(),
+                    scalarData.data.get(),
+                    scalarData.nBytes
+                );
+
+                TileMetaData scalarMetaData;
+                const bool scalarValid = tileMetaDataScalar(
+                    glType,
+                    nRasters,
+                    scalarData.data.get(),
+                    nPixels,
+                    static_cast<float>(noDataValue),
+                    scalarMetaData
+                );
+                TileMetaData kernelMetaData;
+                const bool kernelValid = kernel(
+                    kernelData.data.get(),
+                    nPixels,
+                    static_cast<float>(noDataValue),
+                    kernelMetaData
+                );
+
+                SCOPED_TRACE(
+                    "Rasters: " + std::to_string(nRasters) +
+                    "  Pixels: " + std::to_string(nPixels)
+                );
+                EXPECT_EQ(kernelValid, scalarValid);
+                EXPECT_EQ(kernelMetaData.minValues, scalarMetaData.minValues);
+                EXPECT_EQ(kernelMetaData.maxValues, scalarMetaData.maxValues);
+                EXPECT_EQ(kernelMetaData.hasMissingData, scalarMetaData.hasMissingData);
+                // The missing values have to be rewritten in the same way
+                EXPECT_EQ(
+                    std::memcmp(
+                        kernelData.data.get(),
+                        scalarData.data.get(),
+                        scalarData.nBytes
+                    ),
+                    0
+                );
+            }
+        }
+    }
+
+    template <typename T>
+    void runBenchmark(const char* name, GLenum glType, size_t nRasters) {
+        constexpr const size_t TileSize = 512 * 512;
+        constexpr const int Iterations = 50;
+        const T noDataValue = static_cast<T>(0);
+
+        TestData original = createTestData<T>(TileSize, nRasters, noDataValue, 1);
+        std::unique_ptr<std::byte[]> data(new std::byte[original.nBytes]);
+        TileMetaDataKernel kernel = tileMetaDataKernel(glType, nRasters);
+
+        auto measure = [&](auto function) {
+            std::chrono::microseconds total(0);
+            for (int i = 0; i < Iterations; ++i) {
+                std::memcpy(data.get(), original.data.get(), original.nBytes);
+                TileMetaData metaData;
+                total += benchmark::measure([&]() { function(data.get(), metaData); });
+            }
+            return static_cast<double>(total.count()) / Iterations;
+        };
+
+        const double scalar = measure([&](std::byte* d, TileMetaData& md) {
+            tileMetaDataScalar(glType, nRasters, d, TileSize, noDataValue, md);
+        });
+        const double specialized = measure([&](std::byte* d, TileMetaData& md) {
+            kernel(d, TileSize, noDataValue, md);
+        });
+
+        benchmark::report(
+            "Tile meta data (512x512 " + std::string(name) + ", " +
+                std::to_string(nRasters) + " rasters)",
+            "scalar " + std::to_string(scalar) + " us, kernel " +
+                std::to_string(specialized) + " us, speedup " +
+                std::to_string(scalar / specialized) + "x"
+        );
+    }
+} // namespace
+
+class TileMetaDataKernelTest : public testing::Test {};
+
+TEST_F(TileMetaDataKernelTest, UnsignedByte) {
+    compareWithScalar<GLubyte>(GL_UNSIGNED_BYTE, 0);
+}
+
+TEST_F(TileMetaDataKernelTest, UnsignedShort) {
+    compareWithScalar<GLushort>(GL_UNSIGNED_SHORT, 0);
+}
+
+TEST_F(TileMetaDataKernelTest, Short) {
+    compareWithScalar<GLshort>(GL_SHORT, -32768);
+}
+
+TEST_F(TileMetaDataKernelTest, UnsignedInt) {
+    compareWithScalar<GLuint>(GL_UNSIGNED_INT, 0);
+}
+
+TEST_F(TileMetaDataKernelTest, Int) {
+    compareWithScalar<GLint>(GL_INT, -9999);
+}
+
+TEST_F(TileMetaDataKernelTest, Float) {
+    compareWithScalar<GLfloat>(GL_FLOAT, -9999.f);
+}
+
+TEST_F(TileMetaDataKernelTest, Double) {
+    compareWithScalar<GLdouble>(GL_DOUBLE, -9999.0);
+}
+
+TEST_F(TileMetaDataKernelTest, AllMissing) {
+    constexpr const size_t NPixels = 40;
+    std::vector<float> values(NPixels, -9999.f);
+    values[3] = std::numeric_limits<float>::quiet_NaN();
+
+    TileMetaData metaData;
+    TileMetaDataKernel kernel = tileMetaDataKernel(GL_FLOAT, 1);
+    const bool anyValid = kernel(
+        reinterpret_cast<std::byte*>(values.data()),
+        NPixels,
+        -9999.f,
+        metaData
+    );
+
+    EXPECT_FALSE(anyValid);
+    ASSERT_EQ(metaData.hasMissingData.size(), 1);
+    EXPECT_TRUE(metaData.hasMissingData[0]);
+    for (float v : values) {
+        EXPECT_EQ(v, -std::numeric_limits<float>::max());
+    }
+}
+
+TEST_F(TileMetaDataKernelTest, Unsupported) {
+    EXPECT_EQ(tileMetaDataKernel(GL_HALF_FLOAT, 1), nullptr);
+    EXPECT_EQ(tileMetaDataKernel(GL_FLOAT, 5), nullptr);
+}
+
+TEST_F(TileMetaDataKernelTest, DISABLED_Benchmark) {
+    runBenchmark<GLfloat>("float", GL_FLOAT, 1);
+    runBenchmark<GLushort>("unsigned short", GL_UNSIGNED_SHORT, 1);
+    runBenchmark<GLshort>("short", GL_SHORT, 1);
+    runBenchmark<GLubyte>("unsigned byte", GL_UNSIGNED_BYTE, 4);
+}
@@ -0,0 +1,127 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/volume/volumeutils.h>
+#include <algorithm>
+#include <vector>
+
+class VolumeStreamingWindowTest : public testing::Test {
+protected:
+    // Ten timesteps that start every 100 seconds and occupy 10 bytes each
+    const std::vector<double> _startTimes = {
+        0.0, 100.0, 200.0, 300.0, 400.0, 500.0, 600.0, 700.0, 800.0, 900.0
+    };
+    const std::vector<size_t> _sizes = std::vector<size_t>(10, 10);
+
+    static bool contains(const std::vector<size_t>& window, size_t index) {
+        return std::find(window.begin(), window.end(), index) != window.end();
+    }
+};
+
+TEST_F(VolumeStreamingWindowTest, PrefetchesInDirectionOfTime) {
+    using namespace openspace::volume;
+
+    // Paused: the current timestep, the next one, and the previous one
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 450.0, 0.0, 2.0, 1000, 1),
+        std::vector<size_t>({ 4, 5, 3 })
+    );
+
+    // 100 seconds per second for 2 seconds passes two more timesteps
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 450.0, 100.0, 2.0, 1000, 1),
+        std::vector<size_t>({ 4, 5, 6, 7, 3 })
+    );
+
+    // Running backwards in time prefetches the earlier timesteps instead
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 450.0, -100.0, 2.0, 1000, 1),
+        std::vector<size_t>({ 4, 3, 2, 1, 5 })
+    );
+}
+
+TEST_F(VolumeStreamingWindowTest, ClampsToSequence) {
+    using namespace openspace::volume;
+
+    // Before the sequence the first timestep is the current one
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, -50.0, 0.0, 2.0, 1000, 1),
+        std::vector<size_t>({ 0, 1 })
+    );
+
+    // After the sequence the last timestep stays current and nothing is prefetched
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 5000.0, 100.0, 2.0, 1000, 1),
+        std::vector<size_t>({ 9, 8 })
+    );
+
+    EXPECT_TRUE(streamingWindow({}, {}, 0.0, 1.0, 2.0, 1000, 1).empty());
+}
+
+TEST_F(VolumeStreamingWindowTest, RespectsMemoryBudget) {
+    using namespace openspace::volume;
+
+    // Only three timesteps fit, so the prefetch is cut off before the previous timestep
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 450.0, 100.0, 2.0, 30, 1),
+        std::vector<size_t>({ 4, 5, 6 })
+    );
+
+    // The current timestep is always resident, even if it exceeds the budget
+    EXPECT_EQ(
+        streamingWindow(_startTimes, _sizes, 450.0, 100.0, 2.0, 5, 1),
+        std::vector<size_t>({ 4 })
+    );
+}
+
+TEST_F(VolumeStreamingWindowTest, EvictsTimestepsThatWerePassed) {
+    using namespace openspace::volume;
+
+    const std::vector<size_t> resident =
+        streamingWindow(_startTimes, _sizes, 150.0, 100.0, 1.0, 1000, 1);
+    EXPECT_EQ(resident, std::vector<size_t>({ 1, 2, 3, 0 }));
+
+    // Moving forward by three timesteps keeps the timestep that is now behind and
+    // evicts all older ones
+    const std::vector<size_t> next =
+        streamingWindow(_startTimes, _sizes, 450.0, 100.0, 1.0, 1000, 1);
+    EXPECT_EQ(next, std::vector<size_t>({ 4, 5, 6, 3 }));
+
+    std::vector<size_t> evicted;
+    for (size_t index : resident) {
+        if (!contains(next, index)) {
+            evicted.push_back(index);
+        }
+    }
+    std::sort(evicted.begin(), evicted.end());
+    EXPECT_EQ(evicted, std::vector<size_t>({ 0, 1, 2 }));
+
+    // Jumping back reloads the earlier timesteps
+    const std::vector<size_t> back =
+        streamingWindow(_startTimes, _sizes, 50.0, 100.0, 1.0, 1000, 1);
+    EXPECT_TRUE(contains(back, 0));
+    EXPECT_FALSE(contains(back, 4));
+}